@@ -31,6 +31,9 @@
 #include "Osc.h"
 #include "cinder/Log.h"
 
+#include <condition_variable>
+#include <unordered_map>
+
 using namespace std;
 using namespace asio;
 using namespace asio::ip;
@@ -398,6 +401,16 @@ void Message::appendMidi( uint8_t port, uint8_t status, uint8_t data1, uint8_t d
 }
 
 void Message::createCache() const
+{
+	if( ! mCache )
+		mCache = ByteBufferRef( new ByteBuffer() );
+	
+	mCache->clear();
+	encode( mCache.get() );
+	mIsCached = true;
+}
+
+void Message::encode( ByteBuffer *buffer ) const
 {
 	// Check for debug to allow for Default Constructing.
 	CI_ASSERT_MSG( mAddress.size() > 0 && mAddress[0] == '/',
@@ -406,37 +419,31 @@ void Message::createCache() const
 	size_t addressLen = mAddress.size() + getTrailingZeros( mAddress.size() );
 	// adding one for ',' character, which was the sourc of a particularly ugly bug
 	auto typesSize = mDataViews.size() + 1;
-	std::vector<char> typesArray( typesSize + getTrailingZeros( typesSize ) , 0 );
-	
-	typesArray[0] = ',';
-	int i = 1;
-	for( auto & dataView : mDataViews )
-		typesArray[i++] = Argument::translateArgTypeToCharType( dataView.getType() );
+	size_t typesArrayLen = typesSize + getTrailingZeros( typesSize );
+	int32_t messageSize = addressLen + typesArrayLen + mDataBuffer.size();
 	
-	if( ! mCache )
-		mCache = ByteBufferRef( new ByteBuffer() );
+	// the new bytes are zeroed, which pads the address and types
+	const size_t begin = buffer->size();
+	buffer->resize( begin + 4 + messageSize );
+	auto ptr = buffer->data() + begin;
 	
-	size_t typesArrayLen = typesArray.size();
-	ByteArray<4> sizeArray;
-	int32_t messageSize = addressLen + typesArrayLen + mDataBuffer.size();
 	auto endianSize = htonl( messageSize );
-	memcpy( sizeArray.data(), reinterpret_cast<uint8_t*>( &endianSize ), 4 );
+	memcpy( ptr, reinterpret_cast<uint8_t*>( &endianSize ), 4 );
+	std::copy( mAddress.begin(), mAddress.end(), ptr + 4 );
 	
-	mCache->resize( 4 + messageSize );
+	auto typesPtr = ptr + 4 + addressLen;
+	*typesPtr++ = ',';
+	for( auto & dataView : mDataViews )
+		*typesPtr++ = Argument::translateArgTypeToCharType( dataView.getType() );
 	
-	std::copy( sizeArray.begin(),	sizeArray.end(),	mCache->begin() );
-	std::copy( mAddress.begin(),	mAddress.end(),		mCache->begin() + 4 );
-	std::copy( typesArray.begin(),	typesArray.end(),	mCache->begin() + 4 + addressLen );
-	std::copy( mDataBuffer.begin(),	mDataBuffer.end(),	mCache->begin() + 4 + addressLen + typesArrayLen );
+	std::copy( mDataBuffer.begin(), mDataBuffer.end(), ptr + 4 + addressLen + typesArrayLen );
 	
-	// Now that cached (transportable) buffer is created, swap endian for transmit.
-	auto dataPtr = mCache->data() + 4 + addressLen + typesArrayLen;
+	// Now that the transportable buffer is created, swap endian for transmit.
+	auto dataPtr = ptr + 4 + addressLen + typesArrayLen;
 	for( auto & dataView : mDataViews ) {
 		if( dataView.needsEndianSwapForTransmit() )
 			dataView.swapEndianForTransmit( dataPtr );
 	}
-	
-	mIsCached = true;
 }
 
 ByteBufferRef Message::getSharedBuffer() const
@@ -916,6 +923,226 @@ ByteBufferRef Bundle::getSharedBuffer() const
 	return mDataBuffer;
 }
 	
+////////////////////////////////////////////////////////////////////////////////////////
+//// MessageWriter
+
+namespace {
+
+//! Same padding as Message::getTrailingZeros(), which the receivers expect.
+size_t getTrailingZeros( size_t bufferSize ) { return 4 - ( bufferSize % 4 ); }
+
+//! The size of a bundle's "#bundle" identifier and timetag, after its 4 byte size.
+const size_t sBundleHeaderSize = 16;
+//! Beyond this many send buffers in flight, further ones aren't kept for reuse.
+const size_t sMaxPooledBuffers = 1024;
+
+} // anonymous namespace
+
+void MessageWriter::begin( const ByteBufferRef &buffer, const std::string &address )
+{
+	CI_ASSERT_MSG( address.size() > 0 && address[0] == '/',
+				  "All OSC Address Patterns must at least start with '/' (forward slash)" );
+	
+	mBuffer = buffer;
+	mMessageBegin = mBuffer->size();
+	// the size is filled in by send()
+	mBuffer->resize( mMessageBegin + 4 );
+	appendData( address.data(), address.size(), getTrailingZeros( address.size() ) );
+	mArgumentsBegin = mBuffer->size();
+	mTypeTags.assign( 1, ',' );
+	mBlob.reset();
+}
+
+void MessageWriter::discard()
+{
+	if( mBuffer ) {
+		mBuffer->resize( mMessageBegin );
+		mBuffer.reset();
+	}
+	mBlob.reset();
+}
+
+void MessageWriter::appendData( const void *data, size_t size, size_t trailingZeros )
+{
+	auto ptr = reinterpret_cast<const uint8_t*>( data );
+	mBuffer->insert( mBuffer->end(), ptr, ptr + size );
+	if( trailingZeros != 0 )
+		mBuffer->resize( mBuffer->size() + trailingZeros, 0 );
+}
+
+MessageWriter& MessageWriter::append( int32_t v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::INTEGER_32 );
+	int32_t a = htonl( v );
+	appendData( &a, sizeof( int32_t ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( float v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::FLOAT );
+	uint32_t a;
+	memcpy( &a, &v, sizeof( float ) );
+	a = htonl( a );
+	appendData( &a, sizeof( float ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( const std::string &v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::STRING );
+	appendData( v.data(), v.size(), getTrailingZeros( v.size() ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( const char v[] )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::STRING );
+	auto stringLength = strlen( v );
+	appendData( v, stringLength, getTrailingZeros( stringLength ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::appendBlob( const void *blob, uint32_t size )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::BLOB );
+	int32_t a = htonl( size );
+	appendData( &a, sizeof( int32_t ) );
+	appendData( blob, size, getTrailingZeros( size ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( const ci::BufferRef &blob )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	if( ! blob )
+		return appendBlob( nullptr, 0 );
+	if( mBlob )
+		return appendBlob( blob->getData(), (uint32_t)blob->getSize() );
+	
+	mTypeTags += static_cast<char>( ArgType::BLOB );
+	int32_t a = htonl( (uint32_t)blob->getSize() );
+	appendData( &a, sizeof( int32_t ) );
+	mBlob = blob;
+	mBlobOffset = mBuffer->size();
+	appendData( nullptr, 0, getTrailingZeros( blob->getSize() ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::appendTimeTag( uint64_t v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::TIME_TAG );
+	uint64_t a = htonll( v );
+	appendData( &a, sizeof( uint64_t ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::appendCurrentTime()
+{
+	return appendTimeTag( time::get_current_ntp_time() );
+}
+
+MessageWriter& MessageWriter::append( bool v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( v ? ArgType::BOOL_T : ArgType::BOOL_F );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( int64_t v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::INTEGER_64 );
+	uint64_t a = htonll( static_cast<uint64_t>( v ) );
+	appendData( &a, sizeof( int64_t ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( double v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::DOUBLE );
+	uint64_t a;
+	memcpy( &a, &v, sizeof( double ) );
+	a = htonll( a );
+	appendData( &a, sizeof( double ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::append( char v )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::CHAR );
+	int32_t a = htonl( static_cast<uint8_t>( v ) );
+	appendData( &a, sizeof( int32_t ) );
+	return *this;
+}
+
+MessageWriter& MessageWriter::appendMidi( uint8_t port, uint8_t status, uint8_t data1, uint8_t data2 )
+{
+	if( ! mBuffer )
+		return *this;
+	
+	mTypeTags += static_cast<char>( ArgType::MIDI );
+	const uint8_t b[4] = { port, status, data1, data2 };
+	appendData( b, 4 );
+	return *this;
+}
+
+void MessageWriter::send( OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
+{
+	if( ! mBuffer )
+		return;
+	
+	// the type tags precede the arguments, so they're inserted in front of them now that they're known
+	const size_t typeTagsLen = mTypeTags.size() + getTrailingZeros( mTypeTags.size() );
+	const size_t argumentsLen = mBuffer->size() - mArgumentsBegin;
+	mBuffer->resize( mBuffer->size() + typeTagsLen );
+	auto arguments = mBuffer->data() + mArgumentsBegin;
+	memmove( arguments + typeTagsLen, arguments, argumentsLen );
+	memcpy( arguments, mTypeTags.data(), mTypeTags.size() );
+	memset( arguments + mTypeTags.size(), 0, typeTagsLen - mTypeTags.size() );
+	if( mBlob )
+		mBlobOffset += typeTagsLen;
+	
+	const size_t messageSize = mBuffer->size() - mMessageBegin - 4 + ( mBlob ? mBlob->getSize() : 0 );
+	int32_t a = htonl( (int32_t)messageSize );
+	memcpy( mBuffer->data() + mMessageBegin, &a, 4 );
+	
+	// released before committing, so the buffer can be reused as soon as the send completes
+	ByteBufferRef buffer = std::move( mBuffer );
+	ci::BufferRef blob = std::move( mBlob );
+	mSender->commitMessage( buffer, mMessageBegin, blob, mBlobOffset, std::move( onErrorFn ), std::move( onCompleteFn ) );
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //// SenderBase
 	
@@ -932,14 +1159,178 @@ std::string SenderBase::extractOscAddress( const ByteBufferRef &transportData )
 	
 void SenderBase::send( const Message &message, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
 {
-	sendImpl( message.getSharedBuffer(), std::move( onErrorFn ), std::move( onCompleteFn ) );
+	mWriter.discard();
+	if( mBatchingEnabled && ! mBatch )
+		beginBatch();
+	ByteBufferRef buffer = mBatchingEnabled ? mBatch : acquireBuffer();
+	const size_t messageBegin = buffer->size();
+	message.encode( buffer.get() );
+	commitMessage( buffer, messageBegin, nullptr, 0, std::move( onErrorFn ), std::move( onCompleteFn ) );
 }
 	
 void SenderBase::send( const Bundle &bundle, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
 {
+	flush();
 	sendImpl( bundle.getSharedBuffer(), std::move( onErrorFn ), std::move( onCompleteFn ) );
 }
 
+MessageWriter& SenderBase::beginMessage( const std::string &address )
+{
+	mWriter.discard();
+	if( mBatchingEnabled && ! mBatch )
+		beginBatch();
+	mWriter.begin( mBatchingEnabled ? mBatch : acquireBuffer(), address );
+	return mWriter;
+}
+
+void SenderBase::setBatchingEnabled( bool enable, size_t maxPacketSize )
+{
+	flush();
+	mBatch.reset();
+	mBatchingEnabled = enable;
+	mMaxPacketSize = maxPacketSize;
+}
+
+void SenderBase::flush()
+{
+	mWriter.discard();
+	if( mNumBatched > 0 )
+		sendBatch( nullptr, 0 );
+}
+
+void SenderBase::sendBlobImpl( const ByteBufferRef &byteBuffer, size_t blobOffset, const ci::BufferRef &blob, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
+{
+	auto data = reinterpret_cast<const uint8_t*>( blob->getData() );
+	ByteBufferRef joined( new ByteBuffer() );
+	joined->reserve( byteBuffer->size() + blob->getSize() );
+	joined->insert( joined->end(), byteBuffer->begin(), byteBuffer->begin() + blobOffset );
+	joined->insert( joined->end(), data, data + blob->getSize() );
+	joined->insert( joined->end(), byteBuffer->begin() + blobOffset, byteBuffer->end() );
+	sendImpl( joined, std::move( onErrorFn ), std::move( onCompleteFn ) );
+}
+
+ByteBufferRef SenderBase::acquireBuffer()
+{
+	// A buffer can be reused once no send holds it any more. Sends tend to complete in the order they
+	// were made, so the search continues from the last buffer handed out.
+	if( mNextPooledBuffer >= mBufferPool.size() )
+		mNextPooledBuffer = 0;
+	if( mBufferPool.empty() || mBufferPool[mNextPooledBuffer].use_count() > 1 ) {
+		if( mBufferPool.size() >= sMaxPooledBuffers )
+			return ByteBufferRef( new ByteBuffer() );
+		mBufferPool.insert( mBufferPool.begin() + mNextPooledBuffer, ByteBufferRef( new ByteBuffer() ) );
+	}
+	
+	ByteBufferRef buffer = mBufferPool[mNextPooledBuffer++];
+	buffer->clear();
+	return buffer;
+}
+
+void SenderBase::beginBatch()
+{
+	static const char id[8] = "#bundle";
+	mBatch = acquireBuffer();
+	// the size is filled in by sendBatch(), and the timetag is immediate
+	mBatch->resize( 4 + sBundleHeaderSize, 0 );
+	std::copy( id, id + 8, mBatch->begin() + 4 );
+	(*mBatch)[4 + sBundleHeaderSize - 1] = 1;
+	mNumBatched = 0;
+}
+
+void SenderBase::commitMessage( const ByteBufferRef &buffer, size_t messageBegin, const ci::BufferRef &blob, size_t blobOffset, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
+{
+	if( ! mBatchingEnabled ) {
+		if( blob )
+			sendBlobImpl( buffer, blobOffset, blob, std::move( onErrorFn ), std::move( onCompleteFn ) );
+		else
+			sendImpl( buffer, std::move( onErrorFn ), std::move( onCompleteFn ) );
+		return;
+	}
+	
+	// The size at the front isn't part of the datagram. When the message overflows the bundle, it's moved
+	// into a new one and the messages before it are sent.
+	const size_t blobSize = blob ? blob->getSize() : 0;
+	if( mNumBatched > 0 && mBatch->size() - 4 + blobSize > mMaxPacketSize ) {
+		ByteBufferRef previous = mBatch;
+		const size_t numPrevious = mNumBatched;
+		beginBatch();
+		mBatch->insert( mBatch->end(), previous->begin() + messageBegin, previous->end() );
+		blobOffset = blobOffset + 4 + sBundleHeaderSize - messageBegin;
+		previous->resize( messageBegin );
+		
+		std::swap( previous, mBatch );
+		mNumBatched = numPrevious;
+		sendBatch( nullptr, 0 );
+		mBatch = previous;
+	}
+	
+	++mNumBatched;
+	if( onErrorFn || onCompleteFn )
+		mBatchCallbacks.emplace_back( std::move( onErrorFn ), std::move( onCompleteFn ) );
+	
+	// A message with a blob, or one filling a packet by itself, is sent straight away. Otherwise the bundle
+	// is sent when the io_service next runs, unless a message is being written into it by then.
+	if( blob || mBatch->size() - 4 >= mMaxPacketSize )
+		sendBatch( blob, blobOffset );
+	else if( ! mFlushPosted ) {
+		if( auto io = getIoServiceImpl() ) {
+			mFlushPosted = true;
+			std::weak_ptr<int> token = mFlushToken;
+			io->post( [this, token] {
+				if( token.expired() )
+					return;
+				mFlushPosted = false;
+				if( ! mWriter.mBuffer && mNumBatched > 0 )
+					sendBatch( nullptr, 0 );
+			} );
+		}
+	}
+}
+
+void SenderBase::sendBatch( const ci::BufferRef &blob, size_t blobOffset )
+{
+	// a single message is sent by itself, rather than in a bundle
+	if( mNumBatched == 1 ) {
+		mBatch->erase( mBatch->begin(), mBatch->begin() + 4 + sBundleHeaderSize );
+		blobOffset -= 4 + sBundleHeaderSize;
+	}
+	else {
+		int32_t a = htonl( (int32_t)( mBatch->size() - 4 + ( blob ? blob->getSize() : 0 ) ) );
+		memcpy( mBatch->data(), &a, 4 );
+	}
+	
+	OnErrorFn onErrorFn;
+	OnCompleteFn onCompleteFn;
+	if( ! mBatchCallbacks.empty() ) {
+		auto callbacks = std::make_shared<std::vector<std::pair<OnErrorFn, OnCompleteFn>>>();
+		callbacks->swap( mBatchCallbacks );
+		onErrorFn = [callbacks]( asio::error_code error ) {
+			bool handled = false;
+			for( auto &callback : *callbacks ) {
+				if( callback.first ) {
+					callback.first( error );
+					handled = true;
+				}
+			}
+			if( ! handled )
+				CI_LOG_E( "Send: " << error.message() << " - Code: " << error.value() );
+		};
+		onCompleteFn = [callbacks] {
+			for( auto &callback : *callbacks ) {
+				if( callback.second )
+					callback.second();
+			}
+		};
+	}
+	
+	ByteBufferRef batch = std::move( mBatch );
+	mNumBatched = 0;
+	if( blob )
+		sendBlobImpl( batch, blobOffset, blob, std::move( onErrorFn ), std::move( onCompleteFn ) );
+	else
+		sendImpl( batch, std::move( onErrorFn ), std::move( onCompleteFn ) );
+}
+	
 ////////////////////////////////////////////////////////////////////////////////////////
 //// SenderUdp
 
@@ -993,6 +1384,33 @@ void SenderUdp::sendImpl( const ByteBufferRef &data, OnErrorFn onErrorFn, OnComp
 		}
 	});
 }
+
+void SenderUdp::sendBlobImpl( const ByteBufferRef &data, size_t blobOffset, const ci::BufferRef &blob, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
+{
+	if( ! mSocket->is_open() )
+		return;
+	
+	// the blob is gathered in between the two parts of data, skipping the size again
+	std::array<asio::const_buffer, 3> buffers = { {
+		asio::buffer( data->data() + 4, blobOffset - 4 ),
+		asio::buffer( blob->getData(), blob->getSize() ),
+		asio::buffer( data->data() + blobOffset, data->size() - blobOffset )
+	} };
+	mSocket->async_send_to( buffers, mRemoteEndpoint,
+	// copy data and blob pointers to persist the asynchronous send
+	[&, data, blob, onErrorFn, onCompleteFn]( const asio::error_code& error, size_t bytesTransferred )
+	{
+		if( error ) {
+			if( onErrorFn )
+				onErrorFn( error );
+			else
+				CI_LOG_E( "Udp Send: " << error.message() << " - Code: " << error.value() );
+		}
+		else if( onCompleteFn ) {
+			onCompleteFn();
+		}
+	});
+}
 	
 void SenderUdp::closeImpl()
 {
@@ -1081,18 +1499,65 @@ void SenderTcp::sendImpl( const ByteBufferRef &data, OnErrorFn onErrorFn, OnComp
 	ByteBufferRef transportData = data;
 	if( mPacketFraming )
 		transportData = mPacketFraming->encode( transportData );
-	mSocket->async_send( asio::buffer( *transportData ),
-	// copy data pointer to persist the asynchronous send
-	[&, transportData, onErrorFn, onCompleteFn]( const asio::error_code& error, size_t bytesTransferred )
+	queueWrite( { transportData, nullptr, 0, std::move( onErrorFn ), std::move( onCompleteFn ) } );
+}
+
+void SenderTcp::sendBlobImpl( const ByteBufferRef &data, size_t blobOffset, const ci::BufferRef &blob, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn )
+{
+	if( ! mSocket->is_open() )
+		return;
+	
+	if( mPacketFraming ) {
+		SenderBase::sendBlobImpl( data, blobOffset, blob, std::move( onErrorFn ), std::move( onCompleteFn ) );
+		return;
+	}
+	
+	queueWrite( { data, blob, blobOffset, std::move( onErrorFn ), std::move( onCompleteFn ) } );
+}
+
+void SenderTcp::queueWrite( PendingWrite write )
+{
+	std::lock_guard<std::mutex> lock( mWriteQueue->mMutex );
+	mWriteQueue->mWrites.push_back( std::move( write ) );
+	// the bytes of two writes in progress at once could interleave on the stream, so each waits for the one before it
+	if( mWriteQueue->mWrites.size() == 1 )
+		writeNext( mSocket, mWriteQueue );
+}
+
+// static
+void SenderTcp::writeNext( const TcpSocketRef &socket, const std::shared_ptr<WriteQueue> &queue )
+{
+	const PendingWrite &write = queue->mWrites.front();
+	const ByteBufferRef &data = write.mData;
+	const size_t blobOffset = write.mBlob ? write.mBlobOffset : data->size();
+	std::array<asio::const_buffer, 3> buffers = { {
+		asio::buffer( data->data(), blobOffset ),
+		write.mBlob ? asio::buffer( write.mBlob->getData(), write.mBlob->getSize() ) : asio::const_buffer(),
+		asio::buffer( data->data() + blobOffset, data->size() - blobOffset )
+	} };
+	// a large packet may not go out in a single send, so this writes until everything has. The handler holds the socket
+	// and queue rather than the SenderTcp, as closing the socket on destruction completes the writes still queued with an error.
+	asio::async_write( *socket, buffers,
+	[socket, queue]( const asio::error_code& error, size_t bytesTransferred )
 	{
+		// the data and blob are kept alive by the queue until now
+		PendingWrite written;
+		{
+			std::lock_guard<std::mutex> lock( queue->mMutex );
+			written = std::move( queue->mWrites.front() );
+			queue->mWrites.pop_front();
+			if( ! queue->mWrites.empty() )
+				writeNext( socket, queue );
+		}
+		
 		if( error ) {
-			if( onErrorFn )
-				onErrorFn( error );
+			if( written.mOnErrorFn )
+				written.mOnErrorFn( error );
 			else
 				CI_LOG_E( "Tcp Send: " << error.message() << " - Code: " << error.value() );
 		}
-		else if( onCompleteFn ) {
-			onCompleteFn();
+		else if( written.mOnCompleteFn ) {
+			written.mOnCompleteFn();
 		}
 	});
 }
@@ -1109,28 +1574,199 @@ void SenderTcp::closeImpl()
 /////////////////////////////////////////////////////////////////////////////////////////
 //// ReceiverBase
 	
+namespace {
+
+//! Guards the counts of blocked calls in every ListenerEntry, and is notified as calls to removed listeners return.
+std::mutex				sRunningMutex;
+std::condition_variable	sRunningChanged;
+
+} // anonymous namespace
+
+struct ReceiverBase::ListenerEntry {
+	ListenerEntry( const std::string &address, const ListenerFn &fn ) : mAddress( address ), mFn( fn ) {}
+	
+	//! Calls the listener with \a message unless it has been removed, counting the call while it runs.
+	void call( const Message &message );
+	
+	//! A call running on this thread, linked to the one whose dispatch it was made from.
+	struct Running {
+		ListenerEntry	*mEntry;
+		const Running	*mNext;
+	};
+	static thread_local const Running	*sRunning;
+	
+	const std::string	mAddress;
+	const ListenerFn	mFn;
+	std::atomic<int>	mNumRunning{ 0 };
+	std::atomic<bool>	mRemoved{ false };
+	int					mNumBlocked = 0;	// calls in progress on threads waiting in removeListener(), guarded by sRunningMutex
+};
+
+thread_local const ReceiverBase::ListenerEntry::Running *ReceiverBase::ListenerEntry::sRunning = nullptr;
+
+void ReceiverBase::ListenerEntry::call( const Message &message )
+{
+	// counted before mRemoved is checked, and removeListener() checks the count after setting it, so either the call is skipped or it's waited for
+	struct ScopedRunning {
+		ScopedRunning( ListenerEntry *entry ) : mRunning{ entry, sRunning }
+		{
+			entry->mNumRunning.fetch_add( 1 );
+			sRunning = &mRunning;
+		}
+		~ScopedRunning()
+		{
+			sRunning = mRunning.mNext;
+			mRunning.mEntry->mNumRunning.fetch_sub( 1 );
+			if( mRunning.mEntry->mRemoved.load() ) {
+				std::lock_guard<std::mutex> lock( sRunningMutex );
+				sRunningChanged.notify_all();
+			}
+		}
+		Running	mRunning;
+	} scopedRunning( this );
+	
+	if( ! mRemoved.load() )
+		mFn( message );
+}
+	
+//! The listeners compiled for lookup. Addresses without wildcards go in a hash map. Patterns are stored in
+//! a trie, keyed by the complete '/'-separated parts of the literal text before their first wildcard. A
+//! pattern can only match an address that starts with that text, so the trie only has to hand the
+//! patterns along the address' own path to patternMatch().
+struct ReceiverBase::Dispatch {
+	struct Node {
+		std::unordered_map<std::string, std::unique_ptr<Node>>	mChildren;
+		std::vector<size_t>										mPatterns;
+	};
+	
+	explicit Dispatch( const std::vector<std::shared_ptr<ListenerEntry>> &listeners );
+	//! Fills \a matches with the indices into mListeners of the listeners matching \a address, in the order they were set.
+	void findMatches( const ReceiverBase &receiver, const std::string &address, std::vector<size_t> *matches ) const;
+	
+	std::vector<std::shared_ptr<ListenerEntry>>	mListeners;
+	std::unordered_map<std::string, size_t>		mExact;
+	Node										mRoot;
+};
+
+ReceiverBase::Dispatch::Dispatch( const std::vector<std::shared_ptr<ListenerEntry>> &listeners )
+	: mListeners( listeners )
+{
+	for( size_t i = 0; i < mListeners.size(); ++i ) {
+		const std::string &address = mListeners[i]->mAddress;
+		const size_t wildcard = address.find_first_of( "?*[{" );
+		if( wildcard == std::string::npos ) {
+			mExact.emplace( address, i );
+			continue;
+		}
+		
+		Node *node = &mRoot;
+		size_t begin = 0, end;
+		while( ( end = address.find( '/', begin ) ) < wildcard ) {
+			auto &child = node->mChildren[address.substr( begin, end - begin )];
+			if( ! child )
+				child.reset( new Node );
+			node = child.get();
+			begin = end + 1;
+		}
+		node->mPatterns.push_back( i );
+	}
+}
+
+void ReceiverBase::Dispatch::findMatches( const ReceiverBase &receiver, const std::string &address, std::vector<size_t> *matches ) const
+{
+	matches->clear();
+	auto exact = mExact.find( address );
+	if( exact != mExact.end() )
+		matches->push_back( exact->second );
+	
+	const Node *node = &mRoot;
+	std::string part;
+	size_t begin = 0, end;
+	while( true ) {
+		for( size_t i : node->mPatterns ) {
+			if( receiver.patternMatch( address, mListeners[i]->mAddress ) )
+				matches->push_back( i );
+		}
+		if( ( end = address.find( '/', begin ) ) == std::string::npos )
+			break;
+		part.assign( address, begin, end - begin );
+		auto child = node->mChildren.find( part );
+		if( child == node->mChildren.end() )
+			break;
+		node = child->second.get();
+		begin = end + 1;
+	}
+	
+	if( matches->size() > 1 )
+		std::sort( matches->begin(), matches->end() );
+}
+
+ReceiverBase::~ReceiverBase()
+{
+}
+
 void ReceiverBase::setListener( const std::string &address, ListenerFn listener )
 {
 	std::lock_guard<std::mutex> lock( mListenerMutex );
 	auto foundListener = std::find_if( mListeners.begin(), mListeners.end(),
-	[address]( const std::pair<std::string, ListenerFn> &listener ) {
-		  return address == listener.first;
+	[address]( const std::shared_ptr<ListenerEntry> &listener ) {
+		  return address == listener->mAddress;
 	});
+	// a replaced listener is left to the dispatches already holding it
 	if( foundListener != mListeners.end() )
-		foundListener->second = listener;
+		*foundListener = std::make_shared<ListenerEntry>( address, listener );
 	else
-		mListeners.push_back( { address, listener } );
+		mListeners.push_back( std::make_shared<ListenerEntry>( address, listener ) );
+	// rebuilt by the next dispatch, so setting many listeners at once only compiles them once
+	mDispatchDirty.store( true );
 }
 
 void ReceiverBase::removeListener( const std::string &address )
 {
-	std::lock_guard<std::mutex> lock( mListenerMutex );
-	auto foundListener = std::find_if( mListeners.begin(), mListeners.end(),
-	[address]( const std::pair<std::string, ListenerFn> &listener ) {
-		  return address == listener.first;
-	});
-	if( foundListener != mListeners.end() )
+	std::shared_ptr<ListenerEntry> removed;
+	{
+		std::lock_guard<std::mutex> lock( mListenerMutex );
+		auto foundListener = std::find_if( mListeners.begin(), mListeners.end(),
+		[address]( const std::shared_ptr<ListenerEntry> &listener ) {
+			  return address == listener->mAddress;
+		});
+		if( foundListener == mListeners.end() )
+			return;
+		removed = *foundListener;
 		mListeners.erase( foundListener );
+		removed->mRemoved.store( true );
+		mDispatchDirty.store( true );
+	}
+	
+	// rebuilt now rather than by the next dispatch, so that dispatches starting from here on don't hold the listener at all
+	updateDispatch();
+	
+	// Dispatches in progress still hold it, but skip it from here on, so only the calls already running are waited for. The calls
+	// running on this thread are counted as blocked meanwhile, which lets a removeListener() on another thread waiting for them go on.
+	std::unique_lock<std::mutex> lock( sRunningMutex );
+	for( auto running = ListenerEntry::sRunning; running; running = running->mNext )
+		++running->mEntry->mNumBlocked;
+	if( ListenerEntry::sRunning )
+		sRunningChanged.notify_all();
+	
+	sRunningChanged.wait( lock, [&removed] { return removed->mNumRunning.load() <= removed->mNumBlocked; } );
+	
+	for( auto running = ListenerEntry::sRunning; running; running = running->mNext )
+		--running->mEntry->mNumBlocked;
+}
+
+void ReceiverBase::updateDispatch()
+{
+	if( ! mDispatchDirty.load() )
+		return;
+	
+	std::lock_guard<std::mutex> lock( mListenerMutex );
+	if( ! mDispatchDirty.exchange( false ) )
+		return;
+	// the previous one is freed once the last dispatch holding it is done
+	std::shared_ptr<const Dispatch> dispatch = std::make_shared<Dispatch>( mListeners );
+	std::lock_guard<std::mutex> dispatchLock( mDispatchMutex );
+	mDispatch.swap( dispatch );
 }
 
 void ReceiverBase::dispatchMethods( uint8_t *data, uint32_t size, const asio::ip::address &senderIpAddress, uint16_t senderPort )
@@ -1140,20 +1776,24 @@ void ReceiverBase::dispatchMethods( uint8_t *data, uint32_t size, const asio::ip
 	if( messages.empty() )
 		return;
 	
-	std::lock_guard<std::mutex> lock( mListenerMutex );
-	// iterate through all the messages and find matches with registered methods
+	updateDispatch();
+	std::shared_ptr<const Dispatch> dispatch;
+	{
+		std::lock_guard<std::mutex> lock( mDispatchMutex );
+		dispatch = mDispatch;
+	}
+	
+	// iterate through all the messages and find matches with registered methods, calling them without holding the lock
+	std::vector<size_t> matches;
 	for( auto & message : messages ) {
-		bool dispatchedOnce = false;
 		auto &address = message.getAddress();
 		message.mSenderIpAddress = senderIpAddress;
 		message.mSenderPort = senderPort;
-		for( auto & listener : mListeners ) {
-			if( patternMatch( address, listener.first ) ) {
-				listener.second( message );
-				dispatchedOnce = true;
-			}
-		}
-		if( ! dispatchedOnce ) {
+		dispatch->findMatches( *this, address, &matches );
+		for( size_t i : matches )
+			dispatch->mListeners[i]->call( message );
+		if( matches.empty() ) {
+			std::lock_guard<std::mutex> lock( mListenerMutex );
 			if( mDisregardedAddresses.count( address ) == 0 ) {
 				mDisregardedAddresses.insert( address );
 				CI_LOG_W("Message: " << address << " doesn't have a listener. Disregarding.");
@@ -34,6 +34,8 @@
 #endif
 #include "asio/asio.hpp"
 
+#include <atomic>
+#include <deque>
 #include <set>
 #include <mutex>
 
@@ -340,6 +342,8 @@ class Message {
 	
 	//! Create the OSC message and store it in cache.
 	void createCache() const;
+	//! Appends the complete OSC message to \a buffer, prefixed by its size, in the format of the cache.
+	void encode( ByteBuffer *buffer ) const;
 	//! Used by receiver to create the inner message.
 	bool bufferCache( uint8_t *data, size_t size );
 	
@@ -425,6 +429,83 @@ class Bundle {
 	friend class SenderUdp;
 };
 	
+class SenderBase;
+
+//! Encodes an OSC message straight into one of a Sender's reusable send buffers, without building a
+//! Message. Obtained from SenderBase::beginMessage(). Once the send buffers have grown to fit, writing
+//! and sending a message doesn't allocate. Produces the same bytes as sending the equivalent Message.
+//! Once the message has been sent, or discarded by the Sender starting another, appending to or
+//! sending the MessageWriter does nothing.
+class MessageWriter {
+  public:
+	//! Alias for the send OnErrorFn.
+	using OnErrorFn	= std::function<void( asio::error_code )>;
+	//! Alias for the send OnCompleteFn.
+	using OnCompleteFn = std::function<void()>;
+	
+	//! Appends an int32 to the back of the message.
+	MessageWriter&	append( int32_t v );
+	//! Appends a float to the back of the message.
+	MessageWriter&	append( float v );
+	//! Appends a string to the back of the message.
+	MessageWriter&	append( const std::string &v );
+	//! Appends a null-terminated c-string to the back of message.
+	MessageWriter&	append( const char v[] );
+	//! Appends an osc blob to the back of the message, copying \a size bytes from \a blob.
+	MessageWriter&	appendBlob( const void *blob, uint32_t size );
+	//! Appends an osc blob to the back of the message, copying the contents of \a buffer.
+	MessageWriter&	append( const ci::Buffer &buffer ) { return appendBlob( buffer.getData(), (uint32_t)buffer.getSize() ); }
+	//! Appends an osc blob to the back of the message without copying it. \a blob is sent alongside the
+	//! rest of the message with a scatter-gather send, and kept alive until the send completes. Only the
+	//! first blob of a message is sent this way, any others are copied.
+	MessageWriter&	append( const ci::BufferRef &blob );
+	//! Appends an OSC-timetag (NTP format) to the back of the message.
+	MessageWriter&	appendTimeTag( uint64_t v );
+	//! Appends the current UTP timestamp to the back of the message.
+	MessageWriter&	appendCurrentTime();
+	//! Appends a 'T'(True) or 'F'(False) to the back of the message.
+	MessageWriter&	append( bool v );
+	//! Appends a Null (or nil) to the back of the message.
+	MessageWriter&	appendNull() { if( mBuffer ) mTypeTags += static_cast<char>( ArgType::NULL_T ); return *this; }
+	//! Appends an Impulse (or IMPULSE) to the back of the message
+	MessageWriter&	appendImpulse() { if( mBuffer ) mTypeTags += static_cast<char>( ArgType::IMPULSE ); return *this; }
+	//! Appends an int64_t to the back of the message.
+	MessageWriter&	append( int64_t v );
+	//! Appends a float64 (or double) to the back of the message.
+	MessageWriter&	append( double v );
+	//! Appends an ascii character to the back of the message.
+	MessageWriter&	append( char v );
+	//! Appends a midi value to the back of the message.
+	MessageWriter&	appendMidi( uint8_t port, uint8_t status, uint8_t data1, uint8_t data2 );
+	
+	//! Appends \a arg to the back of the message.
+	template<typename T>
+	MessageWriter& operator<<( T&& arg ) { return append( std::forward<T>( arg ) ); }
+	
+	//! Finishes the message and sends it, or adds it to the current bundle when batching is enabled. Takes
+	//! optional /a onErrorFn and /a onCompleteFn, called as with SenderBase::send().
+	void send( OnErrorFn onErrorFn = nullptr, OnCompleteFn onCompleteFn = nullptr );
+	
+  private:
+	explicit MessageWriter( SenderBase *sender ) : mSender( sender ), mMessageBegin( 0 ), mArgumentsBegin( 0 ), mBlobOffset( 0 ) {}
+	
+	//! Starts a message to \a address at the back of \a buffer.
+	void begin( const ByteBufferRef &buffer, const std::string &address );
+	//! Removes an unfinished message from its buffer.
+	void discard();
+	//! Appends \a size bytes from \a data, followed by \a trailingZeros zeros.
+	void appendData( const void *data, size_t size, size_t trailingZeros = 0 );
+	
+	SenderBase		*mSender;
+	ByteBufferRef	mBuffer;			// the buffer of the unfinished message, if any
+	size_t			mMessageBegin, mArgumentsBegin;
+	std::string		mTypeTags;
+	ci::BufferRef	mBlob;				// sent by reference, inserted at mBlobOffset
+	size_t			mBlobOffset;
+	
+	friend class SenderBase;
+};
+	
 using PacketFramingRef = std::shared_ptr<class PacketFraming>;
 	
 class PacketFraming {
@@ -466,10 +547,27 @@ class SenderBase {
 	void send( const Message &message, OnErrorFn onErrorFn = nullptr, OnCompleteFn onCompleteFn = nullptr );
 	//! Sends \a bundle to the destination endpoint. Takes optional /a onErrorFn and /a onCompleteFn.
 	//! If error occurs, and an error callback is provided, it will be called with error_code information.
-	//! If send operation completes and /a onCompleteFn included, it will be called.
+	//! If send operation completes and /a onCompleteFn included, it will be called. When batching, the
+	//! current bundle is sent first.
 	void send( const Bundle &bundle, OnErrorFn onErrorFn = nullptr, OnCompleteFn onCompleteFn = nullptr );
+	//! Begins a message to \a address, encoded straight into a reusable send buffer. Append its arguments
+	//! to the returned MessageWriter and finish it with MessageWriter::send(). Beginning or sending another
+	//! message, or flushing, before then discards the unfinished one.
+	MessageWriter& beginMessage( const std::string &address );
+	//! Enables coalescing messages into bundles of at most \a maxPacketSize bytes. Messages sent with
+	//! send( const Message& ) or beginMessage() are added to the current bundle, which is sent once the next
+	//! message doesn't fit, on flush(), or when the socket's io_service next runs its handlers, which for
+	//! the App's io_service is once per frame. While enabled, messages have to be sent on the thread that
+	//! runs that io_service. The default fits a UDP datagram in an Ethernet frame. Callbacks passed with a
+	//! batched message are called when its bundle is sent. Disabling sends the current bundle.
+	void setBatchingEnabled( bool enable = true, size_t maxPacketSize = 1472 );
+	//! Returns whether messages are coalesced into bundles.
+	bool isBatchingEnabled() const { return mBatchingEnabled; }
+	//! Sends the current bundle of batched messages, if there is one.
+	void flush();
 	//! Closes the underlying connection to the socket. If an error occurs with either the underlying
-	//! close operations on the socket, throws osc::Exception with asio::error_code information.
+	//! close operations on the socket, throws osc::Exception with asio::error_code information. Batched
+	//! messages that haven't been flushed are dropped.
 	void close() { closeImpl(); }
 	
   protected:
@@ -482,12 +580,42 @@ class SenderBase {
 	
 	//! Abstract send function implemented by the network layer.
 	virtual void sendImpl( const ByteBufferRef &byteBuffer, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn ) = 0;
+	//! Sends \a byteBuffer like sendImpl(), with the contents of \a blob inserted at \a blobOffset. The size at the
+	//! front of \a byteBuffer already includes \a blob. The default implementation copies them into one buffer;
+	//! the network layer can override it to send them without copying.
+	virtual void sendBlobImpl( const ByteBufferRef &byteBuffer, size_t blobOffset, const ci::BufferRef &blob, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn );
+	//! Returns the io_service used to flush batched messages, or null if they're only flushed explicitly.
+	virtual asio::io_service* getIoServiceImpl() { return nullptr; }
 	//! Helper function to extract the address of an osc message if present.
 	static std::string extractOscAddress( const ByteBufferRef &transportData );
 	//! Abstract bind function implemented by the network layer
 	virtual void bindImpl() = 0;
 	//! Abstract close function implemented by the network layer
 	virtual void closeImpl() = 0;
+	
+  private:
+	//! Returns an empty send buffer, reusing one no send is holding any more if possible.
+	ByteBufferRef	acquireBuffer();
+	//! Starts a new bundle in mBatch.
+	void			beginBatch();
+	//! Sends, or adds to the current bundle, the message at \a messageBegin at the back of \a buffer.
+	void			commitMessage( const ByteBufferRef &buffer, size_t messageBegin, const ci::BufferRef &blob, size_t blobOffset, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn );
+	//! Sends mBatch, with \a blob inserted at \a blobOffset if it's non-null.
+	void			sendBatch( const ci::BufferRef &blob, size_t blobOffset );
+	
+	std::vector<ByteBufferRef>	mBufferPool;
+	size_t						mNextPooledBuffer = 0;
+	MessageWriter				mWriter{ this };
+	
+	bool						mBatchingEnabled = false;
+	size_t						mMaxPacketSize = 1472;
+	ByteBufferRef				mBatch;
+	size_t						mNumBatched = 0;
+	std::vector<std::pair<OnErrorFn, OnCompleteFn>>	mBatchCallbacks;
+	bool						mFlushPosted = false;
+	std::shared_ptr<int>		mFlushToken = std::make_shared<int>( 0 );	// expires with the sender, for posted flushes
+	
+	friend class MessageWriter;
 };
 	
 //! Represents an OSC Sender (called a \a server in the OSC spec) and implements the UDP
@@ -531,6 +659,11 @@ class SenderUdp : public SenderBase {
 	//! optional /a options. If error occurs, and SenderOptions provides an error callback, it will be
 	//! called with information. If /a options includes a completeFn, it will be called.
 	void sendImpl( const ByteBufferRef &data, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn ) override;
+	//! Sends the byte buffer /a data with /a blob inserted at /a blobOffset as a single datagram, using a
+	//! scatter-gather send.
+	void sendBlobImpl( const ByteBufferRef &data, size_t blobOffset, const ci::BufferRef &blob, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn ) override;
+	//! Returns the io_service of the underlying UDP socket.
+	asio::io_service* getIoServiceImpl() override { return &mSocket->get_io_service(); }
 	//! Closes the underlying UDP socket. If an error occurs, If an error occurs, throws osc::Exception.
 	void closeImpl() override;
 	
@@ -606,14 +739,39 @@ class SenderTcp : public SenderBase {
 	void bindImpl() override;
 	//! Sends the byte buffer /a data to the remote endpoint using the TCP socket, asynchronously. Takes
 	//! optional /a options. If error occurs, and SenderOptions provides an error callback, it will be
-	//! called with information. If /a options includes a completeFn, it will be called.
+	//! called with information. If /a options includes a completeFn, it will be called. Packets are written
+	//! whole, one at a time, in the order they were sent.
 	void sendImpl( const ByteBufferRef &data, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn ) override;
+	//! Writes the byte buffer /a data with /a blob inserted at /a blobOffset using a scatter-gather write, or
+	//! copies them together first when there's PacketFraming to encode them.
+	void sendBlobImpl( const ByteBufferRef &data, size_t blobOffset, const ci::BufferRef &blob, OnErrorFn onErrorFn, OnCompleteFn onCompleteFn ) override;
+	//! Returns the io_service of the underlying TCP socket.
+	asio::io_service* getIoServiceImpl() override { return &mSocket->get_io_service(); }
 	//! Closes the underlying TCP socket. If error occurs, throws osc::Exception.
 	void closeImpl() override;
 	
+	//! A packet to write, with the blob inserted at mBlobOffset if there is one.
+	struct PendingWrite {
+		ByteBufferRef	mData;
+		ci::BufferRef	mBlob;
+		size_t			mBlobOffset;
+		OnErrorFn		mOnErrorFn;
+		OnCompleteFn	mOnCompleteFn;
+	};
+	//! The packets waiting to be written. Shared with the handler of the write in progress, which may run after the SenderTcp is gone.
+	struct WriteQueue {
+		std::deque<PendingWrite>	mWrites;		// written one at a time, as a large one takes several sends
+		std::mutex					mMutex;
+	};
+	//! Queues \a write, and starts writing it if no other write is in progress.
+	void queueWrite( PendingWrite write );
+	//! Writes the packet at the front of \a queue to \a socket, then the ones after it. Called with the queue's mutex locked.
+	static void writeNext( const TcpSocketRef &socket, const std::shared_ptr<WriteQueue> &queue );
+	
 	TcpSocketRef			mSocket;
 	PacketFramingRef		mPacketFraming;
 	asio::ip::tcp::endpoint mLocalEndpoint, mRemoteEndpoint;
+	std::shared_ptr<WriteQueue>	mWriteQueue = std::make_shared<WriteQueue>();
 	
   public:
 	//! Non-copyable.
@@ -627,10 +785,13 @@ class SenderTcp : public SenderBase {
 };
 
 //! Represents an OSC Receiver(called a \a client in the OSC spec) and implements a unified
-//! interface without implementing any of the networking layer.
+//! interface without implementing any of the networking layer. Listeners may be set and removed on
+//! any thread while messages are dispatched on another. Once removeListener() returns, the listener
+//! isn't running on any other thread and won't be called again, so whatever it captured may be
+//! destroyed, unless it was removed from within a listener (see removeListener()).
 class ReceiverBase {
 public:
-	virtual ~ReceiverBase() = default;
+	virtual ~ReceiverBase();
 	//! Alias function representing a message callback.
 	using ListenerFn = std::function<void( const Message &message )>;
 	//! Alias container for callbacks.
@@ -643,9 +804,15 @@ public:
 	
 	//! Sets a callback, \a listener, to be called when receiving a message with \a address. If a ListenerFn
 	//! does not exist for a specific address, any messages with that address will be disregarded. If a ListenerFn
-	//! already exists for this address, \a listener will replace it.
+	//! already exists for this address, \a listener will replace it. Listeners are called without any lock held,
+	//! so they may set or remove listeners themselves, though messages already being dispatched still use the
+	//! listeners they started with.
 	void		setListener( const std::string &address, ListenerFn listener );
-	//! Removes the listener associated with \a address.
+	//! Removes the listener associated with \a address. Dispatches already in progress don't call it again,
+	//! and this waits for the calls to it still running on other threads to return, so it must not be called
+	//! while holding anything a listener waits on. Called from within a listener, it doesn't wait for the
+	//! listeners running on its own thread, nor for those on a thread that is itself waiting in removeListener(),
+	//! so that listeners removing each other from two threads don't wait on each other forever.
 	void		removeListener( const std::string &address );
 	
   protected:
@@ -670,14 +837,25 @@ public:
 	//! Matches the addresses of messages based on the OSC spec.
 	bool patternMatch( const std::string &lhs, const std::string &rhs ) const;
 	
+	//! Immutable lookup structure compiled from mListeners, defined in Osc.cpp.
+	struct Dispatch;
+	//! A listener set for an address, with the calls to it in progress. Defined in Osc.cpp.
+	struct ListenerEntry;
+	//! Rebuilds and publishes the Dispatch if the listeners changed since it was last built.
+	void updateDispatch();
+	
 	//! Abstract bind implementation function.
 	virtual void bindImpl() = 0;
 	//! Abstract close implementation function.
 	virtual void closeImpl() = 0;
 	
-	Listeners				mListeners;
+	std::vector<std::shared_ptr<ListenerEntry>>	mListeners;
 	std::mutex				mListenerMutex;
 	std::set<std::string>	mDisregardedAddresses;
+	
+	std::shared_ptr<const Dispatch>	mDispatch;			// each dispatch holds the one it started with, until it's done
+	std::mutex						mDispatchMutex;		// guards mDispatch
+	std::atomic<bool>				mDispatchDirty{ true };
 };
 	
 //! Represents an OSC Receiver(called a \a client in the OSC spec) and implements the UDP transport
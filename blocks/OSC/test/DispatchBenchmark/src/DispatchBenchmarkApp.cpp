@@ -0,0 +1,277 @@
+#include "cinder/app/App.h"
+#include "cinder/app/RendererGl.h"
+#include "cinder/gl/gl.h"
+
+#include "cinder/Log.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+#include "cinder/osc/Osc.h"
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+// Measures how many messages per second a ReceiverUdp can dispatch to a large set of listeners. A
+// sender thread floods the receiver over loopback with bundles of messages, while the receiver runs
+// its io_service on its own thread, so the dispatch rate isn't tied to the frame rate. Before that,
+// checkDispatch() verifies that the compiled lookup calls the same listeners as a linear search.
+
+const std::string destinationHost = "127.0.0.1";
+const uint16_t destinationPort = 10001;
+const uint16_t localPort = 10000;
+
+const int numRigs = 100;
+const int numSensors = 18;				// numRigs * numSensors exact listeners, plus 2 patterns per rig
+const int numMessagesPerBundle = 32;
+const int maxBundlesInFlight = 64;
+
+// Passes messages straight to dispatchMethods(), and compares the listeners called with the ones found by trying
+// patternMatch() on every listener in the order they were set, which is how messages were dispatched before the
+// listeners were compiled into a Dispatch.
+class DispatchCheckReceiver : public osc::ReceiverBase {
+  public:
+	void setListener( const std::string &address )
+	{
+		ReceiverBase::setListener( address, [this, address]( const osc::Message &) { mCalled.push_back( address ); } );
+		if( find( mAddresses.begin(), mAddresses.end(), address ) == mAddresses.end() )
+			mAddresses.push_back( address );
+	}
+
+	void removeListener( const std::string &address )
+	{
+		ReceiverBase::removeListener( address );
+		mAddresses.erase( remove( mAddresses.begin(), mAddresses.end(), address ), mAddresses.end() );
+	}
+
+	//! Returns whether a message to \a address is dispatched to the listeners a linear search finds, in the same order.
+	bool check( const std::string &address )
+	{
+		// a message without arguments: the address and an empty type tag string, each null-terminated and padded to 4 bytes
+		std::vector<uint8_t> data( address.begin(), address.end() );
+		data.resize( ( data.size() / 4 + 1 ) * 4, 0 );
+		data.insert( data.end(), { ',', 0, 0, 0 } );
+		mCalled.clear();
+		dispatchMethods( data.data(), (uint32_t)data.size(), asio::ip::address(), 0 );
+
+		std::vector<std::string> expected;
+		for( const auto &listenerAddress : mAddresses ) {
+			if( patternMatch( address, listenerAddress ) )
+				expected.push_back( listenerAddress );
+		}
+		if( mCalled != expected )
+			CI_LOG_E( "Dispatch mismatch for " << address << ": " << mCalled.size() << " listeners called, " << expected.size() << " expected" );
+		return mCalled == expected;
+	}
+
+  protected:
+	void bindImpl() override {}
+	void closeImpl() override {}
+
+	std::vector<std::string>	mAddresses, mCalled;
+};
+
+// Returns the number of addresses whose dispatch differed from the linear search. The same addresses and listeners are
+// generated on every run.
+int checkDispatch()
+{
+	int numMismatches = 0;
+
+	// wildcards at the end of a part, inside one, and at the end of the pattern, where '*' also matches any '/' that follows;
+	// exact listeners that a pattern matches too; and an address nothing matches
+	DispatchCheckReceiver receiver;
+	for( const char *address : { "/rig/1/a", "/rig/*", "/rig/1/*/x", "/r*g/1/a", "/rig/[!1]/a", "/rig/{1,2}/a", "/rig/?/a", "/rig/[0-2]/*", "/*/1/a" } )
+		receiver.setListener( address );
+	for( const char *address : { "/rig/1/a", "/rig/2/a", "/rig/3/a", "/rig/1/b/x", "/rig/1/b/c/x", "/rig/12/a", "/rig", "/rig/", "/other" } )
+		numMismatches += receiver.check( address ) ? 0 : 1;
+	// and once the exact listener is removed and a pattern replaced
+	receiver.removeListener( "/rig/1/a" );
+	receiver.setListener( "/rig/*" );
+	for( const char *address : { "/rig/1/a", "/rig/2/a", "/rig/1/b/x" } )
+		numMismatches += receiver.check( address ) ? 0 : 1;
+
+	// random sets of listeners, with the catch-all "/*" so that every address has at least one
+	Rand rnd( 5 );
+	const char *parts[] = { "a", "b", "ab", "1", "ba", "" };
+	const char *wildcards[] = { "*", "?", "[ab]", "[a-b]", "{a,b}", "a*", "?b", "[!a]" };
+	for( int round = 0; round < 200; ++round ) {
+		DispatchCheckReceiver random;
+		random.setListener( "/*" );
+		const int numListeners = 1 + rnd.nextInt( 60 );
+		for( int i = 0; i < numListeners; ++i ) {
+			std::string address;
+			for( int depth = 1 + rnd.nextInt( 4 ); depth > 0; --depth )
+				address += std::string( "/" ) + ( rnd.nextInt( 3 ) == 0 ? wildcards[rnd.nextInt( 8 )] : parts[rnd.nextInt( 5 )] );
+			random.setListener( address );
+			if( rnd.nextInt( 8 ) == 0 )
+				random.removeListener( address );
+		}
+		for( int i = 0; i < 300; ++i ) {
+			std::string address;
+			for( int depth = 1 + rnd.nextInt( 4 ); depth > 0; --depth )
+				address += std::string( "/" ) + parts[rnd.nextInt( 6 )];
+			numMismatches += random.check( address ) ? 0 : 1;
+		}
+	}
+
+	return numMismatches;
+}
+
+class DispatchBenchmarkApp : public App {
+  public:
+	DispatchBenchmarkApp();
+	void setup() override;
+	void update() override;
+	void draw() override;
+	void cleanup() override;
+
+	void sendLoop();
+
+	std::shared_ptr<asio::io_service>		mReceiverIoService, mSenderIoService;
+	std::shared_ptr<asio::io_service::work>	mReceiverWork;
+	std::thread								mReceiverThread, mSenderThread;
+	std::atomic<bool>						mSending;
+
+	osc::ReceiverUdp	mReceiver;
+	osc::SenderUdp		mSender;
+
+	std::atomic<uint64_t>	mNumDispatched, mNumSent;
+	uint64_t				mLastDispatched, mLastSent;
+	Timer					mTimer;
+	double					mDispatchedPerSecond, mSentPerSecond;
+};
+
+DispatchBenchmarkApp::DispatchBenchmarkApp()
+: mReceiverIoService( new asio::io_service ), mSenderIoService( new asio::io_service ),
+	mReceiverWork( new asio::io_service::work( *mReceiverIoService ) ), mSending( true ),
+	mReceiver( destinationPort, asio::ip::udp::v4(), *mReceiverIoService ),
+	mSender( localPort, destinationHost, destinationPort, asio::ip::udp::v4(), *mSenderIoService ),
+	mNumDispatched( 0 ), mNumSent( 0 ), mLastDispatched( 0 ), mLastSent( 0 ),
+	mDispatchedPerSecond( 0 ), mSentPerSecond( 0 )
+{
+}
+
+void DispatchBenchmarkApp::setup()
+{
+	const int numMismatches = checkDispatch();
+	console() << "dispatch check: " << ( numMismatches ? to_string( numMismatches ) + " mismatches" : "passed" ) << endl;
+
+	// Every message matches one exact listener and one of its rig's patterns
+	for( int rig = 0; rig < numRigs; ++rig ) {
+		const std::string prefix = "/rig/" + to_string( rig );
+		for( int sensor = 0; sensor < numSensors; ++sensor ) {
+			mReceiver.setListener( prefix + "/sensor/" + to_string( sensor ),
+			[&]( const osc::Message &msg ){
+				mNumDispatched.fetch_add( 1, std::memory_order_relaxed );
+			});
+		}
+		mReceiver.setListener( prefix + "/sensor/*", []( const osc::Message &msg ){} );
+		mReceiver.setListener( prefix + "/[!s]*", []( const osc::Message &msg ){} );
+	}
+
+	try {
+		mReceiver.bind();
+		mSender.bind();
+	}
+	catch( const osc::Exception &ex ) {
+		CI_LOG_E( "Error binding: " << ex.what() << " val: " << ex.value() );
+		quit();
+		return;
+	}
+
+	mReceiver.setAmountToReceive( 65536 );
+	mReceiver.listen(
+	[]( asio::error_code error, asio::ip::udp::endpoint endpoint ) -> bool {
+		if( error ) {
+			CI_LOG_E( "Error Listening: " << error.message() << " val: "
+					 << error.value() << " endpoint: " << endpoint );
+			return false;
+		}
+		else
+			return true;
+	});
+
+	mReceiverThread = std::thread( [this] { mReceiverIoService->run(); } );
+	mSenderThread = std::thread( [this] { sendLoop(); } );
+	mTimer.start();
+}
+
+void DispatchBenchmarkApp::sendLoop()
+{
+	Rand rnd( 1 );
+	std::vector<osc::Bundle> bundles( 16 );
+	for( auto &bundle : bundles ) {
+		for( int i = 0; i < numMessagesPerBundle; ++i ) {
+			osc::Message msg( "/rig/" + to_string( rnd.nextInt( numRigs ) ) + "/sensor/" + to_string( rnd.nextInt( numSensors ) ) );
+			msg.append( rnd.nextFloat() );
+			bundle.append( msg );
+		}
+	}
+
+	// Bounding the sends in flight keeps the sender from queueing without limit when it outpaces the receiver
+	int numInFlight = 0;
+	size_t next = 0;
+	while( mSending ) {
+		while( numInFlight < maxBundlesInFlight ) {
+			++numInFlight;
+			mSender.send( bundles[next++ % bundles.size()],
+			[&]( asio::error_code error ) {
+				--numInFlight;
+				CI_LOG_E( "Error sending: " << error.message() << " val: " << error.value() );
+			},
+			[&] {
+				--numInFlight;
+				mNumSent.fetch_add( numMessagesPerBundle, std::memory_order_relaxed );
+			});
+		}
+		mSenderIoService->run_one();
+		mSenderIoService->poll();
+		mSenderIoService->reset();
+	}
+	mSenderIoService->run();
+}
+
+void DispatchBenchmarkApp::update()
+{
+	const double seconds = mTimer.getSeconds();
+	if( seconds < 1 )
+		return;
+
+	const uint64_t dispatched = mNumDispatched.load(), sent = mNumSent.load();
+	mDispatchedPerSecond = ( dispatched - mLastDispatched ) / seconds;
+	mSentPerSecond = ( sent - mLastSent ) / seconds;
+	mLastDispatched = dispatched;
+	mLastSent = sent;
+	mTimer.start();
+
+	console() << "sent " << mSentPerSecond << " messages/s, dispatched " << mDispatchedPerSecond << " messages/s" << endl;
+}
+
+void DispatchBenchmarkApp::draw()
+{
+	gl::clear( GL_COLOR_BUFFER_BIT );
+	gl::setMatricesWindow( getWindowSize() );
+
+	gl::drawString( to_string( numRigs * ( numSensors + 2 ) ) + " listeners", vec2( 20, 20 ) );
+	gl::drawString( "sent: " + to_string( (int)mSentPerSecond ) + " messages/s", vec2( 20, 40 ) );
+	gl::drawString( "dispatched: " + to_string( (int)mDispatchedPerSecond ) + " messages/s", vec2( 20, 60 ) );
+}
+
+void DispatchBenchmarkApp::cleanup()
+{
+	mSending = false;
+	if( mSenderThread.joinable() )
+		mSenderThread.join();
+	mReceiverWork.reset();
+	mReceiverIoService->stop();
+	if( mReceiverThread.joinable() )
+		mReceiverThread.join();
+}
+
+auto settingsFunc = []( App::Settings *settings ) {
+#if defined( CINDER_MSW )
+	settings->setConsoleWindowEnabled();
+#endif
+	settings->setMultiTouchEnabled( false );
+};
+
+CINDER_APP( DispatchBenchmarkApp, RendererGl, settingsFunc )
@@ -0,0 +1,204 @@
+#include "cinder/app/App.h"
+#include "cinder/app/RendererGl.h"
+#include "cinder/gl/gl.h"
+
+#include "cinder/Log.h"
+#include "cinder/Timer.h"
+#include "cinder/osc/Osc.h"
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+// Measures how many messages per second a SenderUdp can send over loopback, and how many allocations
+// each send makes, for each way of sending. Press 1-4 to switch between them. The sender runs on the
+// App's io_service, so batched messages are flushed once per frame, while the receiver counts what
+// arrives on its own thread.
+
+const std::string destinationHost = "127.0.0.1";
+const uint16_t destinationPort = 10001;
+const uint16_t localPort = 10000;
+
+const int numMessagesPerFrame = 500;
+
+// Counts the allocations made on the thread sending, while it's sending
+static std::atomic<uint64_t> sNumAllocations( 0 );
+static thread_local bool sCountAllocations = false;
+
+void* operator new( size_t size )
+{
+	if( sCountAllocations )
+		sNumAllocations.fetch_add( 1, std::memory_order_relaxed );
+	if( void *ptr = malloc( size ) )
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete( void *ptr ) noexcept
+{
+	free( ptr );
+}
+
+class SendBenchmarkApp : public App {
+  public:
+	enum Mode { MESSAGE, MESSAGE_REUSED, WRITER, WRITER_BATCHED, NUM_MODES };
+
+	SendBenchmarkApp();
+	void setup() override;
+	void keyDown( KeyEvent event ) override;
+	void update() override;
+	void draw() override;
+	void cleanup() override;
+
+	void setMode( Mode mode );
+
+	std::shared_ptr<asio::io_service>		mReceiverIoService;
+	std::shared_ptr<asio::io_service::work>	mReceiverWork;
+	std::thread								mReceiverThread;
+
+	osc::ReceiverUdp	mReceiver;
+	osc::SenderUdp		mSender;
+	osc::Message		mReusedMessage;
+
+	Mode					mMode;
+	std::atomic<uint64_t>	mNumReceived;
+	uint64_t				mNumSent, mLastReceived, mLastSent, mLastAllocations;
+	Timer					mTimer;
+	double					mSentPerSecond, mReceivedPerSecond, mAllocationsPerSend;
+};
+
+SendBenchmarkApp::SendBenchmarkApp()
+: mReceiverIoService( new asio::io_service ), mReceiverWork( new asio::io_service::work( *mReceiverIoService ) ),
+	mReceiver( destinationPort, asio::ip::udp::v4(), *mReceiverIoService ),
+	mSender( localPort, destinationHost, destinationPort ),
+	mMode( MESSAGE ), mNumReceived( 0 ), mNumSent( 0 ), mLastReceived( 0 ), mLastSent( 0 ), mLastAllocations( 0 ),
+	mSentPerSecond( 0 ), mReceivedPerSecond( 0 ), mAllocationsPerSend( 0 )
+{
+}
+
+void SendBenchmarkApp::setup()
+{
+	mReceiver.setListener( "/param/*",
+	[&]( const osc::Message &msg ){
+		mNumReceived.fetch_add( 1, std::memory_order_relaxed );
+	});
+
+	try {
+		mReceiver.bind();
+		mSender.bind();
+	}
+	catch( const osc::Exception &ex ) {
+		CI_LOG_E( "Error binding: " << ex.what() << " val: " << ex.value() );
+		quit();
+		return;
+	}
+
+	mReceiver.setAmountToReceive( 65536 );
+	mReceiver.listen(
+	[]( asio::error_code error, asio::ip::udp::endpoint endpoint ) -> bool {
+		if( error ) {
+			CI_LOG_E( "Error Listening: " << error.message() << " val: "
+					 << error.value() << " endpoint: " << endpoint );
+			return false;
+		}
+		else
+			return true;
+	});
+	mReceiverThread = std::thread( [this] { mReceiverIoService->run(); } );
+
+	mReusedMessage.setAddress( "/param/0" );
+	mReusedMessage.append( 0.0f );
+	mReusedMessage.append( 0 );
+	setMode( MESSAGE );
+}
+
+void SendBenchmarkApp::setMode( Mode mode )
+{
+	mMode = mode;
+	mSender.setBatchingEnabled( mode == WRITER_BATCHED );
+	mTimer.start();
+	mLastReceived = mNumReceived;
+	mLastSent = mNumSent;
+	mLastAllocations = sNumAllocations;
+}
+
+void SendBenchmarkApp::keyDown( KeyEvent event )
+{
+	if( event.getChar() >= '1' && event.getChar() < '1' + NUM_MODES )
+		setMode( Mode( event.getChar() - '1' ) );
+}
+
+void SendBenchmarkApp::update()
+{
+	// the addresses are short enough not to allocate
+	sCountAllocations = true;
+	for( int i = 0; i < numMessagesPerFrame; ++i ) {
+		const std::string address = "/param/" + to_string( i % 8 );
+		switch( mMode ) {
+			case MESSAGE: {
+				osc::Message msg( address );
+				msg.append( (float)i );
+				msg.append( i );
+				mSender.send( msg );
+			}
+			break;
+			case MESSAGE_REUSED:
+				mSender.send( mReusedMessage );
+			break;
+			case WRITER:
+			case WRITER_BATCHED:
+				mSender.beginMessage( address ).append( (float)i ).append( i ).send();
+			break;
+			default: break;
+		}
+	}
+	mNumSent += numMessagesPerFrame;
+	sCountAllocations = false;
+
+	const double seconds = mTimer.getSeconds();
+	if( seconds < 1 )
+		return;
+
+	const uint64_t received = mNumReceived, allocations = sNumAllocations;
+	mSentPerSecond = ( mNumSent - mLastSent ) / seconds;
+	mReceivedPerSecond = ( received - mLastReceived ) / seconds;
+	mAllocationsPerSend = double( allocations - mLastAllocations ) / ( mNumSent - mLastSent );
+	mLastSent = mNumSent;
+	mLastReceived = received;
+	mLastAllocations = allocations;
+	mTimer.start();
+
+	console() << "mode " << mMode + 1 << ": sent " << mSentPerSecond << " messages/s, received " << mReceivedPerSecond
+		<< " messages/s, " << mAllocationsPerSend << " allocations/send" << endl;
+}
+
+void SendBenchmarkApp::draw()
+{
+	static const char *modeNames[NUM_MODES] = { "1: send( Message ), a new Message each", "2: send( Message ), reused",
+		"3: beginMessage()", "4: beginMessage(), batched" };
+
+	gl::clear( GL_COLOR_BUFFER_BIT );
+	gl::setMatricesWindow( getWindowSize() );
+
+	gl::drawString( modeNames[mMode], vec2( 20, 20 ) );
+	gl::drawString( "sent: " + to_string( (int)mSentPerSecond ) + " messages/s", vec2( 20, 40 ) );
+	gl::drawString( "received: " + to_string( (int)mReceivedPerSecond ) + " messages/s", vec2( 20, 60 ) );
+	gl::drawString( "allocations: " + to_string( mAllocationsPerSend ) + " per send", vec2( 20, 80 ) );
+}
+
+void SendBenchmarkApp::cleanup()
+{
+	mReceiverWork.reset();
+	mReceiverIoService->stop();
+	if( mReceiverThread.joinable() )
+		mReceiverThread.join();
+}
+
+auto settingsFunc = []( App::Settings *settings ) {
+#if defined( CINDER_MSW )
+	settings->setConsoleWindowEnabled();
+#endif
+	settings->setMultiTouchEnabled( false );
+};
+
+CINDER_APP( SendBenchmarkApp, RendererGl, settingsFunc )
@@ -25,8 +25,10 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Buffer.h"
+#include "cinder/Stream.h"
 
 #include <string>
+#include <vector>
 
 namespace cinder {
 
@@ -44,4 +46,47 @@ Buffer fromBase64( const Buffer &input );
 //! Converts Base64-encoded data \a input into unencoded data.
 Buffer fromBase64( const void *input, size_t inputSize );
 
+//! Reads \a input to its end and writes it Base64-encoded to \a output a chunk at a time, so neither has to be held in memory in full. If \a charsPerLine > 0, carriage returns (\n) are inserted every \a charsPerLine characters, rounded down to the nearest multiple of 4.
+void toBase64( const IStreamRef &input, const OStreamRef &output, int charsPerLine = 0 );
+//! Reads Base64-encoded data from \a input to its end and writes the unencoded data to \a output a chunk at a time.
+void fromBase64( const IStreamRef &input, const OStreamRef &output );
+
+//! Encodes data passed to write() in any number of pieces to an OStream, producing the same output as toBase64() does for the data as a whole. finish() must be called after the last write().
+class CI_API Base64Encoder {
+  public:
+	//! If \a charsPerLine > 0, carriage returns (\n) are inserted every \a charsPerLine characters, rounded down to the nearest multiple of 4.
+	Base64Encoder( const OStreamRef &output, int charsPerLine = 0 );
+
+	//! Encodes \a size bytes of \a data. Up to two bytes are held back until the next call completes their group of three.
+	void	write( const void *data, size_t size );
+	//! Writes the last, padded group. The encoder can then be used for a new encoding.
+	void	finish();
+
+  private:
+	void	flushBuffer( char *end );
+
+	OStreamRef			mOutput;
+	size_t				mGroupsPerLine, mGroupsOnLine;
+	uint8_t				mCarry[3];
+	size_t				mNumCarry;
+	std::vector<char>	mBuffer;
+};
+
+//! Decodes Base64-encoded data passed to write() in any number of pieces to an OStream, producing the same output as fromBase64() does for the data as a whole. finish() must be called after the last write().
+class CI_API Base64Decoder {
+  public:
+	Base64Decoder( const OStreamRef &output );
+
+	//! Decodes \a size characters of \a encoded. Characters outside the Base64 alphabet, such as line breaks and padding, are skipped.
+	void	write( const void *encoded, size_t size );
+	//! Writes the bytes of a last, incomplete group. The decoder can then be used for a new decoding.
+	void	finish();
+
+  private:
+	OStreamRef				mOutput;
+	uint32_t				mBits;
+	int						mNumSextets;
+	std::vector<uint8_t>	mBuffer;
+};
+
 } // namespace cinder
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Exception.h"
+#include "cinder/Frustum.h"
+#include "cinder/Ray.h"
+#include "cinder/TriMesh.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class Bvh>	BvhRef;
+
+/** \brief Bounding volume hierarchy over the triangles of a mesh, for fast ray casting, overlap and closest-point queries.
+ *
+ *  The hierarchy is built top-down using the surface area heuristic (SAH), evaluated over a fixed number of bins per axis.
+ *  Large meshes are built in parallel. The Bvh keeps its own copy of the positions and indices, so the source mesh may be
+ *  discarded after construction. When the positions change but the triangles stay the same, refit() updates the bounds
+ *  much faster than rebuilding, at the cost of query performance if the deformation is large.
+ *
+ *  Triangles are identified by their index in the source mesh, so triangle \c i is formed by indices 3i, 3i+1 and 3i+2.
+**/
+class CI_API Bvh {
+  public:
+	class CI_API Options {
+	  public:
+		Options() : mMaxLeafSize( 4 ), mNumBins( 16 ), mParallel( true ) {}
+
+		//! Sets the number of triangles below which a node may become a leaf. Nodes with more triangles are only left unsplit when all triangle centroids coincide. Default is \c 4.
+		Options&	maxLeafSize( int size ) { mMaxLeafSize = size; return *this; }
+		//! Sets the number of bins per axis used to evaluate the surface area heuristic. More bins produce a slightly better tree, but a slower build. Default is \c 16.
+		Options&	numBins( int bins ) { mNumBins = bins; return *this; }
+		//! Sets whether large meshes are built and refit using multiple threads. Default is \c true.
+		Options&	parallel( bool parallel = true ) { mParallel = parallel; return *this; }
+
+		int			getMaxLeafSize() const { return mMaxLeafSize; }
+		int			getNumBins() const { return mNumBins; }
+		bool		isParallel() const { return mParallel; }
+
+	  protected:
+		int		mMaxLeafSize, mNumBins;
+		bool	mParallel;
+	};
+
+	//! The result of a ray or closest-point query.
+	struct Hit {
+		//! Index of the triangle in the source mesh.
+		uint32_t	triangle;
+		//! Distance along the ray, in multiples of the length of its direction, or distance from the query point.
+		float		distance;
+		//! Position of the hit.
+		vec3		position;
+		//! Barycentric coordinates of the hit relative to the second and third vertex of the triangle. The weight of the first vertex is 1 - x - y.
+		vec2		barycentric;
+	};
+
+	//! Creates an empty Bvh.
+	Bvh();
+	//! Builds a Bvh over the triangles of \a mesh, which must have 3D positions.
+	Bvh( const TriMesh &mesh, const Options &options = Options() );
+	//! Builds a Bvh over the triangles of \a source.
+	Bvh( const geom::Source &source, const Options &options = Options() );
+	//! Builds a Bvh over \a numIndices / 3 triangles formed from \a indices into \a positions.
+	Bvh( const vec3 *positions, size_t numPositions, const uint32_t *indices, size_t numIndices, const Options &options = Options() );
+
+	static BvhRef	create( const TriMesh &mesh, const Options &options = Options() ) { return std::make_shared<Bvh>( mesh, options ); }
+	static BvhRef	create( const geom::Source &source, const Options &options = Options() ) { return std::make_shared<Bvh>( source, options ); }
+
+	//! Rebuilds the Bvh over \a numIndices / 3 triangles formed from \a indices into \a positions.
+	void	build( const vec3 *positions, size_t numPositions, const uint32_t *indices, size_t numIndices );
+
+	//! Updates the positions of the mesh and the bounds of every node, keeping the structure of the hierarchy. \a numPositions must match the mesh the Bvh was built from.
+	void	refit( const vec3 *positions, size_t numPositions );
+	//! Updates the positions from \a mesh, which must have the same vertices as the mesh the Bvh was built from. \sa refit( const vec3*, size_t )
+	void	refit( const TriMesh &mesh );
+
+	//! Returns \c true if \a ray hits a triangle at a distance between 0 and \a maxDistance, and stores the closest hit in \a result, which may be \c nullptr. Backfaces are not culled.
+	bool	intersect( const Ray &ray, Hit *result, float maxDistance = FLT_MAX ) const;
+	//! Returns \c true if \a ray hits any triangle at a distance between 0 and \a maxDistance. Faster than intersect() as the traversal stops at the first hit found, which makes it suitable for occlusion tests.
+	bool	intersectAny( const Ray &ray, float maxDistance = FLT_MAX ) const;
+	//! Appends every hit of \a ray at a distance between 0 and \a maxDistance to \a result, sorted by distance. Returns the number of hits.
+	size_t	intersectAll( const Ray &ray, std::vector<Hit> *result, float maxDistance = FLT_MAX ) const;
+
+	//! Appends the index of every triangle which overlaps \a box to \a result. Returns the number of triangles appended.
+	size_t	query( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const;
+	//! Appends the index of every triangle which overlaps \a frustum to \a result. Returns the number of triangles appended. Like Frustum::intersects(), this is conservative, and may include triangles just outside the corners of the frustum.
+	size_t	query( const Frustum &frustum, std::vector<uint32_t> *result ) const;
+
+	//! Returns \c true if a triangle lies within \a maxDistance of \a point, and stores the closest point on the mesh in \a result, which may be \c nullptr.
+	bool	calcClosestPoint( const vec3 &point, Hit *result, float maxDistance = FLT_MAX ) const;
+
+	//! Returns the number of triangles.
+	size_t	getNumTriangles() const { return mTriangleIds.size(); }
+	//! Returns the number of nodes in the hierarchy.
+	size_t	getNumNodes() const { return mNodes.size(); }
+	//! Returns the bounds of the whole mesh.
+	AxisAlignedBox	getBounds() const;
+	//! Returns the number of bytes used by the hierarchy and its copy of the mesh.
+	size_t	getMemoryUsage() const;
+	//! Returns the options used to build the Bvh.
+	const Options&	getOptions() const { return mOptions; }
+
+  protected:
+	//! A node in the hierarchy. Interior nodes store their children at mFirst and mFirst + 1. Leaves store mCount triangles starting at mFirst.
+	struct Node {
+		vec3		mMin;
+		uint32_t	mFirst;
+		vec3		mMax;
+		uint32_t	mCount;
+
+		bool	isLeaf() const { return mCount != 0; }
+	};
+
+	struct BuildData;
+
+	//! Appends the source index of every triangle below node \a nodeIndex to \a result.
+	void	appendSubtree( uint32_t nodeIndex, std::vector<uint32_t> *result ) const;
+
+	Options					mOptions;
+	std::vector<Node>		mNodes;
+	std::vector<vec3>		mPositions;
+	//! Triangle indices in leaf order, 3 per triangle.
+	std::vector<uint32_t>	mIndices;
+	//! Index of each triangle in the source mesh, in leaf order.
+	std::vector<uint32_t>	mTriangleIds;
+};
+
+class CI_API BvhExc : public Exception {
+  public:
+	BvhExc( const std::string &description ) : Exception( description ) {}
+};
+
+} // namespace cinder
@@ -38,6 +38,7 @@
 namespace cinder {
 
 class Watch;
+class FileWatcherNative;
 typedef std::shared_ptr<class FileWatcher>	FileWatcherRef;
 
 //! Event type returned in callbacks when one more watched files have been modified.
@@ -61,7 +62,9 @@ class WatchEvent {
 
 //! FileMonitor provides a system for monitoring the filesystem for changes at runtime using callbacks.
 //!
-//! Performs file watching asynchronously, however all callbacks will be emitted on the main thread. It is advisable to capture
+//! Performs file watching asynchronously, however all callbacks will be emitted on the main thread. Where the platform supports it
+//! (inotify on Linux), changes are detected from operating system notifications rather than by polling each file's modification time,
+//! \see setBackend(). It is advisable to capture
 //! the resulting signals::Connection with with some sort of scope controlling to ensure that your callbacks are disconnected
 //! when your object is destroyed. \see signals::ScopedConnection, signals::ConnectionList.
 //!
@@ -73,6 +76,15 @@ class CI_API FileWatcher : private Noncopyable {
 	FileWatcher();
 	~FileWatcher();
 
+	//! Mechanism used to detect changes on disk
+	enum class Backend {
+		//! Periodically compares the modification time of every watched file, at the thread update interval
+		POLLING,
+		//! Receives change notifications from the operating system (inotify on Linux), only examining files that were reported
+		//! as changed. Falls back to POLLING on platforms without native support or if notifications cannot be initialized.
+		NATIVE
+	};
+
 	//! Optional parameters provided to watch()
 	struct Options {
 		//! If true (default), the callback is fired directly after the watch is added, before the call to watch() returns.
@@ -105,6 +117,11 @@ class CI_API FileWatcher : private Noncopyable {
 	//! Adds the files in \a filePaths to the watch list, with optional \a options.
 	signals::Connection watch( const std::vector<fs::path> &filePaths, const Options &options, const std::function<void ( const WatchEvent& )> &callback );
 
+	//! Adds the directory at \a directoryPath and all of its subdirectories to the watch list. \a callback receives the files that were created or modified. With Options::callOnWatch(), the initial callback receives \a directoryPath itself.
+	signals::Connection watchDirectory( const fs::path &directoryPath, const std::function<void ( const WatchEvent& )> &callback );
+	//! Adds the directory at \a directoryPath and all of its subdirectories to the watch list, with optional \a options.
+	signals::Connection watchDirectory( const fs::path &directoryPath, const Options &options, const std::function<void ( const WatchEvent& )> &callback );
+
 	//! Removes any watches for \a filePath
 	void	unwatch( const fs::path &filePath );
 	//! Removes any watches for \a filePaths
@@ -129,12 +146,29 @@ class CI_API FileWatcher : private Noncopyable {
 	//! Returns the update time interval in seconds for the polling thread. \default is 0.02 seconds.
 	double		getThreadUpdateInterval() const				{ return mThreadUpdateInterval; }
 
+	//! Sets the mechanism used to detect changes. \default Backend::NATIVE, which is used where available.
+	void		setBackend( Backend backend );
+	//! Returns the requested Backend.
+	Backend		getBackend() const							{ return mBackend; }
+	//! Returns whether changes are currently being detected from operating system notifications, rather than by polling.
+	bool		isNativeBackendActive() const;
+	//! Returns whether the platform supports Backend::NATIVE.
+	static bool	isNativeBackendAvailable();
+
+	//! Sets the time in seconds the native backend waits after the last notification for a file before reporting it, so that a burst of writes results in a single callback.
+	//! A file that is written continuously is still reported once 10 intervals have passed since its first notification. \default is 0.01 seconds.
+	void		setDebounceInterval( double seconds )		{ mDebounceInterval = seconds; }
+	//! Returns the time in seconds the native backend waits after the last notification for a file before reporting it. \default is 0.01 seconds.
+	double		getDebounceInterval() const					{ return mDebounceInterval; }
+
   private:
 
+	signals::Connection	addWatch( Watch *watch, const Options &options, const std::function<void ( const WatchEvent& )> &callback );
 	void	configureWatchPolling();
 	void	connectAppUpdate();
 	void	stopWatchPolling();
 	void	threadEntry();
+	void	threadEntryNative();
 
 	std::list<std::unique_ptr<Watch>>	mWatchList;
 	mutable std::recursive_mutex		mMutex;
@@ -143,6 +177,10 @@ class CI_API FileWatcher : private Noncopyable {
 	std::atomic<double>					mThreadUpdateInterval		= { 0.02 };
 	std::atomic<bool>					mWatchingEnabled			= { true };
 	std::atomic<bool>					mConnectToAppUpdateEnabled	= { true };
+	std::atomic<double>					mDebounceInterval			= { 0.01 };
+	Backend								mBackend					= Backend::NATIVE;
+	std::unique_ptr<FileWatcherNative>	mNative;
+	bool								mNativeNeedsPrune			= false;
 	signals::Connection					mConnectionAppUpdate;
 };
 
@@ -37,6 +37,7 @@
 #include <map>
 #include <algorithm>
 #include <array>
+#include <type_traits>
 
 // Forward declarations in cinder::
 namespace cinder {
@@ -73,11 +74,37 @@ CI_API std::string primitiveToString( Primitive primitive );
 CI_API void copyData( uint8_t srcDimensions, const float *srcData, size_t numElements, uint8_t dstDimensions, size_t dstStrideBytes, float *dstData );
 //! Utility function for copying attribute data. Does the right thing to convert \a srcDimensions to \a dstDimensions. Stride of \c 0 implies tightly packed data.
 CI_API void copyData( uint8_t srcDimensions, size_t srcStrideBytes, const float *srcData, size_t numElements, uint8_t dstDimensions, size_t dstStrideBytes, float *dstData );
+//! Utility function for calculating normals from indexed triangles by summing the normals of the triangles which share each vertex. If \a weighted is \c true, larger triangles contribute more. Triangles with a zero-length edge are ignored. Runs in parallel for large meshes.
+CI_API void calculateNormals( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, bool weighted, std::vector<vec3> *resultNormals );
 //! Utility function for calculating tangents and bitangents from indexed geometry. \a resultBitangents may be NULL if not needed.
 CI_API void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const vec2 *texCoords, std::vector<vec3> *resultTangents, std::vector<vec3> *resultBitangents );
 //! Utility function for calculating tangents and bitangents from indexed geometry and 3D texture coordinates. \a resultBitangents may be NULL if not needed.
 CI_API void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const vec3 *texCoords, std::vector<vec3> *resultTangents, std::vector<vec3> *resultBitangents );
 
+//! Post-transform vertex cache statistics of indexed triangles, as calculated by calculateVertexCacheStatistics().
+struct CI_API VertexCacheStatistics {
+	//! Average cache miss ratio: the number of vertices transformed per triangle. Ranges from 3 down to about 0.5 for a well ordered regular grid.
+	float	acmr;
+	//! Average transform to vertex ratio: the number of vertices transformed per vertex referenced. \c 1 is optimal.
+	float	atvr;
+};
+
+//! Utility function which simulates a FIFO post-transform vertex cache of \a cacheSize vertices while drawing indexed triangles.
+CI_API VertexCacheStatistics calculateVertexCacheStatistics( size_t numIndices, const uint32_t *indices, size_t numVertices, size_t cacheSize = 16 );
+//! Utility function which reorders indexed triangles in place to reduce misses in a post-transform vertex cache of \a cacheSize vertices, using Tom Forsyth's linear-speed algorithm.
+CI_API void optimizeVertexCache( size_t numIndices, uint32_t *indices, size_t numVertices, size_t cacheSize = 16 );
+/** Utility function which reorders indexed triangles in place to reduce overdraw, independent of the view. The triangles should already be ordered by optimizeVertexCache().
+	They are split into clusters whose cache miss ratio is at most \a threshold times that of the input, and the clusters facing away from the center of the mesh are moved first. */
+CI_API void optimizeOverdraw( size_t numIndices, uint32_t *indices, size_t numVertices, const vec3 *positions, float threshold = 1.05f, size_t cacheSize = 16 );
+/** Utility function which orders vertices by their first use in \a indices, improving the locality of vertex fetches. Stores the new index of each vertex in \a resultRemap,
+	with unused vertices placed last in their original order. Returns the number of used vertices. */
+CI_API size_t calculateVertexFetchRemap( size_t numIndices, const uint32_t *indices, size_t numVertices, std::vector<uint32_t> *resultRemap );
+/** Utility function which simplifies indexed triangles by collapsing edges in order of their quadric error, until at most \a targetNumIndices remain or
+	no edge can be collapsed within \a maxError, a distance in the units of \a positions. Stores the remaining triangles in \a resultIndices, which refer to the
+	original vertices. Vertices shared by texture seams or other attribute discontinuities are kept. If \a resultError is not \c nullptr, it is set to the
+	largest error of the collapses, an estimate of the distance of the result from the original surface. Returns the number of indices in \a resultIndices. */
+CI_API size_t simplify( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, size_t targetNumIndices, float maxError, std::vector<uint32_t> *resultIndices, float *resultError = nullptr );
+
 struct CI_API AttribInfo {
 	AttribInfo( const Attrib &attrib, uint8_t dims, size_t stride, size_t offset, uint32_t instanceDivisor = 0 )
 		: mAttrib( attrib ), mDims( dims ), mDataType( DataType::FLOAT ), mStride( stride ), mOffset( offset ), mInstanceDivisor( instanceDivisor )
@@ -136,6 +163,27 @@ class CI_API BufferLayout {
 	std::vector<AttribInfo>		mAttribs;
 };
 
+//! Accumulates a 64-bit FNV-1a hash of the parameters that determine the geometry of a Source or Modifier. \sa Source::hashContent()
+class CI_API ContentHash {
+  public:
+	ContentHash() : mHash( 14695981039346656037ULL ) {}
+
+	//! Adds \a size bytes at \a data to the hash.
+	ContentHash&	add( const void *data, size_t size );
+	//! Adds the bytes of \a value, such as a scalar, vector, matrix, color or std::array of them. Its type must not contain padding or pointers.
+	template<typename T>
+	ContentHash&	add( const T &value )
+	{
+		static_assert( std::is_standard_layout<T>::value && ! std::is_pointer<T>::value, "ContentHash::add() requires a type whose bytes are its value" );
+		return add( &value, sizeof( T ) );
+	}
+
+	uint64_t		get() const { return mHash; }
+
+  private:
+	uint64_t	mHash;
+};
+
 class CI_API Source {
   public:
 	virtual ~Source() {}
@@ -147,6 +195,9 @@ class CI_API Source {
 	
 	virtual void		loadInto( Target *target, const AttribSet &requestedAttribs ) const = 0;
 	virtual Source*		clone() const = 0;
+	/** Adds every parameter that determines the geometry to \a hash and returns \c true, which lets SourceMods memoize chains containing this Source.
+		Returns \c false by default, as for a Source whose geometry depends on external state. Subclasses which add parameters must override it again. **/
+	virtual bool		hashContent( ContentHash* /*hash*/ ) const { return false; }
 
   protected:
 	//! Builds a sequential list of vertices to simulate an indexed geometry when Source is non-indexed. Assumes \a dest contains storage for getNumVertices() entries
@@ -210,6 +261,9 @@ class CI_API Modifier {
 	virtual AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const;
 	
 	virtual void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const = 0;
+	/** Adds every parameter that determines the result of process() to \a hash and returns \c true, which lets SourceMods memoize chains containing
+		this Modifier. Returns \c false by default, as for a Modifier which calls user functions or has side effects, like Bounds. **/
+	virtual bool		hashContent( ContentHash* /*hash*/ ) const { return false; }
 };
 
 class CI_API Rect : public Source {
@@ -233,6 +287,7 @@ class CI_API Rect : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Rect*		clone() const override { return new Rect( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mPositions ).add( mTexCoords ).add( mColors ).add( mHasColors ); return true; }
 
   protected:
 	void					setDefaultColors();
@@ -261,6 +316,7 @@ class CI_API RoundedRect : public Source {
 	AttribSet		getAvailableAttribs() const override;
 	void			loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	RoundedRect*	clone() const override { return new RoundedRect( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mRectPositions ).add( mRectTexCoords ).add( mColors ).add( mHasColors ).add( mSubdivisions ).add( mCornerRadius ); return true; }
 	
   protected:
 	void updateVertexCount();
@@ -297,6 +353,7 @@ class CI_API Cube : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Cube*		clone() const override { return new Cube( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mSubdivisions ).add( mSize ).add( mHasColors ).add( mColors ); return true; }
 
   protected:
 	ivec3					mSubdivisions;
@@ -319,6 +376,7 @@ class CI_API Icosahedron : public Source {
 	AttribSet		getAvailableAttribs() const override;
 	void			loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Icosahedron*	clone() const override { return new Icosahedron( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mHasColors ); return true; }
 
   protected:
 	void		calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec3> *colors, std::vector<vec2> *texcoords, std::vector<uint32_t> *indices ) const;
@@ -348,6 +406,7 @@ class CI_API Icosphere : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Icosphere*	clone() const override { return new Icosphere( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mSubdivision ).add( mHasColors ); return true; }
 
   protected:
 	void	calculate() const;
@@ -375,6 +434,7 @@ class CI_API Teapot : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Teapot*		clone() const override { return new Teapot( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mSubdivision ); return true; }
 
   protected:
 	void			calculate( std::vector<float> *positions, std::vector<float> *normals, std::vector<float> *texCoords, std::vector<uint32_t> *indices ) const;
@@ -412,6 +472,7 @@ class CI_API Circle : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Circle*		clone() const override { return new Circle( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadius ).add( mNumSubdivisions ); return true; }
 
   private:
 	void	updateVertexCounts();
@@ -438,6 +499,7 @@ class CI_API Ring : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Ring*		clone() const override { return new Ring( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadius ).add( mWidth ).add( mNumSubdivisions ); return true; }
 
 private:
 	void	updateVertexCounts();
@@ -467,6 +529,7 @@ class CI_API Sphere : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Sphere*		clone() const override { return new Sphere( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadius ).add( mSubdivisions ).add( mHasColors ); return true; }
 
   protected:
 	void		numRingsAndSegments( int *numRings, int *numSegments ) const;
@@ -501,6 +564,7 @@ class CI_API Capsule : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Capsule*	clone() const override { return new Capsule( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mDirection ).add( mCenter ).add( mLength ).add( mRadius ).add( mSubdivisionsHeight ).add( mSubdivisionsAxis ).add( mNumSegments ).add( mHasColors ); return true; }
 
   private:
 	void	updateCounts();
@@ -539,6 +603,7 @@ class CI_API Torus : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Torus*		clone() const override { return new Torus( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadiusMajor ).add( mRadiusMinor ).add( mSubdivisionsAxis ).add( mSubdivisionsHeight ).add( mHeight ).add( mCoils ).add( mTwist ).add( mTwistOffset ).add( mHasColors ); return true; }
 
   protected:
 	void		updateCounts();
@@ -581,6 +646,7 @@ public:
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	TorusKnot*	clone() const override { return new TorusKnot( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mP ).add( mQ ).add( mSubdivisionsAxis ).add( mSubdivisionsHeight ).add( mScale ).add( mRadius ).add( mHasColors ); return true; }
 
 protected:
 	void		calculate( std::vector<vec3> *positions, std::vector<vec3> *normals, std::vector<vec2> *texCoords, std::vector<vec3> *colors, std::vector<vec3> *tangents, std::vector<uint32_t> *indices ) const;
@@ -666,6 +732,7 @@ class CI_API Cylinder : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Cylinder*	clone() const override { return new Cylinder( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mOrigin ).add( mHeight ).add( mDirection ).add( mRadiusBase ).add( mRadiusApex ).add( mSubdivisionsAxis ).add( mSubdivisionsHeight ).add( mSubdivisionsCap ).add( mHasColors ); return true; }
 
   protected:
 	void	updateCounts();
@@ -734,6 +801,7 @@ class CI_API Plane : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	Plane*		clone() const override { return new Plane( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mSubdivisions ).add( mSize ).add( mOrigin ).add( mAxisU ).add( mAxisV ); return true; }
 
   protected:
 	ivec2		mSubdivisions;
@@ -883,6 +951,7 @@ class CI_API WireCapsule : public WireSource {
 	size_t			getNumVertices() const override;
 	void			loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireCapsule*	clone() const override { return new WireCapsule( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mDirection ).add( mCenter ).add( mLength ).add( mRadius ).add( mSubdivisionsHeight ).add( mSubdivisionsAxis ).add( mNumSegments ); return true; }
 
   private:
 	void	calculate( std::vector<vec3> *positions ) const;
@@ -914,6 +983,7 @@ class CI_API WireCircle : public Source {
 	size_t			getNumVertices() const override;
 	void			loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireCircle*		clone() const override { return new WireCircle( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadius ).add( mNumSegments ); return true; }
 
   private:
 	vec3		mCenter;
@@ -934,6 +1004,7 @@ class CI_API WireRoundedRect : public WireSource {
 	size_t				getNumVertices() const override { return mNumVertices; }
 	void				loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireRoundedRect*	clone() const override { return new WireRoundedRect( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mRectPositions ).add( mCornerSubdivisions ).add( mCornerRadius ); return true; }
 	
   protected:
 	void updateVertexCount();
@@ -954,6 +1025,7 @@ class CI_API WireRect : public WireSource {
 	Primitive			getPrimitive() const override { return geom::LINE_STRIP; }
   	void 				loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
   	WireRect* 			clone() const override { return new WireRect( *this ); };
+  	bool		hashContent( ContentHash *hash ) const override { hash->add( mPositions ); return true; }
 
   protected:
   	std::array<vec2, 5> mPositions;
@@ -978,6 +1050,7 @@ class CI_API WireCube : public WireSource {
 	size_t		getNumVertices() const override { return ( mSubdivisions.x - 1 ) * 8 + ( mSubdivisions.y - 1 ) * 8 + ( mSubdivisions.z - 1 ) * 8 + 24; }
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireCube*	clone() const override { return new WireCube( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mSubdivisions ).add( mSize ); return true; }
 	
   protected:
 	ivec3					mSubdivisions;
@@ -1013,6 +1086,7 @@ class CI_API WireCylinder : public WireSource {
 	size_t			getNumVertices() const override;
 	void			loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireCylinder*	clone() const override { return new WireCylinder( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mOrigin ).add( mHeight ).add( mDirection ).add( mRadiusBase ).add( mRadiusApex ).add( mSubdivisionsAxis ).add( mSubdivisionsHeight ).add( mNumSegments ); return true; }
 
   protected:
 	vec3		mOrigin;
@@ -1064,6 +1138,7 @@ public:
 	size_t				getNumVertices() const override;
 	void				loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireIcosahedron*	clone() const override { return new WireIcosahedron( *this ); }
+	bool				hashContent( ContentHash* /*hash*/ ) const override { return true; }
 
 protected:
 	void		calculate() const;
@@ -1081,6 +1156,7 @@ class CI_API WireFrustum : public WireSource {
 	size_t			getNumVertices() const override { return 24; }
 	void			loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireFrustum*	clone() const override { return new WireFrustum( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( ntl ).add( ntr ).add( nbl ).add( nbr ).add( ftl ).add( ftr ).add( fbl ).add( fbr ); return true; }
 
   private:
 	vec3 ntl, ntr, nbl, nbr, ftl, ftr, fbl, fbr;
@@ -1106,6 +1182,7 @@ class CI_API WirePlane : public WireSource {
 	size_t		getNumVertices() const override { return ( mSubdivisions.x + 1 ) * 2 + ( mSubdivisions.y + 1 ) * 2; }
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WirePlane*	clone() const override { return new WirePlane( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mSubdivisions ).add( mSize ).add( mOrigin ).add( mAxisU ).add( mAxisV ); return true; }
 
   protected:
 	ivec2		mSubdivisions;
@@ -1129,6 +1206,7 @@ class CI_API WireSphere : public WireSource {
 	size_t		getNumVertices() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireSphere*	clone() const override { return new WireSphere( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadius ).add( mSubdivisionsAxis ).add( mSubdivisionsHeight ).add( mNumSegments ); return true; }
 
   protected:
 	vec3		mCenter;
@@ -1157,6 +1235,7 @@ class CI_API WireTorus : public WireSource {
 	size_t		getNumVertices() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	WireTorus*	clone() const override { return new WireTorus( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCenter ).add( mRadiusMajor ).add( mRadiusMinor ).add( mSubdivisionsAxis ).add( mSubdivisionsHeight ).add( mHeight ).add( mCoils ).add( mNumSegments ); return true; }
 
   protected:
 	vec3		mCenter;
@@ -1172,7 +1251,7 @@ class CI_API WireTorus : public WireSource {
 
 //////////////////////////////////////////////////////////////////////////////////////
 // Modifiers
-//! "Bakes" a mat4 transformation into the positions, normals and tangents of a geom::Source. Promotes 2D positions to 3D.
+//! "Bakes" a mat4 transformation into the positions, normals and tangents of a geom::Source. Promotes 2D positions to 3D. Large sources are processed in parallel.
 class CI_API Transform : public Modifier {
   public:
 	//! Does not currently support a projection matrix (i.e. doesn't divide by 'w' )
@@ -1187,6 +1266,7 @@ class CI_API Transform : public Modifier {
 	
 	// Inherited from Modifier
 	Modifier*			clone() const override { return new Transform( mTransform ); }
+	bool			hashContent( ContentHash *hash ) const override { hash->add( mTransform ); return true; }
 	uint8_t				getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	void				process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 
@@ -1220,7 +1300,7 @@ class CI_API Rotate : public Transform {
 	Rotate( float angle, const vec3 &axis ) : Transform( glm::rotate( angle, axis ) ) {}
 };
 
-//! Twists a geom::Source around a given axis
+//! Twists a geom::Source around a given axis. Large sources are processed in parallel.
 class CI_API Twist : public Modifier {
   public:
 	Twist()
@@ -1234,6 +1314,7 @@ class CI_API Twist : public Modifier {
 	Twist&		endAngle( float radians ) { mEndAngle = radians; return *this; }
 
 	Modifier*	clone() const override { return new Twist( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mAxisStart ).add( mAxisEnd ).add( mStartAngle ).add( mEndAngle ); return true; }
 	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 	
   protected:
@@ -1245,6 +1326,7 @@ class CI_API Twist : public Modifier {
 class CI_API Lines : public Modifier {
   public:
 	Modifier*	clone() const override { return new Lines(); }
+	bool		hashContent( ContentHash* /*hash*/ ) const override { return true; }
 
 	size_t		getNumIndices( const Modifier::Params &upstreamParams ) const override;
 	Primitive	getPrimitive( const Modifier::Params &/*upstreamParams*/ ) const override { return geom::LINES; }
@@ -1258,16 +1340,19 @@ class CI_API Lines : public Modifier {
 class CI_API ColorFromAttrib : public Modifier {
   public:
 	ColorFromAttrib( Attrib attrib, const std::function<Colorf(vec2)> &fn )
-		: mAttrib( attrib ), mFnColor2( fn )
+		: mAttrib( attrib ), mFnColor2( fn ), mParallel( false )
 	{}
 	ColorFromAttrib( Attrib attrib, const std::function<Colorf(vec3)> &fn )
-		: mAttrib( attrib ), mFnColor3( fn )
+		: mAttrib( attrib ), mFnColor3( fn ), mParallel( false )
 	{}
 	
 	Attrib				getAttrib() const { return mAttrib; }
 	ColorFromAttrib&	attrib( Attrib attrib ) { mAttrib = attrib; return *this; }
+	//! Enables calling the color function from multiple threads for large sources. The function must then be safe to call concurrently. Disabled by default.
+	ColorFromAttrib&	parallel( bool enable = true ) { mParallel = enable; return *this; }
+	bool				isParallel() const { return mParallel; }
 
-	Modifier*	clone() const override { return new ColorFromAttrib( mAttrib, mFnColor2, mFnColor3 ); }
+	Modifier*	clone() const override { return new ColorFromAttrib( *this ); }
 	uint8_t		getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 	
@@ -1275,15 +1360,16 @@ class CI_API ColorFromAttrib : public Modifier {
 	
   protected:
 	ColorFromAttrib( Attrib attrib, const std::function<Colorf(vec2)> &fn2, const std::function<Colorf(vec3)> &fn3 )
-		: mAttrib( attrib ), mFnColor2( fn2 ), mFnColor3( fn3 )
+		: mAttrib( attrib ), mFnColor2( fn2 ), mFnColor3( fn3 ), mParallel( false )
 	{}
 
 	Attrib							mAttrib;
 	std::function<Colorf(vec2)>		mFnColor2;
 	std::function<Colorf(vec3)>		mFnColor3;
+	bool							mParallel;
 };
 
-//! Sets an attribute of a geom::Source to be a constant value for every vertex. Determines dimension from constructor (vec4 -> 4, for example)
+//! Sets an attribute of a geom::Source to be a constant value for every vertex. Determines dimension from constructor (vec4 -> 4, for example). Large sources are filled in parallel.
 class CI_API Constant : public Modifier {
   public:
 	Constant( geom::Attrib attrib, float v )
@@ -1296,6 +1382,7 @@ class CI_API Constant : public Modifier {
 		: mAttrib( attrib ), mValue( v ), mDims( 4 ) {}
 
 	Modifier*	clone() const override { return new geom::Constant( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mAttrib ).add( mValue ).add( mDims ); return true; }
 	uint8_t		getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 
@@ -1316,14 +1403,18 @@ class AttribFn : public Modifier {
 	static const int DSTDIM = sizeof(D)/ sizeof(float);
 	
 	AttribFn( Attrib src, Attrib dst, const FN &fn )
-		: mSrcAttrib( src ), mDstAttrib( dst ), mFn( fn )
+		: mSrcAttrib( src ), mDstAttrib( dst ), mFn( fn ), mParallel( false )
 	{}
 
 	AttribFn( Attrib attrib, const FN &fn )
-		: mSrcAttrib( attrib ), mDstAttrib( attrib ), mFn( fn )
+		: mSrcAttrib( attrib ), mDstAttrib( attrib ), mFn( fn ), mParallel( false )
 	{}
+
+	//! Enables calling \a fn from multiple threads for large sources. The function must then be safe to call concurrently. Disabled by default.
+	AttribFn&	parallel( bool enable = true ) { mParallel = enable; return *this; }
+	bool		isParallel() const { return mParallel; }
 	
-	Modifier*	clone() const override { return new AttribFn( mSrcAttrib, mDstAttrib, mFn ); }
+	Modifier*	clone() const override { return new AttribFn( *this ); }
 	uint8_t		getAttribDims( Attrib attr, uint8_t upstreamDims ) const override;
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 	
@@ -1332,6 +1423,7 @@ class AttribFn : public Modifier {
   protected:
 	geom::Attrib		mSrcAttrib, mDstAttrib;
 	FN					mFn;
+	bool				mParallel;
 };
 
 //! Draws lines representing the Attrib::NORMALs for a geom::Source. Encodes 0 for base and 1 for normal into CUSTOM_0
@@ -1348,6 +1440,7 @@ class CI_API VertexNormalLines : public Modifier {
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 
 	Modifier*	clone() const override { return new VertexNormalLines( mLength, mAttrib ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mLength ).add( mAttrib ); return true; }
 	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 
   protected:
@@ -1364,6 +1457,7 @@ class CI_API Tangents : public Modifier {
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;
 	
 	Modifier*	clone() const override { return new Tangents; }
+	bool		hashContent( ContentHash* /*hash*/ ) const override { return true; }
 	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 };
 
@@ -1375,6 +1469,7 @@ class CI_API Invert : public Modifier {
 	{}
 
 	Modifier*	clone() const override { return new Invert( mAttrib ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mAttrib ); return true; }
 	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 
   protected:
@@ -1392,6 +1487,7 @@ class CI_API Remove : public Modifier {
 	AttribSet	getAvailableAttribs( const Modifier::Params &upstreamParams ) const override;	
 	
 	Modifier*	clone() const override { return new Remove( mAttrib ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mAttrib ); return true; }
 	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 	
   protected:
@@ -1414,6 +1510,38 @@ class CI_API Bounds : public Modifier {
 	Attrib				mAttrib;
 };
 
+//! Reorders indexed TRIANGLES to make better use of the post-transform vertex cache, and optionally to reduce overdraw. \sa optimizeVertexCache(), optimizeOverdraw()
+class CI_API OptimizeVertexCache : public Modifier {
+  public:
+	OptimizeVertexCache( size_t cacheSize = 16 )
+		: mCacheSize( cacheSize ), mOverdraw( false ), mOverdrawThreshold( 1.05f )
+	{}
+
+	//! Sets the number of vertices in the simulated cache. Default is \c 16.
+	OptimizeVertexCache&	cacheSize( size_t size ) { mCacheSize = size; return *this; }
+	//! Enables reordering clusters of triangles to reduce overdraw, allowing the cache miss ratio to grow by up to \a threshold. Requires 3D POSITION.
+	OptimizeVertexCache&	overdraw( bool enable = true, float threshold = 1.05f ) { mOverdraw = enable; mOverdrawThreshold = threshold; return *this; }
+
+	Modifier*	clone() const override { return new OptimizeVertexCache( *this ); }
+	bool		hashContent( ContentHash *hash ) const override { hash->add( mCacheSize ).add( mOverdraw ).add( mOverdrawThreshold ); return true; }
+	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+
+  protected:
+	size_t		mCacheSize;
+	bool		mOverdraw;
+	float		mOverdrawThreshold;
+};
+
+//! Reorders the vertices of indexed TRIANGLES by their first use, improving the locality of vertex fetches. Unused vertices are moved last. \sa calculateVertexFetchRemap()
+class CI_API OptimizeVertexFetch : public Modifier {
+  public:
+	OptimizeVertexFetch() {}
+
+	Modifier*	clone() const override { return new OptimizeVertexFetch; }
+	bool		hashContent( ContentHash* /*hash*/ ) const override { return true; }
+	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
+};
+
 //! Calculates a single level of subdivision of triangles by inserting a single vertex in the center of each triangle.
 //! Interpolates all attributes and normalizes 3D NORMAL, TANGENT and BITANGENT attributes.
 class CI_API Subdivide : public Modifier {
@@ -1425,6 +1553,7 @@ class CI_API Subdivide : public Modifier {
 	size_t		getNumIndices( const Modifier::Params &upstreamParams ) const override;
 	
 	Modifier*	clone() const override { return new Subdivide(); }
+	bool		hashContent( ContentHash* /*hash*/ ) const override { return true; }
 	void		process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const override;
 };
 
@@ -1446,6 +1575,8 @@ class CI_API SourceModsContext : public Target {
 	void			copyAttrib( Attrib attr, uint8_t dims, size_t strideBytes, const float *srcData, size_t count ) override;
 	void			copyIndices( Primitive primitive, const uint32_t *source, size_t numIndices, uint8_t requiredBytesPerIndex ) override;
 	
+	//! Replaces the data for \a attr with \a data, which holds \a count tightly packed elements of \a dims floats. Avoids the copy made by copyAttrib().
+	void			setAttrib( Attrib attr, uint8_t dims, std::unique_ptr<float[]> &&data, size_t count );
 	//! Appends vertex data to existing data for \a attr. \a dims must match existing data.
 	void			appendAttrib( Attrib attr, uint8_t dims, const float *srcData, size_t count );
 	void			clearAttrib( Attrib attr );
@@ -1537,6 +1668,16 @@ class CI_API SourceMods : public Source {
 	SourceMods&	operator&=( const SourceMods &sourceMods ) { append( sourceMods ); return *this; }
 	SourceMods&	operator&=( const Source &source ) { append( source ); return *this; }	
 	
+	/** Sets the number of bytes of evaluated geometry loadInto() keeps for reuse. A chain whose Source and Modifiers all implement hashContent() is
+		keyed on the hash of their parameters, so identical chains share one result even when built independently, and a chain loaded into several
+		Batches, VboMeshes or TriMeshes is only evaluated once. The least recently used results are discarded beyond \a bytes, and \c 0 disables
+		memoization. Default is 32 MB. **/
+	static void		setCacheCapacity( size_t bytes );
+	//! Returns the number of bytes of evaluated geometry loadInto() keeps for reuse. \sa setCacheCapacity()
+	static size_t	getCacheCapacity();
+	//! Discards every memoized result, so that the next loadInto() of any chain evaluates it again.
+	static void		clearCache();
+
 	const std::vector<std::unique_ptr<Modifier>>&	getModifiers() const { return mModifiers; }
 	const Source*									getSource() const { return mSourcePtr; }
 	//! Not generally useful. Use getSource() instead. Maps to nullptr when the SourceMods is not responsible for ownership.
@@ -1550,10 +1691,12 @@ class CI_API SourceMods : public Source {
 	AttribSet	getAvailableAttribs() const override;
 	void		loadInto( Target *target, const AttribSet &requestedAttribs ) const override;
 	SourceMods*	clone() const override { return new SourceMods( *this ); }
+	bool		hashContent( ContentHash *hash ) const override;
 
   protected:
 	void		copyImpl( const SourceMods &rhs );
 	void		cacheVariables() const;
+	void		loadIntoImpl( Target *target, const AttribSet &requestedAttribs ) const;
 	
 	const Source* 							mSourcePtr; // null if we have children
 	std::unique_ptr<Source>					mSourceStorage; // null if we don't have ownership
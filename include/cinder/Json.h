@@ -267,6 +267,9 @@ private:
 	static bool						isIndex( const std::string &key );
 
 	std::string						replaceAll( const std::string& text, const std::string& search, const std::string& replace ) const;
+
+	friend class JsonDocument;
+	friend class JsonReader;
 	
 	Container						mChildren;
 	std::string						mKey;
@@ -0,0 +1,289 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Json.h"
+#include "cinder/Stream.h"
+#include "cinder/Noncopyable.h"
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+//! Read-only JSON document which is parsed in place into a single contiguous array of nodes.
+/** Keys and strings are unescaped within the document's own copy of the source text and referenced directly, so parsing
+	performs no per-node allocations. Nodes are stored in document order, with each node's descendants immediately
+	following it. Object members preserve the order in which they appear in the source. Use toJsonTree() to convert to
+	a mutable JsonTree. **/
+class CI_API JsonDocument {
+  private:
+	struct NodeData;
+
+  public:
+	//! Lightweight handle to a node within a JsonDocument. Valid for the lifetime of the JsonDocument, and follows its contents when it is moved.
+	class CI_API Node {
+	  public:
+		class CI_API ConstIter {
+		  public:
+			typedef std::forward_iterator_tag	iterator_category;
+			typedef Node						value_type;
+			typedef std::ptrdiff_t				difference_type;
+			typedef const Node*					pointer;
+			typedef Node						reference;
+
+			ConstIter() : mNodes( nullptr ), mIndex( 0 ) {}
+
+			Node			operator*() const { return Node( mNodes, mIndex ); }
+			ConstIter&		operator++();
+			ConstIter		operator++( int ) { ConstIter prev( *this ); ++(*this); return prev; }
+			bool			operator==( const ConstIter &rhs ) const { return mIndex == rhs.mIndex; }
+			bool			operator!=( const ConstIter &rhs ) const { return mIndex != rhs.mIndex; }
+
+		  private:
+			ConstIter( const NodeData *nodes, uint32_t index ) : mNodes( nodes ), mIndex( index ) {}
+
+			const NodeData		*mNodes;
+			uint32_t			mIndex;
+
+			friend class Node;
+		};
+
+		//! Returns the type of the node, matching JsonTree's classification
+		JsonTree::NodeType	getNodeType() const;
+		bool				isNull() const;
+		bool				isBool() const;
+		bool				isNumber() const;
+		bool				isString() const;
+		bool				isArray() const;
+		bool				isObject() const;
+
+		//! Returns the node's key, or an empty string if the node is not a member of an object
+		std::string			getKey() const;
+		//! Returns a pointer to the node's null-terminated key within the document
+		const char*			getKeyData() const;
+		//! Returns the length of the node's key in bytes
+		size_t				getKeyLength() const;
+
+		//! Returns the value of the node as a string. Numbers are returned as written in the source. Empty for arrays, objects and \c null.
+		std::string			getValue() const;
+		//! Returns a pointer to the node's value text within the document. Null-terminated only for strings.
+		const char*			getValueData() const;
+		//! Returns the length of the node's value text in bytes
+		size_t				getValueLength() const;
+		/**! \brief Returns the value of the node cast to T. Numeric and boolean types are converted directly; other types use ci::fromString().
+			Throws JsonTree::ExcNonConvertible if the value cannot be converted. **/
+		template<typename T>
+		T					getValue() const	{ T result; getValueImpl( &result ); return result; }
+		//! Returns the value of the child at \a relativePath. Convenience shortcut for: \code getChild( relativePath ).getValue<T>() \endcode
+		template<typename T>
+		T					getValueForKey( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const	{ return getChild( relativePath, caseSensitive, separator ).getValue<T>(); }
+		//! Returns the value of the child at \a index. Convenience shortcut for: \code getChild( index ).getValue<T>() \endcode
+		template<typename T>
+		T					getValueAtIndex( size_t index ) const	{ return getChild( index ).getValue<T>(); }
+
+		//! Returns the number of direct children of an array or object
+		size_t				getNumChildren() const;
+		bool				hasChildren() const { return getNumChildren() > 0; }
+		ConstIter			begin() const;
+		ConstIter			end() const;
+
+		/**! Returns the child at \a relativePath, using the same path syntax as JsonTree. Throws JsonTree::ExcChildNotFound if none matches.
+			<br><tt>JsonDocument::Node node = doc.getRoot().getChild( "path.to.child[2]" );</tt> **/
+		Node				getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const;
+		//! Returns the child at \a index. Throws JsonTree::ExcChildNotFound if none matches.
+		Node				getChild( size_t index ) const;
+		//! Returns whether a child exists at \a relativePath
+		bool				hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const;
+		Node				operator[]( const std::string &relativePath ) const	{ return getChild( relativePath ); }
+		Node				operator[]( size_t index ) const					{ return getChild( index ); }
+
+		//! Returns a JsonTree containing a copy of this node and its descendants
+		JsonTree			toJsonTree() const;
+
+	  private:
+		Node( const NodeData *nodes, uint32_t index ) : mNodes( nodes ), mIndex( index ) {}
+
+		const NodeData&		getData() const;
+		bool				findChild( const std::string &relativePath, bool caseSensitive, char separator, uint32_t *result ) const;
+		void				throwNonConvertible() const;
+
+		void				getValueImpl( bool *result ) const;
+		void				getValueImpl( int32_t *result ) const;
+		void				getValueImpl( uint32_t *result ) const;
+		void				getValueImpl( int64_t *result ) const;
+		void				getValueImpl( uint64_t *result ) const;
+		void				getValueImpl( float *result ) const;
+		void				getValueImpl( double *result ) const;
+		void				getValueImpl( std::string *result ) const	{ *result = getValue(); }
+		template<typename T>
+		void				getValueImpl( T *result ) const
+		{
+			try {
+				*result = fromString<T>( getValue() );
+			}
+			catch( ... ) {
+				throwNonConvertible();
+			}
+		}
+
+		// the document's node array rather than the document itself, which a move leaves in place
+		const NodeData		*mNodes;
+		uint32_t			mIndex;
+
+		friend class JsonDocument;
+	};
+
+	typedef Node::ConstIter		ConstIter;
+
+	//! Creates an empty document whose root is \c null
+	JsonDocument();
+	//! Parses the JSON contained in \a dataSource. Throws JsonTree::ExcJsonParserError on malformed input unless \a parseOptions ignores errors.
+	explicit JsonDocument( const DataSourceRef &dataSource, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() );
+	//! Parses the JSON contained in \a jsonString.
+	explicit JsonDocument( const std::string &jsonString, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() );
+	//! Parses \a size bytes of JSON starting at \a data. The text is copied, so \a data need not outlive the JsonDocument.
+	JsonDocument( const char *data, size_t size, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() );
+
+	JsonDocument( JsonDocument &&rhs ) = default;
+	JsonDocument& operator=( JsonDocument &&rhs ) = default;
+
+	//! Returns the root value of the document
+	Node		getRoot() const			{ return Node( mNodes.data(), 0 ); }
+	//! Returns the child of the root at \a relativePath. Throws JsonTree::ExcChildNotFound if none matches.
+	Node		operator[]( const std::string &relativePath ) const	{ return getRoot().getChild( relativePath ); }
+	//! Returns the total number of nodes in the document
+	size_t		getNumNodes() const		{ return mNodes.size(); }
+
+	//! Returns a JsonTree containing a copy of the entire document
+	JsonTree	toJsonTree() const		{ return getRoot().toJsonTree(); }
+
+  private:
+	typedef enum { TYPE_NULL, TYPE_BOOL, TYPE_NUMBER, TYPE_STRING, TYPE_ARRAY, TYPE_OBJECT } Type;
+
+	struct NodeData {
+		Type			mType;
+		bool			mBool, mIsInteger;
+		uint32_t		mKeyLength;
+		uint32_t		mValueLength;	// length of string or number text
+		uint32_t		mNumChildren;
+		uint32_t		mNext;			// index of the node following this node's descendants
+		const char		*mKey;
+		const char		*mValue;
+		double			mNumber;
+		int64_t			mInteger;
+	};
+
+	void	parse( const JsonTree::ParseOptions &parseOptions );
+	static void	buildTree( const NodeData *nodes, uint32_t index, JsonTree *result );
+
+	std::unique_ptr<char[]>		mText;
+	size_t						mTextSize;
+	std::vector<NodeData>		mNodes;
+};
+
+//! Forward-only pull parser which reads JSON incrementally from a stream, suitable for files too large to hold in memory as a tree.
+/** Each call to next() advances to the following token. The string for the most recent key, string or number token is
+	held in a buffer owned by the reader which is reused between tokens, so reading allocates only as long strings are
+	encountered. A subtree may be skipped with skip() or materialized as a JsonTree with readTree().
+	\code
+	JsonReader reader( loadFile( "huge.json" ) );
+	while( reader.next() != JsonReader::TOKEN_END ) {
+		if( reader.getToken() == JsonReader::TOKEN_KEY && reader.getString() == "name" && reader.next() == JsonReader::TOKEN_STRING )
+			names.push_back( reader.getString() );
+	}
+	\endcode **/
+class CI_API JsonReader : private Noncopyable {
+  public:
+	typedef enum { TOKEN_NONE, TOKEN_BEGIN_OBJECT, TOKEN_END_OBJECT, TOKEN_BEGIN_ARRAY, TOKEN_END_ARRAY, TOKEN_KEY,
+		TOKEN_STRING, TOKEN_NUMBER, TOKEN_BOOL, TOKEN_NULL, TOKEN_END } Token;
+
+	//! Reads JSON incrementally from \a dataSource. Throws JsonTree::ExcJsonParserError on malformed input unless \a parseOptions ignores errors, in which case reading stops.
+	explicit JsonReader( const DataSourceRef &dataSource, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() );
+	//! Reads JSON incrementally from \a stream
+	explicit JsonReader( const IStreamRef &stream, const JsonTree::ParseOptions &parseOptions = JsonTree::ParseOptions() );
+
+	//! Advances to and returns the next token. Returns TOKEN_END once the top-level value has been read.
+	Token				next();
+	//! Returns the current token
+	Token				getToken() const	{ return mToken; }
+	//! Returns the number of arrays and objects which enclose the current position
+	size_t				getDepth() const	{ return mStack.size(); }
+
+	//! Returns the text of the current key, string or number token
+	const std::string&	getString() const	{ return mString; }
+	//! Returns the most recently read key, which remains valid while the value it names is read
+	const std::string&	getKey() const		{ return mKey; }
+	//! Returns the value of the current number token
+	double				getDouble() const	{ return mNumber; }
+	//! Returns the value of the current number token as an integer. Non-integral numbers are truncated, and those outside the range of \c int64_t are clamped to it.
+	int64_t				getInt64() const	{ return mInteger; }
+	//! Returns whether the current number token was written as an integer
+	bool				isInteger() const	{ return mIsInteger; }
+	//! Returns the value of the current bool token
+	bool				getBool() const		{ return mBool; }
+
+	//! Skips the value following the current token. If the current token is a key, its value is skipped; if it begins an object or array, the reader advances to the matching end token.
+	void				skip();
+	//! Reads the value at the current token, including all of its descendants, into a JsonTree. If the current token is a key, its value is read.
+	JsonTree			readTree();
+
+	//! Returns the number of bytes consumed from the stream
+	uint64_t			getOffset() const	{ return mBufferOffset + ( mPos - mBuffer.data() ); }
+
+  private:
+	typedef enum { STATE_VALUE, STATE_OBJECT_FIRST, STATE_OBJECT_NEXT, STATE_ARRAY_FIRST, STATE_ARRAY_NEXT, STATE_END } State;
+
+	int			peek()	{ return ( mPos < mEnd || refill() ) ? (unsigned char)*mPos : -1; }
+	bool		refill();
+	void		skipWhitespace();
+	void		expect( char c );
+	Token		readValue();
+	Token		readKey();
+	void		readString( std::string *result );
+	void		readNumber();
+	void		readLiteral( const char *literal );
+	Token		endContainer();
+	State		stateAfterValue() const;
+	void		readTree( JsonTree *result );
+	void		throwError( const char *message );
+
+	IStreamRef				mStream;
+	JsonTree::ParseOptions	mParseOptions;
+	std::vector<char>		mBuffer;
+	const char				*mPos, *mEnd;
+	uint64_t				mBufferOffset;
+
+	State					mState;
+	Token					mToken;
+	std::vector<bool>		mStack;		// true for objects, false for arrays
+	std::string				mString, mKey;
+	double					mNumber;
+	int64_t					mInteger;
+	bool					mIsInteger, mBool;
+};
+
+} // namespace cinder
@@ -23,68 +23,89 @@
 #pragma once
 
 #include "cinder/Cinder.h"
+#include "cinder/Thread.h"
 #include "cinder/Vector.h"
 
 #include <vector>
+#include <atomic>
 #include <float.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <memory>
 #include <utility>
 
 namespace cinder {
 
-// KdTree Declarations
-template<unsigned char K>
-struct KdNode {
-	void init( float p, uint32_t a) {
-		splitPos = p;
-		splitAxis = a;
-		rightChild = ~0;
-		hasLeftChild = 0;
-	}
-	void initLeaf() {
-		splitAxis = K;
-		rightChild = ~0;
-		hasLeftChild = 0;
-	}
-	// KdNode Data
-	float splitPos;
-	uint32_t splitAxis:2;
-	uint32_t hasLeftChild:1;
-	uint32_t rightChild:29;
-};
-
 struct NullLookupProc {
  public:
-	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) {}
+	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) const {}
 };
 
+/** \brief Static k-d tree of points for nearest neighbor and radius queries.
+ *
+ *  The points are copied on construction, so the data passed to initialize() need not outlive the tree. They are stored as separate
+ *  arrays of each coordinate in the order of the leaves, with up to eight points per leaf, so queries read contiguous memory and the
+ *  distances within a leaf are computed with vector instructions by the compiler. Large sets are built on several threads.
+ *  Queries are const and may be called concurrently from several threads.
+**/
 template <typename NodeData, unsigned char K=3, class LookupProc = NullLookupProc> class KdTree {
 public:
-	typedef std::pair<const NodeData*, uint32_t> NodeDataIndex;
-	
-	// KdTree Public Methods
+	//! Index reported for points which weren't found.
+	static const uint32_t INVALID = 0xFFFFFFFF;
+
 	template<typename NodeDataVector>
 	KdTree( const NodeDataVector &data );
 	KdTree() {}
+
+	//! Builds the tree from the points in \a data, replacing the previous contents while reusing their storage.
 	template<typename NodeDataVector>
 	void initialize( const NodeDataVector &d );
-	~KdTree() {
-		free( nodes );
-		delete[] mNodeData;
-	}
-	void recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
+
+	//! Returns the number of points in the tree.
+	size_t	getNumPoints() const { return mIndices.size(); }
+
+	//! Calls \a process.process( index, distSqrd, maxDistSqrd ) for every point closer than \a maxDist to \a p. \a process may reduce \a maxDistSqrd to narrow the search.
 	void lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
+	//! Finds the point nearest to \a p, writing its coordinates to \a result and its index to \a resultIndex, which is \c INVALID if the tree is empty.
 	void findNearest( float p[K], float result[K], uint32_t *resultIndex ) const;
-	
+	//! Finds the \a k points nearest to \a p and closer than \a maxDist, writing their indices to \a resultIndices and their squared distances to \a resultDistancesSqrd if it isn't null, closest first. Returns the number of points found.
+	size_t findNearest( const NodeData &p, size_t k, uint32_t *resultIndices, float *resultDistancesSqrd = nullptr, float maxDist = FLT_MAX ) const;
+	//! Finds the \a k nearest points to each of the \a numPoints points at \a points in parallel. Writes \a k results per point to \a resultIndices and \a resultDistancesSqrd, padding with \c INVALID and \c FLT_MAX when fewer are found.
+	void findNearest( const NodeData *points, size_t numPoints, size_t k, uint32_t *resultIndices, float *resultDistancesSqrd = nullptr, float maxDist = FLT_MAX ) const;
+	//! Appends the indices of all points within \a radius of \a p to \a resultIndices and their squared distances to \a resultDistancesSqrd if it isn't null, unordered. Returns the number of points found.
+	size_t findInRadius( const NodeData &p, float radius, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSqrd = nullptr ) const;
+
 private:
-	// KdTree Private Methods
-	void privateLookup(uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared) const;
-	void privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const;
-	// KdTree Private Data
-	KdNode<K> *nodes;
-	NodeDataIndex *mNodeData;
-	uint32_t nNodes, nextFreeNode;
+	static const uint32_t LEAF_SIZE = 8;
+	// Minimum number of points in a node before its children are built on separate threads
+	static const uint32_t PARALLEL_BUILD_SIZE = 1 << 15;
+	// Minimum number of queries per thread for batched queries
+	static const size_t PARALLEL_QUERY_SIZE = 1024;
+	// Largest k whose squared distances are kept on the stack when the caller doesn't want them
+	static const size_t MAX_LOCAL_K = 32;
+
+	struct Node {
+		float		mSplit;		// split position of inner nodes
+		uint32_t	mFirst;		// first of the two children of inner nodes, first point of leaves
+		uint16_t	mCount;		// number of points of leaves, 0 for inner nodes
+		uint8_t		mAxis;		// split axis of inner nodes
+	};
+
+	struct BuildPoint {
+		float		mCoords[K];
+		uint32_t	mIndex;
+	};
+
+	void	buildNode( uint32_t nodeIndex, uint32_t begin, uint32_t end, BuildPoint *points, std::atomic<uint32_t> *numNodes, int parallelDepth );
+	void	getCoords( const NodeData &p, float result[K] ) const;
+	size_t	findNearestSlots( const float p[K], size_t k, uint32_t *resultSlots, float *resultDistancesSqrd, float maxDistSqrd ) const;
+	//! Calls \a fn( slot, distSqrd ) for every point within \a maxDistSqrd of \a p, which \a fn may reduce.
+	template<typename LeafFn>
+	void	traverse( const float p[K], float &maxDistSqrd, LeafFn &&fn ) const;
+
+	std::vector<Node>		mNodes;
+	std::vector<float>		mCoords[K];	// coordinates of the points, in the order of the leaves
+	std::vector<uint32_t>	mIndices;	// original index of each point
 };
 
 
@@ -132,17 +153,18 @@ struct NodeDataTraits<vec2>
 	}
 };
 
-template<typename NodeData> struct CompareNode {
-	CompareNode( int a ) { axis = a; }
-	int axis;
-	bool operator()(const std::pair<const NodeData*,uint32_t> &d1,
-			const std::pair<const NodeData*,uint32_t> &d2) const {
-		return NodeDataTraits<NodeData>::getAxis( *d1.first, axis ) == NodeDataTraits<NodeData>::getAxis( *d2.first, axis ) ? ( d1.first < d2.first ) :
-			NodeDataTraits<NodeData>::getAxis( *d1.first, axis ) < NodeDataTraits<NodeData>::getAxis( *d2.first, axis );
-	}
-};
-
 // KdTree Method Definitions
+template<typename NodeData, unsigned char K, typename LookupProc>
+const uint32_t KdTree<NodeData, K, LookupProc>::INVALID;
+template<typename NodeData, unsigned char K, typename LookupProc>
+const uint32_t KdTree<NodeData, K, LookupProc>::LEAF_SIZE;
+template<typename NodeData, unsigned char K, typename LookupProc>
+const uint32_t KdTree<NodeData, K, LookupProc>::PARALLEL_BUILD_SIZE;
+template<typename NodeData, unsigned char K, typename LookupProc>
+const size_t KdTree<NodeData, K, LookupProc>::PARALLEL_QUERY_SIZE;
+template<typename NodeData, unsigned char K, typename LookupProc>
+const size_t KdTree<NodeData, K, LookupProc>::MAX_LOCAL_K;
+
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
 KdTree<NodeData, K, LookupProc>::KdTree(const NodeDataVector &d)
@@ -154,63 +176,144 @@ template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
 void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d )
 {
-	nNodes = NodeDataVectorTraits<NodeDataVector>::getSize( d );
-	nextFreeNode = 1;
-	nodes = (KdNode<K> *)malloc(nNodes * sizeof(KdNode<K>));
-	mNodeData = new NodeDataIndex[nNodes];
-	std::vector<NodeDataIndex> buildNodes;
-	buildNodes.reserve( nNodes );
-	for( uint32_t i = 0; i < nNodes; ++i )
-		buildNodes.push_back( std::make_pair( &d[i], i ) );
-	// Begin the KdTree building process
-	recursiveBuild( 0, 0, nNodes, buildNodes );
+	const uint32_t numPoints = NodeDataVectorTraits<NodeDataVector>::getSize( d );
+	mNodes.clear();
+	mIndices.resize( numPoints );
+	for( unsigned char k = 0; k < K; ++k )
+		mCoords[k].resize( numPoints );
+	if( numPoints == 0 )
+		return;
+
+	std::vector<BuildPoint> points( numPoints );
+	parallelFor( 0, numPoints, PARALLEL_BUILD_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t i = begin; i < end; ++i ) {
+			getCoords( d[i], points[i].mCoords );
+			points[i].mIndex = (uint32_t)i;
+		}
+	} );
+
+	// median splits leave at least LEAF_SIZE / 2 points in every leaf, which bounds the number of nodes
+	mNodes.resize( 4 * ( numPoints / LEAF_SIZE + 1 ) );
+	std::atomic<uint32_t> numNodes( 1 );
+	int parallelDepth = 0;
+	while( ( size_t( 1 ) << parallelDepth ) < getNumParallelThreads() )
+		++parallelDepth;
+	buildNode( 0, 0, numPoints, points.data(), &numNodes, parallelDepth );
+	mNodes.resize( numNodes );
+
+	parallelFor( 0, numPoints, PARALLEL_BUILD_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t i = begin; i < end; ++i ) {
+			for( unsigned char k = 0; k < K; ++k )
+				mCoords[k][i] = points[i].mCoords[k];
+			mIndices[i] = points[i].mIndex;
+		}
+	} );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
+void KdTree<NodeData, K, LookupProc>::buildNode( uint32_t nodeIndex, uint32_t begin, uint32_t end, BuildPoint *points, std::atomic<uint32_t> *numNodes, int parallelDepth )
 {
-	// Create leaf node of kd-tree if we've reached the bottom
-	if( start + 1 == end) {
-		nodes[nodeNum].initLeaf();
-		mNodeData[nodeNum] = buildNodes[start];
+	Node &node = mNodes[nodeIndex];
+	const uint32_t count = end - begin;
+	if( count <= LEAF_SIZE ) {
+		node.mSplit = 0;
+		node.mFirst = begin;
+		node.mCount = (uint16_t)count;
+		node.mAxis = 0;
 		return;
 	}
-	// Choose split direction and partition data
-	// Compute bounds of data from _start_ to _end_
+
+	// split the widest extent of the points at their median
 	float boundMin[K], boundMax[K];
 	for( unsigned char k = 0; k < K; ++k ) {
 		boundMin[k] = FLT_MAX;
-		boundMax[k] = FLT_MIN;
+		boundMax[k] = -FLT_MAX;
 	}
-	
-	for( uint32_t i = start; i < end; ++i ) {
-		for( uint8_t axis = 0; axis < K; axis++ ) {
-			// NOT Compiling? you should define NOMINMAX
-			boundMin[axis] = std::min( boundMin[axis], NodeDataTraits<NodeData>::getAxis( *buildNodes[i].first, axis ) );
-			boundMax[axis] = std::max( boundMax[axis], NodeDataTraits<NodeData>::getAxis( *buildNodes[i].first, axis ) );
+	for( uint32_t i = begin; i < end; ++i ) {
+		for( unsigned char k = 0; k < K; ++k ) {
+			boundMin[k] = std::min( boundMin[k], points[i].mCoords[k] );
+			boundMax[k] = std::max( boundMax[k], points[i].mCoords[k] );
 		}
 	}
-	int splitAxis = 0;
-	float maxExtent = boundMax[0] - boundMin[0];
+	unsigned char axis = 0;
 	for( unsigned char k = 1; k < K; ++k ) {
-		if( boundMax[k] - boundMin[k] > maxExtent ) {
-			splitAxis = k;
-			maxExtent = boundMax[k] - boundMin[k];
-		}	
+		if( boundMax[k] - boundMin[k] > boundMax[axis] - boundMin[axis] )
+			axis = k;
 	}
-	uint32_t splitPos = ( start + end ) / 2;
-	std::nth_element( &buildNodes[start], &buildNodes[splitPos], &buildNodes[end-1] + 1, CompareNode<NodeData>(splitAxis) );
-	// Allocate kd-tree node and continue recursively
-	nodes[nodeNum].init( NodeDataTraits<NodeData>::getAxis( *buildNodes[splitPos].first, splitAxis ), splitAxis );
-	mNodeData[nodeNum] = buildNodes[splitPos];
-	if( start < splitPos ) {
-		nodes[nodeNum].hasLeftChild = 1;
-		uint32_t childNum = nextFreeNode++;
-		recursiveBuild( childNum, start, splitPos, buildNodes );
+
+	const uint32_t mid = begin + count / 2;
+	std::nth_element( points + begin, points + mid, points + end, [axis]( const BuildPoint &a, const BuildPoint &b ) { return a.mCoords[axis] < b.mCoords[axis]; } );
+	const uint32_t children = numNodes->fetch_add( 2 );
+	node.mSplit = points[mid].mCoords[axis];
+	node.mFirst = children;
+	node.mCount = 0;
+	node.mAxis = axis;
+
+	if( parallelDepth > 0 && count >= PARALLEL_BUILD_SIZE ) {
+		std::thread leftThread( [=] { buildNode( children, begin, mid, points, numNodes, parallelDepth - 1 ); } );
+		buildNode( children + 1, mid, end, points, numNodes, parallelDepth - 1 );
+		leftThread.join();
 	}
-	if( splitPos + 1 < end ) {
-		nodes[nodeNum].rightChild = nextFreeNode++;
-		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
+	else {
+		buildNode( children, begin, mid, points, numNodes, parallelDepth );
+		buildNode( children + 1, mid, end, points, numNodes, parallelDepth );
+	}
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::getCoords( const NodeData &p, float result[K] ) const
+{
+	for( unsigned char k = 0; k < K; ++k )
+		result[k] = NodeDataTraits<NodeData>::getAxis( p, k );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+ template<typename LeafFn>
+void KdTree<NodeData, K, LookupProc>::traverse( const float p[K], float &maxDistSqrd, LeafFn &&fn ) const
+{
+	if( mNodes.empty() )
+		return;
+
+	// median splits keep the depth below the number of bits of the point count
+	struct StackEntry {
+		uint32_t	mNode;
+		float		mDistSqrd;
+	} stack[64];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+	float nodeDistSqrd = 0;
+	while( true ) {
+		if( nodeDistSqrd <= maxDistSqrd ) {
+			const Node &node = mNodes[nodeIndex];
+			if( node.mCount == 0 ) {
+				// descend into the child on the side of p first, and visit the other one later if it's still close enough
+				const float diff = p[node.mAxis] - node.mSplit;
+				stack[stackSize].mNode = node.mFirst + ( diff < 0 ? 1 : 0 );
+				stack[stackSize].mDistSqrd = diff * diff;
+				++stackSize;
+				nodeIndex = node.mFirst + ( diff < 0 ? 0 : 1 );
+				continue;
+			}
+
+			float distSqrd[LEAF_SIZE] = {};
+			for( unsigned char k = 0; k < K; ++k ) {
+				const float *coords = mCoords[k].data() + node.mFirst;
+				for( uint32_t i = 0; i < node.mCount; ++i ) {
+					const float v = coords[i] - p[k];
+					distSqrd[i] += v * v;
+				}
+			}
+			for( uint32_t i = 0; i < node.mCount; ++i ) {
+				if( distSqrd[i] <= maxDistSqrd )
+					fn( node.mFirst + i, distSqrd[i] );
+			}
+		}
+
+		if( stackSize == 0 )
+			break;
+		--stackSize;
+		nodeIndex = stack[stackSize].mNode;
+		nodeDistSqrd = stack[stackSize].mDistSqrd;
 	}
 }
 
@@ -219,86 +322,105 @@ void KdTree<NodeData, K, LookupProc>::lookup( const NodeData &p, const LookupPro
 {
 	float maxDistSqrd = maxDist * maxDist;
 	float pt[K];
-	for( unsigned char k = 0; k < K; ++k )
-		pt[k] = NodeDataTraits<NodeData>::getAxis( p, k );
-
-	privateLookup( 0, pt, proc, maxDistSqrd );
+	getCoords( p, pt );
+	traverse( pt, maxDistSqrd, [&]( uint32_t slot, float distSqrd ) {
+		if( distSqrd < maxDistSqrd )
+			proc.process( mIndices[slot], distSqrd, maxDistSqrd );
+	} );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::privateLookup( uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared ) const 
+size_t KdTree<NodeData, K, LookupProc>::findNearestSlots( const float p[K], size_t k, uint32_t *resultSlots, float *resultDistancesSqrd, float maxDistSqrd ) const
 {
-	KdNode<K> *node = &nodes[nodeNum];
-	// process kd-tree node's children
-	int axis = node->splitAxis;
-	if( axis != K ) {
-		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
-		if( p[axis] <= node->splitPos ) {
-			if(node->hasLeftChild)
-				privateLookup( nodeNum + 1, p, process, maxDistSquared );
-			if( ( dist2 < maxDistSquared ) && ( node->rightChild < nNodes ) )
-				privateLookup( node->rightChild, p, process, maxDistSquared );
-		}
-		else {
-			if( node->rightChild < nNodes )
-				privateLookup( node->rightChild, p, process, maxDistSquared );
-			if( ( dist2 < maxDistSquared ) && node->hasLeftChild )
-				privateLookup( nodeNum + 1, p, process, maxDistSquared );
+	if( k == 0 )
+		return 0;
+
+	// keep the k closest points sorted by distance, and only search closer than the farthest of them once there are k
+	size_t numFound = 0;
+	traverse( p, maxDistSqrd, [&]( uint32_t slot, float distSqrd ) {
+		if( distSqrd >= maxDistSqrd )
+			return;
+		size_t i = ( numFound < k ) ? numFound++ : k - 1;
+		for( ; i > 0 && resultDistancesSqrd[i - 1] > distSqrd; --i ) {
+			resultDistancesSqrd[i] = resultDistancesSqrd[i - 1];
+			resultSlots[i] = resultSlots[i - 1];
 		}
-	}
-	// Hand kd-tree node to processing function
-	float distSqr = 0.0f;
-	for( unsigned char k = 0; k < K; ++k ) {
-		float v = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, k ) - p[k];
-		distSqr += v * v;
-	}
-	
-	if( distSqr < maxDistSquared )
-		process.process( mNodeData[nodeNum].second, distSqr, maxDistSquared );
+		resultDistancesSqrd[i] = distSqrd;
+		resultSlots[i] = slot;
+		if( numFound == k )
+			maxDistSqrd = resultDistancesSqrd[k - 1];
+	} );
+
+	return numFound;
 }
 
 // Find Nearest
 template<typename NodeData, unsigned char K, typename LookupProc>
 void KdTree<NodeData, K, LookupProc>::findNearest( float p[K], float result[K], uint32_t *resultIndex ) const
 {
-	float maxDist = FLT_MAX;
-	*resultIndex = -1;
-	privateFindNearest( 0, p, maxDist, result, resultIndex );
+	uint32_t slot;
+	float distSqrd;
+	if( findNearestSlots( p, 1, &slot, &distSqrd, FLT_MAX ) == 0 ) {
+		*resultIndex = INVALID;
+		return;
+	}
+
+	for( unsigned char k = 0; k < K; ++k )
+		result[k] = mCoords[k][slot];
+	*resultIndex = mIndices[slot];
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+size_t KdTree<NodeData, K, LookupProc>::findNearest( const NodeData &p, size_t k, uint32_t *resultIndices, float *resultDistancesSqrd, float maxDist ) const
+{
+	float localDistancesSqrd[MAX_LOCAL_K];
+	std::unique_ptr<float[]> allocatedDistancesSqrd;
+	if( ! resultDistancesSqrd ) {
+		if( k > MAX_LOCAL_K )
+			allocatedDistancesSqrd.reset( new float[k] );
+		resultDistancesSqrd = ( k > MAX_LOCAL_K ) ? allocatedDistancesSqrd.get() : localDistancesSqrd;
+	}
+
+	float pt[K];
+	getCoords( p, pt );
+	const size_t numFound = findNearestSlots( pt, k, resultIndices, resultDistancesSqrd, ( maxDist < FLT_MAX ) ? maxDist * maxDist : FLT_MAX );
+	for( size_t i = 0; i < numFound; ++i )
+		resultIndices[i] = mIndices[resultIndices[i]];
+
+	return numFound;
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const
+void KdTree<NodeData, K, LookupProc>::findNearest( const NodeData *points, size_t numPoints, size_t k, uint32_t *resultIndices, float *resultDistancesSqrd, float maxDist ) const
 {
-	KdNode<K> *node = &nodes[nodeNum];
-	// process kd-tree node's children
-	int axis = node->splitAxis;
-	if( axis != K ) {
-		float dist2 = (p[axis] - node->splitPos) * (p[axis] - node->splitPos);
-		if( p[axis] <= node->splitPos ) {
-			if( node->hasLeftChild )
-				privateFindNearest( nodeNum+1, p, maxDistSquared, result, resultIndex );
-			if( ( dist2 < maxDistSquared ) && ( node->rightChild < nNodes) )
-				privateFindNearest( node->rightChild, p, maxDistSquared, result, resultIndex );
+	parallelFor( 0, numPoints, PARALLEL_QUERY_SIZE, [&]( size_t begin, size_t end ) {
+		std::vector<float> distancesSqrd( resultDistancesSqrd ? 0 : k );
+		for( size_t i = begin; i < end; ++i ) {
+			uint32_t *indices = resultIndices + i * k;
+			float *dists = resultDistancesSqrd ? resultDistancesSqrd + i * k : distancesSqrd.data();
+			const size_t numFound = findNearest( points[i], k, indices, dists, maxDist );
+			std::fill( indices + numFound, indices + k, INVALID );
+			if( resultDistancesSqrd )
+				std::fill( dists + numFound, dists + k, FLT_MAX );
 		}
-		else {
-			if( node->rightChild < nNodes)
-				privateFindNearest(node->rightChild,
-				              p,
-							  maxDistSquared, result, resultIndex );
-			if( dist2 < maxDistSquared && node->hasLeftChild)
-				privateFindNearest(nodeNum+1,
-				              p,
-							  maxDistSquared, result, resultIndex );
-		}
-	}
-	
-	float distSqr = NodeDataTraits<NodeData>::distanceSquared( *mNodeData[nodeNum].first, p );
-	if( distSqr < maxDistSquared ) {
-		maxDistSquared = distSqr;
-		for( unsigned char k = 0; k < K; ++k )
-			result[k] = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, k );
-		*resultIndex = mNodeData[nodeNum].second;
-	}
+	} );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+size_t KdTree<NodeData, K, LookupProc>::findInRadius( const NodeData &p, float radius, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSqrd ) const
+{
+	float pt[K];
+	getCoords( p, pt );
+	float radiusSqrd = radius * radius;
+	size_t numFound = 0;
+	traverse( pt, radiusSqrd, [&]( uint32_t slot, float distSqrd ) {
+		resultIndices->push_back( mIndices[slot] );
+		if( resultDistancesSqrd )
+			resultDistancesSqrd->push_back( distSqrd );
+		++numFound;
+	} );
+
+	return numFound;
 }
 
 } // namespace ci
@@ -35,6 +35,7 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 namespace cinder { namespace log {
 
@@ -47,6 +48,14 @@ typedef enum {
 	LEVEL_FATAL
 } Level;
 
+//! Determines what happens to records logged while LogManager's asynchronous queue is full. \see LogManager::enableAsync()
+typedef enum {
+	//! The logging thread waits until the background thread has made room
+	OVERFLOW_BLOCK,
+	//! Records below LEVEL_ERROR are dropped and counted, errors and fatal records still wait
+	OVERFLOW_DROP
+} OverflowPolicy;
+
 struct CI_API Location {
 	Location() {}
 
@@ -191,8 +200,39 @@ protected:
 //! \brief LogManager manages a stack of all active Loggers.
 //!
 //! LogManager's default state contains a single LoggerConsole.  LogManager allows for adding and removing Loggers via their pointer values.
+//! By default records are written to every Logger on the logging thread while holding the manager's mutex. enableAsync() instead queues
+//! them and writes them from a background thread, so that logging from time-critical threads (audio, rendering) doesn't wait on slow loggers.
 class CI_API LogManager {
 public:
+	//! Options for enableAsync()
+	struct CI_API AsyncOptions {
+		AsyncOptions()
+			: mCapacity( 8192 ), mMaxBatchSize( 256 ), mOverflowPolicy( OVERFLOW_BLOCK ), mFlushOnCrash( false )
+		{}
+
+		//! Sets the number of records the queue can hold, which is rounded up to a power of two. Defaults to \c 8192.
+		AsyncOptions&	capacity( size_t numRecords )				{ mCapacity = numRecords; return *this; }
+		//! Sets the maximum number of records written to the Loggers each time the background thread locks the Logger stack. Defaults to \c 256.
+		AsyncOptions&	maxBatchSize( size_t numRecords )			{ mMaxBatchSize = numRecords; return *this; }
+		//! Sets what happens to records logged while the queue is full. Defaults to \c OVERFLOW_BLOCK.
+		AsyncOptions&	overflowPolicy( OverflowPolicy policy )		{ mOverflowPolicy = policy; return *this; }
+		//! Sets whether queued records are written out when the process crashes with SIGSEGV, SIGABRT, SIGFPE or SIGILL, or calls std::terminate(). This installs
+		//! process-wide handlers that chain to the ones already in place, and then stay installed for the life of the process. Defaults to \c false.
+		AsyncOptions&	flushOnCrash( bool enable = true )			{ mFlushOnCrash = enable; return *this; }
+
+		size_t			getCapacity() const			{ return mCapacity; }
+		size_t			getMaxBatchSize() const		{ return mMaxBatchSize; }
+		OverflowPolicy	getOverflowPolicy() const	{ return mOverflowPolicy; }
+		bool			isFlushOnCrash() const		{ return mFlushOnCrash; }
+
+	  private:
+		size_t			mCapacity, mMaxBatchSize;
+		OverflowPolicy	mOverflowPolicy;
+		bool			mFlushOnCrash;
+	};
+
+	~LogManager();
+
 	// Returns a pointer to the shared instance. To enable logging during shutdown, this instance is leaked at shutdown.
 	static LogManager* instance()	{ return sInstance; }
 	//! Destroys the shared instance. Useful to remove false positives with leak detectors like valgrind.
@@ -217,6 +257,18 @@ public:
 	std::mutex& getMutex() const			{ return mMutex; }
 	
 	void write( const Metadata &meta, const std::string &text );
+
+	//! Moves writing to the Loggers onto a background thread. Logging threads push formatted records into a lock-free queue, which the
+	//! background thread writes to the Loggers in batches. Records from any one thread keep their order. LEVEL_FATAL records block until written.
+	void		enableAsync( const AsyncOptions &options = AsyncOptions() );
+	//! Writes out all queued records, stops the background thread and returns to writing on the logging thread
+	void		disableAsync();
+	//! Returns whether records are written to the Loggers from a background thread
+	bool		isAsync() const		{ return mAsyncEnabled.load(); }
+	//! Blocks until every record logged before the call has been written to the Loggers. Does nothing when not asynchronous.
+	void		flush();
+	//! Returns the number of records dropped with OVERFLOW_DROP since enableAsync() was last called, or \c 0 when not asynchronous
+	uint64_t	getNumDroppedRecords() const;
 	
 	template<typename LoggerT, typename... Args>
 	std::shared_ptr<LoggerT> makeLogger( Args&&... args );
@@ -227,9 +279,26 @@ public:
 protected:
 	LogManager();
 
+	class AsyncQueue;
+	
+	//! Writes to every Logger on the calling thread
+	void	writeSync( const Metadata &meta, const std::string &text );
+	//! Waits up to \a timeoutMs for the queue to be written out, returning whether it was. Used when crashing.
+	bool	flushWithTimeout( int timeoutMs );
+	//! Writes out and destroys the queue, if any. Called with mAsyncMutex held.
+	void	stopAsync();
+
+	friend class AsyncQueue;
+
 	std::vector<LoggerRef>			mLoggers;
 	
 	mutable std::mutex				mMutex;
+
+	std::unique_ptr<AsyncQueue>		mAsync;
+	std::atomic<bool>				mAsyncEnabled;
+	std::atomic<bool>				mAsyncDraining; // set while stopAsync() writes out the queue
+	std::atomic<int>				mNumAsyncWriters; // threads currently inside write() with asynchronous writing enabled
+	mutable std::mutex				mAsyncMutex; // serializes enableAsync() and disableAsync()
 	
 	static LogManager 				*sInstance;
 };
@@ -0,0 +1,144 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Exception.h"
+#include "cinder/Frustum.h"
+#include "cinder/Ray.h"
+#include "cinder/Sphere.h"
+
+#include <memory>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class LooseOctree>	LooseOctreeRef;
+
+/** \brief Dynamic spatial index of axis-aligned boxes, for culling and querying scenes whose objects move every frame.
+ *
+ *  Each box is stored in the deepest octree cell whose size is at least that of the box, chosen by the center of the box. Cells are
+ *  "loose": their bounds are twice the size of the cell, so every box fits entirely inside the cell it is stored in, and inserting,
+ *  moving or removing a box only touches the cells on the path to it. Boxes whose center lies outside the bounds given at construction
+ *  are stored at the root, which is always tested, so the index remains correct but becomes slower as more boxes leave the bounds.
+ *
+ *  The boxes of each cell are stored as separate arrays of each coordinate, which the frustum query tests against all six planes four
+ *  boxes at a time using SIMD instructions where available. Cells fully inside the frustum are accepted without testing their boxes.
+ *
+ *  Boxes are identified by the id returned from insert(), which remains valid until it is passed to remove(). Ids are reused afterwards.
+**/
+class CI_API LooseOctree {
+  public:
+	class CI_API Options {
+	  public:
+		Options() : mMaxDepth( 6 ) {}
+
+		//! Sets the depth of the smallest cells, whose size is the size of the bounds divided by 2^depth. Default is \c 6.
+		Options&	maxDepth( int depth ) { mMaxDepth = depth; return *this; }
+
+		int			getMaxDepth() const { return mMaxDepth; }
+
+	  protected:
+		int		mMaxDepth;
+	};
+
+	//! Creates an index covering \a bounds, which is expanded to a cube around its center.
+	LooseOctree( const AxisAlignedBox &bounds, const Options &options = Options() );
+
+	static LooseOctreeRef	create( const AxisAlignedBox &bounds, const Options &options = Options() ) { return std::make_shared<LooseOctree>( bounds, options ); }
+
+	//! Adds \a box to the index and returns its id.
+	uint32_t	insert( const AxisAlignedBox &box );
+	//! Updates the bounds of the box with id \a id to \a box. Cheapest when the box stays in the same cell. Throws LooseOctreeExc if \a id is not in the index.
+	void		move( uint32_t id, const AxisAlignedBox &box );
+	//! Removes the box with id \a id from the index. Throws LooseOctreeExc if \a id is not in the index.
+	void		remove( uint32_t id );
+	//! Removes every box. Invalidates all ids.
+	void		clear();
+
+	//! Returns whether \a id refers to a box in the index.
+	bool			contains( uint32_t id ) const { return id < mItems.size() && mItems[id].mNode != INVALID; }
+	//! Returns the bounds of the box with id \a id, which must be in the index.
+	AxisAlignedBox	getBounds( uint32_t id ) const { return AxisAlignedBox( mItems[id].mMin, mItems[id].mMax ); }
+
+	//! Appends the id of every box which intersects \a frustum to \a result, with the same result as Frustum::intersects() for each box. Returns the number of ids appended.
+	size_t	query( const Frustum &frustum, std::vector<uint32_t> *result ) const;
+	//! Appends the id of every box which overlaps \a box to \a result. Returns the number of ids appended.
+	size_t	query( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const;
+	//! Appends the id of every box which overlaps \a sphere to \a result. Returns the number of ids appended.
+	size_t	query( const Sphere &sphere, std::vector<uint32_t> *result ) const;
+	//! Appends the id of every box hit by \a ray at a distance between 0 and \a maxDistance to \a result, sorted by the distance at which the ray enters the box. Returns the number of ids appended.
+	size_t	intersect( const Ray &ray, std::vector<uint32_t> *result, float maxDistance = FLT_MAX ) const;
+
+	//! Returns the number of boxes in the index.
+	size_t	getNumItems() const { return mItems.size() - mFreeIds.size(); }
+	//! Returns the number of cells allocated, including empty cells kept for reuse.
+	size_t	getNumNodes() const { return mNodes.size(); }
+	//! Returns the cube covered by the index.
+	AxisAlignedBox	getBounds() const { return AxisAlignedBox( mCenter - vec3( mHalfSize ), mCenter + vec3( mHalfSize ) ); }
+	//! Returns the options used to create the index.
+	const Options&	getOptions() const { return mOptions; }
+
+  protected:
+	static const uint32_t INVALID = 0xFFFFFFFF;
+
+	//! An octree cell. The bounds of a box are kept in separate arrays for the minimum and maximum of each axis, in the order of mIds.
+	struct Node {
+		vec3					mCenter;
+		float					mHalfSize;
+		uint32_t				mParent;
+		uint32_t				mChildren[8];
+		//! Number of boxes in this cell and its descendants
+		uint32_t				mSubtreeCount;
+		std::vector<float>		mBounds[6];
+		std::vector<uint32_t>	mIds;
+	};
+
+	struct Item {
+		vec3		mMin, mMax;
+		uint32_t	mNode, mSlot;
+	};
+
+	//! Returns the cell \a box belongs in, creating it and its ancestors if necessary.
+	uint32_t	findNode( const vec3 &min, const vec3 &max );
+	void		addToNode( uint32_t id, uint32_t nodeIndex );
+	void		removeFromNode( uint32_t id );
+	//! Appends the id of every box in the cell \a nodeIndex and its descendants to \a result.
+	void		appendSubtree( uint32_t nodeIndex, std::vector<uint32_t> *result ) const;
+
+	Options					mOptions;
+	vec3					mCenter;
+	float					mHalfSize;
+	std::vector<Node>		mNodes;
+	std::vector<Item>		mItems;
+	std::vector<uint32_t>	mFreeIds;
+};
+
+class CI_API LooseOctreeExc : public Exception {
+  public:
+	LooseOctreeExc( const std::string &description ) : Exception( description ) {}
+};
+
+} // namespace cinder
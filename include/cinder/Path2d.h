@@ -28,14 +28,27 @@
 #include "cinder/Exception.h"
 #include "cinder/Matrix.h"
 
+#include <memory>
 #include <vector>
 
 namespace cinder {
 
+/** \brief A 2D path made of lines, quadratic and cubic Bezier segments.
+ *
+ *  The arc length calculations (calcTimeForDistance(), calcNormalizedTime() and the batched calcTimesForDistances() and
+ *  calcPositionsForDistances()) share a table of arc lengths sampled along each segment, which is built on first use and discarded by
+ *  every non-const member function. calcLength() uses it when it has been built. Avoid keeping the references returned by the non-const accessors across those calls. Const member
+ *  functions may be called concurrently, and copies share the table until either is modified.
+**/
 class CI_API Path2d {
  public:
 	Path2d() {}
 	explicit Path2d( const BSpline2f &spline, float subdivisionStep = 0.01f );
+	Path2d( const Path2d &rhs );
+	Path2d( Path2d &&rhs ) = default;
+
+	Path2d&	operator=( const Path2d &rhs );
+	Path2d&	operator=( Path2d &&rhs ) = default;
 
 	//! Sets the start point of the path to \a p. This is the only legal first command, and only legal as the first command.
 	void	moveTo( const vec2 &p );
@@ -53,14 +66,14 @@ class CI_API Path2d {
 	void	arcTo( float x, float y, float tanX, float tanY, float radius) { arcTo( vec2( x, y ), vec2( tanX, tanY ), radius ); }
 	
 	//! Closes the path, by drawing a straight line from the first to the last point. This is only legal as the last command.
-	void	close() { mSegments.push_back( CLOSE ); }
+	void	close() { invalidateArcLengths(); mSegments.push_back( CLOSE ); }
 	bool	isClosed() const { return ( mSegments.size() > 1 ) && mSegments.back() == CLOSE; }
     
 	//! Reverses the order of the path's points, inverting its winding order
     void	reverse();
 	
 	bool	empty() const { return mPoints.empty(); }
-	void	clear() { mSegments.clear(); mPoints.clear(); }
+	void	clear() { invalidateArcLengths(); mSegments.clear(); mPoints.clear(); }
 	size_t	getNumSegments() const { return mSegments.size(); }
 	size_t	getNumPoints() const { return mPoints.size(); }
 
@@ -93,18 +106,18 @@ class CI_API Path2d {
 	Path2d		getSubPath( float startT, float endT ) const;
 
 	const std::vector<vec2>&	getPoints() const { return mPoints; }
-	std::vector<vec2>&			getPoints() { return mPoints; }
+	std::vector<vec2>&			getPoints() { invalidateArcLengths(); return mPoints; }
 	const vec2&				getPoint( size_t point ) const { return mPoints[point]; }
-	vec2&						getPoint( size_t point ) { return mPoints[point]; }
+	vec2&						getPoint( size_t point ) { invalidateArcLengths(); return mPoints[point]; }
 	const vec2&				getCurrentPoint() const { return mPoints.back(); }
-	void						setPoint( size_t index, const vec2 &p ) { mPoints[index] = p; }
+	void						setPoint( size_t index, const vec2 &p ) { invalidateArcLengths(); mPoints[index] = p; }
 
 	enum SegmentType { MOVETO, LINETO, QUADTO, CUBICTO, CLOSE };
 	static const int sSegmentTypePointCounts[];
 	SegmentType		getSegmentType( size_t segment ) const { return mSegments[segment]; }
 
 	const std::vector<SegmentType>&	getSegments() const { return mSegments; }
-	std::vector<SegmentType>&		getSegments() { return mSegments; }
+	std::vector<SegmentType>&		getSegments() { invalidateArcLengths(); return mSegments; }
 
 	//! Appends a new segment of type \a segmentType to the Path2d. \a points must contain an appropriate number of points for the segment type. Note that while the first point for the segment is always required, it will only be used when the Path2d is initially empty.
 	void	appendSegment( SegmentType segmentType, const vec2 *points );
@@ -135,11 +148,16 @@ class CI_API Path2d {
 	//! Calculates the length of a specific segment in the range [\a minT,\a maxT], where \a minT and \a maxT range from 0 to 1 and are relative to the segment
 	float	calcSegmentLength( size_t segment, float minT = 0, float maxT = 1 ) const;
 	
-	//! Calculates the t value corresponding to \a relativeTime in the range [0,1) within epsilon of \a tolerance. For example, \a relativeTime of 0.5f returns the t-value corresponding to half the length. \a maxIterations dictates the number of refinement loop iterations allowed, setting an upper bound for worst-case performance. Consider a Path2dCalcCache if using frequently.
+	//! Calculates the t value corresponding to \a relativeTime in the range [0,1) within epsilon of \a tolerance. For example, \a relativeTime of 0.5f returns the t-value corresponding to half the length. \a maxIterations dictates the number of refinement loop iterations allowed, setting an upper bound for worst-case performance.
 	float	calcNormalizedTime( float relativeTime, bool wrap = true, float tolerance = 1.0e-03f, int maxIterations = 16 ) const;
-	//! Calculates a t-value corresponding to arc length \a distance. If \a wrap then the t-value loops inside the 0-1 range as \a distance exceeds the arc length. Consider a Path2dCalcCache if using frequently.
+	//! Calculates a t-value corresponding to arc length \a distance. If \a wrap then the t-value loops inside the 0-1 range as \a distance exceeds the arc length. Consider calcTimesForDistances() for many distances.
 	float	calcTimeForDistance( float distance, bool wrap = true, float tolerance = 1.0e-03f, int maxIterations = 16 ) const;
 
+	//! Calculates the t-values corresponding to the \a count arc lengths \a distances into \a resultTimes. Interpolates the arc length table without further refinement, to within about 1/10000 of the length of each segment. If \a wrap then distances outside the arc length loop around, otherwise they're clamped.
+	void	calcTimesForDistances( const float *distances, size_t count, float *resultTimes, bool wrap = true ) const;
+	//! Calculates the positions at the \a count arc lengths \a distances into \a resultPositions and, if \a resultTangents isn't null, the un-normalized tangents into \a resultTangents. Interpolates like calcTimesForDistances().
+	void	calcPositionsForDistances( const float *distances, size_t count, vec2 *resultPositions, vec2 *resultTangents = nullptr, bool wrap = true ) const;
+
 
 	static int	calcQuadraticBezierMonotoneRegions( const vec2 p[3], float resultT[2] );
 	static vec2	calcQuadraticBezierPos( const vec2 p[3], float t );
@@ -167,9 +185,23 @@ class CI_API Path2d {
 
 	//! Returns the point on segment \a segment that is closest to \a pt. The \a firstPoint parameter can be used as an optimization if known, otherwise pass 0.
 	vec2	calcClosestPoint( const vec2 &pt, size_t segment, size_t firstPoint ) const;
+
+	//! Returns the position on segment \a segment, whose first point is \a firstPoint, at parameter \a t
+	vec2	getSegmentPosition( size_t segment, size_t firstPoint, float t ) const;
+	//! Returns the tangent on segment \a segment, whose first point is \a firstPoint, at parameter \a t
+	vec2	getSegmentTangent( size_t segment, size_t firstPoint, float t ) const;
+
+	struct ArcLengthTable;
+	//! Returns the arc length table, building it if necessary
+	std::shared_ptr<const ArcLengthTable>	getArcLengthTable() const;
+	void									invalidateArcLengths() { mArcLengthTable.reset(); }
+	//! Returns the t-value at arc length \a distance, which lies in the range [0,length], refined until within \a tolerance or for at most \a maxIterations
+	float									solveTimeForDistance( const ArcLengthTable &table, float distance, float tolerance, int maxIterations ) const;
 	
 	std::vector<vec2>			mPoints;
 	std::vector<SegmentType>	mSegments;
+	//! Accessed atomically, since const member functions build it on demand
+	mutable std::shared_ptr<const ArcLengthTable>	mArcLengthTable;
 };
 
 CI_API inline std::ostream& operator<<( std::ostream &out, const Path2d &p )
@@ -202,7 +234,7 @@ CI_API inline std::ostream& operator<<( std::ostream &out, const Path2d &p )
 	return out;
 }
 
-//! Accelerates the calculation of various operations on Path2d. Useful if doing repeated calculations, otherwise just use Path2d member functions.
+//! Keeps a copy of a Path2d along with its arc length table. Path2d caches its arc lengths itself, so this is only useful to keep a snapshot of a path that is modified elsewhere.
 class CI_API Path2dCalcCache {
   public:
 	Path2dCalcCache( const Path2d &path );
@@ -220,7 +252,6 @@ class CI_API Path2dCalcCache {
   private:
 	Path2d				mPath;
 	float				mLength;
-	std::vector<float>	mSegmentLengths;
 };
 
 class CI_API Path2dExc : public Exception {
@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/Channel.h"
 
 namespace cinder {
 
@@ -63,6 +64,29 @@ class CI_API Perlin
 	vec2	dnoise( float x, float y ) const;
 	vec3	dnoise( float x, float y, float z ) const;
 
+	/// Calculates a single octave of simplex noise, in the range [-1, 1]. Uses the same permutation table as noise(), so it follows the seed.
+	float	simplex( float x, float y ) const;
+	float	simplex( const vec2 &v ) const			{ return simplex( v.x, v.y ); }
+	float	simplex( float x, float y, float z ) const;
+	float	simplex( const vec3 &v ) const			{ return simplex( v.x, v.y, v.z ); }
+
+	/// Batched variants, evaluating \a count points into \a result. Several points are processed at once with SIMD where available, matching the single point versions.
+	void	fBm( const vec2 *points, size_t count, float *result ) const;
+	void	fBm( const vec3 *points, size_t count, float *result ) const;
+	void	dfBm( const vec2 *points, size_t count, vec2 *result ) const;
+	void	dfBm( const vec3 *points, size_t count, vec3 *result ) const;
+	void	noise( const vec2 *points, size_t count, float *result ) const;
+	void	noise( const vec3 *points, size_t count, float *result ) const;
+	void	dnoise( const vec2 *points, size_t count, vec2 *result ) const;
+	void	dnoise( const vec3 *points, size_t count, vec3 *result ) const;
+	void	simplex( const vec2 *points, size_t count, float *result ) const;
+	void	simplex( const vec3 *points, size_t count, float *result ) const;
+
+	/// Fills \a channel with fBm() sampled at \a origin + \a scale * ( x, y ) for each pixel ( x, y ). Rows are distributed across threads.
+	void	fBm( Channel32f *channel, const vec2 &origin = vec2( 0 ), const vec2 &scale = vec2( 1 ) ) const;
+	/// Fills \a channel with a single octave of noise() sampled at \a origin + \a scale * ( x, y ) for each pixel ( x, y ). Rows are distributed across threads.
+	void	noise( Channel32f *channel, const vec2 &origin = vec2( 0 ), const vec2 &scale = vec2( 1 ) ) const;
+
  private:
 	void	initPermutationTable();
 
@@ -67,6 +67,10 @@ class CI_API PolyLineT {
 	PolyLineT<T>	getOffset( const T &offsetBy ) const;
 	void			reverse();
 	PolyLineT<T>	reversed() const;
+	//! Simplifies the PolyLine with the Ramer-Douglas-Peucker algorithm, removing points closer than \a tolerance to the simplified line. End points of open PolyLines are kept.
+	void			simplify( float tolerance );
+	//! Returns a copy simplified with the Ramer-Douglas-Peucker algorithm, see simplify().
+	PolyLineT<T>	simplified( float tolerance ) const;
 
 	//! Returns whether the point \a pt is contained within the boundaries of the PolyLine
 	bool	contains( const vec2 &pt ) const;
@@ -0,0 +1,110 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/PolyLine.h"
+#include "cinder/Shape2d.h"
+
+#include <vector>
+
+namespace cinder { namespace polygon {
+
+//! Rule used to decide which regions of a set of (possibly self-intersecting or overlapping) contours are filled, based on their winding number
+typedef enum FillRule { FILL_EVEN_ODD, FILL_NONZERO, FILL_POSITIVE, FILL_NEGATIVE } FillRule;
+//! Boolean operation applied to a subject and a clip polygon
+typedef enum Operation { UNION, INTERSECTION, DIFFERENCE, XOR } Operation;
+//! Shape of the corners created where the offset edges of convex vertices meet
+typedef enum JoinType { JOIN_MITER, JOIN_ROUND, JOIN_BEVEL } JoinType;
+
+/** Calculates the boolean \a op of the polygons \a subject and \a clip, each of which may consist of several contours.
+	Contours are always treated as closed and may self-intersect, overlap or touch each other; \a fillRule determines their interior.
+	The result consists of closed, non-intersecting contours without repeated end points. Outer contours are counterclockwise
+	and holes are clockwise (when the y axis points up), so the result is filled the same with either the even-odd or the nonzero rule.
+	Intersections are found with a single Bentley-Ottmann sweep in double precision, which runs in O((n + k) log n) for \a n edges and \a k intersections. **/
+CI_API std::vector<PolyLine2f>	calcBoolean( Operation op, const std::vector<PolyLine2f> &subject, const std::vector<PolyLine2f> &clip, FillRule fillRule = FILL_EVEN_ODD );
+//! Calculates the boolean \a op of the shapes \a subject and \a clip. Curves are subdivided with \a approximationScale, see Path2d::subdivide(). The resulting Shape2d consists of straight closed contours.
+CI_API Shape2d					calcBoolean( Operation op, const Shape2d &subject, const Shape2d &clip, FillRule fillRule = FILL_EVEN_ODD, float approximationScale = 1.0f );
+
+//! Calculates the union of \a a and \a b. See calcBoolean().
+inline std::vector<PolyLine2f>	calcUnion( const std::vector<PolyLine2f> &a, const std::vector<PolyLine2f> &b, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( UNION, a, b, fillRule ); }
+//! Calculates the union of the contours of \a polygons, which resolves self-intersections and overlaps into simple contours. See calcBoolean().
+inline std::vector<PolyLine2f>	calcUnion( const std::vector<PolyLine2f> &polygons, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( UNION, polygons, std::vector<PolyLine2f>(), fillRule ); }
+//! Calculates the intersection of \a a and \a b. See calcBoolean().
+inline std::vector<PolyLine2f>	calcIntersection( const std::vector<PolyLine2f> &a, const std::vector<PolyLine2f> &b, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( INTERSECTION, a, b, fillRule ); }
+//! Calculates the difference of \a subject minus \a clip. See calcBoolean().
+inline std::vector<PolyLine2f>	calcDifference( const std::vector<PolyLine2f> &subject, const std::vector<PolyLine2f> &clip, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( DIFFERENCE, subject, clip, fillRule ); }
+//! Calculates the symmetric difference of \a a and \a b. See calcBoolean().
+inline std::vector<PolyLine2f>	calcXor( const std::vector<PolyLine2f> &a, const std::vector<PolyLine2f> &b, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( XOR, a, b, fillRule ); }
+
+//! Calculates the union of \a a and \a b. See calcBoolean().
+inline Shape2d	calcUnion( const Shape2d &a, const Shape2d &b, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( UNION, a, b, fillRule ); }
+//! Calculates the intersection of \a a and \a b. See calcBoolean().
+inline Shape2d	calcIntersection( const Shape2d &a, const Shape2d &b, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( INTERSECTION, a, b, fillRule ); }
+//! Calculates the difference of \a subject minus \a clip. See calcBoolean().
+inline Shape2d	calcDifference( const Shape2d &subject, const Shape2d &clip, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( DIFFERENCE, subject, clip, fillRule ); }
+//! Calculates the symmetric difference of \a a and \a b. See calcBoolean().
+inline Shape2d	calcXor( const Shape2d &a, const Shape2d &b, FillRule fillRule = FILL_EVEN_ODD ) { return calcBoolean( XOR, a, b, fillRule ); }
+
+//! Options for calcOffset()
+class CI_API OffsetOptions {
+  public:
+	OffsetOptions()
+		: mJoinType( JOIN_MITER ), mMiterLimit( 2 ), mArcTolerance( 0.25f ), mFillRule( FILL_EVEN_ODD ), mApproximationScale( 1 )
+	{}
+
+	//! Sets the shape of convex corners. Default is \c JOIN_MITER.
+	OffsetOptions&	join( JoinType type ) { mJoinType = type; return *this; }
+	//! Sets the maximum distance of a miter point from its vertex, as a multiple of the offset. Longer miters are beveled, like SVG's \c stroke-miterlimit. Default is \c 2.
+	OffsetOptions&	miterLimit( float limit ) { mMiterLimit = limit; return *this; }
+	//! Sets the maximum distance between round joins and their true arcs. Default is \c 0.25.
+	OffsetOptions&	arcTolerance( float tolerance ) { mArcTolerance = tolerance; return *this; }
+	//! Sets the fill rule of the input contours. Default is \c FILL_EVEN_ODD.
+	OffsetOptions&	fillRule( FillRule rule ) { mFillRule = rule; return *this; }
+	//! Sets the scale used to subdivide the curves of a Shape2d, see Path2d::subdivide(). Default is \c 1.
+	OffsetOptions&	approximationScale( float scale ) { mApproximationScale = scale; return *this; }
+
+	JoinType	getJoinType() const { return mJoinType; }
+	float		getMiterLimit() const { return mMiterLimit; }
+	float		getArcTolerance() const { return mArcTolerance; }
+	FillRule	getFillRule() const { return mFillRule; }
+	float		getApproximationScale() const { return mApproximationScale; }
+
+  private:
+	JoinType	mJoinType;
+	float		mMiterLimit, mArcTolerance;
+	FillRule	mFillRule;
+	float		mApproximationScale;
+};
+
+/** Offsets the boundary of \a polygons by \a delta, growing the polygons for positive \a delta and shrinking (insetting) them for negative \a delta.
+	The input is first resolved with calcUnion(), the raw offset contours are then merged with calcBoolean() so that the result doesn't self-intersect. **/
+CI_API std::vector<PolyLine2f>	calcOffset( const std::vector<PolyLine2f> &polygons, float delta, const OffsetOptions &options = OffsetOptions() );
+//! Offsets the boundary of \a shape by \a delta. Curves are subdivided first, the resulting Shape2d consists of straight closed contours.
+CI_API Shape2d					calcOffset( const Shape2d &shape, float delta, const OffsetOptions &options = OffsetOptions() );
+
+//! Simplifies each contour of \a shape with the Ramer-Douglas-Peucker algorithm after subdividing its curves, see PolyLineT::simplify(). The resulting Shape2d consists of straight contours, which are closed where the original ones were.
+CI_API Shape2d	calcSimplified( const Shape2d &shape, float tolerance, float approximationScale = 1.0f );
+
+} } // namespace cinder::polygon
@@ -35,6 +35,10 @@ class CI_API Rand {
 		: mBase( seed )
 	{}
 
+	//! Constructs the generator for stream \a stream of \a seed. Distinct streams are independent, so parallel work can be split reproducibly by handing each task its own stream.
+	//! Stream 0 is the sequence of Rand( seed ).
+	Rand( uint32_t seed, uint64_t stream );
+
 	//! Re-seeds the random generator
 	void seed( uint32_t seedValue )
 	{
@@ -134,48 +138,50 @@ class CI_API Rand {
 	}
 
 	// STATICS
-	//! Resets the static random generator to a random seed
+	// Each thread uses its own static generator, so the static functions are safe to call concurrently. The first thread to
+	// use them is seeded with the master seed itself, later threads with independent streams derived from it. Streams are
+	// handed out in the order threads first use the statics, so only a single thread's sequence is reproducible from the
+	// master seed; for reproducible parallel work, give each task its own Rand( seed, stream ) instead.
+
+	//! Resets the static random generators to a random master seed
 	static void randomize()
 	{
-		sBase.seed( std::random_device{}() );
+		randSeed( std::random_device{}() );
 	}
 
-	//! Resets the static random generator to the specific seed \a seedValue
-	static void	randSeed( uint32_t seedValue )
-	{
-		sBase.seed( seedValue );
-	}
+	//! Resets the static random generators to the master seed \a seedValue. Every thread's generator is reseeded before its next use.
+	static void	randSeed( uint32_t seedValue );
 
 	//! returns a random boolean value
 	static bool randBool()
 	{
-		return sBase() & 1;
+		return getThreadGenerator().mBase() & 1;
 	}
 
 	//! returns a random integer in the range [-2147483648,2147483647]
 	static int32_t randInt()
 	{
-		return sBase();
+		return getThreadGenerator().mBase();
 	}
 
 	//! returns a random integer in the range [0,4294967296)
 	static uint32_t randUint()
 	{
-		return sBase();
+		return getThreadGenerator().mBase();
 	}
 
 	//! returns a random integer in the range [0,v)
 	static int32_t randInt( int32_t v )
 	{
 		if( v <= 0 ) return 0;
-		else return sBase() % v;
+		else return getThreadGenerator().mBase() % v;
 	}
 
 	//! returns a random integer in the range [0,v)
 	static uint32_t randUint( uint32_t v )
 	{
 		if( v == 0 ) return 0;
-		else return sBase() % v;
+		else return getThreadGenerator().mBase() % v;
 	}
 
 	//! returns a random integer in the range [a,b)
@@ -187,19 +193,20 @@ class CI_API Rand {
 	//! returns a random float in the range [0.0f,1.0f)
 	static float randFloat()
 	{
-		return sFloatGen( sBase );
+		ThreadGenerator &gen = getThreadGenerator();
+		return gen.mFloatGen( gen.mBase );
 	}
 
 	//! returns a random float in the range [0.0f,v)
 	static float randFloat( float v )
 	{
-		return sFloatGen( sBase ) * v;
+		return randFloat() * v;
 	}
 
 	//! returns a random float in the range [a,b)
 	static float randFloat( float a, float b )
 	{
-		return sFloatGen( sBase ) * ( b - a ) + a;
+		return randFloat() * ( b - a ) + a;
 	}
 
 	//! returns a random float in the range [a,b) or the range [-b,-a)
@@ -235,8 +242,8 @@ class CI_API Rand {
 	//! returns a random float via Gaussian distribution
 	static float randGaussian()
 	{
-		static std::normal_distribution<float> dist{};
-		return dist( sBase );
+		ThreadGenerator &gen = getThreadGenerator();
+		return gen.mNormDist( gen.mBase );
 	}
 
   private:
@@ -244,8 +251,147 @@ class CI_API Rand {
 	std::uniform_real_distribution<float>	mFloatGen;
 	std::normal_distribution<float>			mNormDist;
 
-	static std::mt19937 sBase;
-	static std::uniform_real_distribution<float> sFloatGen;
+	struct ThreadGenerator {
+		std::mt19937							mBase;
+		std::uniform_real_distribution<float>	mFloatGen;
+		std::normal_distribution<float>			mNormDist;
+		uint64_t								mSeedState = 0;
+		uint32_t								mStream = 0;
+	};
+
+	//! Returns the calling thread's static generator, reseeding it first if randSeed() was called since its last use
+	static ThreadGenerator&	getThreadGenerator();
+};
+
+//! Fast random generator based on xoshiro128**, with the same interface as Rand plus bulk generation into arrays.
+/** The generator runs four interleaved xoshiro128** streams, which lets the bulk functions produce four values per step with SIMD.
+	The bulk functions return the values the equivalent sequence of single calls would. Integers and nextFloats() over [0,1) match
+	exactly, and are the same on every platform. Floats scaled to other ranges, and the vector and Gaussian functions, may differ in
+	the last bits, because the compiler is free to fuse a multiply and add into an FMA in one path and not the other, and because
+	math libraries differ. A FastRand is small and cheap to seed, so the usual pattern for reproducible parallel work is one
+	FastRand( seed, taskIndex ) per task. **/
+class CI_API FastRand {
+  public:
+	//! Constructs a generator with a fixed default seed
+	FastRand()											{ seed( 0 ); }
+	//! Constructs the generator for stream \a stream of \a seed. Distinct streams are independent.
+	explicit FastRand( uint64_t seed, uint64_t stream = 0 )	{ this->seed( seed, stream ); }
+
+	//! Re-seeds the generator to stream \a stream of \a seed
+	void seed( uint64_t seed, uint64_t stream = 0 );
+
+	//! returns a random integer in the range [0,4294967296)
+	uint32_t nextUint()
+	{
+		if( mBufferIndex == 4 )
+			refill();
+		return mBuffer[mBufferIndex++];
+	}
+
+	//! returns a random integer in the range [0,v)
+	uint32_t nextUint( uint32_t v )
+	{
+		return (uint32_t)( ( (uint64_t)nextUint() * v ) >> 32 );
+	}
+
+	//! returns a random boolean value
+	bool nextBool()
+	{
+		return ( nextUint() >> 31 ) != 0;
+	}
+
+	//! returns a random integer in the range [-2147483648,2147483647]
+	int32_t nextInt()
+	{
+		return (int32_t)nextUint();
+	}
+
+	//! returns a random integer in the range [0,v)
+	int32_t nextInt( int32_t v )
+	{
+		if( v <= 0 ) return 0;
+		return (int32_t)nextUint( (uint32_t)v );
+	}
+
+	//! returns a random integer in the range [a,b)
+	int32_t nextInt( int32_t a, int32_t b )
+	{
+		return nextInt( b - a ) + a;
+	}
+
+	//! returns a random float in the range [0.0f,1.0f)
+	float nextFloat()
+	{
+		return ( nextUint() >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+
+	//! returns a random float in the range [0.0f,v)
+	float nextFloat( float v )
+	{
+		return nextFloat() * v;
+	}
+
+	//! returns a random float in the range [a,b)
+	float nextFloat( float a, float b )
+	{
+		return nextFloat() * ( b - a ) + a;
+	}
+
+	//! returns a random float in the range [a,b] or the range [-b,-a)
+	float posNegFloat( float a, float b )
+	{
+		if( nextBool() )
+			return nextFloat( a, b );
+		else
+			return -nextFloat( a, b );
+	}
+
+	//! returns a random vec3 that represents a point on the unit sphere
+	vec3 nextVec3()
+	{
+		float phi = nextFloat( (float)M_PI * 2.0f );
+		float costheta = nextFloat( -1.0f, 1.0f );
+		return unitSphere( phi, costheta );
+	}
+
+	//! returns a random vec2 that represents a point on the unit circle
+	vec2 nextVec2()
+	{
+		float theta = nextFloat( (float)M_PI * 2.0f );
+		return vec2( math<float>::cos( theta ), math<float>::sin( theta ) );
+	}
+
+	//! returns a random float via Gaussian distribution, with a mean of 0 and a standard deviation of 1.0
+	float nextGaussian();
+
+	//! Fills \a result with \a count random integers in the range [0,4294967296)
+	void	nextUints( uint32_t *result, size_t count );
+	//! Fills \a result with \a count random integers in the range [a,b)
+	void	nextInts( int32_t *result, size_t count, int32_t a, int32_t b );
+	//! Fills \a result with \a count random floats in the range [a,b)
+	void	nextFloats( float *result, size_t count, float a = 0.0f, float b = 1.0f );
+	//! Fills \a result with \a count random points on the unit circle
+	void	nextVec2s( vec2 *result, size_t count );
+	//! Fills \a result with \a count random points on the unit sphere
+	void	nextVec3s( vec3 *result, size_t count );
+	//! Fills \a result with \a count random floats via Gaussian distribution with a mean of \a mean and a standard deviation of \a stdDev
+	void	nextGaussians( float *result, size_t count, float mean = 0.0f, float stdDev = 1.0f );
+
+  private:
+	//! Advances the four streams, storing their outputs in mBuffer
+	void	refill();
+
+	static vec3 unitSphere( float phi, float costheta )
+	{
+		float rho = math<float>::sqrt( 1.0f - costheta * costheta );
+		return vec3( rho * math<float>::cos( phi ), rho * math<float>::sin( phi ), costheta );
+	}
+
+	uint32_t	mState[4][4]; // [word][stream]
+	uint32_t	mBuffer[4];
+	uint32_t	mBufferIndex;
+	float		mGaussian;
+	bool		mHasGaussian;
 };
 
 //! Resets the static random generator to the specific seed \a seedValue
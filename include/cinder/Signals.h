@@ -30,9 +30,12 @@
 #include "cinder/Noncopyable.h"
 #include "cinder/Export.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
 namespace cinder { namespace signals {
@@ -74,22 +77,22 @@ struct SignalLinkBase {
 
 	void enable()
 	{
-		mEnabled = true;
+		mEnabled.store( true, std::memory_order_relaxed );
 	}
 
 	void disable()
 	{
-		mEnabled = false;
+		mEnabled.store( false, std::memory_order_relaxed );
 	}
 
 	bool isEnabled() const
 	{
-		return mEnabled;
+		return mEnabled.load( std::memory_order_relaxed );
 	}
 
   private:
-	int		mRefCount;
-	bool	mEnabled;
+	int					mRefCount;
+	std::atomic<bool>	mEnabled; // atomic so that a Connection may be enabled and disabled while a ConcurrentSignal emits on another thread
 };
 
 //! Base Signal class, which provides a concrete type that can be stored by the Disconnector
@@ -184,6 +187,10 @@ namespace detail {
 //! The template implementation for callback list.
 template<typename, typename> class	SignalProto;   // undefined
 
+//! Arguments are passed through an emission by const reference rather than copied at each step, unless the signature takes a reference.
+template<typename T> struct SignalArg		{ typedef const T& type; };
+template<typename T> struct SignalArg<T&>	{ typedef T& type; };
+
 //! Invokes signal handlers differently depending on return type.
 template<typename, typename> struct	CollectorInvocation;
 
@@ -219,7 +226,7 @@ struct CollectorDefault<void> {
 template<class Collector, class R, class... Args>
 struct CollectorInvocation<Collector, R ( Args... )> : public SignalBase {
 
-	bool invoke( Collector &collector, const std::function<R ( Args... )> &callback, Args... args )
+	bool invoke( Collector &collector, const std::function<R ( Args... )> &callback, typename SignalArg<Args>::type... args )
 	{
 		return collector( callback( args... ) );
 	}
@@ -229,7 +236,7 @@ struct CollectorInvocation<Collector, R ( Args... )> : public SignalBase {
 template<class Collector, class... Args>
 struct CollectorInvocation<Collector, void( Args... )> : public SignalBase {
 
-	bool invoke( Collector &collector, const std::function<void( Args... )> &callback, Args... args )
+	bool invoke( Collector &collector, const std::function<void( Args... )> &callback, typename SignalArg<Args>::type... args )
 	{
 		callback( args... );
 		return collector();
@@ -286,7 +293,7 @@ class SignalProto<R ( Args... ), Collector> : private CollectorInvocation<Collec
 	}
 
 	//! Emit a signal, i.e. invoke all its callbacks and collect return types with Collector. \return the CollectorResult from the collector.
-	CollectorResult	emit( Args... args )
+	CollectorResult	emit( typename SignalArg<Args>::type... args )
 	{
 		Collector collector;
 		emit( collector, args... );
@@ -294,7 +301,7 @@ class SignalProto<R ( Args... ), Collector> : private CollectorInvocation<Collec
 	}
 
 	//! Emit a signal, i.e. invoke all its callbacks and collect return types with \a collector.
-	void emit( Collector &collector, Args... args )
+	void emit( Collector &collector, typename SignalArg<Args>::type... args )
 	{
 		bool continueEmission = true;
 		for( auto &lp : mLinks ) {
@@ -477,6 +484,341 @@ struct Signal : detail::SignalProto<Signature, Collector> {
 	typedef typename SignalProto::CallbackFn			CallbackFn;
 };
 
+// ----------------------------------------------------------------------------------------------------
+// ConcurrentSignal
+// ----------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+template<size_t... I> struct SignalIndices {};
+template<size_t N, size_t... I> struct MakeSignalIndices : MakeSignalIndices<N - 1, N - 1, I...> {};
+template<size_t... I> struct MakeSignalIndices<0, I...> { typedef SignalIndices<I...> type; };
+
+//! The template implementation for ConcurrentSignal.
+template<typename, typename> class	ConcurrentSignalProto;   // undefined
+
+//! ConcurrentSignalProto template, the parent class of ConcurrentSignal, specialised for the callback signature and collector.
+template<class Collector, class R, class... Args>
+class ConcurrentSignalProto<R ( Args... ), Collector> : private CollectorInvocation<Collector, R ( Args... )> {
+  protected:
+	typedef std::function<R ( Args... )>		CallbackFn;
+	typedef typename Collector::CollectorResult	CollectorResult;
+
+  public:
+	//! Function that runs its argument on another thread, for example AppBase::dispatchAsync(). Used for queued connections.
+	typedef std::function<void ( const std::function<void ()> & )>	DispatchFn;
+
+	//! Constructs an empty ConcurrentSignalProto
+	ConcurrentSignalProto()
+		: mSlots( new SlotList ), mNumEmitting( 0 ), mHasRetired( false ), mNextOrder( 0 ), mDisconnector( new Disconnector( this ) )
+	{}
+
+	//! Destructor releases all resources associated with this signal. Queued calls that haven't been delivered yet are skipped.
+	~ConcurrentSignalProto()
+	{
+		SlotList *slots = mSlots.load();
+		for( Slot *slot : slots->mSlots )
+			slot->markDisconnected();
+
+		releaseSlotList( slots );
+		for( SlotList *retired : mRetired )
+			releaseSlotList( retired );
+	}
+
+	//! Connects \a callback to the signal, assigned to the default priority group (priority = 0). \return a Connection, which can be used to disconnect this callback slot.
+	Connection connect( const CallbackFn &callback )
+	{
+		return connect( 0, callback );
+	}
+
+	//! Connects \a callback to the signal, assigned to the priority group \a priority. \return a Connection, which can be used to disconnect this callback slot.
+	Connection connect( int priority, const CallbackFn &callback )
+	{
+		return addSlot( priority, callback, nullptr );
+	}
+
+	//! Connects \a callback so that it is called through \a dispatchFn rather than on the emitting thread. Calls made while a delivery is
+	//! pending are delivered together, in the order they were emitted, by a single call through \a dispatchFn, which should run functions
+	//! in the order it receives them. The arguments are copied, and the result of \a callback isn't collected.
+	Connection connectQueued( const CallbackFn &callback, const DispatchFn &dispatchFn )
+	{
+		return connectQueued( 0, callback, dispatchFn );
+	}
+
+	//! Connects \a callback so that it is called through \a dispatchFn, assigned to the priority group \a priority. \see connectQueued()
+	Connection connectQueued( int priority, const CallbackFn &callback, const DispatchFn &dispatchFn )
+	{
+		CI_ASSERT( dispatchFn );
+		return addSlot( priority, callback, std::make_shared<QueuedDelivery>( callback, dispatchFn ) );
+	}
+
+	//! Emit a signal, i.e. invoke all its callbacks and collect return types with Collector. \return the CollectorResult from the collector.
+	CollectorResult	emit( typename SignalArg<Args>::type... args )
+	{
+		Collector collector;
+		emit( collector, args... );
+		return collector.getResult();
+	}
+
+	//! Emit a signal, i.e. invoke all its callbacks and collect return types with \a collector.
+	void emit( Collector &collector, typename SignalArg<Args>::type... args )
+	{
+		EmitScope scope( this );
+		for( Slot *slot : scope.mSlots->mSlots ) {
+			// a slot disconnected during this emission, possibly from another thread, is skipped from here on
+			if( ! slot->mConnected.load( std::memory_order_acquire ) || ! slot->isEnabled() )
+				continue;
+
+			if( slot->mQueued )
+				slot->mQueued->push( args... );
+			else if( ! this->invoke( collector, slot->mCallbackFn, args... ) )
+				break;
+		}
+	}
+
+	//! Returns the number of connected slots.
+	size_t getNumSlots() const
+	{
+		EmitScope scope( this );
+		return scope.mSlots->mSlots.size();
+	}
+
+  private:
+	//! Copies of the arguments from emissions waiting for delivery through a DispatchFn. Shared with the pending deliveries, so it
+	//! outlives the slot and the signal if need be.
+	struct QueuedDelivery : public std::enable_shared_from_this<QueuedDelivery> {
+		typedef std::tuple<typename std::decay<Args>::type...>	ArgsTuple;
+
+		struct Call {
+			ArgsTuple	mArgs;
+			Call		*mNext;
+		};
+
+		QueuedDelivery( const CallbackFn &callback, const DispatchFn &dispatchFn )
+			: mCallbackFn( callback ), mDispatchFn( dispatchFn ), mPending( nullptr ), mConnected( true )
+		{}
+
+		~QueuedDelivery()
+		{
+			Call *call = mPending.exchange( nullptr );
+			while( call ) {
+				Call *next = call->mNext;
+				delete call;
+				call = next;
+			}
+		}
+
+		//! Pushes a copy of \a args. The push that finds nothing pending schedules a delivery, which takes everything pushed until it runs.
+		void push( typename SignalArg<Args>::type... args )
+		{
+			Call *call = new Call{ ArgsTuple( args... ), nullptr };
+			Call *head = mPending.load( std::memory_order_relaxed );
+			do {
+				call->mNext = head;
+			} while( ! mPending.compare_exchange_weak( head, call, std::memory_order_release, std::memory_order_relaxed ) );
+
+			if( ! head ) {
+				auto self = this->shared_from_this();
+				mDispatchFn( [self] { self->deliver(); } );
+			}
+		}
+
+		void deliver()
+		{
+			// pending calls are stacked newest first
+			Call *call = mPending.exchange( nullptr, std::memory_order_acquire );
+			Call *ordered = nullptr;
+			while( call ) {
+				Call *next = call->mNext;
+				call->mNext = ordered;
+				ordered = call;
+				call = next;
+			}
+
+			while( ordered ) {
+				Call *next = ordered->mNext;
+				if( mConnected.load( std::memory_order_acquire ) )
+					invoke( ordered->mArgs, typename MakeSignalIndices<sizeof...( Args )>::type() );
+				delete ordered;
+				ordered = next;
+			}
+		}
+
+		template<size_t... I>
+		void invoke( ArgsTuple &args, SignalIndices<I...> )
+		{
+			mCallbackFn( std::get<I>( args )... );
+		}
+
+		CallbackFn				mCallbackFn;
+		DispatchFn				mDispatchFn;
+		std::atomic<Call*>		mPending;
+		std::atomic<bool>		mConnected;
+	};
+
+	struct Slot : public SignalLinkBase {
+		Slot( int priority, uint64_t order, const CallbackFn &callback, const std::shared_ptr<QueuedDelivery> &queued )
+			: mPriority( priority ), mOrder( order ), mCallbackFn( callback ), mQueued( queued ), mConnected( true )
+		{}
+
+		bool removeSibling( SignalLinkBase *link ) override	{ return false; }
+
+		void markDisconnected()
+		{
+			mConnected.store( false, std::memory_order_release );
+			if( mQueued )
+				mQueued->mConnected.store( false, std::memory_order_release );
+		}
+
+		int									mPriority;
+		uint64_t							mOrder;
+		CallbackFn							mCallbackFn;
+		std::shared_ptr<QueuedDelivery>		mQueued;
+		std::atomic<bool>					mConnected;
+	};
+
+	//! Immutable once published, sorted by descending priority and then connection order. Slots are reference counted by the lists they're in.
+	struct SlotList {
+		std::vector<Slot*>	mSlots;
+	};
+
+	//! Holds on to the current SlotList for the duration of an emission
+	struct EmitScope {
+		EmitScope( const ConcurrentSignalProto *signal )
+			: mSignal( signal )
+		{
+			// while mNumEmitting is non-zero no retired SlotList is released, and one loaded after the increment can't be retired before it
+			mSignal->mNumEmitting.fetch_add( 1 );
+			mSlots = mSignal->mSlots.load();
+		}
+
+		~EmitScope()
+		{
+			// the last emission to finish releases the lists replaced while it ran, unless a connect() or disconnect() holds the mutex
+			if( mSignal->mNumEmitting.fetch_sub( 1 ) == 1 && mSignal->mHasRetired.load() ) {
+				std::unique_lock<std::mutex> lock( mSignal->mWriteMutex, std::try_to_lock );
+				if( lock.owns_lock() )
+					mSignal->releaseRetired();
+			}
+		}
+
+		const ConcurrentSignalProto		*mSignal;
+		const SlotList					*mSlots;
+	};
+
+	Connection addSlot( int priority, const CallbackFn &callback, const std::shared_ptr<QueuedDelivery> &queued )
+	{
+		std::lock_guard<std::mutex> lock( mWriteMutex );
+
+		Slot *slot = new Slot( priority, mNextOrder++, callback, queued ); // ref count = 1, owned by the new list
+		SlotList *slots = new SlotList;
+		const SlotList *current = mSlots.load();
+		slots->mSlots.reserve( current->mSlots.size() + 1 );
+		bool inserted = false;
+		for( Slot *existing : current->mSlots ) {
+			if( ! inserted && existing->mPriority < priority ) {
+				slots->mSlots.push_back( slot );
+				inserted = true;
+			}
+			existing->incrRef();
+			slots->mSlots.push_back( existing );
+		}
+		if( ! inserted )
+			slots->mSlots.push_back( slot );
+
+		publish( slots );
+		return Connection( mDisconnector, slot, priority );
+	}
+
+	bool disconnect( SignalLinkBase *link, int priority ) override
+	{
+		std::lock_guard<std::mutex> lock( mWriteMutex );
+
+		const SlotList *current = mSlots.load();
+		Slot *removed = nullptr;
+		for( Slot *slot : current->mSlots ) {
+			if( slot == link ) {
+				removed = slot;
+				break;
+			}
+		}
+		if( ! removed )
+			return false;
+
+		removed->markDisconnected();
+		SlotList *slots = new SlotList;
+		slots->mSlots.reserve( current->mSlots.size() - 1 );
+		for( Slot *slot : current->mSlots ) {
+			if( slot != removed ) {
+				slot->incrRef();
+				slots->mSlots.push_back( slot );
+			}
+		}
+
+		publish( slots );
+		return true;
+	}
+
+	//! Replaces the current SlotList with \a slots. Called with mWriteMutex locked.
+	void publish( SlotList *slots )
+	{
+		mRetired.push_back( mSlots.exchange( slots ) );
+		mHasRetired.store( true );
+		releaseRetired();
+	}
+
+	//! Releases the retired SlotLists if no emission is running. Called with mWriteMutex locked.
+	void releaseRetired() const
+	{
+		// any emission that starts from here on sees the current list, so when none is running nothing can still be using the retired ones
+		if( mNumEmitting.load() == 0 ) {
+			for( SlotList *retired : mRetired )
+				releaseSlotList( retired );
+			mRetired.clear();
+			mHasRetired.store( false );
+		}
+	}
+
+	static void releaseSlotList( SlotList *slots )
+	{
+		for( Slot *slot : slots->mSlots )
+			slot->decrRef();
+		delete slots;
+	}
+
+	std::atomic<SlotList*>				mSlots;
+	mutable std::atomic<int>			mNumEmitting;
+	mutable std::mutex					mWriteMutex;	// serializes connect() and disconnect(), which emit() never waits on
+	mutable std::vector<SlotList*>		mRetired;		// replaced lists that an emission might still be walking
+	mutable std::atomic<bool>			mHasRetired;	// lets the last emission to finish skip the mutex when mRetired is empty
+	uint64_t							mNextOrder;
+	std::shared_ptr<Disconnector>		mDisconnector;	// Connection holds a weak_ptr to this to make disconnections.
+};
+
+} // namespace detail
+
+//! \brief ConcurrentSignal is a Signal that may be connected to, disconnected from and emitted on any thread.
+//!
+//! The interface and callback ordering match Signal. Each emission walks an immutable snapshot of the connected slots, which connect()
+//! and disconnect() replace without waiting for emissions in flight, so emit() never blocks. A slot disconnected during an emission
+//! is skipped if the emission hasn't reached it yet, but a call already underway on another thread may still be running when
+//! disconnect() returns.
+//!
+//! connectQueued() connects a callback that runs on another thread's event loop instead of the emitting thread, for example to hand
+//! events from a worker thread to the main thread in batches:
+//! \code
+//! signal.connectQueued( callback, []( const std::function<void ()> &fn ) { app::App::get()->dispatchAsync( fn ); } );
+//! \endcode
+//!
+//! \note The signal itself must outlive any emit(), connect() or disconnect() calls made on it from other threads.
+template <typename Signature, class Collector = detail::CollectorDefault<typename std::function<Signature>::result_type> >
+struct ConcurrentSignal : detail::ConcurrentSignalProto<Signature, Collector> {
+
+	typedef detail::ConcurrentSignalProto<Signature, Collector>	ConcurrentSignalProto;
+	typedef typename ConcurrentSignalProto::CallbackFn				CallbackFn;
+	typedef typename ConcurrentSignalProto::DispatchFn				DispatchFn;
+};
+
 // ----------------------------------------------------------------------------------------------------
 // slot
 // ----------------------------------------------------------------------------------------------------
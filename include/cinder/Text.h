@@ -27,11 +27,13 @@
 #include "cinder/Surface.h"
 #include "cinder/Font.h"
 #include "cinder/Vector.h"
+#include "cinder/Unicode.h"
 
 #include <vector>
 #include <deque>
 #include <string>
 #include <map> 
+#include <unordered_map>
 
 // Core Text forward declarations
 #if defined( CINDER_COCOA )
@@ -161,8 +163,49 @@ class CI_API TextBox {
 
 	mutable std::u16string	mWideText;
 #elif defined( CINDER_UWP ) || defined( CINDER_ANDROID ) || defined( CINDER_LINUX )
+	//! A line of laid out text. Its glyphs and their horizontal positions are filled in once measureGlyphs() needs them.
+	struct Line {
+		std::string									mText;
+		ivec2										mSize, mBaseline;
+		std::vector<std::pair<Font::Glyph,float>>	mGlyphs;
+	};
+
+	//! The lines of a paragraph, which depend on the font and width as well as its text
+	struct Paragraph {
+		Paragraph() : mLaidOut( false ), mLastUse( 0 ) {}
+
+		std::vector<Line>		mLines;
+		bool					mLaidOut;
+		uint64_t				mLastUse;
+	};
+
+	//! The layout memoised by font, size, width and text. Editing the text only re-breaks the paragraphs which changed. Copies start out empty.
+	struct LayoutCache {
+		LayoutCache() : mFontSize( 0 ), mWidth( 0 ), mValid( false ), mGeneration( 0 ) {}
+		LayoutCache( const LayoutCache & ) : LayoutCache() {}
+		LayoutCache& operator=( const LayoutCache & ) { clear(); return *this; }
+
+		void	clear() { mValid = false; mLines.clear(); mParagraphs.clear(); mLinebreaks.clear(); }
+
+		std::string									mFontName;
+		float										mFontSize;
+		int											mWidth;
+		std::string									mText;
+		bool										mValid;
+		std::vector<Line*>							mLines;
+		LinebreakCache								mLinebreaks;
+		//! Keyed like LinebreakCache, by the paragraph's text followed by a byte which is 1 for the first paragraph and 0 otherwise
+		std::unordered_map<std::string, Paragraph>	mParagraphs;
+		std::string									mKey;
+		uint64_t									mGeneration;
+	};
+
 	std::vector<std::string>	calculateLineBreaks( const std::map<Font::Glyph, Font::GlyphMetrics>* cachedGlyphMetrics = nullptr ) const;
 	void 						calculate() const;
+	//! Returns the laid out lines of the text, reusing whatever \a mLayoutCache holds
+	const std::vector<Line*>&	layout( const std::map<Font::Glyph, Font::GlyphMetrics>* cachedGlyphMetrics = nullptr ) const;
+
+	mutable LayoutCache			mLayoutCache;
 #endif
 };
 
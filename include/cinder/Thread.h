@@ -34,6 +34,9 @@
 #include <mutex>
 #include <condition_variable>
 #include <future>
+#include <vector>
+#include <algorithm>
+#include <exception>
 
 namespace cinder {
 //! Create an instance of this class at the beginning of any multithreaded code that makes use of Cinder functionality
@@ -51,4 +54,56 @@ class CI_API ThreadSetup {
 #endif
 };
 
+//! Returns the number of worker threads used by parallelFor() when none is specified. Always at least \c 1.
+inline size_t getNumParallelThreads()
+{
+	return std::max<size_t>( 1, std::thread::hardware_concurrency() );
+}
+
+//! Splits [\a begin, \a end) into contiguous ranges of at least \a minRangeSize and calls \a fn( rangeBegin, rangeEnd ) for each, concurrently. Blocks until all ranges have completed.
+/** The calling thread processes the last range itself. \a maxThreads of \c 0 uses getNumParallelThreads(). The first exception thrown by \a fn is rethrown on the calling thread. **/
+template<typename FnT>
+void parallelFor( size_t begin, size_t end, size_t minRangeSize, FnT &&fn, size_t maxThreads = 0 )
+{
+	if( end <= begin )
+		return;
+
+	const size_t count = end - begin;
+	const size_t numThreads = ( maxThreads == 0 ) ? getNumParallelThreads() : maxThreads;
+	const size_t numRanges = std::max<size_t>( 1, std::min( numThreads, count / std::max<size_t>( 1, minRangeSize ) ) );
+	if( numRanges == 1 ) {
+		fn( begin, end );
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	std::vector<std::exception_ptr> exceptions( numRanges );
+	threads.reserve( numRanges - 1 );
+	const size_t rangeSize = count / numRanges, remainder = count % numRanges;
+	size_t rangeBegin = begin;
+	for( size_t r = 0; r < numRanges; ++r ) {
+		const size_t rangeEnd = rangeBegin + rangeSize + ( ( r < remainder ) ? 1 : 0 );
+		auto task = [&fn, &exceptions, r, rangeBegin, rangeEnd] {
+			try {
+				fn( rangeBegin, rangeEnd );
+			}
+			catch( ... ) {
+				exceptions[r] = std::current_exception();
+			}
+		};
+		if( r + 1 < numRanges )
+			threads.emplace_back( task );
+		else
+			task();
+		rangeBegin = rangeEnd;
+	}
+
+	for( auto &thread : threads )
+		thread.join();
+	for( auto &exc : exceptions ) {
+		if( exc )
+			std::rethrow_exception( exc );
+	}
+}
+
 } // namespace cinder
@@ -43,6 +43,7 @@ class CI_API Timeline : public TimelineItem {
   public:
 	//! Creates a new timeline, defaulted to infinite
 	static TimelineRef	create() { TimelineRef result( new Timeline() ); result->setInfinite( true ); return result; }
+	~Timeline();
 
 	//! Advances time a specified amount and evaluates items
 	void	step( float timestep );
@@ -182,6 +183,16 @@ class CI_API Timeline : public TimelineItem {
 	//! Returns the default \a autoRemove value for all future TimelineItems added to the Timeline
 	bool	getDefaultAutoRemove() const { return mDefaultAutoRemove; }
 
+	//! Enables batched evaluation, which scales to very large numbers of simultaneous tweens. See setBatched().
+	/** When batched, float, vec2, vec3 and Color tweens using the default lerp are kept in contiguous arrays sorted by start time and grouped by
+		ease function, so that stepping skips tweens which haven't started and evaluates the polynomial ease functions with SIMD. Callbacks fire as usual,
+		though the order in which different tweens are updated within a step may differ. A tween's ease function, loop, ping-pong and infinite settings
+		are captured on the first step after it is added; changes made later through TweenRef setters only take effect if its start time or duration
+		also changes. Other items (Cues, FnTweens, looping tweens, nested Timelines) are stepped individually as usual. **/
+	void	setBatched( bool batched = true );
+	//! Returns whether the Timeline uses batched evaluation. Defaults to \c false.
+	bool	isBatched() const { return (bool)mTweenBatches; }
+
 	//! Call this to notify the Timeline if the \a item's start-time or duration has changed. Advanced use cases only.
 	void	itemTimeChanged( TimelineItem *item );
 
@@ -216,6 +227,18 @@ class CI_API Timeline : public TimelineItem {
 	std::multimap<void*,TimelineItemRef>		mItems;
 	
   private:
+	struct TweenBatches;
+
+	//! Records that an item was marked for removal by something other than stepping, such as remove() or TimelineItem::removeSelf()
+	void	markedForRemoval();
+	void	markBatchesDirty();
+	void	stepBatched( float time );
+
+	bool							mHasMarkedItems;
+	std::unique_ptr<TweenBatches>	mTweenBatches;
+
+	friend class TimelineItem;
+
 	Timeline( const Timeline &rhs ); // private to prevent copying; use clone() method instead
 	Timeline& operator=( const Timeline &rhs ); // not defined to prevent copying
 };
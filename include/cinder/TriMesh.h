@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
 #include "cinder/Vector.h"
 #include "cinder/AxisAlignedBox.h"
@@ -38,6 +39,7 @@
 namespace cinder {
 
 typedef std::shared_ptr<class TriMesh>		TriMeshRef;
+typedef std::shared_ptr<class TriMeshView>	TriMeshViewRef;
 	
 class CI_API TriMesh : public geom::Source {
  public:
@@ -66,6 +68,41 @@ class CI_API TriMesh : public geom::Source {
 		uint8_t		mTexCoords0Dims, mTexCoords1Dims, mTexCoords2Dims, mTexCoords3Dims;
 	};
 
+	/** \brief Options for writing a TriMesh to a binary file.
+	 *
+	 *  Version 3 files store each attribute in a 16-byte aligned block listed in a table at the start of the file, so a TriMeshView can use
+	 *  the attributes of a memory-mapped file in place. Quantized or compressed attributes produce smaller files, but must be decoded when read.
+	**/
+	class CI_API WriteOptions {
+	  public:
+		WriteOptions();
+
+		//! Sets the version of the file format, either \c 2 or \c 3. Version 2 files can be read by older releases, but ignore the quantization and compression options. Default is \c 3.
+		WriteOptions&	version( uint8_t version ) { mVersion = version; return *this; }
+		//! Sets the attributes to write. By default every attribute of the TriMesh is written.
+		WriteOptions&	attribs( const std::set<geom::Attrib> &attribs );
+		//! Sets whether normals, tangents and bitangents are stored as two 16-bit octahedral coordinates instead of three floats. Quantized vectors are read back with unit length. Default is \c false.
+		WriteOptions&	quantizeNormals( bool quantize = true ) { mQuantizeNormals = quantize; return *this; }
+		//! Sets whether texture coordinates are stored as 16-bit fractions of their range instead of floats. Default is \c false.
+		WriteOptions&	quantizeTexCoords( bool quantize = true ) { mQuantizeTexCoords = quantize; return *this; }
+		//! Sets whether indices are stored as variable-length differences from the previous index. Lossless. Default is \c false.
+		WriteOptions&	compressIndices( bool compress = true ) { mCompressIndices = compress; return *this; }
+		//! Sets whether vertex attributes are stored as packed bytewise differences from the previous vertex. Lossless, and most effective on quantized attributes. Default is \c false.
+		WriteOptions&	compressVertices( bool compress = true ) { mCompressVertices = compress; return *this; }
+
+		uint8_t		getVersion() const { return mVersion; }
+		uint32_t	getAttribMask() const { return mAttribMask; }
+		bool		getQuantizeNormals() const { return mQuantizeNormals; }
+		bool		getQuantizeTexCoords() const { return mQuantizeTexCoords; }
+		bool		getCompressIndices() const { return mCompressIndices; }
+		bool		getCompressVertices() const { return mCompressVertices; }
+
+	  protected:
+		uint8_t		mVersion;
+		uint32_t	mAttribMask;
+		bool		mQuantizeNormals, mQuantizeTexCoords, mCompressIndices, mCompressVertices;
+	};
+
 	static TriMeshRef	create() { return TriMeshRef( new TriMesh( Format().positions().normals().texCoords() ) ); }
 	static TriMeshRef	create( const Format &format ) { return TriMeshRef( new TriMesh( format ) ); }
 	static TriMeshRef	create( const geom::Source &source ) { return TriMeshRef( new TriMesh( source ) ); }
@@ -298,25 +335,49 @@ class CI_API TriMesh : public geom::Source {
 	//! Calculates the bounding box of all vertices as transformed by \a transform. Fails if the positions are not 3D.
 	AxisAlignedBox	calcBoundingBox( const mat4 &transform ) const;
 
-	//! Fills this TriMesh with the data from a binary file, which was created with TriMesh::write().
+	//! Fills this TriMesh with the data from a binary file, which was created with TriMesh::write(). Version 3 files are memory-mapped when possible.
 	void		read( const DataSourceRef &dataSource );
-	//! Writes this TriMesh out to a binary data file.
+	//! Writes this TriMesh out to a binary data file, using version 2 of the format.
 	void		write( const DataTargetRef &dataTarget ) const { write( dataTarget, ~0u ); }
+	//! Writes this TriMesh out to a binary data file, using the version, attributes and encoding specified by \a options.
+	void		write( const DataTargetRef &dataTarget, const WriteOptions &options ) const;
 	//! Writes this TriMesh out to a binary data file. If \a writeNormals or \a writeTangents is \c true, normals and/or tangents are written to the file.
 	void		write( const DataTargetRef &dataTarget, bool writeNormals, bool writeTangents ) const;
 	//! Writes this TriMesh out to a binary data file. You can specify which attributes to write by supplying a list of \a attribs.
 	void		write( const DataTargetRef &dataTarget, const std::set<geom::Attrib> &attribs ) const;
 
+	//! Default distance within which vertices are considered to share a position, equal to sqrt(FLT_EPSILON).
+	static constexpr float DEFAULT_WELD_TOLERANCE = 3.4526698e-4f;
+
 	/*! Adds or replaces normals by calculating them from the vertices and faces. If \a smooth is TRUE,
-		similar vertices are grouped together to calculate their average. This will not change the mesh,
+		vertices within \a weldTolerance of each other are grouped together to calculate their average. This will not change the mesh,
 		nor will it affect texture mapping. If \a weighted is TRUE, larger polygons contribute more to
 		the calculated normal. Renormalization requires 3D vertices. */
-	bool		recalculateNormals( bool smooth = false, bool weighted = false );
+	bool		recalculateNormals( bool smooth = false, bool weighted = false, float weldTolerance = DEFAULT_WELD_TOLERANCE );
 	//! Adds or replaces tangents by calculating them from the normals and texture coordinates. Requires 3D normals and 2D texture coordinates.
 	bool		recalculateTangents();
 	//! Adds or replaces bitangents by calculating them from the normals and tangents. Requires 3D normals and tangents.
 	bool		recalculateBitangents();
 
+	/*! Merges vertices whose positions are within \a tolerance of each other, keeping the attributes of the first vertex in each group and remapping the indices.
+		A \a tolerance of zero only merges identical positions. Returns the number of vertices removed. */
+	size_t		weld( float tolerance = DEFAULT_WELD_TOLERANCE );
+	//! Merges vertices whose positions and other attributes are all equal, remapping the indices. Returns the number of vertices removed.
+	size_t		removeDuplicateVertices();
+
+	//! Reorders the triangles to reduce misses in a post-transform vertex cache of \a cacheSize vertices. \sa geom::optimizeVertexCache()
+	void		optimizeVertexCache( size_t cacheSize = 16 );
+	//! Reorders clusters of triangles to reduce overdraw, allowing the cache miss ratio to grow by up to \a threshold. Call after optimizeVertexCache(). Requires 3D positions. \sa geom::optimizeOverdraw()
+	void		optimizeOverdraw( float threshold = 1.05f, size_t cacheSize = 16 );
+	//! Reorders the vertices by their first use in the indices, and removes unused vertices. Returns the number of vertices removed. \sa geom::calculateVertexFetchRemap()
+	size_t		optimizeVertexFetch();
+	/*! Removes triangles by collapsing edges, until at most \a targetNumTriangles remain or no edge can be collapsed within \a maxError, in units of the positions.
+		Unused vertices are removed. If \a resultError is not \c nullptr, it is set to the estimated distance of the result from the original surface.
+		Requires 3D positions. Returns the number of triangles removed. \sa geom::simplify() */
+	size_t		simplify( size_t targetNumTriangles, float maxError = FLT_MAX, float *resultError = nullptr );
+	//! Returns the efficiency of the triangle order in a FIFO post-transform vertex cache of \a cacheSize vertices.
+	geom::VertexCacheStatistics	calcVertexCacheStatistics( size_t cacheSize = 16 ) const;
+
 	/*! Subdivide each triangle of the TriMesh into \a division times division triangles. Division less than 2 leaves the mesh unaltered.
 		Optionally, vertices are normalized if \a normalize is TRUE. */
 	void		subdivide( int division = 2, bool normalize = false );
@@ -340,7 +401,12 @@ class CI_API TriMesh : public geom::Source {
 
 	//! Returns whether or not the vertex, color etc. at both indices is the same.
 	bool		verticesEqual( uint32_t indexA, uint32_t indexB ) const;
+	//! Removes every vertex \a i for which \a weldMap[i] != i, replacing references to it with \a weldMap[i], which must be a vertex that is kept. Returns the number of vertices removed.
+	size_t		removeVertices( const std::vector<uint32_t> &weldMap );
+	//! Moves each vertex \a i to \a remap[i], removing it if that is not less than \a numVertices, and updates the indices to match. \a remap must not map two vertices to the same index.
+	void		remapVertices( const std::vector<uint32_t> &remap, size_t numVertices );
 
+	void		readImplV3( const DataSourceRef &dataSource );
 	void		readImplV2( const IStreamRef &in );
 	void		readImplV1( const IStreamRef &in );
 
@@ -348,6 +414,7 @@ class CI_API TriMesh : public geom::Source {
 	 * what data should be included (e.g. toMask(POSITION) | toMask(COLOR) )
 	 * or what should be excluded (e.g. ~toMask( NORMAL ) & ~toMask( TEX_COORD_0) ). */
 	void		write( const DataTargetRef &dataTarget, uint32_t writeMask ) const;
+	void		writeImplV3( const DataTargetRef &dataTarget, const WriteOptions &options ) const;
 
 	//! Converts a geom::Attrib to an attribute bitmask.
 	static uint32_t	toMask( geom::Attrib attrib );
@@ -366,6 +433,62 @@ class CI_API TriMesh : public geom::Source {
 	std::vector<uint32_t>	mIndices;
 	
 	friend class TriMeshGeomTarget;
+	friend class TriMeshView;
+};
+
+/** \brief Read-only geom::Source over a mesh in the version 3 binary format written by TriMesh::write().
+ *
+ *  Attributes and indices stored as plain floats and integers are used directly from the file data, so a memory-mapped file is wrapped without
+ *  being copied or even read in full. Quantized or compressed blocks are decoded into memory once, on construction. Copies made with clone() share
+ *  both the file data and the decoded blocks.
+**/
+class CI_API TriMeshView : public geom::Source {
+  public:
+	//! Memory-maps the file behind \a dataSource, or uses its buffer if it is not a file or cannot be mapped.
+	static TriMeshViewRef	create( const DataSourceRef &dataSource ) { return std::make_shared<TriMeshView>( dataSource ); }
+	//! Wraps \a buffer, which is kept alive by the view and must not be modified.
+	static TriMeshViewRef	create( const BufferRef &buffer ) { return std::make_shared<TriMeshView>( buffer ); }
+
+	//! Memory-maps the file behind \a dataSource, or uses its buffer if it is not a file or cannot be mapped. Throws if the data is not a valid version 3 TriMesh file.
+	TriMeshView( const DataSourceRef &dataSource );
+	//! Wraps \a buffer, which is kept alive by the view and must not be modified. Throws if the data is not a valid version 3 TriMesh file.
+	TriMeshView( const BufferRef &buffer );
+	/** Wraps \a size bytes at \a data, which must remain valid and unmodified while the view and any of its clones exist.
+		Blocks are only used in place when \a data is 4-byte aligned. Throws if the data is not a valid version 3 TriMesh file. */
+	TriMeshView( const void *data, size_t size );
+
+	size_t				getNumVertices() const override { return mNumVertices; }
+	size_t				getNumIndices() const override { return mNumIndices; }
+	geom::Primitive		getPrimitive() const override { return geom::Primitive::TRIANGLES; }
+	uint8_t				getAttribDims( geom::Attrib attr ) const override;
+	geom::AttribSet		getAvailableAttribs() const override;
+	void				loadInto( geom::Target *target, const geom::AttribSet &requestedAttribs ) const override;
+	geom::Source*		clone() const override { return new TriMeshView( *this ); }
+
+	//! Returns the getNumIndices() triangle indices, or \c nullptr if the mesh has no indices.
+	const uint32_t*		getIndices() const { return mIndices; }
+	//! Returns getNumVertices() values of \a attr, each of getAttribDims( \a attr ) floats, or \c nullptr if the mesh does not have \a attr.
+	const float*		getAttribData( geom::Attrib attr ) const;
+	//! Returns whether the indices are used in place rather than decoded into a copy.
+	bool				isIndicesMapped() const { return mIndices && ! mDecodedIndices; }
+	//! Returns whether \a attr is used in place rather than decoded into a copy.
+	bool				isAttribMapped( geom::Attrib attr ) const;
+
+  protected:
+	struct AttribData {
+		uint8_t										mDims;
+		const float									*mData;
+		std::shared_ptr<const std::vector<float>>	mDecoded;
+	};
+
+	void	init( const uint8_t *data, size_t size );
+
+	//! Keeps the mapped file or buffer alive.
+	std::shared_ptr<const void>						mStorage;
+	size_t											mNumVertices, mNumIndices;
+	const uint32_t									*mIndices;
+	std::shared_ptr<const std::vector<uint32_t>>	mDecodedIndices;
+	std::map<geom::Attrib, AttribData>				mAttribs;
 };
 
 } // namespace cinder
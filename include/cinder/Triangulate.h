@@ -28,11 +28,12 @@
 #include "cinder/Shape2d.h"
 #include "cinder/Path2d.h"
 
-struct TESStesselator;
-
 namespace cinder {
 
 //! Converts an arbitrary Shape2d into a TriMesh2d
+/** A Triangulator can be reused: calcMesh() and createMesh() consume the contours added so far, and the tessellator's memory lives in an arena
+	which is reset rather than freed, so triangulating many shapes with a single Triangulator performs almost no allocations. A single simple
+	contour is triangulated by ear clipping, which is considerably faster than the general tessellator, covering the same area. **/
 class CI_API Triangulator {
   public:
 	typedef enum Winding { WINDING_ODD, WINDING_NONZERO, WINDING_POSITIVE, WINDING_NEGATIVE, WINDING_ABS_GEQ_TWO } Winding;
@@ -55,19 +56,34 @@ class CI_API Triangulator {
 	//! Adds a PolyLine defined as a series of vec2's
 	void		addPolyLine( const vec2 *points, size_t numPoints );
 
-	//! Performs the tesselation, returning a TriMesh2d
+	//! Removes all contours added so far. Retains the allocated memory for subsequent tesselations.
+	void		clear();
+	//! Returns the number of contours added since the last tesselation
+	size_t		getNumContours() const	{ return mContourEnds.size(); }
+
+	//! Performs the tesselation, returning a TriMesh2d. The Triangulator is cleared afterwards and can be reused.
 	TriMesh		calcMesh( Winding winding = WINDING_ODD );
-	//! Performs the tesselation, returning a TriMesh2d
+	//! Performs the tesselation, returning a TriMesh2d. The Triangulator is cleared afterwards and can be reused.
 	TriMeshRef	createMesh( Winding winding = WINDING_ODD );
+
+	//! Tesselates each of \a shapes independently and in parallel, returning the concatenation of the results in order as a single TriMesh2d. \a approximationScale represents how smooth the tesselation is, with 1.0 corresponding to 1:1 with screen space
+	static TriMesh	calcMesh( const std::vector<Shape2d> &shapes, float approximationScale = 1.0f, Winding winding = WINDING_ODD );
 	
 	class CI_API Exception : public cinder::Exception {
 	};
 	
   protected:	
+	struct Arena;
+
 	void			allocate();
+	//! Appends the triangulation of the current contours to \a positions and \a indices and clears them
+	void			tesselate( Winding winding, std::vector<vec2> *positions, std::vector<uint32_t> *indices );
+	//! Triangulates a single simple contour by ear clipping. Returns \c false when the contour isn't suitable, leaving \a positions and \a indices untouched.
+	bool			calcEarClipping( Winding winding, std::vector<vec2> *positions, std::vector<uint32_t> *indices );
 	
-	int									mAllocated;
-	std::shared_ptr<TESStesselator>		mTess;
+	std::shared_ptr<Arena>		mArena;
+	std::vector<vec2>			mPoints;
+	std::vector<size_t>			mContourEnds;
 };
 
 } // namespace cinder
\ No newline at end of file
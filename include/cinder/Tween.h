@@ -136,6 +136,8 @@ class CI_API TweenBase : public TimelineItem {
 	EaseFn		mEaseFunction;
 	float		mDuration;
 	bool		mCopyStartValue;
+
+	friend class Timeline;
 };
 
 template<typename T>
@@ -261,6 +263,8 @@ class Tween : public TweenBase {
 	T	mStartValue, mEndValue;	
 	
 	LerpFn				mLerpFunction;
+
+	friend class Timeline;
 };
 
 template<typename T>
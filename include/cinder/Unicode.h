@@ -28,6 +28,7 @@
 
 #include <string>
 #include <functional>
+#include <unordered_map>
 #include <vector>
 
 namespace cinder {
@@ -46,6 +47,29 @@ CI_API std::string		toUtf8( const std::u32string &utf32Str );
 CI_API std::u16string	toUtf16( const std::u32string &utf32str );
 CI_API std::u32string	toUtf32( const std::u16string &utf16str );
 
+//! Returns whether the \a lengthInBytes bytes of \a str are well-formed UTF-8, rejecting overlong forms, surrogates, truncated sequences and code points above U+10FFFF.
+CI_API bool		isValidUtf8( const char *str, size_t lengthInBytes );
+
+// The following convert without allocating. Invalid input throws the same utf8::exception as the conversions above.
+
+//! Converts the UTF-8 string \a utf8Str into \a result, which has room for \a resultCapacity units, and returns the number of units in the conversion. If that exceeds \a resultCapacity nothing is written, so a \a resultCapacity of \c 0 queries the required size. \a lengthInBytes units always suffice.
+CI_API size_t	toUtf16( const char *utf8Str, size_t lengthInBytes, char16_t *result, size_t resultCapacity );
+//! Converts the UTF-8 string \a utf8Str into \a result, which has room for \a resultCapacity code points, and returns the number of code points in the conversion. If that exceeds \a resultCapacity nothing is written. \a lengthInBytes code points always suffice.
+CI_API size_t	toUtf32( const char *utf8Str, size_t lengthInBytes, char32_t *result, size_t resultCapacity );
+//! Converts \a lengthInBytes bytes of the UTF-16 string \a utf16Str into \a result, which has room for \a resultCapacity bytes, and returns the number of bytes in the conversion. If that exceeds \a resultCapacity nothing is written. 3 bytes per unit always suffice.
+CI_API size_t	toUtf8( const char16_t *utf16Str, size_t lengthInBytes, char *result, size_t resultCapacity );
+//! Converts \a lengthInBytes bytes of the UTF-32 string \a utf32Str into \a result, which has room for \a resultCapacity bytes, and returns the number of bytes in the conversion. If that exceeds \a resultCapacity nothing is written. 4 bytes per code point always suffice.
+CI_API size_t	toUtf8( const char32_t *utf32Str, size_t lengthInBytes, char *result, size_t resultCapacity );
+
+//! Replaces the contents of \a result with the conversion of the UTF-8 string \a utf8Str, reusing its capacity. Repeatedly converting into the same string stops allocating once it has grown large enough.
+CI_API void		toUtf16( const char *utf8Str, size_t lengthInBytes, std::u16string *result );
+//! Replaces the contents of \a result with the conversion of the UTF-8 string \a utf8Str, reusing its capacity.
+CI_API void		toUtf32( const char *utf8Str, size_t lengthInBytes, std::u32string *result );
+//! Replaces the contents of \a result with the conversion of \a lengthInBytes bytes of the UTF-16 string \a utf16Str, reusing its capacity.
+CI_API void		toUtf8( const char16_t *utf16Str, size_t lengthInBytes, std::string *result );
+//! Replaces the contents of \a result with the conversion of \a lengthInBytes bytes of the UTF-32 string \a utf32Str, reusing its capacity.
+CI_API void		toUtf8( const char32_t *utf32Str, size_t lengthInBytes, std::string *result );
+
 //! Returns the number of characters (not bytes) in the the UTF-8 string \a str. Optimize operation by supplying a non-default \a lengthInBytes of \a str.
 CI_API size_t	stringLengthUtf8( const char *str, size_t lengthInBytes = 0 );
 //!  Returns the UTF-32 code point of the next character in \a str, relative to the byte \a inOutByte. Increments \a inOutByte to be the first byte of the next character. Optimize operation by supplying a non-default \a lengthInBytes of \a str.
@@ -64,6 +88,50 @@ CI_API void		calcLinebreaksUtf8( const char *str, std::vector<uint8_t> *resultBr
 //! Sets \a resultBreaks to be of the same length as the UTF-8 string \a str with the values enumerated by UnicodeBreaks
 CI_API void		calcLinebreaksUtf8( const char *str, size_t strLength, std::vector<uint8_t> *resultBreaks );
 
+//! Returns the length in bytes of the paragraph which starts \a str, including the '\\n' which ends it. Paragraphs are broken into lines independently of each other.
+CI_API size_t	paragraphLengthUtf8( const char *str, size_t lengthInBytes );
+//! Sets \a resultBreaks to the break opportunities of the paragraph \a str, as calcLinebreaksUtf8() would calculate them for a text in which it follows another paragraph, unless it's the \a first.
+CI_API void		calcParagraphLinebreaksUtf8( const char *str, size_t strLength, bool first, std::vector<uint8_t> *resultBreaks );
+//! Breaks the paragraph \a str into lines as lineBreakUtf8() would within a longer text, using the \a breaks calculated by calcParagraphLinebreaksUtf8(). Unless it's the \a first paragraph its leading spaces are skipped.
+CI_API void		lineBreakParagraphUtf8( const char *str, size_t lengthInBytes, const uint8_t *breaks, bool first, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn );
+
+//! Caches the break opportunities of each paragraph of UTF-8 text, so that breaking edited text only recalculates the paragraphs which changed
+class CI_API LinebreakCache {
+  public:
+	LinebreakCache() : mNumCalculated( 0 ), mGeneration( 0 ) {}
+
+	//! Sets \a resultBreaks like ci::calcLinebreaksUtf8(), then evicts the paragraphs which weren't part of \a str
+	void	calcLinebreaksUtf8( const char *str, size_t strLength, std::vector<uint8_t> *resultBreaks );
+	//! Breaks \a str into lines like ci::lineBreakUtf8(), then evicts the paragraphs which weren't part of \a str
+	void	lineBreakUtf8( const char *str, size_t lengthInBytes, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn );
+
+	//! Returns the break opportunities of the paragraph \a str like calcParagraphLinebreaksUtf8(), calculating them only if they aren't cached
+	const std::vector<uint8_t>&	getParagraphBreaks( const char *str, size_t lengthInBytes, bool first );
+	//! Evicts the paragraphs which haven't been used since the last eviction
+	void	evictUnused();
+	//! Evicts all paragraphs
+	void	clear();
+
+	//! Returns the number of paragraphs currently cached
+	size_t	getNumParagraphs() const { return mParagraphs.size(); }
+	//! Returns the number of times a paragraph's breaks were calculated rather than found in the cache
+	size_t	getNumCalculated() const { return mNumCalculated; }
+
+  private:
+	struct Paragraph {
+		Paragraph() : mLastUse( 0 ) {}
+
+		std::vector<uint8_t>	mBreaks;
+		uint64_t				mLastUse;
+	};
+
+	//! Keyed by the paragraph's text followed by a byte which is 1 for the first paragraph and 0 otherwise
+	std::unordered_map<std::string, Paragraph>	mParagraphs;
+	std::string									mKey;	// reused so that finding a cached paragraph doesn't allocate
+	size_t										mNumCalculated;
+	uint64_t									mGeneration;
+};
+
 //! Sets \a resultBreaks to be of the same length as the null-terminated UTF-16 string \a str with the values enumerated by UnicodeBreaks
 CI_API void		calcLinebreaksUtf16( const uint16_t *str, std::vector<uint8_t> *resultBreaks );
 
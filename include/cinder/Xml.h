@@ -374,6 +374,8 @@ class CI_API XmlTree {
 	class CI_API ExcChildNotFound : public XmlTree::Exception {
 	  public:
 		ExcChildNotFound( const XmlTree &node, const std::string &childPath ) throw();
+		//! Constructs the exception from the path of the node that was searched, as returned by XmlTree::getPath().
+		ExcChildNotFound( const std::string &nodePath, const std::string &childPath ) throw();
 	  
 		virtual const char* what() const throw() { return mMessage; }
 	  
@@ -385,6 +387,8 @@ class CI_API XmlTree {
 	class CI_API ExcAttrNotFound : public XmlTree::Exception {
 	  public:
 		ExcAttrNotFound( const XmlTree &node, const std::string &attrName ) throw();
+		//! Constructs the exception from the path of the node that was searched, as returned by XmlTree::getPath().
+		ExcAttrNotFound( const std::string &nodePath, const std::string &attrName ) throw();
 			  
 		virtual const char* what() const throw() { return mMessage; }
 	  
@@ -0,0 +1,287 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Xml.h"
+#include "cinder/Noncopyable.h"
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! \cond
+namespace rapidxml {
+	template<class Ch> class xml_attribute;
+};
+//! \endcond
+
+namespace cinder {
+
+//! Read-only view of an XML document which keeps the RapidXML parse alive rather than copying it into an XmlTree.
+/** Tags, values and attributes reference the document's own copy of the source text, so loading performs no per-node string
+	allocations. Nodes are exposed through lightweight Node handles which are valid for the lifetime of the XmlDocument and
+	follow the same ParseOptions, path syntax and case rules as XmlTree. Call buildIndex() before performing many path
+	lookups on a large document. Use toXmlTree() to convert to a mutable XmlTree.
+	\code
+	XmlDocument doc( loadAsset( "config.xml" ) );
+	float gamma = doc.getChild( "config/display/gamma" ).getValue<float>();
+	for( auto item : doc / "config" / "items" )
+		console() << item.getTag() << ": " << item.getAttributeValue<int>( "id" ) << std::endl;
+	\endcode **/
+class CI_API XmlDocument : private Noncopyable {
+  private:
+	typedef rapidxml::xml_node<char>		NodeImpl;
+	typedef rapidxml::xml_attribute<char>	AttrImpl;
+
+  public:
+	//! Lightweight handle to an attribute within an XmlDocument. An Attr for a non-existent attribute has an empty name and value.
+	class CI_API Attr {
+	  public:
+		Attr() : mAttr( nullptr ) {}
+
+		//! Returns whether the attribute exists
+		explicit operator bool() const	{ return mAttr != nullptr; }
+		//! Returns true if the Attr value is empty
+		bool			empty() const	{ return getValueLength() == 0; }
+
+		//! Returns the name of the attribute as a string.
+		std::string		getName() const	{ return std::string( getNameData(), getNameLength() ); }
+		//! Returns a pointer to the attribute's null-terminated name within the document
+		const char*		getNameData() const;
+		//! Returns the length of the attribute's name in bytes
+		size_t			getNameLength() const;
+
+		//! Returns the value of the attribute as a string.
+		std::string		getValue() const	{ return std::string( getValueData(), getValueLength() ); }
+		//! Returns a pointer to the attribute's null-terminated value within the document
+		const char*		getValueData() const;
+		//! Returns the length of the attribute's value in bytes
+		size_t			getValueLength() const;
+		//! Returns the value of the attribute parsed as a T using ci::fromString().
+		template<typename T>
+		T				getValue() const	{ return fromString<T>( getValue() ); }
+
+		//! Returns the next attribute of the same node, or an empty Attr if this is the last
+		Attr			getNext() const;
+
+		bool	operator==( const char *rhs ) const;
+		bool	operator==( const std::string &rhs ) const	{ return *this == rhs.c_str(); }
+		bool	operator!=( const char *rhs ) const			{ return ! ( *this == rhs ); }
+		bool	operator!=( const std::string &rhs ) const	{ return ! ( *this == rhs.c_str() ); }
+
+	  private:
+		explicit Attr( const AttrImpl *attr ) : mAttr( attr ) {}
+
+		const AttrImpl	*mAttr;
+
+		friend class XmlDocument;
+	};
+
+	//! Lightweight handle to a node within an XmlDocument. Valid for the lifetime of the XmlDocument.
+	class CI_API Node {
+	  public:
+		//! A const iterator over the children of a Node, optionally filtered by a path in the manner of XmlTree::begin( filterPath ).
+		class CI_API ConstIter {
+		  public:
+			typedef std::forward_iterator_tag	iterator_category;
+			typedef Node						value_type;
+			typedef std::ptrdiff_t				difference_type;
+			typedef const Node*					pointer;
+			typedef Node						reference;
+
+			ConstIter() : mDoc( nullptr ), mNode( nullptr ), mCaseSensitive( false ) {}
+
+			Node			operator*() const	{ return Node( mDoc, mNode ); }
+			ConstIter&		operator++();
+			ConstIter		operator++( int ) { ConstIter prev( *this ); ++(*this); return prev; }
+			bool			operator==( const ConstIter &rhs ) const { return mNode == rhs.mNode; }
+			bool			operator!=( const ConstIter &rhs ) const { return mNode != rhs.mNode; }
+
+		  private:
+			ConstIter( const XmlDocument *doc, const NodeImpl *node ) : mDoc( doc ), mNode( node ), mCaseSensitive( false ) {}
+			ConstIter( const XmlDocument *doc, const NodeImpl *parent, const std::string &filterPath, bool caseSensitive, char separator );
+
+			const NodeImpl*		seek( const NodeImpl *parent, const NodeImpl *node, size_t level ) const;
+
+			const XmlDocument			*mDoc;
+			const NodeImpl				*mNode;
+			std::vector<std::string>	mFilter;
+			bool						mCaseSensitive;
+
+			friend class Node;
+		};
+
+		//! Returns the type of this node as an XmlTree::NodeType.
+		XmlTree::NodeType	getNodeType() const;
+		//! Returns whether this node is a document node, meaning it is a root node.
+		bool				isDocument() const	{ return getNodeType() == XmlTree::NODE_DOCUMENT; }
+		//! Returns whether this node is an element node.
+		bool				isElement() const	{ return getNodeType() == XmlTree::NODE_ELEMENT; }
+		//! Returns whether this node represents CDATA. Only possible when a document's ParseOptions disabled collapsing CDATA.
+		bool				isCData() const		{ return getNodeType() == XmlTree::NODE_CDATA; }
+		//! Returns whether this node represents a comment. Only possible when a document's ParseOptions enabled parsing comments.
+		bool				isComment() const	{ return getNodeType() == XmlTree::NODE_COMMENT; }
+
+		//! Returns the tag or name of the node as a string.
+		std::string			getTag() const		{ return std::string( getTagData(), getTagLength() ); }
+		//! Returns a pointer to the node's null-terminated tag within the document
+		const char*			getTagData() const;
+		//! Returns the length of the node's tag in bytes
+		size_t				getTagLength() const;
+
+		//! Returns the value of the node as a string. As with XmlTree, CDATA children are appended unless the document's ParseOptions disabled collapsing CDATA.
+		std::string			getValue() const;
+		//! Returns a pointer to the node's null-terminated value within the document, excluding any collapsed CDATA
+		const char*			getValueData() const;
+		//! Returns the length of the node's value in bytes, excluding any collapsed CDATA
+		size_t				getValueLength() const;
+		//! Returns the value of the node parsed as a T. Requires T to support the istream>> operator.
+		template<typename T>
+		T					getValue() const	{ return fromString<T>( getValue() ); }
+		//! Returns the value of the node parsed as a T. If the value is empty or fails to parse \a defaultValue is returned.
+		template<typename T>
+		T					getValue( const T &defaultValue ) const { try { return fromString<T>( getValue() ); } catch( ... ) { return defaultValue; } }
+
+		//! Returns whether this node has a parent node.
+		bool				hasParent() const;
+		//! Returns the node which is the parent of this node.
+		Node				getParent() const;
+
+		//! Returns whether at least one child matches \a relativePath
+		bool				hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns the first child that matches \a relativePath. Throws XmlTree::ExcChildNotFound if none matches.
+		Node				getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns the first child that matches \a childName. Throws XmlTree::ExcChildNotFound if none matches.
+		Node				operator/( const std::string &childName ) const	{ return getChild( childName ); }
+		//! Returns the first child that matches \a relativePath or end() if none matches
+		ConstIter			find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const { return begin( relativePath, caseSensitive, separator ); }
+
+		//! Returns an iterator to the first child node of this node.
+		ConstIter			begin() const;
+		//! Returns an iterator to the children of this node which match the path \a filterPath.
+		ConstIter			begin( const std::string &filterPath, bool caseSensitive = false, char separator = '/' ) const;
+		//! Returns an iterator which marks the end of the children of this node.
+		ConstIter			end() const			{ return ConstIter( mDoc, nullptr ); }
+
+		//! Returns whether the node has an attribute named \a attrName.
+		bool				hasAttribute( const std::string &attrName ) const	{ return static_cast<bool>( findAttribute( attrName ) ); }
+		//! Returns the attribute named \a attrName. Throws XmlTree::ExcAttrNotFound if no attribute exists with that name.
+		Attr				getAttribute( const std::string &attrName ) const;
+		//! Returns the attribute named \a attrName, or an empty Attr if none exists.
+		Attr				operator[]( const std::string &attrName ) const		{ return findAttribute( attrName ); }
+		//! Returns the node's first attribute, or an empty Attr if it has none. Use Attr::getNext() to visit the rest.
+		Attr				getFirstAttribute() const;
+		//! Returns the value of the attribute \a attrName parsed as a T. Throws XmlTree::ExcAttrNotFound if no attribute exists with that name.
+		template<typename T>
+		T					getAttributeValue( const std::string &attrName ) const { return getAttribute( attrName ).getValue<T>(); }
+		//! Returns the value of the attribute \a attrName parsed as a T. Returns \a defaultValue if no attribute exists with that name or the attribute fails to cast to T.
+		template<typename T>
+		T					getAttributeValue( const std::string &attrName, const T &defaultValue ) const
+		{
+			Attr attr = findAttribute( attrName );
+			if( attr ) {
+				try {
+					return attr.getValue<T>();
+				}
+				catch( ... ) {
+					return defaultValue;
+				}
+			}
+			else
+				return defaultValue;
+		}
+
+		//! Returns a path to this node, separated by the character \a separator.
+		std::string			getPath( char separator = '/' ) const;
+
+		//! Returns an XmlTree containing a copy of this node and its descendants
+		XmlTree				toXmlTree() const;
+
+		bool	operator==( const Node &rhs ) const	{ return mNode == rhs.mNode; }
+		bool	operator!=( const Node &rhs ) const	{ return mNode != rhs.mNode; }
+
+	  private:
+		Node( const XmlDocument *doc, const NodeImpl *node ) : mDoc( doc ), mNode( node ) {}
+
+		const NodeImpl*		findNode( const std::string &relativePath, bool caseSensitive, char separator ) const;
+		Attr				findAttribute( const std::string &attrName ) const;
+		void				buildTree( XmlTree *result ) const;
+
+		const XmlDocument	*mDoc;
+		const NodeImpl		*mNode;
+
+		friend class XmlDocument;
+	};
+
+	typedef Node::ConstIter		ConstIter;
+
+	//! Parses the XML contained in \a dataSource using the options \a parseOptions. Throws rapidxml::parse_error on malformed input, as XmlTree does.
+	explicit XmlDocument( const DataSourceRef &dataSource, const XmlTree::ParseOptions &parseOptions = XmlTree::ParseOptions() );
+	//! Parses the XML contained in the string \a xmlString using the options \a parseOptions.
+	explicit XmlDocument( const std::string &xmlString, const XmlTree::ParseOptions &parseOptions = XmlTree::ParseOptions() );
+	//! Parses \a size bytes of XML starting at \a data. The text is copied, so \a data need not outlive the XmlDocument.
+	XmlDocument( const char *data, size_t size, const XmlTree::ParseOptions &parseOptions = XmlTree::ParseOptions() );
+	~XmlDocument();
+
+	//! Returns the document node, the parent of the document's root element
+	Node		getRoot() const		{ return Node( this, mRoot ); }
+	//! Returns the first child of the document node that matches \a relativePath. Throws XmlTree::ExcChildNotFound if none matches.
+	Node		getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const	{ return getRoot().getChild( relativePath, caseSensitive, separator ); }
+	//! Returns whether at least one child of the document node matches \a relativePath
+	bool		hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const	{ return getRoot().hasChild( relativePath, caseSensitive, separator ); }
+	//! Returns the first child of the document node that matches \a childName. Throws XmlTree::ExcChildNotFound if none matches.
+	Node		operator/( const std::string &childName ) const	{ return getRoot().getChild( childName ); }
+	//! Returns the DOCTYPE string of the document
+	std::string	getDocType() const;
+
+	//! Returns the options the document was parsed with
+	const XmlTree::ParseOptions&	getParseOptions() const		{ return mParseOptions; }
+
+	/** \brief Builds a hashed index of every element's children by tag, making each step of subsequent getChild() and hasChild() lookups constant time.
+		Lookups remain correct without the index, scanning children linearly as XmlTree does. The index is worthwhile when a
+		large document is queried repeatedly; building it visits every element once. **/
+	void		buildIndex();
+	//! Returns whether buildIndex() has been called
+	bool		hasIndex() const	{ return mIndexed; }
+
+	//! Returns an XmlTree containing a copy of the entire document
+	XmlTree		toXmlTree() const	{ return getRoot().toXmlTree(); }
+
+  private:
+	void			parse( const char *data, size_t size );
+	const NodeImpl*	findChild( const NodeImpl *parent, const char *tag, size_t tagLength, bool caseSensitive ) const;
+	bool			isVisible( const NodeImpl *node ) const;
+
+	XmlTree::ParseOptions									mParseOptions;
+	std::unique_ptr<char[]>									mText;
+	std::unique_ptr<rapidxml::xml_document<char>>			mDoc;
+	const NodeImpl											*mRoot;
+	// maps a hash of ( parent, case-folded tag ) to the first child with that tag
+	std::unordered_map<size_t, const NodeImpl*>				mIndex;
+	bool													mIndexed;
+};
+
+} // namespace cinder
@@ -0,0 +1,146 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/Color.h"
+#include "cinder/Matrix.h"
+#include "cinder/Shape2d.h"
+#include "cinder/PolyLine.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! CPU scanline rasterizer for Shape2d, Path2d and PolyLine2f, computing exact per-pixel area coverage for anti-aliasing.
+/** Geometry is accumulated as edges in pixel space and then composited into a Channel8u or Surface8u. Rows are
+	processed in horizontal bands which are distributed across threads. A Rasterizer may be reused for many shapes of
+	the same size; its edge storage is retained by clear(). **/
+class CI_API Rasterizer {
+  public:
+	typedef enum { FILL_RULE_NONZERO, FILL_RULE_EVENODD } FillRule;
+	typedef enum { LINE_CAP_BUTT, LINE_CAP_ROUND, LINE_CAP_SQUARE } LineCap;
+	typedef enum { LINE_JOIN_MITER, LINE_JOIN_ROUND, LINE_JOIN_BEVEL } LineJoin;
+
+	//! Describes how outlines are expanded by addStroke()
+	class CI_API StrokeStyle {
+	  public:
+		StrokeStyle( float width = 1.0f ) : mWidth( width ), mCap( LINE_CAP_BUTT ), mJoin( LINE_JOIN_MITER ), mMiterLimit( 4.0f ) {}
+
+		StrokeStyle&	width( float width ) { mWidth = width; return *this; }
+		StrokeStyle&	cap( LineCap cap ) { mCap = cap; return *this; }
+		StrokeStyle&	join( LineJoin join ) { mJoin = join; return *this; }
+		//! Sets the maximum ratio of miter length to stroke width before a miter join is beveled. Default is \c 4, matching SVG.
+		StrokeStyle&	miterLimit( float limit ) { mMiterLimit = limit; return *this; }
+
+		float		getWidth() const { return mWidth; }
+		LineCap		getCap() const { return mCap; }
+		LineJoin	getJoin() const { return mJoin; }
+		float		getMiterLimit() const { return mMiterLimit; }
+
+	  private:
+		float		mWidth;
+		LineCap		mCap;
+		LineJoin	mJoin;
+		float		mMiterLimit;
+	};
+
+	//! Constructs a Rasterizer which targets images of size \a width x \a height
+	Rasterizer( int32_t width, int32_t height );
+
+	int32_t		getWidth() const { return mWidth; }
+	int32_t		getHeight() const { return mHeight; }
+
+	//! Sets the transform applied to geometry passed to subsequent add*() calls. Default is identity.
+	void			setTransform( const mat3 &transform ) { mTransform = transform; }
+	const mat3&		getTransform() const { return mTransform; }
+	//! Sets the curve subdivision scale, where larger values produce more segments. Default is \c 1.
+	void			setApproximationScale( float scale ) { mApproximationScale = scale; }
+	float			getApproximationScale() const { return mApproximationScale; }
+	//! Sets the maximum number of threads used when compositing. \c 0 (the default) uses all available hardware threads. Small fills are always composited on the calling thread.
+	void			setMaxThreads( size_t maxThreads ) { mMaxThreads = maxThreads; }
+
+	//! Removes all accumulated edges, retaining allocated storage
+	void	clear() { mEdges.clear(); }
+	//! Returns whether any edges have been accumulated
+	bool	empty() const { return mEdges.empty(); }
+
+	//! Adds the interior of \a shape. Open contours are implicitly closed.
+	void	addShape( const Shape2d &shape );
+	//! Adds the interior of \a path. An open path is implicitly closed.
+	void	addPath( const Path2d &path );
+	//! Adds the interior of \a polyLine. An open PolyLine is implicitly closed.
+	void	addPolyLine( const PolyLine2f &polyLine );
+	//! Adds the outline of \a shape expanded according to \a style
+	void	addStroke( const Shape2d &shape, const StrokeStyle &style );
+	//! Adds the outline of \a path expanded according to \a style
+	void	addStroke( const Path2d &path, const StrokeStyle &style );
+	//! Adds the outline of \a polyLine expanded according to \a style
+	void	addStroke( const PolyLine2f &polyLine, const StrokeStyle &style );
+
+	//! Writes the coverage of the accumulated edges into \a result, replacing its contents. \a result must match the Rasterizer's dimensions.
+	void	renderCoverage( Channel8u *result, FillRule fillRule = FILL_RULE_NONZERO ) const;
+	//! Blends \a value into \a channel weighted by the coverage of the accumulated edges
+	void	fill( Channel8u *channel, uint8_t value = 255, FillRule fillRule = FILL_RULE_NONZERO ) const;
+	//! Blends \a color into \a surface weighted by the coverage of the accumulated edges and the alpha of \a color
+	void	fill( Surface8u *surface, const ColorA &color, FillRule fillRule = FILL_RULE_NONZERO ) const;
+
+  private:
+	struct Edge {
+		vec2	mP0, mP1; // mP0.y < mP1.y
+		float	mDir;
+	};
+
+	void	addContour( const std::vector<vec2> &points, bool alreadyTransformed = false );
+	void	addLine( vec2 p0, vec2 p1 );
+	void	addStrokeContour( const std::vector<vec2> &points, bool closed, const StrokeStyle &style );
+	void	addCircle( const vec2 &center, float radius );
+	void	addConvexPolygon( std::initializer_list<vec2> points );
+
+	template<typename SpanFnT>
+	void	rasterize( FillRule fillRule, SpanFnT &&spanFn ) const;
+
+	int32_t				mWidth, mHeight;
+	mat3				mTransform;
+	float				mApproximationScale;
+	size_t				mMaxThreads;
+	std::vector<Edge>	mEdges;
+};
+
+//! Fills \a shape into \a channel with anti-aliasing, blending toward \a value. \a transform maps \a shape into pixel space.
+CI_API void rasterize( Channel8u *channel, const Shape2d &shape, uint8_t value = 255, Rasterizer::FillRule fillRule = Rasterizer::FILL_RULE_NONZERO, const mat3 &transform = mat3() );
+//! Fills \a path into \a channel with anti-aliasing, blending toward \a value. \a transform maps \a path into pixel space.
+CI_API void rasterize( Channel8u *channel, const Path2d &path, uint8_t value = 255, Rasterizer::FillRule fillRule = Rasterizer::FILL_RULE_NONZERO, const mat3 &transform = mat3() );
+//! Fills \a shape into \a surface with anti-aliasing, blending \a color over the existing contents. \a transform maps \a shape into pixel space.
+CI_API void rasterize( Surface8u *surface, const Shape2d &shape, const ColorA &color, Rasterizer::FillRule fillRule = Rasterizer::FILL_RULE_NONZERO, const mat3 &transform = mat3() );
+//! Fills \a path into \a surface with anti-aliasing, blending \a color over the existing contents. \a transform maps \a path into pixel space.
+CI_API void rasterize( Surface8u *surface, const Path2d &path, const ColorA &color, Rasterizer::FillRule fillRule = Rasterizer::FILL_RULE_NONZERO, const mat3 &transform = mat3() );
+//! Strokes the outline of \a shape into \a channel according to \a style, blending toward \a value
+CI_API void rasterizeStroke( Channel8u *channel, const Shape2d &shape, const Rasterizer::StrokeStyle &style, uint8_t value = 255, const mat3 &transform = mat3() );
+//! Strokes the outline of \a shape into \a surface according to \a style, blending \a color over the existing contents
+CI_API void rasterizeStroke( Surface8u *surface, const Shape2d &shape, const Rasterizer::StrokeStyle &style, const ColorA &color, const mat3 &transform = mat3() );
+
+} } // namespace cinder::ip
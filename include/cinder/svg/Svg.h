@@ -25,7 +25,7 @@
 #pragma once
 
 #include "cinder/Cinder.h"
-#include "cinder/Xml.h"
+#include "cinder/DataSource.h"
 #include "cinder/Vector.h"
 #include "cinder/Matrix.h"
 #include "cinder/Color.h"
@@ -37,8 +37,15 @@
 #include "cinder/Noncopyable.h"
 
 #include <functional>
+#include <list>
 #include <map>
 
+//! \cond
+namespace rapidxml {
+	template<class Ch> class xml_node;
+};
+//! \endcond
+
 namespace cinder { namespace svg {
 
 typedef enum { FILL_RULE_NONZERO, FILL_RULE_EVENODD } FillRule;
@@ -181,7 +188,7 @@ class CI_API Paint {
 class CI_API Style {
   public:
 	Style();
-	Style( const XmlTree &xml, const Node *parent );
+	Style( const rapidxml::xml_node<char> &xml, const Node *parent );
 
 	//! Returns a Style set appropriately for global defaults
 	static Style	makeGlobalDefaults();
@@ -390,7 +397,7 @@ class CI_API Node {
 
 
   protected:
-	Node( Node *parent, const XmlTree &xml );
+	Node( Node *parent, const rapidxml::xml_node<char> &xml );
 	// returns whether this type of node directly renders anything. Everything but groups.
 	virtual bool	isDrawable() const { return true; }
 
@@ -426,11 +433,11 @@ class CI_API Node {
 //! Base class for SVG Gradients. See SVG Gradients: http://www.w3.org/TR/SVG/pservers.html#Gradients
 class CI_API Gradient : public Node {
   public:
-  	Gradient( Node *parent, const XmlTree &xml );
+  	Gradient( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	class CI_API Stop {
 	  public:
-	  	Stop( const Node *parent, const XmlTree &xml );
+	  	Stop( const Node *parent, const rapidxml::xml_node<char> &xml );
 		
 		float		mOffset; // normalized 0-1
 		ColorA8u	mColor;
@@ -444,7 +451,7 @@ class CI_API Gradient : public Node {
   protected:
 	virtual void	renderSelf( Renderer & /*renderer*/ ) const {}
 
-	void 		parse( const Node *parent, const XmlTree &xml );
+	void 		parse( const Node *parent, const rapidxml::xml_node<char> &xml );
 	void		copyAttributesFrom( const Gradient &rhs );
 	Paint		asPaint() const;
 
@@ -458,12 +465,12 @@ class CI_API Gradient : public Node {
 //! SVG Linear gradient
 class CI_API LinearGradient : public Gradient {
   public:
-	LinearGradient( Node *parent, const XmlTree &xml );
+	LinearGradient( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	Paint		asPaint() const;
 	
   protected:
-	void 		parse( const XmlTree &xml );
+	void 		parse( const rapidxml::xml_node<char> &xml );
 	
   	virtual bool	isDrawable() const { return false; }
 };
@@ -471,12 +478,12 @@ class CI_API LinearGradient : public Gradient {
 //! SVG Radial gradient
 class CI_API RadialGradient : public Gradient {
   public:
-	RadialGradient( Node *parent, const XmlTree &xml );
+	RadialGradient( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	Paint		asPaint() const;
 	
   protected:
-	void 		parse( const XmlTree &xml );
+	void 		parse( const rapidxml::xml_node<char> &xml );
 
 	virtual bool	isDrawable() const { return false; }
 	float			mRadius;
@@ -486,7 +493,7 @@ class CI_API RadialGradient : public Gradient {
 class CI_API Circle : public Node {
   public:
 	Circle( Node *parent ) : Node( parent ) {}
-	Circle( Node *parent, const XmlTree &xml );
+	Circle( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	vec2		getCenter() const { return mCenter; }
 	void		setCenter( const vec2 &center ) { mCenter = center; }
@@ -509,7 +516,7 @@ class CI_API Circle : public Node {
 class CI_API Ellipse : public Node {
   public:
 	Ellipse( Node *parent ) : Node( parent ) {}
-	Ellipse( Node *parent, const XmlTree &xml );
+	Ellipse( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	vec2		getCenter() const { return mCenter; }
 	void		setCenter( const vec2 &center ) { mCenter = center; }
@@ -534,7 +541,7 @@ class CI_API Ellipse : public Node {
 class CI_API Path : public Node {
   public:
 	Path( Node *parent ) : Node( parent ) {}
-	Path( Node *parent, const XmlTree &xml );
+	Path( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	const Shape2d&		getShape2d() const { return mPath; }
 	void				appendShape2d( Shape2d *appendTo ) const;
@@ -555,7 +562,7 @@ class CI_API Path : public Node {
 class CI_API Line : public Node {
   public:
 	Line( Node *parent ) : Node( parent ) {}
-	Line( Node *parent, const XmlTree &xml );
+	Line( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	const vec2&	getPoint1() const { return mPoint1; }
 	const vec2&	getPoint2() const { return mPoint2; }
@@ -573,7 +580,7 @@ class CI_API Line : public Node {
 class CI_API Rect : public Node {
   public:
 	Rect( Node *parent ) : Node( parent ) {}
-	Rect( Node *parent, const XmlTree &xml );
+	Rect( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	const Rectf&	getRect() const { return mRect; }
 	void			setRect( const Rectf &rect ) { mRect = rect; }
@@ -595,7 +602,7 @@ class CI_API Rect : public Node {
 class CI_API Polygon : public Node {
   public:
 	Polygon( Node *parent ) : Node( parent ) {}
-	Polygon( Node *parent, const XmlTree &xml );
+	Polygon( Node *parent, const rapidxml::xml_node<char> &xml );
 
 	const PolyLine2f&	getPolyLine() const { return mPolyLine; }
 	PolyLine2f&			getPolyLine() { return mPolyLine; }
@@ -615,7 +622,7 @@ class CI_API Polygon : public Node {
 class CI_API Polyline : public Node {
   public:
 	Polyline( Node *parent ) : Node( parent ) {}
-	Polyline( Node *parent, const XmlTree &xml );
+	Polyline( Node *parent, const rapidxml::xml_node<char> &xml );
 
 	const PolyLine2f&	getPolyLine() const { return mPolyLine; }
 	PolyLine2f&			getPolyLine() { return mPolyLine; }
@@ -634,7 +641,7 @@ class CI_API Polyline : public Node {
 //! SVG Use Element, which instantiates a different element: http://www.w3.org/TR/SVG/struct.html#UseElement
 class CI_API Use : public Node {
   public:
-	Use( Node *parent, const XmlTree &xml );
+	Use( Node *parent, const rapidxml::xml_node<char> &xml );
 	
 	virtual bool	isDrawable() const { return false; }
 	
@@ -644,7 +651,7 @@ class CI_API Use : public Node {
 	virtual void	renderSelf( Renderer &renderer ) const;  
 	virtual Rectf	calcBoundingBox() const { if( mReferenced ) return mReferenced->getBoundingBox(); else return Rectf(0,0,0,0); }
 	
-	void parse( const XmlTree &xml );
+	void parse( const rapidxml::xml_node<char> &xml );
 	
 	const Node		*mReferenced;
 };
@@ -652,7 +659,7 @@ class CI_API Use : public Node {
 //! SVG Image Element. Represents an unpremultiplied bitmap. http://www.w3.org/TR/SVG/struct.html#ImageElement
 class CI_API Image : public Node {
   public:
-	Image( Node *parent, const XmlTree &xml );
+	Image( Node *parent, const rapidxml::xml_node<char> &xml );
 
 	const Rectf&						getRect() const { return mRect; }
 	const std::shared_ptr<Surface8u>	getSurface() const { return mImage; }
@@ -678,7 +685,7 @@ class CI_API TextSpan : public Node {
 	class CI_API Attributes {
 	  public:
 		Attributes() {}
-		Attributes( const XmlTree &xml );
+		Attributes( const rapidxml::xml_node<char> &xml );
 
 		void 	startRender( Renderer &renderer ) const;
 		void 	finishRender( Renderer &renderer ) const;
@@ -693,7 +700,7 @@ class CI_API TextSpan : public Node {
 		std::vector<Value>	mLetterSpacing;
 	};
 
-	TextSpan( Node *parent, const XmlTree &xml );
+	TextSpan( Node *parent, const rapidxml::xml_node<char> &xml );
 	TextSpan( Node *parent, const std::string &spanString );
 	
 	const std::string&						getString() const { return mString; }
@@ -727,7 +734,7 @@ class CI_API TextSpan : public Node {
 //! SVG Text element. http://www.w3.org/TR/SVG/text.html#TextElement
 class CI_API Text : public Node {
   public:
-  	Text( Node *parent, const XmlTree &xml );
+  	Text( Node *parent, const rapidxml::xml_node<char> &xml );
 
 	vec2 	getTextPen() const;
 	void	setTextPen( const vec2 &textPen ) { mAttributes.setTextPen( textPen ); }  
@@ -749,7 +756,7 @@ class CI_API Text : public Node {
 class CI_API Group : public Node, private Noncopyable {
   public:
 	Group( Node *parent ) : Node( parent ) {}
-	Group( Node *parent, const XmlTree &xml );
+	Group( Node *parent, const rapidxml::xml_node<char> &xml );
 	~Group();
 
 	//! Recursively searches for a child element of type <tt>svg::T</tt> named \a id. Returns NULL on failure to find the object or if it is not of type T.
@@ -801,7 +808,7 @@ class CI_API Group : public Node, private Noncopyable {
 	virtual Rectf	calcBoundingBox() const;
 
 	virtual bool	isDrawable() const { return false; }
-	void 			parse( const XmlTree &xml );
+	void 			parse( const rapidxml::xml_node<char> &xml );
 
 	std::list<Node*>		mChildren;
 	std::shared_ptr<Group>	mDefs;
@@ -844,7 +851,6 @@ class CI_API Doc : public Group {
 
 	virtual void		renderSelf( Renderer &renderer ) const;
   
-	std::shared_ptr<XmlTree>	mXmlTree;
 	std::map<fs::path,std::shared_ptr<Surface8u> >	mImageCache;
 	
 	fs::path		mFilePath;
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/svg/Svg.h"
+#include "cinder/ip/Rasterize.h"
+
+namespace cinder {
+
+//! svg::Renderer which draws into a Surface8u using ip::Rasterizer, requiring no GL context or external dependencies.
+/** Gradients are approximated by their first color stop, and text spans are not drawn. **/
+class CI_API SvgRendererRaster : public svg::Renderer {
+  public:
+	//! Renders into \a target, which must outlive the renderer. \a transform maps document coordinates to pixels.
+	SvgRendererRaster( Surface8u *target, const mat3 &transform = mat3() );
+
+	void	pushGroup( const svg::Group &group, float opacity ) override;
+	void	popGroup() override;
+
+	void	drawPath( const svg::Path &path ) override;
+	void	drawPolyline( const svg::Polyline &polyline ) override;
+	void	drawPolygon( const svg::Polygon &polygon ) override;
+	void	drawLine( const svg::Line &line ) override;
+	void	drawRect( const svg::Rect &rect ) override;
+	void	drawCircle( const svg::Circle &circle ) override;
+	void	drawEllipse( const svg::Ellipse &ellipse ) override;
+	void	drawImage( const svg::Image &image ) override;
+
+	void	pushMatrix( const mat3 &m ) override;
+	void	popMatrix() override;
+	void	pushFill( const svg::Paint &paint ) override { mFillStack.push_back( paint ); }
+	void	popFill() override { mFillStack.pop_back(); }
+	void	pushStroke( const svg::Paint &paint ) override { mStrokeStack.push_back( paint ); }
+	void	popStroke() override { mStrokeStack.pop_back(); }
+	void	pushFillOpacity( float opacity ) override { mFillOpacityStack.push_back( opacity ); }
+	void	popFillOpacity() override { mFillOpacityStack.pop_back(); }
+	void	pushStrokeOpacity( float opacity ) override { mStrokeOpacityStack.push_back( opacity ); }
+	void	popStrokeOpacity() override { mStrokeOpacityStack.pop_back(); }
+	void	pushStrokeWidth( float width ) override { mStrokeWidthStack.push_back( width ); }
+	void	popStrokeWidth() override { mStrokeWidthStack.pop_back(); }
+	void	pushFillRule( svg::FillRule rule ) override { mFillRuleStack.push_back( rule ); }
+	void	popFillRule() override { mFillRuleStack.pop_back(); }
+	void	pushLineCap( svg::LineCap lineCap ) override { mLineCapStack.push_back( lineCap ); }
+	void	popLineCap() override { mLineCapStack.pop_back(); }
+	void	pushLineJoin( svg::LineJoin lineJoin ) override { mLineJoinStack.push_back( lineJoin ); }
+	void	popLineJoin() override { mLineJoinStack.pop_back(); }
+
+  private:
+	void	fillAndStroke( const Shape2d &shape, bool fill );
+	bool	calcPaintColor( const svg::Paint &paint, float opacity, ColorA *result ) const;
+
+	Surface8u					*mTarget;
+	ip::Rasterizer				mRasterizer;
+	std::vector<mat3>			mMatrixStack;
+	std::vector<svg::Paint>		mFillStack, mStrokeStack;
+	std::vector<float>			mFillOpacityStack, mStrokeOpacityStack, mGroupOpacityStack;
+	std::vector<float>			mStrokeWidthStack;
+	std::vector<svg::FillRule>	mFillRuleStack;
+	std::vector<svg::LineCap>	mLineCapStack;
+	std::vector<svg::LineJoin>	mLineJoinStack;
+};
+
+namespace svg {
+//! Renders \a node into \a target without requiring a GL context. \a transform maps document coordinates to pixels.
+CI_API void render( Surface8u *target, const Node &node, const mat3 &transform = mat3() );
+//! Returns a Surface8u with alpha the size of \a doc containing \a doc rendered over a transparent background
+CI_API Surface8u renderToSurface( const Doc &doc );
+} // namespace svg
+
+} // namespace cinder
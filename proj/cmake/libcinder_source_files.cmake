@@ -12,6 +12,7 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/BSpline.cpp
 	${CINDER_SRC_DIR}/cinder/BSplineFit.cpp
 	${CINDER_SRC_DIR}/cinder/Buffer.cpp
+	${CINDER_SRC_DIR}/cinder/Bvh.cpp
 	${CINDER_SRC_DIR}/cinder/Camera.cpp
 	${CINDER_SRC_DIR}/cinder/CameraUi.cpp
 	${CINDER_SRC_DIR}/cinder/Channel.cpp
@@ -28,19 +29,23 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/Font.cpp
 	${CINDER_SRC_DIR}/cinder/Frustum.cpp
 	${CINDER_SRC_DIR}/cinder/GeomIo.cpp
+	${CINDER_SRC_DIR}/cinder/GeomOptimize.cpp
 	${CINDER_SRC_DIR}/cinder/ImageFileTinyExr.cpp
 	${CINDER_SRC_DIR}/cinder/ImageIo.cpp
 	${CINDER_SRC_DIR}/cinder/ImageSourceFileRadiance.cpp
 	${CINDER_SRC_DIR}/cinder/ImageSourceFileStbImage.cpp
 	${CINDER_SRC_DIR}/cinder/ImageTargetFileStbImage.cpp
 	${CINDER_SRC_DIR}/cinder/Json.cpp
+	${CINDER_SRC_DIR}/cinder/JsonDocument.cpp
 	${CINDER_SRC_DIR}/cinder/Log.cpp
+	${CINDER_SRC_DIR}/cinder/LooseOctree.cpp
 	${CINDER_SRC_DIR}/cinder/Matrix.cpp
 	${CINDER_SRC_DIR}/cinder/MediaTime.cpp
 	${CINDER_SRC_DIR}/cinder/ObjLoader.cpp
 	${CINDER_SRC_DIR}/cinder/Path2d.cpp
 	${CINDER_SRC_DIR}/cinder/Perlin.cpp
 	${CINDER_SRC_DIR}/cinder/Plane.cpp
+	${CINDER_SRC_DIR}/cinder/PolygonOps.cpp
 	${CINDER_SRC_DIR}/cinder/PolyLine.cpp
 	${CINDER_SRC_DIR}/cinder/Rand.cpp
 	${CINDER_SRC_DIR}/cinder/Ray.cpp
@@ -62,6 +67,7 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/Url.cpp
 	${CINDER_SRC_DIR}/cinder/Utilities.cpp
 	${CINDER_SRC_DIR}/cinder/Xml.cpp
+	${CINDER_SRC_DIR}/cinder/XmlDocument.cpp
 )
 
 if( ( NOT CINDER_LINUX ) AND ( NOT CINDER_ANDROID ) )
@@ -189,6 +195,7 @@ list( APPEND SRC_SET_CINDER_IP
 	${CINDER_SRC_DIR}/cinder/ip/Fill.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Grayscale.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Premultiply.cpp
+	${CINDER_SRC_DIR}/cinder/ip/Rasterize.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Threshold.cpp
 	${CINDER_SRC_DIR}/cinder/ip/EdgeDetect.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Flip.cpp
@@ -206,6 +213,7 @@ source_group( "cinder\\ip" FILES    ${SRC_SET_CINDER_IP} )
 
 list( APPEND SRC_SET_CINDER_SVG
 	${CINDER_SRC_DIR}/cinder/svg/Svg.cpp
+	${CINDER_SRC_DIR}/cinder/svg/SvgRaster.cpp
 )
 
 list( APPEND CINDER_SRC_FILES       ${SRC_SET_CINDER_SVG} )
@@ -21,201 +21,275 @@
  POSSIBILITY OF SUCH DAMAGE.
 */
 
-/* Significant portions of this code come from the public domain libb64 project. For details, see http://sourceforge.net/projects/libb64 */
-
 #include "cinder/Base64.h"
+#include "cinder/Simd.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace {
 
-typedef enum { step_a, step_b, step_c, step_d } base64_decodestep;
+const char sEncoding[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Maps each character to its sextet, or to 0xFF for characters outside the alphabet, which decoding skips
+struct DecodingTable {
+	DecodingTable()
+	{
+		std::memset( mValues, 0xFF, sizeof( mValues ) );
+		for( uint8_t i = 0; i < 64; ++i )
+			mValues[(uint8_t)sEncoding[i]] = i;
+	}
+
+	uint8_t		mValues[256];
+};
 
-typedef struct {
-	base64_decodestep step;
-	char plainchar;
-} base64_decodestate;
+const DecodingTable sDecoding;
 
-int base64_decode_value( char value_in ) {
-	static const char decoding[] = {62,static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),63,52,53,54,55,56,57,58,59,60,61,static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-2),static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),static_cast<char>(-1),26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51};
-	static const char decoding_size = sizeof(decoding);
-	value_in -= 43;
-	if (value_in < 0 || value_in > decoding_size) return -1;
-	return decoding[(int)value_in];
+// Input handled per chunk by the streaming encoder and decoder
+const size_t sStreamChunkGroups = 4096;
+const size_t sStreamChunkChars = 16384;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// encode
+
+#if defined( CINDER_SIMD_SSE2 )
+// Maps 16 sextets to the alphabet by adding an offset that depends on the range each falls in
+inline __m128i encodeSextets( __m128i s )
+{
+	__m128i offset = _mm_set1_epi8( 'A' );
+	offset = _mm_add_epi8( offset, _mm_and_si128( _mm_cmpgt_epi8( s, _mm_set1_epi8( 25 ) ), _mm_set1_epi8( ( 'a' - 26 ) - 'A' ) ) );
+	offset = _mm_add_epi8( offset, _mm_and_si128( _mm_cmpgt_epi8( s, _mm_set1_epi8( 51 ) ), _mm_set1_epi8( ( '0' - 52 ) - ( 'a' - 26 ) ) ) );
+	offset = _mm_add_epi8( offset, _mm_and_si128( _mm_cmpgt_epi8( s, _mm_set1_epi8( 61 ) ), _mm_set1_epi8( ( '+' - 62 ) - ( '0' - 52 ) ) ) );
+	offset = _mm_add_epi8( offset, _mm_and_si128( _mm_cmpgt_epi8( s, _mm_set1_epi8( 62 ) ), _mm_set1_epi8( ( '/' - 63 ) - ( '+' - 62 ) ) ) );
+	return _mm_add_epi8( s, offset );
 }
+#elif defined( CINDER_SIMD_NEON )
+inline uint8x16_t encodeSextets( uint8x16_t s )
+{
+	uint8x16_t offset = vdupq_n_u8( 'A' );
+	offset = vaddq_u8( offset, vandq_u8( vcgtq_u8( s, vdupq_n_u8( 25 ) ), vdupq_n_u8( uint8_t( ( 'a' - 26 ) - 'A' ) ) ) );
+	offset = vaddq_u8( offset, vandq_u8( vcgtq_u8( s, vdupq_n_u8( 51 ) ), vdupq_n_u8( uint8_t( ( '0' - 52 ) - ( 'a' - 26 ) ) ) ) );
+	offset = vaddq_u8( offset, vandq_u8( vcgtq_u8( s, vdupq_n_u8( 61 ) ), vdupq_n_u8( uint8_t( ( '+' - 62 ) - ( '0' - 52 ) ) ) ) );
+	offset = vaddq_u8( offset, vandq_u8( vcgtq_u8( s, vdupq_n_u8( 62 ) ), vdupq_n_u8( uint8_t( ( '/' - 63 ) - ( '+' - 62 ) ) ) ) );
+	return vaddq_u8( s, offset );
+}
+#endif
 
-void base64_init_decodestate( base64_decodestate* state_in )
+// Encodes \a numGroups groups of three bytes into four characters each, without line breaks
+char* encodeGroups( const uint8_t *in, size_t numGroups, char *out )
 {
-	state_in->step = step_a;
-	state_in->plainchar = 0;
+#if defined( CINDER_SIMD_SSE2 )
+	// each iteration loads 16 bytes and encodes the first 12, so the last groups are left to the scalar loop
+	for( ; numGroups >= 6; numGroups -= 4, in += 12, out += 16 ) {
+		const __m128i bytes = _mm_loadu_si128( (const __m128i*)in );
+		// spread the groups to one per 32-bit lane: the 64-bit lanes get bytes 0-5 and 6-11, then the second group in each moves up a byte
+		const __m128i halves = _mm_unpacklo_epi64( bytes, _mm_srli_si128( bytes, 6 ) );
+		const __m128i groups = _mm_or_si128( _mm_and_si128( halves, _mm_set_epi32( 0, 0xFFFFFF, 0, 0xFFFFFF ) ),
+												_mm_and_si128( _mm_slli_epi64( halves, 8 ), _mm_set_epi32( 0xFFFFFF, 0, 0xFFFFFF, 0 ) ) );
+
+		// each lane holds b0 | b1 << 8 | b2 << 16, and gets its four sextets in output order
+		__m128i s = _mm_and_si128( _mm_srli_epi32( groups, 2 ), _mm_set1_epi32( 0x3F ) );
+		s = _mm_or_si128( s, _mm_and_si128( _mm_slli_epi32( groups, 12 ), _mm_set1_epi32( 0x3000 ) ) );
+		s = _mm_or_si128( s, _mm_and_si128( _mm_srli_epi32( groups, 4 ), _mm_set1_epi32( 0x0F00 ) ) );
+		s = _mm_or_si128( s, _mm_and_si128( _mm_slli_epi32( groups, 10 ), _mm_set1_epi32( 0x3C0000 ) ) );
+		s = _mm_or_si128( s, _mm_and_si128( _mm_srli_epi32( groups, 6 ), _mm_set1_epi32( 0x030000 ) ) );
+		s = _mm_or_si128( s, _mm_and_si128( _mm_slli_epi32( groups, 8 ), _mm_set1_epi32( 0x3F000000 ) ) );
+		_mm_storeu_si128( (__m128i*)out, encodeSextets( s ) );
+	}
+#elif defined( CINDER_SIMD_NEON )
+	for( ; numGroups >= 16; numGroups -= 16, in += 48, out += 64 ) {
+		const uint8x16x3_t bytes = vld3q_u8( in );
+		uint8x16x4_t chars;
+		chars.val[0] = encodeSextets( vshrq_n_u8( bytes.val[0], 2 ) );
+		chars.val[1] = encodeSextets( vorrq_u8( vshlq_n_u8( vandq_u8( bytes.val[0], vdupq_n_u8( 0x03 ) ), 4 ), vshrq_n_u8( bytes.val[1], 4 ) ) );
+		chars.val[2] = encodeSextets( vorrq_u8( vshlq_n_u8( vandq_u8( bytes.val[1], vdupq_n_u8( 0x0F ) ), 2 ), vshrq_n_u8( bytes.val[2], 6 ) ) );
+		chars.val[3] = encodeSextets( vandq_u8( bytes.val[2], vdupq_n_u8( 0x3F ) ) );
+		vst4q_u8( (uint8_t*)out, chars );
+	}
+#endif
+
+	for( ; numGroups > 0; --numGroups, in += 3, out += 4 ) {
+		const uint32_t v = ( uint32_t( in[0] ) << 16 ) | ( uint32_t( in[1] ) << 8 ) | in[2];
+		out[0] = sEncoding[v >> 18];
+		out[1] = sEncoding[( v >> 12 ) & 0x3F];
+		out[2] = sEncoding[( v >> 6 ) & 0x3F];
+		out[3] = sEncoding[v & 0x3F];
+	}
+
+	return out;
 }
 
-ptrdiff_t base64_decode_block( const char* code_in, const size_t length_in, char* plaintext_out, base64_decodestate* state_in )
+// Encodes \a numGroups groups, inserting a line break after every \a groupsPerLine groups if it's non-zero. \a groupsOnLine carries over between calls.
+char* encodeLines( const uint8_t *in, size_t numGroups, char *out, size_t groupsPerLine, size_t &groupsOnLine )
 {
-	const char* codechar = code_in;
-	char* plainchar = plaintext_out;
-	char fragment;
-	
-	*plainchar = state_in->plainchar;
-	
-	switch (state_in->step)
-	{
-		while (1)
-		{
-	case step_a:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_a;
-					state_in->plainchar = 0;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar    = (fragment & 0x03f) << 2;
-	case step_b:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_b;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++ |= (fragment & 0x030) >> 4;
-			*plainchar    = (fragment & 0x00f) << 4;
-	case step_c:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_c;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++ |= (fragment & 0x03c) >> 2;
-			*plainchar    = (fragment & 0x003) << 6;
-	case step_d:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_d;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++   |= (fragment & 0x03f);
+	if( groupsPerLine == 0 )
+		return encodeGroups( in, numGroups, out );
+
+	while( numGroups > 0 ) {
+		const size_t count = std::min( numGroups, groupsPerLine - groupsOnLine );
+		out = encodeGroups( in, count, out );
+		in += count * 3;
+		numGroups -= count;
+		groupsOnLine += count;
+		if( groupsOnLine == groupsPerLine ) {
+			*out++ = '\n';
+			groupsOnLine = 0;
 		}
 	}
-	/* control should not reach here */
-	return plainchar - plaintext_out;
+
+	return out;
+}
+
+// Encodes the last one or two bytes with padding
+char* encodeEnd( const uint8_t *in, size_t size, char *out )
+{
+	const uint32_t v = ( uint32_t( in[0] ) << 16 ) | ( size > 1 ? uint32_t( in[1] ) << 8 : 0 );
+	out[0] = sEncoding[v >> 18];
+	out[1] = sEncoding[( v >> 12 ) & 0x3F];
+	out[2] = ( size > 1 ) ? sEncoding[( v >> 6 ) & 0x3F] : '=';
+	out[3] = '=';
+	return out + 4;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// encode
-typedef enum { step_A, step_B, step_C } base64_encodestep;
+// decode
 
-typedef struct {
-	base64_encodestep step;
-	char result;
-	int stepcount;
-} base64_encodestate;
+#if defined( CINDER_SIMD_SSE2 )
+inline __m128i inRange( __m128i c, char lo, char hi )
+{
+	return _mm_and_si128( _mm_cmpgt_epi8( c, _mm_set1_epi8( lo - 1 ) ), _mm_cmpgt_epi8( _mm_set1_epi8( hi + 1 ), c ) );
+}
 
-void base64_init_encodestate( base64_encodestate* state_in )
+// Maps 16 characters to sextets, returning false if any is outside the alphabet. Bytes above 127 compare as negative, so fall outside every range.
+inline bool decodeChars( __m128i c, __m128i *sextets )
 {
-	state_in->step = step_A;
-	state_in->result = 0;
-	state_in->stepcount = 0;
+	const __m128i upper = inRange( c, 'A', 'Z' ), lower = inRange( c, 'a', 'z' ), digit = inRange( c, '0', '9' );
+	const __m128i plus = _mm_cmpeq_epi8( c, _mm_set1_epi8( '+' ) ), slash = _mm_cmpeq_epi8( c, _mm_set1_epi8( '/' ) );
+	const __m128i valid = _mm_or_si128( _mm_or_si128( _mm_or_si128( upper, lower ), _mm_or_si128( digit, plus ) ), slash );
+	if( _mm_movemask_epi8( valid ) != 0xFFFF )
+		return false;
+
+	__m128i offset = _mm_and_si128( upper, _mm_set1_epi8( -'A' ) );
+	offset = _mm_or_si128( offset, _mm_and_si128( lower, _mm_set1_epi8( 26 - 'a' ) ) );
+	offset = _mm_or_si128( offset, _mm_and_si128( digit, _mm_set1_epi8( 52 - '0' ) ) );
+	offset = _mm_or_si128( offset, _mm_and_si128( plus, _mm_set1_epi8( 62 - '+' ) ) );
+	offset = _mm_or_si128( offset, _mm_and_si128( slash, _mm_set1_epi8( 63 - '/' ) ) );
+	*sextets = _mm_add_epi8( c, offset );
+	return true;
+}
+#elif defined( CINDER_SIMD_NEON )
+inline uint8x16_t inRange( uint8x16_t c, uint8_t lo, uint8_t hi )
+{
+	return vandq_u8( vcgeq_u8( c, vdupq_n_u8( lo ) ), vcleq_u8( c, vdupq_n_u8( hi ) ) );
 }
 
-char base64_encode_value(char value_in)
+// Maps 16 characters to sextets, and sets \a valid to all ones in the lanes whose characters are in the alphabet
+inline uint8x16_t decodeChars( uint8x16_t c, uint8x16_t *valid )
 {
-	static const char* encoding = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-	if (value_in > 63) return '=';
-	return encoding[(int)value_in];
+	const uint8x16_t upper = inRange( c, 'A', 'Z' ), lower = inRange( c, 'a', 'z' ), digit = inRange( c, '0', '9' );
+	const uint8x16_t plus = vceqq_u8( c, vdupq_n_u8( '+' ) ), slash = vceqq_u8( c, vdupq_n_u8( '/' ) );
+	*valid = vorrq_u8( vorrq_u8( vorrq_u8( upper, lower ), vorrq_u8( digit, plus ) ), slash );
+
+	uint8x16_t offset = vandq_u8( upper, vdupq_n_u8( uint8_t( -'A' ) ) );
+	offset = vorrq_u8( offset, vandq_u8( lower, vdupq_n_u8( uint8_t( 26 - 'a' ) ) ) );
+	offset = vorrq_u8( offset, vandq_u8( digit, vdupq_n_u8( uint8_t( 52 - '0' ) ) ) );
+	offset = vorrq_u8( offset, vandq_u8( plus, vdupq_n_u8( uint8_t( 62 - '+' ) ) ) );
+	offset = vorrq_u8( offset, vandq_u8( slash, vdupq_n_u8( uint8_t( 63 - '/' ) ) ) );
+	return vaddq_u8( c, offset );
 }
 
-ptrdiff_t base64_encode_block(const char* plaintext_in, size_t length_in, char* code_out, base64_encodestate* state_in, int charsPerLine )
+inline bool allSet( uint8x16_t mask )
 {
-	const char* plainchar = plaintext_in;
-	const char* const plaintextend = plaintext_in + length_in;
-	char* codechar = code_out;
-	char result;
-	char fragment;
-	
-	result = state_in->result;
-	
-	switch (state_in->step)
-	{
-		while (1)
-		{
-	case step_A:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_A;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result = (fragment & 0x0fc) >> 2;
-			*codechar++ = base64_encode_value(result);
-			result = (fragment & 0x003) << 4;
-	case step_B:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_B;
-				return codechar - code_out;
+	const uint8x8_t half = vand_u8( vget_low_u8( mask ), vget_high_u8( mask ) );
+	return vget_lane_u64( vreinterpret_u64_u8( half ), 0 ) == ~uint64_t( 0 );
+}
+#endif
+
+// Decodes \a in up to \a end, skipping characters outside the alphabet. \a bits and \a numSextets hold an incomplete group between calls.
+// May write up to two bytes past the returned end.
+uint8_t* decode( const uint8_t *in, const uint8_t *end, uint8_t *out, uint32_t &bits, int &numSextets )
+{
+	const uint8_t *table = sDecoding.mValues;
+	while( in < end ) {
+		// runs of whole groups without line breaks or padding take the fast paths
+		if( numSextets == 0 ) {
+#if defined( CINDER_SIMD_SSE2 )
+			for( ; end - in >= 16; in += 16, out += 12 ) {
+				__m128i s;
+				if( ! decodeChars( _mm_loadu_si128( (const __m128i*)in ), &s ) )
+					break;
+
+				// combine sextet pairs into 12 bits, then pairs of those into a 24-bit group per 32-bit lane
+				const __m128i pairs = _mm_or_si128( _mm_slli_epi16( _mm_and_si128( s, _mm_set1_epi16( 0xFF ) ), 6 ), _mm_srli_epi16( s, 8 ) );
+				const __m128i groups = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( pairs, _mm_set1_epi32( 0xFFFF ) ), 12 ), _mm_srli_epi32( pairs, 16 ) );
+				// most significant byte first, then close the gaps left by the fourth byte of each lane
+				const __m128i swapped = _mm_or_si128( _mm_or_si128( _mm_slli_epi32( _mm_and_si128( groups, _mm_set1_epi32( 0xFF ) ), 16 ), _mm_and_si128( groups, _mm_set1_epi32( 0xFF00 ) ) ),
+														_mm_and_si128( _mm_srli_epi32( groups, 16 ), _mm_set1_epi32( 0xFF ) ) );
+				const __m128i packed = _mm_or_si128( _mm_and_si128( swapped, _mm_set_epi32( 0, 0xFFFFFF, 0, 0xFFFFFF ) ),
+														_mm_and_si128( _mm_srli_epi64( swapped, 8 ), _mm_set_epi32( 0xFFFF, (int)0xFF000000, 0xFFFF, (int)0xFF000000 ) ) );
+				_mm_storel_epi64( (__m128i*)out, packed );
+				_mm_storel_epi64( (__m128i*)( out + 6 ), _mm_srli_si128( packed, 8 ) );
 			}
-			fragment = *plainchar++;
-			result |= (fragment & 0x0f0) >> 4;
-			*codechar++ = base64_encode_value(result);
-			result = (fragment & 0x00f) << 2;
-	case step_C:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_C;
-				return codechar - code_out;
+#elif defined( CINDER_SIMD_NEON )
+			for( ; end - in >= 64; in += 64, out += 48 ) {
+				const uint8x16x4_t chars = vld4q_u8( in );
+				uint8x16_t s[4], valid[4];
+				for( int i = 0; i < 4; ++i )
+					s[i] = decodeChars( chars.val[i], &valid[i] );
+				if( ! allSet( vandq_u8( vandq_u8( valid[0], valid[1] ), vandq_u8( valid[2], valid[3] ) ) ) )
+					break;
+
+				uint8x16x3_t bytes;
+				bytes.val[0] = vorrq_u8( vshlq_n_u8( s[0], 2 ), vshrq_n_u8( s[1], 4 ) );
+				bytes.val[1] = vorrq_u8( vshlq_n_u8( s[1], 4 ), vshrq_n_u8( s[2], 2 ) );
+				bytes.val[2] = vorrq_u8( vshlq_n_u8( s[2], 6 ), s[3] );
+				vst3q_u8( out, bytes );
 			}
-			fragment = *plainchar++;
-			result |= (fragment & 0x0c0) >> 6;
-			*codechar++ = base64_encode_value(result);
-			result  = (fragment & 0x03f) >> 0;
-			*codechar++ = base64_encode_value(result);
-			
-			++(state_in->stepcount);
-			if ( ( charsPerLine != 0 ) && ( state_in->stepcount == charsPerLine/4 ) )
-			{
-				*codechar++ = '\n';
-				state_in->stepcount = 0;
+#endif
+			for( ; end - in >= 4; in += 4, out += 3 ) {
+				const uint32_t a = table[in[0]], b = table[in[1]], c = table[in[2]], d = table[in[3]];
+				if( ( a | b | c | d ) & 0x80 )
+					break;
+				const uint32_t v = ( a << 18 ) | ( b << 12 ) | ( c << 6 ) | d;
+				out[0] = uint8_t( v >> 16 );
+				out[1] = uint8_t( v >> 8 );
+				out[2] = uint8_t( v );
 			}
+
+			if( in == end )
+				break;
+		}
+
+		// otherwise a character at a time, until a group is complete
+		const uint8_t value = table[*in++];
+		if( value & 0x80 )
+			continue;
+
+		bits = ( bits << 6 ) | value;
+		if( ++numSextets == 4 ) {
+			out[0] = uint8_t( bits >> 16 );
+			out[1] = uint8_t( bits >> 8 );
+			out[2] = uint8_t( bits );
+			out += 3;
+			bits = 0;
+			numSextets = 0;
 		}
 	}
-	/* control should not reach here */
-	return codechar - code_out;
+
+	return out;
 }
 
-ptrdiff_t base64_encode_blockend( char* code_out, base64_encodestate* state_in )
+// Writes the whole bytes of an incomplete last group
+uint8_t* decodeEnd( uint8_t *out, uint32_t bits, int numSextets )
 {
-	char* codechar = code_out;
-	
-	switch (state_in->step) {
-	case step_B:
-		*codechar++ = base64_encode_value(state_in->result);
-		*codechar++ = '=';
-		*codechar++ = '=';
-		break;
-	case step_C:
-		*codechar++ = base64_encode_value(state_in->result);
-		*codechar++ = '=';
-		break;
-	case step_A:
-		break;
+	if( numSextets == 2 )
+		*out++ = uint8_t( bits >> 4 );
+	else if( numSextets == 3 ) {
+		*out++ = uint8_t( bits >> 10 );
+		*out++ = uint8_t( bits >> 2 );
 	}
-	
-	return codechar - code_out;
+
+	return out;
 }
 
 } // anonymous namespace
@@ -237,19 +311,18 @@ std::string toBase64( const void *input, size_t inputSize, int charsPerLine )
 {
 	if( inputSize == 0 ) return std::string();
 
-	if( charsPerLine != 0 )
-		charsPerLine -= charsPerLine % 4;
-	size_t lines = ( charsPerLine == 0 ) ? 0 : ( inputSize * 4 / 3 / charsPerLine + 1 ); // account for inserted carriage returns
-	char *buffer = new char[inputSize * 4 / 3 + 4 + lines];
-
-	base64_encodestate encs;
-	base64_init_encodestate( &encs );
-	ptrdiff_t resultSize = base64_encode_block( reinterpret_cast<const char*>(input), inputSize, &buffer[0], &encs, charsPerLine );
-	resultSize += base64_encode_blockend( &buffer[resultSize], &encs );
-	buffer[resultSize] = 0; // null terminate the string
-	
-	std::string result( buffer );
-	delete [] buffer;
+	// charsPerLine is rounded down to a multiple of 4, and a line break follows every full line
+	const size_t groupsPerLine = ( charsPerLine > 0 ) ? charsPerLine / 4 : 0;
+	const size_t numGroups = inputSize / 3, remainder = inputSize % 3;
+	const size_t resultSize = ( numGroups + ( remainder ? 1 : 0 ) ) * 4 + ( groupsPerLine ? numGroups / groupsPerLine : 0 );
+
+	std::string result( resultSize, 0 );
+	const uint8_t *in = reinterpret_cast<const uint8_t*>( input );
+	size_t groupsOnLine = 0;
+	char *out = encodeLines( in, numGroups, &result[0], groupsPerLine, groupsOnLine );
+	if( remainder )
+		encodeEnd( in + numGroups * 3, remainder, out );
+
 	return result;
 }
 
@@ -265,16 +338,135 @@ Buffer fromBase64( const Buffer &input )
 
 Buffer fromBase64( const void *input, size_t inputSize )
 {
-	size_t outputSize = inputSize / 4 * 3;
-	Buffer result( outputSize );
-	if( inputSize >= 4 ) {
-		base64_decodestate decs;
-		base64_init_decodestate( &decs );
-		ptrdiff_t actualSize = base64_decode_block( reinterpret_cast<const char*>(input), inputSize, (char*)result.getData(), &decs );
-		result.setSize( actualSize );
-	}
+	// decoding writes up to two bytes past the end of the data; unpadded input shorter than a group still yields its whole bytes, as it does with Base64Decoder
+	Buffer result( inputSize / 4 * 3 + 4 );
+	const uint8_t *in = reinterpret_cast<const uint8_t*>( input );
+	uint8_t *out = reinterpret_cast<uint8_t*>( result.getData() );
+	uint32_t bits = 0;
+	int numSextets = 0;
+	uint8_t *end = decode( in, in + inputSize, out, bits, numSextets );
+	end = decodeEnd( end, bits, numSextets );
+	result.setSize( end - out );
 	return result;
 }
 
+void toBase64( const IStreamRef &input, const OStreamRef &output, int charsPerLine )
+{
+	Base64Encoder encoder( output, charsPerLine );
+	std::vector<uint8_t> chunk( sStreamChunkGroups * 3 );
+	while( ! input->isEof() ) {
+		const size_t size = input->readDataAvailable( chunk.data(), chunk.size() );
+		if( size == 0 )
+			break;
+		encoder.write( chunk.data(), size );
+	}
+	encoder.finish();
+}
+
+void fromBase64( const IStreamRef &input, const OStreamRef &output )
+{
+	Base64Decoder decoder( output );
+	std::vector<uint8_t> chunk( sStreamChunkChars );
+	while( ! input->isEof() ) {
+		const size_t size = input->readDataAvailable( chunk.data(), chunk.size() );
+		if( size == 0 )
+			break;
+		decoder.write( chunk.data(), size );
+	}
+	decoder.finish();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Base64Encoder
+
+Base64Encoder::Base64Encoder( const OStreamRef &output, int charsPerLine )
+	: mOutput( output ), mGroupsPerLine( ( charsPerLine > 0 ) ? charsPerLine / 4 : 0 ), mGroupsOnLine( 0 ), mNumCarry( 0 )
+{
+	// a chunk plus a carried group, with a line break after each at most
+	mBuffer.resize( ( sStreamChunkGroups + 1 ) * 5 );
+}
+
+void Base64Encoder::write( const void *data, size_t size )
+{
+	const uint8_t *in = reinterpret_cast<const uint8_t*>( data );
+	char *out = mBuffer.data();
+
+	// complete the group held back from the last call first
+	if( mNumCarry > 0 ) {
+		while( mNumCarry < 3 && size > 0 ) {
+			mCarry[mNumCarry++] = *in++;
+			--size;
+		}
+		if( mNumCarry < 3 )
+			return;
+
+		out = encodeLines( mCarry, 1, out, mGroupsPerLine, mGroupsOnLine );
+		mNumCarry = 0;
+	}
+
+	size_t numGroups = size / 3;
+	while( numGroups > 0 ) {
+		const size_t count = std::min( numGroups, sStreamChunkGroups );
+		out = encodeLines( in, count, out, mGroupsPerLine, mGroupsOnLine );
+		flushBuffer( out );
+		out = mBuffer.data();
+		in += count * 3;
+		numGroups -= count;
+	}
+	flushBuffer( out );
+
+	for( size_t i = 0; i < size % 3; ++i )
+		mCarry[mNumCarry++] = in[i];
+}
+
+void Base64Encoder::finish()
+{
+	char *out = mBuffer.data();
+	if( mNumCarry > 0 )
+		out = encodeEnd( mCarry, mNumCarry, out );
+	flushBuffer( out );
+
+	mNumCarry = 0;
+	mGroupsOnLine = 0;
+}
+
+void Base64Encoder::flushBuffer( char *end )
+{
+	if( end > mBuffer.data() )
+		mOutput->writeData( mBuffer.data(), end - mBuffer.data() );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Base64Decoder
+
+Base64Decoder::Base64Decoder( const OStreamRef &output )
+	: mOutput( output ), mBits( 0 ), mNumSextets( 0 )
+{
+	// a chunk's worth plus an incomplete group carried in, and the two bytes decoding may write past the end
+	mBuffer.resize( sStreamChunkChars / 4 * 3 + 8 );
+}
+
+void Base64Decoder::write( const void *encoded, size_t size )
+{
+	const uint8_t *in = reinterpret_cast<const uint8_t*>( encoded );
+	while( size > 0 ) {
+		const size_t count = std::min( size, sStreamChunkChars );
+		uint8_t *end = decode( in, in + count, mBuffer.data(), mBits, mNumSextets );
+		if( end > mBuffer.data() )
+			mOutput->writeData( mBuffer.data(), end - mBuffer.data() );
+		in += count;
+		size -= count;
+	}
+}
+
+void Base64Decoder::finish()
+{
+	uint8_t *end = decodeEnd( mBuffer.data(), mBits, mNumSextets );
+	if( end > mBuffer.data() )
+		mOutput->writeData( mBuffer.data(), end - mBuffer.data() );
+
+	mBits = 0;
+	mNumSextets = 0;
+}
 
 } // namespace cinder
@@ -0,0 +1,846 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/Bvh.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// Nodes deeper than this become leaves, which bounds the traversal stacks
+const int MAX_DEPTH = 64;
+// Minimum number of triangles in a node before its bounds and bins are computed in parallel, or its children are built on separate threads
+const uint32_t PARALLEL_BUILD_SIZE = 65536;
+// Minimum number of nodes per range when refitting in parallel
+const size_t PARALLEL_REFIT_SIZE = 16384;
+
+struct Bounds {
+	Bounds() : mMin( FLT_MAX ), mMax( -FLT_MAX ) {}
+
+	void include( const vec3 &point )		{ mMin = glm::min( mMin, point ); mMax = glm::max( mMax, point ); }
+	void include( const vec3 &min, const vec3 &max ) { mMin = glm::min( mMin, min ); mMax = glm::max( mMax, max ); }
+	void include( const Bounds &bounds )	{ include( bounds.mMin, bounds.mMax ); }
+
+	float calcHalfArea() const
+	{
+		vec3 size = glm::max( mMax - mMin, vec3( 0 ) );
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	vec3	mMin, mMax;
+};
+
+struct Bin {
+	Bin() : mCount( 0 ) {}
+
+	Bounds		mBounds;
+	uint32_t	mCount;
+};
+
+// Per-thread scratch space, reused by every node a thread builds
+struct BuildScratch {
+	vector<Bin>		mBins;
+	vector<float>	mRightCosts;
+};
+
+// Möller-Trumbore, matching Ray::calcTriangleIntersection() but also returning the barycentric coordinates
+inline bool intersectTriangle( const vec3 &origin, const vec3 &direction, const vec3 &v0, const vec3 &v1, const vec3 &v2, float *t, vec2 *barycentric )
+{
+	const vec3 edge1 = v1 - v0;
+	const vec3 edge2 = v2 - v0;
+	const vec3 pvec = cross( direction, edge2 );
+	const float det = dot( edge1, pvec );
+	if( det > -0.000001f && det < 0.000001f )
+		return false;
+
+	const float invDet = 1.0f / det;
+	const vec3 tvec = origin - v0;
+	const float u = dot( tvec, pvec ) * invDet;
+	if( u < 0.0f || u > 1.0f )
+		return false;
+
+	const vec3 qvec = cross( tvec, edge1 );
+	const float v = dot( direction, qvec ) * invDet;
+	if( v < 0.0f || u + v > 1.0f )
+		return false;
+
+	*t = dot( edge2, qvec ) * invDet;
+	*barycentric = vec2( u, v );
+	return true;
+}
+
+// Returns the distance along the ray at which it enters the box, or FLT_MAX if it misses the box within [0, maxT]
+inline float intersectBox( const vec3 &min, const vec3 &max, const vec3 &origin, const vec3 &invDirection, float maxT )
+{
+	const vec3 t0 = ( min - origin ) * invDirection;
+	const vec3 t1 = ( max - origin ) * invDirection;
+	const vec3 tMin = glm::min( t0, t1 );
+	const vec3 tMax = glm::max( t0, t1 );
+	const float enter = std::max( std::max( tMin.x, tMin.y ), std::max( tMin.z, 0.0f ) );
+	const float exit = std::min( std::min( tMax.x, tMax.y ), std::min( tMax.z, maxT ) );
+	return ( enter <= exit ) ? enter : FLT_MAX;
+}
+
+inline float calcDistance2( const vec3 &min, const vec3 &max, const vec3 &point )
+{
+	const vec3 d = glm::max( glm::max( min - point, point - max ), vec3( 0 ) );
+	return dot( d, d );
+}
+
+// Separating axis test of a triangle against a box, after Akenine-Möller, "Fast 3D Triangle-Box Overlap Testing"
+bool triangleOverlapsBox( const vec3 &center, const vec3 &extents, const vec3 &v0, const vec3 &v1, const vec3 &v2 )
+{
+	const vec3 a = v0 - center, b = v1 - center, c = v2 - center;
+
+	// box face normals
+	if( glm::any( glm::lessThan( glm::max( glm::max( a, b ), c ), -extents ) ) || glm::any( glm::greaterThan( glm::min( glm::min( a, b ), c ), extents ) ) )
+		return false;
+
+	// triangle normal
+	const vec3 normal = cross( b - a, c - b );
+	if( std::abs( dot( normal, a ) ) > dot( extents, glm::abs( normal ) ) )
+		return false;
+
+	// cross products of the box axes with the triangle edges
+	const vec3 edges[3] = { b - a, c - b, a - c };
+	for( const auto &edge : edges ) {
+		const vec3 axes[3] = { vec3( 0, -edge.z, edge.y ), vec3( edge.z, 0, -edge.x ), vec3( -edge.y, edge.x, 0 ) };
+		for( const auto &axis : axes ) {
+			const float p0 = dot( a, axis ), p1 = dot( b, axis ), p2 = dot( c, axis );
+			const float r = dot( extents, glm::abs( axis ) );
+			if( std::min( std::min( p0, p1 ), p2 ) > r || std::max( std::max( p0, p1 ), p2 ) < -r )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Ericson, "Real-Time Collision Detection", 5.1.5. Returns the closest point and its barycentric coordinates relative to \a b and \a c.
+vec3 closestPointOnTriangle( const vec3 &p, const vec3 &a, const vec3 &b, const vec3 &c, vec2 *barycentric )
+{
+	const vec3 ab = b - a, ac = c - a, ap = p - a;
+	// a degenerate triangle has no interior, so the closest point lies on its longest edge
+	const vec3 bc = c - b;
+	const float ab2 = length2( ab ), ac2 = length2( ac ), bc2 = length2( bc );
+	if( length2( cross( ab, ac ) ) <= FLT_MIN ) {
+		if( bc2 > std::max( ab2, ac2 ) ) {
+			const float w = glm::clamp( dot( p - b, bc ) / bc2, 0.0f, 1.0f );
+			*barycentric = vec2( 1 - w, w );
+			return b + w * bc;
+		}
+		else if( ab2 >= ac2 ) {
+			const float v = ( ab2 > 0 ) ? glm::clamp( dot( ab, ap ) / ab2, 0.0f, 1.0f ) : 0.0f;
+			*barycentric = vec2( v, 0 );
+			return a + v * ab;
+		}
+		else {
+			const float w = glm::clamp( dot( ac, ap ) / ac2, 0.0f, 1.0f );
+			*barycentric = vec2( 0, w );
+			return a + w * ac;
+		}
+	}
+
+	const float d1 = dot( ab, ap ), d2 = dot( ac, ap );
+	if( d1 <= 0 && d2 <= 0 ) {
+		*barycentric = vec2( 0, 0 );
+		return a;
+	}
+
+	const vec3 bp = p - b;
+	const float d3 = dot( ab, bp ), d4 = dot( ac, bp );
+	if( d3 >= 0 && d4 <= d3 ) {
+		*barycentric = vec2( 1, 0 );
+		return b;
+	}
+
+	const float vc = d1 * d4 - d3 * d2;
+	if( vc <= 0 && d1 >= 0 && d3 <= 0 ) {
+		const float v = d1 / ( d1 - d3 );
+		*barycentric = vec2( v, 0 );
+		return a + v * ab;
+	}
+
+	const vec3 cp = p - c;
+	const float d5 = dot( ab, cp ), d6 = dot( ac, cp );
+	if( d6 >= 0 && d5 <= d6 ) {
+		*barycentric = vec2( 0, 1 );
+		return c;
+	}
+
+	const float vb = d5 * d2 - d1 * d6;
+	if( vb <= 0 && d2 >= 0 && d6 <= 0 ) {
+		const float w = d2 / ( d2 - d6 );
+		*barycentric = vec2( 0, w );
+		return a + w * ac;
+	}
+
+	const float va = d3 * d6 - d5 * d4;
+	if( va <= 0 && ( d4 - d3 ) >= 0 && ( d5 - d6 ) >= 0 ) {
+		const float w = ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) );
+		*barycentric = vec2( 1 - w, w );
+		return b + w * bc;
+	}
+
+	const float denom = 1.0f / ( va + vb + vc );
+	const float v = vb * denom, w = vc * denom;
+	*barycentric = vec2( v, w );
+	return a + ab * v + ac * w;
+}
+
+} // anonymous namespace
+
+struct Bvh::BuildData {
+	BuildData( Bvh *bvh, size_t numTriangles )
+		: mBvh( bvh ), mTriangles( numTriangles ), mNumNodes( 1 )
+	{
+		mNumBins = glm::clamp( bvh->mOptions.getNumBins(), 2, 256 );
+		mMaxLeafSize = (uint32_t)std::max( 1, bvh->mOptions.getMaxLeafSize() );
+	}
+
+	// Triangles are partitioned in place, so each node's triangles stay contiguous in memory
+	struct Triangle {
+		Bounds		mBounds;
+		vec3		mCentroid;
+		uint32_t	mIndex;
+	};
+
+	//! Returns the bounds of the triangles in [\a begin, \a end) of mTriangles, and of their centroids.
+	void calcBounds( uint32_t begin, uint32_t end, Bounds *bounds, Bounds *centroidBounds ) const;
+	//! Builds the subtree at \a nodeIndex from the triangles in [\a begin, \a end) of mTriangles, which have \a bounds and \a centroidBounds.
+	void buildNode( uint32_t nodeIndex, uint32_t begin, uint32_t end, const Bounds &bounds, const Bounds &centroidBounds, int depth, int parallelDepth, BuildScratch &scratch );
+
+	Bvh						*mBvh;
+	int						mNumBins;
+	uint32_t				mMaxLeafSize;
+	vector<Triangle>		mTriangles;
+	std::atomic<uint32_t>	mNumNodes;
+};
+
+Bvh::Bvh()
+{
+}
+
+Bvh::Bvh( const TriMesh &mesh, const Options &options )
+	: mOptions( options )
+{
+	if( mesh.getAttribDims( geom::Attrib::POSITION ) != 3 )
+		throw BvhExc( "Bvh requires a TriMesh with 3D positions" );
+
+	build( mesh.getPositions<3>(), mesh.getNumVertices(), mesh.getIndices().data(), mesh.getNumIndices() );
+}
+
+Bvh::Bvh( const geom::Source &source, const Options &options )
+	: mOptions( options )
+{
+	TriMesh mesh( source, TriMesh::Format().positions() );
+	build( mesh.getPositions<3>(), mesh.getNumVertices(), mesh.getIndices().data(), mesh.getNumIndices() );
+}
+
+Bvh::Bvh( const vec3 *positions, size_t numPositions, const uint32_t *indices, size_t numIndices, const Options &options )
+	: mOptions( options )
+{
+	build( positions, numPositions, indices, numIndices );
+}
+
+void Bvh::build( const vec3 *positions, size_t numPositions, const uint32_t *indices, size_t numIndices )
+{
+	const size_t numTriangles = numIndices / 3;
+	if( numTriangles >= ( 1u << 31 ) )
+		throw BvhExc( "Too many triangles for Bvh" );
+	for( size_t i = 0; i < numTriangles * 3; ++i ) {
+		if( indices[i] >= numPositions )
+			throw BvhExc( "Bvh index out of range" );
+	}
+
+	mPositions.assign( positions, positions + numPositions );
+	mNodes.clear();
+	mIndices.clear();
+	mTriangleIds.clear();
+	if( numTriangles == 0 )
+		return;
+
+	BuildData data( this, numTriangles );
+	const size_t numThreads = mOptions.isParallel() ? 0 : 1;
+	parallelFor( 0, numTriangles, PARALLEL_BUILD_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t t = begin; t < end; ++t ) {
+			BuildData::Triangle &tri = data.mTriangles[t];
+			tri.mBounds.include( positions[indices[t * 3 + 0]] );
+			tri.mBounds.include( positions[indices[t * 3 + 1]] );
+			tri.mBounds.include( positions[indices[t * 3 + 2]] );
+			tri.mCentroid = ( tri.mBounds.mMin + tri.mBounds.mMax ) * 0.5f;
+			tri.mIndex = (uint32_t)t;
+		}
+	}, numThreads );
+
+	// a binary tree with at most one leaf per triangle
+	mNodes.resize( numTriangles * 2 - 1 );
+
+	int parallelDepth = 0;
+	if( mOptions.isParallel() ) {
+		while( ( size_t( 1 ) << parallelDepth ) < getNumParallelThreads() )
+			++parallelDepth;
+	}
+
+	Bounds bounds, centroidBounds;
+	data.calcBounds( 0, (uint32_t)numTriangles, &bounds, &centroidBounds );
+	BuildScratch scratch;
+	data.buildNode( 0, 0, (uint32_t)numTriangles, bounds, centroidBounds, 0, parallelDepth, scratch );
+
+	mNodes.resize( data.mNumNodes );
+	mNodes.shrink_to_fit();
+
+	// store the triangles in leaf order so that leaves reference contiguous ranges
+	mIndices.resize( numTriangles * 3 );
+	mTriangleIds.resize( numTriangles );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		mTriangleIds[t] = data.mTriangles[t].mIndex;
+		for( int v = 0; v < 3; ++v )
+			mIndices[t * 3 + v] = indices[mTriangleIds[t] * 3 + v];
+	}
+}
+
+void Bvh::BuildData::calcBounds( uint32_t begin, uint32_t end, Bounds *bounds, Bounds *centroidBounds ) const
+{
+	auto calcRange = [this]( size_t rangeBegin, size_t rangeEnd, Bounds *resultBounds, Bounds *resultCentroidBounds ) {
+		for( size_t i = rangeBegin; i < rangeEnd; ++i ) {
+			resultBounds->include( mTriangles[i].mBounds );
+			resultCentroidBounds->include( mTriangles[i].mCentroid );
+		}
+	};
+
+	if( mBvh->mOptions.isParallel() && end - begin >= PARALLEL_BUILD_SIZE ) {
+		vector<pair<Bounds, Bounds>> rangeBounds( getNumParallelThreads() );
+		std::atomic<size_t> numRanges( 0 );
+		parallelFor( begin, end, PARALLEL_BUILD_SIZE / 4, [&]( size_t rangeBegin, size_t rangeEnd ) {
+			auto &result = rangeBounds[numRanges++];
+			calcRange( rangeBegin, rangeEnd, &result.first, &result.second );
+		}, rangeBounds.size() );
+		for( const auto &result : rangeBounds ) {
+			bounds->include( result.first );
+			centroidBounds->include( result.second );
+		}
+	}
+	else {
+		calcRange( begin, end, bounds, centroidBounds );
+	}
+}
+
+void Bvh::BuildData::buildNode( uint32_t nodeIndex, uint32_t begin, uint32_t end, const Bounds &bounds, const Bounds &centroidBounds, int depth, int parallelDepth, BuildScratch &scratch )
+{
+	const uint32_t count = end - begin;
+	const bool parallel = mBvh->mOptions.isParallel() && count >= PARALLEL_BUILD_SIZE;
+	// small nodes gain nothing from more bins than triangles
+	const int numBins = (int)std::min<uint32_t>( mNumBins, std::max<uint32_t>( 4, count ) );
+
+	Node &node = mBvh->mNodes[nodeIndex];
+	node.mMin = bounds.mMin;
+	node.mMax = bounds.mMax;
+	node.mFirst = begin;
+	node.mCount = count;
+	if( count == 1 || depth >= MAX_DEPTH )
+		return;
+
+	// bin the triangles by centroid along each axis
+	const vec3 extent = centroidBounds.mMax - centroidBounds.mMin;
+	const vec3 binScale = glm::mix( vec3( 0 ), vec3( numBins * 0.99999f ) / extent, glm::greaterThan( extent, vec3( 0 ) ) );
+	auto calcBin = [&]( const vec3 &centroid, int axis ) {
+		return std::min( numBins - 1, (int)( ( centroid[axis] - centroidBounds.mMin[axis] ) * binScale[axis] ) );
+	};
+	auto fillBins = [&]( size_t rangeBegin, size_t rangeEnd, Bin *result ) {
+		for( size_t i = rangeBegin; i < rangeEnd; ++i ) {
+			const Triangle &tri = mTriangles[i];
+			for( int axis = 0; axis < 3; ++axis ) {
+				Bin &bin = result[axis * numBins + calcBin( tri.mCentroid, axis )];
+				bin.mBounds.include( tri.mBounds );
+				++bin.mCount;
+			}
+		}
+	};
+
+	vector<Bin> &bins = scratch.mBins;
+	bins.assign( numBins * 3, Bin() );
+	if( parallel ) {
+		vector<vector<Bin>> rangeBins( getNumParallelThreads(), vector<Bin>( numBins * 3 ) );
+		std::atomic<size_t> numRanges( 0 );
+		parallelFor( begin, end, PARALLEL_BUILD_SIZE / 4, [&]( size_t rangeBegin, size_t rangeEnd ) {
+			fillBins( rangeBegin, rangeEnd, rangeBins[numRanges++].data() );
+		}, rangeBins.size() );
+		for( const auto &result : rangeBins ) {
+			for( int b = 0; b < numBins * 3; ++b ) {
+				bins[b].mBounds.include( result[b].mBounds );
+				bins[b].mCount += result[b].mCount;
+			}
+		}
+	}
+	else {
+		fillBins( begin, end, bins.data() );
+	}
+
+	// find the split with the lowest surface area heuristic cost, relative to intersecting a single triangle, with traversing a node costing the same
+	float bestCost = FLT_MAX;
+	int bestAxis = -1, bestBin = 0;
+	vector<float> &rightCosts = scratch.mRightCosts;
+	rightCosts.resize( numBins );
+	for( int axis = 0; axis < 3; ++axis ) {
+		if( extent[axis] <= 0 )
+			continue;
+
+		const Bin *axisBins = &bins[axis * numBins];
+		Bounds right;
+		uint32_t rightCount = 0;
+		for( int b = numBins - 1; b > 0; --b ) {
+			right.include( axisBins[b].mBounds );
+			rightCount += axisBins[b].mCount;
+			rightCosts[b] = rightCount ? right.calcHalfArea() * rightCount : -1.0f;
+		}
+
+		Bounds left;
+		uint32_t leftCount = 0;
+		for( int b = 0; b < numBins - 1; ++b ) {
+			left.include( axisBins[b].mBounds );
+			leftCount += axisBins[b].mCount;
+			if( leftCount == 0 || rightCosts[b + 1] < 0 )
+				continue;
+			const float cost = left.calcHalfArea() * leftCount + rightCosts[b + 1];
+			if( cost < bestCost ) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b;
+			}
+		}
+	}
+
+	const float area = bounds.calcHalfArea();
+	bestCost = ( area > 0 ) ? 1 + bestCost / area : FLT_MAX;
+
+	uint32_t mid;
+	Bounds leftBounds, rightBounds, leftCentroidBounds, rightCentroidBounds;
+	if( bestAxis >= 0 && ( bestCost < count || count > mMaxLeafSize ) ) {
+		// the children's bounds follow from the bins, and the bounds of their centroids are gathered while partitioning
+		for( int b = 0; b < numBins; ++b )
+			( b <= bestBin ? leftBounds : rightBounds ).include( bins[bestAxis * numBins + b].mBounds );
+
+		uint32_t i = begin, j = end;
+		while( true ) {
+			while( i < j && calcBin( mTriangles[i].mCentroid, bestAxis ) <= bestBin )
+				leftCentroidBounds.include( mTriangles[i++].mCentroid );
+			while( i < j && calcBin( mTriangles[j - 1].mCentroid, bestAxis ) > bestBin )
+				rightCentroidBounds.include( mTriangles[--j].mCentroid );
+			if( i >= j )
+				break;
+			std::swap( mTriangles[i], mTriangles[j - 1] );
+		}
+		mid = i;
+	}
+	else if( count > mMaxLeafSize && bestAxis < 0 ) {
+		// all centroids coincide, so split evenly to keep leaves small
+		mid = begin + count / 2;
+		calcBounds( begin, mid, &leftBounds, &leftCentroidBounds );
+		calcBounds( mid, end, &rightBounds, &rightCentroidBounds );
+	}
+	else {
+		return;
+	}
+
+	const uint32_t children = mNumNodes.fetch_add( 2 );
+	node.mFirst = children;
+	node.mCount = 0;
+
+	if( parallel && parallelDepth > 0 ) {
+		exception_ptr exc;
+		thread leftThread( [&] {
+			try {
+				BuildScratch threadScratch;
+				buildNode( children, begin, mid, leftBounds, leftCentroidBounds, depth + 1, parallelDepth - 1, threadScratch );
+			}
+			catch( ... ) {
+				exc = current_exception();
+			}
+		} );
+		buildNode( children + 1, mid, end, rightBounds, rightCentroidBounds, depth + 1, parallelDepth - 1, scratch );
+		leftThread.join();
+		if( exc )
+			rethrow_exception( exc );
+	}
+	else {
+		buildNode( children, begin, mid, leftBounds, leftCentroidBounds, depth + 1, parallelDepth, scratch );
+		buildNode( children + 1, mid, end, rightBounds, rightCentroidBounds, depth + 1, parallelDepth, scratch );
+	}
+}
+
+void Bvh::refit( const vec3 *positions, size_t numPositions )
+{
+	if( numPositions != mPositions.size() )
+		throw BvhExc( "Bvh::refit() requires the same number of positions as the mesh it was built from" );
+
+	mPositions.assign( positions, positions + numPositions );
+
+	// leaves first, in parallel
+	parallelFor( 0, mNodes.size(), PARALLEL_REFIT_SIZE, [this]( size_t begin, size_t end ) {
+		for( size_t n = begin; n < end; ++n ) {
+			Node &node = mNodes[n];
+			if( ! node.isLeaf() )
+				continue;
+			Bounds bounds;
+			for( uint32_t i = node.mFirst * 3; i < ( node.mFirst + node.mCount ) * 3; ++i )
+				bounds.include( mPositions[mIndices[i]] );
+			node.mMin = bounds.mMin;
+			node.mMax = bounds.mMax;
+		}
+	}, mOptions.isParallel() ? 0 : 1 );
+
+	// children are always stored after their parent, so a reverse pass visits them first
+	for( size_t n = mNodes.size(); n-- > 0; ) {
+		Node &node = mNodes[n];
+		if( node.isLeaf() )
+			continue;
+		const Node &left = mNodes[node.mFirst], &right = mNodes[node.mFirst + 1];
+		node.mMin = glm::min( left.mMin, right.mMin );
+		node.mMax = glm::max( left.mMax, right.mMax );
+	}
+}
+
+void Bvh::refit( const TriMesh &mesh )
+{
+	if( mesh.getAttribDims( geom::Attrib::POSITION ) != 3 )
+		throw BvhExc( "Bvh requires a TriMesh with 3D positions" );
+
+	refit( mesh.getPositions<3>(), mesh.getNumVertices() );
+}
+
+bool Bvh::intersect( const Ray &ray, Hit *result, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	const vec3 &origin = ray.getOrigin();
+	const vec3 &direction = ray.getDirection();
+	const vec3 &invDirection = ray.getInverseDirection();
+
+	float closest = maxDistance;
+	uint32_t closestTriangle = UINT32_MAX;
+	vec2 closestBarycentric;
+
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	if( intersectBox( mNodes[0].mMin, mNodes[0].mMax, origin, invDirection, closest ) != FLT_MAX )
+		stack[stackSize++] = 0;
+
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		if( node.isLeaf() ) {
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				float dist;
+				vec2 barycentric;
+				const uint32_t *tri = &mIndices[t * 3];
+				if( intersectTriangle( origin, direction, mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]], &dist, &barycentric ) && dist >= 0 && dist <= closest ) {
+					closest = dist;
+					closestTriangle = t;
+					closestBarycentric = barycentric;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first by pushing it last
+		const Node &left = mNodes[node.mFirst], &right = mNodes[node.mFirst + 1];
+		const float leftDist = intersectBox( left.mMin, left.mMax, origin, invDirection, closest );
+		const float rightDist = intersectBox( right.mMin, right.mMax, origin, invDirection, closest );
+		if( leftDist <= rightDist ) {
+			if( rightDist != FLT_MAX ) stack[stackSize++] = node.mFirst + 1;
+			if( leftDist != FLT_MAX ) stack[stackSize++] = node.mFirst;
+		}
+		else {
+			if( leftDist != FLT_MAX ) stack[stackSize++] = node.mFirst;
+			stack[stackSize++] = node.mFirst + 1;
+		}
+	}
+
+	if( closestTriangle == UINT32_MAX )
+		return false;
+
+	if( result ) {
+		result->triangle = mTriangleIds[closestTriangle];
+		result->distance = closest;
+		result->position = ray.calcPosition( closest );
+		result->barycentric = closestBarycentric;
+	}
+
+	return true;
+}
+
+bool Bvh::intersectAny( const Ray &ray, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	const vec3 &origin = ray.getOrigin();
+	const vec3 &direction = ray.getDirection();
+	const vec3 &invDirection = ray.getInverseDirection();
+
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		if( intersectBox( node.mMin, node.mMax, origin, invDirection, maxDistance ) == FLT_MAX )
+			continue;
+
+		if( node.isLeaf() ) {
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				float dist;
+				vec2 barycentric;
+				const uint32_t *tri = &mIndices[t * 3];
+				if( intersectTriangle( origin, direction, mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]], &dist, &barycentric ) && dist >= 0 && dist <= maxDistance )
+					return true;
+			}
+		}
+		else {
+			stack[stackSize++] = node.mFirst + 1;
+			stack[stackSize++] = node.mFirst;
+		}
+	}
+
+	return false;
+}
+
+size_t Bvh::intersectAll( const Ray &ray, std::vector<Hit> *result, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return 0;
+
+	const vec3 &origin = ray.getOrigin();
+	const vec3 &direction = ray.getDirection();
+	const vec3 &invDirection = ray.getInverseDirection();
+	const size_t first = result->size();
+
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		if( intersectBox( node.mMin, node.mMax, origin, invDirection, maxDistance ) == FLT_MAX )
+			continue;
+
+		if( node.isLeaf() ) {
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				Hit hit;
+				const uint32_t *tri = &mIndices[t * 3];
+				if( intersectTriangle( origin, direction, mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]], &hit.distance, &hit.barycentric ) && hit.distance >= 0 && hit.distance <= maxDistance ) {
+					hit.triangle = mTriangleIds[t];
+					hit.position = ray.calcPosition( hit.distance );
+					result->push_back( hit );
+				}
+			}
+		}
+		else {
+			stack[stackSize++] = node.mFirst + 1;
+			stack[stackSize++] = node.mFirst;
+		}
+	}
+
+	std::sort( result->begin() + first, result->end(), []( const Hit &a, const Hit &b ) {
+		return ( a.distance < b.distance ) || ( a.distance == b.distance && a.triangle < b.triangle );
+	} );
+
+	return result->size() - first;
+}
+
+void Bvh::appendSubtree( uint32_t nodeIndex, std::vector<uint32_t> *result ) const
+{
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = nodeIndex;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		if( node.isLeaf() ) {
+			result->insert( result->end(), mTriangleIds.begin() + node.mFirst, mTriangleIds.begin() + node.mFirst + node.mCount );
+		}
+		else {
+			stack[stackSize++] = node.mFirst + 1;
+			stack[stackSize++] = node.mFirst;
+		}
+	}
+}
+
+size_t Bvh::query( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const
+{
+	if( mNodes.empty() )
+		return 0;
+
+	const vec3 boxMin = box.getMin(), boxMax = box.getMax();
+	const size_t first = result->size();
+
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = mNodes[nodeIndex];
+		if( glm::any( glm::lessThan( node.mMax, boxMin ) ) || glm::any( glm::greaterThan( node.mMin, boxMax ) ) )
+			continue;
+
+		// every triangle of a node inside the box overlaps it
+		if( glm::all( glm::greaterThanEqual( node.mMin, boxMin ) ) && glm::all( glm::lessThanEqual( node.mMax, boxMax ) ) ) {
+			appendSubtree( nodeIndex, result );
+		}
+		else if( node.isLeaf() ) {
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				const uint32_t *tri = &mIndices[t * 3];
+				if( triangleOverlapsBox( box.getCenter(), box.getExtents(), mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]] ) )
+					result->push_back( mTriangleIds[t] );
+			}
+		}
+		else {
+			stack[stackSize++] = node.mFirst + 1;
+			stack[stackSize++] = node.mFirst;
+		}
+	}
+
+	return result->size() - first;
+}
+
+size_t Bvh::query( const Frustum &frustum, std::vector<uint32_t> *result ) const
+{
+	if( mNodes.empty() )
+		return 0;
+
+	const size_t first = result->size();
+
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = mNodes[nodeIndex];
+		const AxisAlignedBox nodeBox( node.mMin, node.mMax );
+		if( ! frustum.intersects( nodeBox ) )
+			continue;
+
+		if( frustum.contains( nodeBox ) ) {
+			appendSubtree( nodeIndex, result );
+		}
+		else if( node.isLeaf() ) {
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				const uint32_t *tri = &mIndices[t * 3];
+				bool outside = false;
+				for( int p = 0; p < 6 && ! outside; ++p ) {
+					const auto &plane = frustum.getPlane( (Frustum::FrustumSection)p );
+					outside = plane.distance( mPositions[tri[0]] ) < 0 && plane.distance( mPositions[tri[1]] ) < 0 && plane.distance( mPositions[tri[2]] ) < 0;
+				}
+				if( ! outside )
+					result->push_back( mTriangleIds[t] );
+			}
+		}
+		else {
+			stack[stackSize++] = node.mFirst + 1;
+			stack[stackSize++] = node.mFirst;
+		}
+	}
+
+	return result->size() - first;
+}
+
+bool Bvh::calcClosestPoint( const vec3 &point, Hit *result, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	float closest2 = ( maxDistance < sqrt( FLT_MAX ) ) ? maxDistance * maxDistance : FLT_MAX;
+	uint32_t closestTriangle = UINT32_MAX;
+	vec3 closestPosition;
+	vec2 closestBarycentric;
+
+	uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		if( calcDistance2( node.mMin, node.mMax, point ) > closest2 )
+			continue;
+
+		if( node.isLeaf() ) {
+			for( uint32_t t = node.mFirst; t < node.mFirst + node.mCount; ++t ) {
+				const uint32_t *tri = &mIndices[t * 3];
+				vec2 barycentric;
+				const vec3 position = closestPointOnTriangle( point, mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]], &barycentric );
+				const float dist2 = distance2( point, position );
+				if( dist2 <= closest2 ) {
+					closest2 = dist2;
+					closestTriangle = t;
+					closestPosition = position;
+					closestBarycentric = barycentric;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first by pushing it last
+		const Node &left = mNodes[node.mFirst], &right = mNodes[node.mFirst + 1];
+		const float leftDist2 = calcDistance2( left.mMin, left.mMax, point );
+		const float rightDist2 = calcDistance2( right.mMin, right.mMax, point );
+		if( leftDist2 <= rightDist2 ) {
+			if( rightDist2 <= closest2 ) stack[stackSize++] = node.mFirst + 1;
+			if( leftDist2 <= closest2 ) stack[stackSize++] = node.mFirst;
+		}
+		else {
+			if( leftDist2 <= closest2 ) stack[stackSize++] = node.mFirst;
+			stack[stackSize++] = node.mFirst + 1;
+		}
+	}
+
+	if( closestTriangle == UINT32_MAX )
+		return false;
+
+	if( result ) {
+		result->triangle = mTriangleIds[closestTriangle];
+		result->distance = sqrt( closest2 );
+		result->position = closestPosition;
+		result->barycentric = closestBarycentric;
+	}
+
+	return true;
+}
+
+AxisAlignedBox Bvh::getBounds() const
+{
+	if( mNodes.empty() )
+		return AxisAlignedBox();
+
+	return AxisAlignedBox( mNodes[0].mMin, mNodes[0].mMax );
+}
+
+size_t Bvh::getMemoryUsage() const
+{
+	return mNodes.capacity() * sizeof( Node ) + mPositions.capacity() * sizeof( vec3 )
+		+ mIndices.capacity() * sizeof( uint32_t ) + mTriangleIds.capacity() * sizeof( uint32_t );
+}
+
+} // namespace cinder
@@ -27,6 +27,19 @@
 #include "cinder/Log.h"
 #include "cinder/Utilities.h"
 
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined( CINDER_LINUX )
+	#include <sys/inotify.h>
+	#include <sys/eventfd.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
 //#define LOG_UPDATE( stream )	CI_LOG_I( stream )
 #define LOG_UPDATE( stream )	( (void)( 0 ) )
 
@@ -38,12 +51,16 @@ namespace cinder {
 //! Base class for Watch types, which are returned from FileWatcher::load() and watch()
 class Watch : public std::enable_shared_from_this<Watch>, private Noncopyable {
   public:
-	Watch( const std::vector<fs::path> &filePaths, bool needsCallback );
+	Watch( const std::vector<fs::path> &filePaths, bool needsCallback, bool isDirectory = false );
 
 	signals::Connection	connect( const function<void ( const WatchEvent& )> &callback )	{ return mSignalChanged.connect( callback ); }
 
 	//! Checks if the asset file is up-to-date. Also may discard the Watch if there are no more connected slots.
 	void checkCurrent();
+	//! Checks only the files in \a changedPaths, which were reported as changed by the native backend. Paths are canonical.
+	void checkChanged( const std::unordered_set<std::string> &changedPaths );
+	//! Discards the Watch if there are no more connected slots. Returns whether the Watch is discarded.
+	bool checkDiscarded();
 	//! Remove any watches for \a filePath. If it is the last file associated with this Watch, discard
 	void unwatch( const fs::path &filePath );
 	//! Emit the signal callback. 
@@ -59,28 +76,41 @@ class Watch : public std::enable_shared_from_this<Watch>, private Noncopyable {
 	void markDiscarded()			{ mDiscarded = true; }
 	//! Returns whether the Watch is discarded and should be destroyed.
 	bool isDiscarded() const		{ return mDiscarded; }
+	//! Marks the Watch as needing to be polled even though the native backend is in use, because its files could not all be watched.
+	void setPolled( bool b )		{ mPolled = b; }
+	//! Returns whether the Watch needs to be polled even though the native backend is in use.
+	bool isPolled() const			{ return mPolled; }
 
 	class WatchItem {
 	  public:
-		WatchItem( const fs::path& path, const fs::file_time_type& timeStamp, bool enabled )
-			: mFilePath( path ), mTimeStamp( timeStamp ), mEnabled( enabled ), mErrors( 0 )
+		WatchItem( const fs::path& path, const fs::file_time_type& timeStamp, bool enabled, bool isDirectory )
+			: mFilePath( path ), mTimeStamp( timeStamp ), mEnabled( enabled ), mIsDirectory( isDirectory ), mErrors( 0 )
 		{}
 		
 		fs::path			mFilePath;
+		std::string			mCanonicalPath; // matched against paths reported by the native backend
 		fs::file_time_type	mTimeStamp;
 		bool				mEnabled;
+		bool				mIsDirectory;	// watches all files beneath mFilePath
 		int8_t				mErrors;
 	};
 
 	const std::vector<WatchItem>&	getItems() const	{ return mWatchItems; }
 
   private:
+	void checkDirectory( const WatchItem &item );
+	void addModified( const fs::path &filePath );
+
 	bool mDiscarded = false;
 	bool mEnabled = true;
 	bool mNeedsCallback = false;
+	bool mPolled = false;
 
 	std::vector<WatchItem>				mWatchItems;
 	std::vector<fs::path>				mModifiedFilePaths;
+	// modification times of the files beneath directory items, used when polling
+	std::map<fs::path, fs::file_time_type>	mDirectoryFileTimes;
+	bool									mDirectoryScanned = false;
 
 	signals::Signal<void ( const WatchEvent& )>	mSignalChanged;
 };
@@ -102,6 +132,29 @@ fs::path findFullFilePath( const fs::path &filePath )
 	return resolvedAssetPath;
 }
 
+// Resolves symlinks and relative components in \a path, so that it matches the paths the native backend reports. A file
+// that is a symlink resolves to its target, whose directory is the one that receives notifications. The file itself need
+// not exist.
+string canonicalPath( const fs::path &path, bool isDirectory )
+{
+	try {
+		if( isDirectory || fs::is_symlink( path ) )
+			return fs::canonical( path ).string();
+		else
+			return ( fs::canonical( path.parent_path() ) / path.filename() ).string();
+	}
+	catch( fs::filesystem_error & ) {
+		return path.string();
+	}
+}
+
+// Returns whether \a path is \a root or lies beneath it.
+bool isWithin( const string &path, const string &root )
+{
+	return path.size() >= root.size() && path.compare( 0, root.size(), root ) == 0
+		&& ( path.size() == root.size() || path[root.size()] == fs::path::preferred_separator );
+}
+
 // Used from the debugger.
 void debugPrintWatches( const std::list<std::unique_ptr<Watch>>&watchList )
 {
@@ -139,12 +192,25 @@ double getElapsedSeconds()
 // Watch
 // ----------------------------------------------------------------------------------------------------
 
-Watch::Watch( const vector<fs::path> &filePaths, bool needsCallback )
+Watch::Watch( const vector<fs::path> &filePaths, bool needsCallback, bool isDirectory )
 {
 	mWatchItems.reserve( filePaths.size() );
 	for( const auto &fp : filePaths ) {
 		auto fullPath = findFullFilePath( fp );
-		mWatchItems.push_back( { fullPath, fs::last_write_time( fullPath ), true } );
+		if( isDirectory && ! fs::is_directory( fullPath ) )
+			throw FileWatcherException( "not a directory: " + fullPath.string() );
+		mWatchItems.push_back( { fullPath, fs::last_write_time( fullPath ), true, isDirectory } );
+		mWatchItems.back().mCanonicalPath = canonicalPath( fullPath, isDirectory );
+	}
+
+	// list directories now rather than on the first poll, so that files created as soon as watch() returns are reported as new
+	for( const auto &item : mWatchItems ) {
+		try {
+			if( item.mIsDirectory )
+				checkDirectory( item );
+		}
+		catch( fs::filesystem_error & ) {
+		}
 	}
 
 	if( needsCallback ) {
@@ -168,7 +234,11 @@ void Watch::checkCurrent()
 	mModifiedFilePaths.clear();
 	for( auto &item : mWatchItems ) {
 		try {
-			if( item.mEnabled && fs::exists( item.mFilePath ) ) {
+			if( item.mIsDirectory ) {
+				if( item.mEnabled )
+					checkDirectory( item );
+			}
+			else if( item.mEnabled && fs::exists( item.mFilePath ) ) {
 				auto timeLastWrite = fs::last_write_time( item.mFilePath );
 				if( item.mTimeStamp < timeLastWrite ) {
 					item.mTimeStamp = timeLastWrite;
@@ -190,6 +260,81 @@ void Watch::checkCurrent()
 	}
 }
 
+void Watch::checkDirectory( const WatchItem &item )
+{
+	const bool reportNewFiles = mDirectoryScanned;
+	// symlinked directories are followed once each, unless they lead back into the watched tree
+	unordered_set<string> symlinkTargets;
+	for( auto it = fs::recursive_directory_iterator( item.mFilePath, fs::directory_options::follow_directory_symlink ); it != fs::recursive_directory_iterator(); ++it ) {
+		if( fs::is_symlink( it->path() ) && fs::is_directory( it->path() ) ) {
+			const string target = fs::canonical( it->path() ).string();
+			if( isWithin( target, item.mCanonicalPath ) || ! symlinkTargets.insert( target ).second )
+				it.disable_recursion_pending();
+			continue;
+		}
+		if( ! fs::is_regular_file( it->path() ) )
+			continue;
+
+		auto timeLastWrite = fs::last_write_time( it->path() );
+		auto result = mDirectoryFileTimes.insert( make_pair( it->path(), timeLastWrite ) );
+		if( result.second ) {
+			if( reportNewFiles )
+				addModified( it->path() );
+		}
+		else if( result.first->second < timeLastWrite ) {
+			result.first->second = timeLastWrite;
+			addModified( it->path() );
+		}
+	}
+
+	mDirectoryScanned = true;
+}
+
+void Watch::checkChanged( const unordered_set<string> &changedPaths )
+{
+	for( auto &item : mWatchItems ) {
+		if( ! item.mEnabled )
+			continue;
+
+		try {
+			if( item.mIsDirectory ) {
+				const string &root = item.mCanonicalPath;
+				for( const auto &changed : changedPaths ) {
+					if( changed.size() > root.size() && changed.compare( 0, root.size(), root ) == 0 && changed[root.size()] == fs::path::preferred_separator
+							&& fs::is_regular_file( changed ) )
+						addModified( item.mFilePath / changed.substr( root.size() + 1 ) );
+				}
+			}
+			else if( changedPaths.count( item.mCanonicalPath ) && fs::exists( item.mFilePath ) ) {
+				// compare timestamps as polling does, so that notifications which don't change the file's contents are ignored
+				auto timeLastWrite = fs::last_write_time( item.mFilePath );
+				if( item.mTimeStamp < timeLastWrite ) {
+					item.mTimeStamp = timeLastWrite;
+					addModified( item.mFilePath );
+				}
+			}
+		}
+		catch( fs::filesystem_error & ) {
+		}
+	}
+}
+
+bool Watch::checkDiscarded()
+{
+	if( mSignalChanged.getNumSlots() == 0 )
+		markDiscarded();
+
+	return isDiscarded();
+}
+
+void Watch::addModified( const fs::path &filePath )
+{
+	if( find( mModifiedFilePaths.begin(), mModifiedFilePaths.end(), filePath ) == mModifiedFilePaths.end() )
+		mModifiedFilePaths.push_back( filePath );
+
+	setNeedsCallback( true );
+}
+
 void Watch::unwatch( const fs::path &filePath ) 
 {
 	mWatchItems.erase( remove_if( mWatchItems.begin(), mWatchItems.end(),
@@ -211,6 +356,10 @@ void Watch::setEnabled( bool enable, const fs::path &filePath )
 			// update the timestamp so that any modifications while
 			// the watch was disabled don't trigger a callback
 			item.mTimeStamp = fs::last_write_time( item.mFilePath );
+			if( item.mIsDirectory ) {
+				mDirectoryFileTimes.clear();
+				mDirectoryScanned = false;
+			}
 		}
 	}
 }
@@ -219,10 +368,257 @@ void Watch::emitCallback()
 {
 	WatchEvent event( mModifiedFilePaths );
 
-	mSignalChanged.emit( event );
+	mModifiedFilePaths.clear();
 	setNeedsCallback( false );
+
+	mSignalChanged.emit( event );
 } 
 
+// ----------------------------------------------------------------------------------------------------
+// FileWatcherNative
+// ----------------------------------------------------------------------------------------------------
+
+#if defined( CINDER_LINUX )
+
+//! Receives change notifications through inotify. Files are watched through their parent directory, so that editors which save
+//! by replacing the file are still observed, and directory watches add every subdirectory as it appears, following symlinks.
+//! Watched directories that are removed or moved away are watched again once their path reappears. Except for
+//! waitForEvents(), all methods are called with FileWatcher's mutex held.
+class FileWatcherNative : private Noncopyable {
+  public:
+	FileWatcherNative()
+	{
+		mFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+		if( mFd < 0 )
+			throw FileWatcherException( string( "inotify_init1 failed: " ) + strerror( errno ) );
+
+		mWakeFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+		if( mWakeFd < 0 ) {
+			close( mFd );
+			throw FileWatcherException( string( "eventfd failed: " ) + strerror( errno ) );
+		}
+	}
+
+	~FileWatcherNative()
+	{
+		close( mFd );
+		close( mWakeFd );
+	}
+
+	//! Starts watching the directories needed by the items of \a watch. Returns false if a directory could not be watched.
+	bool addWatch( const Watch &watch )
+	{
+		bool result = true;
+		for( const auto &item : watch.getItems() ) {
+			if( item.mIsDirectory )
+				result = addDirectory( item.mCanonicalPath, true, nullptr ) && result;
+			else
+				result = addDirectory( fs::path( item.mCanonicalPath ).parent_path().string(), false, nullptr ) && result;
+		}
+
+		return result;
+	}
+
+	//! Stops watching directories which are no longer needed by any Watch in \a watchList.
+	void prune( const std::list<std::unique_ptr<Watch>> &watchList )
+	{
+		unordered_set<string> fileDirs;
+		vector<string> recursiveRoots;
+		for( const auto &watch : watchList ) {
+			for( const auto &item : watch->getItems() ) {
+				if( item.mIsDirectory )
+					recursiveRoots.push_back( item.mCanonicalPath );
+				else
+					fileDirs.insert( fs::path( item.mCanonicalPath ).parent_path().string() );
+			}
+		}
+
+		auto isNeeded = [&]( const string &path ) {
+			bool needed = fileDirs.count( path ) > 0;
+			for( size_t r = 0; r < recursiveRoots.size() && ! needed; ++r )
+				needed = isWithin( path, recursiveRoots[r] );
+			return needed;
+		};
+
+		for( auto it = mDirectories.begin(); it != mDirectories.end(); ) {
+			if( isNeeded( it->first ) ) {
+				++it;
+				continue;
+			}
+
+			inotify_rm_watch( mFd, it->second.mDescriptor );
+			mPaths.erase( it->second.mDescriptor );
+			it = mDirectories.erase( it );
+		}
+
+		for( auto it = mLostDirectories.begin(); it != mLostDirectories.end(); ) {
+			if( isNeeded( it->first ) )
+				++it;
+			else
+				it = mLostDirectories.erase( it );
+		}
+	}
+
+	//! Blocks until notifications are available, wake() is called or \a timeoutSeconds elapses.
+	void waitForEvents( double timeoutSeconds )
+	{
+		pollfd fds[2] = { { mFd, POLLIN, 0 }, { mWakeFd, POLLIN, 0 } };
+		poll( fds, 2, std::max<int>( 0, (int)( timeoutSeconds * 1000 + 0.5 ) ) );
+
+		uint64_t count;
+		while( read( mWakeFd, &count, sizeof( count ) ) > 0 )
+			;
+	}
+
+	//! Interrupts waitForEvents() from another thread.
+	void wake()
+	{
+		uint64_t count = 1;
+		ssize_t written = write( mWakeFd, &count, sizeof( count ) );
+		(void)written;
+	}
+
+	//! Reads all pending notifications without blocking, appending the canonical path of each changed file to \a changedPaths.
+	//! Directories created beneath a recursive watch are watched immediately, and the files they already contain are reported,
+	//! as are the files in lost directories whose path has reappeared.
+	void readEvents( vector<string> *changedPaths )
+	{
+		alignas( inotify_event ) char buffer[16 * 1024];
+		while( true ) {
+			ssize_t length = read( mFd, buffer, sizeof( buffer ) );
+			if( length <= 0 )
+				break;
+
+			for( char *ptr = buffer; ptr < buffer + length; ) {
+				const inotify_event *event = reinterpret_cast<const inotify_event *>( ptr );
+				ptr += sizeof( inotify_event ) + event->len;
+
+				if( event->mask & IN_Q_OVERFLOW ) {
+					CI_LOG_W( "inotify queue overflowed, some changes may not be reported" );
+					continue;
+				}
+
+				auto pathIt = mPaths.find( event->wd );
+				if( pathIt == mPaths.end() )
+					continue;
+
+				// The directory was removed or unmounted, or moved away so that its watch no longer follows its path.
+				// The watch is re-added once something appears at the path again.
+				if( event->mask & ( IN_IGNORED | IN_MOVE_SELF ) ) {
+					if( event->mask & IN_MOVE_SELF )
+						inotify_rm_watch( mFd, event->wd );
+					auto dirIt = mDirectories.find( pathIt->second );
+					if( dirIt != mDirectories.end() ) {
+						mLostDirectories[dirIt->first] = dirIt->second.mRecursive;
+						mDirectories.erase( dirIt );
+					}
+					mPaths.erase( pathIt );
+					continue;
+				}
+
+				if( event->len == 0 )
+					continue;
+
+				string path = pathIt->second + '/' + event->name;
+				if( event->mask & IN_ISDIR ) {
+					auto dirIt = mDirectories.find( pathIt->second );
+					if( dirIt != mDirectories.end() && dirIt->second.mRecursive && ( event->mask & ( IN_CREATE | IN_MOVED_TO ) ) )
+						addDirectory( path, true, changedPaths );
+				}
+				else
+					changedPaths->push_back( path );
+			}
+		}
+
+		rearm( changedPaths );
+	}
+
+  private:
+	struct Directory {
+		int		mDescriptor;
+		bool	mRecursive;
+	};
+
+	// Watches again the lost directories that exist again, appending the files they contain to \a changedPaths. Lost directories
+	// beneath a recursive watch are left to it, as it adds them when they are created.
+	void rearm( vector<string> *changedPaths )
+	{
+		for( auto it = mLostDirectories.begin(); it != mLostDirectories.end(); ) {
+			bool covered = false;
+			for( fs::path parent = fs::path( it->first ).parent_path(); ! covered && parent.has_relative_path(); parent = parent.parent_path() ) {
+				auto dirIt = mDirectories.find( parent.string() );
+				covered = dirIt != mDirectories.end() && dirIt->second.mRecursive;
+			}
+
+			error_code ec;
+			if( covered || ( fs::is_directory( it->first, ec ) && addDirectory( it->first, it->second, changedPaths ) ) )
+				it = mLostDirectories.erase( it );
+			else
+				++it;
+		}
+	}
+
+	// Watches \a path, and if \a recursive all of its subdirectories. If \a existingFiles is non-null, the files found in the
+	// directories added are appended to it. A directory reached again through a symlink is only watched once.
+	bool addDirectory( const string &path, bool recursive, vector<string> *existingFiles )
+	{
+		auto it = mDirectories.find( path );
+		if( it != mDirectories.end() && ( it->second.mRecursive || ! recursive ) )
+			return true;
+
+		if( it == mDirectories.end() ) {
+			const uint32_t mask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_MOVE_SELF | IN_ONLYDIR;
+			int wd = inotify_add_watch( mFd, path.c_str(), mask );
+			if( wd < 0 ) {
+				CI_LOG_W( "could not watch directory '" << path << "': " << strerror( errno ) );
+				return false;
+			}
+			if( mPaths.count( wd ) )
+				return true;
+			it = mDirectories.insert( make_pair( path, Directory{ wd, recursive } ) ).first;
+			mPaths[wd] = path;
+		}
+		it->second.mRecursive = recursive;
+
+		bool result = true;
+		if( recursive || existingFiles ) {
+			try {
+				for( fs::directory_iterator dirIt( path ), end; dirIt != end; ++dirIt ) {
+					if( fs::is_directory( dirIt->path() ) ) {
+						if( recursive )
+							result = addDirectory( dirIt->path().string(), true, existingFiles ) && result;
+					}
+					else if( existingFiles )
+						existingFiles->push_back( dirIt->path().string() );
+				}
+			}
+			catch( fs::filesystem_error & ) {
+			}
+		}
+
+		return result;
+	}
+
+	int		mFd, mWakeFd;
+	std::map<string, Directory>		mDirectories;
+	std::unordered_map<int, string>	mPaths;
+	std::map<string, bool>			mLostDirectories;	// whether each was watched recursively
+};
+
+#else
+
+//! Placeholder for platforms without a native backend. Never instantiated.
+class FileWatcherNative : private Noncopyable {
+  public:
+	bool addWatch( const Watch & )									{ return false; }
+	void prune( const std::list<std::unique_ptr<Watch>> & )			{}
+	void waitForEvents( double )									{}
+	void wake()														{}
+	void readEvents( vector<string> * )								{}
+};
+
+#endif
+
 // ----------------------------------------------------------------------------------------------------
 // FileWatcher
 // ----------------------------------------------------------------------------------------------------
@@ -288,7 +684,22 @@ signals::Connection FileWatcher::watch( const vector<fs::path> &filePaths, const
 
 signals::Connection FileWatcher::watch( const vector<fs::path> &filePaths, const Options &options, const function<void ( const WatchEvent& )> &callback )
 {
-	auto watch = new Watch( filePaths, options.mCallOnWatch );
+	return addWatch( new Watch( filePaths, options.mCallOnWatch ), options, callback );
+}
+
+signals::Connection FileWatcher::watchDirectory( const fs::path &directoryPath, const function<void ( const WatchEvent& )> &callback )
+{
+	return watchDirectory( directoryPath, Options(), callback );
+}
+
+signals::Connection FileWatcher::watchDirectory( const fs::path &directoryPath, const Options &options, const function<void ( const WatchEvent& )> &callback )
+{
+	vector<fs::path> filePaths = { directoryPath };
+	return addWatch( new Watch( filePaths, options.mCallOnWatch, true ), options, callback );
+}
+
+signals::Connection FileWatcher::addWatch( Watch *watch, const Options &options, const function<void ( const WatchEvent& )> &callback )
+{
 	auto conn = watch->connect( callback );
 
 	lock_guard<recursive_mutex> lock( mMutex );
@@ -300,6 +711,9 @@ signals::Connection FileWatcher::watch( const vector<fs::path> &filePaths, const
 
 	configureWatchPolling();
 
+	if( mNative && ! mNative->addWatch( *watch ) )
+		watch->setPolled( true );
+
 	return conn;
 }
 
@@ -314,6 +728,7 @@ void FileWatcher::unwatch( const fs::path &filePath )
 		watch->unwatch( fullPath );
 		if( watch->isDiscarded() ) {
 			it = mWatchList.erase( it );
+			mNativeNeedsPrune = true;
 			continue;
 		}
 		++it;
@@ -358,6 +773,19 @@ void FileWatcher::configureWatchPolling()
 		connectAppUpdate();
 
 	if( ! mThread.joinable() ) {
+		if( mBackend == Backend::NATIVE && ! mNative && isNativeBackendAvailable() ) {
+			try {
+				mNative.reset( new FileWatcherNative );
+
+				lock_guard<recursive_mutex> lock( mMutex );
+				for( auto &watch : mWatchList )
+					watch->setPolled( ! mNative->addWatch( *watch ) );
+			}
+			catch( FileWatcherException &exc ) {
+				CI_LOG_EXCEPTION( "failed to initialize native backend, falling back to polling", exc );
+			}
+		}
+
 		mThreadShouldQuit = false;
 		mThread = thread( std::bind( &FileWatcher::threadEntry, this ) );
 	}
@@ -369,14 +797,56 @@ void FileWatcher::stopWatchPolling()
 
 	mThreadShouldQuit = true;
 	if( mThread.joinable() ) {
+		if( mNative )
+			mNative->wake();
 		mThread.join();
 	}
 }
 
+void FileWatcher::setBackend( Backend backend )
+{
+	if( mBackend == backend )
+		return;
+
+	const bool wasRunning = mThread.joinable();
+	stopWatchPolling();
+
+	mBackend = backend;
+	mNative.reset();
+	{
+		lock_guard<recursive_mutex> lock( mMutex );
+		for( auto &watch : mWatchList )
+			watch->setPolled( false );
+	}
+
+	if( wasRunning )
+		configureWatchPolling();
+}
+
+bool FileWatcher::isNativeBackendActive() const
+{
+	return mNative != nullptr;
+}
+
+// static
+bool FileWatcher::isNativeBackendAvailable()
+{
+#if defined( CINDER_LINUX )
+	return true;
+#else
+	return false;
+#endif
+}
+
 void FileWatcher::threadEntry()
 {
 	setThreadName( "cinder::FileWatcher" );
 
+	if( mNative ) {
+		threadEntryNative();
+		return;
+	}
+
 	while( ! mThreadShouldQuit ) {
 		LOG_UPDATE( "epoch seconds: " << getElapsedSeconds() );
 
@@ -412,6 +882,95 @@ void FileWatcher::threadEntry()
 	}
 }
 
+void FileWatcher::threadEntryNative()
+{
+	// Changed paths are held until no further notifications have arrived for them within the debounce interval,
+	// so that a burst of writes to a file is reported as a single change. A file that never stops changing is
+	// still reported once maxDebounceIntervals have passed since its first notification.
+	struct PendingPath {
+		double	mFirstTime, mLastTime;
+	};
+	const double maxDebounceIntervals = 10;
+	unordered_map<string, PendingPath> pendingPaths;
+	unordered_set<string> readyPaths;
+	vector<string> changedPaths;
+	double lastPollTime = 0;
+	bool hasPolledWatches = false;
+
+	while( ! mThreadShouldQuit ) {
+		// wake at least every 100ms to discard Watches whose connections have been dropped
+		double now = getElapsedSeconds();
+		double timeout = 0.1;
+		const double debounceInterval = mDebounceInterval;
+		auto readyTime = [&]( const PendingPath &pending ) {
+			return std::min( pending.mLastTime + debounceInterval, pending.mFirstTime + debounceInterval * maxDebounceIntervals );
+		};
+		for( const auto &pending : pendingPaths )
+			timeout = std::min( timeout, readyTime( pending.second ) - now );
+		if( hasPolledWatches )
+			timeout = std::min( timeout, lastPollTime + mThreadUpdateInterval - now );
+
+		mNative->waitForEvents( timeout );
+
+		lock_guard<recursive_mutex> lock( mMutex );
+
+		changedPaths.clear();
+		mNative->readEvents( &changedPaths );
+		now = getElapsedSeconds();
+		for( const auto &path : changedPaths ) {
+			auto result = pendingPaths.insert( make_pair( path, PendingPath{ now, now } ) );
+			result.first->second.mLastTime = now;
+		}
+
+		readyPaths.clear();
+		for( auto it = pendingPaths.begin(); it != pendingPaths.end(); ) {
+			if( now >= readyTime( it->second ) ) {
+				readyPaths.insert( it->first );
+				it = pendingPaths.erase( it );
+			}
+			else
+				++it;
+		}
+
+		const bool pollNow = now - lastPollTime >= mThreadUpdateInterval;
+		if( pollNow )
+			lastPollTime = now;
+
+		hasPolledWatches = false;
+		for( auto it = mWatchList.begin(); it != mWatchList.end(); /* */ ) {
+			const auto &watch = *it;
+			auto next = std::next( it );
+
+			if( watch->isDiscarded() || watch->checkDiscarded() ) {
+				mWatchList.erase( it );
+				mNativeNeedsPrune = true;
+				it = next;
+				continue;
+			}
+
+			if( watch->isPolled() ) {
+				hasPolledWatches = true;
+				if( pollNow && ! watch->needsCallback() )
+					watch->checkCurrent();
+			}
+
+			if( ! readyPaths.empty() )
+				watch->checkChanged( readyPaths );
+
+			// If the Watch needs a callback, move it to the front of the list
+			if( watch->needsCallback() && it != mWatchList.begin() )
+				mWatchList.splice( mWatchList.begin(), mWatchList, it );
+
+			it = next;
+		}
+
+		if( mNativeNeedsPrune ) {
+			mNative->prune( mWatchList );
+			mNativeNeedsPrune = false;
+		}
+	}
+}
+
 void FileWatcher::update()
 {
 	LOG_UPDATE( "elapsed seconds: " << getElapsedSeconds() );
@@ -30,8 +30,14 @@
 #include "cinder/Triangulate.h"
 #include "cinder/BSpline.h"
 #include "cinder/Matrix.h"
+#include "cinder/Simd.h"
 #include "cinder/Sphere.h"
+#include "cinder/Thread.h"
 #include <algorithm>
+#include <list>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
 
 #if defined( CINDER_ANDROID )
   #include "cinder/app/App.h"
@@ -143,6 +149,19 @@ size_t BufferLayout::calcRequiredStorage( size_t numVertices ) const
 	return result;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+// ContentHash
+ContentHash& ContentHash::add( const void *data, size_t size )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( data );
+	for( size_t i = 0; i < size; ++i ) {
+		mHash ^= bytes[i];
+		mHash *= 1099511628211ULL;
+	}
+
+	return *this;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Source
 namespace { // these are helper functions for copyData() and copyDataMultAdd
@@ -390,17 +409,98 @@ void copyIndexDataForceTrianglesImpl( Primitive primitive, const uint32_t *sourc
 	}
 }
 
+// Minimum number of triangles or vertices per range when processing meshes in parallel
+const size_t PARALLEL_RANGE_SIZE = 16384;
+
+// Transforms \a count points or directions in place by the upper 3x4 of \a m, using \a w as the fourth component of each input.
+// Directions are renormalized when \a normalizeResult is true. Large arrays are split into parallel ranges.
+void transformVec3s( const mat4 &m, float w, bool normalizeResult, vec3 *data, size_t count )
+{
+	parallelFor( 0, count, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		size_t v = begin;
+#if defined( CINDER_SIMD_SSE2 )
+		// groups of 4 vertices are transposed to separate x, y and z registers, transformed and transposed back
+		__m128 col[4][3];
+		for( int c = 0; c < 4; ++c ) {
+			for( int r = 0; r < 3; ++r )
+				col[c][r] = _mm_set1_ps( ( c == 3 ) ? m[c][r] * w : m[c][r] );
+		}
+
+		for( ; v + 4 <= end; v += 4 ) {
+			float *p = &data[v].x;
+			const __m128 a = _mm_loadu_ps( p ), b = _mm_loadu_ps( p + 4 ), c = _mm_loadu_ps( p + 8 );
+			const __m128 x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+			const __m128 y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+			const __m128 z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+			__m128 r[3];
+			for( int i = 0; i < 3; ++i )
+				r[i] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( col[0][i], x ), _mm_mul_ps( col[1][i], y ) ), _mm_add_ps( _mm_mul_ps( col[2][i], z ), col[3][i] ) );
+			if( normalizeResult ) {
+				const __m128 lengthSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r[0], r[0] ), _mm_mul_ps( r[1], r[1] ) ), _mm_mul_ps( r[2], r[2] ) );
+				const __m128 invLength = _mm_div_ps( _mm_set1_ps( 1 ), _mm_sqrt_ps( lengthSq ) );
+				for( int i = 0; i < 3; ++i )
+					r[i] = _mm_mul_ps( r[i], invLength );
+			}
+
+			const __m128 xy01 = _mm_unpacklo_ps( r[0], r[1] ), xy23 = _mm_unpackhi_ps( r[0], r[1] ), yz01 = _mm_unpacklo_ps( r[1], r[2] );
+			_mm_storeu_ps( p, _mm_shuffle_ps( xy01, _mm_shuffle_ps( r[2], xy01, _MM_SHUFFLE( 2, 2, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+			_mm_storeu_ps( p + 4, _mm_shuffle_ps( yz01, xy23, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+			_mm_storeu_ps( p + 8, _mm_shuffle_ps( _mm_shuffle_ps( r[2], xy23, _MM_SHUFFLE( 2, 2, 2, 2 ) ), _mm_shuffle_ps( xy23, r[2], _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		}
+#endif
+		for( ; v < end; ++v ) {
+			vec3 r( m * vec4( data[v], w ) );
+			data[v] = normalizeResult ? normalize( r ) : r;
+		}
+	} );
+}
+
+// Sums the value computed by \a faceFn for each triangle into every vertex the triangle references. Rather than scattering
+// into the result, which would require atomics or per-thread copies, a vertex-to-triangle table is built so that each vertex
+// gathers its own sum. Triangles are visited in order, so the result is identical to a serial accumulation.
+template<typename FaceFnT>
+void accumulateTriangles( size_t numIndices, const uint32_t *indices, size_t numVertices, const FaceFnT &faceFn, vector<vec3> *result )
+{
+	const size_t numTriangles = numIndices / 3;
+	vector<vec3> faceValues( numTriangles );
+	parallelFor( 0, numTriangles, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t t = begin; t < end; ++t )
+			faceValues[t] = faceFn( t );
+	} );
+
+	// counting sort of triangle corners by vertex
+	vector<uint32_t> offsets( numVertices + 1, 0 );
+	for( size_t i = 0; i < numTriangles * 3; ++i )
+		++offsets[indices[i] + 1];
+	for( size_t v = 0; v < numVertices; ++v )
+		offsets[v + 1] += offsets[v];
+
+	vector<uint32_t> vertexTriangles( numTriangles * 3 );
+	{
+		vector<uint32_t> cursor( offsets.begin(), offsets.end() - 1 );
+		for( size_t i = 0; i < numTriangles * 3; ++i )
+			vertexTriangles[cursor[indices[i]]++] = (uint32_t)( i / 3 );
+	}
+
+	result->resize( numVertices );
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t v = begin; v < end; ++v ) {
+			vec3 sum( 0 );
+			for( uint32_t c = offsets[v]; c < offsets[v + 1]; ++c )
+				sum += faceValues[vertexTriangles[c]];
+			(*result)[v] = sum;
+		}
+	} );
+}
+
 // Lengyel, Eric. "Computing Tangent Space Basis Vectors for an Arbitrary Mesh". 
 // Terathon Software 3D Graphics Library, 2001.
 // http://www.terathon.com/code/tangent.html
 template<typename TEXTYPE>
 void calculateTangentsImpl( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const TEXTYPE *texCoords, vector<vec3> *resultTangents, vector<vec3> *resultBitangents )
 {
-	if( resultTangents )
-		resultTangents->assign( numVertices, vec3( 0 ) );
-
-	size_t numTriangles = numIndices / 3;
-	for( size_t i = 0; i < numTriangles; ++i ) {
+	auto faceTangent = [=]( size_t i ) {
 		uint32_t index0 = indices[i * 3];
 		uint32_t index1 = indices[i * 3 + 1];
 		uint32_t index2 = indices[i * 3 + 2];
@@ -428,32 +528,60 @@ void calculateTangentsImpl( size_t numIndices, const uint32_t *indices, size_t n
 		float r = (s1 * t2 - s2 * t1);
 		if( r != 0.0f ) r = 1.0f / r;
 
-		vec3 tangent( (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r );
+		return vec3( (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r );
+	};
 
-		(*resultTangents)[index0] += tangent;
-		(*resultTangents)[index1] += tangent;
-		(*resultTangents)[index2] += tangent;
-	}
+	accumulateTriangles( numIndices, indices, numVertices, faceTangent, resultTangents );
 
-	for( size_t i = 0; i < numVertices; ++i ) {
-		vec3 normal = normals[i];
-		vec3 tangent = (*resultTangents)[i];
-		(*resultTangents)[i] = ( tangent - normal * dot( normal, tangent ) );
+	if( resultBitangents )
+		resultBitangents->resize( numVertices );
 
-		float len = length2( (*resultTangents)[i] );
-		if( len > 0.0f )
-			(*resultTangents)[i] /= sqrt( len );
-	}
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t i = begin; i < end; ++i ) {
+			vec3 normal = normals[i];
+			vec3 tangent = (*resultTangents)[i];
+			(*resultTangents)[i] = ( tangent - normal * dot( normal, tangent ) );
 
-	if( resultBitangents ) {
-		resultBitangents->reserve( numVertices );
-		for( size_t i = 0; i < numVertices; ++i )
-			resultBitangents->emplace_back( normalize( cross( normals[i], (*resultTangents)[i] ) ) );
-	}
+			float len = length2( (*resultTangents)[i] );
+			if( len > 0.0f )
+				(*resultTangents)[i] /= sqrt( len );
+
+			if( resultBitangents )
+				(*resultBitangents)[i] = normalize( cross( normal, (*resultTangents)[i] ) );
+		}
+	} );
 }
 
 } // anonymous namespace
 
+void calculateNormals( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, bool weighted, vector<vec3> *resultNormals )
+{
+	auto faceNormal = [=]( size_t i ) {
+		const vec3 &v0 = positions[indices[i * 3 + 0]];
+		const vec3 &v1 = positions[indices[i * 3 + 1]];
+		const vec3 &v2 = positions[indices[i * 3 + 2]];
+
+		vec3 e0 = v1 - v0;
+		vec3 e1 = v2 - v0;
+		vec3 e2 = v2 - v1;
+
+		if( length2( e0 ) < FLT_EPSILON || length2( e1 ) < FLT_EPSILON || length2( e2 ) < FLT_EPSILON )
+			return vec3( 0 );
+
+		vec3 normal = cross( e0, e1 );
+
+		// if not weighted, every normal has an equal contribution
+		return weighted ? normal : normalize( normal );
+	};
+
+	accumulateTriangles( numIndices, indices, numVertices, faceNormal, resultNormals );
+
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t i = begin; i < end; ++i )
+			(*resultNormals)[i] = normalize( (*resultNormals)[i] );
+	} );
+}
+
 void calculateTangents( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, const vec3 *normals, const vec2 *texCoords, vector<vec3> *resultTangents, vector<vec3> *resultBitangents )
 {
 	calculateTangentsImpl( numIndices, indices, numVertices, positions, normals, texCoords, resultTangents, resultBitangents );
@@ -2716,21 +2844,23 @@ void Transform::process( SourceModsContext *ctx, const AttribSet &requestedAttri
 
 	if( ctx->getAttribDims( POSITION ) == 2 ) {
 		const vec2* inPositions = reinterpret_cast<vec2*>( ctx->getAttribData( POSITION ) );
-		vector<vec3> outPositions;
-		outPositions.reserve( numVertices );
+		unique_ptr<float[]> outData( new float[numVertices * 3] );
+		vec3* outPositions = reinterpret_cast<vec3*>( outData.get() );
 		for( size_t v = 0; v < numVertices; ++v )
-			outPositions.push_back( vec3( mTransform * vec4( inPositions[v], 0, 1 ) ) );
-		ctx->copyAttrib( POSITION, 3, 0, (const float*)outPositions.data(), numVertices );
+			outPositions[v] = vec3( inPositions[v], 0 );
+		transformVec3s( mTransform, 1, false, outPositions, numVertices );
+		ctx->setAttrib( POSITION, 3, std::move( outData ), numVertices );
 	}
 	else if( ctx->getAttribDims( POSITION ) == 3 ) {
 		vec3* positions = reinterpret_cast<vec3*>( ctx->getAttribData( POSITION ) );
-		for( size_t v = 0; v < numVertices; ++v )
-			positions[v] = vec3( mTransform * vec4( positions[v], 1 ) );
+		transformVec3s( mTransform, 1, false, positions, numVertices );
 	}
 	else if( ctx->getAttribDims( POSITION ) == 4 ) {
 		vec4* positions = reinterpret_cast<vec4*>( ctx->getAttribData( POSITION ) );
-		for( size_t v = 0; v < numVertices; ++v )
-			positions[v] = mTransform * positions[v];
+		parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+			for( size_t v = begin; v < end; ++v )
+				positions[v] = mTransform * positions[v];
+		} );
 	}
 	else if( ctx->getAttribDims( POSITION ) != 0 )
 		CI_LOG_W( "Unsupported dimension for geom::POSITION passed to geom::Transform" );
@@ -2740,8 +2870,7 @@ void Transform::process( SourceModsContext *ctx, const AttribSet &requestedAttri
 	if( ctx->getAttribDims( NORMAL ) == 3 ) {
 		vec3* normals = reinterpret_cast<vec3*>( ctx->getAttribData( NORMAL ) );
 		mat3 normalsTransform = glm::transpose( inverse( mat3( mTransform ) ) );
-		for( size_t v = 0; v < numVertices; ++v )
-			normals[v] = normalize( normalsTransform * normals[v] );
+		transformVec3s( mat4( normalsTransform ), 0, true, normals, numVertices );
 	}
 	else if( ctx->getAttribDims( NORMAL ) != 0 )
 		CI_LOG_W( "Unsupported dimension for geom::NORMAL passed to geom::Transform" );
@@ -2751,8 +2880,7 @@ void Transform::process( SourceModsContext *ctx, const AttribSet &requestedAttri
 	if( ctx->getAttribDims( TANGENT ) == 3 ) {
 		vec3* tangents = reinterpret_cast<vec3*>( ctx->getAttribData( TANGENT ) );
 		mat3 tangentsTransform = glm::transpose( inverse( mat3( mTransform ) ) );
-		for( size_t v = 0; v < numVertices; ++v )
-			tangents[v] = normalize( tangentsTransform * tangents[v] );
+		transformVec3s( mat4( tangentsTransform ), 0, true, tangents, numVertices );
 	}
 	else if( ctx->getAttribDims( TANGENT ) != 0 )
 		CI_LOG_W( "Unsupported dimension for geom::TANGENT passed to geom::Transform" );
@@ -2776,25 +2904,25 @@ void Twist::process( SourceModsContext *ctx, const AttribSet &requestedAttribs )
 		if( ctx->getAttribDims( TANGENT ) == 3 )
 			tangents = reinterpret_cast<vec3*>( ctx->getAttribData( TANGENT ) );
 		
-		for( size_t v = 0; v < numVertices; ++v ) {
-			// find the 't' value of the point on the axis that inPosition is closest to
-			float closestDist = dot( positions[v] - mAxisStart, axisDir );
-			float tVal = glm::clamp<float>( closestDist * invAxisLength, 0, 1 );
-			// 'pointOnAxis' is the actual point on the axis inPosition is closest to
-			vec3 pointOnAxis = mAxisStart + axisDir * closestDist;
-			// our rotation is around the axis, and the angle is a lerp between 'mStartAngle' and 'mEndAngle' based on 't'
-			mat4 rotation = rotate( glm::mix( mStartAngle, mEndAngle, tVal ), axisDir );
-			// now transform the point by rotating around 'pointOnAxis'
-			mat4 transform = translate( pointOnAxis ) * rotation * translate( -pointOnAxis );
-			vec3 outPos = vec3( transform * vec4( positions[v], 1 ) );
-			positions[v] = outPos;
-			// we need to transform the normal by rotating it by the same angle (but not around the point) we did the position
-			if( normals )
-				normals[v] = vec3( rotation * vec4( normals[v], 0 ) );
-			// we need to transform the tangent by rotating it by the same angle (but not around the point) we did the position
-			if( tangents )
-				tangents[v] = vec3( rotation * vec4( tangents[v], 0 ) );
-		}
+		parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+			for( size_t v = begin; v < end; ++v ) {
+				// find the 't' value of the point on the axis that inPosition is closest to
+				float closestDist = dot( positions[v] - mAxisStart, axisDir );
+				float tVal = glm::clamp<float>( closestDist * invAxisLength, 0, 1 );
+				// 'pointOnAxis' is the actual point on the axis inPosition is closest to
+				vec3 pointOnAxis = mAxisStart + axisDir * closestDist;
+				// our rotation is around the axis, and the angle is a lerp between 'mStartAngle' and 'mEndAngle' based on 't'
+				mat3 rotation = mat3( rotate( glm::mix( mStartAngle, mEndAngle, tVal ), axisDir ) );
+				// now transform the point by rotating around 'pointOnAxis'
+				positions[v] = pointOnAxis + rotation * ( positions[v] - pointOnAxis );
+				// we need to transform the normal by rotating it by the same angle (but not around the point) we did the position
+				if( normals )
+					normals[v] = rotation * normals[v];
+				// we need to transform the tangent by rotating it by the same angle (but not around the point) we did the position
+				if( tangents )
+					tangents[v] = rotation * tangents[v];
+			}
+		} );
 	}
 	else if( ctx->getAttribDims( POSITION ) != 0 )
 		CI_LOG_W( "Unsupported dimension for geom::POSITION passed to geom::Twist" );
@@ -2957,22 +3085,27 @@ AttribSet ColorFromAttrib::getAvailableAttribs( const Modifier::Params &upstream
 }
 
 namespace {
+// \a maxThreads of 1 processes the vertices serially on the calling thread
 template<typename I, typename IFD, typename O>
-void processColorAttrib( const I* inputData, O *outputData, const std::function<O(IFD)> &fn, size_t numVertices )
+void processColorAttrib( const I* inputData, O *outputData, const std::function<O(IFD)> &fn, size_t numVertices, size_t maxThreads )
 {
-	for( size_t v = 0; v < numVertices; ++v ) {
-		IFD in( (IFD)inputData[v] );
-		outputData[v] = fn( in );
-	}
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t v = begin; v < end; ++v ) {
+			IFD in( (IFD)inputData[v] );
+			outputData[v] = fn( in );
+		}
+	}, maxThreads );
 }
 
 template<typename O>
-void processColorAttrib2d( const vec2* inputData, O *outputData, const std::function<O(vec3)> &fn, size_t numVertices )
+void processColorAttrib2d( const vec2* inputData, O *outputData, const std::function<O(vec3)> &fn, size_t numVertices, size_t maxThreads )
 {
-	for( size_t v = 0; v < numVertices; ++v ) {
-		vec3 in( inputData[v], 0 );
-		outputData[v] = fn( in );
-	}
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t v = begin; v < end; ++v ) {
+			vec3 in( inputData[v], 0 );
+			outputData[v] = fn( in );
+		}
+	}, maxThreads );
 }
 } // anonymous namespace
 
@@ -2995,25 +3128,26 @@ void ColorFromAttrib::process( SourceModsContext *ctx, const AttribSet &requeste
 	unique_ptr<float[]> mColorData( new float[numVertices * 3] );
 	uint8_t inputAttribDims = ctx->getAttribDims( mAttrib );
 	const float* inputAttribData = ctx->getAttribData( mAttrib );
+	const size_t maxThreads = mParallel ? 0 : 1;
 	
 	if( mFnColor2 ) {
 		if( inputAttribDims == 2 )
-			processColorAttrib( reinterpret_cast<const vec2*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices );
+			processColorAttrib( reinterpret_cast<const vec2*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices, maxThreads );
 		else if( inputAttribDims == 3 )
-			processColorAttrib( reinterpret_cast<const vec3*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices );
+			processColorAttrib( reinterpret_cast<const vec3*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices, maxThreads );
 		else if( inputAttribDims == 4 )
-			processColorAttrib( reinterpret_cast<const vec4*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices );
+			processColorAttrib( reinterpret_cast<const vec4*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor2, numVertices, maxThreads );
 	}
 	else if( mFnColor3 ) {
 		if( inputAttribDims == 2 )
-			processColorAttrib2d( reinterpret_cast<const vec2*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices );
+			processColorAttrib2d( reinterpret_cast<const vec2*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices, maxThreads );
 		if( inputAttribDims == 3 )
-			processColorAttrib( reinterpret_cast<const vec3*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices );
+			processColorAttrib( reinterpret_cast<const vec3*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices, maxThreads );
 		else if( inputAttribDims == 4 )
-			processColorAttrib( reinterpret_cast<const vec4*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices );
+			processColorAttrib( reinterpret_cast<const vec4*>( inputAttribData ), reinterpret_cast<Colorf*>( mColorData.get() ), mFnColor3, numVertices, maxThreads );
 	}
 
-	ctx->copyAttrib( Attrib::COLOR, 3, 0, mColorData.get(), numVertices );
+	ctx->setAttrib( Attrib::COLOR, 3, std::move( mColorData ), numVertices );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -3033,44 +3167,42 @@ AttribSet Constant::getAvailableAttribs( const Modifier::Params &upstreamParams
 	return result;
 }
 
+namespace {
+template<typename T>
+void fillConstant( T *data, size_t numVertices, const T &value )
+{
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		std::fill( data + begin, data + end, value );
+	} );
+}
+} // anonymous namespace
+
 void Constant::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
 {
 	ctx->processUpstream( requestedAttribs );
 
 	const size_t numVertices = ctx->getNumVertices();
+	unique_ptr<float[]> data( new float[numVertices * mDims] );
 	
 	switch( mDims ) {
-		case 1: {
-			unique_ptr<float[]> mColorData( new float[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = mValue.x;
-			ctx->copyAttrib( mAttrib, 1, 0, (const float*)mColorData.get(), numVertices );
-		}
+		case 1:
+			fillConstant( data.get(), numVertices, mValue.x );
 		break;
-		case 2: {
-			unique_ptr<vec2[]> mColorData( new vec2[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = vec2( mValue.x, mValue.y );
-			ctx->copyAttrib( mAttrib, 2, 0, (const float*)mColorData.get(), numVertices );
-		}
+		case 2:
+			fillConstant( reinterpret_cast<vec2*>( data.get() ), numVertices, vec2( mValue.x, mValue.y ) );
 		break;
-		case 3: {
-			unique_ptr<vec3[]> mColorData( new vec3[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = vec3( mValue.x, mValue.y, mValue.z );
-			ctx->copyAttrib( mAttrib, 3, 0, (const float*)mColorData.get(), numVertices );
-		}
+		case 3:
+			fillConstant( reinterpret_cast<vec3*>( data.get() ), numVertices, vec3( mValue.x, mValue.y, mValue.z ) );
 		break;
-		case 4: {
-			unique_ptr<vec4[]> mColorData( new vec4[numVertices] );
-			for( size_t v = 0; v < numVertices; ++v )
-				mColorData[v] = mValue;
-			ctx->copyAttrib( mAttrib, 4, 0, (const float*)mColorData.get(), numVertices );
-		}
+		case 4:
+			fillConstant( reinterpret_cast<vec4*>( data.get() ), numVertices, mValue );
 		break;
 		default:
 			CI_LOG_E( "Illegal dimensions." );
+			return;
 	}
+
+	ctx->setAttrib( mAttrib, mDims, std::move( data ), numVertices );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -3094,13 +3226,15 @@ AttribSet AttribFn<S,D>::getAvailableAttribs( const Modifier::Params &upstreamPa
 
 namespace {
 template<typename S, typename D>
-void processAttrib( const float *inputDataFloat, float *outputDataFloat, const std::function<D(S)> &fn, size_t numVertices )
+void processAttrib( const float *inputDataFloat, float *outputDataFloat, const std::function<D(S)> &fn, size_t numVertices, size_t maxThreads )
 {
 	const S *inData = reinterpret_cast<const S*>( inputDataFloat );
 	D *outData = reinterpret_cast<D*>( outputDataFloat );
 
-	for( size_t v = 0; v < numVertices; ++v )
-		outData[v] = fn( inData[v] );
+	parallelFor( 0, numVertices, PARALLEL_RANGE_SIZE, [&]( size_t begin, size_t end ) {
+		for( size_t v = begin; v < end; ++v )
+			outData[v] = fn( inData[v] );
+	}, maxThreads );
 }
 } // anonymous namespace
 
@@ -3132,8 +3266,8 @@ void geom::AttribFn<S,D>::process( SourceModsContext *ctx, const AttribSet &requ
 	else
 		inputAttribData = ctx->getAttribData( mSrcAttrib );
 	
-	processAttrib<S,D>( inputAttribData, outData.get(), mFn, numVertices );
-	ctx->copyAttrib( mDstAttrib, DSTDIM, 0, outData.get(), numVertices );
+	processAttrib<S,D>( inputAttribData, outData.get(), mFn, numVertices, mParallel ? 0 : 1 );
+	ctx->setAttrib( mDstAttrib, DSTDIM, std::move( outData ), numVertices );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -4525,6 +4659,67 @@ void Bounds::process( SourceModsContext *ctx, const AttribSet &requestedAttribs
 		*mResult = AxisAlignedBox( minResult, maxResult );
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+// OptimizeVertexCache
+void OptimizeVertexCache::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+{
+	AttribSet request = requestedAttribs;
+	if( mOverdraw )
+		request.insert( POSITION );
+	ctx->processUpstream( request );
+
+	if( ctx->getPrimitive() != Primitive::TRIANGLES || ctx->getNumIndices() == 0 ) {
+		CI_LOG_W( "geom::OptimizeVertexCache requires indexed TRIANGLES" );
+		return;
+	}
+
+	const size_t numIndices = ctx->getNumIndices();
+	const size_t numVertices = ctx->getNumVertices();
+	uint32_t *indices = ctx->getIndicesData();
+	optimizeVertexCache( numIndices, indices, numVertices, mCacheSize );
+
+	if( mOverdraw ) {
+		if( ctx->getAttribDims( POSITION ) == 3 )
+			optimizeOverdraw( numIndices, indices, numVertices, (const vec3*)ctx->getAttribData( POSITION ), mOverdrawThreshold, mCacheSize );
+		else
+			CI_LOG_W( "geom::OptimizeVertexCache requires 3D positions to reduce overdraw" );
+	}
+
+	// we don't need to copyIndices() because we processed in place
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// OptimizeVertexFetch
+void OptimizeVertexFetch::process( SourceModsContext *ctx, const AttribSet &requestedAttribs ) const
+{
+	ctx->processUpstream( requestedAttribs );
+
+	if( ctx->getPrimitive() != Primitive::TRIANGLES || ctx->getNumIndices() == 0 ) {
+		CI_LOG_W( "geom::OptimizeVertexFetch requires indexed TRIANGLES" );
+		return;
+	}
+
+	const size_t numIndices = ctx->getNumIndices();
+	const size_t numVertices = ctx->getNumVertices();
+	uint32_t *indices = ctx->getIndicesData();
+
+	vector<uint32_t> remap;
+	calculateVertexFetchRemap( numIndices, indices, numVertices, &remap );
+	for( size_t i = 0; i < numIndices; ++i )
+		indices[i] = remap[indices[i]];
+
+	// reorder each attribute in place
+	vector<float> reordered;
+	for( const auto &attr : ctx->getAvailableAttribs() ) {
+		const uint8_t dims = ctx->getAttribDims( attr );
+		float *data = ctx->getAttribData( attr );
+		reordered.resize( numVertices * dims );
+		for( size_t v = 0; v < numVertices; ++v )
+			std::copy( data + v * dims, data + ( v + 1 ) * dims, reordered.data() + remap[v] * dims );
+		std::copy( reordered.begin(), reordered.end(), data );
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////////////////
 // Subdivide
 size_t Subdivide::getNumVertices( const Modifier::Params &upstreamParams ) const
@@ -4623,6 +4818,48 @@ void Subdivide::process( SourceModsContext *ctx, const AttribSet &requestedAttri
 
 //////////////////////////////////////////////////////////////////////////////////////
 // SourceMods
+
+namespace {
+
+// A memoized result of evaluating a SourceMods
+struct CachedResult {
+	uint64_t									mHash;
+	//! The attributes 'mResult' was evaluated with
+	AttribSet									mAttribs;
+	std::shared_ptr<const SourceModsContext>	mResult;
+	size_t										mNumBytes;
+};
+
+// Results shared by every SourceMods with the same SourceMods::hashContent(), most recently used first
+struct ResultCache {
+	std::mutex													mMutex;
+	std::list<CachedResult>										mResults;
+	std::unordered_map<uint64_t, std::list<CachedResult>::iterator>	mResultsByHash;
+	size_t														mNumBytes = 0;
+	size_t														mCapacity = 32 * 1024 * 1024;
+
+	void erase( std::list<CachedResult>::iterator resultIt )
+	{
+		mNumBytes -= resultIt->mNumBytes;
+		mResultsByHash.erase( resultIt->mHash );
+		mResults.erase( resultIt );
+	}
+
+	void trim()
+	{
+		while( mNumBytes > mCapacity )
+			erase( --mResults.end() );
+	}
+};
+
+ResultCache& resultCache()
+{
+	static ResultCache sResultCache;
+	return sResultCache;
+}
+
+} // anonymous namespace
+
 void SourceMods::copyImpl( const SourceMods &rhs )
 {
 	mVariablesCached = false;
@@ -4756,6 +4993,96 @@ void SourceMods::cacheVariables() const
 }
 
 void SourceMods::loadInto( Target *target, const AttribSet &requestedAttribs ) const
+{
+	ResultCache &cache = resultCache();
+	ContentHash hash;
+	if( ( getCacheCapacity() == 0 ) || ! hashContent( &hash ) ) {
+		loadIntoImpl( target, requestedAttribs );
+		return;
+	}
+
+	// evaluate the chain again only if it can supply an attribute which is missing from the memoized result.
+	// The previous request is included so that the new result satisfies both.
+	const AttribSet availableAttribs = getAvailableAttribs();
+	AttribSet evaluatedAttribs = requestedAttribs;
+	std::shared_ptr<const SourceModsContext> result;
+	{
+		std::lock_guard<std::mutex> lock( cache.mMutex );
+		auto resultIt = cache.mResultsByHash.find( hash.get() );
+		if( resultIt != cache.mResultsByHash.end() ) {
+			const CachedResult &cached = *resultIt->second;
+			bool complete = true;
+			for( Attrib attrib : requestedAttribs ) {
+				if( availableAttribs.count( attrib ) && ( cached.mAttribs.count( attrib ) == 0 ) )
+					complete = false;
+			}
+
+			if( complete ) {
+				result = cached.mResult;
+				cache.mResults.splice( cache.mResults.begin(), cache.mResults, resultIt->second );
+			}
+			else
+				evaluatedAttribs.insert( cached.mAttribs.begin(), cached.mAttribs.end() );
+		}
+	}
+
+	// evaluated without holding the lock, so that different chains are evaluated concurrently
+	if( ! result ) {
+		auto evaluated = make_shared<SourceModsContext>();
+		loadIntoImpl( evaluated.get(), evaluatedAttribs );
+		result = evaluated;
+
+		size_t numBytes = result->getNumIndices() * sizeof( uint32_t );
+		for( Attrib attrib : result->getAvailableAttribs() )
+			numBytes += result->getAttribDims( attrib ) * result->getNumVertices() * sizeof( float );
+
+		std::lock_guard<std::mutex> lock( cache.mMutex );
+		auto resultIt = cache.mResultsByHash.find( hash.get() );
+		if( resultIt != cache.mResultsByHash.end() )
+			cache.erase( resultIt->second );
+		if( numBytes <= cache.mCapacity ) {
+			cache.mResults.push_front( CachedResult{ hash.get(), evaluatedAttribs, result, numBytes } );
+			cache.mResultsByHash[hash.get()] = cache.mResults.begin();
+			cache.mNumBytes += numBytes;
+			cache.trim();
+		}
+	}
+
+	for( Attrib attrib : result->getAvailableAttribs() ) {
+		if( requestedAttribs.count( attrib ) )
+			target->copyAttrib( attrib, result->getAttribDims( attrib ), 0, result->getAttribData( attrib ), result->getNumVertices() );
+	}
+
+	if( result->getNumIndices() > 0 )
+		target->copyIndices( result->getPrimitive(), result->getIndicesData(), result->getNumIndices(), calcIndicesRequiredBytes( result->getNumIndices() ) );
+}
+
+bool SourceMods::hashContent( ContentHash *hash ) const
+{
+	// the type of each Source and Modifier distinguishes those with the same parameters
+	if( mSourcePtr ) {
+		hash->add( typeid( *mSourcePtr ).hash_code() );
+		if( ! mSourcePtr->hashContent( hash ) )
+			return false;
+		hash->add( mModifiers.size() );
+		for( auto &modifier : mModifiers ) {
+			hash->add( typeid( *modifier ).hash_code() );
+			if( ! modifier->hashContent( hash ) )
+				return false;
+		}
+	}
+	else {
+		hash->add( mChildren.size() );
+		for( auto &child : mChildren ) {
+			if( ! child->hashContent( hash ) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void SourceMods::loadIntoImpl( Target *target, const AttribSet &requestedAttribs ) const
 {
 	if( mSourcePtr ) { // normal, no children
 		if( mModifiers.empty() ) {
@@ -4778,6 +5105,30 @@ void SourceMods::loadInto( Target *target, const AttribSet &requestedAttribs ) c
 	}
 }
 
+void SourceMods::setCacheCapacity( size_t bytes )
+{
+	ResultCache &cache = resultCache();
+	std::lock_guard<std::mutex> lock( cache.mMutex );
+	cache.mCapacity = bytes;
+	cache.trim();
+}
+
+size_t SourceMods::getCacheCapacity()
+{
+	ResultCache &cache = resultCache();
+	std::lock_guard<std::mutex> lock( cache.mMutex );
+	return cache.mCapacity;
+}
+
+void SourceMods::clearCache()
+{
+	ResultCache &cache = resultCache();
+	std::lock_guard<std::mutex> lock( cache.mMutex );
+	cache.mResults.clear();
+	cache.mResultsByHash.clear();
+	cache.mNumBytes = 0;
+}
+
 void SourceMods::append( const Modifier &modifier )
 {
 	mModifiers.emplace_back( modifier.clone() );
@@ -4814,6 +5165,7 @@ SourceModsContext::SourceModsContext( const SourceMods *sourceMods )
 {
 	mSource = sourceMods->getSource();
 	
+	sourceMods->cacheVariables();
 	if( ! sourceMods->mParamsStack.empty() ) // this allows for a non-indexed Source to have never specified the primitive via copyIndices()
 		mPrimitive = sourceMods->mParamsStack.front().mPrimitive;
 	
@@ -4947,7 +5299,9 @@ void SourceModsContext::complete( Target *target, const AttribSet &requestedAttr
 		target->copyAttrib( attrib, attribInfo.getDims(), attribInfo.getStride(), mAttribData[attrib].get(), mAttribCount[attrib] );
 	}
 
-	target->copyIndices( mPrimitive, mIndices.get(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );	
+	// like a Source, non-indexed geometry leaves generating indices to the target
+	if( mNumIndices > 0 )
+		target->copyIndices( mPrimitive, mIndices.get(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );
 }
 
 void SourceModsContext::loadInto( Target *target, const AttribSet &requestedAttribs )
@@ -4979,7 +5333,9 @@ void SourceModsContext::loadInto( Target *target, const AttribSet &requestedAttr
 			target->copyAttrib( attrib, attribInfo.getDims(), attribInfo.getStride(), mAttribData[attrib].get(), mAttribCount[attrib] );
 		}
 
-		target->copyIndices( mPrimitive, mIndices.get(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );
+		// like a Source, non-indexed geometry leaves generating indices to the target
+		if( mNumIndices > 0 )
+			target->copyIndices( mPrimitive, mIndices.get(), mNumIndices, calcIndicesRequiredBytes( mNumIndices ) );
 	}
 	else {
 		// no modifiers; in this case just call loadInto()
@@ -5083,6 +5439,18 @@ void SourceModsContext::copyAttrib( Attrib attr, uint8_t dims, size_t strideByte
 	copyData( dims, strideBytes, srcData, count, dims, 0, mAttribData.at( attr ).get() );
 }
 
+void SourceModsContext::setAttrib( Attrib attr, uint8_t dims, std::unique_ptr<float[]> &&data, size_t count )
+{
+	if( mAttribMask && mAttribMask->count( attr ) == 0 )
+		return;
+
+	mNumVertices = count;
+	mAttribData[attr] = std::move( data );
+	mAttribCount[attr] = count;
+	auto it = mAttribInfo.insert( make_pair( attr, AttribInfo( attr, dims, dims * sizeof(float), (size_t)0 ) ) ).first;
+	it->second = AttribInfo( attr, dims, dims * sizeof(float), (size_t)0 );
+}
+
 void SourceModsContext::appendAttrib( Attrib attr, uint8_t dims, const float *srcData, size_t count )
 {
 	// if we don't have any data for this attribute, just call copyAttrib
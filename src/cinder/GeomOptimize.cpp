@@ -0,0 +1,591 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/GeomIo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+using namespace std;
+
+namespace cinder { namespace geom {
+
+namespace {
+
+const size_t MAX_CACHE_SIZE = 64;
+
+// Simulates a FIFO cache using a timestamp per vertex. A vertex is in the cache if fewer than cacheSize vertices have been loaded since it was.
+class FifoCache {
+  public:
+	FifoCache( size_t numVertices, size_t cacheSize )
+		: mTimestamps( numVertices, 0 ), mCacheSize( (uint32_t)cacheSize ), mTime( (uint32_t)cacheSize + 1 )
+	{}
+
+	//! Returns the number of misses caused by the triangle at \a indices.
+	int		addTriangle( const uint32_t *indices )
+	{
+		int misses = 0;
+		for( int i = 0; i < 3; ++i ) {
+			if( mTime - mTimestamps[indices[i]] > mCacheSize ) {
+				mTimestamps[indices[i]] = mTime++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	void	clear() { mTime += mCacheSize + 1; }
+
+  private:
+	vector<uint32_t>	mTimestamps;
+	uint32_t			mCacheSize, mTime;
+};
+
+// Stores the triangles using each vertex contiguously, in the order of \a indices
+void buildAdjacency( size_t numIndices, const uint32_t *indices, size_t numVertices, vector<uint32_t> *offsets, vector<uint32_t> *triangles )
+{
+	offsets->assign( numVertices + 1, 0 );
+	for( size_t i = 0; i < numIndices; ++i )
+		++(*offsets)[indices[i] + 1];
+	for( size_t v = 0; v < numVertices; ++v )
+		(*offsets)[v + 1] += (*offsets)[v];
+
+	vector<uint32_t> next( offsets->begin(), offsets->end() - 1 );
+	triangles->resize( numIndices );
+	for( size_t i = 0; i < numIndices; ++i )
+		(*triangles)[next[indices[i]]++] = uint32_t( i / 3 );
+}
+
+// A quadric measuring the weighted sum of squared distances to a set of planes
+struct Quadric {
+	Quadric() { memset( this, 0, sizeof( Quadric ) ); }
+
+	void addPlane( const dvec3 &n, double d, double weight )
+	{
+		a2 += weight * n.x * n.x; ab += weight * n.x * n.y; ac += weight * n.x * n.z; ad += weight * n.x * d;
+		b2 += weight * n.y * n.y; bc += weight * n.y * n.z; bd += weight * n.y * d;
+		c2 += weight * n.z * n.z; cd += weight * n.z * d;
+		d2 += weight * d * d;
+		w += weight;
+	}
+
+	Quadric& operator+=( const Quadric &rhs )
+	{
+		a2 += rhs.a2; ab += rhs.ab; ac += rhs.ac; ad += rhs.ad; b2 += rhs.b2; bc += rhs.bc; bd += rhs.bd; c2 += rhs.c2; cd += rhs.cd; d2 += rhs.d2; w += rhs.w;
+		return *this;
+	}
+
+	//! Returns the weighted mean squared distance of \a p to the planes.
+	double eval( const vec3 &p ) const
+	{
+		const double x = p.x, y = p.y, z = p.z;
+		const double sum = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+						+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+						+ c2 * z * z + 2 * cd * z
+						+ d2;
+		return ( w > 0 ) ? std::max( sum, 0.0 ) / w : 0;
+	}
+
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, w;
+};
+
+struct Collapse {
+	float		mCost;
+	uint32_t	mFrom, mTo;
+	uint32_t	mFromVersion, mToVersion;
+
+	bool operator>( const Collapse &rhs ) const { return mCost > rhs.mCost; }
+};
+
+// Borders are weighted more heavily than faces, so open edges keep their shape
+const double BORDER_WEIGHT = 10;
+
+} // anonymous namespace
+
+VertexCacheStatistics calculateVertexCacheStatistics( size_t numIndices, const uint32_t *indices, size_t numVertices, size_t cacheSize )
+{
+	VertexCacheStatistics result = { 0, 0 };
+	if( numIndices < 3 || numVertices == 0 )
+		return result;
+
+	FifoCache cache( numVertices, cacheSize );
+	vector<bool> used( numVertices, false );
+	size_t misses = 0, numUsed = 0;
+	for( size_t i = 0; i + 2 < numIndices; i += 3 ) {
+		misses += cache.addTriangle( indices + i );
+		for( int c = 0; c < 3; ++c ) {
+			if( ! used[indices[i + c]] ) {
+				used[indices[i + c]] = true;
+				++numUsed;
+			}
+		}
+	}
+
+	result.acmr = float( misses ) / float( numIndices / 3 );
+	result.atvr = float( misses ) / float( numUsed );
+	return result;
+}
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": triangles are emitted greedily by the sum of their vertex scores, which favor vertices
+// recently used, and vertices with few remaining triangles so that none are left isolated. Only triangles of vertices in the cache are scored.
+void optimizeVertexCache( size_t numIndices, uint32_t *indices, size_t numVertices, size_t cacheSize )
+{
+	const size_t numTriangles = numIndices / 3;
+	if( numTriangles < 2 )
+		return;
+
+	cacheSize = std::max<size_t>( 4, std::min( cacheSize, MAX_CACHE_SIZE ) );
+
+	float cacheScores[MAX_CACHE_SIZE + 3];
+	for( size_t i = 0; i < cacheSize + 3; ++i ) {
+		if( i < 3 )
+			cacheScores[i] = 0.75f;
+		else if( i < cacheSize )
+			cacheScores[i] = std::pow( 1.0f - float( i - 3 ) / float( cacheSize - 3 ), 1.5f );
+		else
+			cacheScores[i] = 0;
+	}
+
+	float valenceScores[32];
+	for( int i = 1; i < 32; ++i )
+		valenceScores[i] = 2.0f / std::sqrt( float( i ) );
+
+	vector<uint32_t> adjacencyOffsets, adjacency;
+	buildAdjacency( numTriangles * 3, indices, numVertices, &adjacencyOffsets, &adjacency );
+
+	vector<uint32_t> remaining( numVertices );
+	vector<int> cachePositions( numVertices, -1 );
+	vector<float> vertexScores( numVertices );
+	auto calcVertexScore = [&]( uint32_t v ) {
+		if( remaining[v] == 0 )
+			return -1.0f;
+		const float valenceScore = ( remaining[v] < 32 ) ? valenceScores[remaining[v]] : 2.0f / std::sqrt( float( remaining[v] ) );
+		return ( ( cachePositions[v] >= 0 ) ? cacheScores[cachePositions[v]] : 0 ) + valenceScore;
+	};
+	for( size_t v = 0; v < numVertices; ++v ) {
+		remaining[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+		vertexScores[v] = calcVertexScore( (uint32_t)v );
+	}
+
+	vector<uint32_t> result( numTriangles * 3 );
+	vector<bool> emitted( numTriangles, false );
+	vector<uint32_t> cache, newCache;
+	cache.reserve( cacheSize + 3 );
+	newCache.reserve( cacheSize + 3 );
+
+	uint32_t best = 0;
+	size_t nextUnemitted = 0;
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		// at a dead end, continue with the first triangle not yet emitted
+		if( best == ~0u ) {
+			while( emitted[nextUnemitted] )
+				++nextUnemitted;
+			best = (uint32_t)nextUnemitted;
+		}
+
+		const uint32_t *triangle = indices + best * 3;
+		std::copy( triangle, triangle + 3, result.data() + t * 3 );
+		emitted[best] = true;
+
+		// remove the triangle from the live triangles of its vertices
+		for( int c = 0; c < 3; ++c ) {
+			const uint32_t v = triangle[c];
+			uint32_t *live = adjacency.data() + adjacencyOffsets[v];
+			uint32_t *found = std::find( live, live + remaining[v], best );
+			std::swap( *found, live[remaining[v] - 1] );
+			--remaining[v];
+		}
+
+		// move the triangle's vertices to the front of the cache
+		newCache.assign( triangle, triangle + 3 );
+		for( uint32_t v : cache ) {
+			if( v != triangle[0] && v != triangle[1] && v != triangle[2] )
+				newCache.push_back( v );
+		}
+		for( size_t i = 0; i < newCache.size(); ++i ) {
+			const uint32_t v = newCache[i];
+			cachePositions[v] = ( i < cacheSize ) ? (int)i : -1;
+			vertexScores[v] = calcVertexScore( v );
+		}
+		if( newCache.size() > cacheSize )
+			newCache.resize( cacheSize );
+		cache.swap( newCache );
+
+		// choose the best triangle using a vertex in the cache
+		best = ~0u;
+		float bestScore = -1;
+		for( uint32_t v : cache ) {
+			const uint32_t *live = adjacency.data() + adjacencyOffsets[v];
+			for( uint32_t i = 0; i < remaining[v]; ++i ) {
+				const uint32_t *candidate = indices + live[i] * 3;
+				const float score = vertexScores[candidate[0]] + vertexScores[candidate[1]] + vertexScores[candidate[2]];
+				if( score > bestScore ) {
+					bestScore = score;
+					best = live[i];
+				}
+			}
+		}
+	}
+
+	std::copy( result.begin(), result.end(), indices );
+}
+
+// Similar to meshoptimizer's overdraw optimizer: the triangles are split into clusters wherever the cache would be cleared anyway, and wherever the
+// cache miss ratio of the cluster so far is within threshold of that of the whole run. Clusters facing away from the center of the mesh are drawn first,
+// as they are the most likely to occlude others.
+void optimizeOverdraw( size_t numIndices, uint32_t *indices, size_t numVertices, const vec3 *positions, float threshold, size_t cacheSize )
+{
+	const size_t numTriangles = numIndices / 3;
+	if( numTriangles < 2 )
+		return;
+
+	// hard boundaries, where a triangle misses all 3 vertices
+	FifoCache cache( numVertices, cacheSize );
+	vector<size_t> hardBoundaries;
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		if( cache.addTriangle( indices + t * 3 ) == 3 )
+			hardBoundaries.push_back( t );
+	}
+	hardBoundaries.push_back( numTriangles );
+
+	// soft boundaries within each run
+	vector<size_t> clusters;
+	for( size_t h = 0; h + 1 < hardBoundaries.size(); ++h ) {
+		const size_t begin = hardBoundaries[h], end = hardBoundaries[h + 1];
+		cache.clear();
+		size_t misses = 0;
+		for( size_t t = begin; t < end; ++t )
+			misses += cache.addTriangle( indices + t * 3 );
+		const float clusterThreshold = threshold * float( misses ) / float( end - begin );
+
+		cache.clear();
+		clusters.push_back( begin );
+		size_t clusterBegin = begin;
+		misses = 0;
+		for( size_t t = begin; t + 1 < end; ++t ) {
+			misses += cache.addTriangle( indices + t * 3 );
+			if( float( misses ) <= clusterThreshold * float( t + 1 - clusterBegin ) ) {
+				clusters.push_back( t + 1 );
+				clusterBegin = t + 1;
+				misses = 0;
+				cache.clear();
+			}
+		}
+	}
+	clusters.push_back( numTriangles );
+
+	// area weighted centroids and normals
+	const size_t numClusters = clusters.size() - 1;
+	vector<vec3> centroids( numClusters ), normals( numClusters );
+	vector<float> areas( numClusters );
+	vec3 meshCentroid( 0 );
+	float meshArea = 0;
+	for( size_t c = 0; c < numClusters; ++c ) {
+		vec3 centroid( 0 ), normal( 0 );
+		float area = 0;
+		for( size_t t = clusters[c]; t < clusters[c + 1]; ++t ) {
+			const vec3 &p0 = positions[indices[t * 3 + 0]], &p1 = positions[indices[t * 3 + 1]], &p2 = positions[indices[t * 3 + 2]];
+			const vec3 n = cross( p1 - p0, p2 - p0 );
+			const float triangleArea = length( n );
+			centroid += ( p0 + p1 + p2 ) * ( triangleArea / 3.0f );
+			normal += n;
+			area += triangleArea;
+		}
+		centroids[c] = ( area > 0 ) ? centroid / area : vec3( 0 );
+		normals[c] = normal;
+		areas[c] = area;
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+	if( meshArea > 0 )
+		meshCentroid /= meshArea;
+
+	vector<float> keys( numClusters );
+	for( size_t c = 0; c < numClusters; ++c ) {
+		const float normalLength = length( normals[c] );
+		keys[c] = ( normalLength > 0 ) ? dot( centroids[c] - meshCentroid, normals[c] / normalLength ) : 0;
+	}
+
+	vector<uint32_t> order( numClusters );
+	for( size_t c = 0; c < numClusters; ++c )
+		order[c] = (uint32_t)c;
+	std::stable_sort( order.begin(), order.end(), [&]( uint32_t a, uint32_t b ) { return keys[a] > keys[b]; } );
+
+	vector<uint32_t> result;
+	result.reserve( numTriangles * 3 );
+	for( uint32_t c : order )
+		result.insert( result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3 );
+	std::copy( result.begin(), result.end(), indices );
+}
+
+size_t calculateVertexFetchRemap( size_t numIndices, const uint32_t *indices, size_t numVertices, std::vector<uint32_t> *resultRemap )
+{
+	resultRemap->assign( numVertices, ~0u );
+	uint32_t next = 0;
+	for( size_t i = 0; i < numIndices; ++i ) {
+		if( (*resultRemap)[indices[i]] == ~0u )
+			(*resultRemap)[indices[i]] = next++;
+	}
+
+	const size_t numUsed = next;
+	for( auto &index : *resultRemap ) {
+		if( index == ~0u )
+			index = next++;
+	}
+
+	return numUsed;
+}
+
+// Garland and Heckbert's quadric error metric simplification, collapsing each edge into one of its vertices so that the other attributes need not be
+// interpolated. Vertices which share their position with another vertex, such as those along texture seams, are never removed, and vertices on open
+// borders are only collapsed along the border. Collapses which would flip a triangle or join two surfaces are rejected.
+size_t simplify( size_t numIndices, const uint32_t *indices, size_t numVertices, const vec3 *positions, size_t targetNumIndices, float maxError, std::vector<uint32_t> *resultIndices, float *resultError )
+{
+	const size_t numTriangles = numIndices / 3;
+	vector<uint32_t> triangles( indices, indices + numTriangles * 3 );
+	if( resultError )
+		*resultError = 0;
+	if( targetNumIndices >= numTriangles * 3 ) {
+		resultIndices->swap( triangles );
+		return resultIndices->size();
+	}
+
+	// vertices with identical positions share a group, whose id is the lowest of their indices
+	struct PositionHash {
+		size_t operator()( const vec3 &p ) const
+		{
+			uint32_t bits[3];
+			memcpy( bits, &p, sizeof( bits ) );
+			return ( bits[0] * 73856093u ) ^ ( bits[1] * 19349663u ) ^ ( bits[2] * 83492791u );
+		}
+	};
+	vector<uint32_t> groups( numVertices ), groupSizes( numVertices, 0 );
+	{
+		unordered_map<vec3, uint32_t, PositionHash> firstVertex;
+		firstVertex.reserve( numVertices );
+		for( uint32_t v = 0; v < numVertices; ++v ) {
+			vec3 p = positions[v] + vec3( 0 ); // normalizes -0
+			groups[v] = firstVertex.emplace( p, v ).first->second;
+			++groupSizes[groups[v]];
+		}
+	}
+
+	// triangles using each group, and the quadrics of the planes of those triangles
+	vector<vector<uint32_t>> adjacency( numVertices );
+	vector<Quadric> quadrics( numVertices );
+	for( uint32_t t = 0; t < numTriangles; ++t ) {
+		const uint32_t *tri = triangles.data() + t * 3;
+		const vec3 &p0 = positions[tri[0]], &p1 = positions[tri[1]], &p2 = positions[tri[2]];
+		const dvec3 n = cross( dvec3( p1 - p0 ), dvec3( p2 - p0 ) );
+		const double area2 = length( n );
+		for( int c = 0; c < 3; ++c ) {
+			adjacency[groups[tri[c]]].push_back( t );
+			if( area2 > 0 )
+				quadrics[groups[tri[c]]].addPlane( n / area2, -dot( n / area2, dvec3( positions[tri[c]] ) ), area2 * 0.5 );
+		}
+	}
+
+	// open borders are edges used by a single triangle, which get a plane perpendicular to the triangle
+	vector<bool> border( numVertices, false );
+	{
+		auto edgeKey = []( uint32_t a, uint32_t b ) { return ( uint64_t( std::min( a, b ) ) << 32 ) | std::max( a, b ); };
+		unordered_map<uint64_t, uint32_t> edgeCounts;
+		edgeCounts.reserve( numTriangles * 3 );
+		for( size_t i = 0; i < numTriangles * 3; ++i )
+			++edgeCounts[edgeKey( groups[triangles[i]], groups[triangles[i - i % 3 + ( i + 1 ) % 3]] )];
+
+		for( size_t i = 0; i < numTriangles * 3; ++i ) {
+			const size_t first = i - i % 3;
+			const uint32_t a = groups[triangles[i]], b = groups[triangles[first + ( i + 1 ) % 3]];
+			if( a == b || edgeCounts[edgeKey( a, b )] != 1 )
+				continue;
+
+			const vec3 &p0 = positions[triangles[first]], &p1 = positions[triangles[first + 1]], &p2 = positions[triangles[first + 2]];
+			const dvec3 edge = dvec3( positions[b] ) - dvec3( positions[a] );
+			const dvec3 n = cross( edge, cross( dvec3( p1 - p0 ), dvec3( p2 - p0 ) ) );
+			const double nLength = length( n );
+			if( nLength > 0 ) {
+				const dvec3 plane = n / nLength;
+				const double weight = dot( edge, edge ) * BORDER_WEIGHT;
+				quadrics[a].addPlane( plane, -dot( plane, dvec3( positions[a] ) ), weight );
+				quadrics[b].addPlane( plane, -dot( plane, dvec3( positions[a] ) ), weight );
+			}
+			border[a] = border[b] = true;
+		}
+	}
+
+	vector<bool> removedTriangles( numTriangles, false );
+	vector<uint32_t> versions( numVertices, 0 );
+	vector<uint32_t> marks( numVertices, 0 );
+	uint32_t mark = 0;
+
+	auto containsGroup = [&]( uint32_t t, uint32_t group ) {
+		const uint32_t *tri = triangles.data() + t * 3;
+		return groups[tri[0]] == group || groups[tri[1]] == group || groups[tri[2]] == group;
+	};
+	// the number of triangles using both \a a and \a b
+	auto countSharedTriangles = [&]( uint32_t a, uint32_t b ) {
+		int count = 0;
+		for( uint32_t t : adjacency[a] )
+			count += ( ! removedTriangles[t] && containsGroup( t, b ) ) ? 1 : 0;
+		return count;
+	};
+
+	std::priority_queue<Collapse, vector<Collapse>, std::greater<Collapse>> queue;
+	auto pushCollapse = [&]( uint32_t from, uint32_t to ) {
+		const uint32_t fromGroup = groups[from], toGroup = groups[to];
+		if( fromGroup == toGroup || groupSizes[fromGroup] > 1 || ( border[fromGroup] && ! border[toGroup] ) )
+			return;
+		Quadric q = quadrics[fromGroup];
+		q += quadrics[toGroup];
+		queue.push( { (float)q.eval( positions[to] ), from, to, versions[fromGroup], versions[toGroup] } );
+	};
+
+	for( size_t i = 0; i < numTriangles * 3; ++i ) {
+		const uint32_t a = triangles[i], b = triangles[i - i % 3 + ( i + 1 ) % 3];
+		pushCollapse( a, b );
+		pushCollapse( b, a );
+	}
+
+	const double maxCost = double( maxError ) * double( maxError );
+	double resultCost = 0;
+	size_t numLive = numTriangles;
+	while( numLive * 3 > targetNumIndices && ! queue.empty() ) {
+		const Collapse collapse = queue.top();
+		queue.pop();
+
+		// a vertex is only removed with its group, as groups of more than one vertex are locked
+		const uint32_t from = collapse.mFrom, to = collapse.mTo, toGroup = groups[to];
+		if( versions[from] != collapse.mFromVersion || versions[toGroup] != collapse.mToVersion || adjacency[from].empty() )
+			continue;
+		if( collapse.mCost > maxCost )
+			break;
+
+		const int shared = countSharedTriangles( from, toGroup );
+		if( shared == 0 || ( border[from] && shared != 1 ) )
+			continue;
+
+		// the vertices adjacent to both ends must be those of the triangles which are removed, or two surfaces would be joined
+		++mark;
+		for( uint32_t t : adjacency[from] ) {
+			if( ! removedTriangles[t] )
+				for( int c = 0; c < 3; ++c )
+					marks[groups[triangles[t * 3 + c]]] = mark;
+		}
+		const uint32_t sharedMark = ++mark;
+		int numCommon = 0;
+		for( uint32_t t : adjacency[toGroup] ) {
+			if( removedTriangles[t] )
+				continue;
+			for( int c = 0; c < 3; ++c ) {
+				const uint32_t g = groups[triangles[t * 3 + c]];
+				if( g != from && g != toGroup && marks[g] == sharedMark - 1 ) {
+					marks[g] = sharedMark;
+					++numCommon;
+				}
+			}
+		}
+		if( numCommon != shared )
+			continue;
+
+		// reject collapses which would flip or squash a remaining triangle
+		bool flips = false;
+		for( uint32_t t : adjacency[from] ) {
+			if( removedTriangles[t] || containsGroup( t, toGroup ) )
+				continue;
+			const uint32_t *tri = triangles.data() + t * 3;
+			vec3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+			const vec3 before = cross( p[1] - p[0], p[2] - p[0] );
+			for( int c = 0; c < 3; ++c )
+				if( tri[c] == from )
+					p[c] = positions[to];
+			const vec3 after = cross( p[1] - p[0], p[2] - p[0] );
+			if( dot( before, after ) <= 0.25f * length( before ) * length( after ) && length2( before ) > 0 ) {
+				flips = true;
+				break;
+			}
+		}
+		if( flips )
+			continue;
+
+		// apply the collapse
+		for( uint32_t t : adjacency[from] ) {
+			if( removedTriangles[t] )
+				continue;
+			if( containsGroup( t, toGroup ) ) {
+				removedTriangles[t] = true;
+				--numLive;
+			}
+			else {
+				for( int c = 0; c < 3; ++c )
+					if( triangles[t * 3 + c] == from )
+						triangles[t * 3 + c] = to;
+				adjacency[toGroup].push_back( t );
+			}
+		}
+		adjacency[from].clear();
+		adjacency[from].shrink_to_fit();
+		quadrics[toGroup] += quadrics[from];
+		++versions[from];
+		++versions[toGroup];
+		resultCost = std::max( resultCost, (double)collapse.mCost );
+
+		// remove dead triangles, and requeue the edges around the vertex
+		auto &toAdjacency = adjacency[toGroup];
+		toAdjacency.erase( std::remove_if( toAdjacency.begin(), toAdjacency.end(), [&]( uint32_t t ) { return removedTriangles[t]; } ), toAdjacency.end() );
+		++mark;
+		for( uint32_t t : toAdjacency ) {
+			const uint32_t *tri = triangles.data() + t * 3;
+			for( int c = 0; c < 3; ++c ) {
+				if( groups[tri[c]] != toGroup )
+					continue;
+				// each neighbor is queued once, through the first triangle found which uses it
+				for( int n = 1; n < 3; ++n ) {
+					const uint32_t neighbor = tri[( c + n ) % 3];
+					if( marks[groups[neighbor]] != mark ) {
+						marks[groups[neighbor]] = mark;
+						pushCollapse( tri[c], neighbor );
+						pushCollapse( neighbor, tri[c] );
+					}
+				}
+			}
+		}
+	}
+
+	resultIndices->clear();
+	resultIndices->reserve( numLive * 3 );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		if( ! removedTriangles[t] )
+			resultIndices->insert( resultIndices->end(), triangles.begin() + t * 3, triangles.begin() + t * 3 + 3 );
+	}
+
+	if( resultError )
+		*resultError = (float)std::sqrt( resultCost );
+	return resultIndices->size();
+}
+
+} } // namespace cinder::geom
@@ -0,0 +1,1124 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/JsonDocument.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+const double sPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+inline bool isDigit( int c )
+{
+	return c >= '0' && c <= '9';
+}
+
+inline bool isWhitespace( int c )
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+int hexValue( int c )
+{
+	if( c >= '0' && c <= '9' ) return c - '0';
+	if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+	if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+	return -1;
+}
+
+// Writes \a codePoint as UTF-8 to \a dest, returning the number of bytes written
+size_t encodeUtf8( uint32_t codePoint, char *dest )
+{
+	if( codePoint < 0x80 ) {
+		dest[0] = (char)codePoint;
+		return 1;
+	}
+	else if( codePoint < 0x800 ) {
+		dest[0] = (char)( 0xC0 | ( codePoint >> 6 ) );
+		dest[1] = (char)( 0x80 | ( codePoint & 0x3F ) );
+		return 2;
+	}
+	else if( codePoint < 0x10000 ) {
+		dest[0] = (char)( 0xE0 | ( codePoint >> 12 ) );
+		dest[1] = (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+		dest[2] = (char)( 0x80 | ( codePoint & 0x3F ) );
+		return 3;
+	}
+	else {
+		dest[0] = (char)( 0xF0 | ( codePoint >> 18 ) );
+		dest[1] = (char)( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) );
+		dest[2] = (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+		dest[3] = (char)( 0x80 | ( codePoint & 0x3F ) );
+		return 4;
+	}
+}
+
+// Converts the validated JSON number in [begin, end) to a double and, when it is written as an integer which fits, an int64_t
+void convertNumber( const char *begin, const char *end, double *number, int64_t *integer, bool *isInteger )
+{
+	const char *s = begin;
+	bool negative = *s == '-';
+	if( negative )
+		++s;
+
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool overflow = false;
+	for( ; s < end && isDigit( *s ); ++s ) {
+		if( digits < 19 ) {
+			mantissa = mantissa * 10 + ( *s - '0' );
+			if( mantissa ) ++digits;
+		}
+		else {
+			overflow = true;
+			++exponent;
+		}
+	}
+	*isInteger = ( s == end ) && ( ! overflow ) && ( mantissa <= (uint64_t)numeric_limits<int64_t>::max() );
+	if( *isInteger ) {
+		*integer = negative ? -(int64_t)mantissa : (int64_t)mantissa;
+		*number = (double)*integer;
+		return;
+	}
+
+	if( s < end && *s == '.' ) {
+		for( ++s; s < end && isDigit( *s ); ++s ) {
+			if( digits < 19 ) {
+				mantissa = mantissa * 10 + ( *s - '0' );
+				if( mantissa ) ++digits;
+				--exponent;
+			}
+			else
+				overflow = true;
+		}
+	}
+	if( s < end && ( *s == 'e' || *s == 'E' ) ) {
+		++s;
+		bool negativeExponent = *s == '-';
+		if( *s == '-' || *s == '+' )
+			++s;
+		int explicitExponent = 0;
+		for( ; s < end && isDigit( *s ); ++s )
+			explicitExponent = std::min( explicitExponent * 10 + ( *s - '0' ), 100000 );
+		exponent += negativeExponent ? -explicitExponent : explicitExponent;
+	}
+
+	// mantissas below 2^53 scaled by an exactly representable power of ten are correctly rounded; anything else defers to strtod
+	if( ( ! overflow ) && mantissa < ( 1ULL << 53 ) && exponent >= -22 && exponent <= 22 ) {
+		double value = (double)mantissa;
+		value = ( exponent < 0 ) ? value / sPowersOf10[-exponent] : value * sPowersOf10[exponent];
+		*number = negative ? -value : value;
+	}
+	else
+		*number = strtod( string( begin, end ).c_str(), nullptr );
+
+	// the conversion is only defined within the range of int64_t, so values beyond it (up to 1e308, or infinity) are clamped
+	const double integerLimit = 9223372036854775808.0; // 2^63
+	if( *number >= integerLimit )
+		*integer = numeric_limits<int64_t>::max();
+	else if( *number < -integerLimit )
+		*integer = numeric_limits<int64_t>::min();
+	else
+		*integer = (int64_t)*number;
+}
+
+string makeErrorMessage( const char *message, size_t line, size_t column )
+{
+	return "Line " + toString( line ) + ", Column " + toString( column ) + "\n  " + message;
+}
+
+struct ParseError {
+	ParseError( const char *message, const char *pos ) : mMessage( message ), mPos( pos ) {}
+
+	const char	*mMessage;
+	const char	*mPos;
+};
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonDocument::Node
+
+const JsonDocument::NodeData& JsonDocument::Node::getData() const
+{
+	return mNodes[mIndex];
+}
+
+JsonDocument::Node::ConstIter& JsonDocument::Node::ConstIter::operator++()
+{
+	mIndex = mNodes[mIndex].mNext;
+	return *this;
+}
+
+JsonTree::NodeType JsonDocument::Node::getNodeType() const
+{
+	switch( getData().mType ) {
+		case TYPE_NULL:		return JsonTree::NODE_NULL;
+		case TYPE_ARRAY:	return JsonTree::NODE_ARRAY;
+		case TYPE_OBJECT:	return JsonTree::NODE_OBJECT;
+		default:			return JsonTree::NODE_VALUE;
+	}
+}
+
+bool JsonDocument::Node::isNull() const		{ return getData().mType == TYPE_NULL; }
+bool JsonDocument::Node::isBool() const		{ return getData().mType == TYPE_BOOL; }
+bool JsonDocument::Node::isNumber() const	{ return getData().mType == TYPE_NUMBER; }
+bool JsonDocument::Node::isString() const	{ return getData().mType == TYPE_STRING; }
+bool JsonDocument::Node::isArray() const	{ return getData().mType == TYPE_ARRAY; }
+bool JsonDocument::Node::isObject() const	{ return getData().mType == TYPE_OBJECT; }
+
+string JsonDocument::Node::getKey() const
+{
+	const NodeData &data = getData();
+	return string( data.mKey, data.mKeyLength );
+}
+
+const char* JsonDocument::Node::getKeyData() const
+{
+	return getData().mKey;
+}
+
+size_t JsonDocument::Node::getKeyLength() const
+{
+	return getData().mKeyLength;
+}
+
+string JsonDocument::Node::getValue() const
+{
+	const NodeData &data = getData();
+	return string( data.mValue, data.mValueLength );
+}
+
+const char* JsonDocument::Node::getValueData() const
+{
+	return getData().mValue;
+}
+
+size_t JsonDocument::Node::getValueLength() const
+{
+	return getData().mValueLength;
+}
+
+void JsonDocument::Node::throwNonConvertible() const
+{
+	throw JsonTree::ExcNonConvertible( toJsonTree() );
+}
+
+void JsonDocument::Node::getValueImpl( bool *result ) const
+{
+	const NodeData &data = getData();
+	if( data.mType == TYPE_BOOL )
+		*result = data.mBool;
+	else if( data.mType == TYPE_NUMBER )
+		*result = data.mNumber != 0;
+	else
+		throwNonConvertible();
+}
+
+void JsonDocument::Node::getValueImpl( int32_t *result ) const
+{
+	int64_t value;
+	getValueImpl( &value );
+	*result = (int32_t)value;
+}
+
+void JsonDocument::Node::getValueImpl( uint32_t *result ) const
+{
+	int64_t value;
+	getValueImpl( &value );
+	*result = (uint32_t)value;
+}
+
+void JsonDocument::Node::getValueImpl( int64_t *result ) const
+{
+	const NodeData &data = getData();
+	if( data.mType == TYPE_NUMBER )
+		*result = data.mInteger;
+	else if( data.mType == TYPE_BOOL )
+		*result = data.mBool ? 1 : 0;
+	else
+		getValueImpl<int64_t>( result );
+}
+
+void JsonDocument::Node::getValueImpl( uint64_t *result ) const
+{
+	const NodeData &data = getData();
+	if( data.mType == TYPE_NUMBER && ( data.mIsInteger || data.mNumber < 0 ) )
+		*result = (uint64_t)data.mInteger;
+	else if( data.mType == TYPE_NUMBER )
+		*result = ( data.mNumber >= 18446744073709551616.0 ) ? numeric_limits<uint64_t>::max() : (uint64_t)data.mNumber; // clamped at 2^64
+	else if( data.mType == TYPE_BOOL )
+		*result = data.mBool ? 1 : 0;
+	else
+		getValueImpl<uint64_t>( result );
+}
+
+void JsonDocument::Node::getValueImpl( float *result ) const
+{
+	double value;
+	getValueImpl( &value );
+	*result = (float)value;
+}
+
+void JsonDocument::Node::getValueImpl( double *result ) const
+{
+	const NodeData &data = getData();
+	if( data.mType == TYPE_NUMBER )
+		*result = data.mNumber;
+	else if( data.mType == TYPE_BOOL )
+		*result = data.mBool ? 1 : 0;
+	else
+		getValueImpl<double>( result );
+}
+
+size_t JsonDocument::Node::getNumChildren() const
+{
+	return getData().mNumChildren;
+}
+
+JsonDocument::Node::ConstIter JsonDocument::Node::begin() const
+{
+	const NodeData &data = getData();
+	return ConstIter( mNodes, data.mNumChildren ? mIndex + 1 : data.mNext );
+}
+
+JsonDocument::Node::ConstIter JsonDocument::Node::end() const
+{
+	return ConstIter( mNodes, getData().mNext );
+}
+
+bool JsonDocument::Node::findChild( const std::string &relativePath, bool caseSensitive, char separator, uint32_t *result ) const
+{
+	// paths follow JsonTree: components are separated by 'separator', and "[2]" or "['key']" are equivalent to ".2" and ".key"
+	uint32_t current = mIndex;
+	const char *s = relativePath.c_str();
+	const char *end = s + relativePath.size();
+	while( s < end ) {
+		while( s < end && ( *s == separator || *s == '[' || *s == ']' || *s == '\'' ) )
+			++s;
+		const char *componentBegin = s;
+		while( s < end && *s != separator && *s != '[' && *s != ']' && *s != '\'' )
+			++s;
+		size_t componentLength = s - componentBegin;
+		if( componentLength == 0 )
+			break;
+
+		bool isIndex = true;
+		uint64_t index = 0;
+		for( const char *c = componentBegin; c < s; ++c ) {
+			if( ! isDigit( *c ) ) {
+				isIndex = false;
+				break;
+			}
+			index = std::min<uint64_t>( index * 10 + ( *c - '0' ), numeric_limits<uint32_t>::max() );
+		}
+
+		const NodeData &parent = mNodes[current];
+		uint32_t child = current + 1;
+		bool found = false;
+		for( uint32_t i = 0; i < parent.mNumChildren; ++i, child = mNodes[child].mNext ) {
+			const NodeData &childData = mNodes[child];
+			if( isIndex ) {
+				found = ( i == index );
+			}
+			else if( childData.mKeyLength == componentLength ) {
+				if( caseSensitive )
+					found = memcmp( childData.mKey, componentBegin, componentLength ) == 0;
+				else {
+					found = true;
+					for( size_t c = 0; c < componentLength && found; ++c )
+						found = tolower( (unsigned char)childData.mKey[c] ) == tolower( (unsigned char)componentBegin[c] );
+				}
+			}
+			if( found )
+				break;
+		}
+		if( ! found )
+			return false;
+		current = child;
+	}
+
+	*result = current;
+	return true;
+}
+
+JsonDocument::Node JsonDocument::Node::getChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	uint32_t index;
+	if( ! findChild( relativePath, caseSensitive, separator, &index ) )
+		throw JsonTree::ExcChildNotFound( JsonTree::makeObject( getKey() ), relativePath );
+	return Node( mNodes, index );
+}
+
+JsonDocument::Node JsonDocument::Node::getChild( size_t index ) const
+{
+	const NodeData &data = getData();
+	if( index >= data.mNumChildren )
+		throw JsonTree::ExcChildNotFound( JsonTree::makeObject( getKey() ), toString( index ) );
+
+	uint32_t child = mIndex + 1;
+	for( size_t i = 0; i < index; ++i )
+		child = mNodes[child].mNext;
+	return Node( mNodes, child );
+}
+
+bool JsonDocument::Node::hasChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	uint32_t index;
+	return findChild( relativePath, caseSensitive, separator, &index );
+}
+
+JsonTree JsonDocument::Node::toJsonTree() const
+{
+	JsonTree result;
+	buildTree( mNodes, mIndex, &result );
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonDocument
+
+JsonDocument::JsonDocument()
+	: mText( new char[1] ), mTextSize( 0 )
+{
+	mText[0] = 0;
+	parse( JsonTree::ParseOptions().ignoreErrors() );
+}
+
+JsonDocument::JsonDocument( const DataSourceRef &dataSource, const JsonTree::ParseOptions &parseOptions )
+{
+	BufferRef buffer = dataSource->getBuffer();
+	mTextSize = buffer->getSize();
+	mText.reset( new char[mTextSize + 1] );
+	memcpy( mText.get(), buffer->getData(), mTextSize );
+	mText[mTextSize] = 0;
+	parse( parseOptions );
+}
+
+JsonDocument::JsonDocument( const std::string &jsonString, const JsonTree::ParseOptions &parseOptions )
+	: JsonDocument( jsonString.data(), jsonString.size(), parseOptions )
+{
+}
+
+JsonDocument::JsonDocument( const char *data, size_t size, const JsonTree::ParseOptions &parseOptions )
+	: mText( new char[size + 1] ), mTextSize( size )
+{
+	memcpy( mText.get(), data, size );
+	mText[size] = 0;
+	parse( parseOptions );
+}
+
+void JsonDocument::parse( const JsonTree::ParseOptions &parseOptions )
+{
+	static const char sEmpty[] = "";
+
+	mNodes.clear();
+	// a rough estimate of one node per 16 bytes of text avoids most reallocation for typical documents
+	mNodes.reserve( mTextSize / 16 + 1 );
+
+	char *p = mText.get();
+	char *end = p + mTextSize;
+	const bool allowComments = parseOptions.getAllowComments();
+	vector<uint32_t> stack;
+
+	auto skipWhitespace = [&]() {
+		for(;;) {
+			while( isWhitespace( *p ) )
+				++p;
+			if( allowComments && p[0] == '/' && p[1] == '/' ) {
+				while( p < end && *p != '\n' )
+					++p;
+			}
+			else if( allowComments && p[0] == '/' && p[1] == '*' ) {
+				const char *commentBegin = p;
+				for( p += 2; p < end && ! ( p[0] == '*' && p[1] == '/' ); ++p )
+					;
+				if( p >= end )
+					throw ParseError( "Unterminated comment", commentBegin );
+				p += 2;
+			}
+			else
+				break;
+		}
+	};
+
+	// unescapes the string beginning after the opening quote at 'p' in place, null-terminates it and advances past the closing quote
+	auto parseString = [&]( const char **result, uint32_t *length ) {
+		char *dest = p;
+		*result = p;
+		for(;;) {
+			char c = *p;
+			if( c == '"' ) {
+				++p;
+				break;
+			}
+			else if( c == '\\' ) {
+				const char *escapeBegin = p;
+				switch( p[1] ) {
+					case '"': *dest++ = '"'; break;
+					case '\\': *dest++ = '\\'; break;
+					case '/': *dest++ = '/'; break;
+					case 'b': *dest++ = '\b'; break;
+					case 'f': *dest++ = '\f'; break;
+					case 'n': *dest++ = '\n'; break;
+					case 'r': *dest++ = '\r'; break;
+					case 't': *dest++ = '\t'; break;
+					case 'u': {
+						uint32_t codePoint = 0;
+						for( int i = 2; i < 6; ++i ) {
+							int h = hexValue( p[i] );
+							if( h < 0 )
+								throw ParseError( "Bad unicode escape sequence in string", escapeBegin );
+							codePoint = ( codePoint << 4 ) | h;
+						}
+						p += 4;
+						if( codePoint >= 0xD800 && codePoint <= 0xDBFF ) { // surrogate pair
+							uint32_t low = 0;
+							if( p[2] != '\\' || p[3] != 'u' )
+								throw ParseError( "Expected a low surrogate after a high surrogate in string", escapeBegin );
+							for( int i = 4; i < 8; ++i ) {
+								int h = hexValue( p[i] );
+								if( h < 0 )
+									throw ParseError( "Bad unicode escape sequence in string", escapeBegin );
+								low = ( low << 4 ) | h;
+							}
+							if( low < 0xDC00 || low > 0xDFFF )
+								throw ParseError( "Expected a low surrogate after a high surrogate in string", escapeBegin );
+							codePoint = 0x10000 + ( ( codePoint - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+							p += 6;
+						}
+						else if( codePoint >= 0xDC00 && codePoint <= 0xDFFF )
+							throw ParseError( "Unexpected low surrogate without a preceding high surrogate in string", escapeBegin );
+						dest += encodeUtf8( codePoint, dest );
+					}
+					break;
+					default:
+						throw ParseError( "Bad escape sequence in string", escapeBegin );
+				}
+				p += 2;
+			}
+			else if( p >= end )
+				throw ParseError( "Missing '\"' at the end of string", *result - 1 );
+			else
+				*dest++ = *p++;
+		}
+		*dest = 0;
+		*length = (uint32_t)( dest - *result );
+	};
+
+	auto expectLiteral = [&]( const char *literal, size_t length ) {
+		if( (size_t)( end - p ) < length || strncmp( p, literal, length ) != 0 )
+			throw ParseError( "Syntax error: value, object or array expected", p );
+		p += length;
+	};
+
+	const char *key = sEmpty;
+	uint32_t keyLength = 0;
+	bool nodeIncomplete = false;
+	try {
+		skipWhitespace();
+		for(;;) {
+			// parse a value, named by 'key' when its parent is an object
+			uint32_t index = (uint32_t)mNodes.size();
+			mNodes.push_back( NodeData() );
+			NodeData *node = &mNodes.back();
+			node->mKey = key;
+			node->mKeyLength = keyLength;
+			node->mValue = sEmpty;
+			node->mValueLength = 0;
+			node->mNumChildren = 0;
+			node->mNext = index + 1;
+			node->mBool = node->mIsInteger = false;
+			node->mNumber = 0;
+			node->mInteger = 0;
+			if( ! stack.empty() )
+				++mNodes[stack.back()].mNumChildren;
+			nodeIncomplete = true;
+
+			bool openedContainer = false;
+			const char *valueBegin = p;
+			switch( *p ) {
+				case '{':
+				case '[':
+					node->mType = ( *p == '{' ) ? TYPE_OBJECT : TYPE_ARRAY;
+					stack.push_back( index );
+					openedContainer = true;
+					++p;
+				break;
+				case '"':
+					++p;
+					node->mType = TYPE_STRING;
+					parseString( &node->mValue, &node->mValueLength );
+				break;
+				case 't':
+					expectLiteral( "true", 4 );
+					node->mType = TYPE_BOOL;
+					node->mBool = true;
+					node->mNumber = 1;
+					node->mInteger = 1;
+				break;
+				case 'f':
+					expectLiteral( "false", 5 );
+					node->mType = TYPE_BOOL;
+				break;
+				case 'n':
+					expectLiteral( "null", 4 );
+					node->mType = TYPE_NULL;
+				break;
+				default: {
+					if( *p == '-' )
+						++p;
+					if( *p == '0' )
+						++p;
+					else if( isDigit( *p ) ) {
+						while( isDigit( *p ) ) ++p;
+					}
+					else
+						throw ParseError( "Syntax error: value, object or array expected", valueBegin );
+					if( *p == '.' ) {
+						++p;
+						if( ! isDigit( *p ) )
+							throw ParseError( "Bad number: expected a digit after the decimal point", valueBegin );
+						while( isDigit( *p ) ) ++p;
+					}
+					if( *p == 'e' || *p == 'E' ) {
+						++p;
+						if( *p == '-' || *p == '+' )
+							++p;
+						if( ! isDigit( *p ) )
+							throw ParseError( "Bad number: expected a digit in the exponent", valueBegin );
+						while( isDigit( *p ) ) ++p;
+					}
+					node->mType = TYPE_NUMBER;
+					node->mValue = valueBegin;
+					node->mValueLength = (uint32_t)( p - valueBegin );
+					convertNumber( valueBegin, p, &node->mNumber, &node->mInteger, &node->mIsInteger );
+				}
+			}
+
+			nodeIncomplete = false;
+
+			// after a value, close any containers which end here, then read the separator and the next member's key
+			bool done = false;
+			bool expectMember = openedContainer;
+			for(;;) {
+				skipWhitespace();
+				if( stack.empty() ) {
+					done = true;
+					break;
+				}
+				NodeData &parent = mNodes[stack.back()];
+				char closer = ( parent.mType == TYPE_OBJECT ) ? '}' : ']';
+				if( *p == closer ) {
+					++p;
+					parent.mNext = (uint32_t)mNodes.size();
+					stack.pop_back();
+					expectMember = false;
+					continue;
+				}
+				if( ! expectMember ) {
+					if( *p != ',' )
+						throw ParseError( ( parent.mType == TYPE_OBJECT ) ? "Missing ',' or '}' in object declaration" : "Missing ',' or ']' in array declaration", p );
+					++p;
+					skipWhitespace();
+				}
+				if( parent.mType == TYPE_OBJECT ) {
+					if( *p != '"' )
+						throw ParseError( "Missing '}' or object member name", p );
+					++p;
+					parseString( &key, &keyLength );
+					skipWhitespace();
+					if( *p != ':' )
+						throw ParseError( "Missing ':' after object member name", p );
+					++p;
+					skipWhitespace();
+				}
+				else {
+					key = sEmpty;
+					keyLength = 0;
+				}
+				break;
+			}
+			if( done )
+				break;
+		}
+
+		if( p < end && ! parseOptions.getIgnoreErrors() )
+			throw ParseError( "Extra non-whitespace after JSON value", p );
+	}
+	catch( const ParseError &error ) {
+		if( ! parseOptions.getIgnoreErrors() ) {
+			size_t line = 1, column = 1;
+			for( const char *c = mText.get(); c < error.mPos && c < end; ++c ) {
+				if( *c == '\n' ) {
+					++line;
+					column = 1;
+				}
+				else
+					++column;
+			}
+			throw JsonTree::ExcJsonParserError( makeErrorMessage( error.mMessage, line, column ) );
+		}
+
+		// keep what was parsed, dropping the value which failed and closing any open containers
+		if( nodeIncomplete ) {
+			mNodes.pop_back();
+			if( ! stack.empty() )
+				--mNodes[stack.back()].mNumChildren;
+		}
+		for( uint32_t index : stack )
+			mNodes[index].mNext = (uint32_t)mNodes.size();
+		if( mNodes.empty() ) {
+			NodeData root = NodeData();
+			root.mType = TYPE_NULL;
+			root.mKey = root.mValue = sEmpty;
+			root.mNext = 1;
+			mNodes.push_back( root );
+		}
+	}
+}
+
+// static
+void JsonDocument::buildTree( const NodeData *nodes, uint32_t index, JsonTree *result )
+{
+	const NodeData &node = nodes[index];
+	result->mKey.assign( node.mKey, node.mKeyLength );
+	result->mValue.assign( node.mValue, node.mValueLength );
+	switch( node.mType ) {
+		case TYPE_NULL:
+			result->mNodeType = JsonTree::NODE_NULL;
+			result->mValueType = JsonTree::VALUE_STRING;
+		break;
+		case TYPE_BOOL:
+			result->mNodeType = JsonTree::NODE_VALUE;
+			result->mValueType = JsonTree::VALUE_BOOL;
+			result->mValue = toString( node.mBool );
+		break;
+		case TYPE_NUMBER:
+			result->mNodeType = JsonTree::NODE_VALUE;
+			result->mValueType = node.mIsInteger ? JsonTree::VALUE_INT : JsonTree::VALUE_DOUBLE;
+		break;
+		case TYPE_STRING:
+			result->mNodeType = JsonTree::NODE_VALUE;
+			result->mValueType = JsonTree::VALUE_STRING;
+		break;
+		case TYPE_ARRAY:
+		case TYPE_OBJECT: {
+			result->mNodeType = ( node.mType == TYPE_ARRAY ) ? JsonTree::NODE_ARRAY : JsonTree::NODE_OBJECT;
+			result->mValueType = JsonTree::VALUE_STRING;
+			uint32_t child = index + 1;
+			for( uint32_t i = 0; i < node.mNumChildren; ++i, child = nodes[child].mNext ) {
+				result->mChildren.emplace_back();
+				buildTree( nodes, child, &result->mChildren.back() );
+				result->mChildren.back().mParent = result;
+			}
+		}
+		break;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonReader
+
+JsonReader::JsonReader( const DataSourceRef &dataSource, const JsonTree::ParseOptions &parseOptions )
+	: JsonReader( dataSource->createStream(), parseOptions )
+{
+}
+
+JsonReader::JsonReader( const IStreamRef &stream, const JsonTree::ParseOptions &parseOptions )
+	: mStream( stream ), mParseOptions( parseOptions ), mBuffer( 64 * 1024 ), mBufferOffset( 0 ),
+	mState( STATE_VALUE ), mToken( TOKEN_NONE ), mNumber( 0 ), mInteger( 0 ), mIsInteger( false ), mBool( false )
+{
+	mPos = mEnd = mBuffer.data();
+}
+
+bool JsonReader::refill()
+{
+	mBufferOffset += mEnd - mBuffer.data();
+	mPos = mEnd = mBuffer.data();
+	if( mStream->isEof() )
+		return false;
+
+	size_t bytesRead = mStream->readDataAvailable( mBuffer.data(), mBuffer.size() );
+	mEnd = mBuffer.data() + bytesRead;
+	return bytesRead > 0;
+}
+
+void JsonReader::throwError( const char *message )
+{
+	mState = STATE_END;
+	mToken = TOKEN_END;
+	if( ! mParseOptions.getIgnoreErrors() )
+		throw JsonTree::ExcJsonParserError( "Offset " + toString( getOffset() ) + "\n  " + message );
+}
+
+void JsonReader::skipWhitespace()
+{
+	for(;;) {
+		int c = peek();
+		if( isWhitespace( c ) )
+			++mPos;
+		else if( c == '/' && mParseOptions.getAllowComments() ) {
+			++mPos;
+			c = peek();
+			if( c == '/' ) {
+				while( ( c = peek() ) >= 0 && c != '\n' )
+					++mPos;
+			}
+			else if( c == '*' ) {
+				++mPos;
+				int prev = 0;
+				while( ( c = peek() ) >= 0 && ! ( prev == '*' && c == '/' ) ) {
+					prev = c;
+					++mPos;
+				}
+				if( c < 0 )
+					return throwError( "Unterminated comment" );
+				++mPos;
+			}
+			else
+				return throwError( "Syntax error: value, object or array expected" );
+		}
+		else
+			return;
+	}
+}
+
+JsonReader::State JsonReader::stateAfterValue() const
+{
+	if( mStack.empty() )
+		return STATE_END;
+	return mStack.back() ? STATE_OBJECT_NEXT : STATE_ARRAY_NEXT;
+}
+
+JsonReader::Token JsonReader::next()
+{
+	if( mState == STATE_END ) {
+		if( mToken != TOKEN_END ) {
+			skipWhitespace();
+			if( mToken != TOKEN_END && peek() >= 0 )
+				throwError( "Extra non-whitespace after JSON value" );
+		}
+		return mToken = TOKEN_END;
+	}
+
+	skipWhitespace();
+	if( mState == STATE_END )
+		return mToken;
+
+	int c = peek();
+	switch( mState ) {
+		case STATE_OBJECT_FIRST:
+			if( c == '}' )
+				return endContainer();
+			return readKey();
+		case STATE_OBJECT_NEXT:
+			if( c == '}' )
+				return endContainer();
+			if( c != ',' ) {
+				throwError( "Missing ',' or '}' in object declaration" );
+				return mToken;
+			}
+			++mPos;
+			skipWhitespace();
+			return readKey();
+		case STATE_ARRAY_FIRST:
+			if( c == ']' )
+				return endContainer();
+			return readValue();
+		case STATE_ARRAY_NEXT:
+			if( c == ']' )
+				return endContainer();
+			if( c != ',' ) {
+				throwError( "Missing ',' or ']' in array declaration" );
+				return mToken;
+			}
+			++mPos;
+			skipWhitespace();
+			return readValue();
+		default:
+			return readValue();
+	}
+}
+
+JsonReader::Token JsonReader::endContainer()
+{
+	++mPos;
+	bool wasObject = mStack.back();
+	mStack.pop_back();
+	mState = stateAfterValue();
+	return mToken = wasObject ? TOKEN_END_OBJECT : TOKEN_END_ARRAY;
+}
+
+JsonReader::Token JsonReader::readKey()
+{
+	if( peek() != '"' ) {
+		throwError( "Missing '}' or object member name" );
+		return mToken;
+	}
+	++mPos;
+	readString( &mKey );
+	mString = mKey;
+	skipWhitespace();
+	if( mToken != TOKEN_END ) {
+		if( peek() != ':' ) {
+			throwError( "Missing ':' after object member name" );
+			return mToken;
+		}
+		++mPos;
+		mState = STATE_VALUE;
+		mToken = TOKEN_KEY;
+	}
+	return mToken;
+}
+
+JsonReader::Token JsonReader::readValue()
+{
+	switch( peek() ) {
+		case '{':
+		case '[':
+			mStack.push_back( *mPos == '{' );
+			mState = mStack.back() ? STATE_OBJECT_FIRST : STATE_ARRAY_FIRST;
+			++mPos;
+			return mToken = mStack.back() ? TOKEN_BEGIN_OBJECT : TOKEN_BEGIN_ARRAY;
+		case '"':
+			++mPos;
+			mToken = TOKEN_STRING;
+			readString( &mString );
+		break;
+		case 't':
+			mToken = TOKEN_BOOL;
+			mBool = true;
+			readLiteral( "true" );
+		break;
+		case 'f':
+			mToken = TOKEN_BOOL;
+			mBool = false;
+			readLiteral( "false" );
+		break;
+		case 'n':
+			mToken = TOKEN_NULL;
+			readLiteral( "null" );
+		break;
+		default:
+			mToken = TOKEN_NUMBER;
+			readNumber();
+	}
+
+	if( mState != STATE_END || mToken != TOKEN_END )
+		mState = stateAfterValue();
+	return mToken;
+}
+
+void JsonReader::readLiteral( const char *literal )
+{
+	for( const char *l = literal; *l; ++l ) {
+		if( peek() != *l )
+			return throwError( "Syntax error: value, object or array expected" );
+		++mPos;
+	}
+}
+
+void JsonReader::readNumber()
+{
+	mString.clear();
+	int c = peek();
+	auto take = [&]() { mString.push_back( (char)c ); ++mPos; c = peek(); };
+
+	if( c == '-' )
+		take();
+	if( c == '0' )
+		take();
+	else if( isDigit( c ) ) {
+		while( isDigit( c ) ) take();
+	}
+	else
+		return throwError( "Syntax error: value, object or array expected" );
+	if( c == '.' ) {
+		take();
+		if( ! isDigit( c ) )
+			return throwError( "Bad number: expected a digit after the decimal point" );
+		while( isDigit( c ) ) take();
+	}
+	if( c == 'e' || c == 'E' ) {
+		take();
+		if( c == '-' || c == '+' )
+			take();
+		if( ! isDigit( c ) )
+			return throwError( "Bad number: expected a digit in the exponent" );
+		while( isDigit( c ) ) take();
+	}
+
+	convertNumber( mString.data(), mString.data() + mString.size(), &mNumber, &mInteger, &mIsInteger );
+}
+
+void JsonReader::readString( std::string *result )
+{
+	result->clear();
+	for(;;) {
+		// copy runs of plain characters directly from the buffer
+		const char *runBegin = mPos;
+		while( mPos < mEnd && *mPos != '"' && *mPos != '\\' )
+			++mPos;
+		result->append( runBegin, mPos );
+
+		int c = peek();
+		if( c < 0 )
+			return throwError( "Missing '\"' at the end of string" );
+		if( c != '"' && c != '\\' )
+			continue; // the buffer was refilled
+		++mPos;
+		if( c == '"' )
+			return;
+
+		c = peek();
+		if( c < 0 )
+			return throwError( "Missing '\"' at the end of string" );
+		++mPos;
+		switch( c ) {
+			case '"': result->push_back( '"' ); break;
+			case '\\': result->push_back( '\\' ); break;
+			case '/': result->push_back( '/' ); break;
+			case 'b': result->push_back( '\b' ); break;
+			case 'f': result->push_back( '\f' ); break;
+			case 'n': result->push_back( '\n' ); break;
+			case 'r': result->push_back( '\r' ); break;
+			case 't': result->push_back( '\t' ); break;
+			case 'u': {
+				auto readHex4 = [&]( uint32_t *value ) {
+					*value = 0;
+					for( int i = 0; i < 4; ++i ) {
+						int h = hexValue( peek() );
+						if( h < 0 )
+							return false;
+						*value = ( *value << 4 ) | h;
+						++mPos;
+					}
+					return true;
+				};
+				uint32_t codePoint, low;
+				if( ! readHex4( &codePoint ) )
+					return throwError( "Bad unicode escape sequence in string" );
+				if( codePoint >= 0xD800 && codePoint <= 0xDBFF ) {
+					if( peek() != '\\' )
+						return throwError( "Expected a low surrogate after a high surrogate in string" );
+					++mPos;
+					if( peek() != 'u' )
+						return throwError( "Expected a low surrogate after a high surrogate in string" );
+					++mPos;
+					if( ! readHex4( &low ) || low < 0xDC00 || low > 0xDFFF )
+						return throwError( "Expected a low surrogate after a high surrogate in string" );
+					codePoint = 0x10000 + ( ( codePoint - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+				}
+				else if( codePoint >= 0xDC00 && codePoint <= 0xDFFF )
+					return throwError( "Unexpected low surrogate without a preceding high surrogate in string" );
+				char utf8[4];
+				result->append( utf8, encodeUtf8( codePoint, utf8 ) );
+			}
+			break;
+			default:
+				return throwError( "Bad escape sequence in string" );
+		}
+	}
+}
+
+void JsonReader::skip()
+{
+	if( mToken == TOKEN_KEY || mToken == TOKEN_NONE )
+		next();
+	if( mToken == TOKEN_BEGIN_OBJECT || mToken == TOKEN_BEGIN_ARRAY ) {
+		size_t depth = mStack.size();
+		while( mStack.size() >= depth && mToken != TOKEN_END )
+			next();
+	}
+}
+
+JsonTree JsonReader::readTree()
+{
+	JsonTree result;
+	readTree( &result );
+	return result;
+}
+
+void JsonReader::readTree( JsonTree *result )
+{
+	string key;
+	if( mToken == TOKEN_KEY ) {
+		key = mKey;
+		next();
+	}
+	else if( mToken == TOKEN_NONE )
+		next();
+	else if( mStack.size() > ( ( mToken == TOKEN_BEGIN_OBJECT || mToken == TOKEN_BEGIN_ARRAY ) ? 1u : 0u ) ) {
+		// the enclosing container is the one below any container this token just opened
+		size_t parentIndex = mStack.size() - ( ( mToken == TOKEN_BEGIN_OBJECT || mToken == TOKEN_BEGIN_ARRAY ) ? 2 : 1 );
+		if( mStack[parentIndex] )
+			key = mKey;
+	}
+
+	result->mKey = key;
+	result->mValueType = JsonTree::VALUE_STRING;
+	switch( mToken ) {
+		case TOKEN_BEGIN_OBJECT:
+		case TOKEN_BEGIN_ARRAY:
+			result->mNodeType = ( mToken == TOKEN_BEGIN_OBJECT ) ? JsonTree::NODE_OBJECT : JsonTree::NODE_ARRAY;
+			for(;;) {
+				Token token = next();
+				if( token == TOKEN_END_OBJECT || token == TOKEN_END_ARRAY || token == TOKEN_END )
+					break;
+				// children are constructed in place, as copying a JsonTree copies all of its descendants
+				result->mChildren.emplace_back();
+				readTree( &result->mChildren.back() );
+				result->mChildren.back().mParent = result;
+			}
+		break;
+		case TOKEN_STRING:
+			result->mNodeType = JsonTree::NODE_VALUE;
+			result->mValue = mString;
+		break;
+		case TOKEN_NUMBER:
+			result->mNodeType = JsonTree::NODE_VALUE;
+			result->mValueType = mIsInteger ? JsonTree::VALUE_INT : JsonTree::VALUE_DOUBLE;
+			result->mValue = mString;
+		break;
+		case TOKEN_BOOL:
+			result->mNodeType = JsonTree::NODE_VALUE;
+			result->mValueType = JsonTree::VALUE_BOOL;
+			result->mValue = toString( mBool );
+		break;
+		default:
+			result->mNodeType = JsonTree::NODE_NULL;
+	}
+}
+
+} // namespace cinder
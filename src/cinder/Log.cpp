@@ -25,6 +25,7 @@
 #include "cinder/CinderAssert.h"
 #include "cinder/Utilities.h"
 #include "cinder/Breakpoint.h"
+#include "cinder/Thread.h"
 #include "cinder/app/Platform.h"
 
 #if defined( CINDER_COCOA )
@@ -43,12 +44,19 @@
 	#include <unistd.h>
 #endif
 
+#if defined( CINDER_POSIX )
+	#include <signal.h>
+#endif
+
 #if defined( CINDER_COCOA ) && ( ! defined( __OBJC__ ) )
 	#error "This file must be compiled as Objective-C++ on the Mac"
 #endif
 
 #include <mutex>
 #include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <time.h>
 #include <cstring>
 
@@ -89,6 +97,9 @@ const std::string getDailyLogString( const std::string& format )
 	return result;
 }
 
+// set on the asynchronous queue's background thread
+thread_local bool sIsAsyncConsumerThread = false;
+
 } // anonymous namespace
 
 // ----------------------------------------------------------------------------------------------------
@@ -102,7 +113,74 @@ LogManager* manager()
 	return LogManager::instance();
 }
 
+// Bounded multiple-producer queue after Dmitry Vyukov's design. Producers claim a cell with a CAS on the enqueue position and publish it
+// through the cell's sequence number, so logging threads never take a lock. The single consumer is the background thread, which swaps the
+// records out rather than copying them, so the cells' strings keep their capacity and producers rarely allocate once the queue is warm.
+class LogManager::AsyncQueue {
+  public:
+	AsyncQueue( LogManager *manager, const AsyncOptions &options );
+	~AsyncQueue();
+
+	//! Writes out the remaining records and stops the background thread
+	void		stop();
+
+	//! Returns \c false if the record was dropped
+	bool		push( const Metadata &meta, const std::string &text );
+	//! Waits until the records pushed before the call have been written. If \a timeoutMs is negative waits indefinitely.
+	bool		flush( int timeoutMs );
+	//! Like flush(), but polls rather than waiting on a condition variable, for use from a crash handler
+	bool		flushPolling( int timeoutMs );
+	bool		isConsumerThread() const	{ return std::this_thread::get_id() == mThread.get_id(); }
+	uint64_t	getNumDropped() const		{ return mNumDropped.load( memory_order_relaxed ); }
+
+	static void	installCrashHandlers();
+
+  private:
+	struct Cell {
+		std::atomic<size_t>	mSequence;
+		Metadata			mMeta;
+		std::string			mText;
+	};
+
+	struct Record {
+		Metadata	mMeta;
+		std::string	mText;
+	};
+
+	bool	tryPush( const Metadata &meta, const std::string &text );
+	//! Returns whether the next cell has been published, consumer only
+	bool	hasPublished() const;
+	void	wakeConsumer( bool always );
+	void	run();
+	void	writeDroppedWarning();
+
+#if defined( CINDER_POSIX )
+	static void	crashSignalHandler( int signal, siginfo_t *info, void *context );
+#else
+	static void	crashSignalHandler( int signal );
+#endif
+	static void	crashTerminateHandler();
+
+	LogManager					*mManager;
+	std::unique_ptr<Cell[]>		mCells;
+	size_t						mMask, mMaxBatchSize;
+	OverflowPolicy				mOverflowPolicy;
+
+	alignas( 64 ) std::atomic<size_t>	mEnqueuePos;
+	alignas( 64 ) std::atomic<size_t>	mWrittenPos;
+	size_t						mDequeuePos; // consumer only
+	std::atomic<uint64_t>		mNumDropped;
+	uint64_t					mNumDroppedReported; // consumer only
+
+	std::atomic<bool>			mConsumerWaiting, mStopping;
+	std::atomic<int>			mNumFlushWaiters;
+	std::mutex					mWakeMutex;
+	std::condition_variable		mWakeCond, mWrittenCond;
+	std::thread					mThread;
+};
+
 LogManager::LogManager()
+	: mAsyncEnabled( false ), mAsyncDraining( false ), mNumAsyncWriters( 0 )
 {
 	restoreToDefault();
 }
@@ -155,6 +233,36 @@ void LogManager::restoreToDefault()
 }
 	
 void LogManager::write( const Metadata &meta, const std::string &text )
+{
+	if( mAsyncEnabled.load() ) {
+		// the count keeps disableAsync() from destroying the queue while this thread is pushing to it
+		mNumAsyncWriters.fetch_add( 1 );
+		if( mAsyncEnabled.load() ) {
+			mAsync->push( meta, text );
+			mNumAsyncWriters.fetch_sub( 1 );
+
+			// a fatal record is likely followed by the process going down, so make sure it gets out
+			if( meta.mLevel == LEVEL_FATAL )
+				flush();
+			return;
+		}
+		mNumAsyncWriters.fetch_sub( 1 );
+	}
+
+	// While the queue is written out before switching modes, a record written here would overtake the ones this thread queued
+	// before, so wait for the switch. The background thread can't wait for itself, but it writes out what it pushes before stopping.
+	if( mAsyncDraining.load() ) {
+		if( sIsAsyncConsumerThread ) {
+			mAsync->push( meta, text );
+			return;
+		}
+		lock_guard<mutex> lock( mAsyncMutex );
+	}
+
+	writeSync( meta, text );
+}
+
+void LogManager::writeSync( const Metadata &meta, const std::string &text )
 {
 	// TODO move this to a shared_lock_timed with c++14 support
 	lock_guard<mutex> lock( mMutex );
@@ -164,6 +272,374 @@ void LogManager::write( const Metadata &meta, const std::string &text )
 	}
 }
 
+// ----------------------------------------------------------------------------------------------------
+// LogManager::AsyncQueue
+// ----------------------------------------------------------------------------------------------------
+
+LogManager::AsyncQueue::AsyncQueue( LogManager *manager, const AsyncOptions &options )
+	: mManager( manager ), mMaxBatchSize( std::max<size_t>( 1, options.getMaxBatchSize() ) ), mOverflowPolicy( options.getOverflowPolicy() ),
+		mEnqueuePos( 0 ), mWrittenPos( 0 ), mDequeuePos( 0 ), mNumDropped( 0 ), mNumDroppedReported( 0 ),
+		mConsumerWaiting( false ), mStopping( false ), mNumFlushWaiters( 0 )
+{
+	size_t capacity = 2;
+	while( capacity < options.getCapacity() )
+		capacity *= 2;
+
+	mCells.reset( new Cell[capacity] );
+	for( size_t i = 0; i < capacity; ++i )
+		mCells[i].mSequence.store( i, memory_order_relaxed );
+	mMask = capacity - 1;
+
+	mThread = std::thread( &AsyncQueue::run, this );
+
+	if( options.isFlushOnCrash() )
+		installCrashHandlers();
+}
+
+LogManager::AsyncQueue::~AsyncQueue()
+{
+	stop();
+}
+
+void LogManager::AsyncQueue::stop()
+{
+	if( ! mThread.joinable() )
+		return;
+
+	mStopping.store( true );
+	wakeConsumer( true );
+	mThread.join();
+}
+
+bool LogManager::AsyncQueue::tryPush( const Metadata &meta, const std::string &text )
+{
+	Cell *cell;
+	size_t pos = mEnqueuePos.load( memory_order_relaxed );
+	for(;;) {
+		cell = &mCells[pos & mMask];
+		const size_t sequence = cell->mSequence.load( memory_order_acquire );
+		const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if( diff == 0 ) {
+			if( mEnqueuePos.compare_exchange_weak( pos, pos + 1, memory_order_relaxed ) )
+				break;
+		}
+		else if( diff < 0 )
+			return false; // full
+		else
+			pos = mEnqueuePos.load( memory_order_relaxed );
+	}
+
+	cell->mMeta = meta;
+	cell->mText = text;
+	cell->mSequence.store( pos + 1, memory_order_release );
+	return true;
+}
+
+bool LogManager::AsyncQueue::push( const Metadata &meta, const std::string &text )
+{
+	int attempts = 0;
+	while( ! tryPush( meta, text ) ) {
+		// the background thread can't wait for itself, so a logger that logs drops records rather than deadlocking
+		if( ( mOverflowPolicy == OVERFLOW_DROP && meta.mLevel < LEVEL_ERROR ) || isConsumerThread() ) {
+			mNumDropped.fetch_add( 1, memory_order_relaxed );
+			return false;
+		}
+
+		wakeConsumer( true );
+		if( ++attempts < 64 )
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+	}
+
+	wakeConsumer( false );
+	return true;
+}
+
+bool LogManager::AsyncQueue::hasPublished() const
+{
+	const Cell &cell = mCells[mDequeuePos & mMask];
+	return cell.mSequence.load( memory_order_acquire ) == mDequeuePos + 1;
+}
+
+void LogManager::AsyncQueue::wakeConsumer( bool always )
+{
+	// pairs with the fence in run(), so that either the consumer sees the new record or this sees the consumer waiting. Only the
+	// first producer to see it waiting pays for the notification.
+	atomic_thread_fence( memory_order_seq_cst );
+	if( always || ( mConsumerWaiting.load( memory_order_relaxed ) && mConsumerWaiting.exchange( false ) ) ) {
+		lock_guard<mutex> lock( mWakeMutex );
+		mWakeCond.notify_one();
+	}
+}
+
+void LogManager::AsyncQueue::run()
+{
+	ThreadSetup threadSetup;
+	sIsAsyncConsumerThread = true;
+
+	vector<Record> batch( mMaxBatchSize );
+	int numIdle = 0;
+	for(;;) {
+		size_t count = 0;
+		while( count < mMaxBatchSize && hasPublished() ) {
+			Cell &cell = mCells[mDequeuePos & mMask];
+			std::swap( batch[count].mMeta, cell.mMeta );
+			std::swap( batch[count].mText, cell.mText );
+			cell.mSequence.store( mDequeuePos + mMask + 1, memory_order_release );
+			++mDequeuePos;
+			++count;
+		}
+
+		if( count > 0 ) {
+			{
+				lock_guard<mutex> lock( mManager->mMutex );
+				for( size_t i = 0; i < count; ++i ) {
+					for( auto &logger : mManager->mLoggers )
+						logger->write( batch[i].mMeta, batch[i].mText );
+				}
+				writeDroppedWarning();
+			}
+
+			mWrittenPos.store( mDequeuePos );
+			if( mNumFlushWaiters.load() > 0 ) {
+				lock_guard<mutex> lock( mWakeMutex );
+				mWrittenCond.notify_all();
+			}
+			numIdle = 0;
+			continue;
+		}
+
+		if( mStopping.load() )
+			break;
+
+		// records tend to come in bursts, so give producers a moment before paying for a sleep and a wake-up
+		if( ++numIdle < 32 ) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		unique_lock<mutex> lock( mWakeMutex );
+		mConsumerWaiting.store( true );
+		atomic_thread_fence( memory_order_seq_cst );
+		// the timeout is only a safety net, producers wake the thread when it's waiting
+		if( ( ! hasPublished() ) && ( ! mStopping.load() ) )
+			mWakeCond.wait_for( lock, std::chrono::milliseconds( 100 ) );
+		mConsumerWaiting.store( false );
+	}
+
+	lock_guard<mutex> lock( mManager->mMutex );
+	writeDroppedWarning();
+}
+
+void LogManager::AsyncQueue::writeDroppedWarning()
+{
+	const uint64_t numDropped = mNumDropped.load( memory_order_relaxed );
+	if( numDropped == mNumDroppedReported )
+		return;
+
+	Metadata meta;
+	meta.mLevel = LEVEL_WARNING;
+	meta.mLocation = Location( CINDER_CURRENT_FUNCTION, __FILE__, __LINE__ );
+	const string text = "dropped " + to_string( numDropped - mNumDroppedReported ) + " log records because the queue was full";
+	for( auto &logger : mManager->mLoggers )
+		logger->write( meta, text );
+
+	mNumDroppedReported = numDropped;
+}
+
+bool LogManager::AsyncQueue::flush( int timeoutMs )
+{
+	const size_t target = mEnqueuePos.load();
+	if( mWrittenPos.load() >= target )
+		return true;
+	if( isConsumerThread() )
+		return false;
+
+	mNumFlushWaiters.fetch_add( 1 );
+	wakeConsumer( true );
+
+	bool result = true;
+	{
+		unique_lock<mutex> lock( mWakeMutex );
+		auto written = [this, target] { return mWrittenPos.load() >= target; };
+		if( timeoutMs < 0 )
+			mWrittenCond.wait( lock, written );
+		else
+			result = mWrittenCond.wait_for( lock, std::chrono::milliseconds( timeoutMs ), written );
+	}
+
+	mNumFlushWaiters.fetch_sub( 1 );
+	return result;
+}
+
+bool LogManager::AsyncQueue::flushPolling( int timeoutMs )
+{
+	const size_t target = mEnqueuePos.load();
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeoutMs );
+	while( mWrittenPos.load() < target ) {
+		if( isConsumerThread() || std::chrono::steady_clock::now() > deadline )
+			return false;
+		mWakeCond.notify_one();
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	return true;
+}
+
+namespace {
+
+const int						sCrashSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+#if defined( CINDER_POSIX )
+struct sigaction				sPrevCrashSignalActions[4];
+#else
+void							(*sPrevCrashSignalHandlers[4])( int );
+#endif
+std::terminate_handler			sPrevTerminateHandler = nullptr;
+
+} // anonymous namespace
+
+void LogManager::AsyncQueue::installCrashHandlers()
+{
+	static std::once_flag sInstalled;
+	std::call_once( sInstalled, [] {
+#if defined( CINDER_POSIX )
+		// sigaction rather than std::signal, so that a previous SA_SIGINFO handler (a crash reporter, say) is kept intact to chain to
+		struct sigaction action;
+		memset( &action, 0, sizeof( action ) );
+		action.sa_sigaction = &crashSignalHandler;
+		action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+		sigemptyset( &action.sa_mask );
+		for( int i = 0; i < 4; ++i )
+			sigaction( sCrashSignals[i], &action, &sPrevCrashSignalActions[i] );
+#else
+		for( int i = 0; i < 4; ++i )
+			sPrevCrashSignalHandlers[i] = std::signal( sCrashSignals[i], &crashSignalHandler );
+#endif
+		sPrevTerminateHandler = std::set_terminate( &crashTerminateHandler );
+
+		// the manager is leaked at shutdown, so this is the only chance to write out what's left in the queue. The background
+		// thread may already be gone or stuck by now, so this polls with a timeout rather than waiting on it indefinitely.
+		std::atexit( [] {
+			if( LogManager::instance() )
+				LogManager::instance()->flushWithTimeout( 2000 );
+		} );
+	} );
+}
+
+// Writing out the queue from a signal handler isn't async-signal-safe, but the process is going down either way and the records
+// leading up to a crash are the ones most worth having. The background thread does the writing, so this only waits for it.
+#if defined( CINDER_POSIX )
+void LogManager::AsyncQueue::crashSignalHandler( int signal, siginfo_t *info, void *context )
+{
+	if( LogManager::instance() )
+		LogManager::instance()->flushWithTimeout( 2000 );
+
+	// puts the previous action back and hands the signal on to it with the original siginfo. If it returns, or there is none, a fault
+	// re-executes the faulting instruction under that action, while a raised signal is raised again.
+	for( int i = 0; i < 4; ++i ) {
+		if( sCrashSignals[i] == signal ) {
+			const struct sigaction &prev = sPrevCrashSignalActions[i];
+			sigaction( signal, &prev, nullptr );
+			if( prev.sa_flags & SA_SIGINFO ) {
+				if( prev.sa_sigaction )
+					prev.sa_sigaction( signal, info, context );
+			}
+			else if( prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN )
+				prev.sa_handler( signal );
+			else if( prev.sa_handler == SIG_DFL && info->si_code <= 0 )
+				std::raise( signal );
+			return;
+		}
+	}
+}
+#else
+void LogManager::AsyncQueue::crashSignalHandler( int signal )
+{
+	if( LogManager::instance() )
+		LogManager::instance()->flushWithTimeout( 2000 );
+
+	for( int i = 0; i < 4; ++i ) {
+		if( sCrashSignals[i] == signal ) {
+			auto prevHandler = sPrevCrashSignalHandlers[i];
+			std::signal( signal, ( prevHandler == SIG_ERR || prevHandler == nullptr ) ? SIG_DFL : prevHandler );
+			break;
+		}
+	}
+	std::raise( signal );
+}
+#endif
+
+void LogManager::AsyncQueue::crashTerminateHandler()
+{
+	if( LogManager::instance() )
+		LogManager::instance()->flushWithTimeout( 2000 );
+
+	if( sPrevTerminateHandler )
+		sPrevTerminateHandler();
+	std::abort();
+}
+
+LogManager::~LogManager()
+{
+	disableAsync();
+}
+
+void LogManager::enableAsync( const AsyncOptions &options )
+{
+	lock_guard<mutex> lock( mAsyncMutex );
+	stopAsync();
+
+	mAsync.reset( new AsyncQueue( this, options ) );
+	mAsyncEnabled.store( true );
+}
+
+void LogManager::disableAsync()
+{
+	lock_guard<mutex> lock( mAsyncMutex );
+	stopAsync();
+}
+
+void LogManager::stopAsync()
+{
+	if( ! mAsyncEnabled.load() )
+		return;
+
+	// Logging threads wait in write() until the queue has been written out, so that their records stay in order. Once no
+	// thread is pushing, stopping the queue writes out what's left.
+	mAsyncDraining.store( true );
+	mAsyncEnabled.store( false );
+	while( mNumAsyncWriters.load() > 0 )
+		std::this_thread::yield();
+	mAsync->stop();
+	mAsyncDraining.store( false );
+	mAsync.reset();
+}
+
+void LogManager::flush()
+{
+	mNumAsyncWriters.fetch_add( 1 );
+	if( mAsyncEnabled.load() )
+		mAsync->flush( -1 );
+	mNumAsyncWriters.fetch_sub( 1 );
+}
+
+bool LogManager::flushWithTimeout( int timeoutMs )
+{
+	mNumAsyncWriters.fetch_add( 1 );
+	bool result = true;
+	if( mAsyncEnabled.load() )
+		result = mAsync->flushPolling( timeoutMs );
+	mNumAsyncWriters.fetch_sub( 1 );
+	return result;
+}
+
+uint64_t LogManager::getNumDroppedRecords() const
+{
+	lock_guard<mutex> lock( mAsyncMutex );
+	return mAsync ? mAsync->getNumDropped() : 0;
+}
+
 // ----------------------------------------------------------------------------------------------------
 // Entry
 // ----------------------------------------------------------------------------------------------------
@@ -0,0 +1,427 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/LooseOctree.h"
+#include "cinder/Simd.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+// Indices into Node::mBounds
+enum { MIN_X, MIN_Y, MIN_Z, MAX_X, MAX_Y, MAX_Z };
+
+// Bounds the traversal stacks; every level may push up to 8 children
+const int MAX_DEPTH = 16;
+const int STACK_SIZE = MAX_DEPTH * 8 + 1;
+
+// Returns the distance along the ray at which it enters the box, or FLT_MAX if it misses the box within [0, maxT]
+inline float intersectBox( const vec3 &min, const vec3 &max, const vec3 &origin, const vec3 &invDirection, float maxT )
+{
+	const vec3 t0 = ( min - origin ) * invDirection;
+	const vec3 t1 = ( max - origin ) * invDirection;
+	const vec3 tMin = glm::min( t0, t1 );
+	const vec3 tMax = glm::max( t0, t1 );
+	const float enter = std::max( std::max( tMin.x, tMin.y ), std::max( tMin.z, 0.0f ) );
+	const float exit = std::min( std::min( tMax.x, tMax.y ), std::min( tMax.z, maxT ) );
+	return ( enter <= exit ) ? enter : FLT_MAX;
+}
+
+inline float calcDistance2( const vec3 &min, const vec3 &max, const vec3 &point )
+{
+	const vec3 d = glm::max( glm::max( min - point, point - max ), vec3( 0 ) );
+	return dot( d, d );
+}
+
+// A frustum plane, with the indices of the bounds which form the corner of a box furthest along the normal
+struct CullPlane {
+	vec3	mNormal;
+	float	mDistance;
+	int		mPositive[3];
+	int		mNegative[3];
+};
+
+} // anonymous namespace
+
+const uint32_t LooseOctree::INVALID;
+
+LooseOctree::LooseOctree( const AxisAlignedBox &bounds, const Options &options )
+	: mOptions( options )
+{
+	if( options.getMaxDepth() < 0 || options.getMaxDepth() > MAX_DEPTH )
+		throw LooseOctreeExc( "LooseOctree max depth must be between 0 and " + to_string( MAX_DEPTH ) + "." );
+
+	const vec3 size = bounds.getSize();
+	mCenter = bounds.getCenter();
+	mHalfSize = std::max( std::max( size.x, size.y ), std::max( size.z, FLT_MIN ) ) * 0.5f;
+	clear();
+}
+
+void LooseOctree::clear()
+{
+	mNodes.clear();
+	mItems.clear();
+	mFreeIds.clear();
+
+	Node root;
+	root.mCenter = mCenter;
+	root.mHalfSize = mHalfSize;
+	root.mParent = INVALID;
+	std::fill( root.mChildren, root.mChildren + 8, 0 );
+	root.mSubtreeCount = 0;
+	mNodes.push_back( std::move( root ) );
+}
+
+uint32_t LooseOctree::findNode( const vec3 &min, const vec3 &max )
+{
+	const vec3 center = ( min + max ) * 0.5f;
+	if( glm::any( glm::greaterThan( glm::abs( center - mCenter ), vec3( mHalfSize ) ) ) )
+		return 0;
+
+	// the deepest level whose cells are at least as large as the box
+	const vec3 size = max - min;
+	const float maxSize = std::max( std::max( size.x, size.y ), size.z );
+	uint32_t nodeIndex = 0;
+	for( int depth = 0; depth < mOptions.getMaxDepth() && mNodes[nodeIndex].mHalfSize >= maxSize; ++depth ) {
+		const vec3 nodeCenter = mNodes[nodeIndex].mCenter;
+		const int octant = ( center.x >= nodeCenter.x ? 1 : 0 ) | ( center.y >= nodeCenter.y ? 2 : 0 ) | ( center.z >= nodeCenter.z ? 4 : 0 );
+		uint32_t child = mNodes[nodeIndex].mChildren[octant];
+		if( child == 0 ) {
+			Node node;
+			node.mHalfSize = mNodes[nodeIndex].mHalfSize * 0.5f;
+			node.mCenter = nodeCenter + vec3( ( octant & 1 ) ? node.mHalfSize : -node.mHalfSize, ( octant & 2 ) ? node.mHalfSize : -node.mHalfSize, ( octant & 4 ) ? node.mHalfSize : -node.mHalfSize );
+			node.mParent = nodeIndex;
+			std::fill( node.mChildren, node.mChildren + 8, 0 );
+			node.mSubtreeCount = 0;
+			child = (uint32_t)mNodes.size();
+			mNodes[nodeIndex].mChildren[octant] = child;
+			mNodes.push_back( std::move( node ) );
+		}
+		nodeIndex = child;
+	}
+
+	return nodeIndex;
+}
+
+void LooseOctree::addToNode( uint32_t id, uint32_t nodeIndex )
+{
+	Item &item = mItems[id];
+	Node &node = mNodes[nodeIndex];
+	item.mNode = nodeIndex;
+	item.mSlot = (uint32_t)node.mIds.size();
+	node.mIds.push_back( id );
+	for( int a = 0; a < 3; ++a ) {
+		node.mBounds[MIN_X + a].push_back( item.mMin[a] );
+		node.mBounds[MAX_X + a].push_back( item.mMax[a] );
+	}
+
+	for( uint32_t n = nodeIndex; n != INVALID; n = mNodes[n].mParent )
+		++mNodes[n].mSubtreeCount;
+}
+
+void LooseOctree::removeFromNode( uint32_t id )
+{
+	Item &item = mItems[id];
+	Node &node = mNodes[item.mNode];
+
+	// move the last box of the cell into the slot of the removed one
+	const uint32_t last = (uint32_t)node.mIds.size() - 1;
+	if( item.mSlot != last ) {
+		node.mIds[item.mSlot] = node.mIds[last];
+		for( int b = 0; b < 6; ++b )
+			node.mBounds[b][item.mSlot] = node.mBounds[b][last];
+		mItems[node.mIds[item.mSlot]].mSlot = item.mSlot;
+	}
+	node.mIds.pop_back();
+	for( int b = 0; b < 6; ++b )
+		node.mBounds[b].pop_back();
+
+	for( uint32_t n = item.mNode; n != INVALID; n = mNodes[n].mParent )
+		--mNodes[n].mSubtreeCount;
+	item.mNode = INVALID;
+}
+
+uint32_t LooseOctree::insert( const AxisAlignedBox &box )
+{
+	uint32_t id;
+	if( ! mFreeIds.empty() ) {
+		id = mFreeIds.back();
+		mFreeIds.pop_back();
+	}
+	else {
+		id = (uint32_t)mItems.size();
+		mItems.push_back( Item() );
+	}
+
+	mItems[id].mMin = box.getMin();
+	mItems[id].mMax = box.getMax();
+	addToNode( id, findNode( box.getMin(), box.getMax() ) );
+	return id;
+}
+
+void LooseOctree::move( uint32_t id, const AxisAlignedBox &box )
+{
+	if( ! contains( id ) )
+		throw LooseOctreeExc( "LooseOctree::move() called with an invalid id." );
+
+	Item &item = mItems[id];
+	item.mMin = box.getMin();
+	item.mMax = box.getMax();
+	const uint32_t nodeIndex = findNode( item.mMin, item.mMax );
+	if( nodeIndex == item.mNode ) {
+		Node &node = mNodes[nodeIndex];
+		for( int a = 0; a < 3; ++a ) {
+			node.mBounds[MIN_X + a][item.mSlot] = item.mMin[a];
+			node.mBounds[MAX_X + a][item.mSlot] = item.mMax[a];
+		}
+	}
+	else {
+		removeFromNode( id );
+		addToNode( id, nodeIndex );
+	}
+}
+
+void LooseOctree::remove( uint32_t id )
+{
+	if( ! contains( id ) )
+		throw LooseOctreeExc( "LooseOctree::remove() called with an invalid id." );
+
+	removeFromNode( id );
+	mFreeIds.push_back( id );
+}
+
+void LooseOctree::appendSubtree( uint32_t nodeIndex, std::vector<uint32_t> *result ) const
+{
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = nodeIndex;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		result->insert( result->end(), node.mIds.begin(), node.mIds.end() );
+		for( uint32_t child : node.mChildren ) {
+			if( child && mNodes[child].mSubtreeCount )
+				stack[stackSize++] = child;
+		}
+	}
+}
+
+size_t LooseOctree::query( const Frustum &frustum, std::vector<uint32_t> *result ) const
+{
+	CullPlane planes[6];
+	for( int p = 0; p < 6; ++p ) {
+		const auto &plane = frustum.getPlane( (Frustum::FrustumSection)p );
+		planes[p].mNormal = plane.getNormal();
+		planes[p].mDistance = plane.getDistance();
+		for( int a = 0; a < 3; ++a ) {
+			planes[p].mPositive[a] = ( planes[p].mNormal[a] > 0 ) ? MAX_X + a : MIN_X + a;
+			planes[p].mNegative[a] = ( planes[p].mNormal[a] < 0 ) ? MAX_X + a : MIN_X + a;
+		}
+	}
+
+	const size_t first = result->size();
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = mNodes[nodeIndex];
+
+		// the root also holds boxes outside the bounds, so it is always tested box by box
+		if( nodeIndex != 0 ) {
+			const float looseSize = node.mHalfSize * 2;
+			const float bounds[6] = { node.mCenter.x - looseSize, node.mCenter.y - looseSize, node.mCenter.z - looseSize,
+									  node.mCenter.x + looseSize, node.mCenter.y + looseSize, node.mCenter.z + looseSize };
+			bool outside = false, inside = true;
+			for( int p = 0; p < 6 && ! outside; ++p ) {
+				const CullPlane &plane = planes[p];
+				const vec3 positive( bounds[plane.mPositive[0]], bounds[plane.mPositive[1]], bounds[plane.mPositive[2]] );
+				const vec3 negative( bounds[plane.mNegative[0]], bounds[plane.mNegative[1]], bounds[plane.mNegative[2]] );
+				outside = dot( plane.mNormal, positive ) - plane.mDistance < 0;
+				inside = inside && ( dot( plane.mNormal, negative ) - plane.mDistance >= 0 );
+			}
+
+			if( outside )
+				continue;
+			if( inside ) {
+				appendSubtree( nodeIndex, result );
+				continue;
+			}
+		}
+
+		const size_t count = node.mIds.size();
+		size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 )
+		const __m128 zero = _mm_setzero_ps();
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 visible = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+			for( int p = 0; p < 6; ++p ) {
+				const CullPlane &plane = planes[p];
+				const __m128 dx = _mm_mul_ps( _mm_set1_ps( plane.mNormal.x ), _mm_loadu_ps( &node.mBounds[plane.mPositive[0]][i] ) );
+				const __m128 dy = _mm_mul_ps( _mm_set1_ps( plane.mNormal.y ), _mm_loadu_ps( &node.mBounds[plane.mPositive[1]][i] ) );
+				const __m128 dz = _mm_mul_ps( _mm_set1_ps( plane.mNormal.z ), _mm_loadu_ps( &node.mBounds[plane.mPositive[2]][i] ) );
+				const __m128 distance = _mm_sub_ps( _mm_add_ps( _mm_add_ps( dx, dy ), dz ), _mm_set1_ps( plane.mDistance ) );
+				visible = _mm_and_ps( visible, _mm_cmpnlt_ps( distance, zero ) );
+			}
+
+			int mask = _mm_movemask_ps( visible );
+			while( mask ) {
+				const int lane = ( mask & 1 ) ? 0 : ( mask & 2 ) ? 1 : ( mask & 4 ) ? 2 : 3;
+				result->push_back( node.mIds[i + lane] );
+				mask &= ~( 1 << lane );
+			}
+		}
+#endif
+		for( ; i < count; ++i ) {
+			bool outside = false;
+			for( int p = 0; p < 6 && ! outside; ++p ) {
+				const CullPlane &plane = planes[p];
+				const vec3 positive( node.mBounds[plane.mPositive[0]][i], node.mBounds[plane.mPositive[1]][i], node.mBounds[plane.mPositive[2]][i] );
+				outside = dot( plane.mNormal, positive ) - plane.mDistance < 0;
+			}
+			if( ! outside )
+				result->push_back( node.mIds[i] );
+		}
+
+		for( uint32_t child : node.mChildren ) {
+			if( child && mNodes[child].mSubtreeCount )
+				stack[stackSize++] = child;
+		}
+	}
+
+	return result->size() - first;
+}
+
+size_t LooseOctree::query( const AxisAlignedBox &box, std::vector<uint32_t> *result ) const
+{
+	const vec3 boxMin = box.getMin(), boxMax = box.getMax();
+	const size_t first = result->size();
+
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = mNodes[nodeIndex];
+		if( nodeIndex != 0 ) {
+			const vec3 looseSize( node.mHalfSize * 2 );
+			const vec3 nodeMin = node.mCenter - looseSize, nodeMax = node.mCenter + looseSize;
+			if( glm::any( glm::lessThan( nodeMax, boxMin ) ) || glm::any( glm::greaterThan( nodeMin, boxMax ) ) )
+				continue;
+			if( glm::all( glm::greaterThanEqual( nodeMin, boxMin ) ) && glm::all( glm::lessThanEqual( nodeMax, boxMax ) ) ) {
+				appendSubtree( nodeIndex, result );
+				continue;
+			}
+		}
+
+		for( size_t i = 0; i < node.mIds.size(); ++i ) {
+			const Item &item = mItems[node.mIds[i]];
+			if( ! glm::any( glm::lessThan( item.mMax, boxMin ) ) && ! glm::any( glm::greaterThan( item.mMin, boxMax ) ) )
+				result->push_back( node.mIds[i] );
+		}
+
+		for( uint32_t child : node.mChildren ) {
+			if( child && mNodes[child].mSubtreeCount )
+				stack[stackSize++] = child;
+		}
+	}
+
+	return result->size() - first;
+}
+
+size_t LooseOctree::query( const Sphere &sphere, std::vector<uint32_t> *result ) const
+{
+	const vec3 center = sphere.getCenter();
+	const float radius2 = sphere.getRadius() * sphere.getRadius();
+	const size_t first = result->size();
+
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = mNodes[nodeIndex];
+		if( nodeIndex != 0 ) {
+			const vec3 looseSize( node.mHalfSize * 2 );
+			if( calcDistance2( node.mCenter - looseSize, node.mCenter + looseSize, center ) > radius2 )
+				continue;
+		}
+
+		for( size_t i = 0; i < node.mIds.size(); ++i ) {
+			const Item &item = mItems[node.mIds[i]];
+			if( calcDistance2( item.mMin, item.mMax, center ) <= radius2 )
+				result->push_back( node.mIds[i] );
+		}
+
+		for( uint32_t child : node.mChildren ) {
+			if( child && mNodes[child].mSubtreeCount )
+				stack[stackSize++] = child;
+		}
+	}
+
+	return result->size() - first;
+}
+
+size_t LooseOctree::intersect( const Ray &ray, std::vector<uint32_t> *result, float maxDistance ) const
+{
+	const vec3 &origin = ray.getOrigin();
+	const vec3 &invDirection = ray.getInverseDirection();
+	vector<pair<float, uint32_t>> hits;
+
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = mNodes[nodeIndex];
+		if( nodeIndex != 0 ) {
+			const vec3 looseSize( node.mHalfSize * 2 );
+			if( intersectBox( node.mCenter - looseSize, node.mCenter + looseSize, origin, invDirection, maxDistance ) == FLT_MAX )
+				continue;
+		}
+
+		for( size_t i = 0; i < node.mIds.size(); ++i ) {
+			const Item &item = mItems[node.mIds[i]];
+			const float distance = intersectBox( item.mMin, item.mMax, origin, invDirection, maxDistance );
+			if( distance != FLT_MAX )
+				hits.emplace_back( distance, node.mIds[i] );
+		}
+
+		for( uint32_t child : node.mChildren ) {
+			if( child && mNodes[child].mSubtreeCount )
+				stack[stackSize++] = child;
+		}
+	}
+
+	std::sort( hits.begin(), hits.end() );
+	for( const auto &hit : hits )
+		result->push_back( hit.second );
+
+	return hits.size();
+}
+
+} // namespace cinder
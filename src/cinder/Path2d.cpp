@@ -151,8 +151,25 @@ Path2d::Path2d( const BSpline2f &spline, float subdivisionStep )
 	}
 }
 
+Path2d::Path2d( const Path2d &rhs )
+	: mPoints( rhs.mPoints ), mSegments( rhs.mSegments ), mArcLengthTable( std::atomic_load( &rhs.mArcLengthTable ) )
+{
+}
+
+Path2d& Path2d::operator=( const Path2d &rhs )
+{
+	if( this != &rhs ) {
+		mPoints = rhs.mPoints;
+		mSegments = rhs.mSegments;
+		mArcLengthTable = std::atomic_load( &rhs.mArcLengthTable );
+	}
+
+	return *this;
+}
+
 void Path2d::moveTo( const vec2 &p )
 {
+	invalidateArcLengths();
 	if( ! mPoints.empty() )
 		throw Path2dExc(); // can only moveTo as the first point
 
@@ -161,6 +178,7 @@ void Path2d::moveTo( const vec2 &p )
 
 void Path2d::lineTo( const vec2 &p )
 {
+	invalidateArcLengths();
 	if( mPoints.empty() )
 		throw Path2dExc(); // can only lineTo as non-first point
 
@@ -170,6 +188,7 @@ void Path2d::lineTo( const vec2 &p )
 
 void Path2d::quadTo( const vec2 &p1, const vec2 &p2 )
 {
+	invalidateArcLengths();
 	if( mPoints.empty() )
 		throw Path2dExc(); // can only quadTo as non-first point
 
@@ -180,6 +199,7 @@ void Path2d::quadTo( const vec2 &p1, const vec2 &p2 )
 
 void Path2d::curveTo( const vec2 &p1, const vec2 &p2, const vec2 &p3 )
 {
+	invalidateArcLengths();
 	if( mPoints.empty() )
 		throw Path2dExc(); // can only curveTo as non-first point
 
@@ -340,6 +360,7 @@ void Path2d::arcTo( const vec2 &p1, const vec2 &t, float radius )
 
 void Path2d::reverse()
 {
+	invalidateArcLengths();
     // The path is empty: nothing to do.
     if( empty() )
         return;
@@ -362,6 +383,7 @@ void Path2d::reverse()
 
 void Path2d::appendSegment( SegmentType segmentType, const vec2 *points )
 {
+	invalidateArcLengths();
 	mSegments.push_back( segmentType );
 	// we only copy all of the segments points when we are empty. ie lineto -> line when we are empty
 	if( mPoints.empty() )
@@ -372,6 +394,7 @@ void Path2d::appendSegment( SegmentType segmentType, const vec2 *points )
 
 void Path2d::removeSegment( size_t segment )
 {
+	invalidateArcLengths();
 	int firstPoint = 1; // we always skip the first point, since it's a moveTo
 	for( size_t s = 0; s < segment; ++s )
 		firstPoint += sSegmentTypePointCounts[mSegments[s]];
@@ -435,6 +458,11 @@ vec2 Path2d::getSegmentPosition( size_t segment, float t ) const
 	size_t firstPoint = 0;
 	for( size_t s = 0; s < segment; ++s )
 		firstPoint += sSegmentTypePointCounts[mSegments[s]];
+	return getSegmentPosition( segment, firstPoint, t );
+}
+
+vec2 Path2d::getSegmentPosition( size_t segment, size_t firstPoint, float t ) const
+{
 	switch( mSegments[segment] ) {
 		case CUBICTO: {
 			float t1 = 1 - t;
@@ -469,6 +497,11 @@ vec2 Path2d::getSegmentTangent( size_t segment, float t ) const
 	size_t firstPoint = 0;
 	for( size_t s = 0; s < segment; ++s )
 		firstPoint += sSegmentTypePointCounts[mSegments[s]];
+	return getSegmentTangent( segment, firstPoint, t );
+}
+
+vec2 Path2d::getSegmentTangent( size_t segment, size_t firstPoint, float t ) const
+{
 	switch( mSegments[segment] ) {
 		case CUBICTO:
 			return calcCubicBezierDerivative( &mPoints[firstPoint], t );
@@ -723,18 +756,21 @@ void Path2d::subdivide( std::vector<vec2> *resultPositions, std::vector<vec2> *r
 
 void Path2d::translate( const vec2 &offset )
 {
+	invalidateArcLengths();
 	for( vector<vec2>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
 		*ptIt += offset;
 }
 
 void Path2d::scale( const vec2 &amount, vec2 scaleCenter )
 {
+	invalidateArcLengths();
 	for( vector<vec2>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
 		*ptIt = scaleCenter + vec2( ( ptIt->x - scaleCenter.x ) * amount.x, ( ptIt->y - scaleCenter.y ) * amount.y );
 }
 
 void Path2d::transform( const mat3 &matrix )
 {
+	invalidateArcLengths();
 	for( vector<vec2>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
 		*ptIt = vec2( matrix * vec3( *ptIt, 1 ) );
 }
@@ -742,6 +778,7 @@ void Path2d::transform( const mat3 &matrix )
 Path2d Path2d::transformed( const mat3 &matrix ) const
 {
 	Path2d result = *this;
+	result.invalidateArcLengths();
 	for( vector<vec2>::iterator ptIt = result.mPoints.begin(); ptIt != result.mPoints.end(); ++ptIt )
 		*ptIt = vec2( matrix * vec3( *ptIt, 1 ) );
 	return result;
@@ -1638,8 +1675,246 @@ vec2 Path2d::calcClosestPoint( const vec2 &pt, size_t segment, size_t firstPoint
 	}
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Arc length table
+namespace {
+
+// Number of parameter intervals each segment type is initially sampled at, which are halved where interpolating them isn't precise enough
+const int sSegmentTypeArcLengthIntervals[] = { 1, 1, 4, 8, 1 }; // MOVETO, LINETO, QUADTO, CUBICTO, CLOSE
+// Maximum number of times an interval is halved
+const int MAX_ARC_LENGTH_SUBDIVISIONS = 10;
+// Maximum distance between interpolated and exact positions, relative to the length of the segment's control polygon
+const float ARC_LENGTH_TOLERANCE = 1.0e-5f;
+
+// Integrates fn over [a,b] with 5-point Gauss-Legendre quadrature, which is exact for polynomials up to degree 9
+template<typename FnT>
+float gaussLegendreIntegral( float a, float b, const FnT &fn )
+{
+	static const float x[5] = { 0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f };
+	static const float w[5] = { 0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f };
+
+	const float center = ( a + b ) * 0.5f, halfWidth = ( b - a ) * 0.5f;
+	float result = 0;
+	for( int i = 0; i < 5; ++i )
+		result += w[i] * fn( center + halfWidth * x[i] );
+
+	return result * halfWidth;
+}
+
+// Loops \a distance into [0,length] if \a wrap, otherwise clamps it
+float wrapDistance( float distance, float length, bool wrap )
+{
+	if( wrap && ( distance < 0 || distance > length ) ) {
+		distance = math<float>::fmod( distance, length );
+		return ( distance < 0 ) ? distance + length : distance;
+	}
+
+	return math<float>::clamp( distance, 0, length );
+}
+
+// Returns the parameter at \a distance between samples at distances \a d0 and \a d1 with parameters \a t0 and \a t1 and derivatives by distance \a slope0 and \a slope1.
+// Uses cubic Hermite interpolation, with the slopes limited to three times the secant to keep it monotonic (Fritsch-Carlson).
+float interpolateMonotone( float d0, float d1, float t0, float t1, float slope0, float slope1, float distance )
+{
+	const float width = d1 - d0;
+	if( width <= 0 )
+		return t0;
+
+	const float secant = ( t1 - t0 ) / width;
+	const float m0 = std::min( slope0, 3 * secant ) * width;
+	const float m1 = std::min( slope1, 3 * secant ) * width;
+	const float s = math<float>::clamp( ( distance - d0 ) / width, 0, 1 );
+	const float s2 = s * s, s3 = s2 * s;
+	return ( 2 * s3 - 3 * s2 + 1 ) * t0 + ( s3 - 2 * s2 + s ) * m0 + ( 3 * s2 - 2 * s3 ) * t1 + ( s3 - s2 ) * m1;
+}
+
+} // anonymous namespace
+
+// The arc length sampled along each segment, more densely where its speed varies. Each segment has its own samples, so the last sample
+// of a segment and the first one of the next segment lie at the same distance.
+struct Path2d::ArcLengthTable {
+	//! Returns the interval between samples \a i and \a i + 1 which contains \a distance
+	size_t	findInterval( float distance ) const;
+	//! Returns the parameter relative to its segment at \a distance, which lies within \a interval
+	float	interpolate( size_t interval, float distance ) const;
+
+	float					mLength;
+	std::vector<float>		mDistances;		// distance from the start of the path
+	std::vector<float>		mTimes;			// parameter relative to the segment
+	std::vector<float>		mSlopes;		// derivative of the parameter by distance, the inverse of the speed
+	std::vector<uint32_t>	mSegments;		// segment of each sample
+	std::vector<uint32_t>	mFirstPoints;	// first point of each segment
+};
+
+size_t Path2d::ArcLengthTable::findInterval( float distance ) const
+{
+	// the last sample at or before distance, which always starts an interval within a segment except at the end of the path
+	const size_t next = std::upper_bound( mDistances.begin(), mDistances.end(), distance ) - mDistances.begin();
+	return std::min( std::max<size_t>( next, 1 ), mDistances.size() - 1 ) - 1;
+}
+
+float Path2d::ArcLengthTable::interpolate( size_t interval, float distance ) const
+{
+	return interpolateMonotone( mDistances[interval], mDistances[interval + 1], mTimes[interval], mTimes[interval + 1], mSlopes[interval], mSlopes[interval + 1], distance );
+}
+
+std::shared_ptr<const Path2d::ArcLengthTable> Path2d::getArcLengthTable() const
+{
+	auto table = std::atomic_load( &mArcLengthTable );
+	if( table )
+		return table;
+
+	auto result = std::make_shared<ArcLengthTable>();
+	result->mFirstPoints.reserve( mSegments.size() );
+
+	struct Interval {
+		float	mEndT;
+		int		mDepth;
+	};
+	std::vector<Interval> intervals;
+	float distance = 0;
+	size_t firstPoint = 0;
+	for( size_t s = 0; s < mSegments.size(); ++s ) {
+		auto speed = [&]( float t ) { return ( mSegments[s] == MOVETO ) ? 0.0f : length( getSegmentTangent( s, firstPoint, t ) ); };
+		auto addSample = [&]( float t, float v ) {
+			result->mDistances.push_back( distance );
+			result->mTimes.push_back( t );
+			result->mSlopes.push_back( ( v > 0 ) ? 1 / v : FLT_MAX );
+			result->mSegments.push_back( (uint32_t)s );
+		};
+
+		float controlLength = 0;
+		const int numPoints = sSegmentTypePointCounts[mSegments[s]];
+		for( int p = 0; p < numPoints; ++p )
+			controlLength += glm::distance( mPoints[firstPoint + p], mPoints[firstPoint + p + 1] );
+		if( mSegments[s] == CLOSE )
+			controlLength = glm::distance( mPoints[firstPoint], mPoints[0] );
+		const float tolerance = controlLength * ARC_LENGTH_TOLERANCE;
+
+		// halve each interval until the interpolated position at its middle is within the tolerance, processing them in order
+		addSample( 0, speed( 0 ) );
+		const int numIntervals = sSegmentTypeArcLengthIntervals[mSegments[s]];
+		for( int i = numIntervals; i > 0; --i )
+			intervals.push_back( { i / (float)numIntervals, 0 } );
+		while( ! intervals.empty() ) {
+			const Interval interval = intervals.back();
+			intervals.pop_back();
+			// the lengths of the quarters of the interval, whose ends are where the interpolation is tested
+			const float t0 = result->mTimes.back(), t1 = interval.mEndT, middleT = ( t0 + t1 ) * 0.5f;
+			float quarterLengths[4], intervalLength = 0;
+			for( int q = 0; q < 4; ++q ) {
+				quarterLengths[q] = gaussLegendreIntegral( t0 + ( t1 - t0 ) * q * 0.25f, t0 + ( t1 - t0 ) * ( q + 1 ) * 0.25f, speed );
+				intervalLength += quarterLengths[q];
+			}
+			const float v1 = speed( t1 );
+			if( interval.mDepth < MAX_ARC_LENGTH_SUBDIVISIONS ) {
+				float quarterDistance = distance, error = 0;
+				for( int q = 1; q < 4; ++q ) {
+					const float quarterT = t0 + ( t1 - t0 ) * q * 0.25f;
+					quarterDistance += quarterLengths[q - 1];
+					const float interpolatedT = interpolateMonotone( distance, distance + intervalLength, t0, t1, result->mSlopes.back(), ( v1 > 0 ) ? 1 / v1 : FLT_MAX, quarterDistance );
+					error = std::max( error, math<float>::abs( interpolatedT - quarterT ) * speed( quarterT ) );
+				}
+				if( error > tolerance ) {
+					intervals.push_back( { t1, interval.mDepth + 1 } );
+					intervals.push_back( { middleT, interval.mDepth + 1 } );
+					continue;
+				}
+			}
+
+			distance += intervalLength;
+			addSample( t1, v1 );
+		}
+
+		result->mFirstPoints.push_back( (uint32_t)firstPoint );
+		firstPoint += numPoints;
+	}
+	result->mLength = distance;
+
+	table = result;
+	std::atomic_store( &mArcLengthTable, table );
+	return table;
+}
+
+float Path2d::solveTimeForDistance( const ArcLengthTable &table, float distance, float tolerance, int maxIterations ) const
+{
+	const size_t interval = table.findInterval( distance );
+	const size_t segment = table.mSegments[interval];
+	const size_t firstPoint = table.mFirstPoints[segment];
+	float t = table.interpolate( interval, distance );
+
+	// refine with Newton-Raphson on the arc length from the start of the interval, bisecting whenever it would leave the bracket [a,b]
+	auto speed = [&]( float t ) { return ( mSegments[segment] == MOVETO ) ? 0.0f : length( getSegmentTangent( segment, firstPoint, t ) ); };
+	const float startT = table.mTimes[interval];
+	float a = startT, b = table.mTimes[interval + 1];
+	for( int i = 0; i < maxIterations && a < b; ++i ) {
+		const float delta = table.mDistances[interval] + gaussLegendreIntegral( startT, t, speed ) - distance;
+		if( math<float>::abs( delta ) < tolerance )
+			break;
+
+		if( delta < 0 )
+			a = t;
+		else
+			b = t;
+
+		const float v = speed( t );
+		const float next = ( v > 0 ) ? t - delta / v : a;
+		t = ( next > a && next < b ) ? next : ( a + b ) * 0.5f;
+	}
+
+	return ( t + segment ) / (float)mSegments.size();
+}
+
+void Path2d::calcTimesForDistances( const float *distances, size_t count, float *resultTimes, bool wrap ) const
+{
+	const auto table = getArcLengthTable();
+	if( table->mDistances.empty() ) {
+		std::fill( resultTimes, resultTimes + count, 0.0f );
+		return;
+	}
+
+	const float numSegments = (float)mSegments.size();
+	for( size_t i = 0; i < count; ++i ) {
+		const float distance = wrapDistance( distances[i], table->mLength, wrap );
+		const size_t interval = table->findInterval( distance );
+		resultTimes[i] = ( table->interpolate( interval, distance ) + table->mSegments[interval] ) / numSegments;
+	}
+}
+
+void Path2d::calcPositionsForDistances( const float *distances, size_t count, vec2 *resultPositions, vec2 *resultTangents, bool wrap ) const
+{
+	const auto table = getArcLengthTable();
+	if( table->mDistances.empty() ) {
+		std::fill( resultPositions, resultPositions + count, mPoints.empty() ? vec2() : mPoints[0] );
+		if( resultTangents )
+			std::fill( resultTangents, resultTangents + count, vec2() );
+		return;
+	}
+
+	for( size_t i = 0; i < count; ++i ) {
+		const float distance = wrapDistance( distances[i], table->mLength, wrap );
+		const size_t interval = table->findInterval( distance );
+		const size_t segment = table->mSegments[interval];
+		const float t = table->interpolate( interval, distance );
+		if( mSegments[segment] == MOVETO ) {
+			resultPositions[i] = mPoints[table->mFirstPoints[segment]];
+			if( resultTangents )
+				resultTangents[i] = vec2();
+			continue;
+		}
+
+		resultPositions[i] = getSegmentPosition( segment, table->mFirstPoints[segment], t );
+		if( resultTangents )
+			resultTangents[i] = getSegmentTangent( segment, table->mFirstPoints[segment], t );
+	}
+}
+
 float Path2d::calcLength() const
 {
+	// integrating the segments is cheaper than building the arc length table when it isn't needed otherwise
+	if( auto table = std::atomic_load( &mArcLengthTable ) )
+		return table->mLength;
+
 	float result = 0;
 
 	size_t firstPoint = 0;
@@ -1713,19 +1988,13 @@ float Path2d::calcNormalizedTime( float relativeTime, bool wrap, float tolerance
 			return 0.0f;
 	}
 
-	float targetLength = calcLength() * math<float>::clamp( relativeTime, 0.0f, 1.0f );
+	const auto table = getArcLengthTable();
+	float targetLength = table->mLength * math<float>::clamp( relativeTime, 0.0f, 1.0f );
 	// test for 0-length Path2d
 	if( targetLength < 0.0001f )
 		return 0;
 
-	int currentSegment = 0;
-	float currentSegmentLength = calcSegmentLength( 0 );
-	while( targetLength > currentSegmentLength ) {
-		targetLength -= currentSegmentLength;
-		currentSegmentLength = calcSegmentLength( ++currentSegment );
-	}
-
-	return segmentSolveTimeForDistance( currentSegment, currentSegmentLength, targetLength, tolerance, maxIterations );
+	return solveTimeForDistance( *table, targetLength, tolerance, maxIterations );
 }
 
 float Path2d::calcTimeForDistance( float distance, bool wrap, float tolerance, int maxIterations ) const
@@ -1733,23 +2002,18 @@ float Path2d::calcTimeForDistance( float distance, bool wrap, float tolerance, i
 	if( mSegments.empty() )
 		return 0;
 
-	float totalLength = calcLength();
-	if( distance > totalLength ) {
+	const auto table = getArcLengthTable();
+	if( table->mLength <= 0 )
+		return 0;
+
+	if( distance > table->mLength ) {
 		if( wrap )
-			distance = fmodf( distance, totalLength );
+			distance = fmodf( distance, table->mLength );
 		else
 			return 1.0f;
 	}
 
-	// Iterate the segments to find the segment defining the range containing our targetLength
-	int currentSegment = 0;
-	float currentSegmentLength = calcSegmentLength( 0 );
-	while( distance > currentSegmentLength ) {
-		distance -= currentSegmentLength;
-		currentSegmentLength = calcSegmentLength(++currentSegment);
-	}
-
-	return segmentSolveTimeForDistance( currentSegment, currentSegmentLength, distance, tolerance, maxIterations );
+	return solveTimeForDistance( *table, std::max( distance, 0.0f ), tolerance, maxIterations );
 }
 
 float Path2d::segmentSolveTimeForDistance( size_t segment, float segmentLength, float segmentRelativeDistance, float tolerance, int maxIterations ) const
@@ -1794,67 +2058,18 @@ float Path2d::segmentSolveTimeForDistance( size_t segment, float segmentLength,
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Path2dCalcCache
 Path2dCalcCache::Path2dCalcCache( const Path2d &path )
-	: mPath( path ), mLength( path.calcLength() )
+	: mPath( path ), mLength( mPath.getArcLengthTable()->mLength )
 {
-	for( size_t i = 0; i < mPath.getNumSegments(); ++i )
-		mSegmentLengths.push_back( mPath.calcSegmentLength( i ) );
 }
 
 float Path2dCalcCache::calcNormalizedTime( float relativeTime, bool wrap, float tolerance, int maxIterations ) const
 {
-	if( mPath.mSegments.empty() )
-		return 0;
-
-	// Wrap relative time if necessary
-	if( relativeTime >= 1 ) {
-		if( wrap )
-			relativeTime = math<float>::fmod( relativeTime, 1.0f );
-		else
-			return 1.0f;
-	}
-	else if( relativeTime < 0 ) {
-		if( wrap )
-			relativeTime = 1.0f - math<float>::fmod( math<float>::abs( relativeTime ), 1.0f );
-		else
-			return 0.0f;
-	}
-
-	// We're looking for a length that is relativeTime * totalPathLength
-	float targetLength = mLength * math<float>::clamp( relativeTime, 0.0f, 1.0f );
-
-	// Iterate the segments to find the segment defining the range containing our targetLength
-	int currentSegment = 0;
-	float currentSegmentLength = mSegmentLengths[0];
-	while( targetLength > currentSegmentLength ) {
-		targetLength -= currentSegmentLength;
-		currentSegmentLength = mSegmentLengths[++currentSegment];
-	}
-
-	return mPath.segmentSolveTimeForDistance( currentSegment, currentSegmentLength, targetLength, tolerance, maxIterations );
+	return mPath.calcNormalizedTime( relativeTime, wrap, tolerance, maxIterations );
 }
 
 float Path2dCalcCache::calcTimeForDistance( float distance, bool wrap, float tolerance, int maxIterations ) const
 {
-	if( mPath.mSegments.empty() || mLength == 0 )
-		return 0;
-
-	if( distance > mLength ) {
-		if( wrap )
-			distance = fmodf( distance, mLength );
-		else
-			return 1.0f;
-	}
-
-	// Iterate the segments to find the segment defining the range containing our targetLength
-	int currentSegment = 0;
-	float currentSegmentLength = mSegmentLengths[0];
-	while( distance > currentSegmentLength ) {
-		distance -= currentSegmentLength;
-		currentSegmentLength = mSegmentLengths[++currentSegment];
-	}
-
-	return mPath.segmentSolveTimeForDistance( currentSegment, currentSegmentLength, distance, tolerance, maxIterations );
+	return mPath.calcTimeForDistance( distance, wrap, tolerance, maxIterations );
 }
 
-
 } // namespace cinder
@@ -27,6 +27,11 @@
 #include "cinder/Perlin.h"
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
+#include "cinder/Simd.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace cinder {
 
@@ -34,6 +39,10 @@ static inline float fade( float t ) { return t * t * t * (t * (t * 6 - 15) + 10)
 static inline float dfade( float t ) { return 30.0f * t * t * ( t * ( t - 2.0f ) + 1.0f ); }
 inline float nlerp(float t, float a, float b) { return a + t * (b - a); }
 
+// Simplex skewing factors, ( sqrt( 3 ) - 1 ) / 2 and ( 3 - sqrt( 3 ) ) / 6 in 2D
+static const float SIMPLEX_F2 = 0.366025403f, SIMPLEX_G2 = 0.211324865f;
+static const float SIMPLEX_F3 = 1.0f / 3.0f, SIMPLEX_G3 = 1.0f / 6.0f;
+
 Perlin::Perlin( uint8_t aOctaves, int32_t aSeed )
 	: mOctaves( aOctaves ), mSeed( aSeed ){
 	initPermutationTable();
@@ -306,6 +315,595 @@ float Perlin::grad( int32_t hash, float x, float y, float z ) const
 	return ((h&1) == 0 ? u : -u) + ((h&2) == 0 ? v : -v);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// simplex
+
+float Perlin::simplex( float x, float y ) const
+{
+	// skew into the simplex grid and find which of the cell's two triangles contains the point
+	const float s = ( x + y ) * SIMPLEX_F2;
+	const float fi = floorf( x + s ), fj = floorf( y + s );
+	const float t = ( fi + fj ) * SIMPLEX_G2;
+	const float x0 = x - ( fi - t ), y0 = y - ( fj - t );
+	const int32_t i1 = ( x0 > y0 ) ? 1 : 0, j1 = 1 - i1;
+
+	const float x1 = x0 - (float)i1 + SIMPLEX_G2, y1 = y0 - (float)j1 + SIMPLEX_G2;
+	const float x2 = x0 - 1.0f + 2.0f * SIMPLEX_G2, y2 = y0 - 1.0f + 2.0f * SIMPLEX_G2;
+	const int32_t ii = ((int32_t)fi) & 255, jj = ((int32_t)fj) & 255;
+
+	float n[3];
+	const float cx[3] = { x0, x1, x2 }, cy[3] = { y0, y1, y2 };
+	const int32_t hash[3] = { mPerms[ii + mPerms[jj]], mPerms[ii + i1 + mPerms[jj + j1]], mPerms[ii + 1 + mPerms[jj + 1]] };
+	for( int c = 0; c < 3; ++c ) {
+		float r = std::max( 0.5f - cx[c] * cx[c] - cy[c] * cy[c], 0.0f );
+		r *= r;
+		n[c] = r * r * grad( hash[c], cx[c], cy[c] );
+	}
+
+	return 70.0f * ( n[0] + n[1] + n[2] );
+}
+
+float Perlin::simplex( float x, float y, float z ) const
+{
+	const float s = ( x + y + z ) * SIMPLEX_F3;
+	const float fi = floorf( x + s ), fj = floorf( y + s ), fk = floorf( z + s );
+	const float t = ( fi + fj + fk ) * SIMPLEX_G3;
+	const float x0 = x - ( fi - t ), y0 = y - ( fj - t ), z0 = z - ( fk - t );
+
+	// the offsets of the second and third corners follow from the ordering of x0, y0 and z0
+	const bool xy = x0 >= y0, yz = y0 >= z0, xz = x0 >= z0;
+	const int32_t i1 = xy && xz, j1 = ! xy && yz, k1 = ! ( xz || yz );
+	const int32_t i2 = xy || xz, j2 = ! xy || yz, k2 = ! ( xz && yz );
+
+	const float cx[4] = { x0, x0 - (float)i1 + SIMPLEX_G3, x0 - (float)i2 + 2.0f * SIMPLEX_G3, x0 - 1.0f + 3.0f * SIMPLEX_G3 };
+	const float cy[4] = { y0, y0 - (float)j1 + SIMPLEX_G3, y0 - (float)j2 + 2.0f * SIMPLEX_G3, y0 - 1.0f + 3.0f * SIMPLEX_G3 };
+	const float cz[4] = { z0, z0 - (float)k1 + SIMPLEX_G3, z0 - (float)k2 + 2.0f * SIMPLEX_G3, z0 - 1.0f + 3.0f * SIMPLEX_G3 };
+	const int32_t ii = ((int32_t)fi) & 255, jj = ((int32_t)fj) & 255, kk = ((int32_t)fk) & 255;
+	const int32_t hash[4] = {	mPerms[ii + mPerms[jj + mPerms[kk]]],
+								mPerms[ii + i1 + mPerms[jj + j1 + mPerms[kk + k1]]],
+								mPerms[ii + i2 + mPerms[jj + j2 + mPerms[kk + k2]]],
+								mPerms[ii + 1 + mPerms[jj + 1 + mPerms[kk + 1]]] };
+
+	float n[4];
+	for( int c = 0; c < 4; ++c ) {
+		float r = std::max( 0.6f - cx[c] * cx[c] - cy[c] * cy[c] - cz[c] * cz[c], 0.0f );
+		r *= r;
+		n[c] = r * r * grad( hash[c], cx[c], cy[c], cz[c] );
+	}
+
+	return 32.0f * ( n[0] + n[1] + n[2] + n[3] );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// batched evaluation
+
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+namespace {
+
+// Four lanes of floats and integers, with the handful of operations the noise kernels need
+#if defined( CINDER_SIMD_SSE2 )
+typedef __m128	float4;
+typedef __m128i	int4;
+
+inline float4	splat( float v )						{ return _mm_set1_ps( v ); }
+inline float4	load4( const float *p )					{ return _mm_loadu_ps( p ); }
+inline void		store4( float *p, float4 v )			{ _mm_storeu_ps( p, v ); }
+inline float4	add( float4 a, float4 b )				{ return _mm_add_ps( a, b ); }
+inline float4	sub( float4 a, float4 b )				{ return _mm_sub_ps( a, b ); }
+inline float4	mul( float4 a, float4 b )				{ return _mm_mul_ps( a, b ); }
+inline float4	max4( float4 a, float4 b )				{ return _mm_max_ps( a, b ); }
+inline int4		greater( float4 a, float4 b )			{ return _mm_castps_si128( _mm_cmpgt_ps( a, b ) ); }
+inline int4		greaterEqual( float4 a, float4 b )		{ return _mm_castps_si128( _mm_cmpge_ps( a, b ) ); }
+//! Returns the lanes of \a a where \a mask is set and those of \a b elsewhere
+inline float4	select( int4 mask, float4 a, float4 b )	{ return _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( mask ), a ), _mm_andnot_ps( _mm_castsi128_ps( mask ), b ) ); }
+inline int4		truncate( float4 v )					{ return _mm_cvttps_epi32( v ); }
+inline float4	toFloat( int4 v )						{ return _mm_cvtepi32_ps( v ); }
+inline int4		splatInt( int32_t v )					{ return _mm_set1_epi32( v ); }
+inline int4		loadInt4( const int32_t *p )			{ return _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) ); }
+inline void		storeInt4( int32_t *p, int4 v )			{ _mm_storeu_si128( reinterpret_cast<__m128i*>( p ), v ); }
+inline int4		andInt( int4 a, int4 b )				{ return _mm_and_si128( a, b ); }
+inline int4		orInt( int4 a, int4 b )					{ return _mm_or_si128( a, b ); }
+inline int4		notInt( int4 a )						{ return _mm_xor_si128( a, _mm_set1_epi32( -1 ) ); }
+inline int4		lessInt( int4 a, int4 b )				{ return _mm_cmplt_epi32( a, b ); }
+inline int4		equalInt( int4 a, int4 b )				{ return _mm_cmpeq_epi32( a, b ); }
+template<int N>
+inline int4		shiftLeft( int4 a )						{ return _mm_slli_epi32( a, N ); }
+//! Flips the sign of the lanes of \a v for which bit 31 of \a bits is set
+inline float4	flipSign( float4 v, int4 bits )			{ return _mm_xor_ps( v, _mm_castsi128_ps( bits ) ); }
+#else
+typedef float32x4_t	float4;
+typedef int32x4_t	int4;
+
+inline float4	splat( float v )						{ return vdupq_n_f32( v ); }
+inline float4	load4( const float *p )					{ return vld1q_f32( p ); }
+inline void		store4( float *p, float4 v )			{ vst1q_f32( p, v ); }
+inline float4	add( float4 a, float4 b )				{ return vaddq_f32( a, b ); }
+inline float4	sub( float4 a, float4 b )				{ return vsubq_f32( a, b ); }
+inline float4	mul( float4 a, float4 b )				{ return vmulq_f32( a, b ); }
+inline float4	max4( float4 a, float4 b )				{ return vmaxq_f32( a, b ); }
+inline int4		greater( float4 a, float4 b )			{ return vreinterpretq_s32_u32( vcgtq_f32( a, b ) ); }
+inline int4		greaterEqual( float4 a, float4 b )		{ return vreinterpretq_s32_u32( vcgeq_f32( a, b ) ); }
+//! Returns the lanes of \a a where \a mask is set and those of \a b elsewhere
+inline float4	select( int4 mask, float4 a, float4 b )	{ return vbslq_f32( vreinterpretq_u32_s32( mask ), a, b ); }
+inline int4		truncate( float4 v )					{ return vcvtq_s32_f32( v ); }
+inline float4	toFloat( int4 v )						{ return vcvtq_f32_s32( v ); }
+inline int4		splatInt( int32_t v )					{ return vdupq_n_s32( v ); }
+inline int4		loadInt4( const int32_t *p )			{ return vld1q_s32( p ); }
+inline void		storeInt4( int32_t *p, int4 v )			{ vst1q_s32( p, v ); }
+inline int4		andInt( int4 a, int4 b )				{ return vandq_s32( a, b ); }
+inline int4		orInt( int4 a, int4 b )					{ return vorrq_s32( a, b ); }
+inline int4		notInt( int4 a )						{ return vmvnq_s32( a ); }
+inline int4		lessInt( int4 a, int4 b )				{ return vreinterpretq_s32_u32( vcltq_s32( a, b ) ); }
+inline int4		equalInt( int4 a, int4 b )				{ return vreinterpretq_s32_u32( vceqq_s32( a, b ) ); }
+template<int N>
+inline int4		shiftLeft( int4 a )						{ return vshlq_n_s32( a, N ); }
+//! Flips the sign of the lanes of \a v for which bit 31 of \a bits is set
+inline float4	flipSign( float4 v, int4 bits )			{ return vreinterpretq_f32_s32( veorq_s32( vreinterpretq_s32_f32( v ), bits ) ); }
+#endif
+
+inline float4 floor4( float4 v )
+{
+	const float4 t = toFloat( truncate( v ) );
+	return sub( t, select( greater( t, v ), splat( 1.0f ), splat( 0.0f ) ) );
+}
+
+inline float4 fade4( float4 t )		{ return mul( mul( mul( t, t ), t ), add( mul( t, sub( mul( t, splat( 6 ) ), splat( 15 ) ) ), splat( 10 ) ) ); }
+inline float4 dfade4( float4 t )	{ return mul( mul( mul( splat( 30.0f ), t ), t ), add( mul( t, sub( t, splat( 2.0f ) ) ), splat( 1.0f ) ) ); }
+inline float4 lerp4( float4 t, float4 a, float4 b )	{ return add( a, mul( t, sub( b, a ) ) ); }
+
+// Matches Perlin::grad( hash, x, y, z ); the 2D variant corresponds to a \a z of zero
+inline float4 grad4( int4 hash, float4 x, float4 y, float4 z )
+{
+	const int4 h = andInt( hash, splatInt( 15 ) );
+	const float4 u = select( lessInt( h, splatInt( 8 ) ), x, y );
+	const float4 v = select( lessInt( h, splatInt( 4 ) ), y, select( orInt( equalInt( h, splatInt( 12 ) ), equalInt( h, splatInt( 14 ) ) ), x, z ) );
+	return add( flipSign( u, shiftLeft<31>( h ) ), flipSign( v, shiftLeft<30>( andInt( h, splatInt( 2 ) ) ) ) );
+}
+
+// The table lookups have no vector equivalent without gathers, so each lane hashes its cell's corners in turn
+void hashCorners( const uint8_t *perms, int4 cellX, int4 cellY, int4 *result )
+{
+	int32_t X[4], Y[4], hashes[4][4];
+	storeInt4( X, cellX );
+	storeInt4( Y, cellY );
+	for( int l = 0; l < 4; ++l ) {
+		const int32_t A = perms[X[l]] + Y[l], B = perms[X[l] + 1] + Y[l];
+		hashes[0][l] = perms[perms[A]];
+		hashes[1][l] = perms[perms[B]];
+		hashes[2][l] = perms[perms[A + 1]];
+		hashes[3][l] = perms[perms[B + 1]];
+	}
+	for( int c = 0; c < 4; ++c )
+		result[c] = loadInt4( hashes[c] );
+}
+
+void hashCorners( const uint8_t *perms, int4 cellX, int4 cellY, int4 cellZ, int4 *result )
+{
+	int32_t X[4], Y[4], Z[4], hashes[8][4];
+	storeInt4( X, cellX );
+	storeInt4( Y, cellY );
+	storeInt4( Z, cellZ );
+	for( int l = 0; l < 4; ++l ) {
+		const int32_t A = perms[X[l]] + Y[l], AA = perms[A] + Z[l], AB = perms[A + 1] + Z[l];
+		const int32_t B = perms[X[l] + 1] + Y[l], BA = perms[B] + Z[l], BB = perms[B + 1] + Z[l];
+		hashes[0][l] = perms[AA];
+		hashes[1][l] = perms[BA];
+		hashes[2][l] = perms[AB];
+		hashes[3][l] = perms[BB];
+		hashes[4][l] = perms[AA + 1];
+		hashes[5][l] = perms[BA + 1];
+		hashes[6][l] = perms[AB + 1];
+		hashes[7][l] = perms[BB + 1];
+	}
+	for( int c = 0; c < 8; ++c )
+		result[c] = loadInt4( hashes[c] );
+}
+
+float4 noise4( const uint8_t *perms, float4 x, float4 y )
+{
+	const float4 fx = floor4( x ), fy = floor4( y );
+	int4 h[4];
+	hashCorners( perms, andInt( truncate( fx ), splatInt( 255 ) ), andInt( truncate( fy ), splatInt( 255 ) ), h );
+
+	x = sub( x, fx );
+	y = sub( y, fy );
+	const float4 u = fade4( x ), v = fade4( y );
+	const float4 zero = splat( 0 ), x1 = sub( x, splat( 1 ) ), y1 = sub( y, splat( 1 ) );
+
+	return lerp4( v, lerp4( u, grad4( h[0], x, y, zero ), grad4( h[1], x1, y, zero ) ),
+					 lerp4( u, grad4( h[2], x, y1, zero ), grad4( h[3], x1, y1, zero ) ) );
+}
+
+float4 noise4( const uint8_t *perms, float4 x, float4 y, float4 z )
+{
+	const float4 fx = floor4( x ), fy = floor4( y ), fz = floor4( z );
+	int4 h[8];
+	hashCorners( perms, andInt( truncate( fx ), splatInt( 255 ) ), andInt( truncate( fy ), splatInt( 255 ) ), andInt( truncate( fz ), splatInt( 255 ) ), h );
+
+	x = sub( x, fx );
+	y = sub( y, fy );
+	z = sub( z, fz );
+	const float4 u = fade4( x ), v = fade4( y ), w = fade4( z );
+	const float4 x1 = sub( x, splat( 1 ) ), y1 = sub( y, splat( 1 ) ), z1 = sub( z, splat( 1 ) );
+
+	return lerp4( w, lerp4( v, lerp4( u, grad4( h[0], x, y, z ), grad4( h[1], x1, y, z ) ),
+							   lerp4( u, grad4( h[2], x, y1, z ), grad4( h[3], x1, y1, z ) ) ),
+					 lerp4( v, lerp4( u, grad4( h[4], x, y, z1 ), grad4( h[5], x1, y, z1 ) ),
+							   lerp4( u, grad4( h[6], x, y1, z1 ), grad4( h[7], x1, y1, z1 ) ) ) );
+}
+
+// Derivatives below degenerate to 1 where the fade curve is flat, as in Perlin::dnoise()
+inline float4 nonZeroDfade4( float4 t )
+{
+	const float4 d = dfade4( t );
+	return select( greater( splat( 0.000001f ), d ), splat( 1.0f ), d );
+}
+
+void dnoise4( const uint8_t *perms, float4 x, float4 y, float4 *dx, float4 *dy )
+{
+	// Perlin::dnoise( x, y ) truncates rather than floors the cell coordinates
+	int4 h[4];
+	hashCorners( perms, andInt( truncate( x ), splatInt( 255 ) ), andInt( truncate( y ), splatInt( 255 ) ), h );
+
+	x = sub( x, floor4( x ) );
+	y = sub( y, floor4( y ) );
+	const float4 u = fade4( x ), v = fade4( y ), du = nonZeroDfade4( x ), dv = nonZeroDfade4( y );
+	const float4 zero = splat( 0 ), x1 = sub( x, splat( 1 ) ), y1 = sub( y, splat( 1 ) );
+
+	const float4 a = grad4( h[0], x, y, zero ), b = grad4( h[1], x1, y, zero ), c = grad4( h[2], x, y1, zero ), d = grad4( h[3], x1, y1, zero );
+	const float4 k1 = sub( b, a ), k2 = sub( c, a ), k4 = add( sub( sub( a, b ), c ), d );
+	*dx = mul( du, add( k1, mul( k4, v ) ) );
+	*dy = mul( dv, add( k2, mul( k4, u ) ) );
+}
+
+void dnoise4( const uint8_t *perms, float4 x, float4 y, float4 z, float4 *dx, float4 *dy, float4 *dz )
+{
+	const float4 fx = floor4( x ), fy = floor4( y ), fz = floor4( z );
+	int4 h[8];
+	hashCorners( perms, andInt( truncate( fx ), splatInt( 255 ) ), andInt( truncate( fy ), splatInt( 255 ) ), andInt( truncate( fz ), splatInt( 255 ) ), h );
+
+	x = sub( x, fx );
+	y = sub( y, fy );
+	z = sub( z, fz );
+	const float4 u = fade4( x ), v = fade4( y ), w = fade4( z );
+	const float4 du = nonZeroDfade4( x ), dv = nonZeroDfade4( y ), dw = nonZeroDfade4( z );
+	const float4 x1 = sub( x, splat( 1 ) ), y1 = sub( y, splat( 1 ) ), z1 = sub( z, splat( 1 ) );
+
+	const float4 a = grad4( h[0], x, y, z ), b = grad4( h[1], x1, y, z ), c = grad4( h[2], x, y1, z ), d = grad4( h[3], x1, y1, z );
+	const float4 e = grad4( h[4], x, y, z1 ), f = grad4( h[5], x1, y, z1 ), g = grad4( h[6], x, y1, z1 ), k = grad4( h[7], x1, y1, z1 );
+
+	const float4 k1 = sub( b, a ), k2 = sub( c, a ), k3 = sub( e, a );
+	const float4 k4 = add( sub( sub( a, b ), c ), d );
+	const float4 k5 = add( sub( sub( a, c ), e ), g );
+	const float4 k6 = add( sub( sub( a, b ), e ), f );
+	const float4 k7 = add( sub( sub( add( sub( add( add( sub( splat( 0 ), a ), b ), c ), d ), e ), f ), g ), k );
+
+	*dx = mul( du, add( add( add( k1, mul( k4, v ) ), mul( k6, w ) ), mul( mul( k7, v ), w ) ) );
+	*dy = mul( dv, add( add( add( k2, mul( k5, w ) ), mul( k4, u ) ), mul( mul( k7, w ), u ) ) );
+	*dz = mul( dw, add( add( add( k3, mul( k6, u ) ), mul( k5, v ) ), mul( mul( k7, u ), v ) ) );
+}
+
+inline float4 simplexCorner4( int4 hash, float4 x, float4 y, float4 z, float radius )
+{
+	float4 r = max4( sub( sub( sub( splat( radius ), mul( x, x ) ), mul( y, y ) ), mul( z, z ) ), splat( 0.0f ) );
+	r = mul( r, r );
+	return mul( mul( r, r ), grad4( hash, x, y, z ) );
+}
+
+float4 simplex4( const uint8_t *perms, float4 x, float4 y )
+{
+	const float4 s = mul( add( x, y ), splat( SIMPLEX_F2 ) );
+	const float4 fi = floor4( add( x, s ) ), fj = floor4( add( y, s ) );
+	const float4 t = mul( add( fi, fj ), splat( SIMPLEX_G2 ) );
+	const float4 x0 = sub( x, sub( fi, t ) ), y0 = sub( y, sub( fj, t ) );
+	const int4 xGreater = greater( x0, y0 );
+	const float4 one = splat( 1.0f ), zero = splat( 0.0f ), i1 = select( xGreater, one, zero ), j1 = sub( one, i1 );
+
+	int32_t ii[4], jj[4], offset[4], hashes[3][4];
+	storeInt4( ii, andInt( truncate( fi ), splatInt( 255 ) ) );
+	storeInt4( jj, andInt( truncate( fj ), splatInt( 255 ) ) );
+	storeInt4( offset, andInt( xGreater, splatInt( 1 ) ) );
+	for( int l = 0; l < 4; ++l ) {
+		hashes[0][l] = perms[ii[l] + perms[jj[l]]];
+		hashes[1][l] = perms[ii[l] + offset[l] + perms[jj[l] + 1 - offset[l]]];
+		hashes[2][l] = perms[ii[l] + 1 + perms[jj[l] + 1]];
+	}
+
+	const float4 n0 = simplexCorner4( loadInt4( hashes[0] ), x0, y0, zero, 0.5f );
+	const float4 n1 = simplexCorner4( loadInt4( hashes[1] ), add( sub( x0, i1 ), splat( SIMPLEX_G2 ) ), add( sub( y0, j1 ), splat( SIMPLEX_G2 ) ), zero, 0.5f );
+	const float4 n2 = simplexCorner4( loadInt4( hashes[2] ), add( sub( x0, one ), splat( 2.0f * SIMPLEX_G2 ) ), add( sub( y0, one ), splat( 2.0f * SIMPLEX_G2 ) ), zero, 0.5f );
+	return mul( splat( 70.0f ), add( add( n0, n1 ), n2 ) );
+}
+
+float4 simplex4( const uint8_t *perms, float4 x, float4 y, float4 z )
+{
+	const float4 s = mul( add( add( x, y ), z ), splat( SIMPLEX_F3 ) );
+	const float4 fi = floor4( add( x, s ) ), fj = floor4( add( y, s ) ), fk = floor4( add( z, s ) );
+	const float4 t = mul( add( add( fi, fj ), fk ), splat( SIMPLEX_G3 ) );
+	const float4 x0 = sub( x, sub( fi, t ) ), y0 = sub( y, sub( fj, t ) ), z0 = sub( z, sub( fk, t ) );
+
+	const int4 xy = greaterEqual( x0, y0 ), yz = greaterEqual( y0, z0 ), xz = greaterEqual( x0, z0 );
+	const int4 i1 = andInt( xy, xz ), j1 = andInt( notInt( xy ), yz ), k1 = notInt( orInt( xz, yz ) );
+	const int4 i2 = orInt( xy, xz ), j2 = orInt( notInt( xy ), yz ), k2 = notInt( andInt( xz, yz ) );
+
+	int32_t ii[4], jj[4], kk[4], o1[3][4], o2[3][4], hashes[4][4];
+	storeInt4( ii, andInt( truncate( fi ), splatInt( 255 ) ) );
+	storeInt4( jj, andInt( truncate( fj ), splatInt( 255 ) ) );
+	storeInt4( kk, andInt( truncate( fk ), splatInt( 255 ) ) );
+	const int4 one = splatInt( 1 );
+	storeInt4( o1[0], andInt( i1, one ) );
+	storeInt4( o1[1], andInt( j1, one ) );
+	storeInt4( o1[2], andInt( k1, one ) );
+	storeInt4( o2[0], andInt( i2, one ) );
+	storeInt4( o2[1], andInt( j2, one ) );
+	storeInt4( o2[2], andInt( k2, one ) );
+	for( int l = 0; l < 4; ++l ) {
+		hashes[0][l] = perms[ii[l] + perms[jj[l] + perms[kk[l]]]];
+		hashes[1][l] = perms[ii[l] + o1[0][l] + perms[jj[l] + o1[1][l] + perms[kk[l] + o1[2][l]]]];
+		hashes[2][l] = perms[ii[l] + o2[0][l] + perms[jj[l] + o2[1][l] + perms[kk[l] + o2[2][l]]]];
+		hashes[3][l] = perms[ii[l] + 1 + perms[jj[l] + 1 + perms[kk[l] + 1]]];
+	}
+
+	const float4 onef = splat( 1.0f ), zero = splat( 0.0f ), g1 = splat( SIMPLEX_G3 ), g2 = splat( 2.0f * SIMPLEX_G3 ), g3 = splat( 3.0f * SIMPLEX_G3 );
+	const float4 n0 = simplexCorner4( loadInt4( hashes[0] ), x0, y0, z0, 0.6f );
+	const float4 n1 = simplexCorner4( loadInt4( hashes[1] ), add( sub( x0, select( i1, onef, zero ) ), g1 ), add( sub( y0, select( j1, onef, zero ) ), g1 ), add( sub( z0, select( k1, onef, zero ) ), g1 ), 0.6f );
+	const float4 n2 = simplexCorner4( loadInt4( hashes[2] ), add( sub( x0, select( i2, onef, zero ) ), g2 ), add( sub( y0, select( j2, onef, zero ) ), g2 ), add( sub( z0, select( k2, onef, zero ) ), g2 ), 0.6f );
+	const float4 n3 = simplexCorner4( loadInt4( hashes[3] ), add( sub( x0, onef ), g3 ), add( sub( y0, onef ), g3 ), add( sub( z0, onef ), g3 ), 0.6f );
+	return mul( splat( 32.0f ), add( add( add( n0, n1 ), n2 ), n3 ) );
+}
+
+inline void loadPoints( const vec2 *points, float4 *x, float4 *y )
+{
+	float xs[4], ys[4];
+	for( int l = 0; l < 4; ++l ) {
+		xs[l] = points[l].x;
+		ys[l] = points[l].y;
+	}
+	*x = load4( xs );
+	*y = load4( ys );
+}
+
+inline void loadPoints( const vec3 *points, float4 *x, float4 *y, float4 *z )
+{
+	float xs[4], ys[4], zs[4];
+	for( int l = 0; l < 4; ++l ) {
+		xs[l] = points[l].x;
+		ys[l] = points[l].y;
+		zs[l] = points[l].z;
+	}
+	*x = load4( xs );
+	*y = load4( ys );
+	*z = load4( zs );
+}
+
+inline void storePoints( vec2 *points, float4 x, float4 y )
+{
+	float xs[4], ys[4];
+	store4( xs, x );
+	store4( ys, y );
+	for( int l = 0; l < 4; ++l )
+		points[l] = vec2( xs[l], ys[l] );
+}
+
+inline void storePoints( vec3 *points, float4 x, float4 y, float4 z )
+{
+	float xs[4], ys[4], zs[4];
+	store4( xs, x );
+	store4( ys, y );
+	store4( zs, z );
+	for( int l = 0; l < 4; ++l )
+		points[l] = vec3( xs[l], ys[l], zs[l] );
+}
+
+} // anonymous namespace
+#endif // defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+
+namespace {
+
+// Evaluates \a fn, a batched Perlin function, on the pixel grid of \a channel with rows distributed across threads
+template<typename FnT>
+void fillChannel( Channel32f *channel, const vec2 &origin, const vec2 &scale, const FnT &fn )
+{
+	const int32_t width = channel->getWidth();
+	const uint8_t increment = channel->getIncrement();
+	parallelFor( 0, (size_t)channel->getHeight(), 16, [&]( size_t rowBegin, size_t rowEnd ) {
+		std::vector<vec2> points( width );
+		std::vector<float> values( width );
+		for( size_t y = rowBegin; y < rowEnd; ++y ) {
+			for( int32_t x = 0; x < width; ++x )
+				points[x] = origin + scale * vec2( (float)x, (float)y );
+			fn( points.data(), (size_t)width, values.data() );
+
+			float *row = channel->getData( 0, (int32_t)y );
+			for( int32_t x = 0; x < width; ++x )
+				row[x * increment] = values[x];
+		}
+	} );
+}
+
+} // anonymous namespace
+
+void Perlin::fBm( const vec2 *points, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, sum = splat( 0.0f );
+		loadPoints( points + i, &x, &y );
+		float amp = 0.5f;
+		for( uint8_t o = 0; o < mOctaves; o++ ) {
+			sum = add( sum, mul( noise4( mPerms, x, y ), splat( amp ) ) );
+			x = mul( x, splat( 2.0f ) ); y = mul( y, splat( 2.0f ) );
+			amp *= 0.5f;
+		}
+		store4( result + i, sum );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = fBm( points[i] );
+}
+
+void Perlin::fBm( const vec3 *points, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, z, sum = splat( 0.0f );
+		loadPoints( points + i, &x, &y, &z );
+		float amp = 0.5f;
+		for( uint8_t o = 0; o < mOctaves; o++ ) {
+			sum = add( sum, mul( noise4( mPerms, x, y, z ), splat( amp ) ) );
+			x = mul( x, splat( 2.0f ) ); y = mul( y, splat( 2.0f ) ); z = mul( z, splat( 2.0f ) );
+			amp *= 0.5f;
+		}
+		store4( result + i, sum );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = fBm( points[i] );
+}
+
+void Perlin::dfBm( const vec2 *points, size_t count, vec2 *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, sumX = splat( 0.0f ), sumY = splat( 0.0f );
+		loadPoints( points + i, &x, &y );
+		float amp = 0.5f;
+		for( uint8_t o = 0; o < mOctaves; o++ ) {
+			float4 dx, dy;
+			dnoise4( mPerms, x, y, &dx, &dy );
+			sumX = add( sumX, mul( dx, splat( amp ) ) );
+			sumY = add( sumY, mul( dy, splat( amp ) ) );
+			x = mul( x, splat( 2.0f ) ); y = mul( y, splat( 2.0f ) );
+			amp *= 0.5f;
+		}
+		storePoints( result + i, sumX, sumY );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = dfBm( points[i] );
+}
+
+void Perlin::dfBm( const vec3 *points, size_t count, vec3 *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, z, sumX = splat( 0.0f ), sumY = splat( 0.0f ), sumZ = splat( 0.0f );
+		loadPoints( points + i, &x, &y, &z );
+		float amp = 0.5f;
+		for( uint8_t o = 0; o < mOctaves; o++ ) {
+			float4 dx, dy, dz;
+			dnoise4( mPerms, x, y, z, &dx, &dy, &dz );
+			sumX = add( sumX, mul( dx, splat( amp ) ) );
+			sumY = add( sumY, mul( dy, splat( amp ) ) );
+			sumZ = add( sumZ, mul( dz, splat( amp ) ) );
+			x = mul( x, splat( 2.0f ) ); y = mul( y, splat( 2.0f ) ); z = mul( z, splat( 2.0f ) );
+			amp *= 0.5f;
+		}
+		storePoints( result + i, sumX, sumY, sumZ );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = dfBm( points[i] );
+}
+
+void Perlin::noise( const vec2 *points, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y;
+		loadPoints( points + i, &x, &y );
+		store4( result + i, noise4( mPerms, x, y ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = noise( points[i] );
+}
+
+void Perlin::noise( const vec3 *points, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, z;
+		loadPoints( points + i, &x, &y, &z );
+		store4( result + i, noise4( mPerms, x, y, z ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = noise( points[i] );
+}
+
+void Perlin::dnoise( const vec2 *points, size_t count, vec2 *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, dx, dy;
+		loadPoints( points + i, &x, &y );
+		dnoise4( mPerms, x, y, &dx, &dy );
+		storePoints( result + i, dx, dy );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = dnoise( points[i].x, points[i].y );
+}
 
+void Perlin::dnoise( const vec3 *points, size_t count, vec3 *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, z, dx, dy, dz;
+		loadPoints( points + i, &x, &y, &z );
+		dnoise4( mPerms, x, y, z, &dx, &dy, &dz );
+		storePoints( result + i, dx, dy, dz );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = dnoise( points[i].x, points[i].y, points[i].z );
+}
+
+void Perlin::simplex( const vec2 *points, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y;
+		loadPoints( points + i, &x, &y );
+		store4( result + i, simplex4( mPerms, x, y ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = simplex( points[i] );
+}
+
+void Perlin::simplex( const vec3 *points, size_t count, float *result ) const
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		float4 x, y, z;
+		loadPoints( points + i, &x, &y, &z );
+		store4( result + i, simplex4( mPerms, x, y, z ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = simplex( points[i] );
+}
+
+void Perlin::fBm( Channel32f *channel, const vec2 &origin, const vec2 &scale ) const
+{
+	fillChannel( channel, origin, scale, [this]( const vec2 *points, size_t count, float *result ) { fBm( points, count, result ); } );
+}
+
+void Perlin::noise( Channel32f *channel, const vec2 &origin, const vec2 &scale ) const
+{
+	fillChannel( channel, origin, scale, [this]( const vec2 *points, size_t count, float *result ) { noise( points, count, result ); } );
+}
 
 } // namespace cinder
@@ -143,6 +143,90 @@ PolyLineT<T> PolyLineT<T>::reversed() const
 	return result;
 }
 
+namespace {
+
+// Marks the points between points[first] and points[last] that the Ramer-Douglas-Peucker algorithm keeps. Iterative so that long lines can't overflow the stack.
+template<typename T>
+void markSimplified( const std::vector<T> &points, size_t first, size_t last, double toleranceSqrd, std::vector<bool> *keep )
+{
+	std::vector<std::pair<size_t, size_t>> spans( 1, std::make_pair( first, last ) );
+	while( ! spans.empty() ) {
+		size_t begin = spans.back().first, end = spans.back().second;
+		spans.pop_back();
+
+		const dvec2 a( points[begin] ), ab = dvec2( points[end] ) - a;
+		const double lengthSqrd = dot( ab, ab );
+		double maxDistanceSqrd = 0;
+		size_t farthest = begin;
+		for( size_t i = begin + 1; i < end; ++i ) {
+			dvec2 ap = dvec2( points[i] ) - a;
+			double t = ( lengthSqrd > 0 ) ? glm::clamp( dot( ap, ab ) / lengthSqrd, 0.0, 1.0 ) : 0.0;
+			double distanceSqrd = length2( ap - ab * t );
+			if( distanceSqrd > maxDistanceSqrd ) {
+				maxDistanceSqrd = distanceSqrd;
+				farthest = i;
+			}
+		}
+
+		if( maxDistanceSqrd > toleranceSqrd ) {
+			(*keep)[farthest] = true;
+			spans.emplace_back( begin, farthest );
+			spans.emplace_back( farthest, end );
+		}
+	}
+}
+
+} // anonymous namespace
+
+template<typename T>
+void PolyLineT<T>::simplify( float tolerance )
+{
+	if( mPoints.size() < 3 )
+		return;
+
+	// a closed PolyLine is simplified as a loop from the first point back to itself
+	const bool appendFirst = mClosed && mPoints.front() != mPoints.back();
+	if( appendFirst )
+		mPoints.push_back( mPoints.front() );
+
+	const size_t last = mPoints.size() - 1;
+	const double toleranceSqrd = (double)tolerance * tolerance;
+	std::vector<bool> keep( mPoints.size(), false );
+	keep[0] = keep[last] = true;
+	if( mClosed ) {
+		// the loop's end points coincide, so split it at the point farthest from them
+		size_t farthest = 0;
+		double maxDistanceSqrd = 0;
+		for( size_t i = 1; i < last; ++i ) {
+			double distanceSqrd = length2( dvec2( mPoints[i] ) - dvec2( mPoints[0] ) );
+			if( distanceSqrd > maxDistanceSqrd ) {
+				maxDistanceSqrd = distanceSqrd;
+				farthest = i;
+			}
+		}
+		keep[farthest] = true;
+		markSimplified( mPoints, 0, farthest, toleranceSqrd, &keep );
+		markSimplified( mPoints, farthest, last, toleranceSqrd, &keep );
+	}
+	else
+		markSimplified( mPoints, 0, last, toleranceSqrd, &keep );
+
+	size_t numKept = 0;
+	for( size_t i = 0; i <= last; ++i ) {
+		if( keep[i] )
+			mPoints[numKept++] = mPoints[i];
+	}
+	mPoints.resize( appendFirst ? numKept - 1 : numKept );
+}
+
+template<typename T>
+PolyLineT<T> PolyLineT<T>::simplified( float tolerance ) const
+{
+	PolyLineT result( *this );
+	result.simplify( tolerance );
+	return result;
+}
+
 template<typename T>
 T linearYatX( const glm::tvec2<T, glm::defaultp> p[2], T x )
 {
@@ -0,0 +1,664 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/PolygonOps.h"
+
+#include <algorithm>
+#include <deque>
+#include <queue>
+#include <set>
+
+namespace cinder { namespace polygon {
+
+namespace {
+
+typedef std::vector<dvec2>	Contour;
+
+// Returns twice the signed area of the triangle a, b, c, which is positive when c lies left of the line from a to b
+inline double signedArea( const dvec2 &a, const dvec2 &b, const dvec2 &c )
+{
+	return ( a.x - c.x ) * ( b.y - c.y ) - ( b.x - c.x ) * ( a.y - c.y );
+}
+
+inline double cross2( const dvec2 &a, const dvec2 &b )
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+// The order in which the sweep line visits points, left to right and bottom to top
+inline bool pointLess( const dvec2 &a, const dvec2 &b )
+{
+	return a.x < b.x || ( a.x == b.x && a.y < b.y );
+}
+
+struct SweepEvent;
+
+// Orders the segments crossing the sweep line from bottom to top
+struct SegmentLess {
+	bool operator()( const SweepEvent *a, const SweepEvent *b ) const;
+};
+
+typedef std::set<SweepEvent*, SegmentLess>	SweepStatus;
+
+// One end point of a segment. Each segment has a left and a right event which point at each other.
+struct SweepEvent {
+	dvec2					point;
+	SweepEvent				*other;
+	double					angle;		// direction from the left to the right end point
+	uint32_t				segment;	// index of the input segment, inherited when splitting; breaks ties between collinear segments
+	uint8_t					polygon;	// 0 for the subject, 1 for the clip
+	bool					left;
+	SweepStatus::iterator	position;	// valid while a left event is on the sweep line
+};
+
+// Returns whether segment e lies below point p
+inline bool isBelow( const SweepEvent *e, const dvec2 &p )
+{
+	return e->left ? signedArea( e->point, e->other->point, p ) > 0 : signedArea( e->other->point, e->point, p ) > 0;
+}
+
+// Returns whether a is processed after b
+bool eventAfter( const SweepEvent *a, const SweepEvent *b )
+{
+	if( a->point.x != b->point.x )
+		return a->point.x > b->point.x;
+	if( a->point.y != b->point.y )
+		return a->point.y > b->point.y;
+	// segments ending at a point leave the sweep line before the ones starting there enter it
+	if( a->left != b->left )
+		return a->left;
+	// the lower segment first
+	const dvec2 &left = a->left ? a->point : a->other->point, &right = a->left ? a->other->point : a->point;
+	double area = signedArea( left, right, b->other->point );
+	if( area != 0 )
+		return area < 0;
+	// collinear segments: the subject first, then in input order
+	if( a->polygon != b->polygon )
+		return a->polygon > b->polygon;
+	return a->segment > b->segment;
+}
+
+// Returns pointers to the events in the order of eventAfter(), where the angle of the segments replaces orientation tests to be a consistent sort key.
+// Compact copies of the keys are sorted, which is considerably faster than sorting pointers to the scattered events.
+template<typename EventContainer>
+std::vector<SweepEvent*> sortEvents( EventContainer &events )
+{
+	struct Key {
+		dvec2		point;
+		double		angle;
+		uint32_t	index, segment;
+		uint8_t		polygon;
+		bool		left;
+	};
+
+	std::vector<Key> keys( events.size() );
+	for( size_t i = 0; i < events.size(); ++i ) {
+		const SweepEvent &e = events[i];
+		keys[i] = { e.point, e.angle, (uint32_t)i, e.segment, e.polygon, e.left };
+	}
+	std::sort( keys.begin(), keys.end(), []( const Key &a, const Key &b ) {
+		if( a.point != b.point )
+			return pointLess( a.point, b.point );
+		if( a.left != b.left )
+			return ! a.left;
+		if( a.angle != b.angle )
+			return a.left ? a.angle < b.angle : a.angle > b.angle;
+		if( a.polygon != b.polygon )
+			return a.polygon < b.polygon;
+		return a.segment < b.segment;
+	} );
+
+	std::vector<SweepEvent*> result( keys.size() );
+	for( size_t i = 0; i < keys.size(); ++i )
+		result[i] = &events[keys[i].index];
+	return result;
+}
+
+struct EventAfter {
+	bool operator()( const SweepEvent *a, const SweepEvent *b ) const { return eventAfter( a, b ); }
+};
+
+bool SegmentLess::operator()( const SweepEvent *a, const SweepEvent *b ) const
+{
+	if( a == b )
+		return false;
+
+	const double areaLeft = signedArea( a->point, a->other->point, b->point );
+	const double areaRight = signedArea( a->point, a->other->point, b->other->point );
+	if( areaLeft != 0 || areaRight != 0 ) {
+		// segments sharing their left end point are ordered by their right end points
+		if( a->point == b->point )
+			return areaRight > 0;
+		// segments starting on the same vertical are ordered by their left end points
+		if( a->point.x == b->point.x )
+			return a->point.y < b->point.y;
+		// otherwise the left end point of the segment inserted later decides
+		if( eventAfter( a, b ) )
+			return ! isBelow( b, a->point );
+		return areaLeft > 0;
+	}
+
+	// collinear segments: the subject below the clip, then in the order they were inserted
+	if( a->polygon != b->polygon )
+		return a->polygon < b->polygon;
+	if( a->point != b->point )
+		return eventAfter( b, a );
+	return a->segment < b->segment;
+}
+
+// A piece of the input edges between two consecutive intersections. p0 comes before p1 on the sweep.
+struct Edge {
+	dvec2	p0, p1;
+	int		winding[2];			// change of the subject's and the clip's winding number when crossing the edge upwards
+	int		windingBelow[2];	// winding numbers of the region just below the edge
+};
+
+// Splits the edges of the subject and clip contours at all of their intersections with a Bentley-Ottmann sweep
+class EdgeSplitter {
+  public:
+	EdgeSplitter( double snapDistance )
+		: mSnapDistanceSqrd( snapDistance * snapDistance ), mNumSegments( 0 )
+	{}
+
+	void addContour( const Contour &contour, uint8_t polygon )
+	{
+		for( size_t i = 0; i < contour.size(); ++i ) {
+			const dvec2 &a = contour[i], &b = contour[( i + 1 ) % contour.size()];
+			if( a == b )
+				continue;
+			// crossing an edge running left to right upwards enters a counterclockwise contour
+			const bool forward = pointLess( a, b );
+			SweepEvent *left = newEvent( forward ? a : b, true, nullptr, polygon, mNumSegments );
+			SweepEvent *right = newEvent( forward ? b : a, false, left, polygon, mNumSegments );
+			left->other = right;
+			left->angle = right->angle = atan2( right->point.y - left->point.y, right->point.x - left->point.x );
+			mWindings.push_back( forward ? 1 : -1 );
+			++mNumSegments;
+		}
+	}
+
+	// Returns the split edges, coincident edges merged into one
+	std::vector<Edge> run()
+	{
+		// the input's events are sorted up front, only the ones created by splitting segments go through the priority queue
+		const std::vector<SweepEvent*> sorted = sortEvents( mEvents );
+		size_t nextSorted = 0;
+
+		std::vector<Edge> edges;
+		edges.reserve( mNumSegments * 2 );
+		while( nextSorted < sorted.size() || ! mQueue.empty() ) {
+			SweepEvent *e;
+			if( ! mQueue.empty() && ( nextSorted == sorted.size() || eventAfter( sorted[nextSorted], mQueue.top() ) ) ) {
+				e = mQueue.top();
+				mQueue.pop();
+			}
+			else
+				e = sorted[nextSorted++];
+
+			if( e->left ) {
+				e->position = mStatus.insert( e ).first;
+				auto next = std::next( e->position );
+				if( next != mStatus.end() )
+					intersect( e, *next );
+				if( e->position != mStatus.begin() )
+					intersect( *std::prev( e->position ), e );
+			}
+			else {
+				SweepEvent *left = e->other;
+				auto next = std::next( left->position );
+				auto prev = ( left->position != mStatus.begin() ) ? std::prev( left->position ) : mStatus.end();
+				mStatus.erase( left->position );
+				if( prev != mStatus.end() && next != mStatus.end() )
+					intersect( *prev, *next );
+
+				Edge edge = { left->point, e->point, { 0, 0 }, { 0, 0 } };
+				edge.winding[left->polygon] = mWindings[left->segment];
+				edges.push_back( edge );
+			}
+		}
+
+		// merge coincident edges, summing their windings
+		std::sort( edges.begin(), edges.end(), []( const Edge &a, const Edge &b ) {
+			return pointLess( a.p0, b.p0 ) || ( a.p0 == b.p0 && pointLess( a.p1, b.p1 ) );
+		} );
+		size_t numMerged = 0;
+		for( size_t i = 0; i < edges.size(); ) {
+			Edge merged = edges[i];
+			for( ++i; i < edges.size() && edges[i].p0 == merged.p0 && edges[i].p1 == merged.p1; ++i ) {
+				merged.winding[0] += edges[i].winding[0];
+				merged.winding[1] += edges[i].winding[1];
+			}
+			// edges whose windings cancel out don't separate different regions
+			if( merged.winding[0] != 0 || merged.winding[1] != 0 )
+				edges[numMerged++] = merged;
+		}
+		edges.resize( numMerged );
+		return edges;
+	}
+
+  private:
+	SweepEvent* newEvent( const dvec2 &point, bool left, SweepEvent *other, uint8_t polygon, uint32_t segment )
+	{
+		mEvents.push_back( SweepEvent() );
+		SweepEvent *e = &mEvents.back();
+		e->point = point;
+		e->other = other;
+		e->segment = segment;
+		e->polygon = polygon;
+		e->left = left;
+		return e;
+	}
+
+	// Splits the segment of left event e at p, which has to lie strictly between its end points. Returns the left event of the new piece.
+	SweepEvent* divide( SweepEvent *e, const dvec2 &p )
+	{
+		if( ! pointLess( e->point, p ) || ! pointLess( p, e->other->point ) )
+			return nullptr;
+
+		SweepEvent *right = newEvent( p, false, e, e->polygon, e->segment );
+		SweepEvent *left = newEvent( p, true, e->other, e->polygon, e->segment );
+		right->angle = left->angle = e->angle;
+		e->other->other = left;
+		e->other = right;
+		mQueue.push( right );
+		mQueue.push( left );
+		return left;
+	}
+
+	// Splits the segments of the left events a and b, which are neighbors on the sweep line, where they intersect or overlap
+	void intersect( SweepEvent *a, SweepEvent *b )
+	{
+		const dvec2 a0 = a->point, a1 = a->other->point, b0 = b->point, b1 = b->other->point;
+		if( std::max( a0.y, a1.y ) < std::min( b0.y, b1.y ) || std::max( b0.y, b1.y ) < std::min( a0.y, a1.y ) )
+			return;
+
+		const double o1 = signedArea( a0, a1, b0 ), o2 = signedArea( a0, a1, b1 );
+		if( o1 != 0 || o2 != 0 ) {
+			const double o3 = signedArea( b0, b1, a0 ), o4 = signedArea( b0, b1, a1 );
+			if( ( o1 > 0 && o2 > 0 ) || ( o1 < 0 && o2 < 0 ) || ( o3 > 0 && o4 > 0 ) || ( o3 < 0 && o4 < 0 ) || o3 == o4 )
+				return;
+
+			dvec2 p;
+			if( o1 == 0 )
+				p = b0;
+			else if( o2 == 0 )
+				p = b1;
+			else if( o3 == 0 )
+				p = a0;
+			else if( o4 == 0 )
+				p = a1;
+			else {
+				p = a0 + ( a1 - a0 ) * ( o3 / ( o3 - o4 ) );
+				// snap to nearby end points so that rounding doesn't create tiny pieces
+				for( const dvec2 &end : { a0, a1, b0, b1 } ) {
+					if( distance2( p, end ) <= mSnapDistanceSqrd ) {
+						p = end;
+						break;
+					}
+				}
+			}
+
+			if( p != a0 && p != a1 )
+				divide( a, p );
+			if( p != b0 && p != b1 )
+				divide( b, p );
+			return;
+		}
+
+		// collinear segments overlap unless they're disjoint or only touch
+		if( ! pointLess( b0, a1 ) || ! pointLess( a0, b1 ) )
+			return;
+		const bool leftCoincide = a0 == b0, rightCoincide = a1 == b1;
+		if( leftCoincide && rightCoincide )
+			return;
+		if( leftCoincide ) {
+			// the longer segment is split where the shorter one ends
+			if( pointLess( a1, b1 ) )
+				divide( b, a1 );
+			else
+				divide( a, b1 );
+			return;
+		}
+
+		SweepEvent *first = pointLess( a0, b0 ) ? a : b, *second = ( first == a ) ? b : a;
+		const dvec2 firstEnd = first->other->point, secondStart = second->point, secondEnd = second->other->point;
+		SweepEvent *remainder = divide( first, secondStart );
+		if( ! rightCoincide ) {
+			if( pointLess( firstEnd, secondEnd ) )
+				divide( second, firstEnd );
+			else if( remainder )
+				divide( remainder, secondEnd );
+		}
+	}
+
+	double				mSnapDistanceSqrd;
+	uint32_t			mNumSegments;
+	std::vector<int>	mWindings;
+	std::deque<SweepEvent>	mEvents;
+	std::priority_queue<SweepEvent*, std::vector<SweepEvent*>, EventAfter>	mQueue;
+	SweepStatus			mStatus;
+};
+
+// Computes the winding numbers below each edge with a second sweep. The edges no longer intersect, which keeps the sweep line's order consistent.
+void computeWindings( std::vector<Edge> *edges )
+{
+	std::vector<SweepEvent> events( edges->size() * 2 );
+	for( size_t i = 0; i < edges->size(); ++i ) {
+		const Edge &edge = (*edges)[i];
+		SweepEvent &left = events[i * 2], &right = events[i * 2 + 1];
+		left.point = edge.p0;
+		right.point = edge.p1;
+		left.other = &right;
+		right.other = &left;
+		left.left = true;
+		right.left = false;
+		left.segment = right.segment = (uint32_t)i;
+		left.polygon = right.polygon = 0;
+		left.angle = right.angle = atan2( edge.p1.y - edge.p0.y, edge.p1.x - edge.p0.x );
+	}
+	const std::vector<SweepEvent*> order = sortEvents( events );
+
+	SweepStatus status;
+	for( SweepEvent *e : order ) {
+		if( e->left ) {
+			e->position = status.insert( e ).first;
+			Edge &edge = (*edges)[e->segment];
+			if( e->position != status.begin() ) {
+				const Edge &below = (*edges)[( *std::prev( e->position ) )->segment];
+				edge.windingBelow[0] = below.windingBelow[0] + below.winding[0];
+				edge.windingBelow[1] = below.windingBelow[1] + below.winding[1];
+			}
+			else
+				edge.windingBelow[0] = edge.windingBelow[1] = 0;
+		}
+		else
+			status.erase( e->other->position );
+	}
+}
+
+bool isFilled( int winding, FillRule fillRule )
+{
+	switch( fillRule ) {
+		case FILL_EVEN_ODD:	return ( winding & 1 ) != 0;
+		case FILL_NONZERO:	return winding != 0;
+		case FILL_POSITIVE:	return winding > 0;
+		case FILL_NEGATIVE:	return winding < 0;
+	}
+	return false;
+}
+
+bool isInside( Operation op, FillRule fillRule, int windingSubject, int windingClip )
+{
+	const bool subject = isFilled( windingSubject, fillRule ), clip = isFilled( windingClip, fillRule );
+	switch( op ) {
+		case UNION:			return subject || clip;
+		case INTERSECTION:	return subject && clip;
+		case DIFFERENCE:	return subject && ! clip;
+		case XOR:			return subject != clip;
+	}
+	return false;
+}
+
+// Connects the directed edges from[i] -> to[i] into closed contours, tracing each region's boundary with the interior on the left
+std::vector<Contour> connectEdges( const std::vector<dvec2> &from, const std::vector<dvec2> &to )
+{
+	const size_t numEdges = from.size();
+	std::vector<std::pair<dvec2, uint32_t>> sources( numEdges );
+	for( size_t i = 0; i < numEdges; ++i )
+		sources[i] = std::make_pair( from[i], (uint32_t)i );
+	std::sort( sources.begin(), sources.end(), []( const std::pair<dvec2, uint32_t> &a, const std::pair<dvec2, uint32_t> &b ) {
+		return pointLess( a.first, b.first ) || ( a.first == b.first && a.second < b.second );
+	} );
+
+	std::vector<Contour> result;
+	std::vector<bool> used( numEdges, false );
+	for( size_t start = 0; start < numEdges; ++start ) {
+		if( used[start] )
+			continue;
+
+		Contour contour;
+		size_t e = start;
+		do {
+			used[e] = true;
+			contour.push_back( from[e] );
+
+			// where several edges leave a point, the one turning least clockwise from the way back stays on this region's boundary
+			const dvec2 back = from[e] - to[e];
+			auto it = std::lower_bound( sources.begin(), sources.end(), to[e], []( const std::pair<dvec2, uint32_t> &a, const dvec2 &p ) { return pointLess( a.first, p ); } );
+			size_t next = numEdges;
+			double nextAngle = 0;
+			const bool single = it != sources.end() && ( std::next( it ) == sources.end() || std::next( it )->first != it->first );
+			for( ; it != sources.end() && it->first == to[e]; ++it ) {
+				const uint32_t candidate = it->second;
+				if( used[candidate] && candidate != start )
+					continue;
+				if( single ) {
+					next = candidate;
+					break;
+				}
+				const dvec2 out = to[candidate] - from[candidate];
+				double angle = atan2( -cross2( back, out ), dot( back, out ) );
+				if( angle <= 0 )
+					angle += 2 * M_PI;
+				if( next == numEdges || angle < nextAngle ) {
+					next = candidate;
+					nextAngle = angle;
+				}
+			}
+			e = next;
+		} while( e != numEdges && e != start );
+
+		// remove the collinear points left by splitting
+		bool removed = true;
+		while( removed && contour.size() >= 3 ) {
+			removed = false;
+			size_t numKept = 0;
+			for( size_t i = 0; i < contour.size(); ++i ) {
+				const dvec2 &prev = numKept ? contour[numKept - 1] : contour.back(), &next = contour[( i + 1 ) % contour.size()];
+				if( signedArea( prev, contour[i], next ) == 0 )
+					removed = true;
+				else
+					contour[numKept++] = contour[i];
+			}
+			contour.resize( numKept );
+		}
+		if( contour.size() >= 3 )
+			result.push_back( std::move( contour ) );
+	}
+
+	return result;
+}
+
+std::vector<Contour> calcBooleanContours( Operation op, const std::vector<Contour> &subject, const std::vector<Contour> &clip, FillRule fillRule )
+{
+	// snap intersections this close to end points, far below float precision
+	double maxCoordinate = 0;
+	for( const auto *contours : { &subject, &clip } ) {
+		for( const Contour &contour : *contours ) {
+			for( const dvec2 &p : contour )
+				maxCoordinate = std::max( maxCoordinate, std::max( std::abs( p.x ), std::abs( p.y ) ) );
+		}
+	}
+	EdgeSplitter splitter( maxCoordinate * 1e-10 );
+	for( const Contour &contour : subject )
+		splitter.addContour( contour, 0 );
+	for( const Contour &contour : clip )
+		splitter.addContour( contour, 1 );
+	std::vector<Edge> edges = splitter.run();
+	computeWindings( &edges );
+
+	// edges between an inside and an outside region are part of the result, directed so that the inside is on their left
+	std::vector<dvec2> from, to;
+	for( const Edge &edge : edges ) {
+		bool insideBelow = isInside( op, fillRule, edge.windingBelow[0], edge.windingBelow[1] );
+		bool insideAbove = isInside( op, fillRule, edge.windingBelow[0] + edge.winding[0], edge.windingBelow[1] + edge.winding[1] );
+		if( insideBelow != insideAbove ) {
+			from.push_back( insideAbove ? edge.p0 : edge.p1 );
+			to.push_back( insideAbove ? edge.p1 : edge.p0 );
+		}
+	}
+
+	return connectEdges( from, to );
+}
+
+std::vector<Contour> calcOffsetContours( const std::vector<Contour> &contours, double delta, const OffsetOptions &options )
+{
+	// resolve the input into simple contours with the interior on their left, outwards is then always to the right
+	std::vector<Contour> simple = calcBooleanContours( UNION, contours, std::vector<Contour>(), options.getFillRule() );
+	if( delta == 0 )
+		return simple;
+
+	const double absDelta = std::abs( delta );
+	const double arcTolerance = glm::clamp( (double)options.getArcTolerance(), absDelta * 1e-3, absDelta );
+	const double maxArcStep = 2 * acos( 1 - arcTolerance / absDelta );
+	const double miterLimitSqrd = (double)options.getMiterLimit() * options.getMiterLimit();
+
+	std::vector<Contour> raw;
+	raw.reserve( simple.size() );
+	std::vector<dvec2> normals;
+	for( const Contour &contour : simple ) {
+		const size_t numPoints = contour.size();
+		normals.resize( numPoints );
+		for( size_t i = 0; i < numPoints; ++i ) {
+			dvec2 dir = normalize( contour[( i + 1 ) % numPoints] - contour[i] );
+			normals[i] = dvec2( dir.y, -dir.x );
+		}
+
+		Contour offset;
+		offset.reserve( numPoints * 2 );
+		for( size_t i = 0; i < numPoints; ++i ) {
+			const dvec2 &p = contour[i], &n0 = normals[( i + numPoints - 1 ) % numPoints], &n1 = normals[i];
+			const double sinA = cross2( n0, n1 ), cosA = dot( n0, n1 );
+			if( sinA * delta < 0 ) {
+				// the offset edges overlap at concave corners; looping through the vertex leaves a region with negative winding
+				offset.push_back( p + n0 * delta );
+				offset.push_back( p );
+				offset.push_back( p + n1 * delta );
+			}
+			else if( sinA == 0 && cosA > 0 )
+				offset.push_back( p + n0 * delta );
+			else if( options.getJoinType() == JOIN_ROUND ) {
+				const double angle = atan2( sinA, cosA );
+				const int numSteps = std::max( 1, (int)ceil( std::abs( angle ) / maxArcStep ) );
+				offset.push_back( p + n0 * delta );
+				for( int s = 1; s < numSteps; ++s ) {
+					const double a = angle * s / numSteps;
+					offset.push_back( p + dvec2( n0.x * cos( a ) - n0.y * sin( a ), n0.x * sin( a ) + n0.y * cos( a ) ) * delta );
+				}
+				offset.push_back( p + n1 * delta );
+			}
+			else if( options.getJoinType() == JOIN_MITER && ( 1 + cosA ) * miterLimitSqrd >= 2 )
+				offset.push_back( p + ( n0 + n1 ) * ( delta / ( 1 + cosA ) ) );
+			else {
+				offset.push_back( p + n0 * delta );
+				offset.push_back( p + n1 * delta );
+			}
+		}
+		raw.push_back( std::move( offset ) );
+	}
+
+	return calcBooleanContours( UNION, raw, std::vector<Contour>(), FILL_POSITIVE );
+}
+
+std::vector<Contour> toContours( const std::vector<PolyLine2f> &polyLines )
+{
+	std::vector<Contour> result;
+	result.reserve( polyLines.size() );
+	for( const PolyLine2f &polyLine : polyLines )
+		result.emplace_back( polyLine.begin(), polyLine.end() );
+	return result;
+}
+
+std::vector<Contour> toContours( const Shape2d &shape, float approximationScale )
+{
+	std::vector<Contour> result;
+	result.reserve( shape.getNumContours() );
+	for( const Path2d &path : shape.getContours() ) {
+		std::vector<vec2> points = path.subdivide( approximationScale );
+		result.emplace_back( points.begin(), points.end() );
+	}
+	return result;
+}
+
+std::vector<PolyLine2f> toPolyLines( const std::vector<Contour> &contours )
+{
+	std::vector<PolyLine2f> result;
+	result.reserve( contours.size() );
+	for( const Contour &contour : contours )
+		result.emplace_back( std::vector<vec2>( contour.begin(), contour.end() ), true );
+	return result;
+}
+
+Shape2d toShape( const std::vector<Contour> &contours )
+{
+	Shape2d result;
+	for( const Contour &contour : contours ) {
+		result.moveTo( vec2( contour[0] ) );
+		for( size_t i = 1; i < contour.size(); ++i )
+			result.lineTo( vec2( contour[i] ) );
+		result.close();
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+std::vector<PolyLine2f> calcBoolean( Operation op, const std::vector<PolyLine2f> &subject, const std::vector<PolyLine2f> &clip, FillRule fillRule )
+{
+	return toPolyLines( calcBooleanContours( op, toContours( subject ), toContours( clip ), fillRule ) );
+}
+
+Shape2d calcBoolean( Operation op, const Shape2d &subject, const Shape2d &clip, FillRule fillRule, float approximationScale )
+{
+	return toShape( calcBooleanContours( op, toContours( subject, approximationScale ), toContours( clip, approximationScale ), fillRule ) );
+}
+
+std::vector<PolyLine2f> calcOffset( const std::vector<PolyLine2f> &polygons, float delta, const OffsetOptions &options )
+{
+	return toPolyLines( calcOffsetContours( toContours( polygons ), delta, options ) );
+}
+
+Shape2d calcOffset( const Shape2d &shape, float delta, const OffsetOptions &options )
+{
+	return toShape( calcOffsetContours( toContours( shape, options.getApproximationScale() ), delta, options ) );
+}
+
+Shape2d calcSimplified( const Shape2d &shape, float tolerance, float approximationScale )
+{
+	Shape2d result;
+	for( const Path2d &path : shape.getContours() ) {
+		PolyLine2f polyLine( path.subdivide( approximationScale ), path.isClosed() );
+		polyLine.simplify( tolerance );
+		if( polyLine.size() == 0 )
+			continue;
+		result.moveTo( polyLine.getPoints()[0] );
+		for( size_t i = 1; i < polyLine.size(); ++i )
+			result.lineTo( polyLine.getPoints()[i] );
+		if( path.isClosed() )
+			result.close();
+	}
+	return result;
+}
+
+} } // namespace cinder::polygon
@@ -23,10 +23,311 @@
 */
 
 #include "cinder/Rand.h"
+#include "cinder/Simd.h"
+
+#include <algorithm>
+#include <atomic>
 
 namespace cinder {
 
-std::mt19937 Rand::sBase( 310u );
-std::uniform_real_distribution<float> Rand::sFloatGen;
+namespace {
+
+// Master seed for the static generators in the low 32 bits and the number of randSeed() calls in the high 32 bits, so that
+// threads notice a reseed even when the seed itself is unchanged. Never 0, which marks a thread generator as unseeded.
+std::atomic<uint64_t>	sSeedState( 310u );
+std::atomic<uint32_t>	sNextStream( 0 );
+
+// Stream 0 is seeded exactly as Rand( seed ) and the single shared static generator used to be, so existing sequences are unchanged
+void seedStream( std::mt19937 *base, uint32_t seed, uint64_t stream )
+{
+	if( stream == 0 ) {
+		base->seed( seed );
+		return;
+	}
+
+	std::seed_seq seq{ seed, (uint32_t)stream, (uint32_t)( stream >> 32 ) };
+	base->seed( seq );
+}
+
+inline uint64_t splitMix64( uint64_t *state )
+{
+	uint64_t z = ( *state += 0x9E3779B97F4A7C15ull );
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+	return z ^ ( z >> 31 );
+}
+
+// One xoshiro128** step for each of the four interleaved streams. The multiplies by 5 and 9 are done as shift+add since
+// neither SSE2 nor NEON has a cheap 32-bit lane multiply that matches on both.
+#if defined( CINDER_SIMD_SSE2 )
+typedef __m128i uint4;
+
+inline uint4 load4( const uint32_t *p )				{ return _mm_loadu_si128( (const __m128i*)p ); }
+inline void store4( uint32_t *p, uint4 v )			{ _mm_storeu_si128( (__m128i*)p, v ); }
+inline uint4 rotl4( uint4 x, int k )				{ return _mm_or_si128( _mm_slli_epi32( x, k ), _mm_srli_epi32( x, 32 - k ) ); }
+
+inline uint4 next4( uint4 s[4] )
+{
+	const uint4 s1x5 = _mm_add_epi32( _mm_slli_epi32( s[1], 2 ), s[1] );
+	const uint4 r = rotl4( s1x5, 7 );
+	const uint4 result = _mm_add_epi32( _mm_slli_epi32( r, 3 ), r );
+	const uint4 t = _mm_slli_epi32( s[1], 9 );
+	s[2] = _mm_xor_si128( s[2], s[0] );
+	s[3] = _mm_xor_si128( s[3], s[1] );
+	s[1] = _mm_xor_si128( s[1], s[2] );
+	s[0] = _mm_xor_si128( s[0], s[3] );
+	s[2] = _mm_xor_si128( s[2], t );
+	s[3] = rotl4( s[3], 11 );
+	return result;
+}
+
+// Converts the top 24 bits of each lane to a float in [0,1), then maps it to [a,a+range) the same way FastRand::nextFloat( a, b ) does
+inline void storeFloat4( float *p, uint4 v, float a, float range )
+{
+	__m128 f = _mm_mul_ps( _mm_cvtepi32_ps( _mm_srli_epi32( v, 8 ) ), _mm_set1_ps( 1.0f / 16777216.0f ) );
+	_mm_storeu_ps( p, _mm_add_ps( _mm_mul_ps( f, _mm_set1_ps( range ) ), _mm_set1_ps( a ) ) );
+}
+#elif defined( CINDER_SIMD_NEON )
+typedef uint32x4_t uint4;
+
+inline uint4 load4( const uint32_t *p )				{ return vld1q_u32( p ); }
+inline void store4( uint32_t *p, uint4 v )			{ vst1q_u32( p, v ); }
+template<int K>
+inline uint4 rotl4( uint4 x )						{ return vorrq_u32( vshlq_n_u32( x, K ), vshrq_n_u32( x, 32 - K ) ); }
+
+inline uint4 next4( uint4 s[4] )
+{
+	const uint4 s1x5 = vaddq_u32( vshlq_n_u32( s[1], 2 ), s[1] );
+	const uint4 r = rotl4<7>( s1x5 );
+	const uint4 result = vaddq_u32( vshlq_n_u32( r, 3 ), r );
+	const uint4 t = vshlq_n_u32( s[1], 9 );
+	s[2] = veorq_u32( s[2], s[0] );
+	s[3] = veorq_u32( s[3], s[1] );
+	s[1] = veorq_u32( s[1], s[2] );
+	s[0] = veorq_u32( s[0], s[3] );
+	s[2] = veorq_u32( s[2], t );
+	s[3] = rotl4<11>( s[3] );
+	return result;
+}
+
+inline void storeFloat4( float *p, uint4 v, float a, float range )
+{
+	float32x4_t f = vmulq_n_f32( vcvtq_f32_u32( vshrq_n_u32( v, 8 ) ), 1.0f / 16777216.0f );
+	vst1q_f32( p, vaddq_f32( vmulq_n_f32( f, range ), vdupq_n_f32( a ) ) );
+}
+#endif
+
+inline uint32_t rotl( uint32_t x, int k )
+{
+	return ( x << k ) | ( x >> ( 32 - k ) );
+}
+
+// Size of the stack buffers the vector and Gaussian bulk functions draw their uniforms into
+const size_t BULK_CHUNK_SIZE = 256;
+
+} // anonymous namespace
+
+Rand::Rand( uint32_t seed, uint64_t stream )
+{
+	seedStream( &mBase, seed, stream );
+}
+
+void Rand::randSeed( uint32_t seedValue )
+{
+	uint64_t state = sSeedState.load( std::memory_order_relaxed );
+	uint64_t next;
+	do {
+		next = ( ( ( state >> 32 ) + 1 ) << 32 ) | seedValue;
+	} while( ! sSeedState.compare_exchange_weak( state, next ) );
+}
+
+Rand::ThreadGenerator& Rand::getThreadGenerator()
+{
+	thread_local ThreadGenerator generator;
+
+	const uint64_t state = sSeedState.load( std::memory_order_acquire );
+	if( generator.mSeedState != state ) {
+		if( generator.mSeedState == 0 )
+			generator.mStream = sNextStream.fetch_add( 1 );
+
+		seedStream( &generator.mBase, (uint32_t)state, generator.mStream );
+		generator.mFloatGen.reset();
+		generator.mNormDist.reset();
+		generator.mSeedState = state;
+	}
+
+	return generator;
+}
+
+void FastRand::seed( uint64_t seed, uint64_t stream )
+{
+	// mix the stream through a splitmix64 step of its own so that nearby (seed, stream) pairs land far apart
+	uint64_t streamState = stream;
+	uint64_t state = seed ^ ( stream ? splitMix64( &streamState ) : 0 );
+	for( int i = 0; i < 16; i += 2 ) {
+		const uint64_t v = splitMix64( &state );
+		mState[i / 4][i % 4] = (uint32_t)v;
+		mState[( i + 1 ) / 4][( i + 1 ) % 4] = (uint32_t)( v >> 32 );
+	}
+
+	// xoshiro's all-zero state is a fixed point
+	for( int lane = 0; lane < 4; ++lane ) {
+		if( ( mState[0][lane] | mState[1][lane] | mState[2][lane] | mState[3][lane] ) == 0 )
+			mState[0][lane] = 1;
+	}
+
+	mBufferIndex = 4;
+	mHasGaussian = false;
+}
+
+void FastRand::refill()
+{
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	uint4 s[4] = { load4( mState[0] ), load4( mState[1] ), load4( mState[2] ), load4( mState[3] ) };
+	store4( mBuffer, next4( s ) );
+	for( int w = 0; w < 4; ++w )
+		store4( mState[w], s[w] );
+#else
+	for( int lane = 0; lane < 4; ++lane ) {
+		uint32_t s0 = mState[0][lane], s1 = mState[1][lane], s2 = mState[2][lane], s3 = mState[3][lane];
+		mBuffer[lane] = rotl( s1 * 5, 7 ) * 9;
+		const uint32_t t = s1 << 9;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = rotl( s3, 11 );
+		mState[0][lane] = s0; mState[1][lane] = s1; mState[2][lane] = s2; mState[3][lane] = s3;
+	}
+#endif
+	mBufferIndex = 0;
+}
+
+float FastRand::nextGaussian()
+{
+	if( mHasGaussian ) {
+		mHasGaussian = false;
+		return mGaussian;
+	}
+
+	// Box-Muller; the second value of the pair is kept for the next call
+	const float u1 = nextFloat();
+	const float u2 = nextFloat();
+	const float radius = math<float>::sqrt( -2.0f * math<float>::log( 1.0f - u1 ) );
+	const float theta = (float)M_PI * 2.0f * u2;
+	mGaussian = radius * math<float>::sin( theta );
+	mHasGaussian = true;
+	return radius * math<float>::cos( theta );
+}
+
+void FastRand::nextUints( uint32_t *result, size_t count )
+{
+	size_t i = 0;
+	// values already buffered come first, so that the output matches a sequence of nextUint() calls
+	while( i < count && mBufferIndex < 4 )
+		result[i++] = mBuffer[mBufferIndex++];
+
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	if( count - i >= 4 ) {
+		uint4 s[4] = { load4( mState[0] ), load4( mState[1] ), load4( mState[2] ), load4( mState[3] ) };
+		for( ; i + 4 <= count; i += 4 )
+			store4( result + i, next4( s ) );
+		for( int w = 0; w < 4; ++w )
+			store4( mState[w], s[w] );
+	}
+#endif
+
+	for( ; i < count; ++i )
+		result[i] = nextUint();
+}
+
+void FastRand::nextInts( int32_t *result, size_t count, int32_t a, int32_t b )
+{
+	// matches nextInt( a, b ), which doesn't consume a value for an empty range
+	const int32_t range = b - a;
+	if( range <= 0 ) {
+		std::fill( result, result + count, a );
+		return;
+	}
+
+	uint32_t *raw = reinterpret_cast<uint32_t*>( result );
+	nextUints( raw, count );
+	for( size_t i = 0; i < count; ++i )
+		result[i] = (int32_t)( ( (uint64_t)raw[i] * (uint32_t)range ) >> 32 ) + a;
+}
+
+void FastRand::nextFloats( float *result, size_t count, float a, float b )
+{
+	size_t i = 0;
+	while( i < count && mBufferIndex < 4 )
+		result[i++] = nextFloat( a, b );
+
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	if( count - i >= 4 ) {
+		const float range = b - a;
+		uint4 s[4] = { load4( mState[0] ), load4( mState[1] ), load4( mState[2] ), load4( mState[3] ) };
+		for( ; i + 4 <= count; i += 4 )
+			storeFloat4( result + i, next4( s ), a, range );
+		for( int w = 0; w < 4; ++w )
+			store4( mState[w], s[w] );
+	}
+#endif
+
+	for( ; i < count; ++i )
+		result[i] = nextFloat( a, b );
+}
+
+void FastRand::nextVec2s( vec2 *result, size_t count )
+{
+	float theta[BULK_CHUNK_SIZE];
+	while( count ) {
+		const size_t n = std::min( count, BULK_CHUNK_SIZE );
+		nextFloats( theta, n, 0.0f, (float)M_PI * 2.0f );
+		for( size_t i = 0; i < n; ++i )
+			result[i] = vec2( math<float>::cos( theta[i] ), math<float>::sin( theta[i] ) );
+		result += n;
+		count -= n;
+	}
+}
+
+void FastRand::nextVec3s( vec3 *result, size_t count )
+{
+	float uniforms[BULK_CHUNK_SIZE];
+	while( count ) {
+		const size_t n = std::min( count, BULK_CHUNK_SIZE / 2 );
+		nextFloats( uniforms, n * 2 );
+		for( size_t i = 0; i < n; ++i ) {
+			// same arithmetic as nextFloat( 2 * pi ) and nextFloat( -1, 1 )
+			const float phi = uniforms[i * 2] * ( (float)M_PI * 2.0f );
+			const float costheta = uniforms[i * 2 + 1] * ( 1.0f - -1.0f ) + -1.0f;
+			result[i] = unitSphere( phi, costheta );
+		}
+		result += n;
+		count -= n;
+	}
+}
+
+void FastRand::nextGaussians( float *result, size_t count, float mean, float stdDev )
+{
+	size_t i = 0;
+	if( count && mHasGaussian )
+		result[i++] = nextGaussian() * stdDev + mean;
+
+	float uniforms[BULK_CHUNK_SIZE];
+	while( count - i >= 2 ) {
+		const size_t pairs = std::min( ( count - i ) / 2, BULK_CHUNK_SIZE / 2 );
+		nextFloats( uniforms, pairs * 2 );
+		for( size_t p = 0; p < pairs; ++p, i += 2 ) {
+			const float radius = math<float>::sqrt( -2.0f * math<float>::log( 1.0f - uniforms[p * 2] ) );
+			const float theta = (float)M_PI * 2.0f * uniforms[p * 2 + 1];
+			result[i] = radius * math<float>::cos( theta ) * stdDev + mean;
+			result[i + 1] = radius * math<float>::sin( theta ) * stdDev + mean;
+		}
+	}
+
+	if( i < count )
+		result[i] = nextGaussian() * stdDev + mean;
+}
 
 } // ci
\ No newline at end of file
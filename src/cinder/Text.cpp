@@ -57,6 +57,7 @@
 	static const float MAX_SIZE = 1000000.0f;
 #elif defined( CINDER_UWP ) || defined( CINDER_ANDROID ) || defined( CINDER_LINUX )
 	#include "cinder/linux/FreeTypeUtil.h"
+	#include "cinder/Unicode.h"
 
 	static const float MAX_SIZE = 1000000.0f;
 #endif
@@ -1027,26 +1028,126 @@ Surface	TextBox::render( vec2 offset )
 
 #elif defined( CINDER_ANDROID ) || defined( CINDER_LINUX )
 
-void TextBox::calculate() const
-{
-	if( ! mInvalid ) {	
-		return;
+namespace {
+
+struct LineMeasure {
+	LineMeasure( int maxWidth, const Font &font, const std::map<Font::Glyph, Font::GlyphMetrics>* cachedGlyphMetrics = nullptr ) 
+		: mMaxWidth( maxWidth ), mFont( font.getFreetypeFace() ), mCachedGlyphMerics( cachedGlyphMetrics ) {}
+	bool operator()( const char *line, size_t len ) const {
+		if( mMaxWidth >= MAX_SIZE ) {
+			// too big anyway so just return true
+			return true;
+		}
+
+		std::u32string utf32Chars = ci::toUtf32( std::string( line, len ) );
+		int measuredWidth = 0;
+		FT_Vector pen = { 0, 0 };
+		for( const auto& ch : utf32Chars ) {
+			ivec2 advance = { 0, 0 };
+			FT_UInt glyphIndex = FT_Get_Char_Index( mFont, ch );
+			if( nullptr != mCachedGlyphMerics ) {
+				auto iter = mCachedGlyphMerics->find( glyphIndex );
+				advance = iter->second.advance;		
+			}
+			else  {
+				FT_Load_Glyph( mFont, glyphIndex, FT_LOAD_DEFAULT );
+				const FT_GlyphSlot& slot = mFont->glyph;
+				advance = ivec2( slot->advance.x, slot->advance.y );
+			}
+
+			pen.x += advance.x;
+			pen.y += advance.y;
+
+			measuredWidth = (pen.x >> 6);
+		}
+
+		bool result = (measuredWidth <= mMaxWidth);
+		return result;
 	}
 
-	if( mText.empty() ) {
-		mCalculatedSize = vec2();
-		return;
-	}	
+	int													mMaxWidth;
+	FT_Face												mFont;
+	const std::map<Font::Glyph, Font::GlyphMetrics>* 	mCachedGlyphMerics;
+};
+
+} // anonymous namespace
+
+const vector<TextBox::Line*>& TextBox::layout( const std::map<Font::Glyph, Font::GlyphMetrics>* cachedGlyphMetrics ) const
+{
+	LayoutCache &cache = mLayoutCache;
+	const int width = ( mSize.x > 0 ) ? mSize.x : static_cast<int>( MAX_SIZE );
+	const bool sameFont = ( cache.mFontName == mFont.getName() ) && ( cache.mFontSize == mFont.getSize() );
+	if( cache.mValid && sameFont && ( cache.mWidth == width ) && ( cache.mText == mText ) )
+		return cache.mLines;
+
+	// the breaks of each paragraph in mLinebreaks remain valid, but the lines have to be broken again
+	if( ! sameFont || ( cache.mWidth != width ) ) {
+		for( auto &paragraph : cache.mParagraphs )
+			paragraph.second.mLaidOut = false;
+		cache.mFontName = mFont.getName();
+		cache.mFontSize = mFont.getSize();
+		cache.mWidth = width;
+	}
 
-	mCalculatedSize = vec2();
 	FT_Face face = mFont.getFreetypeFace();
+	const std::function<bool(const char *, size_t)> measureFn = LineMeasure( width, mFont, cachedGlyphMetrics );
+	const char *text = mText.c_str();
+	const size_t length = strlen( text );
+	cache.mLines.clear();
+	++cache.mGeneration;
+	for( size_t offset = 0; offset < length; ) {
+		const char *str = text + offset;
+		const size_t paragraphLength = paragraphLengthUtf8( str, length - offset );
+		const bool first = ( offset == 0 );
+		// a paragraph's lines are only replaced when the font or width changes, before any pointer to them is taken, as the key is its whole text
+		cache.mKey.assign( str, paragraphLength );
+		cache.mKey.push_back( first ? 1 : 0 );
+		auto it = cache.mParagraphs.find( cache.mKey );
+		if( it == cache.mParagraphs.end() )
+			it = cache.mParagraphs.emplace( cache.mKey, Paragraph() ).first;
+		Paragraph &paragraph = it->second;
+
+		// looked up even when the lines are cached, so that the breaks are kept for when the font or width changes
+		const std::vector<uint8_t> &breaks = cache.mLinebreaks.getParagraphBreaks( str, paragraphLength, first );
+		if( ! paragraph.mLaidOut ) {
+			paragraph.mLines.clear();
+			lineBreakParagraphUtf8( str, paragraphLength, breaks.data(), first, measureFn, [&]( const char *line, size_t lineLength ) {
+				Line result;
+				result.mText.assign( line, lineLength );
+				auto measure = ci::linux::ftutil::MeasureString( result.mText, face );
+				result.mSize = measure.getSize();
+				result.mBaseline = measure.getBaseline();
+				paragraph.mLines.push_back( std::move( result ) );
+			} );
+			paragraph.mLaidOut = true;
+		}
+
+		paragraph.mLastUse = cache.mGeneration;
+		for( auto &line : paragraph.mLines )
+			cache.mLines.push_back( &line );
+		offset += paragraphLength;
+	}
 
-	vector<string> lines = calculateLineBreaks( nullptr );
-	for( const auto& text : lines ) {
-		auto measure = ci::linux::ftutil::MeasureString( text, face );
-		float fullWidth = measure.getBaseline().x + measure.getWidth();
+	for( auto it = cache.mParagraphs.begin(); it != cache.mParagraphs.end(); ) {
+		if( it->second.mLastUse != cache.mGeneration )
+			it = cache.mParagraphs.erase( it );
+		else
+			++it;
+	}
+	cache.mLinebreaks.evictUnused();
+
+	cache.mText = mText;
+	cache.mValid = true;
+	return cache.mLines;
+}
+
+void TextBox::calculate() const
+{
+	mCalculatedSize = vec2();
+	for( const Line *line : layout() ) {
+		float fullWidth = line->mBaseline.x + line->mSize.x;
 		mCalculatedSize.x = std::max( mCalculatedSize.x, fullWidth );
-		mCalculatedSize.y += measure.getHeight();
+		mCalculatedSize.y += line->mSize.y;
 	}
 
 	mInvalid = false;
@@ -1061,54 +1162,8 @@ vec2 TextBox::measure() const
 vector<string> TextBox::calculateLineBreaks( const std::map<Font::Glyph, Font::GlyphMetrics>* cachedGlyphMetrics ) const
 {
 	vector<string> result;
-
-	vector<string> strings;
-	struct LineProcessor {
-		LineProcessor( vector<string> *strings ) : mStrings( strings ) {}
-		void operator()( const char *line, size_t len ) const { mStrings->push_back( string( line, len ) ); }
-		mutable vector<string> *mStrings;
-	};
-	struct LineMeasure {
-		LineMeasure( int maxWidth, const Font &font, const std::map<Font::Glyph, Font::GlyphMetrics>* cachedGlyphMetrics = nullptr ) 
-			: mMaxWidth( maxWidth ), mFont( font.getFreetypeFace() ), mCachedGlyphMerics( cachedGlyphMetrics ) {}
-		bool operator()( const char *line, size_t len ) const {
-			if( mMaxWidth >= MAX_SIZE ) {
-				// too big anyway so just return true
-				return true;
-			}
-
-			std::u32string utf32Chars = ci::toUtf32( std::string( line, len ) );
-			int measuredWidth = 0;
-			FT_Vector pen = { 0, 0 };
-			for( const auto& ch : utf32Chars ) {
-				ivec2 advance = { 0, 0 };
-				FT_UInt glyphIndex = FT_Get_Char_Index( mFont, ch );
-				if( nullptr != mCachedGlyphMerics ) {
-					auto iter = mCachedGlyphMerics->find( glyphIndex );
-					advance = iter->second.advance;		
-				}
-				else  {
-					FT_Load_Glyph( mFont, glyphIndex, FT_LOAD_DEFAULT );
-					const FT_GlyphSlot& slot = mFont->glyph;
-					advance = ivec2( slot->advance.x, slot->advance.y );
-				}
-
-				pen.x += advance.x;
-				pen.y += advance.y;
-
-				measuredWidth = (pen.x >> 6);
-			}
-
-			bool result = (measuredWidth <= mMaxWidth);
-			return result;
-		}
-
-		int													mMaxWidth;
-		FT_Face												mFont;
-		const std::map<Font::Glyph, Font::GlyphMetrics>* 	mCachedGlyphMerics;
-	};
-	std::function<void(const char *,size_t)> lineFn = LineProcessor( &result );		
-	lineBreakUtf8( mText.c_str(), LineMeasure( ( mSize.x > 0 ) ? mSize.x : MAX_SIZE, mFont, cachedGlyphMetrics ), lineFn );
+	for( const Line *line : layout( cachedGlyphMetrics ) )
+		result.push_back( line->mText );
 
 	return result;
 }
@@ -1122,33 +1177,39 @@ vector<pair<uint32_t,vec2>> TextBox::measureGlyphs( const std::map<Font::Glyph,
 	}
 
 	FT_Face face = mFont.getFreetypeFace();
-	vector<string> mLines = calculateLineBreaks( cachedGlyphMetrics );
+	const vector<Line*> &lines = layout( cachedGlyphMetrics );
 
 	float curY = 0;
-	for( vector<string>::const_iterator lineIt = mLines.begin(); lineIt != mLines.end(); ++lineIt ) {
-		std::u32string utf32Chars = ci::toUtf32( *lineIt );
+	for( Line *line : lines ) {
+		// each line's glyph run is kept along with it, so only lines which are new to the layout are measured
+		if( line->mGlyphs.empty() ) {
+			std::u32string utf32Chars = ci::toUtf32( line->mText );
 
-		FT_Vector pen = { 0, 0 };
-		for( const auto& ch : utf32Chars ) {
-			ivec2 advance = { 0, 0 };
-			FT_UInt glyphIndex = FT_Get_Char_Index( face, ch );
-			if( nullptr != cachedGlyphMetrics ) {
-				auto iter = cachedGlyphMetrics->find( glyphIndex );
-				advance = iter->second.advance;
-			}
-			else {
-				FT_Load_Glyph( face, glyphIndex, FT_LOAD_DEFAULT );
-				const FT_GlyphSlot& slot = face->glyph;
-				advance = ivec2( slot->advance.x, slot->advance.y );
-			}
+			FT_Vector pen = { 0, 0 };
+			for( const auto& ch : utf32Chars ) {
+				ivec2 advance = { 0, 0 };
+				FT_UInt glyphIndex = FT_Get_Char_Index( face, ch );
+				if( nullptr != cachedGlyphMetrics ) {
+					auto iter = cachedGlyphMetrics->find( glyphIndex );
+					advance = iter->second.advance;
+				}
+				else {
+					FT_Load_Glyph( face, glyphIndex, FT_LOAD_DEFAULT );
+					const FT_GlyphSlot& slot = face->glyph;
+					advance = ivec2( slot->advance.x, slot->advance.y );
+				}
 
-			float xPos = (pen.x / 64.0f) + 0.5f;
-			result.push_back( std::make_pair( (uint32_t)glyphIndex, vec2( xPos, curY ) ) );
+				float xPos = (pen.x / 64.0f) + 0.5f;
+				line->mGlyphs.push_back( std::make_pair( (Font::Glyph)glyphIndex, xPos ) );
 
-			pen.x += advance.x;
-			pen.y += advance.y;	
+				pen.x += advance.x;
+				pen.y += advance.y;	
+			}
 		}
 
+		for( const auto &glyph : line->mGlyphs )
+			result.push_back( std::make_pair( (uint32_t)glyph.first, vec2( glyph.second, curY ) ) );
+
 		curY += mFont.getAscent() + mFont.getDescent();
 	}
 
@@ -1160,15 +1221,11 @@ Surface TextBox::render( vec2 offset )
 	mCalculatedSize = vec2();
 	FT_Face face = mFont.getFreetypeFace();
 
-	std::vector<ci::linux::ftutil::Measure> measures;
-	std::vector<string> lines = calculateLineBreaks( nullptr );
-	for( const auto& text : lines ) {
-		auto measure = ci::linux::ftutil::MeasureString( text, face );
-		measures.push_back( measure );
-
-		float fullWidth = measure.getBaseline().x + measure.getWidth();
+	const vector<Line*> &lines = layout();
+	for( const Line *line : lines ) {
+		float fullWidth = line->mBaseline.x + line->mSize.x;
 		mCalculatedSize.x = std::max( mCalculatedSize.x, fullWidth );
-		mCalculatedSize.y += measure.getHeight();		
+		mCalculatedSize.y += line->mSize.y;		
 	}
 
 	float sizeX = ( mSize.x <= 0 ) ? mCalculatedSize.x : mSize.x;
@@ -1193,23 +1250,20 @@ Surface TextBox::render( vec2 offset )
 	ivec2 		dstSize = result.getSize();
 
 	int curY = 0;
-	for( size_t i = 0; i < lines.size(); ++i ) {
-		const auto& text = lines[i];
-		const auto& measure = measures[i];
-
-		vec2 baseline = measure.getBaseline();
+	for( const Line *line : lines ) {
+		vec2 baseline = line->mBaseline;
 		float penX = baseline.x + offset.x;
 		float penY = dstSize.y - (baseline.y + offset.y + curY);
 		if( TextBox::RIGHT == mAlign ) {
-			penX = dstSize.x - (measure.getWidth() + offset.x + 3.0f);
+			penX = dstSize.x - (line->mSize.x + offset.x + 3.0f);
 		}
 		else if( TextBox::CENTER == mAlign ) {
-			penX = 0.5f*(dstSize.x - measure.getWidth());		
+			penX = 0.5f*(dstSize.x - line->mSize.x);		
 		}
 
 		FT_Vector pen = { (int)(penX*64.0f), (int)(penY*64.0f) };
 
-		std::u32string utf32Chars = ci::toUtf32( text );		
+		std::u32string utf32Chars = ci::toUtf32( line->mText );		
 		for( const auto& ch : utf32Chars ) {
 			FT_Set_Transform( face, nullptr, &pen );
 
@@ -1226,7 +1280,7 @@ Surface TextBox::render( vec2 offset )
 			pen.y += slot->advance.y;	
 		}
 
-		curY += measure.getHeight();
+		curY += line->mSize.y;
 	}
 
 	if( ! mPremultiplied ) {
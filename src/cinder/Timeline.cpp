@@ -23,31 +23,609 @@
 */
 
 #include "cinder/Timeline.h"
+#include "cinder/Color.h"
+#include "cinder/Simd.h"
 
 #include <algorithm>
+#include <typeinfo>
 #include <vector>
 
 using namespace std;
 
 namespace cinder {
 
+////////////////////////////////////////////////////////////////////////////////////////
+// Batched easing
+namespace {
+
+// The ease functions the batched Timeline evaluates with SIMD; everything else is EASE_CUSTOM and called through its EaseFn
+typedef enum {
+	EASE_NONE,
+	EASE_IN_QUAD, EASE_OUT_QUAD, EASE_IN_OUT_QUAD, EASE_OUT_IN_QUAD,
+	EASE_IN_CUBIC, EASE_OUT_CUBIC, EASE_IN_OUT_CUBIC, EASE_OUT_IN_CUBIC,
+	EASE_IN_QUART, EASE_OUT_QUART, EASE_IN_OUT_QUART, EASE_OUT_IN_QUART,
+	EASE_IN_QUINT, EASE_OUT_QUINT, EASE_IN_OUT_QUINT, EASE_OUT_IN_QUINT,
+	EASE_CUSTOM,
+	NUM_EASE_KINDS
+} EaseKind;
+
+template<typename FunctorT>
+bool isEaseFunctor( const EaseFn &fn )
+{
+	return fn.target<FunctorT>() != nullptr;
+}
+
+EaseKind classifyEase( const EaseFn &fn )
+{
+	typedef float (*EaseFnPtr)( float );
+	static const EaseFnPtr sEaseFns[EASE_CUSTOM] = {
+		&easeNone,
+		&easeInQuad, &easeOutQuad, &easeInOutQuad, &easeOutInQuad,
+		&easeInCubic, &easeOutCubic, &easeInOutCubic, &easeOutInCubic,
+		&easeInQuart, &easeOutQuart, &easeInOutQuart, &easeOutInQuart,
+		&easeInQuint, &easeOutQuint, &easeInOutQuint, &easeOutInQuint
+	};
+
+	if( const EaseFnPtr *ptr = fn.target<EaseFnPtr>() ) {
+		for( int kind = 0; kind < EASE_CUSTOM; ++kind ) {
+			if( *ptr == sEaseFns[kind] )
+				return (EaseKind)kind;
+		}
+		return EASE_CUSTOM;
+	}
+
+	if( isEaseFunctor<EaseNone>( fn ) ) return EASE_NONE;
+	if( isEaseFunctor<EaseInQuad>( fn ) ) return EASE_IN_QUAD;
+	if( isEaseFunctor<EaseOutQuad>( fn ) ) return EASE_OUT_QUAD;
+	if( isEaseFunctor<EaseInOutQuad>( fn ) ) return EASE_IN_OUT_QUAD;
+	if( isEaseFunctor<EaseOutInQuad>( fn ) ) return EASE_OUT_IN_QUAD;
+	if( isEaseFunctor<EaseInCubic>( fn ) ) return EASE_IN_CUBIC;
+	if( isEaseFunctor<EaseOutCubic>( fn ) ) return EASE_OUT_CUBIC;
+	if( isEaseFunctor<EaseInOutCubic>( fn ) ) return EASE_IN_OUT_CUBIC;
+	if( isEaseFunctor<EaseOutInCubic>( fn ) ) return EASE_OUT_IN_CUBIC;
+	if( isEaseFunctor<EaseInQuart>( fn ) ) return EASE_IN_QUART;
+	if( isEaseFunctor<EaseOutQuart>( fn ) ) return EASE_OUT_QUART;
+	if( isEaseFunctor<EaseInOutQuart>( fn ) ) return EASE_IN_OUT_QUART;
+	if( isEaseFunctor<EaseOutInQuart>( fn ) ) return EASE_OUT_IN_QUART;
+	if( isEaseFunctor<EaseInQuint>( fn ) ) return EASE_IN_QUINT;
+	if( isEaseFunctor<EaseOutQuint>( fn ) ) return EASE_OUT_QUINT;
+	if( isEaseFunctor<EaseInOutQuint>( fn ) ) return EASE_IN_OUT_QUINT;
+	if( isEaseFunctor<EaseOutInQuint>( fn ) ) return EASE_OUT_IN_QUINT;
+
+	return EASE_CUSTOM;
+}
+
+// Scalar and SIMD versions of the same operations, so that each ease kernel is written once and the SIMD lanes
+// round exactly like the scalar functions in Easing.h
+inline float	splat( float v )						{ return v; }
+inline float	add( float a, float b )					{ return a + b; }
+inline float	sub( float a, float b )					{ return a - b; }
+inline float	mul( float a, float b )					{ return a * b; }
+inline float	neg( float a )							{ return -a; }
+inline float	selectLess( float a, float b, float ifLess, float otherwise )	{ return ( a < b ) ? ifLess : otherwise; }
+
+#if defined( CINDER_SIMD_SSE2 )
+typedef __m128	float4;
+
+inline float4	splat4( float v )						{ return _mm_set1_ps( v ); }
+inline float4	load4( const float *p )					{ return _mm_loadu_ps( p ); }
+inline void		store4( float *p, float4 v )			{ _mm_storeu_ps( p, v ); }
+inline float4	add( float4 a, float4 b )				{ return _mm_add_ps( a, b ); }
+inline float4	sub( float4 a, float4 b )				{ return _mm_sub_ps( a, b ); }
+inline float4	mul( float4 a, float4 b )				{ return _mm_mul_ps( a, b ); }
+inline float4	neg( float4 a )							{ return _mm_xor_ps( a, _mm_set1_ps( -0.0f ) ); }
+inline float4	selectLess( float4 a, float4 b, float4 ifLess, float4 otherwise )
+{
+	const __m128 mask = _mm_cmplt_ps( a, b );
+	return _mm_or_ps( _mm_and_ps( mask, ifLess ), _mm_andnot_ps( mask, otherwise ) );
+}
+#elif defined( CINDER_SIMD_NEON )
+typedef float32x4_t	float4;
+
+inline float4	splat4( float v )						{ return vdupq_n_f32( v ); }
+inline float4	load4( const float *p )					{ return vld1q_f32( p ); }
+inline void		store4( float *p, float4 v )			{ vst1q_f32( p, v ); }
+inline float4	add( float4 a, float4 b )				{ return vaddq_f32( a, b ); }
+inline float4	sub( float4 a, float4 b )				{ return vsubq_f32( a, b ); }
+inline float4	mul( float4 a, float4 b )				{ return vmulq_f32( a, b ); }
+inline float4	neg( float4 a )							{ return vnegq_f32( a ); }
+inline float4	selectLess( float4 a, float4 b, float4 ifLess, float4 otherwise )	{ return vbslq_f32( vcltq_f32( a, b ), ifLess, otherwise ); }
+#endif
+
+template<typename V> V constant( float v );
+template<> inline float constant<float>( float v ) { return v; }
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+template<> inline float4 constant<float4>( float v ) { return splat4( v ); }
+#endif
+
+// t^P, multiplied left to right like Easing.h's t*t*t
+template<int P, typename V>
+inline V power( V t )
+{
+	V result = t;
+	for( int i = 1; i < P; ++i )
+		result = mul( result, t );
+	return result;
+}
+
+template<int P, typename V>
+inline V easeIn( V t )
+{
+	return power<P>( t );
+}
+
+template<int P, typename V>
+inline V easeOut( V t )
+{
+	const V one = constant<V>( 1 );
+	if( P == 2 ) // -t * ( t - 2 )
+		return mul( neg( t ), sub( t, constant<V>( 2 ) ) );
+	else if( P == 4 ) // -( (t-1)^4 - 1 )
+		return neg( sub( power<P>( sub( t, one ) ), one ) );
+	else // (t-1)^P + 1
+		return add( power<P>( sub( t, one ) ), one );
+}
+
+template<int P, typename V>
+inline V easeInOut( V t )
+{
+	const V half = constant<V>( 0.5f );
+	t = mul( t, constant<V>( 2 ) );
+
+	// 0.5f * t * t..., multiplied left to right
+	V in = mul( half, t );
+	for( int i = 1; i < P; ++i )
+		in = mul( in, t );
+
+	V out;
+	if( P == 2 ) { // -0.5f * ( (t-1) * (t-1-2) - 1 )
+		const V u = sub( t, constant<V>( 1 ) );
+		out = mul( constant<V>( -0.5f ), sub( mul( u, sub( u, constant<V>( 2 ) ) ), constant<V>( 1 ) ) );
+	}
+	else if( P == 4 ) // -0.5f * ( (t-2)^4 - 2 )
+		out = mul( constant<V>( -0.5f ), sub( power<P>( sub( t, constant<V>( 2 ) ) ), constant<V>( 2 ) ) );
+	else // 0.5f * ( (t-2)^P + 2 )
+		out = mul( half, add( power<P>( sub( t, constant<V>( 2 ) ) ), constant<V>( 2 ) ) );
+
+	return selectLess( t, constant<V>( 1 ), in, out );
+}
+
+template<int P, typename V>
+inline V easeOutIn( V t )
+{
+	const V half = constant<V>( 0.5f );
+	const V t2 = mul( constant<V>( 2 ), t );
+	const V out = mul( easeOut<P>( t2 ), half );
+	const V in = add( mul( easeIn<P>( sub( t2, constant<V>( 1 ) ) ), half ), half );
+	return selectLess( t, half, out, in );
+}
+
+template<EaseKind KIND, typename V>
+inline V ease( V t )
+{
+	switch( KIND ) {
+		case EASE_IN_QUAD: return easeIn<2>( t );
+		case EASE_OUT_QUAD: return easeOut<2>( t );
+		case EASE_IN_OUT_QUAD: return easeInOut<2>( t );
+		case EASE_OUT_IN_QUAD: return easeOutIn<2>( t );
+		case EASE_IN_CUBIC: return easeIn<3>( t );
+		case EASE_OUT_CUBIC: return easeOut<3>( t );
+		case EASE_IN_OUT_CUBIC: return easeInOut<3>( t );
+		case EASE_OUT_IN_CUBIC: return easeOutIn<3>( t );
+		case EASE_IN_QUART: return easeIn<4>( t );
+		case EASE_OUT_QUART: return easeOut<4>( t );
+		case EASE_IN_OUT_QUART: return easeInOut<4>( t );
+		case EASE_OUT_IN_QUART: return easeOutIn<4>( t );
+		case EASE_IN_QUINT: return easeIn<5>( t );
+		case EASE_OUT_QUINT: return easeOut<5>( t );
+		case EASE_IN_OUT_QUINT: return easeInOut<5>( t );
+		case EASE_OUT_IN_QUINT: return easeOutIn<5>( t );
+		default: return t;
+	}
+}
+
+template<EaseKind KIND>
+void easeRange( float *values, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 ) || defined( CINDER_SIMD_NEON )
+	for( ; i + 4 <= count; i += 4 )
+		store4( values + i, ease<KIND>( load4( values + i ) ) );
+#endif
+	for( ; i < count; ++i )
+		values[i] = ease<KIND>( values[i] );
+}
+
+//! Replaces each of the \a count values with its eased value
+void easeRange( EaseKind kind, float *values, size_t count )
+{
+	switch( kind ) {
+		case EASE_IN_QUAD: easeRange<EASE_IN_QUAD>( values, count ); break;
+		case EASE_OUT_QUAD: easeRange<EASE_OUT_QUAD>( values, count ); break;
+		case EASE_IN_OUT_QUAD: easeRange<EASE_IN_OUT_QUAD>( values, count ); break;
+		case EASE_OUT_IN_QUAD: easeRange<EASE_OUT_IN_QUAD>( values, count ); break;
+		case EASE_IN_CUBIC: easeRange<EASE_IN_CUBIC>( values, count ); break;
+		case EASE_OUT_CUBIC: easeRange<EASE_OUT_CUBIC>( values, count ); break;
+		case EASE_IN_OUT_CUBIC: easeRange<EASE_IN_OUT_CUBIC>( values, count ); break;
+		case EASE_OUT_IN_CUBIC: easeRange<EASE_OUT_IN_CUBIC>( values, count ); break;
+		case EASE_IN_QUART: easeRange<EASE_IN_QUART>( values, count ); break;
+		case EASE_OUT_QUART: easeRange<EASE_OUT_QUART>( values, count ); break;
+		case EASE_IN_OUT_QUART: easeRange<EASE_IN_OUT_QUART>( values, count ); break;
+		case EASE_OUT_IN_QUART: easeRange<EASE_OUT_IN_QUART>( values, count ); break;
+		case EASE_IN_QUINT: easeRange<EASE_IN_QUINT>( values, count ); break;
+		case EASE_OUT_QUINT: easeRange<EASE_OUT_QUINT>( values, count ); break;
+		case EASE_IN_OUT_QUINT: easeRange<EASE_IN_OUT_QUINT>( values, count ); break;
+		case EASE_OUT_IN_QUINT: easeRange<EASE_OUT_IN_QUINT>( values, count ); break;
+		default: break; // EASE_NONE leaves the values as they are; EASE_CUSTOM is handled by the caller
+	}
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Timeline::TweenBatches
+struct Timeline::TweenBatches {
+	typedef enum { STATE_DELEGATE, STATE_RUNNING, STATE_COMPLETE, STATE_REMOVED } State;
+
+	struct BatchBase;
+
+	//! A tween starting or completing, or an unbatched item being stepped
+	struct Event {
+		uint64_t		mSequence;
+		BatchBase		*mBatch;
+		size_t			mIndex;
+		TimelineItem	*mItem;
+
+		bool operator<( const Event &rhs ) const { return mSequence < rhs.mSequence; }
+	};
+
+	struct StepContext {
+		float						mTime;
+		bool						mCallbacksRan;
+		std::vector<TimelineItem*>	*mRemoved;
+		std::vector<Event>			*mEvents;
+	};
+
+	struct BatchBase {
+		virtual ~BatchBase() {}
+		//! Updates the running tweens and queues events for those starting or completing
+		virtual void	step( StepContext *context ) = 0;
+		virtual void	processEvent( size_t index, StepContext *context ) = 0;
+		//! Removes entries removed during stepping, and if \a checkItems also those whose item has been marked for removal by other means
+		virtual void	compact( bool checkItems ) = 0;
+		virtual bool	empty() const = 0;
+	};
+
+	// Tweens of one value type and one ease kind, sorted by start time so that each step only visits those which have begun
+	template<typename T>
+	struct Batch : public BatchBase {
+		struct Entry {
+			float		mStartTime, mEndTime, mInvDuration;
+			uint64_t	mSequence;
+			uint8_t		mState;
+			bool		mHasUpdateFn;
+			T			mStartValue, mEndValue;
+			T			*mTarget;
+			Tween<T>	*mTween;
+		};
+
+		Batch( EaseKind ease )
+			: mEase( ease ), mNumSorted( 0 )
+		{}
+
+		void add( Tween<T> *tween, State state, uint64_t sequence )
+		{
+			Entry entry;
+			entry.mSequence = sequence;
+			entry.mStartTime = tween->mStartTime;
+			entry.mEndTime = tween->getEndTime();
+			entry.mInvDuration = tween->mInvDuration;
+			entry.mState = state;
+			entry.mHasUpdateFn = (bool)tween->mUpdateFunction;
+			entry.mStartValue = tween->mStartValue;
+			entry.mEndValue = tween->mEndValue;
+			entry.mTarget = tween->getTarget();
+			entry.mTween = tween;
+			mEntries.push_back( entry );
+		}
+
+		// Entries added since the last step are sorted and merged into the rest
+		void mergeAdded()
+		{
+			if( mNumSorted == mEntries.size() )
+				return;
+
+			auto byStartTime = []( const Entry &a, const Entry &b ) { return a.mStartTime < b.mStartTime; };
+			const auto added = mEntries.begin() + mNumSorted;
+			std::stable_sort( added, mEntries.end(), byStartTime );
+			if( mNumSorted > 0 && added->mStartTime < ( added - 1 )->mStartTime )
+				std::inplace_merge( mEntries.begin(), added, mEntries.end(), byStartTime );
+			mNumSorted = mEntries.size();
+		}
+
+		void step( StepContext *context ) override
+		{
+			mergeAdded();
+
+			const float time = context->mTime;
+			const size_t numBegun = std::upper_bound( mEntries.begin(), mEntries.end(), time,
+										[]( float t, const Entry &e ) { return t < e.mStartTime; } ) - mEntries.begin();
+
+			mEased.resize( numBegun );
+			for( size_t i = 0; i < numBegun; ++i )
+				mEased[i] = math<float>::min( ( time - mEntries[i].mStartTime ) * mEntries[i].mInvDuration, 1 );
+
+			if( mEase == EASE_CUSTOM ) {
+				for( size_t i = 0; i < numBegun; ++i )
+					mEased[i] = mEntries[i].mTween->mEaseFunction( mEased[i] );
+				context->mCallbacksRan = true;
+			}
+			else
+				easeRange( mEase, mEased.data(), numBegun );
+
+			for( size_t i = 0; i < numBegun; ++i ) {
+				Entry &e = mEntries[i];
+				// a callback earlier in this step may have removed this tween
+				if( context->mCallbacksRan && e.mTween->mMarkedForRemoval )
+					continue;
+
+				if( ( e.mState == STATE_RUNNING && time < e.mEndTime ) || e.mState == STATE_COMPLETE ) {
+					*e.mTarget = tweenLerp<T>( e.mStartValue, e.mEndValue, mEased[i] );
+					if( e.mHasUpdateFn ) {
+						e.mTween->mUpdateFunction();
+						context->mCallbacksRan = true;
+					}
+				}
+				else if( e.mState != STATE_REMOVED ) {
+					Event event = { e.mSequence, this, i, nullptr };
+					context->mEvents->push_back( event );
+				}
+			}
+		}
+
+		// Starting and completing go through the tween itself, which takes care of its callbacks and flags
+		void processEvent( size_t index, StepContext *context ) override
+		{
+			Entry &e = mEntries[index];
+			e.mTween->TimelineItem::stepTo( context->mTime, false );
+			context->mCallbacksRan = true;
+			e.mStartValue = e.mTween->mStartValue;
+			if( ! e.mTween->mComplete )
+				e.mState = STATE_RUNNING;
+			else if( e.mTween->mAutoRemove ) {
+				if( ! e.mTween->mMarkedForRemoval ) {
+					e.mTween->mMarkedForRemoval = true;
+					context->mRemoved->push_back( e.mTween );
+				}
+				e.mState = STATE_REMOVED;
+				mHasRemoved = true;
+			}
+			else
+				e.mState = STATE_COMPLETE;
+		}
+
+		void compact( bool checkItems ) override
+		{
+			if( ! ( mHasRemoved || checkItems ) )
+				return;
+
+			mergeAdded();
+			mEntries.erase( std::remove_if( mEntries.begin(), mEntries.end(), [checkItems]( const Entry &e ) {
+				return e.mState == STATE_REMOVED || ( checkItems && e.mTween->mMarkedForRemoval );
+			} ), mEntries.end() );
+			mNumSorted = mEntries.size();
+			mHasRemoved = false;
+		}
+
+		bool empty() const override
+		{
+			return mEntries.empty();
+		}
+
+		EaseKind			mEase;
+		std::vector<Entry>	mEntries;
+		size_t				mNumSorted;
+		bool				mHasRemoved = false;
+		std::vector<float>	mEased;
+	};
+
+	TweenBatches()
+		: mNextSequence( 0 ), mDirty( true ), mExternalRemovals( false )
+	{}
+
+	void clear()
+	{
+		mBatches.clear();
+		mGeneric.clear();
+		mEvents.clear();
+		mPending.clear();
+		mRemoved.clear();
+		mExternalRemovals = false;
+	}
+
+	template<typename T>
+	bool addTween( TimelineItem *item, int typeIndex )
+	{
+		if( typeid( *item ) != typeid( Tween<T> ) )
+			return false;
+
+		Tween<T> *tween = static_cast<Tween<T>*>( item );
+		tween->updateDuration();
+		typedef T (*LerpFnPtr)( const T&, const T&, float );
+		const LerpFnPtr *lerp = tween->mLerpFunction.template target<LerpFnPtr>();
+		if( ( ! lerp ) || ( *lerp != &tweenLerp<T> ) || tween->mLoop || tween->mPingPong || tween->mInfinite || tween->mInvDuration <= 0 )
+			return false;
+
+		State state = STATE_DELEGATE;
+		if( tween->mHasStarted && ! tween->mComplete )
+			state = STATE_RUNNING;
+		else if( tween->mHasStarted && ( ! tween->mAutoRemove ) )
+			state = STATE_COMPLETE;
+
+		const EaseKind ease = classifyEase( tween->mEaseFunction );
+		std::unique_ptr<BatchBase> &batch = mBatches[typeIndex * NUM_EASE_KINDS + ease];
+		if( ! batch )
+			batch.reset( new Batch<T>( ease ) );
+		static_cast<Batch<T>*>( batch.get() )->add( tween, state, mNextSequence++ );
+		return true;
+	}
+
+	void classify( TimelineItem *item )
+	{
+		if( ! ( addTween<float>( item, 0 ) || addTween<vec2>( item, 1 ) || addTween<vec3>( item, 2 ) || addTween<Color>( item, 3 ) ) )
+			mGeneric.push_back( make_pair( mNextSequence++, item ) );
+	}
+
+	//! Rebuilds from scratch if necessary, then sorts the pending items into batches
+	void update( const std::multimap<void*,TimelineItemRef> &items )
+	{
+		if( mDirty ) {
+			clear();
+			mBatches.resize( 4 * NUM_EASE_KINDS );
+			for( const auto &item : items )
+				mPending.push_back( item.second );
+			mDirty = false;
+		}
+
+		for( const TimelineItemRef &item : mPending ) {
+			if( ! item->mMarkedForRemoval )
+				classify( item.get() );
+		}
+		mPending.clear();
+	}
+
+	void step( float time )
+	{
+		StepContext context = { time, false, &mRemoved, &mEvents };
+		for( auto &batch : mBatches ) {
+			if( batch )
+				batch->step( &context );
+		}
+
+		for( const auto &generic : mGeneric ) {
+			Event event = { generic.first, nullptr, 0, generic.second };
+			mEvents.push_back( event );
+		}
+
+		// Events are processed in the order the items were added, which is the order the multimap of items would visit them in for any one target.
+		// That way a tween appended to another starts from the value the first one finished on.
+		std::sort( mEvents.begin(), mEvents.end() );
+		for( const Event &event : mEvents ) {
+			if( event.mBatch )
+				event.mBatch->processEvent( event.mIndex, &context );
+			else {
+				TimelineItem *item = event.mItem;
+				item->stepTo( time, false );
+				if( item->isComplete() && item->getAutoRemove() && ( ! item->mMarkedForRemoval ) ) {
+					item->mMarkedForRemoval = true;
+					mRemoved.push_back( item );
+				}
+			}
+		}
+		mEvents.clear();
+	}
+
+	//! Removes marked items from the batches and then from \a items. Returns \c false if the caller needs to search \a items for marked items itself.
+	bool eraseMarked( std::multimap<void*,TimelineItemRef> *items )
+	{
+		if( mDirty ) {
+			mRemoved.clear();
+			mExternalRemovals = false;
+			return false;
+		}
+
+		for( auto &batch : mBatches ) {
+			if( batch )
+				batch->compact( mExternalRemovals );
+		}
+		mGeneric.erase( std::remove_if( mGeneric.begin(), mGeneric.end(), []( const std::pair<uint64_t,TimelineItem*> &generic ) {
+			return generic.second->mMarkedForRemoval;
+		} ), mGeneric.end() );
+
+		if( mExternalRemovals ) {
+			mRemoved.clear();
+			mExternalRemovals = false;
+			return false;
+		}
+
+		// everything marked was marked by stepping, so the items can be looked up by target rather than visiting all of them
+		for( TimelineItem *item : mRemoved ) {
+			auto range = items->equal_range( item->mTarget );
+			for( auto iter = range.first; iter != range.second; ++iter ) {
+				if( iter->second.get() == item ) {
+					items->erase( iter );
+					break;
+				}
+			}
+		}
+		mRemoved.clear();
+		return true;
+	}
+
+	std::vector<std::unique_ptr<BatchBase>>	mBatches; // indexed by value type * NUM_EASE_KINDS + ease kind
+	std::vector<std::pair<uint64_t,TimelineItem*>>	mGeneric; // items stepped individually, with their sequence numbers
+	std::vector<Event>						mEvents;
+	std::vector<TimelineItemRef>			mPending;
+	std::vector<TimelineItem*>				mRemoved;
+	uint64_t								mNextSequence; // order in which items were added
+	bool									mDirty, mExternalRemovals;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Timeline
 typedef std::multimap<void*,TimelineItemRef>::iterator s_iter;
 typedef std::multimap<void*,TimelineItemRef>::const_iterator s_const_iter;
 
 Timeline::Timeline()
-	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 )
+	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 ), mHasMarkedItems( false )
 {
 	mUseAbsoluteTime = true;
 }
 
 Timeline::Timeline( const Timeline &rhs )
-	: TimelineItem( rhs ), mDefaultAutoRemove( rhs.mDefaultAutoRemove ), mCurrentTime( rhs.mCurrentTime )
+	: TimelineItem( rhs ), mDefaultAutoRemove( rhs.mDefaultAutoRemove ), mCurrentTime( rhs.mCurrentTime ), mHasMarkedItems( true )
 {
 	for( s_const_iter iter = rhs.mItems.begin(); iter != rhs.mItems.end(); ++iter ) {
-		mItems.insert( make_pair( iter->first, iter->second->clone() ) );
+		TimelineItemRef cloned = iter->second->clone();
+		cloned->mParent = this;
+		mItems.insert( make_pair( iter->first, cloned ) );
 	}
+
+	if( rhs.mTweenBatches )
+		mTweenBatches.reset( new TweenBatches );
+}
+
+Timeline::~Timeline()
+{
+}
+
+void Timeline::setBatched( bool batched )
+{
+	if( batched && ! mTweenBatches )
+		mTweenBatches.reset( new TweenBatches );
+	else if( ! batched )
+		mTweenBatches.reset();
+}
+
+void Timeline::markedForRemoval()
+{
+	mHasMarkedItems = true;
+	if( mTweenBatches )
+		mTweenBatches->mExternalRemovals = true;
+}
+
+void Timeline::markBatchesDirty()
+{
+	if( mTweenBatches )
+		mTweenBatches->mDirty = true;
+}
+
+void Timeline::stepBatched( float time )
+{
+	mTweenBatches->update( mItems );
+	mTweenBatches->step( time );
+	if( ! mTweenBatches->mRemoved.empty() )
+		mHasMarkedItems = true;
 }
 
 void Timeline::step( float timestep )
@@ -63,14 +641,23 @@ void Timeline::stepTo( float absoluteTime )
 	
 	eraseMarked();
 	
-	// we need to cache the end(). If a tween's update() fn or similar were to manipulate
-	// the list of items by adding new ones, we'll have invalidated our iterator.
-	// Deleted items are never removed immediately, but are marked for deletion.
-	s_iter endItem = mItems.end();
-	for( s_iter iter = mItems.begin(); iter != endItem; ++iter ) {
-		iter->second->stepTo( mCurrentTime, reverse );
-		if( iter->second->isComplete() && iter->second->getAutoRemove() )
-			iter->second->mMarkedForRemoval = true;
+	if( mTweenBatches && ! reverse )
+		stepBatched( mCurrentTime );
+	else {
+		// we need to cache the end(). If a tween's update() fn or similar were to manipulate
+		// the list of items by adding new ones, we'll have invalidated our iterator.
+		// Deleted items are never removed immediately, but are marked for deletion.
+		s_iter endItem = mItems.end();
+		for( s_iter iter = mItems.begin(); iter != endItem; ++iter ) {
+			iter->second->stepTo( mCurrentTime, reverse );
+			if( iter->second->isComplete() && iter->second->getAutoRemove() ) {
+				iter->second->mMarkedForRemoval = true;
+				mHasMarkedItems = true;
+			}
+		}
+
+		// stepping backwards changes the items' state in ways the batches don't track
+		markBatchesDirty();
 	}
 	
 	eraseMarked();	
@@ -87,6 +674,11 @@ CueRef Timeline::add( const std::function<void ()> &action, float atTime )
 void Timeline::clear()
 {
 	mItems.clear();	
+	mHasMarkedItems = false;
+	if( mTweenBatches ) {
+		mTweenBatches->clear();
+		mTweenBatches->mDirty = true;
+	}
 }
 
 void Timeline::appendPingPong()
@@ -104,6 +696,8 @@ void Timeline::appendPingPong()
 		mItems.insert( make_pair( (*appIt)->mTarget, *appIt ) );
 	}
 	
+	mHasMarkedItems = true;
+	markBatchesDirty();
 	setDurationDirty();
 }
 
@@ -116,22 +710,33 @@ void Timeline::apply( TimelineItemRef item )
 
 void Timeline::add( TimelineItemRef item )
 {
-	item->mParent = this;
 	item->mStartTime = mCurrentTime;
-	mItems.insert( make_pair( item->mTarget, item ) );
-	setDurationDirty();
+	insert( item );
 }
 
 void Timeline::insert( TimelineItemRef item )
 {
 	item->mParent = this;
 	mItems.insert( make_pair( item->mTarget, item ) );
+	if( item->mMarkedForRemoval )
+		markedForRemoval();
+	if( mTweenBatches )
+		mTweenBatches->mPending.push_back( item );
 	setDurationDirty();
 }
 
 // remove all items which have been marked for removal
 void Timeline::eraseMarked()
 {
+	if( ! mHasMarkedItems )
+		return;
+	mHasMarkedItems = false;
+
+	if( mTweenBatches && mTweenBatches->eraseMarked( &mItems ) ) {
+		setDurationDirty();
+		return;
+	}
+
 	bool needRecalc = false;
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ) {
 		if( iter->second->mMarkedForRemoval ) {
@@ -235,6 +840,7 @@ void Timeline::remove( TimelineItemRef item )
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
 		if( iter->second == item ) {
 			iter->second->mMarkedForRemoval = true;
+			markedForRemoval();
 			break;
 		}
 	}
@@ -249,6 +855,8 @@ void Timeline::removeTarget( void *target )
 	for( s_iter iter = range.first; iter != range.second; ++iter )
 		iter->second->mMarkedForRemoval = true;
 
+	if( range.first != range.second )
+		markedForRemoval();
 	setDurationDirty();
 }
 
@@ -266,8 +874,13 @@ void Timeline::cloneAndReplaceTarget( void *target, void *replacementTarget )
 		newItems.back()->setTarget( replacementTarget );
 	}
 
-	for( vector<TimelineItemRef>::iterator newItemIt = newItems.begin(); newItemIt != newItems.end(); ++newItemIt )
+	for( vector<TimelineItemRef>::iterator newItemIt = newItems.begin(); newItemIt != newItems.end(); ++newItemIt ) {
 		mItems.insert( make_pair( replacementTarget, *newItemIt ) );
+		if( (*newItemIt)->mMarkedForRemoval )
+			markedForRemoval();
+		if( mTweenBatches )
+			mTweenBatches->mPending.push_back( *newItemIt );
+	}
 
 	setDurationDirty();
 }
@@ -283,6 +896,8 @@ void Timeline::replaceTarget( void *target, void *replacementTarget )
 		mItems.insert( make_pair( replacementTarget, iter->second ) );
 		iter = mItems.erase( iter );
 	}
+
+	markBatchesDirty();
 }
 
 void Timeline::reset( bool unsetStarted )
@@ -291,6 +906,8 @@ void Timeline::reset( bool unsetStarted )
 	
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
 		iter->second->reset( unsetStarted );
+
+	markBatchesDirty();
 }
 
 
@@ -303,6 +920,8 @@ void Timeline::reverse()
 {
 	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
 		iter->second->reverse();
+
+	markBatchesDirty();
 }
 
 TimelineItemRef Timeline::clone() const
@@ -326,9 +945,13 @@ void Timeline::update( float absTime )
 	stepTo( absTime );
 }
 
-void Timeline::itemTimeChanged( TimelineItem * /*item*/ )
+void Timeline::itemTimeChanged( TimelineItem *item )
 {
 	setDurationDirty();
+
+	// the common case is adjusting the tween that was just added, which hasn't been sorted into a batch yet
+	if( mTweenBatches && ( mTweenBatches->mPending.empty() || mTweenBatches->mPending.back().get() != item ) )
+		markBatchesDirty();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -47,6 +47,8 @@ TimelineItem::TimelineItem( Timeline *parent, void *target, float startTime, flo
 void TimelineItem::removeSelf()
 {
 	mMarkedForRemoval = true;
+	if( mParent )
+		mParent->markedForRemoval();
 }
 
 void TimelineItem::stepTo( float newTime, bool reverse )
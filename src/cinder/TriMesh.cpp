@@ -25,14 +25,140 @@
 
 #include "cinder/TriMesh.h"
 #include "cinder/Exception.h"
+#include "cinder/Thread.h"
 #if defined( CINDER_ANDROID )
 	#include "cinder/android/CinderAndroid.h"
 #endif 
 
+#if defined( CINDER_MSW_DESKTOP )
+	#include <windows.h>
+#elif defined( CINDER_POSIX )
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
 using namespace std;
 
 namespace cinder {
 
+constexpr float TriMesh::DEFAULT_WELD_TOLERANCE;
+
+namespace {
+
+// Moves the \a dims values of each vertex \a i to \a remap[i], dropping it if that is not less than \a numVertices
+template<typename T>
+void remapAttrib( const vector<uint32_t> &remap, size_t numVertices, uint8_t dims, vector<T> *data )
+{
+	if( data->empty() || dims == 0 )
+		return;
+
+	vector<T> result( numVertices * dims );
+	for( size_t i = 0; i < remap.size(); ++i ) {
+		if( remap[i] < numVertices )
+			std::copy( data->begin() + i * dims, data->begin() + ( i + 1 ) * dims, result.begin() + remap[i] * dims );
+	}
+	data->swap( result );
+}
+
+// Returns a map from each vertex to the lowest-indexed vertex within \a tolerance of it for which \a equalFn also returns true.
+// Vertices are hashed into a grid of cells twice the size of \a tolerance, so only 8 cells need to be searched.
+// A \a tolerance of zero or less, or too small to square, only matches identical positions. Vertices with non-finite positions are never merged.
+template<typename EqualFnT>
+vector<uint32_t> calcWeldMap( const float *positions, uint8_t dims, size_t numVertices, float tolerance, const EqualFnT &equalFn )
+{
+	const float tolerance2 = tolerance * tolerance;
+	const bool exact = ! ( tolerance > 0 ) || ! ( tolerance2 > 0 ) || ! std::isfinite( 0.5f / tolerance );
+	const float invCellSize = exact ? 1.0f : 0.5f / tolerance;
+	const uint8_t numDims = std::min<uint8_t>( dims, 3 );
+
+	auto getPosition = [=]( size_t i ) {
+		vec3 result( 0 );
+		for( uint8_t d = 0; d < numDims; ++d )
+			result[d] = positions[i * dims + d];
+		return result;
+	};
+
+	// casting a cell coordinate beyond the range of int64_t is undefined, so far out cells are clamped together; their vertices are still compared by distance
+	auto cellCoord = []( float c ) {
+		return (int64_t)std::max( -4.0e18, std::min( 4.0e18, floor( (double)c ) ) );
+	};
+
+	auto cellKey = [=]( int64_t x, int64_t y, int64_t z ) {
+		return (uint64_t)x * 73856093ULL ^ (uint64_t)y * 19349663ULL ^ (uint64_t)z * 83492791ULL;
+	};
+
+	// each cell stores the head of a linked list through 'next' of the unique vertices it contains
+	unordered_map<uint64_t, uint32_t> cells;
+	cells.reserve( numVertices );
+	vector<uint32_t> next( numVertices, UINT32_MAX );
+	vector<uint32_t> result( numVertices );
+
+	for( uint32_t i = 0; i < (uint32_t)numVertices; ++i ) {
+		result[i] = i;
+		const vec3 p = getPosition( i );
+		if( ! ( glm::all( glm::isfinite( p ) ) ) )
+			continue;
+
+		uint32_t match = UINT32_MAX;
+		int64_t cx, cy, cz;
+		if( exact ) {
+			// key on the bits of the position, with -0 treated as 0
+			const vec3 q = p + vec3( 0 );
+			uint32_t bits[3];
+			memcpy( bits, &q, sizeof( bits ) );
+			cx = bits[0]; cy = bits[1]; cz = bits[2];
+
+			auto cell = cells.find( cellKey( cx, cy, cz ) );
+			for( uint32_t j = ( cell != cells.end() ) ? cell->second : UINT32_MAX; j != UINT32_MAX; j = next[j] ) {
+				if( getPosition( j ) == p && j < match && equalFn( i, j ) )
+					match = j;
+			}
+		}
+		else {
+			const vec3 c = p * invCellSize;
+			cx = cellCoord( c.x );
+			cy = cellCoord( c.y );
+			cz = cellCoord( c.z );
+
+			// cells are twice the tolerance, so a match can only be in this cell or the adjacent one closest to the vertex on each axis
+			const int64_t nx = ( c.x - cx < 0.5f ) ? -1 : 1;
+			const int64_t ny = ( c.y - cy < 0.5f ) ? -1 : 1;
+			const int64_t nz = ( c.z - cz < 0.5f ) ? -1 : 1;
+			for( int n = 0; n < 8; ++n ) {
+				auto cell = cells.find( cellKey( cx + ( ( n & 1 ) ? nx : 0 ), cy + ( ( n & 2 ) ? ny : 0 ), cz + ( ( n & 4 ) ? nz : 0 ) ) );
+				if( cell == cells.end() )
+					continue;
+				for( uint32_t j = cell->second; j != UINT32_MAX; j = next[j] ) {
+					if( j < match && distance2( getPosition( j ), p ) < tolerance2 && equalFn( i, j ) )
+						match = j;
+				}
+			}
+		}
+
+		if( match != UINT32_MAX ) {
+			result[i] = match;
+		}
+		else {
+			// vertex is unique, add it to its cell
+			auto inserted = cells.insert( make_pair( cellKey( cx, cy, cz ), i ) );
+			if( ! inserted.second ) {
+				next[i] = inserted.first->second;
+				inserted.first->second = i;
+			}
+		}
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // TriMeshGeomTarget
 class TriMeshGeomTarget : public geom::Target {
@@ -446,6 +572,370 @@ AxisAlignedBox TriMesh::calcBoundingBox( const mat4 &transform ) const
 	return AxisAlignedBox( min, max );
 }
 
+namespace {
+
+// Version 3 files start with a 16 byte header: the version, V3_MAGIC, the number of blocks (uint32) and the size of the file (uint64). It is followed
+// by a table of BlockDesc, then the blocks themselves, each aligned to V3_ALIGNMENT bytes. Values are stored in the byte order of the machine that
+// wrote the file and are not swapped when read, so files are only portable between machines of the same endianness.
+const uint8_t	V3_MAGIC[3] = { 'T', 'R', 'I' };
+const size_t	V3_HEADER_SIZE = 16;
+const size_t	V3_ALIGNMENT = 16;
+// the attrib of the index block
+const uint32_t	V3_INDICES = 0;
+// the bits TriMesh::toMask() can return, one of which identifies each attribute block
+const uint32_t	V3_ATTRIB_MASKS = 0x03FF373F;
+// UNORM16 blocks start with the minimum and the scale of each of up to four dimensions
+const size_t	V3_RANGE_SIZE = 8 * sizeof( float );
+// each byte of a compressed vertex is stored in groups of this many differences
+const size_t	V3_GROUP_SIZE = 16;
+
+enum BlockFormat : uint8_t { FORMAT_FLOAT32, FORMAT_UINT32, FORMAT_OCT16, FORMAT_UNORM16 };
+enum BlockCompression : uint8_t { COMPRESSION_NONE, COMPRESSION_DELTA };
+
+struct BlockDesc {
+	uint32_t	mAttrib;
+	uint8_t		mDims, mFormat, mCompression, mReserved;
+	uint32_t	mCount;
+	uint32_t	mReserved2;
+	uint64_t	mOffset, mSize;
+};
+
+static_assert( sizeof( BlockDesc ) == 32, "BlockDesc must be packed" );
+
+// Returns the size in bytes of one element of a block, or 0 if the combination of \a format and \a dims is invalid
+size_t calcElementSize( uint8_t format, uint8_t dims )
+{
+	switch( format ) {
+		case FORMAT_FLOAT32:	return ( dims >= 1 && dims <= 4 ) ? dims * sizeof( float ) : 0;
+		case FORMAT_UINT32:		return ( dims == 1 ) ? sizeof( uint32_t ) : 0;
+		case FORMAT_OCT16:		return ( dims == 3 ) ? 2 * sizeof( int16_t ) : 0;
+		case FORMAT_UNORM16:	return ( dims >= 1 && dims <= 4 ) ? dims * sizeof( uint16_t ) : 0;
+		default:				return 0;
+	}
+}
+
+inline uint8_t zigzag( uint8_t v )
+{
+	return uint8_t( ( v << 1 ) ^ ( int8_t( v ) >> 7 ) );
+}
+
+inline uint8_t unzigzag( uint8_t v )
+{
+	return uint8_t( ( v >> 1 ) ^ -( v & 1 ) );
+}
+
+// Appends \a count elements of \a elementSize bytes to \a result. Similar to meshoptimizer's vertex codec, each byte of the element is stored
+// as a separate stream of differences from the previous element, in groups which are packed into 0, 2, 4 or 8 bits per difference.
+// Smoothly varying attributes have small differences in all but their lowest bytes.
+void encodeVertexBytes( const uint8_t *data, size_t count, size_t elementSize, vector<uint8_t> *result )
+{
+	const size_t numGroups = ( count + V3_GROUP_SIZE - 1 ) / V3_GROUP_SIZE;
+	for( size_t k = 0; k < elementSize; ++k ) {
+		const size_t headers = result->size();
+		result->resize( headers + ( numGroups + 3 ) / 4, 0 );
+		uint8_t previous = 0;
+		for( size_t g = 0; g < numGroups; ++g ) {
+			uint8_t deltas[V3_GROUP_SIZE] = {};
+			uint8_t bits = 0;
+			for( size_t i = 0; i < V3_GROUP_SIZE && g * V3_GROUP_SIZE + i < count; ++i ) {
+				const uint8_t v = data[( g * V3_GROUP_SIZE + i ) * elementSize + k];
+				deltas[i] = zigzag( uint8_t( v - previous ) );
+				bits |= deltas[i];
+				previous = v;
+			}
+
+			const uint8_t mode = ( bits == 0 ) ? 0 : ( bits < 4 ) ? 1 : ( bits < 16 ) ? 2 : 3;
+			(*result)[headers + g / 4] |= uint8_t( mode << ( ( g % 4 ) * 2 ) );
+			if( mode == 3 ) {
+				result->insert( result->end(), deltas, deltas + V3_GROUP_SIZE );
+			}
+			else if( mode != 0 ) {
+				const int perByte = ( mode == 1 ) ? 4 : 2, shift = 8 / perByte;
+				for( size_t i = 0; i < V3_GROUP_SIZE; i += perByte ) {
+					uint8_t packed = 0;
+					for( int j = 0; j < perByte; ++j )
+						packed |= uint8_t( deltas[i + j] << ( j * shift ) );
+					result->push_back( packed );
+				}
+			}
+		}
+	}
+}
+
+// Decodes \a count elements written by encodeVertexBytes() into \a result. Returns \c false if \a size bytes at \a data are not enough.
+bool decodeVertexBytes( const uint8_t *data, size_t size, size_t count, size_t elementSize, uint8_t *result )
+{
+	const uint8_t *end = data + size;
+	const size_t numGroups = ( count + V3_GROUP_SIZE - 1 ) / V3_GROUP_SIZE;
+	for( size_t k = 0; k < elementSize; ++k ) {
+		const uint8_t *headers = data;
+		if( size_t( end - data ) < ( numGroups + 3 ) / 4 )
+			return false;
+		data += ( numGroups + 3 ) / 4;
+
+		uint8_t previous = 0;
+		for( size_t g = 0; g < numGroups; ++g ) {
+			const uint8_t mode = ( headers[g / 4] >> ( ( g % 4 ) * 2 ) ) & 3;
+			uint8_t deltas[V3_GROUP_SIZE];
+			if( mode == 0 ) {
+				memset( deltas, 0, V3_GROUP_SIZE );
+			}
+			else {
+				const size_t payload = size_t( 2 ) << mode;
+				if( size_t( end - data ) < payload )
+					return false;
+				if( mode == 3 ) {
+					memcpy( deltas, data, V3_GROUP_SIZE );
+				}
+				else {
+					const int perByte = ( mode == 1 ) ? 4 : 2, shift = 8 / perByte;
+					const uint8_t mask = uint8_t( ( 1 << shift ) - 1 );
+					for( size_t i = 0; i < V3_GROUP_SIZE; ++i )
+						deltas[i] = ( data[i / perByte] >> ( ( i % perByte ) * shift ) ) & mask;
+				}
+				data += payload;
+			}
+
+			const size_t first = g * V3_GROUP_SIZE, groupSize = std::min( V3_GROUP_SIZE, count - first );
+			uint8_t *dst = result + first * elementSize + k;
+			for( size_t i = 0; i < groupSize; ++i, dst += elementSize ) {
+				previous += unzigzag( deltas[i] );
+				*dst = previous;
+			}
+		}
+	}
+
+	return true;
+}
+
+// Appends each index to \a result as the zigzag encoded difference from the previous index, in 7-bit groups
+void encodeIndices( const uint32_t *indices, size_t count, vector<uint8_t> *result )
+{
+	uint32_t previous = 0;
+	for( size_t i = 0; i < count; ++i ) {
+		const uint32_t delta = indices[i] - previous;
+		uint32_t v = ( delta << 1 ) ^ uint32_t( int32_t( delta ) >> 31 );
+		while( v >= 0x80 ) {
+			result->push_back( uint8_t( v | 0x80 ) );
+			v >>= 7;
+		}
+		result->push_back( uint8_t( v ) );
+		previous = indices[i];
+	}
+}
+
+// Decodes \a count indices written by encodeIndices() into \a result. Returns \c false if \a size bytes at \a data are not enough.
+bool decodeIndices( const uint8_t *data, size_t size, size_t count, uint32_t *result )
+{
+	const uint8_t *end = data + size;
+	uint32_t previous = 0;
+	for( size_t i = 0; i < count; ++i ) {
+		uint32_t v = 0;
+		for( int shift = 0; ; shift += 7 ) {
+			if( data == end || shift > 28 )
+				return false;
+			const uint8_t b = *data++;
+			v |= uint32_t( b & 0x7f ) << shift;
+			if( ! ( b & 0x80 ) )
+				break;
+		}
+		previous += ( v >> 1 ) ^ ( 0u - ( v & 1 ) );
+		result[i] = previous;
+	}
+
+	return true;
+}
+
+// Maps the unit sphere onto an octahedron unfolded into a square, storing the two coordinates as 16-bit signed fractions
+void encodeOctahedral( const vec3 &v, int16_t result[2] )
+{
+	const float l1 = std::abs( v.x ) + std::abs( v.y ) + std::abs( v.z );
+	vec2 p( 0 );
+	if( l1 > 0 && std::isfinite( l1 ) ) {
+		p = vec2( v.x, v.y ) / l1;
+		if( v.z < 0 )
+			p = ( 1.0f - glm::abs( vec2( p.y, p.x ) ) ) * vec2( p.x >= 0 ? 1.0f : -1.0f, p.y >= 0 ? 1.0f : -1.0f );
+	}
+
+	result[0] = int16_t( std::round( glm::clamp( p.x, -1.0f, 1.0f ) * 32767.0f ) );
+	result[1] = int16_t( std::round( glm::clamp( p.y, -1.0f, 1.0f ) * 32767.0f ) );
+}
+
+vec3 decodeOctahedral( const int16_t v[2] )
+{
+	const vec2 p = glm::max( vec2( v[0], v[1] ) / 32767.0f, vec2( -1 ) );
+	vec3 n( p.x, p.y, 1 - std::abs( p.x ) - std::abs( p.y ) );
+	const float t = std::max( -n.z, 0.0f );
+	n.x += ( n.x >= 0 ) ? -t : t;
+	n.y += ( n.y >= 0 ) ? -t : t;
+
+	return normalize( n );
+}
+
+// Stores each dimension of \a data as a 16-bit fraction of its range, after a V3_RANGE_SIZE header holding the minimum and scale of each dimension.
+// Returns \c false if \a data has non-finite values, which cannot be quantized.
+bool encodeUnorm16( const float *data, size_t count, uint8_t dims, vector<uint8_t> *result )
+{
+	float range[8] = {};
+	for( uint8_t d = 0; d < dims; ++d ) {
+		float minValue = FLT_MAX, maxValue = -FLT_MAX;
+		for( size_t i = 0; i < count; ++i ) {
+			const float v = data[i * dims + d];
+			if( ! std::isfinite( v ) )
+				return false;
+			minValue = std::min( minValue, v );
+			maxValue = std::max( maxValue, v );
+		}
+		if( ! std::isfinite( maxValue - minValue ) )
+			return false;
+		range[d] = minValue;
+		range[4 + d] = ( maxValue - minValue ) / 65535.0f;
+	}
+
+	result->resize( V3_RANGE_SIZE + count * dims * sizeof( uint16_t ) );
+	memcpy( result->data(), range, V3_RANGE_SIZE );
+	uint16_t *dst = reinterpret_cast<uint16_t*>( result->data() + V3_RANGE_SIZE );
+	for( size_t i = 0; i < count * dims; ++i ) {
+		const uint8_t d = uint8_t( i % dims );
+		dst[i] = ( range[4 + d] > 0 ) ? uint16_t( std::min( std::round( ( data[i] - range[d] ) / range[4 + d] ), 65535.0f ) ) : 0;
+	}
+
+	return true;
+}
+
+// Returns whether desc.mSize is at least the smallest size a block of desc.mCount elements can be encoded in, so that a corrupt count
+// cannot cause a larger allocation than the block could legitimately expand to.
+bool isBlockSizeValid( const BlockDesc &desc, size_t elementSize )
+{
+	const uint64_t prefixSize = ( desc.mFormat == FORMAT_UNORM16 ) ? V3_RANGE_SIZE : 0;
+	const uint64_t count = desc.mCount;
+	uint64_t minSize;
+	if( desc.mCompression == COMPRESSION_NONE )
+		minSize = count * elementSize;
+	else if( desc.mCompression == COMPRESSION_DELTA && desc.mFormat == FORMAT_UINT32 )
+		minSize = count; // at least one byte per index
+	else if( desc.mCompression == COMPRESSION_DELTA )
+		minSize = elementSize * ( ( ( count + V3_GROUP_SIZE - 1 ) / V3_GROUP_SIZE + 3 ) / 4 ); // only the group headers
+	else
+		return false;
+
+	return desc.mSize >= prefixSize + minSize;
+}
+
+// Decodes a block described by \a desc into \a result, which holds desc.mCount elements of desc.mDims floats, or indices for the index block.
+// Returns \c false if the block is too short.
+bool decodeBlock( const BlockDesc &desc, const uint8_t *block, void *result )
+{
+	const size_t elementSize = calcElementSize( desc.mFormat, desc.mDims );
+	const size_t prefixSize = ( desc.mFormat == FORMAT_UNORM16 ) ? V3_RANGE_SIZE : 0;
+	if( desc.mSize < prefixSize )
+		return false;
+
+	const uint8_t *elements = block + prefixSize;
+	const size_t elementsSize = size_t( desc.mSize ) - prefixSize;
+	const size_t count = desc.mCount;
+	const bool directResult = ( desc.mFormat == FORMAT_FLOAT32 || desc.mFormat == FORMAT_UINT32 );
+
+	// decompress into the result directly when no further decoding is needed
+	vector<uint8_t> decompressed;
+	if( desc.mCompression == COMPRESSION_DELTA ) {
+		if( desc.mFormat == FORMAT_UINT32 )
+			return decodeIndices( elements, elementsSize, count, static_cast<uint32_t*>( result ) );
+
+		uint8_t *dst = static_cast<uint8_t*>( result );
+		if( ! directResult ) {
+			decompressed.resize( count * elementSize );
+			dst = decompressed.data();
+		}
+		if( ! decodeVertexBytes( elements, elementsSize, count, elementSize, dst ) )
+			return false;
+		if( directResult )
+			return true;
+		elements = decompressed.data();
+	}
+	else if( desc.mCompression == COMPRESSION_NONE ) {
+		if( elementsSize < count * elementSize )
+			return false;
+		if( directResult ) {
+			memcpy( result, elements, count * elementSize );
+			return true;
+		}
+	}
+	else {
+		return false;
+	}
+
+	float *dst = static_cast<float*>( result );
+	if( desc.mFormat == FORMAT_OCT16 ) {
+		for( size_t i = 0; i < count; ++i ) {
+			int16_t v[2];
+			memcpy( v, elements + i * elementSize, sizeof( v ) );
+			const vec3 n = decodeOctahedral( v );
+			dst[i * 3 + 0] = n.x;
+			dst[i * 3 + 1] = n.y;
+			dst[i * 3 + 2] = n.z;
+		}
+	}
+	else {
+		float range[8];
+		memcpy( range, block, V3_RANGE_SIZE );
+		for( size_t i = 0; i < count * desc.mDims; ++i ) {
+			uint16_t v;
+			memcpy( &v, elements + i * sizeof( uint16_t ), sizeof( v ) );
+			const uint8_t d = uint8_t( i % desc.mDims );
+			dst[i] = range[d] + v * range[4 + d];
+		}
+	}
+
+	return true;
+}
+
+// Maps the file at \a path into memory, returning \c nullptr if that is not possible
+shared_ptr<const void> mapFile( const fs::path &path, size_t *resultSize )
+{
+#if defined( CINDER_MSW_DESKTOP )
+	HANDLE file = ::CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		return nullptr;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	if( ::GetFileSizeEx( file, &size ) && size.QuadPart > 0 )
+		mapping = ::CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	::CloseHandle( file );
+	if( ! mapping )
+		return nullptr;
+
+	void *data = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	::CloseHandle( mapping );
+	if( ! data )
+		return nullptr;
+
+	*resultSize = (size_t)size.QuadPart;
+	return shared_ptr<const void>( data, []( const void *p ) { ::UnmapViewOfFile( p ); } );
+#elif defined( CINDER_POSIX )
+	int fd = ::open( path.string().c_str(), O_RDONLY );
+	if( fd < 0 )
+		return nullptr;
+
+	struct stat info;
+	void *data = MAP_FAILED;
+	if( ::fstat( fd, &info ) == 0 && info.st_size > 0 )
+		data = ::mmap( nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	::close( fd );
+	if( data == MAP_FAILED )
+		return nullptr;
+
+	const size_t size = (size_t)info.st_size;
+	*resultSize = size;
+	return shared_ptr<const void>( data, [size]( const void *p ) { ::munmap( const_cast<void*>( p ), size ); } );
+#else
+	return nullptr;
+#endif
+}
+
+} // anonymous namespace
+
 void TriMesh::read( const DataSourceRef &dataSource )
 {
 	IStreamRef in = dataSource->createStream();
@@ -461,8 +951,13 @@ void TriMesh::read( const DataSourceRef &dataSource )
 		clear();
 		readImplV2( in );
 	}
+	else if( versionNumber == 3 ) {
+		in.reset();
+		clear();
+		readImplV3( dataSource );
+	}
 	else {
-		throw Exception( "TriMesh::read() error: wrong version number. expected version = 1 or 2, version read: " + std::to_string( versionNumber ) );
+		throw Exception( "TriMesh::read() error: wrong version number. expected version = 1, 2 or 3, version read: " + std::to_string( versionNumber ) );
 	}
 }
 
@@ -515,6 +1010,132 @@ void TriMesh::write( const DataTargetRef &dataTarget, uint32_t writeMask ) const
 	writeAttrib( toMask( geom::BITANGENT ), mBitangentsDims, mBitangents.size() * 3, mBitangents.data() );
 }
 
+void TriMesh::write( const DataTargetRef &dataTarget, const WriteOptions &options ) const
+{
+	if( options.getVersion() == 2 )
+		write( dataTarget, options.getAttribMask() );
+	else if( options.getVersion() == 3 )
+		writeImplV3( dataTarget, options );
+	else
+		throw Exception( "TriMesh::write() error: unsupported version number: " + std::to_string( options.getVersion() ) );
+}
+
+void TriMesh::writeImplV3( const DataTargetRef &dataTarget, const WriteOptions &options ) const
+{
+	struct Block {
+		BlockDesc		mDesc;
+		const uint8_t	*mData;
+		vector<uint8_t>	mStorage;
+	};
+
+	vector<Block> blocks;
+	// keeps quantized attributes alive until they are written
+	deque<vector<uint8_t>> quantized;
+
+	// adds a block of \a count elements at \a data, preceded by \a prefixSize bytes. Uncompressed data is written in place, so must outlive the write.
+	auto addBlock = [&]( uint32_t attrib, uint8_t dims, uint8_t format, size_t count, const uint8_t *data, size_t size, size_t prefixSize, bool compress ) {
+		Block block;
+		memset( &block.mDesc, 0, sizeof( block.mDesc ) );
+		block.mDesc.mAttrib = attrib;
+		block.mDesc.mDims = dims;
+		block.mDesc.mFormat = format;
+		block.mDesc.mCount = (uint32_t)count;
+		if( compress ) {
+			block.mStorage.assign( data, data + prefixSize );
+			if( format == FORMAT_UINT32 )
+				encodeIndices( reinterpret_cast<const uint32_t*>( data ), count, &block.mStorage );
+			else
+				encodeVertexBytes( data + prefixSize, count, calcElementSize( format, dims ), &block.mStorage );
+			block.mDesc.mCompression = COMPRESSION_DELTA;
+			block.mDesc.mSize = block.mStorage.size();
+			block.mData = block.mStorage.data();
+		}
+		else {
+			block.mDesc.mCompression = COMPRESSION_NONE;
+			block.mDesc.mSize = size;
+			block.mData = data;
+		}
+		blocks.push_back( std::move( block ) );
+	};
+
+	auto addAttrib = [&]( geom::Attrib attrib, uint8_t dims, size_t numFloats, const float *data ) {
+		const uint32_t mask = toMask( attrib );
+		if( numFloats == 0 || dims == 0 || dims > 4 || ! ( options.getAttribMask() & mask ) )
+			return;
+
+		const size_t count = numFloats / dims;
+		const bool isVector = ( attrib == geom::NORMAL || attrib == geom::TANGENT || attrib == geom::BITANGENT );
+		const bool isTexCoord = ( attrib == geom::TEX_COORD_0 || attrib == geom::TEX_COORD_1 || attrib == geom::TEX_COORD_2 || attrib == geom::TEX_COORD_3 );
+		if( isVector && dims == 3 && options.getQuantizeNormals() ) {
+			quantized.emplace_back( count * 2 * sizeof( int16_t ) );
+			int16_t *dst = reinterpret_cast<int16_t*>( quantized.back().data() );
+			for( size_t i = 0; i < count; ++i )
+				encodeOctahedral( reinterpret_cast<const vec3*>( data )[i], dst + i * 2 );
+			addBlock( mask, dims, FORMAT_OCT16, count, quantized.back().data(), quantized.back().size(), 0, options.getCompressVertices() );
+			return;
+		}
+		if( isTexCoord && options.getQuantizeTexCoords() ) {
+			quantized.emplace_back();
+			if( encodeUnorm16( data, count, dims, &quantized.back() ) ) {
+				addBlock( mask, dims, FORMAT_UNORM16, count, quantized.back().data(), quantized.back().size(), V3_RANGE_SIZE, options.getCompressVertices() );
+				return;
+			}
+		}
+		addBlock( mask, dims, FORMAT_FLOAT32, count, reinterpret_cast<const uint8_t*>( data ), count * dims * sizeof( float ), 0, options.getCompressVertices() );
+	};
+
+	if( ! mIndices.empty() )
+		addBlock( V3_INDICES, 1, FORMAT_UINT32, mIndices.size(), reinterpret_cast<const uint8_t*>( mIndices.data() ), mIndices.size() * sizeof( uint32_t ), 0, options.getCompressIndices() );
+
+	addAttrib( geom::POSITION, mPositionsDims, mPositions.size(), mPositions.data() );
+	addAttrib( geom::COLOR, mColorsDims, mColors.size(), mColors.data() );
+	addAttrib( geom::NORMAL, mNormalsDims, mNormals.size() * 3, (const float*)mNormals.data() );
+	addAttrib( geom::TEX_COORD_0, mTexCoords0Dims, mTexCoords0.size(), mTexCoords0.data() );
+	addAttrib( geom::TEX_COORD_1, mTexCoords1Dims, mTexCoords1.size(), mTexCoords1.data() );
+	addAttrib( geom::TEX_COORD_2, mTexCoords2Dims, mTexCoords2.size(), mTexCoords2.data() );
+	addAttrib( geom::TEX_COORD_3, mTexCoords3Dims, mTexCoords3.size(), mTexCoords3.data() );
+	addAttrib( geom::TANGENT, mTangentsDims, mTangents.size() * 3, (const float*)mTangents.data() );
+	addAttrib( geom::BITANGENT, mBitangentsDims, mBitangents.size() * 3, (const float*)mBitangents.data() );
+
+	// lay out the blocks after the table
+	auto align = []( uint64_t offset ) { return ( offset + V3_ALIGNMENT - 1 ) & ~uint64_t( V3_ALIGNMENT - 1 ); };
+	uint64_t offset = V3_HEADER_SIZE + blocks.size() * sizeof( BlockDesc );
+	for( auto &block : blocks ) {
+		offset = align( offset );
+		block.mDesc.mOffset = offset;
+		offset += block.mDesc.mSize;
+	}
+
+	uint8_t header[V3_HEADER_SIZE] = { 3, V3_MAGIC[0], V3_MAGIC[1], V3_MAGIC[2] };
+	const uint32_t numBlocks = (uint32_t)blocks.size();
+	const uint64_t fileSize = offset;
+	memcpy( header + 4, &numBlocks, sizeof( numBlocks ) );
+	memcpy( header + 8, &fileSize, sizeof( fileSize ) );
+
+	OStreamRef out = dataTarget->getStream();
+	out->writeData( header, V3_HEADER_SIZE );
+	for( const auto &block : blocks )
+		out->writeData( &block.mDesc, sizeof( BlockDesc ) );
+
+	const uint8_t padding[V3_ALIGNMENT] = {};
+	offset = V3_HEADER_SIZE + blocks.size() * sizeof( BlockDesc );
+	for( const auto &block : blocks ) {
+		if( block.mDesc.mOffset > offset )
+			out->writeData( padding, size_t( block.mDesc.mOffset - offset ) );
+		if( block.mDesc.mSize )
+			out->writeData( block.mData, (size_t)block.mDesc.mSize );
+		offset = block.mDesc.mOffset + block.mDesc.mSize;
+	}
+}
+
+// used since 0.9.3
+void TriMesh::readImplV3( const DataSourceRef &dataSource )
+{
+	TriMeshView view( dataSource );
+	initFromFormat( formatFromSource( view ) );
+	loadFromSource( view );
+}
+
 // used in 0.9.0
 void TriMesh::readImplV2( const IStreamRef &in )
 {
@@ -631,84 +1252,31 @@ void TriMesh::readImplV1( const IStreamRef &in )
 	mTexCoords0Dims = 2;
 }
 
-bool TriMesh::recalculateNormals( bool smooth, bool weighted )
+bool TriMesh::recalculateNormals( bool smooth, bool weighted, float weldTolerance )
 {
 	// requires valid indices and 3D vertices
 	if( mIndices.empty() || mPositions.empty() || mPositionsDims != 3 )
 		return false;
 
-	size_t numPositions = mPositions.size() / 3;
-	mNormals.assign( numPositions, vec3() );
-
-	// for smooth renormalization, we first find all unique vertices and keep track of them
-	std::vector<uint32_t> uniquePositions;
-	if( smooth ) {
-		uniquePositions.assign( numPositions, 0 );
-
-		for( uint32_t i = 0; i < numPositions; ++i ) {
-			if( uniquePositions[i] == 0 ) {
-				uniquePositions[i] = i + 1;
-				const vec3 &v0 = *(const vec3*)(&mPositions[i * 3]);
-				for( size_t j = i + 1; j < numPositions; ++j ) {
-					const vec3 &v1 = *(const vec3*)(&mPositions[j * 3]);
-					if( length2( v1 - v0 ) < FLT_EPSILON )
-						uniquePositions[j] = uniquePositions[i];
-				}
-			}
-		}
-	}
-
-	// perform surface normalization
-	uint32_t index0, index1, index2;
-	size_t numTriangles = getNumTriangles();
-	for( size_t i = 0; i < numTriangles; ++i ) {
-		if( smooth ) {
-			index0 = uniquePositions[mIndices[i * 3 + 0]] - 1;
-			index1 = uniquePositions[mIndices[i * 3 + 1]] - 1;
-			index2 = uniquePositions[mIndices[i * 3 + 2]] - 1;
-		}
-		else {
-			index0 = mIndices[i*3+0];
-			index1 = mIndices[i*3+1];
-			index2 = mIndices[i*3+2];
-		}
-
-		const vec3 &v0 = *(const vec3*)(&mPositions[index0 * 3]);
-		const vec3 &v1 = *(const vec3*)(&mPositions[index1 * 3]);
-		const vec3 &v2 = *(const vec3*)(&mPositions[index2 * 3]);
-
-		vec3 e0 = v1 - v0;
-		vec3 e1 = v2 - v0;
-		vec3 e2 = v2 - v1;
-
-		if( length2( e0 ) < FLT_EPSILON )
-			continue;
-		if( length2( e1 ) < FLT_EPSILON )
-			continue;
-		if( length2( e2 ) < FLT_EPSILON )
-			continue;
-
-		vec3 normal = cross( e0, e1 );
-
-		// if not weighted, every normal has an equal contribution
-		if( ! weighted )
-			normal = normalize( normal );
+	const size_t numPositions = mPositions.size() / 3;
+	const vec3 *positions = reinterpret_cast<const vec3*>( mPositions.data() );
 
-		mNormals[ index0 ] += normal;
-		mNormals[ index1 ] += normal;
-		mNormals[ index2 ] += normal;
+	if( ! smooth ) {
+		geom::calculateNormals( mIndices.size(), mIndices.data(), numPositions, positions, weighted, &mNormals );
 	}
+	else {
+		// for smooth renormalization, we calculate normals as if all vertices sharing a position were welded,
+		// then copy the normal of each unique vertex to its duplicates
+		const vector<uint32_t> uniquePositions = calcWeldMap( mPositions.data(), 3, numPositions, weldTolerance, []( uint32_t, uint32_t ) { return true; } );
 
-	// now normalize the summed normals
-	for( auto &normal : mNormals ) {
-		normal = normalize( normal );
-	}
+		vector<uint32_t> indices( mIndices.size() );
+		for( size_t i = 0; i < mIndices.size(); ++i )
+			indices[i] = uniquePositions[mIndices[i]];
 
-	// copy normals to corresponding non-unique vertices
-	if( smooth ) {
-		for( size_t i = 0; i < numPositions; ++i ) {
-			mNormals[i] = mNormals[uniquePositions[i]-1];
-		}
+		geom::calculateNormals( indices.size(), indices.data(), numPositions, positions, weighted, &mNormals );
+
+		for( size_t i = 0; i < numPositions; ++i )
+			mNormals[i] = mNormals[uniquePositions[i]];
 	}
 
 	mNormalsDims = 3;
@@ -743,17 +1311,155 @@ bool TriMesh::recalculateBitangents()
 	if( ! ( hasTangents() || recalculateTangents() ) )
 		return false;
 
-	mBitangents.assign( mNormals.size(), vec3() );
+	mBitangents.resize( mNormals.size() );
 
-	size_t n = getNumVertices();
-	for( size_t i = 0; i < n; ++i )
-		mBitangents[i] = normalize( cross( mNormals[i], mTangents[i] ) );
+	parallelFor( 0, getNumVertices(), 16384, [this]( size_t begin, size_t end ) {
+		for( size_t i = begin; i < end; ++i )
+			mBitangents[i] = normalize( cross( mNormals[i], mTangents[i] ) );
+	} );
 
 	mBitangentsDims = 3;
 
 	return true;
 }
 
+size_t TriMesh::weld( float tolerance )
+{
+	if( mPositions.empty() || mPositionsDims == 0 )
+		return 0;
+
+	return removeVertices( calcWeldMap( mPositions.data(), mPositionsDims, getNumVertices(), tolerance, []( uint32_t, uint32_t ) { return true; } ) );
+}
+
+size_t TriMesh::removeDuplicateVertices()
+{
+	if( mPositions.empty() || mPositionsDims == 0 )
+		return 0;
+
+	// verticesEqual() accepts positions within sqrt(FLT_EPSILON) of each other, which is the default weld tolerance
+	auto equalFn = [this]( uint32_t a, uint32_t b ) { return verticesEqual( a, b ); };
+	return removeVertices( calcWeldMap( mPositions.data(), mPositionsDims, getNumVertices(), DEFAULT_WELD_TOLERANCE, equalFn ) );
+}
+
+size_t TriMesh::removeVertices( const std::vector<uint32_t> &weldMap )
+{
+	const size_t numVertices = weldMap.size();
+
+	// unique vertices keep their relative order
+	vector<uint32_t> newIndices( numVertices );
+	uint32_t numUnique = 0;
+	for( size_t i = 0; i < numVertices; ++i )
+		newIndices[i] = ( weldMap[i] == i ) ? numUnique++ : newIndices[weldMap[i]];
+
+	if( numUnique == numVertices )
+		return 0;
+
+	auto compact = [&]( float *data, size_t size, uint8_t dims ) {
+		if( size == 0 || dims == 0 )
+			return;
+		for( size_t i = 0; i < numVertices; ++i ) {
+			if( weldMap[i] == i && newIndices[i] != i )
+				std::copy( data + i * dims, data + ( i + 1 ) * dims, data + newIndices[i] * dims );
+		}
+	};
+
+	compact( mPositions.data(), mPositions.size(), mPositionsDims );
+	compact( mColors.data(), mColors.size(), mColorsDims );
+	compact( (float*)mNormals.data(), mNormals.size(), 3 );
+	compact( (float*)mTangents.data(), mTangents.size(), 3 );
+	compact( (float*)mBitangents.data(), mBitangents.size(), 3 );
+	compact( mTexCoords0.data(), mTexCoords0.size(), mTexCoords0Dims );
+	compact( mTexCoords1.data(), mTexCoords1.size(), mTexCoords1Dims );
+	compact( mTexCoords2.data(), mTexCoords2.size(), mTexCoords2Dims );
+	compact( mTexCoords3.data(), mTexCoords3.size(), mTexCoords3Dims );
+
+	mPositions.resize( numUnique * mPositionsDims );
+	if( ! mColors.empty() ) mColors.resize( numUnique * mColorsDims );
+	if( ! mNormals.empty() ) mNormals.resize( numUnique );
+	if( ! mTangents.empty() ) mTangents.resize( numUnique );
+	if( ! mBitangents.empty() ) mBitangents.resize( numUnique );
+	if( ! mTexCoords0.empty() ) mTexCoords0.resize( numUnique * mTexCoords0Dims );
+	if( ! mTexCoords1.empty() ) mTexCoords1.resize( numUnique * mTexCoords1Dims );
+	if( ! mTexCoords2.empty() ) mTexCoords2.resize( numUnique * mTexCoords2Dims );
+	if( ! mTexCoords3.empty() ) mTexCoords3.resize( numUnique * mTexCoords3Dims );
+
+	for( auto &index : mIndices )
+		index = newIndices[index];
+
+	return numVertices - numUnique;
+}
+
+void TriMesh::remapVertices( const std::vector<uint32_t> &remap, size_t numVertices )
+{
+	remapAttrib( remap, numVertices, mPositionsDims, &mPositions );
+	remapAttrib( remap, numVertices, mColorsDims, &mColors );
+	remapAttrib( remap, numVertices, 1, &mNormals );
+	remapAttrib( remap, numVertices, 1, &mTangents );
+	remapAttrib( remap, numVertices, 1, &mBitangents );
+	remapAttrib( remap, numVertices, mTexCoords0Dims, &mTexCoords0 );
+	remapAttrib( remap, numVertices, mTexCoords1Dims, &mTexCoords1 );
+	remapAttrib( remap, numVertices, mTexCoords2Dims, &mTexCoords2 );
+	remapAttrib( remap, numVertices, mTexCoords3Dims, &mTexCoords3 );
+
+	for( auto &index : mIndices )
+		index = remap[index];
+}
+
+void TriMesh::optimizeVertexCache( size_t cacheSize )
+{
+	geom::optimizeVertexCache( mIndices.size(), mIndices.data(), getNumVertices(), cacheSize );
+}
+
+void TriMesh::optimizeOverdraw( float threshold, size_t cacheSize )
+{
+	if( mPositionsDims != 3 )
+		return;
+
+	geom::optimizeOverdraw( mIndices.size(), mIndices.data(), getNumVertices(), reinterpret_cast<const vec3*>( mPositions.data() ), threshold, cacheSize );
+}
+
+size_t TriMesh::optimizeVertexFetch()
+{
+	const size_t numVertices = getNumVertices();
+	vector<uint32_t> remap;
+	const size_t numUsed = geom::calculateVertexFetchRemap( mIndices.size(), mIndices.data(), numVertices, &remap );
+	remapVertices( remap, numUsed );
+
+	return numVertices - numUsed;
+}
+
+size_t TriMesh::simplify( size_t targetNumTriangles, float maxError, float *resultError )
+{
+	if( resultError )
+		*resultError = 0;
+	if( mPositionsDims != 3 || mIndices.size() <= targetNumTriangles * 3 )
+		return 0;
+
+	const size_t numTriangles = getNumTriangles();
+	const size_t numVertices = getNumVertices();
+	vector<uint32_t> indices;
+	geom::simplify( mIndices.size(), mIndices.data(), numVertices, reinterpret_cast<const vec3*>( mPositions.data() ), targetNumTriangles * 3, maxError, &indices, resultError );
+	mIndices.swap( indices );
+
+	// remove the vertices no longer used, keeping the order of the rest
+	vector<uint32_t> remap( numVertices, ~0u );
+	for( auto index : mIndices )
+		remap[index] = 0;
+	uint32_t numUsed = 0;
+	for( auto &index : remap ) {
+		if( index == 0 )
+			index = numUsed++;
+	}
+	remapVertices( remap, numUsed );
+
+	return numTriangles - getNumTriangles();
+}
+
+geom::VertexCacheStatistics TriMesh::calcVertexCacheStatistics( size_t cacheSize ) const
+{
+	return geom::calculateVertexCacheStatistics( mIndices.size(), mIndices.data(), getNumVertices(), cacheSize );
+}
+
 //! TODO: optimize memory allocations
 void TriMesh::subdivide( int division, bool normalize )
 {
@@ -1105,137 +1811,30 @@ bool TriMesh::verticesEqual( uint32_t indexA, uint32_t indexB ) const
 			return false;
 	}
 
-	// positions
-	{
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mPositions[indexA*mPositionsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mPositions[indexB*mPositionsDims]);
-		if( distance2( a, b ) > FLT_EPSILON)
-			return false;
-	}
-
-	if( mColorsDims > 0 ) {
-		if( mColorsDims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mColors[indexA*mColorsDims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mColors[indexB*mColorsDims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mColorsDims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mColors[indexA*mColorsDims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mColors[indexB*mColorsDims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mNormalsDims > 0 ) {
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mNormals[indexA*mNormalsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mNormals[indexB*mNormalsDims]);
-		if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-	}
-
-	if( mTexCoords0Dims > 0 ) {
-		if( mTexCoords0Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords0[indexA*mTexCoords0Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords0[indexB*mTexCoords0Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords0Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords0[indexA*mTexCoords0Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords0[indexB*mTexCoords0Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords0Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords0[indexA*mTexCoords0Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords0[indexB*mTexCoords0Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mTexCoords1Dims > 0 ) {
-		if( mTexCoords1Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords1[indexA*mTexCoords1Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords1[indexB*mTexCoords1Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords1Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords1[indexA*mTexCoords1Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords1[indexB*mTexCoords1Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords1Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords1[indexA*mTexCoords1Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords1[indexB*mTexCoords1Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
-
-	if( mTexCoords2Dims > 0 ) {
-		if( mTexCoords2Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords2[indexA*mTexCoords2Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords2[indexB*mTexCoords2Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords2Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords2[indexA*mTexCoords2Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords2[indexB*mTexCoords2Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords2Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords2[indexA*mTexCoords2Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords2[indexB*mTexCoords2Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
+	// compares the attribute at both indices if the attribute is present
+	auto attribEqual = [indexA, indexB]( const float *data, size_t size, uint8_t dims ) {
+		if( size == 0 || dims == 0 )
+			return true;
 
-	if( mTexCoords3Dims > 0 ) {
-		if( mTexCoords3Dims == 2 ) {
-			const vec2 &a = *reinterpret_cast<const vec2*>(&mTexCoords3[indexA*mTexCoords3Dims]);
-			const vec2 &b = *reinterpret_cast<const vec2*>(&mTexCoords3[indexB*mTexCoords3Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords3Dims == 3 ) {
-			const vec3 &a = *reinterpret_cast<const vec3*>(&mTexCoords3[indexA*mTexCoords3Dims]);
-			const vec3 &b = *reinterpret_cast<const vec3*>(&mTexCoords3[indexB*mTexCoords3Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-		else if( mTexCoords3Dims == 4 ) {
-			const vec4 &a = *reinterpret_cast<const vec4*>(&mTexCoords3[indexA*mTexCoords3Dims]);
-			const vec4 &b = *reinterpret_cast<const vec4*>(&mTexCoords3[indexB*mTexCoords3Dims]);
-			if( distance2( a, b ) > FLT_EPSILON )
-			return false;
-		}
-	}
+		const float *a = data + indexA * dims;
+		const float *b = data + indexB * dims;
+		float dist2 = 0;
+		for( uint8_t d = 0; d < dims; ++d )
+			dist2 += ( a[d] - b[d] ) * ( a[d] - b[d] );
 
-	if( mTangentsDims > 0 ) {
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mTangents[indexA*mTangentsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mTangents[indexB*mTangentsDims]);
-		if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-	}
-
-	if( mBitangentsDims > 0 ) {
-		const vec3 &a = *reinterpret_cast<const vec3*>(&mBitangents[indexA*mBitangentsDims]);
-		const vec3 &b = *reinterpret_cast<const vec3*>(&mBitangents[indexB*mBitangentsDims]);
-		if( distance2( a, b ) > FLT_EPSILON )
-		return false;
-	}
+		return dist2 <= FLT_EPSILON;
+	};
 
 	// TODO: bone index and weight
-
-	return true;
+	return attribEqual( mPositions.data(), mPositions.size(), mPositionsDims )
+		&& attribEqual( mColors.data(), mColors.size(), mColorsDims )
+		&& attribEqual( (const float*)mNormals.data(), mNormals.size(), 3 )
+		&& attribEqual( mTexCoords0.data(), mTexCoords0.size(), mTexCoords0Dims )
+		&& attribEqual( mTexCoords1.data(), mTexCoords1.size(), mTexCoords1Dims )
+		&& attribEqual( mTexCoords2.data(), mTexCoords2.size(), mTexCoords2Dims )
+		&& attribEqual( mTexCoords3.data(), mTexCoords3.size(), mTexCoords3Dims )
+		&& attribEqual( (const float*)mTangents.data(), mTangents.size(), 3 )
+		&& attribEqual( (const float*)mBitangents.data(), mBitangents.size(), 3 );
 }
 
 uint32_t TriMesh::toMask( geom::Attrib attrib )
@@ -1298,4 +1897,162 @@ geom::Attrib TriMesh::fromMask( uint32_t attrib )
 	}
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// TriMesh::WriteOptions
+TriMesh::WriteOptions::WriteOptions()
+	: mVersion( 3 ), mAttribMask( ~0u ), mQuantizeNormals( false ), mQuantizeTexCoords( false ), mCompressIndices( false ), mCompressVertices( false )
+{
+}
+
+TriMesh::WriteOptions& TriMesh::WriteOptions::attribs( const std::set<geom::Attrib> &attribs )
+{
+	mAttribMask = 0;
+	for( auto &attrib : attribs )
+		mAttribMask |= toMask( attrib );
+	return *this;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// TriMeshView
+TriMeshView::TriMeshView( const DataSourceRef &dataSource )
+{
+	size_t size = 0;
+	if( dataSource->isFilePath() )
+		mStorage = mapFile( dataSource->getFilePath(), &size );
+
+	if( mStorage ) {
+		init( static_cast<const uint8_t*>( mStorage.get() ), size );
+	}
+	else {
+		BufferRef buffer = dataSource->getBuffer();
+		mStorage = buffer;
+		init( static_cast<const uint8_t*>( buffer->getData() ), buffer->getSize() );
+	}
+}
+
+TriMeshView::TriMeshView( const BufferRef &buffer )
+	: mStorage( buffer )
+{
+	init( static_cast<const uint8_t*>( buffer->getData() ), buffer->getSize() );
+}
+
+TriMeshView::TriMeshView( const void *data, size_t size )
+{
+	init( static_cast<const uint8_t*>( data ), size );
+}
+
+void TriMeshView::init( const uint8_t *data, size_t size )
+{
+	mNumVertices = mNumIndices = 0;
+	mIndices = nullptr;
+
+	if( size < V3_HEADER_SIZE || data[0] != 3 || memcmp( data + 1, V3_MAGIC, sizeof( V3_MAGIC ) ) != 0 )
+		throw Exception( "TriMeshView error: not a version 3 TriMesh file" );
+
+	uint32_t numBlocks;
+	uint64_t fileSize;
+	memcpy( &numBlocks, data + 4, sizeof( numBlocks ) );
+	memcpy( &fileSize, data + 8, sizeof( fileSize ) );
+	if( fileSize > size || numBlocks > ( size - V3_HEADER_SIZE ) / sizeof( BlockDesc ) )
+		throw Exception( "TriMeshView error: file is truncated" );
+
+	bool hasVertices = false;
+	for( uint32_t b = 0; b < numBlocks; ++b ) {
+		BlockDesc desc;
+		memcpy( &desc, data + V3_HEADER_SIZE + b * sizeof( BlockDesc ), sizeof( BlockDesc ) );
+		const size_t elementSize = calcElementSize( desc.mFormat, desc.mDims );
+		if( desc.mOffset > size || desc.mSize > size - desc.mOffset || elementSize == 0 || ! isBlockSizeValid( desc, elementSize ) )
+			throw Exception( "TriMeshView error: invalid block " + to_string( b ) );
+
+		if( desc.mAttrib != V3_INDICES && ( ( desc.mAttrib & ( desc.mAttrib - 1 ) ) != 0 || ( desc.mAttrib & V3_ATTRIB_MASKS ) == 0 ) )
+			throw Exception( "TriMeshView error: invalid attribute in block " + to_string( b ) );
+
+		// blocks written by TriMesh are aligned, but one that isn't, in the file or in memory, is copied rather than used in place
+		const uint8_t *block = data + desc.mOffset;
+		const bool aligned = ( reinterpret_cast<uintptr_t>( block ) % sizeof( float ) ) == 0;
+		const bool inPlace = aligned && desc.mCompression == COMPRESSION_NONE && desc.mSize >= uint64_t( desc.mCount ) * elementSize;
+		if( desc.mAttrib == V3_INDICES ) {
+			if( desc.mFormat != FORMAT_UINT32 )
+				throw Exception( "TriMeshView error: invalid index block" );
+
+			mNumIndices = desc.mCount;
+			if( inPlace ) {
+				mIndices = reinterpret_cast<const uint32_t*>( block );
+			}
+			else {
+				auto decoded = make_shared<vector<uint32_t>>( desc.mCount );
+				if( ! decodeBlock( desc, block, decoded->data() ) )
+					throw Exception( "TriMeshView error: invalid index block" );
+				mIndices = decoded->data();
+				mDecodedIndices = decoded;
+			}
+		}
+		else {
+			const geom::Attrib attrib = TriMesh::fromMask( desc.mAttrib );
+			if( desc.mFormat == FORMAT_UINT32 || ( hasVertices && desc.mCount != mNumVertices ) )
+				throw Exception( "TriMeshView error: invalid block for attribute " + geom::attribToString( attrib ) );
+
+			mNumVertices = desc.mCount;
+			hasVertices = true;
+
+			AttribData &attribData = mAttribs[attrib];
+			attribData.mDims = desc.mDims;
+			if( inPlace && desc.mFormat == FORMAT_FLOAT32 ) {
+				attribData.mData = reinterpret_cast<const float*>( block );
+			}
+			else {
+				auto decoded = make_shared<vector<float>>( size_t( desc.mCount ) * desc.mDims );
+				if( ! decodeBlock( desc, block, decoded->data() ) )
+					throw Exception( "TriMeshView error: invalid block for attribute " + geom::attribToString( attrib ) );
+				attribData.mData = decoded->data();
+				attribData.mDecoded = decoded;
+			}
+		}
+	}
+
+	// the indices are passed on to geom::Targets unchecked, so must not refer past the vertices
+	for( size_t i = 0; i < mNumIndices; ++i ) {
+		if( mIndices[i] >= mNumVertices )
+			throw Exception( "TriMeshView error: index " + to_string( i ) + " is out of range" );
+	}
+}
+
+uint8_t TriMeshView::getAttribDims( geom::Attrib attr ) const
+{
+	auto it = mAttribs.find( attr );
+	return ( it != mAttribs.end() ) ? it->second.mDims : 0;
+}
+
+geom::AttribSet TriMeshView::getAvailableAttribs() const
+{
+	geom::AttribSet result;
+	for( const auto &attrib : mAttribs )
+		result.insert( attrib.first );
+
+	return result;
+}
+
+const float* TriMeshView::getAttribData( geom::Attrib attr ) const
+{
+	auto it = mAttribs.find( attr );
+	return ( it != mAttribs.end() ) ? it->second.mData : nullptr;
+}
+
+bool TriMeshView::isAttribMapped( geom::Attrib attr ) const
+{
+	auto it = mAttribs.find( attr );
+	return it != mAttribs.end() && ! it->second.mDecoded;
+}
+
+void TriMeshView::loadInto( geom::Target *target, const geom::AttribSet &requestedAttribs ) const
+{
+	for( const auto &attrib : mAttribs ) {
+		if( requestedAttribs.count( attrib.first ) )
+			target->copyAttrib( attrib.first, attrib.second.mDims, 0, attrib.second.mData, mNumVertices );
+	}
+
+	if( mNumIndices )
+		target->copyIndices( geom::Primitive::TRIANGLES, mIndices, mNumIndices, 4 /* bytes per index */ );
+}
+
 } // namespace cinder
@@ -22,24 +22,161 @@
 
 #include "cinder/Triangulate.h"
 #include "cinder/Shape2d.h"
+#include "cinder/Thread.h"
 #include "../libtess2/tesselator.h"
 
+#include <algorithm>
+#include <cstring>
+#include <new>
+
 using namespace std;
 
 namespace cinder {
 
-void* stdAlloc( void* userData, unsigned int size )
+namespace {
+
+// Contours with more vertices than this always go through libtess2; ear clipping is quadratic in the worst case
+const size_t MAX_EAR_CLIPPING_VERTICES = 256;
+// Initial size of the memory blocks libtess2 allocates from
+const size_t ARENA_BLOCK_SIZE = 256 * 1024;
+
+inline double orient( const vec2 &a, const vec2 &b, const vec2 &c )
+{
+	return ( (double)b.x - a.x ) * ( (double)c.y - a.y ) - ( (double)b.y - a.y ) * ( (double)c.x - a.x );
+}
+
+// Assumes \a p is collinear with \a a and \a b
+inline bool onSegment( const vec2 &a, const vec2 &b, const vec2 &p )
 {
-	int *allocated = (int*)userData;
-	*allocated += (int)size;
-	return malloc( size );
+	return p.x >= std::min( a.x, b.x ) && p.x <= std::max( a.x, b.x ) && p.y >= std::min( a.y, b.y ) && p.y <= std::max( a.y, b.y );
 }
 
-void stdFree( void* /*userData*/, void* ptr )
+// Returns true if the segments share any point, including their endpoints
+bool segmentsTouch( const vec2 &a, const vec2 &b, const vec2 &c, const vec2 &d )
 {
-	free( ptr );
+	const double d1 = orient( c, d, a ), d2 = orient( c, d, b ), d3 = orient( a, b, c ), d4 = orient( a, b, d );
+	if( ( ( d1 > 0 && d2 < 0 ) || ( d1 < 0 && d2 > 0 ) ) && ( ( d3 > 0 && d4 < 0 ) || ( d3 < 0 && d4 > 0 ) ) )
+		return true;
+
+	return ( d1 == 0 && onSegment( c, d, a ) ) || ( d2 == 0 && onSegment( c, d, b ) ) || ( d3 == 0 && onSegment( a, b, c ) ) || ( d4 == 0 && onSegment( a, b, d ) );
 }
 
+} // anonymous namespace
+
+//! Bump allocator backing libtess2. Freeing is a no-op; reset() recycles everything at once, coalescing the blocks so that the high water mark fits in one.
+struct Triangulator::Arena {
+	static const size_t HEADER_SIZE = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+	Arena()
+		: mCurrent( 0 ), mOffset( 0 ), mLast( nullptr )
+	{
+		mBlocks.push_back( Block( ARENA_BLOCK_SIZE ) );
+	}
+
+	void* alloc( size_t size )
+	{
+		const size_t required = HEADER_SIZE + roundUp( size );
+		if( mOffset + required > mBlocks[mCurrent].mSize ) {
+			for( ++mCurrent; mCurrent < mBlocks.size() && mBlocks[mCurrent].mSize < required; ++mCurrent )
+				;
+			if( mCurrent == mBlocks.size() ) {
+				mBlocks.push_back( Block( std::max( ARENA_BLOCK_SIZE, required ) ) );
+				if( ! mBlocks.back().mData ) {
+					mBlocks.pop_back();
+					mCurrent = mBlocks.size() - 1;
+					mOffset = mBlocks[mCurrent].mSize;
+					mLast = nullptr;
+					return nullptr;
+				}
+			}
+			mOffset = 0;
+		}
+
+		uint8_t *result = mBlocks[mCurrent].mData.get() + mOffset + HEADER_SIZE;
+		*reinterpret_cast<size_t*>( result - HEADER_SIZE ) = size;
+		mOffset += required;
+		mLast = result;
+		return result;
+	}
+
+	void* realloc( void *ptr, size_t size )
+	{
+		if( ! ptr )
+			return alloc( size );
+
+		uint8_t *bytes = static_cast<uint8_t*>( ptr );
+		size_t &oldSize = *reinterpret_cast<size_t*>( bytes - HEADER_SIZE );
+		// the most recent allocation can grow in place
+		if( bytes == mLast ) {
+			const size_t start = bytes - mBlocks[mCurrent].mData.get();
+			if( start + roundUp( size ) <= mBlocks[mCurrent].mSize ) {
+				oldSize = size;
+				mOffset = start + roundUp( size );
+				return ptr;
+			}
+		}
+
+		void *result = alloc( size );
+		if( result )
+			memcpy( result, ptr, std::min( oldSize, size ) );
+		return result;
+	}
+
+	void reset()
+	{
+		if( mBlocks.size() > 1 ) {
+			size_t total = 0;
+			for( const auto &block : mBlocks )
+				total += block.mSize;
+			mBlocks.clear();
+			mBlocks.push_back( Block( total ) );
+			if( ! mBlocks.back().mData )
+				mBlocks.back() = Block( ARENA_BLOCK_SIZE );
+		}
+		mCurrent = 0;
+		mOffset = 0;
+		mLast = nullptr;
+	}
+
+	//! Recycles the arena and returns a fresh tessellator allocated from it, or \c nullptr on failure
+	TESStesselator* createTess()
+	{
+		reset();
+
+		TESSalloc ma;
+		memset( &ma, 0, sizeof(ma) );
+		ma.memalloc = tessAlloc;
+		ma.memrealloc = tessRealloc;
+		ma.memfree = tessFree;
+		ma.userData = this;
+		return tessNewTess( &ma );
+	}
+
+	static void* tessAlloc( void *userData, unsigned int size )				{ return static_cast<Arena*>( userData )->alloc( size ); }
+	static void* tessRealloc( void *userData, void *ptr, unsigned int size )	{ return static_cast<Arena*>( userData )->realloc( ptr, size ); }
+	static void  tessFree( void * /*userData*/, void * /*ptr*/ )				{}
+
+	static size_t roundUp( size_t size )	{ return ( size + HEADER_SIZE - 1 ) / HEADER_SIZE * HEADER_SIZE; }
+
+	struct Block {
+		Block( size_t size )
+			: mData( new (std::nothrow) uint8_t[size] ), mSize( mData ? size : 0 )
+		{}
+
+		std::unique_ptr<uint8_t[]>	mData;
+		size_t						mSize;
+	};
+
+	std::vector<Block>	mBlocks;
+	size_t				mCurrent, mOffset;
+	uint8_t				*mLast;
+
+	// scratch space reused across tesselations
+	std::vector<vec2>		mContour, mPositions;
+	std::vector<uint32_t>	mPrev, mNext, mEdges, mIndices;
+	std::vector<uint8_t>	mConvex;
+};
+
 Triangulator::Triangulator( const Path2d &path, float approximationScale )
 {	
 	allocate();
@@ -65,18 +202,7 @@ Triangulator::Triangulator()
 
 void Triangulator::allocate()
 {
-	mAllocated = 0;
-	
-	TESSalloc ma;
-	memset( &ma, 0, sizeof(ma) );
-	ma.memalloc = stdAlloc;
-	ma.memfree = stdFree;
-	ma.userData = (void*)&mAllocated;
-	ma.extraVertices = 2560; // realloc not provided, allow 256 extra vertices.
-
-	mTess = shared_ptr<TESStesselator>( tessNewTess( &ma ), tessDeleteTess );
-	if( ! mTess )
-		throw Triangulator::Exception();
+	mArena = make_shared<Arena>();
 }
 
 void Triangulator::addShape( const Shape2d &shape, float approximationScale )
@@ -89,29 +215,40 @@ void Triangulator::addShape( const Shape2d &shape, float approximationScale )
 
 void Triangulator::addPath( const Path2d &path, float approximationScale )
 {
-	vector<vec2> subdivided = path.subdivide( approximationScale );
-	tessAddContour( mTess.get(), 2, &subdivided[0], sizeof(float) * 2, (int)subdivided.size() );
+	path.subdivide( &mPoints, nullptr, approximationScale );
+	if( mPoints.size() > ( mContourEnds.empty() ? 0 : mContourEnds.back() ) )
+		mContourEnds.push_back( mPoints.size() );
 }
 
 void Triangulator::addPolyLine( const PolyLine2f &polyLine )
 {
 	if( polyLine.size() > 0 )
-		tessAddContour( mTess.get(), 2, &polyLine.getPoints()[0], sizeof(float) * 2, (int)polyLine.size() );
+		addPolyLine( polyLine.getPoints().data(), polyLine.size() );
 }
 
 void Triangulator::addPolyLine( const vec2 *points, size_t numPoints )
 {
-	if( numPoints > 0 )
-		tessAddContour( mTess.get(), 2, &points, sizeof(vec2), (int)numPoints );
+	if( numPoints > 0 ) {
+		mPoints.insert( mPoints.end(), points, points + numPoints );
+		mContourEnds.push_back( mPoints.size() );
+	}
+}
+
+void Triangulator::clear()
+{
+	mPoints.clear();
+	mContourEnds.clear();
 }
 
 TriMesh Triangulator::calcMesh( Winding winding )
 {
 	TriMesh result( TriMesh::Format().positions( 2 ) );
 	
-	tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 );
-	result.appendPositions( (vec2*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
-	result.appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
+	mArena->mPositions.clear();
+	mArena->mIndices.clear();
+	tesselate( winding, &mArena->mPositions, &mArena->mIndices );
+	result.appendPositions( mArena->mPositions.data(), mArena->mPositions.size() );
+	result.appendIndices( mArena->mIndices.data(), mArena->mIndices.size() );
 	
 	return result;
 }
@@ -120,11 +257,214 @@ TriMeshRef Triangulator::createMesh( Winding winding )
 {
 	TriMeshRef result = make_shared<TriMesh>( TriMesh::Format().positions( 2 ) );
 	
-	tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 );
-	result->appendPositions( (vec2*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
-	result->appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
+	mArena->mPositions.clear();
+	mArena->mIndices.clear();
+	tesselate( winding, &mArena->mPositions, &mArena->mIndices );
+	result->appendPositions( mArena->mPositions.data(), mArena->mPositions.size() );
+	result->appendIndices( mArena->mIndices.data(), mArena->mIndices.size() );
 	
 	return result;
 }
 
+TriMesh Triangulator::calcMesh( const std::vector<Shape2d> &shapes, float approximationScale, Winding winding )
+{
+	// shapes are split into one contiguous chunk per thread so that the results can be concatenated in order
+	struct Chunk {
+		vector<vec2>		mPositions;
+		vector<uint32_t>	mIndices;
+	};
+
+	const size_t numChunks = std::min( shapes.size(), getNumParallelThreads() );
+	vector<Chunk> chunks( numChunks );
+	parallelFor( 0, numChunks, 1, [&]( size_t chunkBegin, size_t chunkEnd ) {
+		Triangulator triangulator;
+		for( size_t c = chunkBegin; c < chunkEnd; ++c ) {
+			const size_t shapesEnd = ( c + 1 ) * shapes.size() / numChunks;
+			for( size_t s = c * shapes.size() / numChunks; s < shapesEnd; ++s ) {
+				triangulator.addShape( shapes[s], approximationScale );
+				triangulator.tesselate( winding, &chunks[c].mPositions, &chunks[c].mIndices );
+			}
+		}
+	} );
+
+	TriMesh result( TriMesh::Format().positions( 2 ) );
+	uint32_t offset = 0;
+	for( auto &chunk : chunks ) {
+		for( auto &index : chunk.mIndices )
+			index += offset;
+		result.appendPositions( chunk.mPositions.data(), chunk.mPositions.size() );
+		result.appendIndices( chunk.mIndices.data(), chunk.mIndices.size() );
+		offset += (uint32_t)chunk.mPositions.size();
+	}
+
+	return result;
+}
+
+void Triangulator::tesselate( Winding winding, std::vector<vec2> *positions, std::vector<uint32_t> *indices )
+{
+	if( mPoints.empty() || calcEarClipping( winding, positions, indices ) ) {
+		clear();
+		return;
+	}
+
+	TESStesselator *tess = mArena->createTess();
+	if( ! tess )
+		throw Triangulator::Exception();
+
+	size_t contourBegin = 0;
+	for( size_t contourEnd : mContourEnds ) {
+		tessAddContour( tess, 2, &mPoints[contourBegin], sizeof(vec2), (int)( contourEnd - contourBegin ) );
+		contourBegin = contourEnd;
+	}
+	clear();
+
+	if( tessTesselate( tess, (int)winding, TESS_POLYGONS, 3, 2, 0 ) ) {
+		const uint32_t offset = (uint32_t)positions->size();
+		const vec2 *vertices = reinterpret_cast<const vec2*>( tessGetVertices( tess ) );
+		positions->insert( positions->end(), vertices, vertices + tessGetVertexCount( tess ) );
+
+		const TESSindex *elements = tessGetElements( tess );
+		const size_t numIndices = (size_t)tessGetElementCount( tess ) * 3;
+		for( size_t i = 0; i < numIndices; ++i )
+			indices->push_back( offset + (uint32_t)elements[i] );
+	}
+}
+
+bool Triangulator::calcEarClipping( Winding winding, std::vector<vec2> *positions, std::vector<uint32_t> *indices )
+{
+	if( mContourEnds.size() != 1 || mPoints.size() > MAX_EAR_CLIPPING_VERTICES )
+		return false;
+
+	// gather the contour without repeated points
+	auto &points = mArena->mContour;
+	points.clear();
+	for( const vec2 &p : mPoints ) {
+		if( points.empty() || p != points.back() )
+			points.push_back( p );
+	}
+	while( points.size() > 1 && points.back() == points.front() )
+		points.pop_back();
+
+	const uint32_t n = (uint32_t)points.size();
+	if( n < 3 )
+		return false;
+
+	double area = 0;
+	for( uint32_t i = 0, j = n - 1; i < n; j = i++ )
+		area += (double)points[j].x * points[i].y - (double)points[i].x * points[j].y;
+	if( area == 0 )
+		return false;
+
+	// the contour must be simple; sweep the edges by their minimum x and test the ones whose x extents overlap
+	auto &edges = mArena->mEdges;
+	edges.resize( n );
+	for( uint32_t i = 0; i < n; ++i )
+		edges[i] = i;
+	auto minX = [&]( uint32_t e ) { return std::min( points[e].x, points[( e + 1 ) % n].x ); };
+	auto maxX = [&]( uint32_t e ) { return std::max( points[e].x, points[( e + 1 ) % n].x ); };
+	std::sort( edges.begin(), edges.end(), [&]( uint32_t a, uint32_t b ) { return minX( a ) < minX( b ); } );
+	for( uint32_t i = 0; i < n; ++i ) {
+		const uint32_t a = edges[i];
+		const float aMaxX = maxX( a );
+		for( uint32_t j = i + 1; j < n && minX( edges[j] ) <= aMaxX; ++j ) {
+			const uint32_t b = edges[j];
+			if( ( a + 1 ) % n == b || ( b + 1 ) % n == a ) {
+				// adjacent edges may only meet at their shared vertex, which excludes folding back onto each other
+				const uint32_t shared = ( ( a + 1 ) % n == b ) ? b : a;
+				const vec2 &s = points[shared], &u = points[( shared + n - 1 ) % n], &w = points[( shared + 1 ) % n];
+				if( orient( u, s, w ) == 0 && dot( u - s, w - s ) > 0 )
+					return false;
+			}
+			else {
+				const vec2 &a0 = points[a], &a1 = points[( a + 1 ) % n], &b0 = points[b], &b1 = points[( b + 1 ) % n];
+				if( std::max( a0.y, a1.y ) >= std::min( b0.y, b1.y ) && std::max( b0.y, b1.y ) >= std::min( a0.y, a1.y ) && segmentsTouch( a0, a1, b0, b1 ) )
+					return false;
+			}
+		}
+	}
+
+	// relative to the normal libtess2 computes, a single simple contour always has a winding number of +1
+	if( winding == WINDING_NEGATIVE || winding == WINDING_ABS_GEQ_TWO )
+		return true;
+
+	auto &prev = mArena->mPrev, &next = mArena->mNext;
+	prev.resize( n );
+	next.resize( n );
+	for( uint32_t i = 0; i < n; ++i ) {
+		prev[i] = ( i + n - 1 ) % n;
+		next[i] = ( i + 1 ) % n;
+	}
+
+	// triangles keep the orientation of the contour, matching libtess2
+	const double sign = ( area > 0 ) ? 1 : -1;
+	auto &convex = mArena->mConvex;
+	convex.resize( n );
+	uint32_t numReflex = 0;
+	auto updateConvex = [&]( uint32_t i ) {
+		const bool wasConvex = convex[i] != 0;
+		convex[i] = sign * orient( points[prev[i]], points[i], points[next[i]] ) > 0;
+		numReflex += ( wasConvex && ! convex[i] ) ? 1 : 0;
+		numReflex -= ( ! wasConvex && convex[i] ) ? 1 : 0;
+	};
+	std::fill( convex.begin(), convex.end(), 0 );
+	numReflex = n;
+	for( uint32_t i = 0; i < n; ++i )
+		updateConvex( i );
+
+	auto isEar = [&]( uint32_t i ) {
+		if( ! convex[i] )
+			return false;
+		// only reflex (or flat) vertices can lie within an ear of a simple polygon
+		const vec2 &a = points[prev[i]], &b = points[i], &c = points[next[i]];
+		const vec2 minCorner = glm::min( a, glm::min( b, c ) ), maxCorner = glm::max( a, glm::max( b, c ) );
+		for( uint32_t v = next[next[i]]; v != prev[i]; v = next[v] ) {
+			const vec2 &p = points[v];
+			if( ! convex[v] && p.x >= minCorner.x && p.x <= maxCorner.x && p.y >= minCorner.y && p.y <= maxCorner.y
+				&& sign * orient( a, b, p ) >= 0 && sign * orient( b, c, p ) >= 0 && sign * orient( c, a, p ) >= 0 )
+				return false;
+		}
+		return true;
+	};
+
+	const size_t indicesBegin = indices->size();
+	const uint32_t offset = (uint32_t)positions->size();
+	uint32_t remaining = n, current = 0, sinceLastEar = 0;
+	// once no reflex vertices remain, what's left is convex and is emitted as a fan
+	while( remaining > 3 && numReflex > 0 ) {
+		// a full cycle without an ear only happens with degenerate input; leave those to libtess2
+		if( sinceLastEar > remaining ) {
+			indices->resize( indicesBegin );
+			return false;
+		}
+
+		if( isEar( current ) ) {
+			const uint32_t p = prev[current], q = next[current];
+			indices->push_back( offset + p );
+			indices->push_back( offset + current );
+			indices->push_back( offset + q );
+			next[p] = q;
+			prev[q] = p;
+			updateConvex( p );
+			updateConvex( q );
+			--remaining;
+			sinceLastEar = 0;
+			current = q;
+		}
+		else {
+			current = next[current];
+			++sinceLastEar;
+		}
+	}
+	for( uint32_t v = next[current]; next[v] != current; v = next[v] ) {
+		if( orient( points[current], points[v], points[next[v]] ) != 0 ) {
+			indices->push_back( offset + current );
+			indices->push_back( offset + v );
+			indices->push_back( offset + next[v] );
+		}
+	}
+
+	positions->insert( positions->end(), points.begin(), points.end() );
+	return true;
+}
+
 } // namespace cinder
@@ -45,6 +45,7 @@
  */
 
 #include "cinder/Unicode.h"
+#include "cinder/Simd.h"
 #include <cstring>
 #include <string>
 
@@ -72,86 +73,589 @@ static const int halfShift = 10; // shift by 10 bits
 #define UNI_MAX_UTF32			(char32_t)0x7FFFFFFF
 #define UNI_MAX_LEGAL_UTF32		(char32_t)0x0010FFFF
 
+namespace {
+
+// Returned by the transcoders below for malformed input
+const size_t sInvalid = size_t( -1 );
+
+// Decodes the UTF-8 sequence at \a in, which is before \a end, into \a codePoint. Returns the length of the sequence, or 0 if it's
+// malformed or truncated. Overlong forms, surrogates and code points above U+10FFFF are malformed, matching utf8cpp.
+inline size_t decodeUtf8( const uint8_t *in, const uint8_t *end, uint32_t *codePoint )
+{
+	const uint32_t b0 = in[0];
+	if( b0 < 0x80 ) {
+		*codePoint = b0;
+		return 1;
+	}
+	else if( b0 < 0xC2 ) // continuation byte, or the lead of an overlong 2-byte form
+		return 0;
+	else if( b0 < 0xE0 ) {
+		if( end - in < 2 || ( in[1] & 0xC0 ) != 0x80 )
+			return 0;
+		*codePoint = ( ( b0 & 0x1F ) << 6 ) | ( in[1] & 0x3F );
+		return 2;
+	}
+	else if( b0 < 0xF0 ) {
+		if( end - in < 3 || ( in[1] & 0xC0 ) != 0x80 || ( in[2] & 0xC0 ) != 0x80 )
+			return 0;
+		const uint32_t cp = ( ( b0 & 0x0F ) << 12 ) | ( ( in[1] & 0x3F ) << 6 ) | ( in[2] & 0x3F );
+		if( cp < 0x800 || ( cp >= UNI_SUR_HIGH_START && cp <= UNI_SUR_LOW_END ) )
+			return 0;
+		*codePoint = cp;
+		return 3;
+	}
+	else if( b0 < 0xF5 ) {
+		if( end - in < 4 || ( in[1] & 0xC0 ) != 0x80 || ( in[2] & 0xC0 ) != 0x80 || ( in[3] & 0xC0 ) != 0x80 )
+			return 0;
+		const uint32_t cp = ( ( b0 & 0x07 ) << 18 ) | ( ( in[1] & 0x3F ) << 12 ) | ( ( in[2] & 0x3F ) << 6 ) | ( in[3] & 0x3F );
+		if( cp < 0x10000 || cp > UNI_MAX_LEGAL_UTF32 )
+			return 0;
+		*codePoint = cp;
+		return 4;
+	}
+	else
+		return 0;
+}
+
+// Encodes the valid code point \a cp as UTF-8 at \a out, returning the end of the sequence
+inline uint8_t* encodeUtf8( uint32_t cp, uint8_t *out )
+{
+	if( cp < 0x80 )
+		*out++ = uint8_t( cp );
+	else if( cp < 0x800 ) {
+		*out++ = uint8_t( 0xC0 | ( cp >> 6 ) );
+		*out++ = uint8_t( 0x80 | ( cp & 0x3F ) );
+	}
+	else if( cp < 0x10000 ) {
+		*out++ = uint8_t( 0xE0 | ( cp >> 12 ) );
+		*out++ = uint8_t( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+		*out++ = uint8_t( 0x80 | ( cp & 0x3F ) );
+	}
+	else {
+		*out++ = uint8_t( 0xF0 | ( cp >> 18 ) );
+		*out++ = uint8_t( 0x80 | ( ( cp >> 12 ) & 0x3F ) );
+		*out++ = uint8_t( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+		*out++ = uint8_t( 0x80 | ( cp & 0x3F ) );
+	}
+	return out;
+}
+
+// Runs of ASCII are handled 16 characters at a time. Everything else goes a code point at a time for at least 16 bytes or
+// units before looking for ASCII again, so that text without any isn't slowed down by the checks.
+#if defined( CINDER_SIMD_SSE2 )
+inline bool isAscii( __m128i bytes )
+{
+	return _mm_movemask_epi8( bytes ) == 0;
+}
+
+#elif defined( CINDER_SIMD_NEON )
+inline bool isAscii( uint8x16_t bytes )
+{
+	const uint8x8_t half = vorr_u8( vget_low_u8( bytes ), vget_high_u8( bytes ) );
+	return ( vget_lane_u64( vreinterpret_u64_u8( half ), 0 ) & 0x8080808080808080ULL ) == 0;
+}
+
+inline bool isAscii( uint16x8_t units )
+{
+	return isAscii( vreinterpretq_u8_u16( vcgtq_u16( units, vdupq_n_u16( 0x7F ) ) ) );
+}
+
+inline bool isAscii( uint32x4_t codePoints )
+{
+	return isAscii( vreinterpretq_u8_u32( vcgtq_u32( codePoints, vdupq_n_u32( 0x7F ) ) ) );
+}
+#endif
+
+// Validates \a length bytes of UTF-8 at \a in, counting its code points and how many of them are above the BMP. \a hasMaxBmp is set
+// when U+FFFF appears, which lb_get_next_char_utf8() can't tell apart from the end of the string.
+bool scanUtf8( const uint8_t *in, size_t length, size_t *numCodePoints, size_t *numSupplementary, bool *hasMaxBmp )
+{
+	const uint8_t *end = in + length;
+	size_t codePoints = 0, supplementary = 0;
+	bool maxBmp = false;
+	while( in < end ) {
+#if defined( CINDER_SIMD_SSE2 )
+		while( end - in >= 16 && isAscii( _mm_loadu_si128( (const __m128i*)in ) ) ) {
+			in += 16;
+			codePoints += 16;
+		}
+#elif defined( CINDER_SIMD_NEON )
+		while( end - in >= 16 && isAscii( vld1q_u8( in ) ) ) {
+			in += 16;
+			codePoints += 16;
+		}
+#endif
+		const uint8_t *blockEnd = ( end - in > 16 ) ? in + 16 : end;
+		while( in < blockEnd ) {
+			uint32_t cp;
+			const size_t size = decodeUtf8( in, end, &cp );
+			if( ! size )
+				return false;
+			in += size;
+			++codePoints;
+			supplementary += ( size == 4 );
+			maxBmp |= ( cp == UNI_MAX_BMP );
+		}
+	}
+
+	*numCodePoints = codePoints;
+	*numSupplementary = supplementary;
+	*hasMaxBmp = maxBmp;
+	return true;
+}
+
+// Transcodes \a length bytes of UTF-8 at \a in to \a out, which has room for \a length units. Returns the number of units written or sInvalid.
+size_t utf8ToUtf16( const uint8_t *in, size_t length, char16_t *out )
+{
+	const uint8_t *end = in + length;
+	char16_t *outStart = out;
+	while( in < end ) {
+#if defined( CINDER_SIMD_SSE2 )
+		const __m128i zero = _mm_setzero_si128();
+		while( end - in >= 16 ) {
+			const __m128i bytes = _mm_loadu_si128( (const __m128i*)in );
+			if( ! isAscii( bytes ) )
+				break;
+			_mm_storeu_si128( (__m128i*)out, _mm_unpacklo_epi8( bytes, zero ) );
+			_mm_storeu_si128( (__m128i*)( out + 8 ), _mm_unpackhi_epi8( bytes, zero ) );
+			in += 16;
+			out += 16;
+		}
+#elif defined( CINDER_SIMD_NEON )
+		while( end - in >= 16 ) {
+			const uint8x16_t bytes = vld1q_u8( in );
+			if( ! isAscii( bytes ) )
+				break;
+			vst1q_u16( (uint16_t*)out, vmovl_u8( vget_low_u8( bytes ) ) );
+			vst1q_u16( (uint16_t*)( out + 8 ), vmovl_u8( vget_high_u8( bytes ) ) );
+			in += 16;
+			out += 16;
+		}
+#endif
+		const uint8_t *blockEnd = ( end - in > 16 ) ? in + 16 : end;
+		while( in < blockEnd ) {
+			uint32_t cp;
+			const size_t size = decodeUtf8( in, end, &cp );
+			if( ! size )
+				return sInvalid;
+			in += size;
+			if( cp < halfBase )
+				*out++ = char16_t( cp );
+			else {
+				cp -= halfBase;
+				*out++ = char16_t( ( cp >> halfShift ) + UNI_SUR_HIGH_START );
+				*out++ = char16_t( ( cp & halfMask ) + UNI_SUR_LOW_START );
+			}
+		}
+	}
+
+	return out - outStart;
+}
+
+// Transcodes \a length bytes of UTF-8 at \a in to \a out, which has room for \a length code points. Returns the number written or sInvalid.
+size_t utf8ToUtf32( const uint8_t *in, size_t length, char32_t *out )
+{
+	const uint8_t *end = in + length;
+	char32_t *outStart = out;
+	while( in < end ) {
+#if defined( CINDER_SIMD_SSE2 )
+		const __m128i zero = _mm_setzero_si128();
+		while( end - in >= 16 ) {
+			const __m128i bytes = _mm_loadu_si128( (const __m128i*)in );
+			if( ! isAscii( bytes ) )
+				break;
+			const __m128i lo = _mm_unpacklo_epi8( bytes, zero ), hi = _mm_unpackhi_epi8( bytes, zero );
+			_mm_storeu_si128( (__m128i*)out, _mm_unpacklo_epi16( lo, zero ) );
+			_mm_storeu_si128( (__m128i*)( out + 4 ), _mm_unpackhi_epi16( lo, zero ) );
+			_mm_storeu_si128( (__m128i*)( out + 8 ), _mm_unpacklo_epi16( hi, zero ) );
+			_mm_storeu_si128( (__m128i*)( out + 12 ), _mm_unpackhi_epi16( hi, zero ) );
+			in += 16;
+			out += 16;
+		}
+#elif defined( CINDER_SIMD_NEON )
+		while( end - in >= 16 ) {
+			const uint8x16_t bytes = vld1q_u8( in );
+			if( ! isAscii( bytes ) )
+				break;
+			const uint16x8_t lo = vmovl_u8( vget_low_u8( bytes ) ), hi = vmovl_u8( vget_high_u8( bytes ) );
+			vst1q_u32( (uint32_t*)out, vmovl_u16( vget_low_u16( lo ) ) );
+			vst1q_u32( (uint32_t*)( out + 4 ), vmovl_u16( vget_high_u16( lo ) ) );
+			vst1q_u32( (uint32_t*)( out + 8 ), vmovl_u16( vget_low_u16( hi ) ) );
+			vst1q_u32( (uint32_t*)( out + 12 ), vmovl_u16( vget_high_u16( hi ) ) );
+			in += 16;
+			out += 16;
+		}
+#endif
+		const uint8_t *blockEnd = ( end - in > 16 ) ? in + 16 : end;
+		while( in < blockEnd ) {
+			uint32_t cp;
+			const size_t size = decodeUtf8( in, end, &cp );
+			if( ! size )
+				return sInvalid;
+			in += size;
+			*out++ = char32_t( cp );
+		}
+	}
+
+	return out - outStart;
+}
+
+// Returns the number of bytes \a length units of UTF-16 at \a in transcode to, or sInvalid if there are unpaired surrogates
+size_t utf8LengthOfUtf16( const char16_t *in, size_t length )
+{
+	const char16_t *end = in + length;
+	size_t result = 0;
+	while( in < end ) {
+#if defined( CINDER_SIMD_SSE2 )
+		const __m128i nonAscii = _mm_set1_epi16( (short)0xFF80 ), zero = _mm_setzero_si128();
+		while( end - in >= 8 && _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( _mm_loadu_si128( (const __m128i*)in ), nonAscii ), zero ) ) == 0xFFFF ) {
+			in += 8;
+			result += 8;
+		}
+#elif defined( CINDER_SIMD_NEON )
+		while( end - in >= 8 && isAscii( vld1q_u16( (const uint16_t*)in ) ) ) {
+			in += 8;
+			result += 8;
+		}
+#endif
+		const char16_t *blockEnd = ( end - in > 8 ) ? in + 8 : end;
+		while( in < blockEnd ) {
+			const uint32_t u = *in++;
+			if( u < 0x80 )
+				result += 1;
+			else if( u < 0x800 )
+				result += 2;
+			else if( u < UNI_SUR_HIGH_START || u > UNI_SUR_LOW_END )
+				result += 3;
+			else if( u <= UNI_SUR_HIGH_END && in < end && *in >= UNI_SUR_LOW_START && *in <= UNI_SUR_LOW_END ) {
+				++in;
+				result += 4;
+			}
+			else
+				return sInvalid;
+		}
+	}
+
+	return result;
+}
+
+// Transcodes \a length units of valid UTF-16 at \a in to \a out, returning the number of bytes written
+size_t utf16ToUtf8( const char16_t *in, size_t length, uint8_t *out )
+{
+	const char16_t *end = in + length;
+	uint8_t *outStart = out;
+	while( in < end ) {
+#if defined( CINDER_SIMD_SSE2 )
+		const __m128i nonAscii = _mm_set1_epi16( (short)0xFF80 ), zero = _mm_setzero_si128();
+		while( end - in >= 16 ) {
+			const __m128i lo = _mm_loadu_si128( (const __m128i*)in ), hi = _mm_loadu_si128( (const __m128i*)( in + 8 ) );
+			if( _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( _mm_or_si128( lo, hi ), nonAscii ), zero ) ) != 0xFFFF )
+				break;
+			_mm_storeu_si128( (__m128i*)out, _mm_packus_epi16( lo, hi ) );
+			in += 16;
+			out += 16;
+		}
+#elif defined( CINDER_SIMD_NEON )
+		while( end - in >= 16 ) {
+			const uint16x8_t lo = vld1q_u16( (const uint16_t*)in ), hi = vld1q_u16( (const uint16_t*)( in + 8 ) );
+			if( ! isAscii( vorrq_u16( lo, hi ) ) )
+				break;
+			vst1q_u8( out, vcombine_u8( vmovn_u16( lo ), vmovn_u16( hi ) ) );
+			in += 16;
+			out += 16;
+		}
+#endif
+		const char16_t *blockEnd = ( end - in > 16 ) ? in + 16 : end;
+		while( in < blockEnd ) {
+			uint32_t cp = *in++;
+			if( cp >= UNI_SUR_HIGH_START && cp <= UNI_SUR_HIGH_END )
+				cp = ( ( cp - UNI_SUR_HIGH_START ) << halfShift ) + ( *in++ - UNI_SUR_LOW_START ) + halfBase;
+			out = encodeUtf8( cp, out );
+		}
+	}
+
+	return out - outStart;
+}
+
+// Returns the number of bytes \a length code points of UTF-32 at \a in transcode to, or sInvalid if there are surrogates or values above U+10FFFF
+size_t utf8LengthOfUtf32( const char32_t *in, size_t length )
+{
+	size_t result = 0;
+	for( const char32_t *end = in + length; in < end; ++in ) {
+		const uint32_t cp = *in;
+		if( cp < 0x80 )
+			result += 1;
+		else if( cp < 0x800 )
+			result += 2;
+		else if( cp < 0x10000 ) {
+			if( cp >= UNI_SUR_HIGH_START && cp <= UNI_SUR_LOW_END )
+				return sInvalid;
+			result += 3;
+		}
+		else if( cp <= UNI_MAX_LEGAL_UTF32 )
+			result += 4;
+		else
+			return sInvalid;
+	}
+
+	return result;
+}
+
+// Transcodes \a length code points of valid UTF-32 at \a in to \a out, returning the number of bytes written
+size_t utf32ToUtf8( const char32_t *in, size_t length, uint8_t *out )
+{
+	const char32_t *end = in + length;
+	uint8_t *outStart = out;
+	while( in < end ) {
+#if defined( CINDER_SIMD_SSE2 )
+		const __m128i nonAscii = _mm_set1_epi32( (int)0xFFFFFF80 ), zero = _mm_setzero_si128();
+		while( end - in >= 16 ) {
+			const __m128i a = _mm_loadu_si128( (const __m128i*)in ), b = _mm_loadu_si128( (const __m128i*)( in + 4 ) );
+			const __m128i c = _mm_loadu_si128( (const __m128i*)( in + 8 ) ), d = _mm_loadu_si128( (const __m128i*)( in + 12 ) );
+			const __m128i any = _mm_or_si128( _mm_or_si128( a, b ), _mm_or_si128( c, d ) );
+			if( _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( any, nonAscii ), zero ) ) != 0xFFFF )
+				break;
+			_mm_storeu_si128( (__m128i*)out, _mm_packus_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) ) );
+			in += 16;
+			out += 16;
+		}
+#elif defined( CINDER_SIMD_NEON )
+		while( end - in >= 16 ) {
+			const uint32x4_t a = vld1q_u32( (const uint32_t*)in ), b = vld1q_u32( (const uint32_t*)( in + 4 ) );
+			const uint32x4_t c = vld1q_u32( (const uint32_t*)( in + 8 ) ), d = vld1q_u32( (const uint32_t*)( in + 12 ) );
+			if( ! isAscii( vorrq_u32( vorrq_u32( a, b ), vorrq_u32( c, d ) ) ) )
+				break;
+			const uint16x8_t lo = vcombine_u16( vmovn_u32( a ), vmovn_u32( b ) ), hi = vcombine_u16( vmovn_u32( c ), vmovn_u32( d ) );
+			vst1q_u8( out, vcombine_u8( vmovn_u16( lo ), vmovn_u16( hi ) ) );
+			in += 16;
+			out += 16;
+		}
+#endif
+		const char32_t *blockEnd = ( end - in > 16 ) ? in + 16 : end;
+		while( in < blockEnd )
+			out = encodeUtf8( *in++, out );
+	}
+
+	return out - outStart;
+}
+
+// Malformed input is handed to utf8cpp, which rejects the same sequences, so that errors throw the same exceptions as they always have
+void throwInvalidUtf8( const char *str, size_t length )
+{
+	std::u32string discarded;
+	utf8::utf8to32( str, str + length, back_inserter( discarded ) );
+	throw utf8::invalid_utf8( 0 );
+}
+
+void throwInvalidUtf16( const char16_t *str, size_t length )
+{
+	std::string discarded;
+	utf8::utf16to8( str, str + length, back_inserter( discarded ) );
+	throw utf8::invalid_utf16( 0 );
+}
+
+void throwInvalidUtf32( const char32_t *str, size_t length )
+{
+	std::string discarded;
+	utf8::utf32to8( str, str + length, back_inserter( discarded ) );
+	throw utf8::invalid_code_point( 0 );
+}
+
+} // anonymous namespace
+
+bool isValidUtf8( const char *str, size_t lengthInBytes )
+{
+	size_t numCodePoints, numSupplementary;
+	bool hasMaxBmp;
+	return scanUtf8( (const uint8_t*)str, lengthInBytes, &numCodePoints, &numSupplementary, &hasMaxBmp );
+}
+
 std::u16string toUtf16( const char *utf8Str, size_t lengthInBytes )
 {
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( utf8Str );
 	
 	std::u16string result;
-	utf8::utf8to16( utf8Str, utf8Str + lengthInBytes, back_inserter( result ));
+	toUtf16( utf8Str, lengthInBytes, &result );
 	return result;
 }
 
 std::u16string toUtf16( const std::string &utf8Str )
 {
 	std::u16string result;
-	utf8::utf8to16( utf8Str.begin(), utf8Str.end(), back_inserter( result ));
+	toUtf16( utf8Str.data(), utf8Str.size(), &result );
 	return result;
 }
 
+size_t toUtf16( const char *utf8Str, size_t lengthInBytes, char16_t *result, size_t resultCapacity )
+{
+	// a unit per byte always suffices; otherwise the exact size has to be known before writing anything
+	if( resultCapacity < lengthInBytes ) {
+		size_t numCodePoints, numSupplementary;
+		bool hasMaxBmp;
+		if( ! scanUtf8( (const uint8_t*)utf8Str, lengthInBytes, &numCodePoints, &numSupplementary, &hasMaxBmp ) )
+			throwInvalidUtf8( utf8Str, lengthInBytes );
+		if( numCodePoints + numSupplementary > resultCapacity )
+			return numCodePoints + numSupplementary;
+	}
+
+	const size_t size = utf8ToUtf16( (const uint8_t*)utf8Str, lengthInBytes, result );
+	if( size == sInvalid )
+		throwInvalidUtf8( utf8Str, lengthInBytes );
+	return size;
+}
+
+void toUtf16( const char *utf8Str, size_t lengthInBytes, std::u16string *result )
+{
+	result->resize( lengthInBytes );
+	const size_t size = utf8ToUtf16( (const uint8_t*)utf8Str, lengthInBytes, &(*result)[0] );
+	if( size == sInvalid ) {
+		result->clear();
+		throwInvalidUtf8( utf8Str, lengthInBytes );
+	}
+	result->resize( size );
+}
+
 std::u32string toUtf32( const char *utf8Str, size_t lengthInBytes )
 {
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( utf8Str );
 	
 	std::u32string result;
-	utf8::utf8to32( utf8Str, utf8Str + lengthInBytes, back_inserter( result ));
+	toUtf32( utf8Str, lengthInBytes, &result );
 	return result;
 }
 
 std::u32string toUtf32( const std::string &utf8Str )
 {
 	std::u32string result;
-	utf8::utf8to32( utf8Str.begin(), utf8Str.end(), back_inserter( result ));
+	toUtf32( utf8Str.data(), utf8Str.size(), &result );
 	return result;
 }
 
+size_t toUtf32( const char *utf8Str, size_t lengthInBytes, char32_t *result, size_t resultCapacity )
+{
+	if( resultCapacity < lengthInBytes ) {
+		size_t numCodePoints, numSupplementary;
+		bool hasMaxBmp;
+		if( ! scanUtf8( (const uint8_t*)utf8Str, lengthInBytes, &numCodePoints, &numSupplementary, &hasMaxBmp ) )
+			throwInvalidUtf8( utf8Str, lengthInBytes );
+		if( numCodePoints > resultCapacity )
+			return numCodePoints;
+	}
+
+	const size_t size = utf8ToUtf32( (const uint8_t*)utf8Str, lengthInBytes, result );
+	if( size == sInvalid )
+		throwInvalidUtf8( utf8Str, lengthInBytes );
+	return size;
+}
+
+void toUtf32( const char *utf8Str, size_t lengthInBytes, std::u32string *result )
+{
+	result->resize( lengthInBytes );
+	const size_t size = utf8ToUtf32( (const uint8_t*)utf8Str, lengthInBytes, &(*result)[0] );
+	if( size == sInvalid ) {
+		result->clear();
+		throwInvalidUtf8( utf8Str, lengthInBytes );
+	}
+	result->resize( size );
+}
+
 std::string toUtf8( const char16_t *utf16Str, size_t lengthInBytes )
 {
 	if( lengthInBytes == 0 )
-		while( utf16Str[lengthInBytes] )
-			++lengthInBytes;
-	else
-		lengthInBytes /= 2;
+		while( utf16Str[lengthInBytes / 2] )
+			lengthInBytes += 2;
 
 	std::string result;
-	utf8::utf16to8( utf16Str, utf16Str + lengthInBytes, back_inserter( result ));
+	toUtf8( utf16Str, lengthInBytes, &result );
 	return result;	
 }
 
 std::string	toUtf8( const std::u16string &utf16Str )
 {
 	std::string result;
-	utf8::utf16to8( utf16Str.begin(), utf16Str.end(), back_inserter( result ));
+	toUtf8( utf16Str.data(), utf16Str.size() * 2, &result );
 	return result;
 }
 
+size_t toUtf8( const char16_t *utf16Str, size_t lengthInBytes, char *result, size_t resultCapacity )
+{
+	const size_t length = lengthInBytes / 2;
+	const size_t size = utf8LengthOfUtf16( utf16Str, length );
+	if( size == sInvalid )
+		throwInvalidUtf16( utf16Str, length );
+	if( size <= resultCapacity )
+		utf16ToUtf8( utf16Str, length, (uint8_t*)result );
+	return size;
+}
+
+void toUtf8( const char16_t *utf16Str, size_t lengthInBytes, std::string *result )
+{
+	const size_t length = lengthInBytes / 2;
+	const size_t size = utf8LengthOfUtf16( utf16Str, length );
+	if( size == sInvalid ) {
+		result->clear();
+		throwInvalidUtf16( utf16Str, length );
+	}
+	result->resize( size );
+	utf16ToUtf8( utf16Str, length, (uint8_t*)&(*result)[0] );
+}
+
 std::string toUtf8( const char32_t *utf32Str, size_t lengthInBytes )
 {
 	if( lengthInBytes == 0 )
-		while( utf32Str[lengthInBytes] )
-			++lengthInBytes;
-	else
-		lengthInBytes /= 4;
+		while( utf32Str[lengthInBytes / 4] )
+			lengthInBytes += 4;
 
 	std::string result;
-	utf8::utf32to8( utf32Str, utf32Str + lengthInBytes, back_inserter( result ));
+	toUtf8( utf32Str, lengthInBytes, &result );
 	return result;
 }
 
 std::string	toUtf8( const std::u32string &utf32Str )
 {
 	std::string result;
-	utf8::utf32to8( utf32Str.begin(), utf32Str.end(), back_inserter( result ));
+	toUtf8( utf32Str.data(), utf32Str.size() * 4, &result );
 	return result;
 }
 
+size_t toUtf8( const char32_t *utf32Str, size_t lengthInBytes, char *result, size_t resultCapacity )
+{
+	const size_t length = lengthInBytes / 4;
+	const size_t size = utf8LengthOfUtf32( utf32Str, length );
+	if( size == sInvalid )
+		throwInvalidUtf32( utf32Str, length );
+	if( size <= resultCapacity )
+		utf32ToUtf8( utf32Str, length, (uint8_t*)result );
+	return size;
+}
+
+void toUtf8( const char32_t *utf32Str, size_t lengthInBytes, std::string *result )
+{
+	const size_t length = lengthInBytes / 4;
+	const size_t size = utf8LengthOfUtf32( utf32Str, length );
+	if( size == sInvalid ) {
+		result->clear();
+		throwInvalidUtf32( utf32Str, length );
+	}
+	result->resize( size );
+	utf32ToUtf8( utf32Str, length, (uint8_t*)&(*result)[0] );
+}
+
 size_t stringLengthUtf8( const char *str, size_t lengthInBytes )
 {
-	size_t result = 0;
-	size_t nextByte = 0;
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( str );
+
+	// well-formed text is counted in bulk; anything else keeps the lenient counting of lb_get_next_char_utf8()
+	size_t numCodePoints, numSupplementary;
+	bool hasMaxBmp;
+	if( scanUtf8( (const uint8_t*)str, lengthInBytes, &numCodePoints, &numSupplementary, &hasMaxBmp ) && ! hasMaxBmp )
+		return numCodePoints;
+
+	size_t result = 0;
+	size_t nextByte = 0;
 	while( nextCharUtf8( (const char*)str, &nextByte, lengthInBytes ) != 0xFFFF )
 		++result;
 	return result;	
@@ -228,19 +732,14 @@ std::u32string toUtf32( const std::u16string &utf16str )
 }
 
 namespace {
-bool shouldBreak( char code )
+bool shouldBreak( uint8_t code )
 {
 	return ( code == LINEBREAK_ALLOWBREAK ) || ( code == LINEBREAK_MUSTBREAK );
 }
-} // anonymous namespace
 
-void lineBreakUtf8( const char *line, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn )
+// Breaks the \a lengthInBytes bytes of \a line, whose break opportunities are \a brks
+void lineBreakUtf8( const char *line, size_t lengthInBytes, const uint8_t *brks, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn )
 {
-	const size_t lengthInBytes = strlen( line );
-	shared_ptr<char> brks = shared_ptr<char>( (char*)malloc( lengthInBytes ), free );
-	
-	set_linebreaks_utf8( (const uint8_t*)line, lengthInBytes, NULL, brks.get() );
-
 	// Byte-suffixed variables correspond to a byte in the UTF8 string, as opposed to the character
 	// binary search for the threshold where measureFn() returns false; emerges as curChar
 	size_t charLen = stringLengthUtf8( line, lengthInBytes );
@@ -252,14 +751,14 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 		int curChar = 0;
 		
 		// test to see if we're already on a mustbreak
-		if( brks.get()[lineStartByte] != 0 ) {
+		if( brks[lineStartByte] != 0 ) {
 			// update our maxChar to reflect any MUSTBREAKS
 			int maxCharWithMustBreaks = minChar;
 			size_t maxCharByte = lineStartByte;
 
 			while( maxCharWithMustBreaks < maxChar ) {
 				nextCharUtf8( line, &maxCharByte, lengthInBytes );
-				if( brks.get()[maxCharByte] == 0 ) {
+				if( maxCharByte >= lengthInBytes || brks[maxCharByte] == 0 ) {
 					maxCharWithMustBreaks++;
 					break;
 				}
@@ -270,7 +769,7 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 		
 			while( minChar < maxChar ) {
 				curChar = minChar + (maxChar-minChar+1)/2;
-				size_t newByte = advanceCharUtf8( line + lineStartByte, curChar, lengthInBytes );
+				size_t newByte = advanceCharUtf8( line + lineStartByte, curChar, lengthInBytes - lineStartByte );
 				if( ! measureFn( line + lineStartByte, newByte ) )
 					maxChar = curChar - 1;
 				else
@@ -283,9 +782,9 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 		}
 
 		// find ideal place to perform the break, either at curChar or before depending on breaks
-		size_t lineEndByteAfterBreaking = lineEndByte = advanceCharUtf8( line + lineStartByte, curChar ) + lineStartByte;
-		if( ( lineEndByteAfterBreaking < lengthInBytes ) /*&& ( ! shouldBreak( brks.get()[lineEndByteAfterBreaking] ) )*/ ) {
-			while( (lineEndByteAfterBreaking > lineStartByte) && ( ! shouldBreak( brks.get()[lineEndByteAfterBreaking-1] ) ) )
+		size_t lineEndByteAfterBreaking = lineEndByte = advanceCharUtf8( line + lineStartByte, curChar, lengthInBytes - lineStartByte ) + lineStartByte;
+		if( ( lineEndByteAfterBreaking < lengthInBytes ) /*&& ( ! shouldBreak( brks[lineEndByteAfterBreaking] ) )*/ ) {
+			while( (lineEndByteAfterBreaking > lineStartByte) && ( ! shouldBreak( brks[lineEndByteAfterBreaking-1] ) ) )
 				lineEndByteAfterBreaking--;
 			if( lineEndByteAfterBreaking == lineStartByte ) // there's no good breakpoint; just break where we would have
 				lineEndByteAfterBreaking = lineEndByte;
@@ -301,6 +800,100 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 		}
 	}
 }
+} // anonymous namespace
+
+void lineBreakUtf8( const char *line, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn )
+{
+	const size_t lengthInBytes = strlen( line );
+	std::vector<uint8_t> brks;
+	calcLinebreaksUtf8( line, lengthInBytes, &brks );
+	lineBreakUtf8( line, lengthInBytes, brks.data(), measureFn, lineProcessFn );
+}
+
+size_t paragraphLengthUtf8( const char *str, size_t lengthInBytes )
+{
+	const void *newline = memchr( str, '\n', lengthInBytes );
+	return newline ? (const char*)newline - str + 1 : lengthInBytes;
+}
+
+void calcParagraphLinebreaksUtf8( const char *str, size_t strLength, bool first, std::vector<uint8_t> *resultBreaks )
+{
+	if( first ) {
+		calcLinebreaksUtf8( str, strLength, resultBreaks );
+		return;
+	}
+
+	// a space which starts the text is treated differently from one after a line break, so the paragraph gets the '\n' it follows
+	std::string afterBreak( 1, '\n' );
+	afterBreak.append( str, strLength );
+	resultBreaks->resize( afterBreak.size() );
+	set_linebreaks_utf8( (const uint8_t*)afterBreak.data(), afterBreak.size(), NULL, (char*)resultBreaks->data() );
+	resultBreaks->erase( resultBreaks->begin() );
+}
+
+void lineBreakParagraphUtf8( const char *str, size_t lengthInBytes, const uint8_t *breaks, bool first, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn )
+{
+	// lineBreakUtf8() skips the spaces that start each line, including those after a '\n'
+	size_t start = 0;
+	if( ! first )
+		while( start < lengthInBytes && str[start] == ' ' )
+			++start;
+
+	lineBreakUtf8( str + start, lengthInBytes - start, breaks + start, measureFn, lineProcessFn );
+}
+
+void LinebreakCache::calcLinebreaksUtf8( const char *str, size_t strLength, std::vector<uint8_t> *resultBreaks )
+{
+	resultBreaks->resize( strLength );
+	for( size_t offset = 0; offset < strLength; ) {
+		const size_t length = paragraphLengthUtf8( str + offset, strLength - offset );
+		const std::vector<uint8_t> &breaks = getParagraphBreaks( str + offset, length, offset == 0 );
+		std::copy( breaks.begin(), breaks.end(), resultBreaks->begin() + offset );
+		offset += length;
+	}
+	evictUnused();
+}
+
+void LinebreakCache::lineBreakUtf8( const char *str, size_t lengthInBytes, const std::function<bool(const char *, size_t)> &measureFn, const std::function<void(const char *,size_t)> &lineProcessFn )
+{
+	for( size_t offset = 0; offset < lengthInBytes; ) {
+		const size_t length = paragraphLengthUtf8( str + offset, lengthInBytes - offset );
+		const std::vector<uint8_t> &breaks = getParagraphBreaks( str + offset, length, offset == 0 );
+		lineBreakParagraphUtf8( str + offset, length, breaks.data(), offset == 0, measureFn, lineProcessFn );
+		offset += length;
+	}
+	evictUnused();
+}
+
+const std::vector<uint8_t>& LinebreakCache::getParagraphBreaks( const char *str, size_t lengthInBytes, bool first )
+{
+	mKey.assign( str, lengthInBytes );
+	mKey.push_back( first ? 1 : 0 );
+	auto it = mParagraphs.find( mKey );
+	if( it == mParagraphs.end() ) {
+		it = mParagraphs.emplace( mKey, Paragraph() ).first;
+		calcParagraphLinebreaksUtf8( str, lengthInBytes, first, &it->second.mBreaks );
+		++mNumCalculated;
+	}
+	it->second.mLastUse = mGeneration;
+	return it->second.mBreaks;
+}
+
+void LinebreakCache::evictUnused()
+{
+	for( auto it = mParagraphs.begin(); it != mParagraphs.end(); ) {
+		if( it->second.mLastUse != mGeneration )
+			it = mParagraphs.erase( it );
+		else
+			++it;
+	}
+	++mGeneration;
+}
+
+void LinebreakCache::clear()
+{
+	mParagraphs.clear();
+}
 
 void calcLinebreaksUtf8( const char *str, std::vector<uint8_t> *resultBreaks )
 {
@@ -421,20 +421,30 @@ void XmlTree::write( DataTargetRef target, bool createDocument )
 }
 
 XmlTree::ExcChildNotFound::ExcChildNotFound( const XmlTree &node, const string &childPath ) throw()
+	: ExcChildNotFound( node.getPath(), childPath )
+{
+}
+
+XmlTree::ExcChildNotFound::ExcChildNotFound( const string &nodePath, const string &childPath ) throw()
 {
 #if defined( CINDER_MSW )
-	sprintf_s( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), node.getPath().c_str() );
+	sprintf_s( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), nodePath.c_str() );
 #else
-	sprintf( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), node.getPath().c_str() );
+	snprintf( mMessage, sizeof( mMessage ), "Could not find child: %s for node: %s", childPath.c_str(), nodePath.c_str() );
 #endif
 }
 
 XmlTree::ExcAttrNotFound::ExcAttrNotFound( const XmlTree &node, const string &attrName ) throw()
+	: ExcAttrNotFound( node.getPath(), attrName )
+{
+}
+
+XmlTree::ExcAttrNotFound::ExcAttrNotFound( const string &nodePath, const string &attrName ) throw()
 {
 #if defined( CINDER_MSW )
-	sprintf_s( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), node.getPath().c_str() );
+	sprintf_s( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), nodePath.c_str() );
 #else
-	sprintf( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), node.getPath().c_str() );
+	snprintf( mMessage, sizeof( mMessage ), "Could not find attribute: %s for node: %s", attrName.c_str(), nodePath.c_str() );
 #endif
 }
 
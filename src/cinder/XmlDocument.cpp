@@ -0,0 +1,439 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/XmlDocument.h"
+
+#include "rapidxml/rapidxml.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+inline char asciiLower( char c )
+{
+	return ( c >= 'A' && c <= 'Z' ) ? c + ( 'a' - 'A' ) : c;
+}
+
+bool tagsMatch( const char *tag, size_t tagLength, const char *searchTag, size_t searchLength, bool caseSensitive )
+{
+	if( tagLength != searchLength )
+		return false;
+	else if( caseSensitive )
+		return memcmp( tag, searchTag, tagLength ) == 0;
+
+	for( size_t i = 0; i < tagLength; ++i )
+		if( asciiLower( tag[i] ) != asciiLower( searchTag[i] ) )
+			return false;
+	return true;
+}
+
+// FNV-1a over the case-folded tag, combined with the parent's address so that a single table can index every element
+size_t indexKey( const void *parent, const char *tag, size_t tagLength )
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for( size_t i = 0; i < tagLength; ++i ) {
+		hash ^= (uint8_t)asciiLower( tag[i] );
+		hash *= 1099511628211ULL;
+	}
+	hash ^= (uint64_t)(uintptr_t)parent * 0x9E3779B97F4A7C15ULL;
+	return (size_t)( hash ^ ( hash >> 29 ) );
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDocument::Attr
+const char* XmlDocument::Attr::getNameData() const
+{
+	return mAttr ? mAttr->name() : "";
+}
+
+size_t XmlDocument::Attr::getNameLength() const
+{
+	return mAttr ? mAttr->name_size() : 0;
+}
+
+const char* XmlDocument::Attr::getValueData() const
+{
+	return mAttr ? mAttr->value() : "";
+}
+
+size_t XmlDocument::Attr::getValueLength() const
+{
+	return mAttr ? mAttr->value_size() : 0;
+}
+
+XmlDocument::Attr XmlDocument::Attr::getNext() const
+{
+	return Attr( mAttr ? mAttr->next_attribute() : nullptr );
+}
+
+bool XmlDocument::Attr::operator==( const char *rhs ) const
+{
+	const size_t length = strlen( rhs );
+	return length == getValueLength() && memcmp( getValueData(), rhs, length ) == 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDocument::Node::ConstIter
+XmlDocument::Node::ConstIter::ConstIter( const XmlDocument *doc, const NodeImpl *parent, const string &filterPath, bool caseSensitive, char separator )
+	: mDoc( doc ), mNode( nullptr ), mCaseSensitive( caseSensitive )
+{
+	mFilter = split( filterPath, separator );
+
+	// as with XmlTree, a leading separator is ignored and an empty filter matches nothing
+	if( ( ! filterPath.empty() ) && ( filterPath[0] == separator ) && ( ! mFilter.empty() ) )
+		mFilter.erase( mFilter.begin() );
+
+	if( ! mFilter.empty() )
+		mNode = seek( parent, parent->first_node(), 0 );
+}
+
+// Returns the first node at or following \a node which matches the remainder of the filter starting at \a level, descending
+// into matching children and returning to the parent's siblings as each level is exhausted.
+const XmlDocument::NodeImpl* XmlDocument::Node::ConstIter::seek( const NodeImpl *parent, const NodeImpl *node, size_t level ) const
+{
+	while( true ) {
+		const string &tag = mFilter[level];
+		while( node && ! ( node->type() == rapidxml::node_element && tagsMatch( node->name(), node->name_size(), tag.c_str(), tag.size(), mCaseSensitive ) ) )
+			node = node->next_sibling();
+
+		if( node ) {
+			if( level + 1 == mFilter.size() )
+				return node;
+			parent = node;
+			node = node->first_node();
+			++level;
+		}
+		else if( level == 0 )
+			return nullptr;
+		else {
+			node = parent->next_sibling();
+			parent = parent->parent();
+			--level;
+		}
+	}
+}
+
+XmlDocument::Node::ConstIter& XmlDocument::Node::ConstIter::operator++()
+{
+	if( mFilter.empty() ) {
+		do {
+			mNode = mNode->next_sibling();
+		} while( mNode && ! mDoc->isVisible( mNode ) );
+	}
+	else
+		mNode = seek( mNode->parent(), mNode->next_sibling(), mFilter.size() - 1 );
+
+	return *this;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDocument::Node
+XmlTree::NodeType XmlDocument::Node::getNodeType() const
+{
+	switch( mNode->type() ) {
+		case rapidxml::node_document:	return XmlTree::NODE_DOCUMENT;
+		case rapidxml::node_element:	return XmlTree::NODE_ELEMENT;
+		case rapidxml::node_cdata:		return XmlTree::NODE_CDATA;
+		case rapidxml::node_comment:	return XmlTree::NODE_COMMENT;
+		case rapidxml::node_data:		return XmlTree::NODE_DATA;
+		default:						return XmlTree::NODE_UNKNOWN;
+	}
+}
+
+const char* XmlDocument::Node::getTagData() const
+{
+	return mNode->name();
+}
+
+size_t XmlDocument::Node::getTagLength() const
+{
+	return mNode->name_size();
+}
+
+string XmlDocument::Node::getValue() const
+{
+	string result( mNode->value(), mNode->value_size() );
+	if( mDoc->mParseOptions.getCollapseCData() && mNode->type() != rapidxml::node_cdata ) {
+		for( const NodeImpl *child = mNode->first_node(); child; child = child->next_sibling() )
+			if( child->type() == rapidxml::node_cdata )
+				result.append( child->value(), child->value_size() );
+	}
+
+	return result;
+}
+
+const char* XmlDocument::Node::getValueData() const
+{
+	return mNode->value();
+}
+
+size_t XmlDocument::Node::getValueLength() const
+{
+	return mNode->value_size();
+}
+
+bool XmlDocument::Node::hasParent() const
+{
+	return mNode->parent() != nullptr;
+}
+
+XmlDocument::Node XmlDocument::Node::getParent() const
+{
+	return Node( mDoc, mNode->parent() );
+}
+
+const XmlDocument::NodeImpl* XmlDocument::Node::findNode( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	const NodeImpl *node = mNode;
+	const char *c = relativePath.c_str();
+	const char *end = c + relativePath.size();
+	while( c < end ) {
+		const char *componentEnd = c;
+		while( componentEnd < end && *componentEnd != separator )
+			++componentEnd;
+		if( componentEnd > c ) {
+			node = mDoc->findChild( node, c, componentEnd - c, caseSensitive );
+			if( ! node )
+				return nullptr;
+		}
+		c = componentEnd + 1;
+	}
+
+	return node;
+}
+
+bool XmlDocument::Node::hasChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	return findNode( relativePath, caseSensitive, separator ) != nullptr;
+}
+
+XmlDocument::Node XmlDocument::Node::getChild( const string &relativePath, bool caseSensitive, char separator ) const
+{
+	const NodeImpl *child = findNode( relativePath, caseSensitive, separator );
+	if( child )
+		return Node( mDoc, child );
+	else
+		throw XmlTree::ExcChildNotFound( getPath(), relativePath );
+}
+
+XmlDocument::Node::ConstIter XmlDocument::Node::begin() const
+{
+	const NodeImpl *child = mNode->first_node();
+	while( child && ! mDoc->isVisible( child ) )
+		child = child->next_sibling();
+
+	return ConstIter( mDoc, child );
+}
+
+XmlDocument::Node::ConstIter XmlDocument::Node::begin( const string &filterPath, bool caseSensitive, char separator ) const
+{
+	return ConstIter( mDoc, mNode, filterPath, caseSensitive, separator );
+}
+
+XmlDocument::Attr XmlDocument::Node::findAttribute( const string &attrName ) const
+{
+	for( const AttrImpl *attr = mNode->first_attribute(); attr; attr = attr->next_attribute() )
+		if( attr->name_size() == attrName.size() && memcmp( attr->name(), attrName.c_str(), attrName.size() ) == 0 )
+			return Attr( attr );
+
+	return Attr();
+}
+
+XmlDocument::Attr XmlDocument::Node::getAttribute( const string &attrName ) const
+{
+	Attr result = findAttribute( attrName );
+	if( ! result )
+		throw XmlTree::ExcAttrNotFound( getPath(), attrName );
+
+	return result;
+}
+
+XmlDocument::Attr XmlDocument::Node::getFirstAttribute() const
+{
+	return Attr( mNode->first_attribute() );
+}
+
+string XmlDocument::Node::getPath( char separator ) const
+{
+	string result;
+	for( const NodeImpl *node = mNode; node; node = node->parent() ) {
+		string nodeName( node->name(), node->name_size() );
+		if( node != mNode )
+			nodeName += separator;
+		result = nodeName + result;
+	}
+
+	return result;
+}
+
+XmlTree XmlDocument::Node::toXmlTree() const
+{
+	XmlTree result( getTag(), getValue(), nullptr, getNodeType() );
+	buildTree( &result );
+	return result;
+}
+
+// Mirrors the conversion XmlTree performs when parsing, so that toXmlTree() produces the same tree as parsing the source directly
+void XmlDocument::Node::buildTree( XmlTree *result ) const
+{
+	if( mNode->type() == rapidxml::node_document )
+		result->setDocType( mDoc->getDocType() );
+
+	for( const NodeImpl *child = mNode->first_node(); child; child = child->next_sibling() ) {
+		if( ! mDoc->isVisible( child ) )
+			continue;
+		Node childNode( mDoc, child );
+		result->getChildren().push_back( unique_ptr<XmlTree>( new XmlTree( childNode.getTag(), childNode.getValue(), result, childNode.getNodeType() ) ) );
+		childNode.buildTree( result->getChildren().back().get() );
+	}
+
+	for( const AttrImpl *attr = mNode->first_attribute(); attr; attr = attr->next_attribute() )
+		result->getAttributes().push_back( XmlTree::Attr( result, string( attr->name(), attr->name_size() ), string( attr->value(), attr->value_size() ) ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlDocument
+XmlDocument::XmlDocument( const DataSourceRef &dataSource, const XmlTree::ParseOptions &parseOptions )
+	: mParseOptions( parseOptions ), mRoot( nullptr ), mIndexed( false )
+{
+	auto buffer = dataSource->getBuffer();
+	parse( (const char *)buffer->getData(), buffer->getSize() );
+}
+
+XmlDocument::XmlDocument( const string &xmlString, const XmlTree::ParseOptions &parseOptions )
+	: mParseOptions( parseOptions ), mRoot( nullptr ), mIndexed( false )
+{
+	parse( xmlString.data(), xmlString.size() );
+}
+
+XmlDocument::XmlDocument( const char *data, size_t size, const XmlTree::ParseOptions &parseOptions )
+	: mParseOptions( parseOptions ), mRoot( nullptr ), mIndexed( false )
+{
+	parse( data, size );
+}
+
+XmlDocument::~XmlDocument()
+{
+}
+
+void XmlDocument::parse( const char *data, size_t size )
+{
+	mText.reset( new char[size + 1] );
+	memcpy( mText.get(), data, size );
+	mText[size] = 0;
+
+	mDoc.reset( new rapidxml::xml_document<char>() );
+	if( mParseOptions.getParseComments() )
+		mDoc->parse<rapidxml::parse_comment_nodes | rapidxml::parse_doctype_node>( mText.get() );
+	else
+		mDoc->parse<rapidxml::parse_doctype_node>( mText.get() );
+	mRoot = mDoc.get();
+}
+
+string XmlDocument::getDocType() const
+{
+	for( const NodeImpl *node = mRoot->first_node(); node; node = node->next_sibling() )
+		if( node->type() == rapidxml::node_doctype )
+			return string( node->value(), node->value_size() );
+
+	return string();
+}
+
+bool XmlDocument::isVisible( const NodeImpl *node ) const
+{
+	switch( node->type() ) {
+		case rapidxml::node_element:
+		case rapidxml::node_comment:
+			return true;
+		case rapidxml::node_cdata:
+			return ! mParseOptions.getCollapseCData();
+		case rapidxml::node_data:
+			return ! mParseOptions.getIgnoreDataChildren();
+		default:
+			return false;
+	}
+}
+
+void XmlDocument::buildIndex()
+{
+	if( mIndexed )
+		return;
+
+	// count elements first so the table is allocated once
+	size_t numElements = 0;
+	vector<const NodeImpl*> stack( 1, mRoot );
+	while( ! stack.empty() ) {
+		const NodeImpl *parent = stack.back();
+		stack.pop_back();
+		for( const NodeImpl *child = parent->first_node(); child; child = child->next_sibling() ) {
+			if( child->type() == rapidxml::node_element ) {
+				++numElements;
+				stack.push_back( child );
+			}
+		}
+	}
+
+	mIndex.reserve( numElements );
+	stack.push_back( mRoot );
+	while( ! stack.empty() ) {
+		const NodeImpl *parent = stack.back();
+		stack.pop_back();
+		for( const NodeImpl *child = parent->first_node(); child; child = child->next_sibling() ) {
+			if( child->type() == rapidxml::node_element ) {
+				mIndex.emplace( indexKey( parent, child->name(), child->name_size() ), child ); // keeps the first sibling with this key
+				stack.push_back( child );
+			}
+		}
+	}
+
+	mIndexed = true;
+}
+
+const XmlDocument::NodeImpl* XmlDocument::findChild( const NodeImpl *parent, const char *tag, size_t tagLength, bool caseSensitive ) const
+{
+	const NodeImpl *child = parent->first_node();
+	if( mIndexed ) {
+		auto it = mIndex.find( indexKey( parent, tag, tagLength ) );
+		if( it == mIndex.end() )
+			return nullptr;
+		// The entry is the first child whose case-folded tag matches, unless another tag collided with it. No earlier
+		// sibling can match in either case, so a mismatch or a case-sensitive search continues linearly from there.
+		child = it->second;
+		if( child->parent() != parent || ! tagsMatch( child->name(), child->name_size(), tag, tagLength, false ) )
+			child = parent->first_node();
+	}
+
+	for( ; child; child = child->next_sibling() )
+		if( child->type() == rapidxml::node_element && tagsMatch( child->name(), child->name_size(), tag, tagLength, caseSensitive ) )
+			return child;
+
+	return nullptr;
+}
+
+} // namespace cinder
@@ -0,0 +1,565 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// The coverage calculation follows the signed-area accumulation approach popularized by font-rs and stb_truetype:
+// each edge deposits the exact area it covers within each pixel of each scanline it crosses into an accumulation
+// buffer, and a running sum across the row then yields the coverage of every pixel.
+
+#include "cinder/ip/Rasterize.h"
+#include "cinder/ip/Fill.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Simd.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+const int32_t BAND_HEIGHT = 32;
+// Approximate number of pixels below which compositing is not split across another thread
+const size_t PARALLEL_MIN_PIXELS = 1 << 16;
+
+// The edges overlapping a band of BAND_HEIGHT rows, and their horizontal extent
+struct Band {
+	std::vector<uint32_t>	mEdges;
+	float					mMinX, mMaxX;
+};
+
+// Returns the approximate uniform scale applied by the upper 2x2 of 'm'
+float calcTransformScale( const mat3 &m )
+{
+	float det = fabs( m[0][0] * m[1][1] - m[0][1] * m[1][0] );
+	return ( det > 0 ) ? math<float>::sqrt( det ) : 1.0f;
+}
+
+// Writes coverage bytes for the accumulation row 'accum' in the range [begin,end), zeroing 'accum' as it goes.
+// 'begin' must be a multiple of 4 and 'accum' / 'result' must be padded to a multiple of 4 beyond 'end'.
+void accumulateRow( float *accum, int32_t begin, int32_t end, bool evenOdd, uint8_t *result )
+{
+	int32_t x = begin;
+#if defined( CINDER_SIMD_SSE2 )
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 one = _mm_set1_ps( 1.0f ), half = _mm_set1_ps( 0.5f ), two = _mm_set1_ps( 2.0f ), scale = _mm_set1_ps( 255.0f );
+	__m128 offset = _mm_setzero_ps();
+	for( ; x < end; x += 4 ) {
+		__m128 v = _mm_loadu_ps( accum + x );
+		v = _mm_add_ps( v, _mm_castsi128_ps( _mm_slli_si128( _mm_castps_si128( v ), 4 ) ) );
+		v = _mm_add_ps( v, _mm_castsi128_ps( _mm_slli_si128( _mm_castps_si128( v ), 8 ) ) );
+		v = _mm_add_ps( v, offset );
+		offset = _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+		__m128 c = _mm_andnot_ps( signMask, v );
+		if( evenOdd ) {
+			__m128 wraps = _mm_cvtepi32_ps( _mm_cvttps_epi32( _mm_mul_ps( c, half ) ) );
+			c = _mm_sub_ps( c, _mm_mul_ps( wraps, two ) );
+			c = _mm_sub_ps( one, _mm_andnot_ps( signMask, _mm_sub_ps( one, c ) ) );
+		}
+		else
+			c = _mm_min_ps( c, one );
+
+		__m128i bytes = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( c, scale ), half ) );
+		bytes = _mm_packs_epi32( bytes, bytes );
+		bytes = _mm_packus_epi16( bytes, bytes );
+		int32_t packed = _mm_cvtsi128_si32( bytes );
+		memcpy( result + x, &packed, 4 );
+		_mm_storeu_ps( accum + x, _mm_setzero_ps() );
+	}
+#elif defined( CINDER_SIMD_NEON )
+	const float32x4_t zero = vdupq_n_f32( 0 ), one = vdupq_n_f32( 1.0f ), half = vdupq_n_f32( 0.5f );
+	float32x4_t offset = zero;
+	for( ; x < end; x += 4 ) {
+		float32x4_t v = vld1q_f32( accum + x );
+		v = vaddq_f32( v, vextq_f32( zero, v, 3 ) );
+		v = vaddq_f32( v, vextq_f32( zero, v, 2 ) );
+		v = vaddq_f32( v, offset );
+		offset = vdupq_n_f32( vgetq_lane_f32( v, 3 ) );
+
+		float32x4_t c = vabsq_f32( v );
+		if( evenOdd ) {
+			float32x4_t wraps = vcvtq_f32_s32( vcvtq_s32_f32( vmulq_f32( c, half ) ) );
+			c = vmlsq_n_f32( c, wraps, 2.0f );
+			c = vsubq_f32( one, vabsq_f32( vsubq_f32( one, c ) ) );
+		}
+		else
+			c = vminq_f32( c, one );
+
+		uint32x4_t words = vcvtq_u32_f32( vmlaq_n_f32( half, c, 255.0f ) );
+		uint16x4_t shorts = vmovn_u32( words );
+		uint8x8_t bytes = vmovn_u16( vcombine_u16( shorts, shorts ) );
+		uint32_t packed = vget_lane_u32( vreinterpret_u32_u8( bytes ), 0 );
+		memcpy( result + x, &packed, 4 );
+		vst1q_f32( accum + x, zero );
+	}
+#else
+	float acc = 0;
+	for( ; x < end; ++x ) {
+		acc += accum[x];
+		accum[x] = 0;
+		float c = fabs( acc );
+		if( evenOdd ) {
+			c -= 2 * math<float>::floor( c * 0.5f );
+			c = 1 - fabs( 1 - c );
+		}
+		else
+			c = std::min( c, 1.0f );
+		result[x] = static_cast<uint8_t>( c * 255 + 0.5f );
+	}
+#endif
+}
+
+} // anonymous namespace
+
+Rasterizer::Rasterizer( int32_t width, int32_t height )
+	: mWidth( std::max<int32_t>( 0, width ) ), mHeight( std::max<int32_t>( 0, height ) ), mApproximationScale( 1.0f ), mMaxThreads( 0 )
+{
+}
+
+void Rasterizer::addShape( const Shape2d &shape )
+{
+	for( const auto &contour : shape.getContours() )
+		addPath( contour );
+}
+
+void Rasterizer::addPath( const Path2d &path )
+{
+	if( path.empty() )
+		return;
+	addContour( path.subdivide( mApproximationScale * calcTransformScale( mTransform ) ) );
+}
+
+void Rasterizer::addPolyLine( const PolyLine2f &polyLine )
+{
+	addContour( polyLine.getPoints() );
+}
+
+void Rasterizer::addStroke( const Shape2d &shape, const StrokeStyle &style )
+{
+	for( const auto &contour : shape.getContours() )
+		addStroke( contour, style );
+}
+
+void Rasterizer::addStroke( const Path2d &path, const StrokeStyle &style )
+{
+	if( path.empty() )
+		return;
+	addStrokeContour( path.subdivide( mApproximationScale * calcTransformScale( mTransform ) ), path.isClosed(), style );
+}
+
+void Rasterizer::addStroke( const PolyLine2f &polyLine, const StrokeStyle &style )
+{
+	addStrokeContour( polyLine.getPoints(), polyLine.isClosed(), style );
+}
+
+void Rasterizer::addContour( const std::vector<vec2> &points, bool alreadyTransformed )
+{
+	if( points.size() < 2 )
+		return;
+
+	vec2 first = alreadyTransformed ? points[0] : vec2( mTransform * vec3( points[0], 1 ) );
+	vec2 prev = first;
+	for( size_t p = 1; p < points.size(); ++p ) {
+		vec2 cur = alreadyTransformed ? points[p] : vec2( mTransform * vec3( points[p], 1 ) );
+		addLine( prev, cur );
+		prev = cur;
+	}
+	addLine( prev, first );
+}
+
+void Rasterizer::addLine( vec2 p0, vec2 p1 )
+{
+	if( p0.y == p1.y )
+		return;
+	if( std::max( p0.y, p1.y ) <= 0 || std::min( p0.y, p1.y ) >= mHeight )
+		return;
+
+	// split at the left and right image boundaries; portions beyond them are clamped onto the boundary, which
+	// preserves their contribution to the running sum of every pixel to their right
+	const float width = (float)mWidth;
+	float t[4] = { 0, 0, 0, 1 };
+	int numT = 1;
+	if( ( p0.x < 0 ) != ( p1.x < 0 ) )
+		t[numT++] = ( 0 - p0.x ) / ( p1.x - p0.x );
+	if( ( p0.x > width ) != ( p1.x > width ) )
+		t[numT++] = ( width - p0.x ) / ( p1.x - p0.x );
+	t[numT++] = 1;
+	if( numT == 4 && t[1] > t[2] )
+		std::swap( t[1], t[2] );
+
+	for( int i = 0; i + 1 < numT; ++i ) {
+		vec2 a = p0 + ( p1 - p0 ) * t[i];
+		vec2 b = p0 + ( p1 - p0 ) * t[i + 1];
+		a.x = constrain( a.x, 0.0f, width );
+		b.x = constrain( b.x, 0.0f, width );
+		if( a.y == b.y )
+			continue;
+		Edge edge;
+		edge.mDir = ( a.y < b.y ) ? 1.0f : -1.0f;
+		edge.mP0 = ( a.y < b.y ) ? a : b;
+		edge.mP1 = ( a.y < b.y ) ? b : a;
+		mEdges.push_back( edge );
+	}
+}
+
+void Rasterizer::addConvexPolygon( std::initializer_list<vec2> points )
+{
+	// all stroke pieces share one orientation so that overlaps accumulate rather than cancel
+	std::vector<vec2> pts( points );
+	float area = 0;
+	for( size_t i = 0; i < pts.size(); ++i ) {
+		const vec2 &a = pts[i], &b = pts[( i + 1 ) % pts.size()];
+		area += a.x * b.y - b.x * a.y;
+	}
+	if( area < 0 )
+		std::reverse( pts.begin(), pts.end() );
+	addContour( pts );
+}
+
+void Rasterizer::addCircle( const vec2 &center, float radius )
+{
+	if( radius <= 0 )
+		return;
+	const float pixelRadius = radius * calcTransformScale( mTransform );
+	const float tolerance = 0.1f / std::max( mApproximationScale, 0.0001f );
+	int numSegments = 8;
+	if( pixelRadius > tolerance )
+		numSegments = constrain<int>( (int)math<float>::ceil( (float)M_PI / math<float>::acos( 1 - tolerance / pixelRadius ) ), 8, 1024 );
+
+	std::vector<vec2> pts( numSegments );
+	for( int s = 0; s < numSegments; ++s ) {
+		float angle = s * 2 * (float)M_PI / numSegments;
+		pts[s] = center + vec2( math<float>::cos( angle ), math<float>::sin( angle ) ) * radius;
+	}
+	addContour( pts );
+}
+
+void Rasterizer::addStrokeContour( const std::vector<vec2> &inputPoints, bool closed, const StrokeStyle &style )
+{
+	const float hw = style.getWidth() * 0.5f;
+	if( hw <= 0 || inputPoints.empty() )
+		return;
+
+	std::vector<vec2> points;
+	points.reserve( inputPoints.size() );
+	for( const auto &p : inputPoints ) {
+		if( points.empty() || p != points.back() )
+			points.push_back( p );
+	}
+	if( closed && points.size() > 1 && points.front() == points.back() )
+		points.pop_back();
+
+	if( points.size() == 1 ) {
+		if( style.getCap() == LINE_CAP_ROUND )
+			addCircle( points[0], hw );
+		else if( style.getCap() == LINE_CAP_SQUARE )
+			addConvexPolygon( { points[0] + vec2( -hw, -hw ), points[0] + vec2( hw, -hw ), points[0] + vec2( hw, hw ), points[0] + vec2( -hw, hw ) } );
+		return;
+	}
+
+	const size_t numPoints = points.size();
+	const size_t numSegments = closed ? numPoints : numPoints - 1;
+	auto perp = []( const vec2 &v ) { return vec2( -v.y, v.x ); };
+
+	for( size_t s = 0; s < numSegments; ++s ) {
+		const vec2 &a = points[s], &b = points[( s + 1 ) % numPoints];
+		vec2 n = perp( normalize( b - a ) ) * hw;
+		addConvexPolygon( { a + n, b + n, b - n, a - n } );
+	}
+
+	// joins
+	const size_t firstJoin = closed ? 0 : 1;
+	const size_t lastJoin = closed ? numPoints : numPoints - 1;
+	for( size_t j = firstJoin; j < lastJoin; ++j ) {
+		const vec2 &p = points[j];
+		vec2 d0 = normalize( p - points[( j + numPoints - 1 ) % numPoints] );
+		vec2 d1 = normalize( points[( j + 1 ) % numPoints] - p );
+		float cross = d0.x * d1.y - d0.y * d1.x;
+		if( fabs( cross ) < 1.0e-6f && dot( d0, d1 ) > 0 )
+			continue;
+
+		if( style.getJoin() == LINE_JOIN_ROUND ) {
+			addCircle( p, hw );
+			continue;
+		}
+
+		float side = ( cross > 0 ) ? -1.0f : 1.0f;
+		vec2 n0 = perp( d0 ) * side, n1 = perp( d1 ) * side;
+		if( style.getJoin() == LINE_JOIN_MITER ) {
+			vec2 m = n0 + n1;
+			float mLength = length( m );
+			float cosHalf = ( mLength > 0 ) ? dot( m / mLength, n0 ) : 0;
+			if( cosHalf > 0 && 1 / cosHalf <= style.getMiterLimit() ) {
+				addConvexPolygon( { p, p + n0 * hw, p + ( m / mLength ) * ( hw / cosHalf ), p + n1 * hw } );
+				continue;
+			}
+		}
+		addConvexPolygon( { p, p + n0 * hw, p + n1 * hw } );
+	}
+
+	// caps
+	if( ! closed ) {
+		const vec2 ends[2] = { points.front(), points.back() };
+		const vec2 dirs[2] = { normalize( points[0] - points[1] ), normalize( points[numPoints - 1] - points[numPoints - 2] ) };
+		for( int e = 0; e < 2; ++e ) {
+			if( style.getCap() == LINE_CAP_ROUND )
+				addCircle( ends[e], hw );
+			else if( style.getCap() == LINE_CAP_SQUARE ) {
+				vec2 n = perp( dirs[e] ) * hw, d = dirs[e] * hw;
+				addConvexPolygon( { ends[e] + n, ends[e] + n + d, ends[e] - n + d, ends[e] - n } );
+			}
+		}
+	}
+}
+
+namespace {
+
+// Deposits the signed area of 'edge' for the rows in [bandY0,bandY1) into 'accum', whose rows are 'stride' floats apart
+void drawEdge( float *accum, size_t stride, int32_t bandY0, int32_t bandY1, float width, const vec2 &p0, const vec2 &p1, float dir )
+{
+	const float dxdy = ( p1.x - p0.x ) / ( p1.y - p0.y );
+	const int32_t yBegin = std::max<int32_t>( bandY0, (int32_t)math<float>::floor( p0.y ) );
+	const int32_t yEnd = std::min<int32_t>( bandY1, (int32_t)math<float>::ceil( p1.y ) );
+	float x = p0.x + ( std::max( (float)yBegin, p0.y ) - p0.y ) * dxdy;
+
+	for( int32_t y = yBegin; y < yEnd; ++y ) {
+		float *row = accum + ( y - bandY0 ) * stride;
+		const float dy = std::min( (float)( y + 1 ), p1.y ) - std::max( (float)y, p0.y );
+		const float xNext = constrain( x + dxdy * dy, 0.0f, width );
+		const float d = dy * dir;
+		const float x0 = std::min( x, xNext ), x1 = std::max( x, xNext );
+		const float x0Floor = math<float>::floor( x0 );
+		const int32_t x0i = (int32_t)x0Floor;
+		const float x1Ceil = math<float>::ceil( x1 );
+		const int32_t x1i = (int32_t)x1Ceil;
+		if( x1i <= x0i + 1 ) {
+			// the edge stays within a single pixel on this row
+			const float xmf = 0.5f * ( x + xNext ) - x0Floor;
+			row[x0i] += d - d * xmf;
+			row[x0i + 1] += d * xmf;
+		}
+		else {
+			const float s = 1.0f / ( x1 - x0 );
+			const float x0f = x0 - x0Floor;
+			const float a0 = 0.5f * s * ( 1 - x0f ) * ( 1 - x0f );
+			const float x1f = x1 - x1Ceil + 1;
+			const float am = 0.5f * s * x1f * x1f;
+			row[x0i] += d * a0;
+			if( x1i == x0i + 2 )
+				row[x0i + 1] += d * ( 1 - a0 - am );
+			else {
+				const float a1 = s * ( 1.5f - x0f );
+				row[x0i + 1] += d * ( a1 - a0 );
+				for( int32_t xi = x0i + 2; xi < x1i - 1; ++xi )
+					row[xi] += d * s;
+				const float a2 = a1 + ( x1i - x0i - 3 ) * s;
+				row[x1i - 1] += d * ( 1 - a2 - am );
+			}
+			row[x1i] += d * am;
+		}
+		x = xNext;
+	}
+}
+
+} // anonymous namespace
+
+template<typename SpanFnT>
+void Rasterizer::rasterize( FillRule fillRule, SpanFnT &&spanFn ) const
+{
+	if( mEdges.empty() || mWidth == 0 || mHeight == 0 )
+		return;
+
+	// bin the edges by the bands of rows they touch, tracking the horizontal extent of each band's edges
+	const int32_t numBands = ( mHeight + BAND_HEIGHT - 1 ) / BAND_HEIGHT;
+	const float width = (float)mWidth;
+	std::vector<Band> bands( numBands, Band{ {}, width, 0 } );
+	for( size_t e = 0; e < mEdges.size(); ++e ) {
+		const Edge &edge = mEdges[e];
+		int32_t rowBegin = std::max<int32_t>( 0, (int32_t)math<float>::floor( edge.mP0.y ) );
+		int32_t rowEnd = std::min<int32_t>( mHeight, (int32_t)math<float>::ceil( edge.mP1.y ) );
+		for( int32_t b = rowBegin / BAND_HEIGHT; b * BAND_HEIGHT < rowEnd; ++b ) {
+			Band &band = bands[b];
+			band.mEdges.push_back( (uint32_t)e );
+			band.mMinX = std::min( band.mMinX, std::min( edge.mP0.x, edge.mP1.x ) );
+			band.mMaxX = std::max( band.mMaxX, std::max( edge.mP0.x, edge.mP1.x ) );
+		}
+	}
+
+	// only the bands touched by edges are rendered; the pixels they span estimate the work of each
+	std::vector<uint32_t> activeBands;
+	size_t numPixels = 0;
+	for( int32_t b = 0; b < numBands; ++b ) {
+		if( bands[b].mEdges.empty() )
+			continue;
+		activeBands.push_back( (uint32_t)b );
+		numPixels += (size_t)std::max( 1.0f, bands[b].mMaxX - bands[b].mMinX ) * BAND_HEIGHT;
+	}
+	if( activeBands.empty() )
+		return;
+
+	// rows are padded so that SIMD accumulation can always consume 4 columns at a time
+	const size_t stride = ( mWidth + 2 + 3 ) & ~3;
+	const bool evenOdd = fillRule == FILL_RULE_EVENODD;
+
+	// small shapes are not worth the threads; each thread receives at least PARALLEL_MIN_PIXELS worth of bands
+	const size_t pixelsPerBand = std::max<size_t>( 1, numPixels / activeBands.size() );
+	const size_t minBandsPerThread = ( PARALLEL_MIN_PIXELS + pixelsPerBand - 1 ) / pixelsPerBand;
+
+	parallelFor( 0, activeBands.size(), minBandsPerThread, [&]( size_t activeBegin, size_t activeEnd ) {
+		std::vector<float> accum( stride * BAND_HEIGHT, 0.0f );
+		std::vector<uint8_t> coverage( stride );
+		for( size_t a = activeBegin; a < activeEnd; ++a ) {
+			const Band &band = bands[activeBands[a]];
+			const int32_t bandY0 = (int32_t)activeBands[a] * BAND_HEIGHT;
+			const int32_t bandY1 = std::min( bandY0 + BAND_HEIGHT, mHeight );
+			for( uint32_t e : band.mEdges ) {
+				const Edge &edge = mEdges[e];
+				drawEdge( accum.data(), stride, bandY0, bandY1, width, edge.mP0, edge.mP1, edge.mDir );
+			}
+
+			// columns outside of the band's edges receive no deposits; the running sum there is zero
+			const int32_t spanBegin = std::max<int32_t>( 0, (int32_t)math<float>::floor( band.mMinX ) ) & ~3;
+			const int32_t spanEnd = std::min<int32_t>( (int32_t)stride, (int32_t)math<float>::ceil( band.mMaxX ) + 2 );
+			for( int32_t y = bandY0; y < bandY1; ++y ) {
+				accumulateRow( accum.data() + ( y - bandY0 ) * stride, spanBegin, spanEnd, evenOdd, coverage.data() );
+				spanFn( y, std::min( spanBegin, mWidth ), std::min( spanEnd, mWidth ), coverage.data() );
+			}
+		}
+	}, mMaxThreads );
+}
+
+void Rasterizer::renderCoverage( Channel8u *result, FillRule fillRule ) const
+{
+	ip::fill( result, (uint8_t)0 );
+	const int32_t height = std::min( mHeight, result->getHeight() );
+	const int32_t width = std::min( mWidth, result->getWidth() );
+	const uint8_t inc = result->getIncrement();
+	rasterize( fillRule, [&]( int32_t y, int32_t x0, int32_t x1, const uint8_t *coverage ) {
+		if( y >= height )
+			return;
+		uint8_t *dst = result->getData( x0, y );
+		for( int32_t x = x0; x < std::min( x1, width ); ++x, dst += inc )
+			*dst = coverage[x];
+	} );
+}
+
+void Rasterizer::fill( Channel8u *channel, uint8_t value, FillRule fillRule ) const
+{
+	const int32_t height = std::min( mHeight, channel->getHeight() );
+	const int32_t width = std::min( mWidth, channel->getWidth() );
+	const uint8_t inc = channel->getIncrement();
+	rasterize( fillRule, [&]( int32_t y, int32_t x0, int32_t x1, const uint8_t *coverage ) {
+		if( y >= height )
+			return;
+		uint8_t *dst = channel->getData( x0, y );
+		for( int32_t x = x0; x < std::min( x1, width ); ++x, dst += inc ) {
+			const int32_t c = coverage[x];
+			if( c == 255 )
+				*dst = value;
+			else if( c )
+				*dst = (uint8_t)( ( *dst * ( 255 - c ) + value * c + 127 ) / 255 );
+		}
+	} );
+}
+
+void Rasterizer::fill( Surface8u *surface, const ColorA &color, FillRule fillRule ) const
+{
+	const int32_t height = std::min( mHeight, surface->getHeight() );
+	const int32_t width = std::min( mWidth, surface->getWidth() );
+	const uint8_t inc = surface->getPixelInc();
+	const uint8_t rOff = surface->getRedOffset(), gOff = surface->getGreenOffset(), bOff = surface->getBlueOffset();
+	const bool hasAlpha = surface->hasAlpha();
+	const uint8_t aOff = hasAlpha ? surface->getAlphaOffset() : 0;
+	const ColorA8u src( color );
+	const int32_t srcAlpha = src.a;
+	if( srcAlpha == 0 )
+		return;
+
+	rasterize( fillRule, [&]( int32_t y, int32_t x0, int32_t x1, const uint8_t *coverage ) {
+		if( y >= height )
+			return;
+		uint8_t *dst = surface->getData( ivec2( x0, y ) );
+		for( int32_t x = x0; x < std::min( x1, width ); ++x, dst += inc ) {
+			const int32_t c = coverage[x];
+			if( ! c )
+				continue;
+			const int32_t a = ( c * srcAlpha + 127 ) / 255;
+			dst[rOff] = (uint8_t)( ( dst[rOff] * ( 255 - a ) + src.r * a + 127 ) / 255 );
+			dst[gOff] = (uint8_t)( ( dst[gOff] * ( 255 - a ) + src.g * a + 127 ) / 255 );
+			dst[bOff] = (uint8_t)( ( dst[bOff] * ( 255 - a ) + src.b * a + 127 ) / 255 );
+			if( hasAlpha )
+				dst[aOff] = (uint8_t)( ( dst[aOff] * ( 255 - a ) + 255 * a + 127 ) / 255 );
+		}
+	} );
+}
+
+void rasterize( Channel8u *channel, const Shape2d &shape, uint8_t value, Rasterizer::FillRule fillRule, const mat3 &transform )
+{
+	Rasterizer rasterizer( channel->getWidth(), channel->getHeight() );
+	rasterizer.setTransform( transform );
+	rasterizer.addShape( shape );
+	rasterizer.fill( channel, value, fillRule );
+}
+
+void rasterize( Channel8u *channel, const Path2d &path, uint8_t value, Rasterizer::FillRule fillRule, const mat3 &transform )
+{
+	Rasterizer rasterizer( channel->getWidth(), channel->getHeight() );
+	rasterizer.setTransform( transform );
+	rasterizer.addPath( path );
+	rasterizer.fill( channel, value, fillRule );
+}
+
+void rasterize( Surface8u *surface, const Shape2d &shape, const ColorA &color, Rasterizer::FillRule fillRule, const mat3 &transform )
+{
+	Rasterizer rasterizer( surface->getWidth(), surface->getHeight() );
+	rasterizer.setTransform( transform );
+	rasterizer.addShape( shape );
+	rasterizer.fill( surface, color, fillRule );
+}
+
+void rasterize( Surface8u *surface, const Path2d &path, const ColorA &color, Rasterizer::FillRule fillRule, const mat3 &transform )
+{
+	Rasterizer rasterizer( surface->getWidth(), surface->getHeight() );
+	rasterizer.setTransform( transform );
+	rasterizer.addPath( path );
+	rasterizer.fill( surface, color, fillRule );
+}
+
+void rasterizeStroke( Channel8u *channel, const Shape2d &shape, const Rasterizer::StrokeStyle &style, uint8_t value, const mat3 &transform )
+{
+	Rasterizer rasterizer( channel->getWidth(), channel->getHeight() );
+	rasterizer.setTransform( transform );
+	rasterizer.addStroke( shape, style );
+	rasterizer.fill( channel, value, Rasterizer::FILL_RULE_NONZERO );
+}
+
+void rasterizeStroke( Surface8u *surface, const Shape2d &shape, const Rasterizer::StrokeStyle &style, const ColorA &color, const mat3 &transform )
+{
+	Rasterizer rasterizer( surface->getWidth(), surface->getHeight() );
+	rasterizer.setTransform( transform );
+	rasterizer.addStroke( shape, style );
+	rasterizer.fill( surface, color, Rasterizer::FILL_RULE_NONZERO );
+}
+
+} } // namespace cinder::ip
@@ -32,6 +32,8 @@
 #include "cinder/Log.h"
 #include "cinder/Unicode.h"
 
+#include "rapidxml/rapidxml.hpp"
+
 using namespace std;
 
 namespace cinder { namespace svg {
@@ -39,75 +41,144 @@ namespace cinder { namespace svg {
 
 namespace {
 
+// Returns the value of the attribute \a name of \a xml, or nullptr when it has none
+const char* findAttribute( const rapidxml::xml_node<> &xml, const char *name )
+{
+	const rapidxml::xml_attribute<> *attr = xml.first_attribute( name );
+	return attr ? attr->value() : nullptr;
+}
+
+// Returns the value of the attribute \a name of \a xml, or \a defaultValue when it has none
+string getAttribute( const rapidxml::xml_node<> &xml, const char *name, const char *defaultValue = "" )
+{
+	const char *value = findAttribute( xml, name );
+	return value ? value : defaultValue;
+}
+
+// Returns the attribute \a name of \a xml converted with fromString(), or \a defaultValue when it has none
+float getAttributeFloat( const rapidxml::xml_node<> &xml, const char *name, float defaultValue )
+{
+	const char *value = findAttribute( xml, name );
+	return value ? fromString<float>( value ) : defaultValue;
+}
+
+bool isElement( const rapidxml::xml_node<> &xml, const char *name )
+{
+	return ( xml.type() == rapidxml::node_element ) && ( strcmp( xml.name(), name ) == 0 );
+}
 
 bool isNumeric( char c )
 {
 	return ( c >= '0' && c <= '9' ) || c == '.' || c == '-' || c == 'e' || c == 'E' || c == '+';
 }
 
-float parseFloat( const char **sInOut )
+// Parses a decimal number beginning at \a s in place, returning the position following it, or \a s itself when there are
+// no digits to parse. Exponents are only consumed when followed by digits, so that unit suffixes like "em" and "ex" are
+// left intact.
+const char* parseNumber( const char *s, float *result )
 {
-	char temp[256];
-	size_t i = 0;
-	const char *s = *sInOut;
-	while( *s && (isspace(*s) || *s == ',') )
+	static const double sPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char *begin = s;
+	bool negative = false;
+	while( *s == '-' || *s == '+' ) {
+		negative = ( *s == '-' ) != negative;
 		s++;
-	if( ! s )
-		throw PathParseExc();
-	if( isNumeric( *s ) ) {
-		while( *s == '-' || *s == '+' ) {
-			if( i < sizeof(temp) )
-				temp[i++] = *s;
-			s++;
+	}
+
+	const char *digitsBegin = s;
+	uint64_t mantissa = 0;
+	int exponent = 0, digits = 0;
+	for( ; *s >= '0' && *s <= '9'; ++s ) {
+		if( digits < 19 ) {
+			mantissa = mantissa * 10 + ( *s - '0' );
+			if( mantissa ) ++digits;
 		}
-		bool parsingExponent = false, startingExponent;
-		bool seenDecimal = false;
-		while( *s && ( parsingExponent || (*s != '-' && *s != '+')) && isNumeric(*s) ) {
-			startingExponent = false;
-			if( *s == '.' && seenDecimal )
-				break;
-			else if( *s == '.' )
-				seenDecimal = true;
-			if( i < sizeof(temp) )
-				temp[i++] = *s;
-			if( *s == 'e' || *s == 'E' ) {
-				parsingExponent = true;
-				startingExponent = true;
+		else
+			++exponent;
+	}
+	bool hasDigits = s != digitsBegin;
+	if( *s == '.' ) {
+		hasDigits = hasDigits || ( s[1] >= '0' && s[1] <= '9' );
+		for( ++s; *s >= '0' && *s <= '9'; ++s ) {
+			if( digits < 19 ) {
+				mantissa = mantissa * 10 + ( *s - '0' );
+				if( mantissa ) ++digits;
+				--exponent;
 			}
-			else
-				parsingExponent = false;
-			s++;
 		}
-		if( startingExponent ) { // if we got a false positive on an exponent, for example due to "ex" or "em" unit, back up one
-			--i;
-			--s;
+	}
+	// a sign, a decimal point or an exponent alone isn't a number
+	if( ! hasDigits ) {
+		*result = 0;
+		return begin;
+	}
+	if( *s == 'e' || *s == 'E' ) {
+		const char *e = s + 1;
+		bool negativeExponent = false;
+		if( *e == '-' || *e == '+' )
+			negativeExponent = *e++ == '-';
+		if( *e >= '0' && *e <= '9' ) {
+			int explicitExponent = 0;
+			for( ; *e >= '0' && *e <= '9'; ++e )
+				explicitExponent = std::min( explicitExponent * 10 + ( *e - '0' ), 10000 );
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			s = e;
 		}
-		temp[i] = 0;
-		float result = (float)atof( temp );
-		*sInOut = s;
-		return result;
 	}
-	else
+
+	double value = (double)mantissa;
+	if( mantissa == 0 )
+		value = 0;
+	else if( exponent < 0 && exponent >= -22 )
+		value /= sPowersOf10[-exponent];
+	else if( exponent > 0 && exponent <= 22 )
+		value *= sPowersOf10[exponent];
+	else if( exponent != 0 )
+		value *= std::pow( 10.0, (double)exponent );
+
+	*result = (float)( negative ? -value : value );
+	return s;
+}
+
+float parseFloat( const char **sInOut )
+{
+	const char *s = *sInOut;
+	while( *s && (isspace(*s) || *s == ',') )
+		s++;
+	if( ! isNumeric( *s ) )
+		throw FloatParseExc();
+
+	// leaving a malformed number in place would stall callers that loop until the input ends
+	float result;
+	const char *end = parseNumber( s, &result );
+	if( end == s )
 		throw FloatParseExc();
+	*sInOut = end;
+	return result;
 }
 
-// parses float from comma-separated parenthetical list
-vector<float> parseFloatList( const char **c )
+// parses up to \a maxCount floats from comma-separated parenthetical list into \a result, returning the number parsed
+int parseFloatList( const char **c, float *result, int maxCount )
 {
-	vector<float> result;
+	int count = 0;
 	while( **c && isspace( **c ) ) (*c)++;
 	if( **c != '(' )
-		return result; // failure
+		return 0; // failure
 	(*c)++;
 	do {
-		result.push_back( parseFloat( c ) );
+		float f = parseFloat( c );
+		if( count < maxCount )
+			result[count] = f;
+		++count;
 		while( **c && ( **c == ',' || isspace( **c ) ) ) (*c)++;
 	} while( **c && **c != ')' );
 	
 	// get rid of trailing closing paren
 	if( **c ) (*c)++;
 	
-	return result;
+	return count;
 }
 
 vector<Value> parseValueList( const char **c, bool requireParens = true )
@@ -281,15 +352,15 @@ Style::Style()
 	clear();
 }
 
-Style::Style( const XmlTree &xml, const Node *parent )
+Style::Style( const rapidxml::xml_node<> &xml, const Node *parent )
 {
 	clear();
 
-	for( list<XmlTree::Attr>::const_iterator attIt = xml.getAttributes().begin(); attIt != xml.getAttributes().end(); ++attIt ) {
-		if( attIt->getName() == "style" )
-			parseStyleAttribute( attIt->getValue(), parent );
+	for( const rapidxml::xml_attribute<> *attr = xml.first_attribute(); attr; attr = attr->next_attribute() ) {
+		if( strcmp( attr->name(), "style" ) == 0 )
+			parseStyleAttribute( attr->value(), parent );
 		else
-			parseProperty( attIt->getName(), attIt->getValue(), parent );
+			parseProperty( attr->name(), attr->value(), parent );
 	}
 }
 
@@ -615,14 +686,14 @@ Value Value::parse( const std::string &s )
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Node
-Node::Node( Node *parent, const XmlTree &xml )
+Node::Node( Node *parent, const rapidxml::xml_node<> &xml )
 	: mParent( parent ), mStyle( xml, this ), mBoundingBoxCached( false )
 {
 	mSpecifiesTransform = false;
-	mId = xml["id"];
-	if( xml.hasAttribute( "transform" ) ) {
+	mId = getAttribute( xml, "id" );
+	if( const char *transform = findAttribute( xml, "transform" ) ) {
 		mSpecifiesTransform = true;
-		mTransform = parseTransform( xml["transform"] );
+		mTransform = parseTransform( transform );
 	}
 	else
 		mTransform = mat3();
@@ -820,13 +891,14 @@ bool Node::parseTransformComponent( const char **c, mat3 *result )
 		(*c)++;
 	
 	mat3 m;
+	float v[6];
 	if( ! strncmp( *c, "scale", 5 ) ) {
 		*c += 5; //strlen( "scale" );
-		vector<float> v = parseFloatList( c );
-		if( v.size() == 1 ) {
+		int n = parseFloatList( c, v, 6 );
+		if( n == 1 ) {
 			m = glm::scale( mat3(), vec2( v[0] ) );
 		}
-		else if( v.size() == 2 ) {
+		else if( n == 2 ) {
 			m = glm::scale( mat3(), vec2( v[0], v[1] ) );
 		}
 		else
@@ -834,10 +906,10 @@ bool Node::parseTransformComponent( const char **c, mat3 *result )
 	}
 	else if( ! strncmp( *c, "translate", 9 ) ) {
 		*c += 9; //strlen( "translate" );
-		vector<float> v = parseFloatList( c );
-		if( v.size() == 1 )
+		int n = parseFloatList( c, v, 6 );
+		if( n == 1 )
 			m = glm::translate( mat3(), vec2( v[0], 0 ) );
-		else if( v.size() == 2 ) {
+		else if( n == 2 ) {
 			m = glm::translate( mat3(), vec2( v[0], v[1] ) );
 		}
 		else
@@ -845,14 +917,14 @@ bool Node::parseTransformComponent( const char **c, mat3 *result )
 	}
 	else if( ! strncmp( *c, "rotate", 6 ) ) {
 		*c += 6; //strlen( "rotate" );
-		vector<float> v = parseFloatList( c );
-		if( v.size() == 1 ) {
+		int n = parseFloatList( c, v, 6 );
+		if( n == 1 ) {
 			float a = toRadians( v[0] );
 			m = glm::rotate( mat3(), a );
 			//m33[0] = math<float>::cos( a ); m33[1] = math<float>::sin( a );
 			//m33[3] = -math<float>::sin( a ); m33[4] = math<float>::cos( a );
 		}
-		else if( v.size() == 3 ) { // rotate around point
+		else if( n == 3 ) { // rotate around point
 			float a = toRadians( v[0] );
 			vec2 origin( v[1], v[2] );
 			m = glm::translate( mat3(), origin );
@@ -864,16 +936,16 @@ bool Node::parseTransformComponent( const char **c, mat3 *result )
 	}
 	else if( ! strncmp( *c, "matrix", 6 ) ) {
 		*c += 6; //strlen( "matrix" );
-		vector<float> v = parseFloatList( c );
-		if( v.size() == 6 )
+		int n = parseFloatList( c, v, 6 );
+		if( n == 6 )
 			m = mat3( v[0], v[1], 0, v[2], v[3], 0, v[4], v[5], 1 );
 		else
 			throw TransformParseExc();
 	}
 	else if( ! strncmp( *c, "skewX", 5 ) ) {
 		*c += 5; //strlen( "skewX" );
-		vector<float> v = parseFloatList( c );
-		if( v.size() == 1 ) {
+		int n = parseFloatList( c, v, 6 );
+		if( n == 1 ) {
 			float a = toRadians( v[0] );
 			m = glm::shearY2D( mat3(), tan( a ) );
 		}
@@ -882,8 +954,8 @@ bool Node::parseTransformComponent( const char **c, mat3 *result )
 	}
 	else if( ! strncmp( *c, "skewY", 5 ) ) {
 		*c += 5; //strlen( "skewY" );
-		vector<float> v = parseFloatList( c );
-		if( v.size() == 1 ) {
+		int n = parseFloatList( c, v, 6 );
+		if( n == 1 ) {
 			float a = toRadians( v[0] );
 			//m33[1] = math<float>::tan( a );
 			m = glm::shearX2D( mat3(), tan( a ) );
@@ -1009,16 +1081,16 @@ mat3 Node::getTransformAbsolute() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Gradient
-Gradient::Gradient( Node *parent, const XmlTree &xml )
+Gradient::Gradient( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml ), mUseObjectBoundingBox( true ), mSpecifiesTransform( false )
 {
 	parse( parent, xml );
 }
 
-void Gradient::parse( const Node *parent, const XmlTree &xml )
+void Gradient::parse( const Node *parent, const rapidxml::xml_node<> &xml )
 {
-	if( xml.hasAttribute( "xlink:href" ) ) {
-		string ref = xml.getAttributeValue<string>( "xlink:href" );
+	if( const char *href = findAttribute( xml, "xlink:href" ) ) {
+		string ref = href;
 		if( ref.size() > 1 ) {
 			if( ref[0] == '#' ) {
 				string elementId = ref.substr( 1, string::npos );
@@ -1029,14 +1101,14 @@ void Gradient::parse( const Node *parent, const XmlTree &xml )
 			}
 		}
 	}
-	for( XmlTree::ConstIter stopsIt = xml.begin( "stop" ); stopsIt != xml.end(); ++stopsIt ) {
-		mStops.push_back( Stop( parent, *stopsIt ) );
+	for( const rapidxml::xml_node<> *stop = xml.first_node( "stop" ); stop; stop = stop->next_sibling( "stop" ) ) {
+		mStops.push_back( Stop( parent, *stop ) );
 	}
-	if( xml.hasAttribute( "gradientUnits" ) )
-		mUseObjectBoundingBox = xml.getAttributeValue<string>( "gradientUnits" ) != string("userSpaceOnUse");
-	if( xml.hasAttribute( "gradientTransform" ) ) {
+	if( const char *units = findAttribute( xml, "gradientUnits" ) )
+		mUseObjectBoundingBox = strcmp( units, "userSpaceOnUse" ) != 0;
+	if( const char *transform = findAttribute( xml, "gradientTransform" ) ) {
 		mSpecifiesTransform = true;
-		mTransform = parseTransform( xml.getAttributeValue<string>( "gradientTransform" ) );
+		mTransform = parseTransform( transform );
 	}
 }
 
@@ -1052,22 +1124,22 @@ void Gradient::copyAttributesFrom( const Gradient &rhs )
 	}
 }
 
-Gradient::Stop::Stop( const Node *parent, const XmlTree &xml )
+Gradient::Stop::Stop( const Node *parent, const rapidxml::xml_node<> &xml )
 	: mOffset( 0 ), mSpecifiesColor( false ), mSpecifiesOpacity( false )
 {
-	if( xml.hasAttribute( "offset" ) )
-		mOffset = Value::parse( xml.getAttributeValue<string>( "offset" ) ).asUser();
-	if( xml.hasAttribute( "stop-color" ) )
-		mColor = Node::parsePaint( xml.getAttributeValue<string>( "stop-color" ).c_str(), &mSpecifiesColor, parent ).getColor();
-	if( xml.hasAttribute( "stop-opacity" ) ) {
+	if( const char *offset = findAttribute( xml, "offset" ) )
+		mOffset = Value::parse( &offset ).asUser();
+	if( const char *stopColor = findAttribute( xml, "stop-color" ) )
+		mColor = Node::parsePaint( stopColor, &mSpecifiesColor, parent ).getColor();
+	if( const char *stopOpacity = findAttribute( xml, "stop-opacity" ) ) {
 		mSpecifiesOpacity = true;
-		mColor.a = (uint8_t)(Value::parse( xml.getAttributeValue<string>( "stop-opacity" ) ).asUser() * 255);
+		mColor.a = (uint8_t)(Value::parse( &stopOpacity ).asUser() * 255);
 	}
-	if( xml.hasAttribute( "style" ) ) {
-		string stopColorString = Node::findStyleValue( xml.getAttributeValue<string>( "style" ), "stop-color" );
+	if( const char *style = findAttribute( xml, "style" ) ) {
+		string stopColorString = Node::findStyleValue( style, "stop-color" );
 		if( ! stopColorString.empty() )
 			mColor = Node::parsePaint( stopColorString.c_str(), &mSpecifiesColor, parent ).getColor();	
-		string stopOpacityString = Node::findStyleValue( xml.getAttributeValue<string>( "style" ), "stop-opacity" );
+		string stopOpacityString = Node::findStyleValue( style, "stop-opacity" );
 		if( ! stopOpacityString.empty() ) {
 			mColor.a = (uint8_t)(Value::parse( stopOpacityString ).asUser() * 255);
 		}
@@ -1095,18 +1167,18 @@ Paint Gradient::asPaint() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // LinearGradient
-LinearGradient::LinearGradient( Node *parent, const XmlTree &xml )
+LinearGradient::LinearGradient( Node *parent, const rapidxml::xml_node<> &xml )
 	: Gradient( parent, xml )
 {
 	parse( xml );
 }
 
-void LinearGradient::parse( const XmlTree &xml )
+void LinearGradient::parse( const rapidxml::xml_node<> &xml )
 {
-	mCoords0.x = xml.getAttributeValue( "x1", 0.0f );
-	mCoords0.y = xml.getAttributeValue( "y1", 0.0f );
-	mCoords1.x = xml.getAttributeValue( "x2", 1.0f );
-	mCoords1.y = xml.getAttributeValue( "y2", 0.0f );
+	mCoords0.x = getAttributeFloat( xml, "x1", 0.0f );
+	mCoords0.y = getAttributeFloat( xml, "y1", 0.0f );
+	mCoords1.x = getAttributeFloat( xml, "x2", 1.0f );
+	mCoords1.y = getAttributeFloat( xml, "y2", 0.0f );
 }
 
 Paint LinearGradient::asPaint() const
@@ -1118,19 +1190,19 @@ Paint LinearGradient::asPaint() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // RadialGradient
-RadialGradient::RadialGradient( Node *parent, const XmlTree &xml )
+RadialGradient::RadialGradient( Node *parent, const rapidxml::xml_node<> &xml )
 	: Gradient( parent, xml )
 {
 	parse( xml );
 }
 
-void RadialGradient::parse( const XmlTree &xml )
+void RadialGradient::parse( const rapidxml::xml_node<> &xml )
 {
-	mCoords0.x = xml.getAttributeValue( "cx", 0.5f );
-	mCoords0.y = xml.getAttributeValue( "cy", 0.5f );
-	mCoords1.x = xml.getAttributeValue( "fx", mCoords0.x );
-	mCoords1.y = xml.getAttributeValue( "fy", mCoords0.y );
-	mRadius = xml.getAttributeValue( "r", 0.5f );
+	mCoords0.x = getAttributeFloat( xml, "cx", 0.5f );
+	mCoords0.y = getAttributeFloat( xml, "cy", 0.5f );
+	mCoords1.x = getAttributeFloat( xml, "fx", mCoords0.x );
+	mCoords1.y = getAttributeFloat( xml, "fy", mCoords0.y );
+	mRadius = getAttributeFloat( xml, "r", 0.5f );
 }
 
 Paint RadialGradient::asPaint() const
@@ -1143,12 +1215,12 @@ Paint RadialGradient::asPaint() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Circle
-Circle::Circle( Node *parent, const XmlTree &xml )
+Circle::Circle( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	mCenter.x = xml.getAttributeValue( "cx", 0.0f );
-	mCenter.y = xml.getAttributeValue( "cy", 0.0f );
-	mRadius = xml.getAttributeValue( "r", 0.0f );	
+	mCenter.x = getAttributeFloat( xml, "cx", 0.0f );
+	mCenter.y = getAttributeFloat( xml, "cy", 0.0f );
+	mRadius = getAttributeFloat( xml, "r", 0.0f );	
 }
 
 void Circle::renderSelf( Renderer &renderer ) const
@@ -1165,13 +1237,13 @@ Shape2d Circle::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Ellipse
-Ellipse::Ellipse( Node *parent, const XmlTree &xml )
+Ellipse::Ellipse( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	mCenter.x = xml.getAttributeValue( "cx", 0.0f );
-	mCenter.y = xml.getAttributeValue( "cy", 0.0f );
-	mRadiusX = xml.getAttributeValue( "rx", 0.0f );
-	mRadiusY = xml.getAttributeValue( "ry", 0.0f );
+	mCenter.x = getAttributeFloat( xml, "cx", 0.0f );
+	mCenter.y = getAttributeFloat( xml, "cy", 0.0f );
+	mRadiusX = getAttributeFloat( xml, "rx", 0.0f );
+	mRadiusY = getAttributeFloat( xml, "ry", 0.0f );
 }
 
 void Ellipse::renderSelf( Renderer &renderer ) const
@@ -1268,42 +1340,6 @@ void ellipticalArc( Shape2d &path, float x1, float y1, float x2, float y2, float
     }
 }
 
-static const char* getNextPathItem(const char* s, char it[64] )
-{
-	int i = 0;
-	it[0] = '\0';
-	// Skip white spaces and commas
-	while( *s && (isspace(*s) || *s == ',') )
-		s++;
-	if( ! *s )
-		return s;
-	if( isNumeric(*s) ) {
-		while( *s == '-' || *s == '+' ) {
-			if( i < 63 )
-				it[i++] = *s;
-			s++;
-		}
-		bool parsingExponent = false;
-		while( *s && ( parsingExponent || (*s != '-' && *s != '+')) && isNumeric(*s) ) {
-			if( i < 63 )
-				it[i++] = *s;
-			if( *s == 'e' || *s == 'E' )
-				parsingExponent = true;
-			else
-				parsingExponent = false;
-			s++;
-		}
-		it[i] = '\0';
-	}
-	else {
-		it[0] = *s++;
-		it[1] = '\0';
-		return s;
-	}
-
-	return s;
-}
-
 char readNextCommand( const char **sInOut )
 {
 	const char *s = *sInOut;
@@ -1490,11 +1526,11 @@ Shape2d parsePath( const std::string &p )
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Path
-Path::Path( Node *parent, const XmlTree &xml )
+Path::Path( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	std::string p = xml.getAttributeValue<string>( "d", "" );
-	if( ! p.empty() ) {
+	const char *p = findAttribute( xml, "d" );
+	if( p && *p ) {
 		mPath = parsePath( p );
 	}
 }
@@ -1513,13 +1549,13 @@ void Path::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Line
-Line::Line( Node *parent, const XmlTree &xml )
+Line::Line( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	mPoint1.x = xml.getAttributeValue<float>( "x1", 0 );
-	mPoint1.y = xml.getAttributeValue<float>( "y1", 0 );	
-	mPoint2.x = xml.getAttributeValue<float>( "x2", 0 );
-	mPoint2.y = xml.getAttributeValue<float>( "y2", 0 );	
+	mPoint1.x = getAttributeFloat( xml, "x1", 0 );
+	mPoint1.y = getAttributeFloat( xml, "y1", 0 );
+	mPoint2.x = getAttributeFloat( xml, "x2", 0 );
+	mPoint2.y = getAttributeFloat( xml, "y2", 0 );
 }
 
 void Line::renderSelf( Renderer &renderer ) const
@@ -1537,23 +1573,23 @@ Shape2d	Line::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Rect
-Rect::Rect( Node *parent, const XmlTree &xml )
+Rect::Rect( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
 	float width = 0, height = 0;
 	
-	if( xml.hasAttribute( "x" ) )
-		mRect.x1 = Value::parse( xml["x"] ).asUser();
+	if( const char *x = findAttribute( xml, "x" ) )
+		mRect.x1 = Value::parse( &x ).asUser();
 	else
 		mRect.x1 = 0;
-	if( xml.hasAttribute( "y" ) )
-		mRect.y1 = Value::parse( xml["y"] ).asUser();
+	if( const char *y = findAttribute( xml, "y" ) )
+		mRect.y1 = Value::parse( &y ).asUser();
 	else
 		mRect.y1 = 0;
-	if( xml.hasAttribute( "width" ) )
-		width = Value::parse( xml["width"] ).asUser();
-	if( xml.hasAttribute( "height" ) )
-		height = Value::parse( xml["height"] ).asUser();	
+	if( const char *w = findAttribute( xml, "width" ) )
+		width = Value::parse( &w ).asUser();
+	if( const char *h = findAttribute( xml, "height" ) )
+		height = Value::parse( &h ).asUser();
 	mRect.x2 = mRect.x1 + width;
 	mRect.y2 = mRect.y1 + height;
 	mBoundingBox = mRect;
@@ -1577,32 +1613,39 @@ Shape2d	Rect::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Polygon
-vector<vec2> parsePointList( const std::string &p )
+// Parses the coordinate pairs of the "points" attribute of a polygon or polyline. Anything but numbers and separators throws a
+// FloatParseExc, like a malformed number does. An odd number of coordinates is logged and, as in a path, the last one is ignored.
+vector<vec2> parsePointList( const rapidxml::xml_node<> &xml )
 {
 	vector<vec2> result;
-	
-	if( ! p.empty() ) {
-		char item[64];
-		const char *s = p.c_str();
-		bool odd = false;
-		float lastVal;
-		while( *s ) {
-			s = getNextPathItem( s, item );
-			if( ! odd )
-				lastVal = (float)atof( item );
-			else
-				result.push_back( vec2( lastVal, (float)atof( item ) ) );
-			odd = ! odd;
+	const char *s = findAttribute( xml, "points" );
+	if( ! s )
+		return result;
+
+	bool oddCoordinate = false;
+	while( nextItemIsFloat( s ) ) {
+		float x = parseFloat( &s );
+		if( ! nextItemIsFloat( s ) ) {
+			oddCoordinate = true;
+			break;
 		}
+		result.push_back( vec2( x, parseFloat( &s ) ) );
 	}
 
+	while( *s && ( isspace( *s ) || *s == ',' ) )
+		s++;
+	if( *s )
+		throw FloatParseExc();
+	if( oddCoordinate )
+		CI_LOG_W( "odd number of coordinates in the points of <" << xml.name() << " id=\"" << getAttribute( xml, "id" ) << "\">; ignoring the last one" );
+
 	return result;
 }
 
-Polygon::Polygon( Node *parent, const XmlTree &xml )
+Polygon::Polygon( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	mPolyLine = PolyLine2f( parsePointList( xml.getAttributeValue<string>( "points", "" ) ) );
+	mPolyLine = PolyLine2f( parsePointList( xml ) );
 	mPolyLine.setClosed( true );
 }
 
@@ -1629,10 +1672,10 @@ Shape2d	Polygon::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Polyline
-Polyline::Polyline( Node *parent, const XmlTree &xml )
+Polyline::Polyline( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	mPolyLine = PolyLine2f( parsePointList( xml.getAttributeValue<string>( "points", "" ) ) );
+	mPolyLine = PolyLine2f( parsePointList( xml ) );
 	mPolyLine.setClosed( false );
 }
 
@@ -1657,7 +1700,7 @@ Shape2d	Polyline::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Group
-Group::Group( Node *parent, const XmlTree &xml )
+Group::Group( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
 	parse( xml );
@@ -1669,37 +1712,40 @@ Group::~Group()
 		delete *childIt;
 }
 
-void Group::parse( const XmlTree &xml )
-{
-	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
-		if( treeIt->getTag() == "g" )
-			mChildren.push_back( new Group( this, *treeIt ) );
-		else if( treeIt->getTag() == "path" )
-			mChildren.push_back( new Path( this, *treeIt ) );
-		else if( treeIt->getTag() == "polygon" )
-			mChildren.push_back( new Polygon( this, *treeIt ) );
-		else if( treeIt->getTag() == "polyline" )
-			mChildren.push_back( new Polyline( this, *treeIt ) );
-		else if( treeIt->getTag() == "line" )
-			mChildren.push_back( new Line( this, *treeIt ) );
-		else if( treeIt->getTag() == "rect" )
-			mChildren.push_back( new Rect( this, *treeIt ) );
-		else if( treeIt->getTag() == "circle" )
-			mChildren.push_back( new Circle( this, *treeIt ) );
-		else if( treeIt->getTag() == "ellipse" )
-			mChildren.push_back( new Ellipse( this, *treeIt ) );
-		else if( treeIt->getTag() == "use" )
-			mChildren.push_back( new Use( this, *treeIt ) );
-		else if( treeIt->getTag() == "defs" )
-			mDefs = shared_ptr<Group>( new Group( this, *treeIt ) );
-		else if( treeIt->getTag() == "image" )
-			mChildren.push_back( new Image( this, *treeIt ) );
-		else if( treeIt->getTag() == "linearGradient" )
-			mChildren.push_back( new LinearGradient( this, *treeIt ) );
-		else if( treeIt->getTag() == "radialGradient" )
-			mChildren.push_back( new RadialGradient( this, *treeIt ) );
-		else if( treeIt->getTag() == "text" )
-			mChildren.push_back( new Text( this, *treeIt ) );
+void Group::parse( const rapidxml::xml_node<> &xml )
+{
+	for( const rapidxml::xml_node<> *child = xml.first_node(); child; child = child->next_sibling() ) {
+		if( child->type() != rapidxml::node_element )
+			continue;
+		const char *tag = child->name();
+		if( strcmp( tag, "g" ) == 0 )
+			mChildren.push_back( new Group( this, *child ) );
+		else if( strcmp( tag, "path" ) == 0 )
+			mChildren.push_back( new Path( this, *child ) );
+		else if( strcmp( tag, "polygon" ) == 0 )
+			mChildren.push_back( new Polygon( this, *child ) );
+		else if( strcmp( tag, "polyline" ) == 0 )
+			mChildren.push_back( new Polyline( this, *child ) );
+		else if( strcmp( tag, "line" ) == 0 )
+			mChildren.push_back( new Line( this, *child ) );
+		else if( strcmp( tag, "rect" ) == 0 )
+			mChildren.push_back( new Rect( this, *child ) );
+		else if( strcmp( tag, "circle" ) == 0 )
+			mChildren.push_back( new Circle( this, *child ) );
+		else if( strcmp( tag, "ellipse" ) == 0 )
+			mChildren.push_back( new Ellipse( this, *child ) );
+		else if( strcmp( tag, "use" ) == 0 )
+			mChildren.push_back( new Use( this, *child ) );
+		else if( strcmp( tag, "defs" ) == 0 )
+			mDefs = shared_ptr<Group>( new Group( this, *child ) );
+		else if( strcmp( tag, "image" ) == 0 )
+			mChildren.push_back( new Image( this, *child ) );
+		else if( strcmp( tag, "linearGradient" ) == 0 )
+			mChildren.push_back( new LinearGradient( this, *child ) );
+		else if( strcmp( tag, "radialGradient" ) == 0 )
+			mChildren.push_back( new RadialGradient( this, *child ) );
+		else if( strcmp( tag, "text" ) == 0 )
+			mChildren.push_back( new Text( this, *child ) );
 	}
 }
 
@@ -1896,16 +1942,16 @@ void Group::iterate( const std::function<void(Node*)> &fn )
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Use
-Use::Use( Node *parent, const XmlTree &xml )
+Use::Use( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml ), mReferenced( 0 )
 {
 	parse( xml );
 }
 
-void Use::parse( const XmlTree &xml )
+void Use::parse( const rapidxml::xml_node<> &xml )
 {
-	if( xml.hasAttribute( "xlink:href" ) ) {
-		string ref = xml.getAttributeValue<string>( "xlink:href" );
+	if( const char *href = findAttribute( xml, "xlink:href" ) ) {
+		string ref = href;
 		if( ref.size() > 1 ) {
 			if( ref[0] == '#' ) {
 				string elementId = ref.substr( 1, string::npos );
@@ -1929,18 +1975,18 @@ void Use::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Image
-Image::Image( Node *parent, const XmlTree &xml )
+Image::Image( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml )
 {
-	mRect.x1 = xml.getAttributeValue<float>( "x", 0 );
-	mRect.y1 = xml.getAttributeValue<float>( "y", 0 );
-	float width = xml.getAttributeValue<float>( "width", 0 );
-	float height = xml.getAttributeValue<float>( "height", 0 );	
+	mRect.x1 = getAttributeFloat( xml, "x", 0 );
+	mRect.y1 = getAttributeFloat( xml, "y", 0 );
+	float width = getAttributeFloat( xml, "width", 0 );
+	float height = getAttributeFloat( xml, "height", 0 );
 	mRect.x2 = mRect.x1 + width;
 	mRect.y2 = mRect.y1 + height;
 
-	if( xml.hasAttribute( "xlink:href" ) ) {
-		std::string s = xml.getAttributeValue<string>( "xlink:href" );
+	if( const char *href = findAttribute( xml, "xlink:href" ) ) {
+		std::string s = href;
 		if( s.find( "data:" ) == 0 )
 			mImage = parseDataImage( s );
 		else
@@ -1981,15 +2027,15 @@ void Image::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Text
-Text::Text( Node *parent, const XmlTree &xml )
+Text::Text( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml ), mAttributes( xml )
 {
-	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
-		if( treeIt->getTag() == "" ) { // data!
-			mSpans.push_back( TextSpanRef( new TextSpan( this, treeIt->getValue() ) ) );
+	for( const rapidxml::xml_node<> *child = xml.first_node(); child; child = child->next_sibling() ) {
+		if( child->type() == rapidxml::node_data ) { // data!
+			mSpans.push_back( TextSpanRef( new TextSpan( this, string( child->value(), child->value_size() ) ) ) );
 		}
-		else if( treeIt->getTag() == "tspan" ) { // tspan!
-			mSpans.push_back( TextSpanRef( new TextSpan( this, *treeIt ) ) );
+		else if( isElement( *child, "tspan" ) ) { // tspan!
+			mSpans.push_back( TextSpanRef( new TextSpan( this, *child ) ) );
 		}
 	}
 }
@@ -2045,15 +2091,15 @@ void Text::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // TextSpan
-TextSpan::TextSpan( Node *parent, const XmlTree &xml )
+TextSpan::TextSpan( Node *parent, const rapidxml::xml_node<> &xml )
 	: Node( parent, xml ), mAttributes( xml ), mIgnoreAttributes( false )
 {
-	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
-		if( treeIt->getTag() == "" ) { // data!
-			mSpans.push_back( TextSpanRef( new TextSpan( this, treeIt->getValue() ) ) );
+	for( const rapidxml::xml_node<> *child = xml.first_node(); child; child = child->next_sibling() ) {
+		if( child->type() == rapidxml::node_data ) { // data!
+			mSpans.push_back( TextSpanRef( new TextSpan( this, string( child->value(), child->value_size() ) ) ) );
 		}
-		else if( treeIt->getTag() == "tspan" ) { // tspan!
-			mSpans.push_back( TextSpanRef( new TextSpan( this, *treeIt ) ) );
+		else if( isElement( *child, "tspan" ) ) { // tspan!
+			mSpans.push_back( TextSpanRef( new TextSpan( this, *child ) ) );
 		}
 	}
 }
@@ -2150,16 +2196,16 @@ Shape2d TextSpan::getShape() const
 #endif
 
 // TextSpan::Atributes
-TextSpan::Attributes::Attributes( const XmlTree &xml )
+TextSpan::Attributes::Attributes( const rapidxml::xml_node<> &xml )
 {
-	if( xml.hasAttribute( "x" ) )
-		mX = readValueList( xml["x"], false );
-	if( xml.hasAttribute( "y" ) )
-		mY = readValueList( xml["y"], false );
-	if( xml.hasAttribute( "rotate" ) )
-		mRotate = readValueList( xml["rotate"], false );
-	if( xml.hasAttribute( "letter-spacing" ) )
-		mLetterSpacing = readValueList( xml["letter-spacing"], false );
+	if( const char *x = findAttribute( xml, "x" ) )
+		mX = readValueList( x, false );
+	if( const char *y = findAttribute( xml, "y" ) )
+		mY = readValueList( y, false );
+	if( const char *rotate = findAttribute( xml, "rotate" ) )
+		mRotate = readValueList( rotate, false );
+	if( const char *letterSpacing = findAttribute( xml, "letter-spacing" ) )
+		mLetterSpacing = readValueList( letterSpacing, false );
 }
 
 const std::shared_ptr<Font>	TextSpan::getFont() const
@@ -2301,13 +2347,20 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 {
 	if( ! filePath.empty() )
 		mFilePath = filePath.parent_path();
-	mXmlTree = shared_ptr<XmlTree>( new XmlTree( source, XmlTree::ParseOptions().ignoreDataChildren( false ) ) );
-
-	const XmlTree &xml( mXmlTree->getChild( "svg" ) );
-
-	if( xml.hasAttribute( "viewBox" ) ) {
-		string vbox = xml.getAttributeValue<string>( "viewBox" );
-		const char *vbCPtr = vbox.c_str();
+	// the Nodes are built straight from the rapidxml DOM, which is parsed in place from a copy of the source. The DOM is
+	// allocated from the document's memory pool, so it is released in one go once loading finishes.
+	BufferRef buffer = source->getBuffer();
+	unique_ptr<char[]> text( new char[buffer->getSize() + 1] );
+	memcpy( text.get(), buffer->getData(), buffer->getSize() );
+	text[buffer->getSize()] = 0;
+	rapidxml::xml_document<> doc;
+	doc.parse<rapidxml::parse_default>( text.get() );
+	const rapidxml::xml_node<> *svg = doc.first_node( "svg" );
+	if( ! svg )
+		throw ExcChildNotFound( "svg" );
+	const rapidxml::xml_node<> &xml = *svg;
+
+	if( const char *vbCPtr = findAttribute( xml, "viewBox" ) ) {
 		mViewBox.x1 = static_cast<int>( parseFloat( &vbCPtr ) );
 		mViewBox.y1 = static_cast<int>( parseFloat( &vbCPtr ) );
 		mViewBox.x2 = mViewBox.x1 + static_cast<int>( parseFloat( &vbCPtr ) );
@@ -2316,8 +2369,8 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 	else {
 		mViewBox = Area( 0, 0, 0, 0 );
 	}
-	if( xml.hasAttribute( "width" ) ) {
-		Value val = Value::parse( xml.getAttributeValue<string>( "width" ) );
+	if( const char *width = findAttribute( xml, "width" ) ) {
+		Value val = Value::parse( &width );
 		if( val.isPercent() )
 			mWidth = static_cast<int>( val.asUser() * mViewBox.getWidth() / 100 );
 		else
@@ -2325,8 +2378,8 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 	}
 	else
 		mWidth = mViewBox.getWidth();
-	if( xml.hasAttribute( "height" ) ) {
-		Value val = Value::parse( xml.getAttributeValue<string>( "height" ) );
+	if( const char *height = findAttribute( xml, "height" ) ) {
+		Value val = Value::parse( &height );
 		if( val.isPercent() )
 			mHeight = static_cast<int>( val.asUser() * mViewBox.getHeight() / 100 );
 		else
@@ -2347,8 +2400,8 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 		mTransform = mat3();
 
 	// we can't parse the group w/o having parsed the viewBox, dimensions, etc, so we have to do this manually:
-	if( xml.hasChild( "switch" ) )		// when saved with "preserve Illustrator editing capabilities", svg data is inside a "switch"
-		Group::parse( xml.getChild( "switch" ) );
+	if( const rapidxml::xml_node<> *switchNode = xml.first_node( "switch" ) )		// when saved with "preserve Illustrator editing capabilities", svg data is inside a "switch"
+		Group::parse( *switchNode );
 	else
 		Group::parse( xml );
 }
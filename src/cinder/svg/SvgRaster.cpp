@@ -0,0 +1,179 @@
+/*
+ Copyright (c) 2020, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/svg/SvgRaster.h"
+#include "cinder/ip/Fill.h"
+
+namespace cinder {
+
+SvgRendererRaster::SvgRendererRaster( Surface8u *target, const mat3 &transform )
+	: svg::Renderer(), mTarget( target ), mRasterizer( target->getWidth(), target->getHeight() )
+{
+	mMatrixStack.push_back( transform );
+	mFillStack.push_back( svg::Paint( Color::black() ) );
+	mStrokeStack.push_back( svg::Paint() );
+	mFillOpacityStack.push_back( 1.0f );
+	mStrokeOpacityStack.push_back( 1.0f );
+	mGroupOpacityStack.push_back( 1.0f );
+	mStrokeWidthStack.push_back( 1.0f );
+	mFillRuleStack.push_back( svg::FILL_RULE_NONZERO );
+	mLineCapStack.push_back( svg::LINE_CAP_BUTT );
+	mLineJoinStack.push_back( svg::LINE_JOIN_MITER );
+}
+
+void SvgRendererRaster::pushGroup( const svg::Group & /*group*/, float opacity )
+{
+	// group opacity is applied per-element rather than to a composited layer
+	mGroupOpacityStack.push_back( mGroupOpacityStack.back() * opacity );
+}
+
+void SvgRendererRaster::popGroup()
+{
+	mGroupOpacityStack.pop_back();
+}
+
+void SvgRendererRaster::pushMatrix( const mat3 &m )
+{
+	mMatrixStack.push_back( mMatrixStack.back() * m );
+}
+
+void SvgRendererRaster::popMatrix()
+{
+	mMatrixStack.pop_back();
+}
+
+bool SvgRendererRaster::calcPaintColor( const svg::Paint &paint, float opacity, ColorA *result ) const
+{
+	if( paint.isNone() || paint.getNumColors() == 0 )
+		return false;
+
+	*result = ColorA( paint.getColor() );
+	result->a *= opacity * mGroupOpacityStack.back();
+	return result->a > 0;
+}
+
+void SvgRendererRaster::fillAndStroke( const Shape2d &shape, bool fill )
+{
+	ColorA color;
+	mRasterizer.setTransform( mMatrixStack.back() );
+	if( fill && calcPaintColor( mFillStack.back(), mFillOpacityStack.back(), &color ) ) {
+		mRasterizer.clear();
+		mRasterizer.addShape( shape );
+		auto rule = ( mFillRuleStack.back() == svg::FILL_RULE_EVENODD ) ? ip::Rasterizer::FILL_RULE_EVENODD : ip::Rasterizer::FILL_RULE_NONZERO;
+		mRasterizer.fill( mTarget, color, rule );
+	}
+	if( calcPaintColor( mStrokeStack.back(), mStrokeOpacityStack.back(), &color ) ) {
+		ip::Rasterizer::StrokeStyle style( mStrokeWidthStack.back() );
+		style.cap( (ip::Rasterizer::LineCap)mLineCapStack.back() ).join( (ip::Rasterizer::LineJoin)mLineJoinStack.back() );
+		mRasterizer.clear();
+		mRasterizer.addStroke( shape, style );
+		mRasterizer.fill( mTarget, color, ip::Rasterizer::FILL_RULE_NONZERO );
+	}
+}
+
+void SvgRendererRaster::drawPath( const svg::Path &path )
+{
+	fillAndStroke( path.getShape2d(), true );
+}
+
+void SvgRendererRaster::drawPolyline( const svg::Polyline &polyline )
+{
+	fillAndStroke( polyline.getShape(), true );
+}
+
+void SvgRendererRaster::drawPolygon( const svg::Polygon &polygon )
+{
+	fillAndStroke( polygon.getShape(), true );
+}
+
+void SvgRendererRaster::drawLine( const svg::Line &line )
+{
+	fillAndStroke( line.getShape(), false );
+}
+
+void SvgRendererRaster::drawRect( const svg::Rect &rect )
+{
+	fillAndStroke( rect.getShape(), true );
+}
+
+void SvgRendererRaster::drawCircle( const svg::Circle &circle )
+{
+	fillAndStroke( circle.getShape(), true );
+}
+
+void SvgRendererRaster::drawEllipse( const svg::Ellipse &ellipse )
+{
+	fillAndStroke( ellipse.getShape(), true );
+}
+
+void SvgRendererRaster::drawImage( const svg::Image &image )
+{
+	const std::shared_ptr<Surface8u> source = image.getSurface();
+	const Rectf &rect = image.getRect();
+	if( ! source || rect.getWidth() <= 0 || rect.getHeight() <= 0 )
+		return;
+
+	// nearest-neighbor sample through the inverse of the image's placement, restricted to its transformed bounds
+	const mat3 &m = mMatrixStack.back();
+	const mat3 inv = inverse( m );
+	Rectf bounds( vec2( m * vec3( rect.getUpperLeft(), 1 ) ), vec2( m * vec3( rect.getLowerRight(), 1 ) ) );
+	bounds.include( vec2( m * vec3( rect.getUpperRight(), 1 ) ) );
+	bounds.include( vec2( m * vec3( rect.getLowerLeft(), 1 ) ) );
+	const Area area = Area( bounds ).getClipBy( mTarget->getBounds() );
+	const float opacity = mGroupOpacityStack.back();
+	const vec2 scale( source->getWidth() / rect.getWidth(), source->getHeight() / rect.getHeight() );
+
+	for( int32_t y = area.y1; y < area.y2; ++y ) {
+		for( int32_t x = area.x1; x < area.x2; ++x ) {
+			vec2 local = vec2( inv * vec3( x + 0.5f, y + 0.5f, 1 ) );
+			if( ! rect.contains( local ) )
+				continue;
+			ivec2 srcPos( ( local - rect.getUpperLeft() ) * scale );
+			ColorA src = source->getPixel( srcPos );
+			src.a = source->hasAlpha() ? src.a * opacity : opacity;
+			ColorA dst = mTarget->getPixel( ivec2( x, y ) );
+			ColorA result( lerp( dst.r, src.r, src.a ), lerp( dst.g, src.g, src.a ), lerp( dst.b, src.b, src.a ), dst.a + ( 1 - dst.a ) * src.a );
+			mTarget->setPixel( ivec2( x, y ), result );
+		}
+	}
+}
+
+namespace svg {
+
+void render( Surface8u *target, const Node &node, const mat3 &transform )
+{
+	SvgRendererRaster renderer( target, transform );
+	node.render( renderer );
+}
+
+Surface8u renderToSurface( const Doc &doc )
+{
+	Surface8u result( std::max( 1, doc.getWidth() ), std::max( 1, doc.getHeight() ), true );
+	ip::fill( &result, ColorA8u( 0, 0, 0, 0 ) );
+	render( &result, doc );
+	return result;
+}
+
+} // namespace svg
+
+} // namespace cinder
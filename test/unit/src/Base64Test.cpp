@@ -2,6 +2,10 @@
 #include "catch.hpp"
 #include "cinder/Base64.h"
 #include "cinder/app/App.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
 
 using namespace cinder;
 using namespace std;
@@ -11,6 +15,19 @@ std::string toString( Buffer b )
 	return string( static_cast<const char *>( b.getData() ), b.getSize() );
 }
 
+std::string randomBytes( Rand &rnd, size_t size )
+{
+	std::string result( size, 0 );
+	for( auto &c : result )
+		c = (char)rnd.nextUint( 256 );
+	return result;
+}
+
+std::string toString( const OStreamMemRef &stream )
+{
+	return string( static_cast<const char *>( stream->getBuffer() ), (size_t)stream->tell() );
+}
+
 TEST_CASE("Base64")
 {
 	SECTION("Carnal Redux")
@@ -43,4 +60,112 @@ TEST_CASE("Base64")
 			}
 		}
 	}
+	SECTION("Line breaks follow every full line, rounded down to a multiple of 4")
+	{
+		const string text = "any carnal pleasure.";
+		REQUIRE( toBase64( text, 8 ) == "YW55IGNh\ncm5hbCBw\nbGVhc3Vy\nZS4=" );
+		REQUIRE( toBase64( text, 11 ) == "YW55IGNh\ncm5hbCBw\nbGVhc3Vy\nZS4=" );
+		REQUIRE( toBase64( text.substr( 0, 6 ), 8 ) == "YW55IGNh\n" );
+		REQUIRE( toBase64( text.substr( 0, 6 ), 3 ) == "YW55IGNh" );
+		REQUIRE( toBase64( text.substr( 0, 6 ), -8 ) == "YW55IGNh" );
+	}
+	SECTION("Decoding skips characters outside the alphabet")
+	{
+		REQUIRE( "any carnal pleasure." == toString( fromBase64( "YW55\r\nIGNh cm5h\tbCBw!!bGVh\xff\x80" "c3VyZS4=" ) ) );
+		REQUIRE( "any carnal pleasure" == toString( fromBase64( "{YW55IGNhcm5hbCBwbGVhc3VyZQ==}" ) ) );
+	}
+	SECTION("Unpadded input shorter than a group decodes the same as with Base64Decoder")
+	{
+		for( const std::string &encoded : { std::string( "Q" ), std::string( "QQ" ), std::string( "QUI" ), std::string( "QUJD" ), std::string( "QUJDRA" ) } ) {
+			auto decoded = OStreamMem::create();
+			Base64Decoder decoder( decoded );
+			decoder.write( encoded.data(), encoded.size() );
+			decoder.finish();
+			REQUIRE( toString( fromBase64( encoded ) ) == toString( decoded ) );
+		}
+		REQUIRE( "A" == toString( fromBase64( "QQ" ) ) );
+		REQUIRE( "AB" == toString( fromBase64( "QUI" ) ) );
+		REQUIRE( "" == toString( fromBase64( "Q" ) ) );
+	}
+	SECTION("Random data round trips across the vectorized and scalar paths")
+	{
+		Rand rnd( 5 );
+		for( size_t size : { 1, 11, 12, 13, 17, 18, 47, 48, 49, 95, 96, 97, 1000, 65537 } ) {
+			const std::string data = randomBytes( rnd, size );
+			for( int charsPerLine : { 0, 4, 64, 76 } ) {
+				const std::string base64 = toBase64( data, charsPerLine );
+				REQUIRE( base64.size() == ( size + 2 ) / 3 * 4 + ( charsPerLine ? size / 3 / ( charsPerLine / 4 ) : 0 ) );
+				REQUIRE( toString( fromBase64( base64 ) ) == data );
+			}
+		}
+	}
+	SECTION("Streaming produces the same output in any number of pieces")
+	{
+		Rand rnd( 9 );
+		const std::string data = randomBytes( rnd, 100000 );
+		const std::string expected = toBase64( data, 76 );
+
+		auto encoded = OStreamMem::create();
+		Base64Encoder encoder( encoded, 76 );
+		for( size_t pos = 0; pos < data.size(); ) {
+			const size_t size = std::min<size_t>( rnd.nextUint( 40000 ), data.size() - pos );
+			encoder.write( data.data() + pos, size );
+			pos += size;
+		}
+		encoder.finish();
+		REQUIRE( toString( encoded ) == expected );
+
+		auto decoded = OStreamMem::create();
+		Base64Decoder decoder( decoded );
+		for( size_t pos = 0; pos < expected.size(); ) {
+			const size_t size = std::min<size_t>( rnd.nextUint( 7 ), expected.size() - pos );
+			decoder.write( expected.data() + pos, size );
+			pos += size;
+		}
+		decoder.finish();
+		REQUIRE( toString( decoded ) == data );
+
+		auto streamEncoded = OStreamMem::create();
+		toBase64( IStreamMem::create( data.data(), data.size() ), streamEncoded );
+		REQUIRE( toString( streamEncoded ) == toBase64( data ) );
+
+		auto streamDecoded = OStreamMem::create();
+		fromBase64( IStreamMem::create( expected.data(), expected.size() ), streamDecoded );
+		REQUIRE( toString( streamDecoded ) == data );
+	}
+}
+
+TEST_CASE("Base64Benchmark", "[.][benchmark]")
+{
+	Rand rnd( 1 );
+
+	// a buffer that stays in cache, and one that has to stream from memory; each is run for about the same total number of bytes
+	for( size_t size : { size_t( 64 * 1024 ), size_t( 32 * 1024 * 1024 ) } ) {
+		const std::string data = randomBytes( rnd, size );
+		const int numRuns = int( 128 * 1024 * 1024 / size );
+
+		for( int charsPerLine : { 0, 76 } ) {
+			std::string encoded;
+			Timer timer( true );
+			for( int i = 0; i < numRuns; ++i )
+				encoded = toBase64( data, charsPerLine );
+			const double encodeSeconds = timer.getSeconds() / numRuns;
+
+			Buffer decoded;
+			timer.start();
+			for( int i = 0; i < numRuns; ++i )
+				decoded = fromBase64( encoded );
+			const double decodeSeconds = timer.getSeconds() / numRuns;
+
+			timer.start();
+			for( int i = 0; i < numRuns; ++i ) {
+				auto stream = OStreamMem::create( encoded.size() );
+				toBase64( IStreamMem::create( data.data(), data.size() ), stream, charsPerLine );
+			}
+			const double streamSeconds = timer.getSeconds() / numRuns;
+
+			cout << size / 1024 << " KB input, charsPerLine " << charsPerLine << ", MB/s of input: encode " << size / encodeSeconds / 1e6
+				<< ", decode " << size / decodeSeconds / 1e6 << ", stream encode " << size / streamSeconds / 1e6 << endl;
+		}
+	}
 }
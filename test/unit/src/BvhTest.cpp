@@ -0,0 +1,251 @@
+#include "catch.hpp"
+#include "cinder/Bvh.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// A sphere plus a soup of random triangles, so that the hierarchy has both well-shaped and overlapping leaves
+TriMesh makeTestMesh()
+{
+	TriMesh mesh( geom::Sphere().subdivisions( 24 ), TriMesh::Format().positions() );
+	Rand rnd( 1234 );
+	for( int i = 0; i < 200; ++i ) {
+		vec3 center = rnd.nextVec3() * rnd.nextFloat( 0.5f, 2.0f );
+		uint32_t first = (uint32_t)mesh.getNumVertices();
+		for( int v = 0; v < 3; ++v )
+			mesh.appendPosition( center + rnd.nextVec3() * 0.2f );
+		mesh.appendTriangle( first, first + 1, first + 2 );
+	}
+
+	return mesh;
+}
+
+bool bruteForceIntersect( const TriMesh &mesh, const Ray &ray, float *result, uint32_t *triangle )
+{
+	bool hit = false;
+	*result = FLT_MAX;
+	for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+		vec3 v0, v1, v2;
+		mesh.getTriangleVertices( t, &v0, &v1, &v2 );
+		float dist;
+		if( ray.calcTriangleIntersection( v0, v1, v2, &dist ) && dist >= 0 && dist < *result ) {
+			*result = dist;
+			*triangle = (uint32_t)t;
+			hit = true;
+		}
+	}
+
+	return hit;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Bvh" )
+{
+	TriMesh mesh = makeTestMesh();
+	Bvh bvh( mesh, Bvh::Options().parallel( false ) );
+	REQUIRE( bvh.getNumTriangles() == mesh.getNumTriangles() );
+	REQUIRE( bvh.getNumNodes() < mesh.getNumTriangles() * 2 );
+	REQUIRE( bvh.getBounds().getMin() == mesh.calcBoundingBox().getMin() );
+	REQUIRE( bvh.getBounds().getMax() == mesh.calcBoundingBox().getMax() );
+
+	Rand rnd( 5678 );
+
+	SECTION( "Ray intersection matches brute force" )
+	{
+		for( int i = 0; i < 500; ++i ) {
+			Ray ray( rnd.nextVec3() * 4.0f, -rnd.nextVec3() + rnd.nextVec3() * 0.3f );
+			float expected;
+			uint32_t expectedTriangle;
+			bool expectedHit = bruteForceIntersect( mesh, ray, &expected, &expectedTriangle );
+
+			Bvh::Hit hit;
+			REQUIRE( bvh.intersect( ray, &hit ) == expectedHit );
+			REQUIRE( bvh.intersectAny( ray ) == expectedHit );
+			if( ! expectedHit )
+				continue;
+
+			REQUIRE( hit.distance == Approx( expected ) );
+			vec3 v0, v1, v2;
+			mesh.getTriangleVertices( hit.triangle, &v0, &v1, &v2 );
+			vec3 position = v0 * ( 1 - hit.barycentric.x - hit.barycentric.y ) + v1 * hit.barycentric.x + v2 * hit.barycentric.y;
+			REQUIRE( distance( position, hit.position ) < 0.0001f );
+
+			vector<Bvh::Hit> hits;
+			REQUIRE( bvh.intersectAll( ray, &hits ) >= 1 );
+			REQUIRE( hits.front().distance == Approx( expected ) );
+			for( size_t h = 1; h < hits.size(); ++h )
+				REQUIRE( hits[h - 1].distance <= hits[h].distance );
+
+			REQUIRE_FALSE( bvh.intersect( ray, nullptr, expected * 0.99f ) );
+		}
+	}
+
+	SECTION( "Box query matches brute force" )
+	{
+		for( int i = 0; i < 100; ++i ) {
+			vec3 center = rnd.nextVec3() * rnd.nextFloat( 0, 1.5f );
+			vec3 size( rnd.nextFloat( 0.01f, 1 ), rnd.nextFloat( 0.01f, 1 ), rnd.nextFloat( 0.01f, 1 ) );
+			AxisAlignedBox box( center - size, center + size );
+
+			vector<uint32_t> result;
+			bvh.query( box, &result );
+			sort( result.begin(), result.end() );
+
+			// a triangle overlaps the box if an edge crosses it, or its center or a vertex is inside it
+			for( uint32_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+				vec3 v0, v1, v2;
+				mesh.getTriangleVertices( t, &v0, &v1, &v2 );
+				bool inside = box.contains( v0 ) || box.contains( v1 ) || box.contains( v2 ) || box.contains( ( v0 + v1 + v2 ) / 3.0f );
+				if( inside )
+					REQUIRE( binary_search( result.begin(), result.end(), t ) );
+				bool outside = glm::any( glm::lessThan( glm::max( glm::max( v0, v1 ), v2 ), box.getMin() ) ) || glm::any( glm::greaterThan( glm::min( glm::min( v0, v1 ), v2 ), box.getMax() ) );
+				if( outside )
+					REQUIRE_FALSE( binary_search( result.begin(), result.end(), t ) );
+			}
+		}
+	}
+
+	SECTION( "Frustum query contains every visible triangle" )
+	{
+		CameraPersp cam( 640, 480, 40, 0.1f, 10 );
+		for( int i = 0; i < 20; ++i ) {
+			cam.lookAt( rnd.nextVec3() * 3.0f, vec3( 0 ) );
+			Frustum frustum( cam );
+
+			vector<uint32_t> result;
+			bvh.query( frustum, &result );
+			sort( result.begin(), result.end() );
+			REQUIRE( adjacent_find( result.begin(), result.end() ) == result.end() );
+			for( uint32_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+				vec3 v0, v1, v2;
+				mesh.getTriangleVertices( t, &v0, &v1, &v2 );
+				if( frustum.contains( v0 ) || frustum.contains( v1 ) || frustum.contains( v2 ) )
+					REQUIRE( binary_search( result.begin(), result.end(), t ) );
+			}
+		}
+	}
+
+	SECTION( "Closest point matches brute force" )
+	{
+		for( int i = 0; i < 200; ++i ) {
+			vec3 point = rnd.nextVec3() * rnd.nextFloat( 0, 3 );
+			Bvh::Hit hit;
+			REQUIRE( bvh.calcClosestPoint( point, &hit ) );
+
+			float expected = FLT_MAX;
+			const uint32_t indices[3] = { 0, 1, 2 };
+			for( uint32_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+				vec3 v[3];
+				mesh.getTriangleVertices( t, &v[0], &v[1], &v[2] );
+				Bvh single( v, 3, indices, 3 );
+				Bvh::Hit singleHit;
+				REQUIRE( single.calcClosestPoint( point, &singleHit ) );
+				expected = std::min( expected, singleHit.distance );
+			}
+
+			REQUIRE( hit.distance == Approx( expected ) );
+			REQUIRE( distance( hit.position, point ) == Approx( hit.distance ) );
+			REQUIRE_FALSE( bvh.calcClosestPoint( point, nullptr, expected * 0.99f ) );
+		}
+	}
+
+	SECTION( "Refit gives the same results as a rebuild" )
+	{
+		// swirl the mesh around the y axis
+		for( size_t v = 0; v < mesh.getNumVertices(); ++v ) {
+			vec3 &p = mesh.getPositions<3>()[v];
+			float angle = p.y * 1.5f;
+			p = vec3( p.x * cos( angle ) - p.z * sin( angle ), p.y, p.x * sin( angle ) + p.z * cos( angle ) );
+		}
+
+		bvh.refit( mesh );
+		Bvh rebuilt( mesh );
+		REQUIRE( bvh.getBounds().getMin() == rebuilt.getBounds().getMin() );
+		REQUIRE( bvh.getBounds().getMax() == rebuilt.getBounds().getMax() );
+		for( int i = 0; i < 200; ++i ) {
+			Ray ray( rnd.nextVec3() * 4.0f, -rnd.nextVec3() + rnd.nextVec3() * 0.3f );
+			Bvh::Hit hit, rebuiltHit;
+			REQUIRE( bvh.intersect( ray, &hit ) == rebuilt.intersect( ray, &rebuiltHit ) );
+			if( bvh.intersect( ray, &hit ) ) {
+				REQUIRE( hit.distance == rebuiltHit.distance );
+				REQUIRE( hit.triangle == rebuiltHit.triangle );
+			}
+		}
+
+		REQUIRE_THROWS_AS( bvh.refit( TriMesh( geom::Cube() ) ), BvhExc );
+	}
+
+	SECTION( "Degenerate input" )
+	{
+		Bvh empty;
+		REQUIRE_FALSE( empty.intersect( Ray( vec3( 0 ), vec3( 0, 0, 1 ) ), nullptr ) );
+		REQUIRE_FALSE( empty.calcClosestPoint( vec3( 0 ), nullptr ) );
+
+		// many triangles sharing a centroid must still produce small leaves
+		vector<vec3> positions = { vec3( -1, 0, 0 ), vec3( 1, 0, 0 ), vec3( 0, 1, 0 ), vec3( 0, -1, 0 ) };
+		vector<uint32_t> indices;
+		for( int i = 0; i < 100; ++i )
+			indices.insert( indices.end(), { 0, 1, 2, 1, 0, 3 } );
+		Bvh stacked( positions.data(), positions.size(), indices.data(), indices.size() );
+		vector<Bvh::Hit> hits;
+		REQUIRE( stacked.intersectAll( Ray( vec3( 0, 0.5f, -1 ), vec3( 0, 0, 1 ) ), &hits ) == 100 );
+
+		indices.push_back( 4 );
+		indices.push_back( 0 );
+		indices.push_back( 1 );
+		REQUIRE_THROWS_AS( Bvh( positions.data(), positions.size(), indices.data(), indices.size() ), BvhExc );
+	}
+} // bvh
+
+TEST_CASE( "BvhBenchmark", "[.][benchmark]" )
+{
+	TriMesh mesh( geom::Sphere().subdivisions( 1024 ), TriMesh::Format().positions() );
+
+	Timer t( true );
+	Bvh bvh( mesh );
+	double buildSeconds = t.getSeconds();
+
+	t.start();
+	Bvh serial( mesh, Bvh::Options().parallel( false ) );
+	double serialBuildSeconds = t.getSeconds();
+
+	t.start();
+	bvh.refit( mesh );
+	double refitSeconds = t.getSeconds();
+
+	cout << mesh.getNumTriangles() << " triangles: build " << buildSeconds << " s (serial " << serialBuildSeconds << " s), refit " << refitSeconds << " s, "
+		<< bvh.getNumNodes() << " nodes, " << bvh.getMemoryUsage() / ( 1024 * 1024 ) << " MB" << endl;
+
+	Rand rnd( 1 );
+	const int numRays = 1000000;
+	vector<Ray> rays;
+	for( int i = 0; i < numRays; ++i )
+		rays.emplace_back( rnd.nextVec3() * 3.0f, -rnd.nextVec3() + rnd.nextVec3() * 0.5f );
+
+	size_t numHits = 0;
+	t.start();
+	for( const auto &ray : rays )
+		numHits += bvh.intersect( ray, nullptr ) ? 1 : 0;
+	double raySeconds = t.getSeconds();
+
+	// the loop the samples use, on a few rays
+	const int numBruteForceRays = 20;
+	size_t numBruteForceHits = 0;
+	t.start();
+	for( int i = 0; i < numBruteForceRays; ++i ) {
+		float dist;
+		uint32_t triangle;
+		numBruteForceHits += bruteForceIntersect( mesh, rays[i], &dist, &triangle ) ? 1 : 0;
+	}
+	double bruteForceSeconds = t.getSeconds();
+
+	cout << "Bvh: " << numRays / raySeconds << " rays/s (" << numHits << " hits), brute force: " << numBruteForceRays / bruteForceSeconds << " rays/s" << endl;
+	REQUIRE( numHits > 0 );
+}
@@ -3,6 +3,11 @@
 #include "cinder/Cinder.h"
 #include "cinder/app/App.h"
 #include "cinder/FileWatcher.h"
+#include "cinder/Timer.h"
+
+#include <ctime>
+#include <fstream>
+#include <iostream>
 
 using namespace std;
 using namespace ci;
@@ -12,7 +17,7 @@ const fs::path WATCH_FILE = "test_watch.txt";
 // update file write time 1 second to the future
 void updateFileWriteTime( const fs::path &file )
 {
-	auto fullFilePath = app::getAssetPath( WATCH_FILE );
+	auto fullFilePath = app::getAssetPath( file );
 #if defined( CINDER_POSIX )
 	// TODO: remove this path, once std::filesystem is available accross the board
 	fs::last_write_time( fullFilePath, fs::last_write_time( fullFilePath ) + 1s );
@@ -45,7 +50,7 @@ TEST_CASE( "FileWatcher" )
 		REQUIRE( FileWatcher::instance().getNumWatchedFiles() == 0 );
 
 		int numCallbacksFired = 0;
-		FileWatcher::instance().watch( WATCH_FILE, [&numCallbacksFired]( const WatchEvent &event ) {
+		FileWatcher::instance().watch( WATCH_FILE, [&numCallbacksFired]( const WatchEvent & ) {
 			numCallbacksFired += 1;
 		} );
 
@@ -75,7 +80,7 @@ TEST_CASE( "FileWatcher" )
 		REQUIRE( watcher.getNumWatchedFiles() == 0 );
 
 		int numCallbacksFired = 0;
-		watcher.watch( WATCH_FILE, [&numCallbacksFired]( const WatchEvent &event ) {
+		watcher.watch( WATCH_FILE, [&numCallbacksFired]( const WatchEvent & ) {
 			numCallbacksFired += 1;
 		} );
 
@@ -85,7 +90,7 @@ TEST_CASE( "FileWatcher" )
 
 		updateFileWriteTime( WATCH_FILE );
 		
-		auto test = [&numCallbacksFired](FileWatcher& watcher) -> bool {
+		auto test = [&numCallbacksFired](FileWatcher&) -> bool {
 			return numCallbacksFired == 2;
 		};
 		updateFileWatcher( watcher, 5, test );
@@ -101,7 +106,7 @@ TEST_CASE( "FileWatcher" )
 		watcher.setConnectToAppUpdateEnabled( false );
 
 		int numCallbacksFired = 0;
-		watcher.watch( WATCH_FILE, FileWatcher::Options().callOnWatch( false ), [&numCallbacksFired]( const WatchEvent &event ) {
+		watcher.watch( WATCH_FILE, FileWatcher::Options().callOnWatch( false ), [&numCallbacksFired]( const WatchEvent & ) {
 			numCallbacksFired += 1;
 		} );
 
@@ -109,7 +114,7 @@ TEST_CASE( "FileWatcher" )
 		
 		updateFileWriteTime( WATCH_FILE );
 
-		auto test = [&numCallbacksFired](FileWatcher& watcher) -> bool {
+		auto test = [&numCallbacksFired](FileWatcher&) -> bool {
 			return numCallbacksFired == 1;
 		};
 		updateFileWatcher( watcher, 5, test );
@@ -123,7 +128,7 @@ TEST_CASE( "FileWatcher" )
 		watcher.setConnectToAppUpdateEnabled( false );
 
 		int numCallbacksFired = 0;
-		watcher.watch( WATCH_FILE, [&numCallbacksFired]( const WatchEvent &event ) {
+		watcher.watch( WATCH_FILE, [&numCallbacksFired]( const WatchEvent & ) {
 			numCallbacksFired += 1;
 		} );
 
@@ -134,7 +139,7 @@ TEST_CASE( "FileWatcher" )
 		watcher.unwatch( WATCH_FILE );
 
 		updateFileWriteTime( WATCH_FILE );
-		auto test = [](FileWatcher& watcher) -> bool {
+		auto test = [](FileWatcher&) -> bool {
 			// wait the whole time
 			return false;
 		};
@@ -147,3 +152,244 @@ TEST_CASE( "FileWatcher" )
 		REQUIRE( watcher.getNumWatchedFiles() == 0 );
 	}
 }
+
+namespace {
+
+fs::path createTempDirectory( const string &name )
+{
+	auto dir = fs::temp_directory_path() / ( "cinder_FileWatcherTest_" + name );
+	fs::remove_all( dir );
+	fs::create_directories( dir );
+	return dir;
+}
+
+void writeFile( const fs::path &filePath, const string &contents )
+{
+	ofstream( filePath.string() ) << contents;
+}
+
+// Returns whether \a events reported \a filePath and nothing else. A change may be split across more than one callback, so it can appear more than once.
+bool reportedOnly( const vector<fs::path> &events, const fs::path &filePath )
+{
+	return ! events.empty() && count( events.begin(), events.end(), filePath ) == (ptrdiff_t)events.size();
+}
+
+vector<FileWatcher::Backend> getAvailableBackends()
+{
+	vector<FileWatcher::Backend> result = { FileWatcher::Backend::POLLING };
+	if( FileWatcher::isNativeBackendAvailable() )
+		result.push_back( FileWatcher::Backend::NATIVE );
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "FileWatcher backends" )
+{
+	for( auto backend : getAvailableBackends() ) {
+		const bool native = backend == FileWatcher::Backend::NATIVE;
+		INFO( ( native ? "native backend" : "polling backend" ) );
+
+		FileWatcher watcher;
+		watcher.setConnectToAppUpdateEnabled( false );
+		watcher.setBackend( backend );
+
+		auto dir = createTempDirectory( native ? "native" : "polling" );
+		fs::create_directories( dir / "assets" );
+		const fs::path shaderPath = dir / "shader.glsl";
+		writeFile( shaderPath, "void main() {}" );
+
+		vector<fs::path> shaderEvents, assetEvents;
+		watcher.watch( shaderPath, FileWatcher::Options().callOnWatch( false ), [&]( const WatchEvent &event ) {
+			shaderEvents.insert( shaderEvents.end(), event.getFiles().begin(), event.getFiles().end() );
+		} );
+		watcher.watchDirectory( dir / "assets", FileWatcher::Options().callOnWatch( false ), [&]( const WatchEvent &event ) {
+			assetEvents.insert( assetEvents.end(), event.getFiles().begin(), event.getFiles().end() );
+		} );
+		REQUIRE( watcher.isNativeBackendActive() == native );
+		REQUIRE( watcher.getNumWatches() == 2 );
+
+		// editors commonly save by writing a temporary file and renaming it over the original
+		const fs::path tempPath = dir / "shader.glsl.tmp";
+		writeFile( tempPath, "void main() { discard; }" );
+		fs::last_write_time( tempPath, fs::last_write_time( shaderPath ) + 1s );
+		fs::rename( tempPath, shaderPath );
+
+		updateFileWatcher( watcher, 5, [&]( FileWatcher& ) { return ! shaderEvents.empty(); } );
+		REQUIRE( reportedOnly( shaderEvents, shaderPath ) );
+
+		// files in subdirectories created after the watch are reported
+		fs::create_directories( dir / "assets" / "textures" / "ui" );
+		const fs::path texturePath = dir / "assets" / "textures" / "ui" / "button.png";
+		writeFile( texturePath, "png" );
+
+		updateFileWatcher( watcher, 5, [&]( FileWatcher& ) { return ! assetEvents.empty(); } );
+		REQUIRE( reportedOnly( assetEvents, texturePath ) );
+		REQUIRE( reportedOnly( shaderEvents, shaderPath ) );
+
+		watcher.unwatch( dir / "assets" );
+		REQUIRE( watcher.getNumWatches() == 1 );
+
+		fs::remove_all( dir );
+	}
+}
+
+TEST_CASE( "FileWatcher native backend coalesces events" )
+{
+	if( ! FileWatcher::isNativeBackendAvailable() )
+		return;
+
+	FileWatcher watcher;
+	watcher.setConnectToAppUpdateEnabled( false );
+	watcher.setDebounceInterval( 0.1 );
+
+	auto dir = createTempDirectory( "debounce" );
+	const fs::path filePath = dir / "data.txt";
+	writeFile( filePath, "" );
+
+	int numCallbacksFired = 0;
+	watcher.watch( filePath, FileWatcher::Options().callOnWatch( false ), [&numCallbacksFired]( const WatchEvent & ) {
+		numCallbacksFired += 1;
+	} );
+
+	const int numWrites = 20;
+	auto timeStamp = fs::last_write_time( filePath );
+	for( int i = 0; i < numWrites; ++i ) {
+		ofstream( filePath.string(), ios::app ) << i;
+		fs::last_write_time( filePath, timeStamp + chrono::seconds( i + 1 ) );
+	}
+
+	updateFileWatcher( watcher, 5, [&numCallbacksFired]( FileWatcher& ) { return numCallbacksFired > 0; } );
+	REQUIRE( numCallbacksFired >= 1 );
+
+	// anything still held back is reported within ten debounce intervals of the first write; a slow machine may split the burst, but not write by write
+	updateFileWatcher( watcher, 1.5, []( FileWatcher& ) { return false; } );
+	REQUIRE( numCallbacksFired <= numWrites / 4 );
+
+	fs::remove_all( dir );
+}
+
+TEST_CASE( "FileWatcher recreated and symlinked paths" )
+{
+	for( auto backend : getAvailableBackends() ) {
+		const bool native = backend == FileWatcher::Backend::NATIVE;
+		INFO( ( native ? "native backend" : "polling backend" ) );
+
+		FileWatcher watcher;
+		watcher.setConnectToAppUpdateEnabled( false );
+		watcher.setBackend( backend );
+
+		auto dir = createTempDirectory( native ? "recreated_native" : "recreated_polling" );
+		fs::create_directories( dir / "config" );
+		fs::create_directories( dir / "assets" );
+		fs::create_directories( dir / "shared" );
+		fs::create_directory_symlink( dir / "shared", dir / "assets" / "shared" );
+		const fs::path configPath = dir / "config" / "settings.json";
+		writeFile( configPath, "{}" );
+
+		vector<fs::path> configEvents, assetEvents;
+		watcher.watch( configPath, FileWatcher::Options().callOnWatch( false ), [&]( const WatchEvent &event ) {
+			configEvents.insert( configEvents.end(), event.getFiles().begin(), event.getFiles().end() );
+		} );
+		watcher.watchDirectory( dir / "assets", FileWatcher::Options().callOnWatch( false ), [&]( const WatchEvent &event ) {
+			assetEvents.insert( assetEvents.end(), event.getFiles().begin(), event.getFiles().end() );
+		} );
+
+		// files beneath a symlinked subdirectory are reported through the symlink
+		writeFile( dir / "shared" / "palette.txt", "red" );
+		updateFileWatcher( watcher, 5, [&]( FileWatcher& ) { return ! assetEvents.empty(); } );
+		REQUIRE( reportedOnly( assetEvents, dir / "assets" / "shared" / "palette.txt" ) );
+
+		// the file's directory is deleted and recreated, as some tools and version control checkouts do
+		auto timeStamp = fs::last_write_time( configPath );
+		fs::remove_all( dir / "config" );
+		fs::create_directories( dir / "config" );
+		writeFile( configPath, "{ \"fullscreen\": true }" );
+		fs::last_write_time( configPath, timeStamp + 1s );
+
+		updateFileWatcher( watcher, 5, [&]( FileWatcher& ) { return ! configEvents.empty(); } );
+		REQUIRE( reportedOnly( configEvents, configPath ) );
+
+		fs::remove_all( dir );
+	}
+}
+
+TEST_CASE( "FileWatcher native backend reports continuous writes" )
+{
+	if( ! FileWatcher::isNativeBackendAvailable() )
+		return;
+
+	FileWatcher watcher;
+	watcher.setConnectToAppUpdateEnabled( false );
+	watcher.setDebounceInterval( 0.05 );
+
+	auto dir = createTempDirectory( "continuous" );
+	const fs::path filePath = dir / "log.txt";
+	writeFile( filePath, "" );
+
+	int numCallbacksFired = 0;
+	watcher.watch( filePath, FileWatcher::Options().callOnWatch( false ), [&numCallbacksFired]( const WatchEvent & ) {
+		numCallbacksFired += 1;
+	} );
+
+	// writes arrive faster than the debounce interval, so only the cap on the total delay lets them through
+	auto timeStamp = fs::last_write_time( filePath );
+	Timer timer( true );
+	for( int i = 0; timer.getSeconds() < 5 && numCallbacksFired == 0; ++i ) {
+		ofstream( filePath.string(), ios::app ) << i;
+		fs::last_write_time( filePath, timeStamp + chrono::seconds( i + 1 ) );
+		this_thread::sleep_for( chrono::milliseconds( 10 ) );
+		watcher.update();
+	}
+	REQUIRE( numCallbacksFired > 0 );
+
+	fs::remove_all( dir );
+}
+
+TEST_CASE( "FileWatcherBenchmark", "[.][benchmark]" )
+{
+	const int numFiles = 5000, numChanges = 20;
+	auto dir = createTempDirectory( "benchmark" );
+	vector<fs::path> filePaths;
+	for( int i = 0; i < numFiles; ++i ) {
+		filePaths.push_back( dir / ( "asset" + to_string( i ) + ".txt" ) );
+		writeFile( filePaths.back(), to_string( i ) );
+	}
+
+	for( auto backend : getAvailableBackends() ) {
+		FileWatcher watcher;
+		watcher.setConnectToAppUpdateEnabled( false );
+		watcher.setBackend( backend );
+
+		int numCallbacksFired = 0;
+		watcher.watch( filePaths, FileWatcher::Options().callOnWatch( false ), [&numCallbacksFired]( const WatchEvent & ) {
+			numCallbacksFired += 1;
+		} );
+
+		// CPU time consumed by the watcher thread while nothing changes
+		const clock_t idleStart = clock();
+		this_thread::sleep_for( chrono::seconds( 1 ) );
+		const double idleCpuSeconds = double( clock() - idleStart ) / CLOCKS_PER_SEC;
+
+		// time from modifying a file until its callback fires
+		double totalLatency = 0, maxLatency = 0;
+		for( int i = 0; i < numChanges; ++i ) {
+			const fs::path &filePath = filePaths[( i * 997 ) % numFiles];
+			const int expected = numCallbacksFired + 1;
+			Timer timer( true );
+			fs::last_write_time( filePath, fs::last_write_time( filePath ) + 1s );
+			while( numCallbacksFired < expected && timer.getSeconds() < 5 ) {
+				this_thread::sleep_for( chrono::microseconds( 200 ) );
+				watcher.update();
+			}
+			totalLatency += timer.getSeconds();
+			maxLatency = std::max( maxLatency, timer.getSeconds() );
+		}
+
+		REQUIRE( numCallbacksFired == numChanges );
+		cout << ( watcher.isNativeBackendActive() ? "native" : "polling" ) << " backend, " << numFiles << " files: idle CPU " << idleCpuSeconds * 100 << "%, latency mean "
+			<< totalLatency / numChanges * 1000 << " ms, max " << maxLatency * 1000 << " ms" << endl;
+	}
+
+	fs::remove_all( dir );
+}
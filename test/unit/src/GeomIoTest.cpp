@@ -0,0 +1,216 @@
+#include "catch.hpp"
+#include "cinder/GeomIo.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+#include <typeinfo>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// Wraps a Source and counts how often it is loaded. Clones share the count.
+class CountingSource : public geom::Source {
+  public:
+	CountingSource( const geom::Source &source )
+		: mSource( source.clone() ), mNumLoads( make_shared<int>( 0 ) )
+	{}
+
+	size_t				getNumVertices() const override { return mSource->getNumVertices(); }
+	size_t				getNumIndices() const override { return mSource->getNumIndices(); }
+	geom::Primitive		getPrimitive() const override { return mSource->getPrimitive(); }
+	uint8_t				getAttribDims( geom::Attrib attr ) const override { return mSource->getAttribDims( attr ); }
+	geom::AttribSet		getAvailableAttribs() const override { return mSource->getAvailableAttribs(); }
+	void				loadInto( geom::Target *target, const geom::AttribSet &requestedAttribs ) const override { ++*mNumLoads; mSource->loadInto( target, requestedAttribs ); }
+	CountingSource*		clone() const override { return new CountingSource( *this ); }
+	bool				hashContent( geom::ContentHash *hash ) const override { hash->add( typeid( *mSource ).hash_code() ); return mSource->hashContent( hash ); }
+
+	int		getNumLoads() const { return *mNumLoads; }
+
+  private:
+	CountingSource( const CountingSource &rhs )
+		: mSource( rhs.mSource->clone() ), mNumLoads( rhs.mNumLoads )
+	{}
+
+	unique_ptr<geom::Source>	mSource;
+	shared_ptr<int>				mNumLoads;
+};
+
+bool equalMeshes( const TriMesh &a, const TriMesh &b )
+{
+	return a.getNumVertices() == b.getNumVertices() && a.getIndices() == b.getIndices() && a.getBufferPositions() == b.getBufferPositions()
+		&& a.getNormals() == b.getNormals() && a.getBufferColors() == b.getBufferColors() && a.getBufferTexCoords0() == b.getBufferTexCoords0();
+}
+
+} // anonymous namespace
+
+TEST_CASE( "GeomIo" )
+{
+	// enough vertices to be split into parallel ranges
+	const auto sphere = geom::Sphere().subdivisions( 300 );
+	const TriMesh original( sphere );
+	REQUIRE( original.getNumVertices() > 40000 );
+
+	SECTION( "Transform matches a reference transformation" )
+	{
+		const mat4 matrix = glm::translate( vec3( 1, 2, 3 ) ) * glm::rotate( 0.7f, normalize( vec3( 1, 1, 0 ) ) ) * glm::scale( vec3( 2, 0.5f, 1 ) );
+		const mat3 normalMatrix = glm::transpose( glm::inverse( mat3( matrix ) ) );
+		TriMesh mesh( sphere >> geom::Transform( matrix ), TriMesh::Format().positions().normals().tangents() );
+		TriMesh tangents( sphere, TriMesh::Format().positions().normals().tangents() );
+		REQUIRE( mesh.getNumVertices() == original.getNumVertices() );
+		for( size_t v = 0; v < mesh.getNumVertices(); ++v ) {
+			REQUIRE( distance( mesh.getPositions<3>()[v], vec3( matrix * vec4( original.getPositions<3>()[v], 1 ) ) ) < 1e-5f );
+			REQUIRE( distance( mesh.getNormals()[v], normalize( normalMatrix * original.getNormals()[v] ) ) < 1e-5f );
+			// the tangents at the poles are zero
+			if( length( tangents.getTangents()[v] ) > 0.5f )
+				REQUIRE( distance( mesh.getTangents()[v], normalize( normalMatrix * tangents.getTangents()[v] ) ) < 1e-5f );
+		}
+
+		// 2D positions are promoted to 3D
+		TriMesh rect( geom::Rect( Rectf( 0, 0, 2, 1 ) ) >> geom::Translate( 1, 2, 3 ), TriMesh::Format().positions() );
+		REQUIRE( rect.getAttribDims( geom::POSITION ) == 3 );
+		REQUIRE( rect.calcBoundingBox().getMin() == vec3( 1, 2, 3 ) );
+		REQUIRE( rect.calcBoundingBox().getMax() == vec3( 3, 3, 3 ) );
+	}
+
+	SECTION( "Twist matches a reference twist" )
+	{
+		TriMesh mesh( sphere >> geom::Twist().axis( vec3( 0, -1, 0 ), vec3( 0, 1, 0 ) ).startAngle( 0 ).endAngle( 2 ) );
+		for( size_t v = 0; v < mesh.getNumVertices(); ++v ) {
+			const vec3 &p = original.getPositions<3>()[v];
+			float angle = glm::clamp( ( p.y + 1 ) / 2, 0.0f, 1.0f ) * 2;
+			mat4 rotation = glm::rotate( angle, vec3( 0, 1, 0 ) );
+			REQUIRE( distance( mesh.getPositions<3>()[v], vec3( rotation * vec4( p, 1 ) ) ) < 1e-5f );
+			REQUIRE( distance( mesh.getNormals()[v], vec3( rotation * vec4( original.getNormals()[v], 0 ) ) ) < 1e-5f );
+		}
+	}
+
+	SECTION( "Per-vertex functions give the same result in parallel" )
+	{
+		auto colorFn = []( vec3 v ) { return Colorf( v.x * 0.5f + 0.5f, v.y * 0.5f + 0.5f, v.z * 0.5f + 0.5f ); };
+		auto texCoordFn = []( vec2 t ) { return vec2( t.y, t.x * 2 ); };
+		TriMesh serial( sphere >> geom::ColorFromAttrib( geom::POSITION, colorFn ) >> geom::AttribFn<vec2, vec2>( geom::TEX_COORD_0, texCoordFn ) );
+		TriMesh parallel( sphere >> geom::ColorFromAttrib( geom::POSITION, colorFn ).parallel() >> geom::AttribFn<vec2, vec2>( geom::TEX_COORD_0, texCoordFn ).parallel() );
+		REQUIRE( serial.hasColorsRgb() );
+		REQUIRE( equalMeshes( serial, parallel ) );
+		for( size_t v = 0; v < serial.getNumVertices(); ++v ) {
+			REQUIRE( serial.getColors<3>()[v] == colorFn( original.getPositions<3>()[v] ) );
+			REQUIRE( serial.getTexCoords0<2>()[v] == texCoordFn( original.getTexCoords0<2>()[v] ) );
+		}
+
+		TriMesh constant( sphere >> geom::Constant( geom::COLOR, vec4( 0.1f, 0.2f, 0.3f, 0.4f ) ) );
+		REQUIRE( constant.hasColorsRgba() );
+		for( size_t v = 0; v < constant.getNumVertices(); ++v )
+			REQUIRE( constant.getColors<4>()[v] == ColorAf( 0.1f, 0.2f, 0.3f, 0.4f ) );
+	}
+
+	SECTION( "Chains with the same content are evaluated once" )
+	{
+		geom::SourceMods::clearCache();
+		CountingSource counting( sphere );
+		geom::SourceMods chain = counting >> geom::Twist() >> geom::Translate( 1, 0, 0 );
+		const auto format = TriMesh::Format().positions().normals().texCoords0( 2 );
+		const TriMesh expected( chain, format );
+		REQUIRE( counting.getNumLoads() == 1 );
+
+		// copies and independently built chains share the result
+		TriMesh second( chain, format );
+		geom::SourceMods copy = chain;
+		TriMesh third( copy, format );
+		TriMesh independent( counting >> geom::Twist() >> geom::Translate( 1, 0, 0 ), format );
+		REQUIRE( counting.getNumLoads() == 1 );
+		REQUIRE( equalMeshes( second, expected ) );
+		REQUIRE( equalMeshes( third, expected ) );
+		REQUIRE( equalMeshes( independent, expected ) );
+
+		// a subset of the memoized attributes doesn't evaluate again
+		TriMesh positions( chain, TriMesh::Format().positions() );
+		REQUIRE( counting.getNumLoads() == 1 );
+		REQUIRE( positions.getBufferPositions() == expected.getBufferPositions() );
+		REQUIRE( ! positions.hasNormals() );
+
+		// an attribute which wasn't memoized does, and the result then covers both requests
+		TriMesh withTangents( chain, TriMesh::Format().positions().normals().tangents() );
+		REQUIRE( counting.getNumLoads() == 2 );
+		REQUIRE( withTangents.hasTangents() );
+		TriMesh fourth( chain, format );
+		REQUIRE( counting.getNumLoads() == 2 );
+		REQUIRE( equalMeshes( fourth, expected ) );
+
+		// different modifiers or parameters are a different chain
+		TriMesh scaled( chain >> geom::Scale( 2 ), format );
+		REQUIRE( counting.getNumLoads() == 3 );
+		REQUIRE( scaled.getPositions<3>()[0] == expected.getPositions<3>()[0] * 2.0f );
+		TriMesh lessTwisted( counting >> geom::Twist().endAngle( 1 ) >> geom::Translate( 1, 0, 0 ), format );
+		REQUIRE( counting.getNumLoads() == 4 );
+		REQUIRE( lessTwisted.getBufferPositions() != expected.getBufferPositions() );
+		TriMesh fifth( chain, format );
+		REQUIRE( counting.getNumLoads() == 4 );
+
+		geom::SourceMods::clearCache();
+		TriMesh sixth( chain, format );
+		REQUIRE( counting.getNumLoads() == 5 );
+		REQUIRE( equalMeshes( sixth, expected ) );
+
+		// a Modifier with side effects can't be memoized
+		AxisAlignedBox bounds;
+		TriMesh( chain >> geom::Bounds( &bounds ), format );
+		bounds = AxisAlignedBox();
+		TriMesh( chain >> geom::Bounds( &bounds ), format );
+		REQUIRE( counting.getNumLoads() == 7 );
+		REQUIRE( bounds.getMax().x > 0 );
+
+		// nor anything with a capacity too small to hold it
+		const size_t capacity = geom::SourceMods::getCacheCapacity();
+		geom::SourceMods::clearCache();
+		geom::SourceMods::setCacheCapacity( 1024 );
+		TriMesh seventh( chain, format );
+		TriMesh eighth( chain, format );
+		REQUIRE( counting.getNumLoads() == 9 );
+		REQUIRE( equalMeshes( eighth, expected ) );
+		geom::SourceMods::setCacheCapacity( capacity );
+
+		// combined and non-indexed sources
+		geom::SourceMods combined = ( geom::Cube() >> geom::Translate( 2, 0, 0 ) ) & geom::Rect();
+		REQUIRE( equalMeshes( TriMesh( combined ), TriMesh( ( geom::Cube() >> geom::Translate( 2, 0, 0 ) ) & geom::Rect() ) ) );
+		REQUIRE( equalMeshes( TriMesh( combined ), TriMesh( ( geom::Cube() >> geom::Translate( 2, 0, 0 ) ) & geom::Rect() ) ) );
+		geom::SourceMods rect = geom::Rect() >> geom::Constant( geom::COLOR, vec3( 1, 0, 0 ) );
+		REQUIRE( TriMesh( rect ).getNumTriangles() == 2 );
+		REQUIRE( TriMesh( rect ).getNumTriangles() == 2 );
+	}
+} // GeomIo
+
+TEST_CASE( "GeomIoBenchmark", "[.][benchmark]" )
+{
+	auto sphere = geom::Sphere().subdivisions( 1024 );
+	auto chain = sphere >> geom::Twist() >> geom::Transform( glm::rotate( 0.5f, vec3( 1, 0, 0 ) ) * glm::scale( vec3( 2 ) ) ) >> geom::Constant( geom::COLOR, vec3( 1, 0.5f, 0 ) );
+	const auto format = TriMesh::Format().positions().normals().tangents().colors( 3 );
+
+	Timer t( true );
+	TriMesh source( sphere, format );
+	double sourceSeconds = t.getSeconds();
+
+	// large enough to keep the result
+	const size_t capacity = geom::SourceMods::getCacheCapacity();
+	geom::SourceMods::setCacheCapacity( 256 * 1024 * 1024 );
+	geom::SourceMods::clearCache();
+
+	t.start();
+	TriMesh evaluated( chain, format );
+	double chainSeconds = t.getSeconds();
+
+	TriMesh first( chain, format );
+	const int numLoads = 10;
+	t.start();
+	for( int i = 0; i < numLoads; ++i )
+		TriMesh mesh( chain, format );
+	double cachedSeconds = t.getSeconds() / numLoads;
+
+	cout << evaluated.getNumVertices() << " vertices, " << getNumParallelThreads() << " threads: source " << sourceSeconds * 1000 << " ms, source >> Twist >> Transform >> Constant "
+		<< chainSeconds * 1000 << " ms, memoized load " << cachedSeconds * 1000 << " ms" << endl;
+	REQUIRE( equalMeshes( first, evaluated ) );
+	geom::SourceMods::setCacheCapacity( capacity );
+}
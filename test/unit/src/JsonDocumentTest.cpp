@@ -0,0 +1,249 @@
+#include "cinder/JsonDocument.h"
+#include "cinder/Timer.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+const char *sLibraryJson = R"({
+	"library": {
+		"owner": { "name": "Andrew", "city": "Boston" },
+		// comments are allowed by default
+		"albums": [
+			{ "title": "Rain Dogs", "year": 1985, "rating": 4.5, "tracks": [ { "id": 1, "title": "Singapore" }, { "id": 2, "title": "Clap Hands" } ] },
+			{ "title": "Blue\tValentine \"78\"", "year": 1978, "rating": -2.5e-1, "live": false, "label": null, "tracks": [] }
+		]
+	}
+})";
+
+vector<JsonReader::Token> readTokens( const string &json )
+{
+	vector<JsonReader::Token> result;
+	JsonReader reader( DataSourceBuffer::create( Buffer::create( (void*)json.data(), json.size() ) ) );
+	while( reader.next() != JsonReader::TOKEN_END )
+		result.push_back( reader.getToken() );
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE("JsonDocument")
+{
+	SECTION("Values, paths and iteration")
+	{
+		JsonDocument doc( sLibraryJson );
+		REQUIRE( doc.getRoot().isObject() );
+		REQUIRE( doc["library.owner.city"].getValue() == "Boston" );
+		REQUIRE( doc["library.albums[0].tracks[1]['title']"].getValue() == "Clap Hands" );
+		REQUIRE( doc["LIBRARY.Albums.0.year"].getValue<int>() == 1985 );
+		REQUIRE( doc["library.albums[0].rating"].getValue<float>() == 4.5f );
+		REQUIRE( doc["library.albums[1].rating"].getValue<double>() == -0.25 );
+		REQUIRE( doc["library.albums[1].title"].getValue() == "Blue\tValentine \"78\"" );
+		REQUIRE( doc["library.albums[1].live"].isBool() );
+		REQUIRE( doc["library.albums[1].live"].getValue<bool>() == false );
+		REQUIRE( doc["library.albums[1].label"].isNull() );
+		REQUIRE( doc["library.albums[1].tracks"].getNumChildren() == 0 );
+		REQUIRE( ! doc.getRoot().hasChild( "library.albums[2]" ) );
+		REQUIRE_THROWS_AS( doc["library.missing"], JsonTree::ExcChildNotFound );
+
+		// members keep their document order
+		vector<string> keys;
+		for( const auto &child : doc["library.albums[1]"] )
+			keys.push_back( child.getKey() );
+		REQUIRE( keys == vector<string>( { "title", "year", "rating", "live", "label", "tracks" } ) );
+
+		int trackIdSum = 0;
+		for( JsonDocument::ConstIter trackIt = doc["library.albums[0].tracks"].begin(); trackIt != doc["library.albums[0].tracks"].end(); ++trackIt )
+			trackIdSum += (*trackIt)["id"].getValue<int>();
+		REQUIRE( trackIdSum == 3 );
+
+		// handles follow the document's contents when it is moved
+		JsonDocument::Node owner = doc["library.owner"];
+		JsonDocument moved( std::move( doc ) );
+		REQUIRE( owner["city"].getValue() == "Boston" );
+		REQUIRE( owner.toJsonTree().getValueForKey( "name" ) == "Andrew" );
+	}
+
+	SECTION("Strings are unescaped in place")
+	{
+		JsonDocument doc( R"({ "a\u00e9": "\ud83d\ude00\/\\", "n": [ 18446744073709551615, -9223372036854775808, 1e400 ] })" );
+		JsonDocument::Node node = doc.getRoot().getChild( 0 );
+		REQUIRE( node.getKey() == "a\xC3\xA9" );
+		REQUIRE( node.getKeyLength() == 3 );
+		REQUIRE( node.getValue() == "\xF0\x9F\x98\x80/\\" );
+		REQUIRE( node.getValueData()[node.getValueLength()] == 0 );
+		REQUIRE( doc["n[0]"].getValue<double>() == 18446744073709551615.0 );
+		REQUIRE( doc["n[1]"].getValue<int64_t>() == std::numeric_limits<int64_t>::min() );
+		REQUIRE( doc["n[2]"].getValue<double>() == std::numeric_limits<double>::infinity() );
+		REQUIRE( doc["n[2]"].getValue<int64_t>() == std::numeric_limits<int64_t>::max() );
+
+		// numbers beyond the integer range are clamped to it
+		JsonDocument large( "[ 1e300, -1e300, 1.5e19, 9223372036854775808 ]" );
+		REQUIRE( large.getRoot()[0].getValue<int64_t>() == std::numeric_limits<int64_t>::max() );
+		REQUIRE( large.getRoot()[1].getValue<int64_t>() == std::numeric_limits<int64_t>::min() );
+		REQUIRE( large.getRoot()[2].getValue<uint64_t>() == 15000000000000000000ULL );
+		REQUIRE( large.getRoot()[0].getValue<uint64_t>() == std::numeric_limits<uint64_t>::max() );
+		REQUIRE( large.getRoot()[3].getValue<int64_t>() == std::numeric_limits<int64_t>::max() );
+	}
+
+	SECTION("Malformed input")
+	{
+		REQUIRE_THROWS_AS( JsonDocument( "{ \"a\": 1, }" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "[ 1 2 ]" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "[ 01 ]" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "\"abc" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "{} {}" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "// comment\n[]", JsonTree::ParseOptions().allowComments( false ) ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "\"\\ud83d\"" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "\"\\ude00\\ud83d\"" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( JsonDocument( "\"a\\udfffb\"" ), JsonTree::ExcJsonParserError );
+
+		JsonDocument partial( "{ \"a\": [ 1, 2, tru", JsonTree::ParseOptions().ignoreErrors() );
+		REQUIRE( partial["a"].getNumChildren() == 2 );
+		REQUIRE( partial.getNumNodes() == 4 );
+		REQUIRE( JsonDocument().getRoot().isNull() );
+	}
+
+	SECTION("Conversion to JsonTree matches JsonTree's parser")
+	{
+		// JsonTree's parser reads null members as empty strings, so they are omitted from the comparison
+		string json = "{ \"a\": [ 1, -2, 3.5, \"x\\ny\" ], \"c\": { \"e\": true, \"d\": [] }, \"b\": 1e3 }";
+		REQUIRE( JsonDocument( json ).toJsonTree().serialize() == JsonTree( json ).serialize() );
+
+		JsonDocument doc( sLibraryJson );
+		JsonTree tree = doc.toJsonTree();
+		REQUIRE( &tree.getChild( "library.albums" ).getParent() == &tree.getChild( "library" ) );
+		REQUIRE( doc["library.albums[0]"].toJsonTree().getValueForKey<int>( "year" ) == 1985 );
+	}
+} // JsonDocument
+
+TEST_CASE("JsonReader")
+{
+	SECTION("Token sequence")
+	{
+		typedef JsonReader R;
+		REQUIRE( readTokens( "{ \"a\": [ 1, \"x\", true, null, {} ], \"b\": -0.5 }" ) == vector<R::Token>( { R::TOKEN_BEGIN_OBJECT, R::TOKEN_KEY, R::TOKEN_BEGIN_ARRAY,
+			R::TOKEN_NUMBER, R::TOKEN_STRING, R::TOKEN_BOOL, R::TOKEN_NULL, R::TOKEN_BEGIN_OBJECT, R::TOKEN_END_OBJECT, R::TOKEN_END_ARRAY,
+			R::TOKEN_KEY, R::TOKEN_NUMBER, R::TOKEN_END_OBJECT } ) );
+		REQUIRE( readTokens( " 42 " ) == vector<R::Token>( { R::TOKEN_NUMBER } ) );
+		REQUIRE_THROWS_AS( readTokens( "[ 1, ]" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( readTokens( "[] x" ), JsonTree::ExcJsonParserError );
+		REQUIRE_THROWS_AS( readTokens( "[ \"\\udc00\" ]" ), JsonTree::ExcJsonParserError );
+	}
+
+	SECTION("Values, skip() and readTree()")
+	{
+		JsonReader reader( DataSourceBuffer::create( Buffer::create( (void*)sLibraryJson, strlen( sLibraryJson ) ) ) );
+		REQUIRE( reader.next() == JsonReader::TOKEN_BEGIN_OBJECT );
+		REQUIRE( reader.next() == JsonReader::TOKEN_KEY );
+		REQUIRE( reader.next() == JsonReader::TOKEN_BEGIN_OBJECT );
+		REQUIRE( reader.next() == JsonReader::TOKEN_KEY );
+		REQUIRE( reader.getString() == "owner" );
+		reader.skip();
+		REQUIRE( reader.getToken() == JsonReader::TOKEN_END_OBJECT );
+		REQUIRE( reader.next() == JsonReader::TOKEN_KEY );
+		REQUIRE( reader.next() == JsonReader::TOKEN_BEGIN_ARRAY );
+		REQUIRE( reader.getDepth() == 3 );
+		REQUIRE( reader.next() == JsonReader::TOKEN_BEGIN_OBJECT );
+		JsonTree album = reader.readTree();
+		REQUIRE( album.getValueForKey( "title" ) == "Rain Dogs" );
+		REQUIRE( album.getValueForKey<double>( "rating" ) == 4.5 );
+		REQUIRE( album.getChild( "tracks" ).getNumChildren() == 2 );
+		REQUIRE( reader.next() == JsonReader::TOKEN_BEGIN_OBJECT );
+		REQUIRE( reader.next() == JsonReader::TOKEN_KEY );
+		REQUIRE( reader.next() == JsonReader::TOKEN_STRING );
+		REQUIRE( reader.getString() == "Blue\tValentine \"78\"" );
+		REQUIRE( reader.next() == JsonReader::TOKEN_KEY );
+		REQUIRE( reader.next() == JsonReader::TOKEN_NUMBER );
+		REQUIRE( reader.isInteger() );
+		REQUIRE( reader.getInt64() == 1978 );
+		REQUIRE( reader.getKey() == "year" );
+
+		const char *largeJson = "[ -1e300, 1e19 ]";
+		JsonReader large( DataSourceBuffer::create( Buffer::create( (void*)largeJson, strlen( largeJson ) ) ) );
+		large.next();
+		REQUIRE( large.next() == JsonReader::TOKEN_NUMBER );
+		REQUIRE( large.getInt64() == std::numeric_limits<int64_t>::min() );
+		REQUIRE( large.next() == JsonReader::TOKEN_NUMBER );
+		REQUIRE( ! large.isInteger() );
+		REQUIRE( large.getInt64() == std::numeric_limits<int64_t>::max() );
+	}
+
+	SECTION("Tokens spanning buffer refills")
+	{
+		string longString( 200000, 'a' );
+		longString[100000] = '\\';
+		longString[100001] = 'n';
+		ostringstream ss;
+		ss << "[ \"" << longString << "\", ";
+		for( int i = 0; i < 20000; ++i )
+			ss << i * 0.125 << ", ";
+		ss << "\"\\u00e9\" ]";
+		string json = ss.str();
+
+		JsonReader reader( DataSourceBuffer::create( Buffer::create( (void*)json.data(), json.size() ) ) );
+		REQUIRE( reader.next() == JsonReader::TOKEN_BEGIN_ARRAY );
+		REQUIRE( reader.next() == JsonReader::TOKEN_STRING );
+		REQUIRE( reader.getString().size() == longString.size() - 1 );
+		REQUIRE( reader.getString()[100000] == '\n' );
+		double sum = 0;
+		while( reader.next() == JsonReader::TOKEN_NUMBER )
+			sum += reader.getDouble();
+		REQUIRE( sum == Approx( 0.125 * 19999 * 20000 / 2 ) );
+		REQUIRE( reader.getString() == "\xC3\xA9" );
+		REQUIRE( reader.next() == JsonReader::TOKEN_END_ARRAY );
+		REQUIRE( reader.next() == JsonReader::TOKEN_END );
+		REQUIRE( reader.getOffset() == json.size() );
+	}
+} // JsonReader
+
+TEST_CASE("JsonParseBenchmark", "[.][benchmark]")
+{
+	ostringstream ss;
+	ss << "{ \"features\": [";
+	for( int i = 0; i < 100000; ++i ) {
+		ss << ( i ? "," : "" ) << "{ \"type\": \"Feature\", \"id\": " << i << ", \"properties\": { \"name\": \"feature " << i
+			<< "\", \"visible\": true }, \"geometry\": { \"type\": \"LineString\", \"coordinates\": [";
+		for( int c = 0; c < 8; ++c )
+			ss << ( c ? "," : "" ) << "[" << i * 0.001 + c << "," << -i * 0.002 - c << "]";
+		ss << "] } }";
+	}
+	ss << "] }";
+	const string json = ss.str();
+	const double megabytes = json.size() / 1.0e6;
+
+	Timer t( true );
+	JsonTree tree( json );
+	double treeSeconds = t.getSeconds();
+
+	t.start();
+	JsonDocument doc( json );
+	double docSeconds = t.getSeconds();
+
+	t.start();
+	JsonTree treeFromDoc = doc.toJsonTree();
+	double docToTreeSeconds = t.getSeconds();
+
+	t.start();
+	size_t numbers = 0;
+	JsonReader reader( DataSourceBuffer::create( Buffer::create( (void*)json.data(), json.size() ) ) );
+	while( reader.next() != JsonReader::TOKEN_END )
+		numbers += reader.getToken() == JsonReader::TOKEN_NUMBER;
+	double readerSeconds = t.getSeconds();
+
+	REQUIRE( doc["features"].getNumChildren() == 100000 );
+	REQUIRE( numbers == 100000 * 17 );
+	cout << "Parsing " << megabytes << " MB of JSON:" << endl;
+	cout << "  JsonTree:                 " << treeSeconds << " s (" << megabytes / treeSeconds << " MB/s)" << endl;
+	cout << "  JsonDocument:             " << docSeconds << " s (" << megabytes / docSeconds << " MB/s)" << endl;
+	cout << "  JsonDocument to JsonTree: " << docToTreeSeconds << " s" << endl;
+	cout << "  JsonReader:               " << readerSeconds << " s (" << megabytes / readerSeconds << " MB/s)" << endl;
+}
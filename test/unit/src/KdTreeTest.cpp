@@ -0,0 +1,212 @@
+#include "catch.hpp"
+#include "cinder/KdTree.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// Collects the points reported to KdTree::lookup()
+struct CollectLookupProc {
+	CollectLookupProc( vector<uint32_t> *result ) : mResult( result ) {}
+	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) const { mResult->push_back( id ); }
+
+	vector<uint32_t>	*mResult;
+};
+
+// Returns the indices of all points sorted by their distance to p, ties by index
+template<typename T>
+vector<pair<float, uint32_t>> sortByDistance( const vector<T> &points, const T &p )
+{
+	vector<pair<float, uint32_t>> result;
+	for( uint32_t i = 0; i < points.size(); ++i )
+		result.emplace_back( distance2( points[i], p ), i );
+	sort( result.begin(), result.end() );
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "KdTree" )
+{
+	Rand rnd( 5678 );
+	vector<vec3> points;
+	for( int i = 0; i < 5000; ++i )
+		points.push_back( rnd.nextVec3() * rnd.nextFloat( 0, 10 ) );
+	// duplicates and a plane of points with equal coordinates on one axis
+	for( int i = 0; i < 100; ++i ) {
+		points.push_back( points[i] );
+		points.push_back( vec3( rnd.nextFloat( -10, 10 ), 3, rnd.nextFloat( -10, 10 ) ) );
+	}
+	KdTree<vec3> tree( points );
+	REQUIRE( tree.getNumPoints() == points.size() );
+
+	SECTION( "Nearest neighbors match brute force" )
+	{
+		for( int q = 0; q < 200; ++q ) {
+			vec3 p = rnd.nextVec3() * rnd.nextFloat( 0, 12 );
+			auto expected = sortByDistance( points, p );
+
+			float pt[3] = { p.x, p.y, p.z }, result[3];
+			uint32_t index;
+			tree.findNearest( pt, result, &index );
+			REQUIRE( distance2( points[index], p ) == expected[0].first );
+			REQUIRE( vec3( result[0], result[1], result[2] ) == points[index] );
+
+			const size_t k = 12;
+			uint32_t indices[k];
+			float distancesSqrd[k];
+			REQUIRE( tree.findNearest( p, k, indices, distancesSqrd ) == k );
+			for( size_t i = 0; i < k; ++i ) {
+				REQUIRE( distancesSqrd[i] == expected[i].first );
+				REQUIRE( distance2( points[indices[i]], p ) == distancesSqrd[i] );
+			}
+
+			// limited by the maximum distance
+			const float maxDist = sqrt( expected[5].first ) + 0.0001f;
+			const size_t numWithin = count_if( expected.begin(), expected.begin() + k, [&]( const pair<float, uint32_t> &e ) { return e.first < maxDist * maxDist; } );
+			REQUIRE( numWithin >= 6 );
+			REQUIRE( tree.findNearest( p, k, indices, nullptr, maxDist ) == numWithin );
+			for( size_t i = 0; i < numWithin; ++i )
+				REQUIRE( distance2( points[indices[i]], p ) == expected[i].first );
+
+			// more neighbors than fit on the stack
+			vector<uint32_t> many( 100 );
+			REQUIRE( tree.findNearest( p, many.size(), many.data() ) == many.size() );
+			for( size_t i = 0; i < many.size(); ++i )
+				REQUIRE( distance2( points[many[i]], p ) == expected[i].first );
+		}
+	}
+
+	SECTION( "Radius queries match brute force" )
+	{
+		for( int q = 0; q < 200; ++q ) {
+			vec3 p = rnd.nextVec3() * rnd.nextFloat( 0, 12 );
+			float radius = rnd.nextFloat( 0, 3 );
+			vector<uint32_t> expected, result, lookupResult;
+			vector<float> distancesSqrd;
+			for( uint32_t i = 0; i < points.size(); ++i ) {
+				if( distance2( points[i], p ) <= radius * radius )
+					expected.push_back( i );
+			}
+			REQUIRE( tree.findInRadius( p, radius, &result, &distancesSqrd ) == expected.size() );
+			REQUIRE( distancesSqrd.size() == result.size() );
+			for( size_t i = 0; i < result.size(); ++i )
+				REQUIRE( distance2( points[result[i]], p ) == distancesSqrd[i] );
+			sort( result.begin(), result.end() );
+			REQUIRE( result == expected );
+
+			// lookup() reports points strictly closer than the distance
+			KdTree<vec3, 3, CollectLookupProc> lookupTree( points );
+			lookupTree.lookup( p, CollectLookupProc( &lookupResult ), radius );
+			sort( lookupResult.begin(), lookupResult.end() );
+			expected.erase( remove_if( expected.begin(), expected.end(), [&]( uint32_t i ) { return distance2( points[i], p ) >= radius * radius; } ), expected.end() );
+			REQUIRE( lookupResult == expected );
+		}
+	}
+
+	SECTION( "Batched queries match single queries" )
+	{
+		vector<vec3> queries;
+		for( int q = 0; q < 5000; ++q )
+			queries.push_back( rnd.nextVec3() * rnd.nextFloat( 0, 12 ) );
+		const size_t k = 4;
+		vector<uint32_t> indices( queries.size() * k );
+		vector<float> distancesSqrd( queries.size() * k );
+		tree.findNearest( queries.data(), queries.size(), k, indices.data(), distancesSqrd.data() );
+		for( size_t q = 0; q < queries.size(); ++q ) {
+			uint32_t expected[k];
+			tree.findNearest( queries[q], k, expected );
+			for( size_t i = 0; i < k; ++i ) {
+				REQUIRE( indices[q * k + i] == expected[i] );
+				REQUIRE( distancesSqrd[q * k + i] == distance2( points[expected[i]], queries[q] ) );
+			}
+		}
+
+		// results beyond the points found are padded
+		tree.findNearest( queries.data(), queries.size(), k, indices.data(), distancesSqrd.data(), 0.0f );
+		REQUIRE( indices[0] == KdTree<vec3>::INVALID );
+		REQUIRE( distancesSqrd[0] == FLT_MAX );
+	}
+
+	SECTION( "Rebuilding, 2D and empty trees" )
+	{
+		vector<vec3> fewer( points.begin(), points.begin() + 3 );
+		tree.initialize( fewer );
+		REQUIRE( tree.getNumPoints() == 3 );
+		uint32_t indices[5];
+		REQUIRE( tree.findNearest( fewer[1], 5, indices ) == 3 );
+		REQUIRE( indices[0] == 1 );
+
+		tree.initialize( vector<vec3>() );
+		REQUIRE( tree.findNearest( vec3( 0 ), 5, indices ) == 0 );
+		float pt[3] = { 0, 0, 0 }, result[3];
+		tree.findNearest( pt, result, indices );
+		REQUIRE( indices[0] == KdTree<vec3>::INVALID );
+		vector<uint32_t> inRadius;
+		REQUIRE( tree.findInRadius( vec3( 0 ), 100, &inRadius ) == 0 );
+		REQUIRE( KdTree<vec3>().getNumPoints() == 0 );
+
+		vector<vec2> points2d;
+		for( int i = 0; i < 1000; ++i )
+			points2d.push_back( rnd.nextVec2() * rnd.nextFloat( 0, 10 ) );
+		KdTree<vec2, 2> tree2d( points2d );
+		for( int q = 0; q < 50; ++q ) {
+			vec2 p = rnd.nextVec2() * 10.0f;
+			auto expected = sortByDistance( points2d, p );
+			uint32_t nearest[3];
+			REQUIRE( tree2d.findNearest( p, 3, nearest ) == 3 );
+			for( int i = 0; i < 3; ++i )
+				REQUIRE( distance2( points2d[nearest[i]], p ) == expected[i].first );
+		}
+	}
+} // KdTree
+
+TEST_CASE( "KdTreeBenchmark", "[.][benchmark]" )
+{
+	const size_t numPoints = 1000000, numQueries = 100000, k = 8;
+	Rand rnd( 1 );
+	vector<vec3> points, queries;
+	for( size_t i = 0; i < numPoints; ++i )
+		points.push_back( vec3( rnd.nextFloat( -100, 100 ), rnd.nextFloat( -100, 100 ), rnd.nextFloat( -10, 10 ) ) );
+	for( size_t i = 0; i < numQueries; ++i )
+		queries.push_back( vec3( rnd.nextFloat( -100, 100 ), rnd.nextFloat( -100, 100 ), rnd.nextFloat( -10, 10 ) ) );
+
+	Timer t( true );
+	KdTree<vec3> tree( points );
+	double buildSeconds = t.getSeconds();
+
+	vector<uint32_t> indices( numQueries * k );
+	t.start();
+	for( size_t q = 0; q < numQueries; ++q ) {
+		float pt[3] = { queries[q].x, queries[q].y, queries[q].z }, result[3];
+		tree.findNearest( pt, result, &indices[q] );
+	}
+	double nearestSeconds = t.getSeconds();
+
+	t.start();
+	for( size_t q = 0; q < numQueries; ++q )
+		tree.findNearest( queries[q], k, &indices[q * k] );
+	double knnSeconds = t.getSeconds();
+
+	t.start();
+	tree.findNearest( queries.data(), numQueries, k, indices.data() );
+	double batchedSeconds = t.getSeconds();
+
+	vector<uint32_t> inRadius;
+	t.start();
+	for( size_t q = 0; q < numQueries; ++q ) {
+		inRadius.clear();
+		tree.findInRadius( queries[q], 1.0f, &inRadius );
+	}
+	double radiusSeconds = t.getSeconds();
+
+	cout << numPoints << " points, " << getNumParallelThreads() << " threads: build " << buildSeconds * 1000 << " ms" << endl;
+	cout << numQueries << " queries: nearest " << nearestSeconds * 1000 << " ms, " << k << " nearest " << knnSeconds * 1000 << " ms, batched " << batchedSeconds * 1000
+		<< " ms, radius " << radiusSeconds * 1000 << " ms" << endl;
+	REQUIRE( tree.getNumPoints() == numPoints );
+}
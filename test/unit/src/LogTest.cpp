@@ -0,0 +1,263 @@
+#include "catch.hpp"
+#include "cinder/Log.h"
+#include "cinder/Timer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// Records every write, optionally slowly to back up the queue
+class LoggerRecord : public log::Logger {
+  public:
+	LoggerRecord( int delayMicroseconds = 0 )
+		: mDelayMicroseconds( delayMicroseconds )
+	{}
+
+	void write( const log::Metadata &meta, const std::string &text ) override
+	{
+		if( mDelayMicroseconds > 0 )
+			this_thread::sleep_for( chrono::microseconds( mDelayMicroseconds ) );
+		mRecords.push_back( make_pair( meta.mLevel, text ) );
+		mThreadIds.push_back( this_thread::get_id() );
+	}
+
+	int								mDelayMicroseconds;
+	vector<pair<log::Level, string>>	mRecords;
+	vector<thread::id>				mThreadIds;
+};
+
+class LoggerNull : public log::Logger {
+  public:
+	void write( const log::Metadata &meta, const std::string &text ) override {}
+};
+
+// Formats and writes each record like a file logger would, without touching the disk
+class LoggerDevNull : public log::Logger {
+  public:
+#if defined( CINDER_MSW )
+	LoggerDevNull()		{ mFile = fopen( "NUL", "w" ); }
+#else
+	LoggerDevNull()		{ mFile = fopen( "/dev/null", "w" ); }
+#endif
+	~LoggerDevNull()	{ if( mFile ) fclose( mFile ); }
+
+	void write( const log::Metadata &meta, const std::string &text ) override
+	{
+		if( mFile ) {
+			fprintf( mFile, "%d %s[%d] %s\n", (int)meta.mLevel, meta.mLocation.getFunctionName().c_str(), (int)meta.mLocation.getLineNumber(), text.c_str() );
+			fflush( mFile );
+		}
+	}
+
+	FILE	*mFile;
+};
+
+void writeRecord( log::Level level, const string &text )
+{
+	log::Metadata meta;
+	meta.mLevel = level;
+	meta.mLocation = log::Location( CINDER_CURRENT_FUNCTION, __FILE__, __LINE__ );
+	log::manager()->write( meta, text );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Log" )
+{
+	log::LogManager *manager = log::manager();
+
+	SECTION( "Asynchronous records keep per-thread order and all arrive after flush" )
+	{
+		auto logger = make_shared<LoggerRecord>();
+		manager->resetLogger( logger );
+		manager->enableAsync( log::LogManager::AsyncOptions().capacity( 64 ).maxBatchSize( 16 ) );
+		REQUIRE( manager->isAsync() );
+
+		const int numThreads = 4, numRecords = 5000;
+		vector<thread> threads;
+		for( int t = 0; t < numThreads; ++t ) {
+			threads.emplace_back( [t] {
+				for( int i = 0; i < numRecords; ++i )
+					writeRecord( log::LEVEL_INFO, to_string( t ) + " " + to_string( i ) );
+			} );
+		}
+		for( auto &t : threads )
+			t.join();
+		manager->flush();
+
+		REQUIRE( logger->mRecords.size() == numThreads * numRecords );
+		vector<int> next( numThreads, 0 );
+		for( const auto &record : logger->mRecords ) {
+			const int t = stoi( record.second );
+			const int i = stoi( record.second.substr( record.second.find( ' ' ) + 1 ) );
+			REQUIRE( i == next[t] );
+			next[t] = i + 1;
+		}
+		REQUIRE( logger->mThreadIds.front() != this_thread::get_id() );
+		REQUIRE( manager->getNumDroppedRecords() == 0 );
+
+		manager->disableAsync();
+		REQUIRE( ! manager->isAsync() );
+	}
+
+	SECTION( "OVERFLOW_DROP drops records below LEVEL_ERROR and reports them" )
+	{
+		auto logger = make_shared<LoggerRecord>( 200 );
+		manager->resetLogger( logger );
+		manager->enableAsync( log::LogManager::AsyncOptions().capacity( 4 ).overflowPolicy( log::OVERFLOW_DROP ) );
+
+		int numErrors = 0;
+		for( int i = 0; i < 400; ++i ) {
+			if( i % 10 == 0 ) {
+				writeRecord( log::LEVEL_ERROR, "error" );
+				++numErrors;
+			}
+			else
+				writeRecord( log::LEVEL_INFO, "info" );
+		}
+		manager->flush();
+
+		const uint64_t numDropped = manager->getNumDroppedRecords();
+		REQUIRE( numDropped > 0 );
+		// disabling writes out the last of the dropped warnings
+		manager->disableAsync();
+
+		size_t numInfos = 0, numErrorsWritten = 0;
+		uint64_t numReported = 0;
+		for( const auto &record : logger->mRecords ) {
+			if( record.first == log::LEVEL_ERROR )
+				++numErrorsWritten;
+			else if( record.first == log::LEVEL_INFO )
+				++numInfos;
+			else if( record.first == log::LEVEL_WARNING )
+				numReported += stoull( record.second.substr( record.second.find( ' ' ) + 1 ) );
+		}
+		REQUIRE( numErrorsWritten == numErrors );
+		REQUIRE( numInfos + numDropped == 400 - numErrors );
+		REQUIRE( numReported == numDropped );
+	}
+
+	SECTION( "Fatal records are written before write() returns" )
+	{
+		auto logger = make_shared<LoggerRecord>( 100 );
+		manager->resetLogger( logger );
+		manager->enableAsync();
+		for( int i = 0; i < 50; ++i )
+			writeRecord( log::LEVEL_INFO, "info" );
+		writeRecord( log::LEVEL_FATAL, "fatal" );
+		{
+			lock_guard<mutex> lock( manager->getMutex() );
+			REQUIRE( logger->mRecords.size() == 51 );
+			REQUIRE( logger->mRecords.back().second == "fatal" );
+		}
+		manager->disableAsync();
+	}
+
+	SECTION( "disableAsync() returns to writing on the calling thread" )
+	{
+		auto logger = make_shared<LoggerRecord>();
+		manager->resetLogger( logger );
+		manager->enableAsync();
+		manager->enableAsync( log::LogManager::AsyncOptions().capacity( 16 ) );
+		writeRecord( log::LEVEL_INFO, "async" );
+		manager->disableAsync();
+		REQUIRE( logger->mRecords.size() == 1 );
+
+		writeRecord( log::LEVEL_INFO, "sync" );
+		REQUIRE( logger->mRecords.size() == 2 );
+		REQUIRE( logger->mThreadIds.back() == this_thread::get_id() );
+		REQUIRE( manager->getNumDroppedRecords() == 0 );
+
+		// flushing while synchronous does nothing
+		manager->flush();
+	}
+
+	SECTION( "Records keep per-thread order while switching modes" )
+	{
+		auto logger = make_shared<LoggerRecord>( 20 );
+		manager->resetLogger( logger );
+
+		const int numThreads = 3, numRecords = 3000;
+		vector<thread> threads;
+		for( int t = 0; t < numThreads; ++t ) {
+			threads.emplace_back( [t] {
+				for( int i = 0; i < numRecords; ++i )
+					writeRecord( log::LEVEL_INFO, to_string( t ) + " " + to_string( i ) );
+			} );
+		}
+		for( int i = 0; i < 20; ++i ) {
+			manager->enableAsync( log::LogManager::AsyncOptions().capacity( 256 ) );
+			this_thread::sleep_for( chrono::milliseconds( 2 ) );
+			if( i % 2 )
+				manager->disableAsync();
+			this_thread::sleep_for( chrono::milliseconds( 2 ) );
+		}
+		for( auto &t : threads )
+			t.join();
+		manager->disableAsync();
+
+		REQUIRE( logger->mRecords.size() == numThreads * numRecords );
+		vector<int> next( numThreads, 0 );
+		for( const auto &record : logger->mRecords ) {
+			const int t = stoi( record.second );
+			const int i = stoi( record.second.substr( record.second.find( ' ' ) + 1 ) );
+			REQUIRE( i == next[t] );
+			next[t] = i + 1;
+		}
+	}
+
+	manager->restoreToDefault();
+}
+
+TEST_CASE( "LogBenchmark", "[.][benchmark]" )
+{
+	log::LogManager *manager = log::manager();
+
+	const int numRecords = 20000;
+	for( int devNull = 0; devNull < 2; ++devNull ) {
+		for( int numThreads : { 1, 2, 4, 8 } ) {
+			if( devNull )
+				manager->resetLogger( make_shared<LoggerDevNull>() );
+			else
+				manager->resetLogger( make_shared<LoggerNull>() );
+
+			for( int async = 0; async < 2; ++async ) {
+				if( async )
+					manager->enableAsync();
+
+				vector<vector<double>> latencies( numThreads );
+				vector<thread> threads;
+				for( int t = 0; t < numThreads; ++t ) {
+					threads.emplace_back( [&latencies, t] {
+						latencies[t].reserve( numRecords );
+						for( int i = 0; i < numRecords; ++i ) {
+							Timer timer( true );
+							writeRecord( log::LEVEL_INFO, "a log record of a typical length, with a number " + to_string( i ) );
+							latencies[t].push_back( timer.getSeconds() );
+						}
+					} );
+				}
+				for( auto &t : threads )
+					t.join();
+				manager->disableAsync();
+
+				vector<double> all;
+				for( const auto &l : latencies )
+					all.insert( all.end(), l.begin(), l.end() );
+				sort( all.begin(), all.end() );
+				double sum = 0;
+				for( double l : all )
+					sum += l;
+				cout << ( devNull ? "file logger, " : "null logger, " ) << numThreads << " threads, " << ( async ? "async" : "sync " )
+					<< ": mean " << sum / all.size() * 1e9 << " ns, p99 " << all[all.size() * 99 / 100] * 1e9 << " ns" << endl;
+			}
+		}
+	}
+
+	manager->restoreToDefault();
+}
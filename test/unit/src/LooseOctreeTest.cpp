@@ -0,0 +1,210 @@
+#include "catch.hpp"
+#include "cinder/LooseOctree.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+#include <map>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+AxisAlignedBox randomBox( Rand &rnd, float extent, float maxSize )
+{
+	vec3 center( rnd.nextFloat( -extent, extent ), rnd.nextFloat( -extent, extent ), rnd.nextFloat( -extent, extent ) );
+	vec3 halfSize( rnd.nextFloat( 0, maxSize ), rnd.nextFloat( 0, maxSize ), rnd.nextFloat( 0, maxSize ) );
+	return AxisAlignedBox( center - halfSize, center + halfSize );
+}
+
+// Returns the distance at which \a ray enters \a box, or -1 if it misses it within [0, maxDistance]
+float rayEnter( const Ray &ray, const AxisAlignedBox &box, float maxDistance )
+{
+	float enter = 0, exit = maxDistance;
+	for( int a = 0; a < 3; ++a ) {
+		float t0 = ( box.getMin()[a] - ray.getOrigin()[a] ) * ray.getInverseDirection()[a];
+		float t1 = ( box.getMax()[a] - ray.getOrigin()[a] ) * ray.getInverseDirection()[a];
+		enter = std::max( enter, std::min( t0, t1 ) );
+		exit = std::min( exit, std::max( t0, t1 ) );
+	}
+	return ( enter <= exit ) ? enter : -1;
+}
+
+vector<uint32_t> sorted( vector<uint32_t> ids )
+{
+	sort( ids.begin(), ids.end() );
+	return ids;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "LooseOctree" )
+{
+	Rand rnd( 1234 );
+	LooseOctree octree( AxisAlignedBox( vec3( -100 ), vec3( 100 ) ) );
+	map<uint32_t, AxisAlignedBox> boxes;
+	for( int i = 0; i < 3000; ++i ) {
+		// mostly small boxes, some large ones and some outside the bounds
+		AxisAlignedBox box = randomBox( rnd, ( i % 10 == 0 ) ? 150.0f : 100.0f, ( i % 50 == 0 ) ? 40.0f : 2.0f );
+		boxes[octree.insert( box )] = box;
+	}
+	REQUIRE( octree.getNumItems() == boxes.size() );
+
+	auto checkQueries = [&]() {
+		REQUIRE( octree.getNumItems() == boxes.size() );
+
+		for( int i = 0; i < 20; ++i ) {
+			CameraPersp cam( 640, 480, rnd.nextFloat( 20, 90 ), 1, rnd.nextFloat( 50, 300 ) );
+			cam.lookAt( rnd.nextVec3() * rnd.nextFloat( 0, 150 ), rnd.nextVec3() * 50.0f );
+			Frustum frustum( cam );
+			vector<uint32_t> expected, result;
+			for( const auto &box : boxes ) {
+				if( frustum.intersects( box.second ) )
+					expected.push_back( box.first );
+			}
+			REQUIRE( octree.query( frustum, &result ) == expected.size() );
+			REQUIRE( sorted( result ) == expected );
+		}
+
+		for( int i = 0; i < 20; ++i ) {
+			AxisAlignedBox query = randomBox( rnd, 120, 30 );
+			vector<uint32_t> expected, result;
+			for( const auto &box : boxes ) {
+				if( ! glm::any( glm::lessThan( box.second.getMax(), query.getMin() ) ) && ! glm::any( glm::greaterThan( box.second.getMin(), query.getMax() ) ) )
+					expected.push_back( box.first );
+			}
+			REQUIRE( octree.query( query, &result ) == expected.size() );
+			REQUIRE( sorted( result ) == expected );
+		}
+
+		for( int i = 0; i < 20; ++i ) {
+			Sphere sphere( rnd.nextVec3() * rnd.nextFloat( 0, 120 ), rnd.nextFloat( 0, 30 ) );
+			vector<uint32_t> expected, result;
+			for( const auto &box : boxes ) {
+				vec3 closest = glm::clamp( sphere.getCenter(), box.second.getMin(), box.second.getMax() );
+				if( distance2( closest, sphere.getCenter() ) <= sphere.getRadius() * sphere.getRadius() )
+					expected.push_back( box.first );
+			}
+			REQUIRE( octree.query( sphere, &result ) == expected.size() );
+			REQUIRE( sorted( result ) == expected );
+		}
+
+		for( int i = 0; i < 20; ++i ) {
+			Ray ray( rnd.nextVec3() * 150.0f, rnd.nextVec3() );
+			vector<uint32_t> expected, result;
+			for( const auto &box : boxes ) {
+				if( rayEnter( ray, box.second, 100 ) >= 0 )
+					expected.push_back( box.first );
+			}
+			REQUIRE( octree.intersect( ray, &result, 100 ) == expected.size() );
+			REQUIRE( sorted( result ) == expected );
+			for( size_t h = 1; h < result.size(); ++h )
+				REQUIRE( rayEnter( ray, boxes[result[h - 1]], 100 ) <= rayEnter( ray, boxes[result[h]], 100 ) );
+		}
+	};
+
+	SECTION( "Queries match brute force" )
+	{
+		checkQueries();
+	}
+
+	SECTION( "Move and remove" )
+	{
+		for( int frame = 0; frame < 3; ++frame ) {
+			for( auto &box : boxes ) {
+				// small steps mostly stay in the same cell, some boxes jump across the bounds
+				if( rnd.nextFloat() < 0.1f )
+					box.second = randomBox( rnd, 120, 5 );
+				else
+					box.second = AxisAlignedBox( box.second.getMin() + rnd.nextVec3() * 0.5f, box.second.getMax() + rnd.nextVec3() * 0.5f );
+				octree.move( box.first, box.second );
+				REQUIRE( distance( octree.getBounds( box.first ).getMin(), box.second.getMin() ) < 1e-4f );
+			}
+
+			for( auto it = boxes.begin(); it != boxes.end(); ) {
+				if( rnd.nextFloat() < 0.2f ) {
+					octree.remove( it->first );
+					REQUIRE_FALSE( octree.contains( it->first ) );
+					it = boxes.erase( it );
+				}
+				else
+					++it;
+			}
+			for( int i = 0; i < 300; ++i ) {
+				AxisAlignedBox box = randomBox( rnd, 100, 3 );
+				uint32_t id = octree.insert( box );
+				REQUIRE( boxes.count( id ) == 0 );
+				boxes[id] = box;
+			}
+
+			checkQueries();
+		}
+
+		REQUIRE_THROWS_AS( octree.remove( 1000000 ), LooseOctreeExc );
+		uint32_t id = boxes.begin()->first;
+		octree.remove( id );
+		REQUIRE_THROWS_AS( octree.move( id, AxisAlignedBox() ), LooseOctreeExc );
+
+		octree.clear();
+		REQUIRE( octree.getNumItems() == 0 );
+		vector<uint32_t> result;
+		REQUIRE( octree.query( AxisAlignedBox( vec3( -1000 ), vec3( 1000 ) ), &result ) == 0 );
+	}
+} // LooseOctree
+
+TEST_CASE( "LooseOctreeBenchmark", "[.][benchmark]" )
+{
+	const int numItems = 100000;
+	Rand rnd( 1 );
+	vector<AxisAlignedBox> boxes;
+	for( int i = 0; i < numItems; ++i )
+		boxes.push_back( randomBox( rnd, 500, 2 ) );
+
+	Timer t( true );
+	LooseOctree octree( AxisAlignedBox( vec3( -500 ), vec3( 500 ) ) );
+	vector<uint32_t> ids;
+	for( const auto &box : boxes )
+		ids.push_back( octree.insert( box ) );
+	double insertSeconds = t.getSeconds();
+
+	t.start();
+	for( int i = 0; i < numItems; ++i ) {
+		boxes[i] = AxisAlignedBox( boxes[i].getMin() + vec3( 0.1f ), boxes[i].getMax() + vec3( 0.1f ) );
+		octree.move( ids[i], boxes[i] );
+	}
+	double moveSeconds = t.getSeconds();
+
+	const int numFrusta = 100;
+	vector<Frustum> frusta;
+	for( int i = 0; i < numFrusta; ++i ) {
+		CameraPersp cam( 1920, 1080, 60, 1, 1000 );
+		cam.lookAt( rnd.nextVec3() * 200.0f, rnd.nextVec3() * 100.0f );
+		frusta.emplace_back( cam );
+	}
+
+	vector<uint32_t> visible;
+	size_t numVisible = 0;
+	t.start();
+	for( const auto &frustum : frusta ) {
+		visible.clear();
+		numVisible += octree.query( frustum, &visible );
+	}
+	double octreeSeconds = t.getSeconds() / numFrusta;
+
+	size_t numBruteForceVisible = 0;
+	t.start();
+	for( const auto &frustum : frusta ) {
+		visible.clear();
+		for( int i = 0; i < numItems; ++i ) {
+			if( frustum.intersects( boxes[i] ) )
+				visible.push_back( i );
+		}
+		numBruteForceVisible += visible.size();
+	}
+	double bruteForceSeconds = t.getSeconds() / numFrusta;
+
+	cout << numItems << " boxes: insert " << insertSeconds * 1000 << " ms, move " << moveSeconds * 1000 << " ms, " << octree.getNumNodes() << " nodes" << endl;
+	cout << "frustum cull: octree " << octreeSeconds * 1000 << " ms, brute force Frustum::intersects " << bruteForceSeconds * 1000 << " ms, " << numVisible / numFrusta << " visible" << endl;
+	REQUIRE( numVisible == numBruteForceVisible );
+}
@@ -1,9 +1,12 @@
 #include "cinder/app/App.h"
 #include "cinder/Path2d.h"
 #include "cinder/Rand.h"
+#include "cinder/Timer.h"
 
 #include "catch.hpp"
 
+#include <iostream>
+
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -16,6 +19,45 @@ bool subPathHelper( const Path2d &p, float start, float end )
 	return abs( targetLength - subLength ) <= (0.01f * targetLength);
 }
 
+// Measures the arc length up to \a t along a fine polyline
+float polylineLength( const Path2d &p, float t, int numSteps = 20000 )
+{
+	float result = 0;
+	vec2 last = p.getPosition( 0 );
+	for( int i = 1; i <= numSteps; ++i ) {
+		vec2 pos = p.getPosition( t * i / numSteps );
+		result += distance( last, pos );
+		last = pos;
+	}
+
+	return result;
+}
+
+// Returns whether a query of \a p, which builds its arc length table if needed, matches one of a new Path2d with the same segments
+bool matchesRebuiltTable( const Path2d &p )
+{
+	Path2d rebuilt;
+	rebuilt.getPoints() = p.getPoints();
+	rebuilt.getSegments() = p.getSegments();
+	float distance = 123, t, expected;
+	p.calcTimesForDistances( &distance, 1, &t );
+	rebuilt.calcTimesForDistances( &distance, 1, &expected );
+	return t == expected;
+}
+
+Path2d makeArcLengthTestPath()
+{
+	Path2d p;
+	p.moveTo( 0, 0 );
+	p.lineTo( 100, 0 );
+	p.quadTo( 150, 0, 150, 50 );
+	p.curveTo( 150, 200, -50, -100, 20, 80 ); // uneven speed
+	p.lineTo( 20, 80 ); // zero length
+	p.curveTo( 30, 90, 30, 90, 40, 80 ); // control points coincide
+	p.close();
+	return p;
+}
+
 TEST_CASE("Path2d")
 {
 	// getSubPath()
@@ -169,6 +211,65 @@ TEST_CASE("Path2d")
 		REQUIRE( glm::distance( p.getPosition( t ), vec2( 50, 50 ) ) == Approx( 0 ).epsilon( 0.001 ) );
 	}
 	
+	SECTION("arc length table")
+	{
+		Path2d p = makeArcLengthTestPath();
+		const float length = p.calcLength();
+		REQUIRE( length == Approx( polylineLength( p, 1 ) ).epsilon( 0.0001 ) );
+		REQUIRE( Path2dCalcCache( p ).getLength() == Approx( length ).epsilon( 0.0001 ) );
+
+		vector<float> distances, times( 200 );
+		for( int i = 0; i < 200; ++i )
+			distances.push_back( length * i / 199.0f );
+		p.calcTimesForDistances( distances.data(), distances.size(), times.data(), false );
+		vector<vec2> positions( distances.size() ), tangents( distances.size() );
+		p.calcPositionsForDistances( distances.data(), distances.size(), positions.data(), tangents.data(), false );
+		for( size_t i = 0; i < distances.size(); ++i ) {
+			// refined solutions are within the tolerance, interpolated ones within a ten thousandth of the segment length
+			const float t = p.calcTimeForDistance( distances[i], false, 0.0001f );
+			REQUIRE( polylineLength( p, t ) == Approx( distances[i] ).margin( length * 0.0001f ) );
+			REQUIRE( distance( p.getPosition( times[i] ), p.getPosition( t ) ) < length * 0.0001f );
+			if( i > 0 )
+				REQUIRE( times[i] >= times[i - 1] );
+			REQUIRE( distance( positions[i], p.getPosition( times[i] ) ) < 0.0001f );
+			REQUIRE( distance( tangents[i], p.getTangent( times[i] ) ) < 0.001f );
+			REQUIRE( p.calcNormalizedTime( distances[i] / length, false, 0.0001f ) == Approx( t ).margin( 0.0001f ) );
+		}
+
+		// wrapping and clamping
+		float outside[] = { -10, length + 10, -length - 10 }, wrapped[3], clamped[3];
+		p.calcTimesForDistances( outside, 3, wrapped );
+		p.calcTimesForDistances( outside, 3, clamped, false );
+		float inside[] = { length - 10, 10, length - 10 }, expected[3];
+		p.calcTimesForDistances( inside, 3, expected );
+		for( int i = 0; i < 3; ++i )
+			REQUIRE( wrapped[i] == Approx( expected[i] ) );
+		REQUIRE( clamped[0] == 0 );
+		REQUIRE( clamped[1] == 1 );
+		REQUIRE( p.calcTimeForDistance( length + 10, false ) == 1 );
+
+		// edits discard the table, copies keep theirs
+		Path2d copy = p;
+		p.scale( vec2( 2 ) );
+		REQUIRE( p.calcLength() == Approx( length * 2 ) );
+		REQUIRE( matchesRebuiltTable( p ) );
+		p.getPoints()[1] = vec2( 200, 100 );
+		REQUIRE( matchesRebuiltTable( p ) );
+		p.setPoint( 1, vec2( 200, 0 ) );
+		REQUIRE( matchesRebuiltTable( p ) );
+		p.removeSegment( p.getNumSegments() - 1 );
+		REQUIRE( matchesRebuiltTable( p ) );
+		p.lineTo( vec2( 1000, 0 ) );
+		REQUIRE( matchesRebuiltTable( p ) );
+		REQUIRE( matchesRebuiltTable( p.transformed( mat3( 0.5f ) ) ) );
+		REQUIRE( matchesRebuiltTable( copy ) );
+		REQUIRE( copy.calcLength() == Approx( length ).epsilon( 0.0001 ) );
+		p.clear();
+		REQUIRE( p.calcLength() == 0 );
+		p.calcPositionsForDistances( distances.data(), 1, positions.data() );
+		REQUIRE( positions[0] == vec2( 0 ) );
+	}
+
 	SECTION("translate")
 	{
 		Path2d p;
@@ -180,3 +281,32 @@ TEST_CASE("Path2d")
 		REQUIRE( glm::distance( p.getPosition( 1.0 ), vec2( 11, 12 ) ) == Approx( 0 ).epsilon( 0.001 ) );
 	}
 }
+
+TEST_CASE( "Path2dBenchmark", "[.][benchmark]" )
+{
+	// animating objects along a path
+	Path2d p = makeArcLengthTestPath();
+	const int numObjects = 10000;
+	const float length = p.calcLength();
+	vector<float> distances;
+	for( int i = 0; i < numObjects; ++i )
+		distances.push_back( length * i / numObjects );
+
+	// the first query builds the arc length table
+	Timer t( true );
+	vec2 sum = p.getPosition( p.calcTimeForDistance( 0 ) );
+	double firstSeconds = t.getSeconds();
+
+	t.start();
+	for( int i = 0; i < numObjects; ++i )
+		sum += p.getPosition( p.calcTimeForDistance( distances[i] ) );
+	double perCallSeconds = t.getSeconds();
+
+	vector<vec2> positions( numObjects ), tangents( numObjects );
+	t.start();
+	p.calcPositionsForDistances( distances.data(), numObjects, positions.data(), tangents.data() );
+	double batchedSeconds = t.getSeconds();
+
+	cout << numObjects << " objects along a path: first query " << firstSeconds * 1000 << " ms, calcTimeForDistance() + getPosition() " << perCallSeconds * 1000 << " ms, calcPositionsForDistances() " << batchedSeconds * 1000 << " ms" << endl;
+	REQUIRE( sum.x != 0 );
+}
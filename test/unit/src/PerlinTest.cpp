@@ -0,0 +1,181 @@
+#include "catch.hpp"
+#include "cinder/Perlin.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+template<typename VecT>
+vector<VecT> randomPoints( size_t count, float range )
+{
+	Rand rnd( 11 );
+	vector<VecT> result( count );
+	for( auto &p : result )
+		for( int c = 0; c < VecT::length(); ++c )
+			p[c] = rnd.nextFloat( -range, range );
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Perlin" )
+{
+	// not a multiple of the SIMD width, so the scalar tail is exercised as well
+	const size_t count = 1003;
+	const auto points2 = randomPoints<vec2>( count, 300 );
+	const auto points3 = randomPoints<vec3>( count, 300 );
+	const Perlin perlin( 5, 1234 );
+
+	SECTION( "batched matches single points" )
+	{
+		vector<float> values( count );
+		vector<vec2> derivatives2( count );
+		vector<vec3> derivatives3( count );
+
+		perlin.noise( points2.data(), count, values.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( values[i] == Approx( perlin.noise( points2[i] ) ).margin( 1e-5 ) );
+		perlin.noise( points3.data(), count, values.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( values[i] == Approx( perlin.noise( points3[i] ) ).margin( 1e-5 ) );
+
+		perlin.fBm( points2.data(), count, values.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( values[i] == Approx( perlin.fBm( points2[i] ) ).margin( 1e-5 ) );
+		perlin.fBm( points3.data(), count, values.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( values[i] == Approx( perlin.fBm( points3[i] ) ).margin( 1e-5 ) );
+
+		perlin.dnoise( points2.data(), count, derivatives2.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( distance( derivatives2[i], perlin.dnoise( points2[i].x, points2[i].y ) ) < 1e-4f );
+		perlin.dnoise( points3.data(), count, derivatives3.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( distance( derivatives3[i], perlin.dnoise( points3[i].x, points3[i].y, points3[i].z ) ) < 1e-4f );
+
+		perlin.dfBm( points2.data(), count, derivatives2.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( distance( derivatives2[i], perlin.dfBm( points2[i] ) ) < 1e-4f );
+		perlin.dfBm( points3.data(), count, derivatives3.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( distance( derivatives3[i], perlin.dfBm( points3[i] ) ) < 1e-4f );
+
+		perlin.simplex( points2.data(), count, values.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( values[i] == Approx( perlin.simplex( points2[i] ) ).margin( 1e-5 ) );
+		perlin.simplex( points3.data(), count, values.data() );
+		for( size_t i = 0; i < count; ++i )
+			REQUIRE( values[i] == Approx( perlin.simplex( points3[i] ) ).margin( 1e-5 ) );
+	}
+
+	SECTION( "simplex" )
+	{
+		// bounded and continuous
+		float minValue = 0, maxValue = 0;
+		for( size_t i = 0; i < count; ++i ) {
+			for( float value : { perlin.simplex( points2[i] ), perlin.simplex( points3[i] ) } ) {
+				minValue = std::min( minValue, value );
+				maxValue = std::max( maxValue, value );
+			}
+			REQUIRE( perlin.simplex( points2[i] + vec2( 1e-4f ) ) == Approx( perlin.simplex( points2[i] ) ).margin( 1e-2 ) );
+			REQUIRE( perlin.simplex( points3[i] + vec3( 1e-4f ) ) == Approx( perlin.simplex( points3[i] ) ).margin( 1e-2 ) );
+		}
+		REQUIRE( minValue >= -1.0f );
+		REQUIRE( maxValue <= 1.0f );
+		REQUIRE( maxValue - minValue > 1.0f );
+
+		// follows the seed like noise() does
+		Perlin same( 1, 1234 ), other( 1, 4321 );
+		REQUIRE( same.simplex( points3[0] ) == perlin.simplex( points3[0] ) );
+		bool differs = false;
+		for( size_t i = 0; i < 10; ++i )
+			differs = differs || other.simplex( points3[i] ) != perlin.simplex( points3[i] );
+		REQUIRE( differs );
+	}
+
+	SECTION( "channel" )
+	{
+		Channel32f channel( 37, 21 );
+		const vec2 origin( -3.5f, 2.0f ), scale( 0.1f, 0.25f );
+		perlin.fBm( &channel, origin, scale );
+		for( int32_t y = 0; y < channel.getHeight(); ++y )
+			for( int32_t x = 0; x < channel.getWidth(); ++x )
+				REQUIRE( channel.getValue( ivec2( x, y ) ) == Approx( perlin.fBm( origin + scale * vec2( x, y ) ) ).margin( 1e-5 ) );
+
+		perlin.noise( &channel );
+		for( int32_t y = 0; y < channel.getHeight(); ++y )
+			for( int32_t x = 0; x < channel.getWidth(); ++x )
+				REQUIRE( channel.getValue( ivec2( x, y ) ) == Approx( perlin.noise( vec2( x, y ) ) ).margin( 1e-5 ) );
+	}
+}
+
+TEST_CASE( "PerlinBenchmark", "[.][benchmark]" )
+{
+	const size_t count = 1000000;
+	const auto points2 = randomPoints<vec2>( count, 100 );
+	const auto points3 = randomPoints<vec3>( count, 100 );
+	const Perlin perlin( 4 );
+	vector<float> values( count );
+	vector<vec3> derivatives( count );
+
+	auto report = [&]( const char *name, double scalarSeconds, double batchedSeconds, size_t samples ) {
+		cout << name << ": " << samples / scalarSeconds / 1e6 << " M samples/s single, " << samples / batchedSeconds / 1e6 << " M samples/s batched" << endl;
+	};
+
+	Timer t( true );
+	float sum = 0;
+	for( size_t i = 0; i < count; ++i )
+		sum += perlin.noise( points3[i] );
+	double scalar = t.getSeconds();
+	t.start();
+	perlin.noise( points3.data(), count, values.data() );
+	report( "noise 3D", scalar, t.getSeconds(), count );
+
+	t.start();
+	for( size_t i = 0; i < count; ++i )
+		sum += perlin.fBm( points3[i] );
+	scalar = t.getSeconds();
+	t.start();
+	perlin.fBm( points3.data(), count, values.data() );
+	report( "fBm 3D, 4 octaves", scalar, t.getSeconds(), count );
+
+	t.start();
+	for( size_t i = 0; i < count; ++i )
+		sum += perlin.dfBm( points3[i] ).x;
+	scalar = t.getSeconds();
+	t.start();
+	perlin.dfBm( points3.data(), count, derivatives.data() );
+	report( "dfBm 3D, 4 octaves", scalar, t.getSeconds(), count );
+
+	t.start();
+	for( size_t i = 0; i < count; ++i )
+		sum += perlin.simplex( points3[i] );
+	scalar = t.getSeconds();
+	t.start();
+	perlin.simplex( points3.data(), count, values.data() );
+	report( "simplex 3D", scalar, t.getSeconds(), count );
+
+	t.start();
+	for( size_t i = 0; i < count; ++i )
+		sum += perlin.noise( points2[i] );
+	scalar = t.getSeconds();
+	t.start();
+	perlin.noise( points2.data(), count, values.data() );
+	report( "noise 2D", scalar, t.getSeconds(), count );
+
+	Channel32f channel( 1024, 1024 );
+	t.start();
+	for( int32_t y = 0; y < 1024; ++y )
+		for( int32_t x = 0; x < 1024; ++x )
+			*channel.getData( x, y ) = perlin.fBm( vec2( x, y ) * 0.01f );
+	scalar = t.getSeconds();
+	t.start();
+	perlin.fBm( &channel, vec2( 0 ), vec2( 0.01f ) );
+	report( "fBm 2D 1024x1024 channel", scalar, t.getSeconds(), 1024 * 1024 );
+	REQUIRE( sum == sum );
+}
@@ -178,5 +178,28 @@ TEST_CASE("PolyLine2f")
 
 		CHECK( poly.calcCentroid() == vec2( 0.5, 0.5 ) );
 	}
-}
 
+	SECTION("simplify")
+	{
+		// a zigzag along a line
+		PolyLine2f line;
+		for( int i = 0; i <= 100; ++i )
+			line.push_back( vec2( i, ( i % 2 ) * 0.1f ) );
+		PolyLine2f simplified = line.simplified( 0.2f );
+		REQUIRE( simplified.size() == 2 );
+		CHECK( simplified.getPoints()[0] == line.getPoints().front() );
+		CHECK( simplified.getPoints()[1] == line.getPoints().back() );
+		CHECK( line.simplified( 0.05f ).size() == line.size() );
+
+		// points beyond the ends of a segment are measured to its end points
+		PolyLine2f spike( { vec2( 0, 0 ), vec2( 10, 0 ), vec2( 12, 0 ), vec2( 5, 0 ) } );
+		CHECK( spike.simplified( 1 ).size() == 3 );
+
+		// closed polylines keep their shape around the whole loop
+		PolyLine2f square( { vec2( 0, 0 ), vec2( 5, 0 ), vec2( 10, 0 ), vec2( 10, 5 ), vec2( 10, 10 ), vec2( 0, 10 ), vec2( 0, 5 ) }, true );
+		square.simplify( 0.1f );
+		REQUIRE( square.size() == 4 );
+		CHECK( square.isClosed() );
+		CHECK( square.calcArea() == Approx( 100 ) );
+	}
+}
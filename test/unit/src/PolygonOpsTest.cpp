@@ -0,0 +1,323 @@
+#include "catch.hpp"
+#include "cinder/PolygonOps.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+#include "PolygonTestUtils.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace cinder::polygon;
+using namespace std;
+
+namespace {
+
+PolyLine2f rectangle( float x0, float y0, float x1, float y1 )
+{
+	return PolyLine2f( { vec2( x0, y0 ), vec2( x1, y0 ), vec2( x1, y1 ), vec2( x0, y1 ) }, true );
+}
+
+int windingNumber( const vector<PolyLine2f> &polygons, const vec2 &pt )
+{
+	int winding = 0;
+	for( const auto &polygon : polygons ) {
+		const auto &p = polygon.getPoints();
+		for( size_t i = 0; i < p.size(); ++i ) {
+			const vec2 &a = p[i], &b = p[( i + 1 ) % p.size()];
+			float side = ( b.x - a.x ) * ( pt.y - a.y ) - ( pt.x - a.x ) * ( b.y - a.y );
+			if( a.y <= pt.y && b.y > pt.y && side > 0 )
+				++winding;
+			else if( a.y > pt.y && b.y <= pt.y && side < 0 )
+				--winding;
+		}
+	}
+	return winding;
+}
+
+float distanceToEdges( const vector<PolyLine2f> &polygons, const vec2 &pt )
+{
+	float result = FLT_MAX;
+	for( const auto &polygon : polygons ) {
+		const auto &p = polygon.getPoints();
+		for( size_t i = 0; i < p.size(); ++i ) {
+			const vec2 &a = p[i], ab = p[( i + 1 ) % p.size()] - a;
+			float t = glm::clamp( dot( pt - a, ab ) / std::max( dot( ab, ab ), 1e-12f ), 0.0f, 1.0f );
+			result = std::min( result, distance( pt, a + ab * t ) );
+		}
+	}
+	return result;
+}
+
+bool isFilled( int winding, FillRule fillRule )
+{
+	return ( fillRule == FILL_EVEN_ODD ) ? ( winding & 1 ) != 0 : winding != 0;
+}
+
+bool isInside( Operation op, bool a, bool b )
+{
+	switch( op ) {
+		case UNION: return a || b;
+		case INTERSECTION: return a && b;
+		case DIFFERENCE: return a && ! b;
+		default: return a != b;
+	}
+}
+
+// Returns whether any two edges of the contours cross or overlap
+bool hasIntersections( const vector<PolyLine2f> &polygons )
+{
+	vector<pair<dvec2, dvec2>> edges;
+	for( const auto &polygon : polygons ) {
+		for( size_t i = 0; i < polygon.size(); ++i )
+			edges.emplace_back( polygon.getPoints()[i], polygon.getPoints()[( i + 1 ) % polygon.size()] );
+	}
+	auto side = []( const dvec2 &a, const dvec2 &b, const dvec2 &c ) { return ( b.x - a.x ) * ( c.y - a.y ) - ( c.x - a.x ) * ( b.y - a.y ); };
+	for( size_t i = 0; i < edges.size(); ++i ) {
+		for( size_t j = i + 1; j < edges.size(); ++j ) {
+			const dvec2 &a0 = edges[i].first, &a1 = edges[i].second, &b0 = edges[j].first, &b1 = edges[j].second;
+			double o1 = side( a0, a1, b0 ), o2 = side( a0, a1, b1 ), o3 = side( b0, b1, a0 ), o4 = side( b0, b1, a1 );
+			if( ( ( o1 > 0 && o2 < 0 ) || ( o1 < 0 && o2 > 0 ) ) && ( ( o3 > 0 && o4 < 0 ) || ( o3 < 0 && o4 > 0 ) ) )
+				return true;
+		}
+	}
+	return false;
+}
+
+// Compares the result of op with the fill of the input at random points that aren't too close to any edge
+void checkBoolean( Rand &rnd, Operation op, const vector<PolyLine2f> &a, const vector<PolyLine2f> &b, FillRule fillRule )
+{
+	auto result = calcBoolean( op, a, b, fillRule );
+	for( const auto &contour : result ) {
+		REQUIRE( contour.isClosed() );
+		REQUIRE( contour.size() >= 3 );
+	}
+	REQUIRE_FALSE( hasIntersections( result ) );
+
+	int numChecked = 0;
+	while( numChecked < 300 ) {
+		vec2 pt( rnd.nextFloat( -12, 12 ), rnd.nextFloat( -12, 12 ) );
+		if( distanceToEdges( a, pt ) < 1e-3f || distanceToEdges( b, pt ) < 1e-3f )
+			continue;
+		bool expected = isInside( op, isFilled( windingNumber( a, pt ), fillRule ), isFilled( windingNumber( b, pt ), fillRule ) );
+		// holes wind opposite to outer contours, so the result is filled the same with either rule
+		REQUIRE( windingNumber( result, pt ) == ( expected ? 1 : 0 ) );
+		++numChecked;
+	}
+}
+
+} // anonymous namespace
+
+TEST_CASE( "PolygonOps" )
+{
+	SECTION( "Overlapping rectangles" )
+	{
+		vector<PolyLine2f> a = { rectangle( 0, 0, 2, 2 ) }, b = { rectangle( 1, 1, 3, 3 ) };
+		auto united = calcUnion( a, b );
+		REQUIRE( united.size() == 1 );
+		REQUIRE( united[0].size() == 8 );
+		REQUIRE( signedArea( united ) == Approx( 7 ) );
+		REQUIRE( united[0].isCounterclockwise() );
+		REQUIRE( signedArea( calcIntersection( a, b ) ) == Approx( 1 ) );
+		REQUIRE( calcIntersection( a, b )[0].size() == 4 );
+		REQUIRE( signedArea( calcDifference( a, b ) ) == Approx( 3 ) );
+		REQUIRE( signedArea( calcXor( a, b ) ) == Approx( 6 ) );
+		REQUIRE( calcXor( a, b ).size() == 2 );
+
+		// a hole winds clockwise
+		auto hole = calcDifference( { rectangle( 0, 0, 4, 4 ) }, { rectangle( 1, 1, 2, 2 ) } );
+		REQUIRE( hole.size() == 2 );
+		REQUIRE( signedArea( hole ) == Approx( 15 ) );
+		REQUIRE( hole[0].isClockwise() != hole[1].isClockwise() );
+	}
+
+	SECTION( "Shared and coincident edges" )
+	{
+		vector<PolyLine2f> a = { rectangle( 0, 0, 1, 1 ) };
+		// rectangles sharing an edge merge into one without the collinear points
+		auto united = calcUnion( a, { rectangle( 1, 0, 2, 1 ) } );
+		REQUIRE( united.size() == 1 );
+		REQUIRE( united[0].size() == 4 );
+		REQUIRE( signedArea( united ) == Approx( 2 ) );
+		REQUIRE( calcIntersection( a, { rectangle( 1, 0, 2, 1 ) } ).empty() );
+
+		// partially overlapping edges
+		REQUIRE( signedArea( calcUnion( a, { rectangle( 0.5f, 1, 2, 2 ) } ) ) == Approx( 2.5 ) );
+		REQUIRE( signedArea( calcDifference( a, { rectangle( 0, 0.5f, 1, 3 ) } ) ) == Approx( 0.5 ) );
+
+		// identical polygons, in either orientation
+		REQUIRE( signedArea( calcUnion( a, a ) ) == Approx( 1 ) );
+		REQUIRE( calcUnion( a, a )[0].size() == 4 );
+		REQUIRE( calcXor( a, a ).empty() );
+		REQUIRE( calcDifference( a, { a[0].reversed() } ).empty() );
+		REQUIRE( signedArea( calcIntersection( a, { a[0].reversed() } ) ) == Approx( 1 ) );
+
+		// rectangles touching at a corner stay separate contours
+		auto corner = calcUnion( a, { rectangle( 1, 1, 2, 2 ) } );
+		REQUIRE( corner.size() == 2 );
+		REQUIRE( signedArea( corner ) == Approx( 2 ) );
+
+		// empty operands
+		REQUIRE( calcUnion( a, {} ).size() == 1 );
+		REQUIRE( calcIntersection( a, {} ).empty() );
+		REQUIRE( calcUnion( {}, {} ).empty() );
+	}
+
+	SECTION( "Fill rules" )
+	{
+		// a figure eight splits into two contours
+		vector<PolyLine2f> bowtie = { PolyLine2f( { vec2( 0, 0 ), vec2( 2, 2 ), vec2( 2, 0 ), vec2( 0, 2 ) }, true ) };
+		auto resolved = calcUnion( bowtie );
+		REQUIRE( resolved.size() == 2 );
+		REQUIRE( signedArea( resolved ) == Approx( 2 ) );
+
+		// two nested counterclockwise contours
+		vector<PolyLine2f> nested = { rectangle( 0, 0, 3, 3 ), rectangle( 1, 1, 2, 2 ) };
+		REQUIRE( signedArea( calcUnion( nested, FILL_EVEN_ODD ) ) == Approx( 8 ) );
+		REQUIRE( signedArea( calcUnion( nested, FILL_NONZERO ) ) == Approx( 9 ) );
+		REQUIRE( signedArea( calcUnion( nested, FILL_POSITIVE ) ) == Approx( 9 ) );
+		REQUIRE( calcUnion( nested, FILL_NEGATIVE ).empty() );
+	}
+
+	SECTION( "Random polygons match point sampling" )
+	{
+		Rand rnd( 2020 );
+		for( int i = 0; i < 20; ++i ) {
+			// simple star shaped polygons and self-intersecting random ones
+			vector<PolyLine2f> a = { PolyLine2f( star( rnd, rnd.nextVec2() * 2.0f, 2, 10, 40 ), true ) }, b = { PolyLine2f( star( rnd, rnd.nextVec2() * 2.0f, 2, 10, 40 ), true ) };
+			vector<PolyLine2f> c( 2 ), d( 1 );
+			for( int j = 0; j < 15; ++j ) {
+				c[j % 2].push_back( vec2( rnd.nextFloat( -10, 10 ), rnd.nextFloat( -10, 10 ) ) );
+				d[0].push_back( vec2( rnd.nextFloat( -10, 10 ), rnd.nextFloat( -10, 10 ) ) );
+			}
+			// points snapped to a coarse grid give shared vertices and collinear edges
+			vector<PolyLine2f> e = { PolyLine2f( star( rnd, vec2( 0 ), 2, 10, 20 ), true ) };
+			for( auto &p : e[0] )
+				p = glm::round( p );
+
+			for( Operation op : { UNION, INTERSECTION, DIFFERENCE, XOR } ) {
+				checkBoolean( rnd, op, a, b, FILL_EVEN_ODD );
+				checkBoolean( rnd, op, c, d, FILL_EVEN_ODD );
+				checkBoolean( rnd, op, c, d, FILL_NONZERO );
+				checkBoolean( rnd, op, e, { rectangle( -5, -5, 5, 5 ) }, FILL_EVEN_ODD );
+			}
+		}
+	}
+
+	SECTION( "Offset" )
+	{
+		vector<PolyLine2f> square = { rectangle( 0, 0, 10, 10 ) };
+		REQUIRE( signedArea( calcOffset( square, 1 ) ) == Approx( 144 ) );
+		REQUIRE( calcOffset( square, 1 )[0].size() == 4 );
+		REQUIRE( signedArea( calcOffset( square, 1, OffsetOptions().join( JOIN_BEVEL ) ) ) == Approx( 142 ) );
+		REQUIRE( signedArea( calcOffset( square, 1, OffsetOptions().join( JOIN_MITER ).miterLimit( 1.2f ) ) ) == Approx( 142 ) );
+		auto round = calcOffset( square, 1, OffsetOptions().join( JOIN_ROUND ).arcTolerance( 0.001f ) );
+		REQUIRE( signedArea( round ) == Approx( 140 + M_PI ).epsilon( 0.001 ) );
+		for( const vec2 &p : round[0] )
+			REQUIRE( distanceToEdges( square, p ) == Approx( 1 ).epsilon( 0.001 ) );
+
+		REQUIRE( signedArea( calcOffset( square, -1 ) ) == Approx( 64 ) );
+		REQUIRE( signedArea( calcOffset( square, -1, OffsetOptions().join( JOIN_ROUND ) ) ) == Approx( 64 ) );
+		REQUIRE( calcOffset( square, -5.5f ).empty() );
+		REQUIRE( signedArea( calcOffset( square, 0 ) ) == Approx( 100 ) );
+
+		// concave corners and holes
+		vector<PolyLine2f> frame = { rectangle( 0, 0, 10, 10 ), rectangle( 3, 3, 7, 7 ) };
+		REQUIRE( signedArea( calcOffset( frame, 1 ) ) == Approx( 144 - 4 ) );
+		REQUIRE( calcOffset( frame, 1 ).size() == 2 );
+		REQUIRE( signedArea( calcOffset( frame, 2.5f ) ) == Approx( 225 ) );
+		REQUIRE( calcOffset( frame, 2.5f ).size() == 1 );
+		vector<PolyLine2f> ell = { PolyLine2f( { vec2( 0, 0 ), vec2( 4, 0 ), vec2( 4, 1 ), vec2( 1, 1 ), vec2( 1, 4 ), vec2( 0, 4 ) }, true ) };
+		REQUIRE( signedArea( calcOffset( ell, 1 ) ) == Approx( 6 * 6 - 3 * 3 ) );
+		REQUIRE_FALSE( hasIntersections( calcOffset( ell, 1 ) ) );
+
+		// overlapping and self-intersecting input is resolved first
+		REQUIRE( signedArea( calcOffset( { rectangle( 0, 0, 2, 2 ), rectangle( 1, 0, 3, 2 ) }, 1, OffsetOptions().fillRule( FILL_NONZERO ) ) ) == Approx( 20 ) );
+	}
+
+	SECTION( "Shape2d" )
+	{
+		Shape2d a, b;
+		// a circle of four cubic Beziers
+		const float k = 10 * 0.5522847f;
+		a.moveTo( 10, 0 );
+		a.curveTo( 10, k, k, 10, 0, 10 );
+		a.curveTo( -k, 10, -10, k, -10, 0 );
+		a.curveTo( -10, -k, -k, -10, 0, -10 );
+		a.curveTo( k, -10, 10, -k, 10, 0 );
+		a.close();
+		b.moveTo( 0, -20 );
+		b.lineTo( 20, -20 );
+		b.lineTo( 20, 20 );
+		b.lineTo( 0, 20 );
+		b.close();
+
+		Shape2d half = calcIntersection( a, b );
+		REQUIRE( half.getNumContours() == 1 );
+		REQUIRE( half.getContour( 0 ).isClosed() );
+		REQUIRE( half.contains( vec2( 5, 0 ) ) );
+		REQUIRE_FALSE( half.contains( vec2( -5, 0 ) ) );
+		Rectf bounds = half.calcBoundingBox();
+		REQUIRE( bounds.x1 == Approx( 0 ).margin( 1e-4 ) );
+		REQUIRE( bounds.x2 == Approx( 10 ).epsilon( 1e-3 ) );
+
+		Shape2d united = calcUnion( a, b );
+		REQUIRE( united.getNumContours() == 1 );
+		REQUIRE( united.contains( vec2( -9, 0 ) ) );
+		REQUIRE( united.contains( vec2( 19, 19 ) ) );
+
+		Shape2d grown = calcOffset( b, 1 );
+		REQUIRE( grown.calcBoundingBox().getUpperLeft() == vec2( -1, -21 ) );
+		REQUIRE( grown.calcBoundingBox().getLowerRight() == vec2( 21, 21 ) );
+
+		Shape2d simplified = calcSimplified( a, 0.5f );
+		REQUIRE( simplified.getNumContours() == 1 );
+		REQUIRE( simplified.getContour( 0 ).isClosed() );
+		REQUIRE( simplified.getContour( 0 ).getNumPoints() < a.getContour( 0 ).subdivide().size() );
+		const auto subdivided = a.getContour( 0 ).subdivide();
+		for( const vec2 &p : simplified.getContour( 0 ).getPoints() )
+			REQUIRE( find( subdivided.begin(), subdivided.end(), p ) != subdivided.end() );
+	}
+} // PolygonOps
+
+TEST_CASE( "PolygonOpsBenchmark", "[.][benchmark]" )
+{
+	// wavy outlines crossing each other a few hundred times
+	const int numPoints = 25000;
+	Rand rnd( 1 );
+	auto wavy = [&]( const vec2 &center, float frequency ) {
+		PolyLine2f result;
+		for( int i = 0; i < numPoints; ++i ) {
+			float angle = i * 2 * (float)M_PI / numPoints;
+			float radius = 100 + 10 * sin( angle * frequency ) + rnd.nextFloat( -0.05f, 0.05f );
+			result.push_back( center + vec2( cos( angle ), sin( angle ) ) * radius );
+		}
+		result.setClosed();
+		return result;
+	};
+	vector<PolyLine2f> a = { wavy( vec2( 0 ), 100 ) }, b = { wavy( vec2( 5, 0 ), 120 ) };
+
+	const char *names[] = { "union", "intersection", "difference", "xor" };
+	for( Operation op : { UNION, INTERSECTION, DIFFERENCE, XOR } ) {
+		Timer t( true );
+		auto result = calcBoolean( op, a, b );
+		double seconds = t.getSeconds();
+		size_t numResultPoints = 0;
+		for( const auto &contour : result )
+			numResultPoints += contour.size();
+		cout << names[op] << " of 2 x " << numPoints << " points: " << seconds * 1000 << " ms, " << result.size() << " contours, " << numResultPoints << " points" << endl;
+		REQUIRE( ! result.empty() );
+	}
+
+	Timer t( true );
+	auto offset = calcOffset( a, 2, OffsetOptions().join( JOIN_ROUND ) );
+	cout << "round offset of " << numPoints << " points: " << t.getSeconds() * 1000 << " ms" << endl;
+	REQUIRE( ! offset.empty() );
+
+	PolyLine2f wave;
+	for( int i = 0; i < 1000000; ++i )
+		wave.push_back( vec2( i * 0.01f, sin( i * 0.00002f ) * 100 + rnd.nextFloat( -0.1f, 0.1f ) ) );
+	t.start();
+	PolyLine2f simplified = wave.simplified( 0.5f );
+	cout << "simplify " << wave.size() << " points: " << t.getSeconds() * 1000 << " ms, " << simplified.size() << " points left" << endl;
+	REQUIRE( simplified.size() < wave.size() );
+}
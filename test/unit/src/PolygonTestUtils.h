@@ -0,0 +1,34 @@
+#pragma once
+
+#include "cinder/PolyLine.h"
+#include "cinder/Rand.h"
+
+#include <vector>
+
+// A star-shaped polygon around center with numPoints random radii
+inline std::vector<ci::vec2> star( ci::Rand &rnd, const ci::vec2 &center, float minRadius, float maxRadius, int numPoints )
+{
+	std::vector<ci::vec2> result;
+	for( int i = 0; i < numPoints; ++i ) {
+		float angle = i * 2 * (float)M_PI / numPoints;
+		result.push_back( center + ci::vec2( cos( angle ), sin( angle ) ) * rnd.nextFloat( minRadius, maxRadius ) );
+	}
+	return result;
+}
+
+// Signed area, positive for counterclockwise contours
+inline double signedArea( const std::vector<ci::vec2> &p )
+{
+	double sum = 0;
+	for( size_t i = 0; i < p.size(); ++i )
+		sum += (double)p[i].x * p[( i + 1 ) % p.size()].y - (double)p[( i + 1 ) % p.size()].x * p[i].y;
+	return sum / 2;
+}
+
+inline double signedArea( const std::vector<ci::PolyLine2f> &polygons )
+{
+	double sum = 0;
+	for( const auto &polygon : polygons )
+		sum += signedArea( polygon.getPoints() );
+	return sum;
+}
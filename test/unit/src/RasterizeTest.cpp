@@ -0,0 +1,118 @@
+#include "cinder/ip/Rasterize.h"
+#include "cinder/ip/Fill.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+double calcCoverageArea( const Channel8u &channel )
+{
+	double result = 0;
+	for( int32_t y = 0; y < channel.getHeight(); ++y )
+		for( int32_t x = 0; x < channel.getWidth(); ++x )
+			result += *channel.getData( x, y ) / 255.0;
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Rasterize")
+{
+	Channel8u channel( 100, 100 );
+	ip::Rasterizer rasterizer( 100, 100 );
+
+	SECTION("Coverage is exact for axis-aligned edges")
+	{
+		rasterizer.addPolyLine( PolyLine2f( { vec2( 10.5f, 10.5f ), vec2( 30.5f, 10.5f ), vec2( 30.5f, 30.5f ), vec2( 10.5f, 30.5f ) } ) );
+		rasterizer.renderCoverage( &channel );
+		REQUIRE( calcCoverageArea( channel ) == Approx( 400 ).epsilon( 0.001 ) );
+		REQUIRE( *channel.getData( 20, 20 ) == 255 );
+		REQUIRE( *channel.getData( 10, 20 ) == 128 );
+		REQUIRE( *channel.getData( 5, 5 ) == 0 );
+	}
+
+	SECTION("Geometry outside the image is clipped")
+	{
+		rasterizer.addPolyLine( PolyLine2f( { vec2( -10, -10 ), vec2( 20, -10 ), vec2( 20, 20 ), vec2( -10, 20 ) } ) );
+		rasterizer.addPolyLine( PolyLine2f( { vec2( 80, 50 ), vec2( 120, 50 ), vec2( 120, 60 ), vec2( 80, 60 ) } ) );
+		rasterizer.renderCoverage( &channel );
+		REQUIRE( calcCoverageArea( channel ) == Approx( 600 ).epsilon( 0.001 ) );
+	}
+
+	SECTION("Fill rules")
+	{
+		rasterizer.addPolyLine( PolyLine2f( { vec2( 10, 10 ), vec2( 90, 10 ), vec2( 90, 90 ), vec2( 10, 90 ) } ) );
+		rasterizer.addPolyLine( PolyLine2f( { vec2( 30, 30 ), vec2( 70, 30 ), vec2( 70, 70 ), vec2( 30, 70 ) } ) );
+		rasterizer.renderCoverage( &channel, ip::Rasterizer::FILL_RULE_EVENODD );
+		REQUIRE( *channel.getData( 50, 50 ) == 0 );
+		REQUIRE( *channel.getData( 20, 20 ) == 255 );
+		rasterizer.renderCoverage( &channel, ip::Rasterizer::FILL_RULE_NONZERO );
+		REQUIRE( *channel.getData( 50, 50 ) == 255 );
+	}
+
+	SECTION("Curves")
+	{
+		Shape2d circle;
+		circle.moveTo( 80, 50 );
+		circle.arc( vec2( 50, 50 ), 30, 0, 2 * (float)M_PI );
+		circle.close();
+		ip::fill( &channel, (uint8_t)0 );
+		ip::rasterize( &channel, circle );
+		REQUIRE( calcCoverageArea( channel ) == Approx( M_PI * 30 * 30 ).epsilon( 0.01 ) );
+	}
+
+	SECTION("Strokes")
+	{
+		rasterizer.addStroke( PolyLine2f( { vec2( 10, 50 ), vec2( 90, 50 ) } ), ip::Rasterizer::StrokeStyle( 4 ) );
+		rasterizer.renderCoverage( &channel );
+		REQUIRE( calcCoverageArea( channel ) == Approx( 320 ).epsilon( 0.001 ) );
+
+		// the miter fills the outer 2x2 corner; the segments overlap in the inner one
+		rasterizer.clear();
+		rasterizer.addStroke( PolyLine2f( { vec2( 10, 10 ), vec2( 90, 10 ), vec2( 90, 90 ) } ), ip::Rasterizer::StrokeStyle( 4 ).join( ip::Rasterizer::LINE_JOIN_MITER ) );
+		rasterizer.renderCoverage( &channel );
+		REQUIRE( calcCoverageArea( channel ) == Approx( 640 ).epsilon( 0.001 ) );
+		REQUIRE( *channel.getData( 91, 8 ) == 255 );
+	}
+
+	SECTION("Threads do not change the result")
+	{
+		// large enough to be split across threads, plus a shape small enough to be composited on the calling thread
+		Shape2d shape;
+		shape.moveTo( 990, 1000 );
+		shape.arc( vec2( 500, 1000 ), 490, 0, 2 * (float)M_PI );
+		shape.close();
+		shape.moveTo( 5, 5 ); shape.lineTo( 9, 5 ); shape.lineTo( 9, 9 ); shape.close();
+		Channel8u serial( 1000, 2000 ), threaded( 1000, 2000 );
+		ip::Rasterizer large( 1000, 2000 );
+		large.addShape( shape );
+		large.setMaxThreads( 1 );
+		large.renderCoverage( &serial );
+		large.setMaxThreads( 4 );
+		large.renderCoverage( &threaded );
+		REQUIRE( memcmp( serial.getData(), threaded.getData(), serial.getRowBytes() * serial.getHeight() ) == 0 );
+		REQUIRE( calcCoverageArea( threaded ) == Approx( M_PI * 490 * 490 + 8 ).epsilon( 0.01 ) );
+	}
+
+	SECTION("Surface blending")
+	{
+		Surface8u surface( 100, 100, false );
+		ip::fill( &surface, Color8u( 0, 0, 255 ) );
+		Shape2d square;
+		square.moveTo( 10, 10 ); square.lineTo( 20, 10 ); square.lineTo( 20, 20 ); square.lineTo( 10, 20 ); square.close();
+		ip::rasterize( &surface, square, ColorA( 1, 0, 0, 1 ) );
+		REQUIRE( surface.getPixel( ivec2( 15, 15 ) ) == ColorA8u( 255, 0, 0, 255 ) );
+		REQUIRE( surface.getPixel( ivec2( 5, 5 ) ) == ColorA8u( 0, 0, 255, 255 ) );
+
+		square.translate( vec2( 50, 0 ) );
+		ip::rasterize( &surface, square, ColorA( 1, 0, 0, 0.5f ) );
+		ColorA8u blended = surface.getPixel( ivec2( 65, 15 ) );
+		REQUIRE( abs( blended.r - 128 ) <= 1 );
+		REQUIRE( abs( blended.b - 128 ) <= 1 );
+	}
+}
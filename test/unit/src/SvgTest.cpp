@@ -0,0 +1,156 @@
+#include "cinder/svg/Svg.h"
+#include "cinder/svg/SvgRaster.h"
+#include "cinder/Timer.h"
+#include "cinder/Rand.h"
+
+#include "catch.hpp"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+svg::DocRef loadSvgString( const std::string &str )
+{
+	return svg::Doc::create( DataSourceBuffer::create( Buffer::create( (void*)str.data(), str.size() ) ) );
+}
+
+} // anonymous namespace
+
+TEST_CASE("Svg")
+{
+	SECTION("Path data numbers are parsed in place")
+	{
+		auto doc = loadSvgString( "<svg width='100' height='100'><path id='p' d='M1.5.5L-2e1,3E+1 .25-.75h1e-2v-5.0e0Z'/></svg>" );
+		const svg::Path *path = doc->find<svg::Path>( "p" );
+		REQUIRE( path );
+		const Path2d &contour = path->getShape2d().getContour( 0 );
+		REQUIRE( contour.getNumPoints() == 5 );
+		REQUIRE( contour.getPoint( 0 ) == vec2( 1.5f, 0.5f ) );
+		REQUIRE( contour.getPoint( 1 ) == vec2( -20, 30 ) );
+		REQUIRE( contour.getPoint( 2 ) == vec2( 0.25f, -0.75f ) );
+		REQUIRE( contour.getPoint( 3 ).x == Approx( 0.26f ) );
+		REQUIRE( contour.getPoint( 4 ).y == Approx( -5.75f ) );
+	}
+
+	SECTION("Transforms and point lists")
+	{
+		auto doc = loadSvgString( "<svg width='100' height='100'><polygon id='p' transform='translate(10 ,20) scale(2)' points='0,0 1e1,0, 10 10 5'/></svg>" );
+		const svg::Polygon *polygon = doc->find<svg::Polygon>( "p" );
+		REQUIRE( polygon );
+		REQUIRE( polygon->getPolyLine().size() == 3 );
+		REQUIRE( polygon->getPolyLine().getPoints()[2] == vec2( 10, 10 ) );
+		REQUIRE( polygon->getTransform() * vec3( 1, 1, 1 ) == vec3( 12, 22, 1 ) );
+	}
+
+	SECTION("Unit suffixes are not consumed as exponents")
+	{
+		auto doc = loadSvgString( "<svg width='2in' height='10em'><rect id='r' width='4e0px' height='1.5e1'/></svg>" );
+		REQUIRE( doc->getWidth() == 144 );
+		REQUIRE( doc->find<svg::Rect>( "r" )->getRect().getSize() == vec2( 4, 15 ) );
+	}
+
+	SECTION("Malformed numbers throw instead of stalling the parser")
+	{
+		REQUIRE_THROWS_AS( loadSvgString( "<svg width='100' height='100'><polygon points='0,0 e'/></svg>" ), svg::FloatParseExc );
+		REQUIRE_THROWS_AS( loadSvgString( "<svg width='100' height='100'><polyline points='1 2 3 + 4'/></svg>" ), svg::FloatParseExc );
+		REQUIRE_THROWS_AS( loadSvgString( "<svg width='100' height='100'><path d='M0 0L1 E'/></svg>" ), svg::FloatParseExc );
+	}
+
+	SECTION("Point lists reject anything but numbers")
+	{
+		REQUIRE_THROWS_AS( loadSvgString( "<svg width='100' height='100'><polygon points='0,0 abc 1,1'/></svg>" ), svg::FloatParseExc );
+		REQUIRE_THROWS_AS( loadSvgString( "<svg width='100' height='100'><polyline points='0,0 1,1;'/></svg>" ), svg::FloatParseExc );
+		auto doc = loadSvgString( "<svg width='100' height='100'><polyline id='p' points=' 0,0 , 1 1 ,, '/></svg>" );
+		const svg::Polyline *polyline = doc->find<svg::Polyline>( "p" );
+		REQUIRE( polyline );
+		REQUIRE( polyline->getPolyLine().size() == 2 );
+	}
+
+	SECTION("Elements are built straight from the XML")
+	{
+		auto doc = loadSvgString( "<?xml version='1.0'?><!-- comment --><svg width='100' height='50'><switch><defs>"
+			"<linearGradient id='lg' x2='0.5'><stop offset='0.25' stop-color='#00ff00'/><stop offset='1' style='stop-color:#0000ff'/></linearGradient></defs>"
+			"<g id='g'><circle id='c' cx='1' cy='2' r='3' fill='url(#lg)'/>"
+			"<text id='t' x='5' y='6'>a &amp; b<tspan id='s'>c</tspan></text></g></switch></svg>" );
+		REQUIRE( doc->getWidth() == 100 );
+		REQUIRE( doc->getHeight() == 50 );
+
+		const svg::Group *group = doc->find<svg::Group>( "g" );
+		REQUIRE( group );
+		REQUIRE( group->getChildren().size() == 2 );
+
+		const svg::Circle *circle = doc->find<svg::Circle>( "c" );
+		REQUIRE( circle );
+		REQUIRE( circle->getCenter() == vec2( 1, 2 ) );
+		REQUIRE( circle->getRadius() == 3 );
+		const svg::Paint &fill = circle->getStyle().getFill();
+		REQUIRE( fill.isLinearGradient() );
+		REQUIRE( fill.getNumColors() == 2 );
+		REQUIRE( fill.getOffset( 0 ) == 0.25f );
+		REQUIRE( fill.getColor( 0 ) == ColorA8u( 0, 255, 0, 255 ) );
+		REQUIRE( fill.getColor( 1 ) == ColorA8u( 0, 0, 255, 255 ) );
+		REQUIRE( fill.getCoords1() == vec2( 0.5f, 0 ) );
+
+		const svg::Text *text = doc->find<svg::Text>( "t" );
+		REQUIRE( text );
+		REQUIRE( text->getTextPen() == vec2( 5, 6 ) );
+		REQUIRE( text->getSpans().size() == 2 );
+		REQUIRE( text->getSpans()[0]->getString() == "a & b" );
+		REQUIRE( text->getSpans()[1]->getSpans().size() == 1 );
+		REQUIRE( text->getSpans()[1]->getSpans()[0]->getString() == "c" );
+	}
+
+	SECTION("A document without an svg element throws")
+	{
+		REQUIRE_THROWS_AS( loadSvgString( "<html/>" ), svg::ExcChildNotFound );
+	}
+
+	SECTION("Documents render to a Surface")
+	{
+		auto doc = loadSvgString( "<svg width='60' height='20'><rect x='0' y='0' width='40' height='20' fill='#ff0000'/>"
+			"<g opacity='0.5'><circle cx='30' cy='10' r='8' fill='#0000ff'/></g>"
+			"<line x1='42' y1='10' x2='58' y2='10' stroke='#00ff00' stroke-width='4'/></svg>" );
+		Surface8u surface = svg::renderToSurface( *doc );
+		REQUIRE( surface.getSize() == ivec2( 60, 20 ) );
+		REQUIRE( surface.hasAlpha() );
+		REQUIRE( surface.getPixel( ivec2( 10, 10 ) ) == ColorA8u( 255, 0, 0, 255 ) );
+		REQUIRE( surface.getPixel( ivec2( 45, 2 ) ) == ColorA8u( 0, 0, 0, 0 ) );
+		ColorA8u blended = surface.getPixel( ivec2( 30, 10 ) );
+		REQUIRE( abs( blended.r - 128 ) <= 1 );
+		REQUIRE( abs( blended.b - 128 ) <= 1 );
+		REQUIRE( blended.a == 255 );
+		REQUIRE( surface.getPixel( ivec2( 50, 10 ) ) == ColorA8u( 0, 255, 0, 255 ) );
+		REQUIRE( surface.getPixel( ivec2( 50, 5 ) ) == ColorA8u( 0, 0, 0, 0 ) );
+	}
+}
+
+TEST_CASE("SvgParseBenchmark", "[.][benchmark]")
+{
+	Rand rnd( 1 );
+	ostringstream ss;
+	ss << "<svg xmlns='http://www.w3.org/2000/svg' width='1000' height='1000'>";
+	for( int g = 0; g < 200; ++g ) {
+		ss << "<g transform='translate(" << rnd.nextFloat( 10 ) << "," << rnd.nextFloat( 10 ) << ")' fill='#336699'>";
+		for( int p = 0; p < 50; ++p ) {
+			ss << "<path d='M" << rnd.nextFloat( 1000 ) << "," << rnd.nextFloat( 1000 );
+			for( int c = 0; c < 30; ++c )
+				ss << " c" << rnd.nextFloat( -50, 50 ) << "," << rnd.nextFloat( -50, 50 ) << " " << rnd.nextFloat( -50, 50 ) << ","
+					<< rnd.nextFloat( -50, 50 ) << " " << rnd.nextFloat( -50, 50 ) << "," << rnd.nextFloat( -50, 50 );
+			ss << "z'/>";
+		}
+		ss << "</g>";
+	}
+	ss << "</svg>";
+	const string svgString = ss.str();
+
+	Timer t( true );
+	auto doc = loadSvgString( svgString );
+	t.stop();
+
+	REQUIRE( doc->getChildren().size() == 200 );
+	cout << "Parsed " << svgString.size() / 1.0e6 << " MB of SVG in " << t.getSeconds() << " s (" << svgString.size() / 1.0e6 / t.getSeconds() << " MB/s)" << endl;
+}
@@ -0,0 +1,79 @@
+#include "catch.hpp"
+#include "cinder/Text.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+const char *sWords[] = { "the", "layout", "of", "a", "paragraph", "is", "cached", "until", "it", "changes", "incomprehensibilities", "\n", "  " };
+
+// Inserts or removes a word at a random position, like typing into the text would
+void edit( string *text, Rand &rnd )
+{
+	const size_t at = rnd.nextUint( (uint32_t)text->size() + 1 );
+	if( rnd.nextUint( 3 ) == 0 && at < text->size() )
+		text->erase( at, std::min<size_t>( rnd.nextUint( 8 ) + 1, text->size() - at ) );
+	else
+		text->insert( at, string( sWords[rnd.nextUint( sizeof( sWords ) / sizeof( sWords[0] ) )] ) + " " );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "TextBox" )
+{
+	SECTION( "An edited TextBox lays out like a new one" )
+	{
+		TextBox edited;
+		edited.font( Font::getDefault() ).size( 160, TextBox::GROW );
+		string text = "A first paragraph.\nAnd a second one, which is long enough to wrap over several lines.\n\n  Indented third.";
+		Rand rnd( 4 );
+		for( int i = 0; i < 60; ++i ) {
+			edit( &text, rnd );
+			if( i % 20 == 19 )
+				edited.setSize( ivec2( 80 + rnd.nextUint( 200 ), TextBox::GROW ) );
+			edited.setText( text );
+
+			TextBox fresh;
+			fresh.font( edited.getFont() ).size( edited.getSize() ).text( text );
+			REQUIRE( edited.measure() == fresh.measure() );
+			REQUIRE( edited.measureGlyphs() == fresh.measureGlyphs() );
+		}
+	}
+}
+
+TEST_CASE( "TextBoxBenchmark", "[.][benchmark]" )
+{
+	string text;
+	Rand rnd( 1 );
+	for( int paragraph = 0; paragraph < 40; ++paragraph ) {
+		for( int word = 0; word < 40; ++word )
+			text += string( sWords[rnd.nextUint( 11 )] ) + " ";
+		text += "\n";
+	}
+
+	// typing into the middle of the text, measuring after each keystroke
+	const int numKeystrokes = 20;
+	const size_t at = text.size() / 2;
+	double seconds[2];
+	for( int persistent = 0; persistent < 2; ++persistent ) {
+		string edited = text;
+		TextBox box;
+		box.font( Font::getDefault() ).size( 400, TextBox::GROW );
+		Timer timer( true );
+		for( int i = 0; i < numKeystrokes; ++i ) {
+			edited.insert( at + i, 1, 'x' );
+			if( ! persistent )
+				box = TextBox().font( Font::getDefault() ).size( 400, TextBox::GROW );
+			box.setText( edited );
+			box.measure();
+		}
+		seconds[persistent] = timer.getSeconds() / numKeystrokes;
+	}
+
+	cout << "40 paragraphs, ms per keystroke: new TextBox " << seconds[0] * 1000 << ", edited TextBox " << seconds[1] * 1000 << endl;
+}
@@ -0,0 +1,169 @@
+#include "catch.hpp"
+#include "cinder/Timeline.h"
+#include "cinder/Color.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+const EaseFn sEaseFns[] = {
+	easeNone, easeInQuad, easeOutQuad, easeInOutQuad, easeOutInQuad, easeInCubic, easeOutCubic, easeInOutCubic, easeOutInCubic,
+	easeInQuart, easeOutQuart, easeInOutQuart, easeOutInQuart, easeInQuint, easeOutQuint, easeInOutQuint, easeOutInQuint,
+	EaseInQuad(), EaseOutQuint(), EaseInOutCubic(), EaseOutBack(), easeInOutSine, []( float t ) { return t * 0.5f; }
+};
+const size_t sNumEaseFns = sizeof( sEaseFns ) / sizeof( sEaseFns[0] );
+
+// The same set of tweens and callbacks, built on either a batched or a regular Timeline
+struct Scene {
+	Scene( bool batched, size_t count )
+		: mTimeline( Timeline::create() ), mFloats( count, Anim<float>( 0 ) ), mVec2s( count, Anim<vec2>( vec2( 0 ) ) ), mVec3s( count, Anim<vec3>( vec3( 0 ) ) ),
+			mColors( count, Anim<Color>( Color::black() ) ), mLerped( 0 ), mFnValue( 0 ),
+			mNumStarts( 0 ), mNumUpdates( 0 ), mNumFinishes( 0 ), mNumCues( 0 )
+	{
+		mTimeline->setBatched( batched );
+		Rand rnd( 17 );
+		for( size_t i = 0; i < count; ++i ) {
+			const EaseFn &ease = sEaseFns[i % sNumEaseFns];
+			auto options = mTimeline->apply( &mFloats[i], rnd.nextFloat( -10, 10 ), rnd.nextFloat( 0.1f, 2 ), ease ).delay( rnd.nextFloat( 0, 3 ) );
+			if( i % 7 == 0 )
+				options.startFn( [this] { ++mNumStarts; } ).finishFn( [this] { ++mNumFinishes; } );
+			if( i % 11 == 0 )
+				options.updateFn( [this] { ++mNumUpdates; } );
+			if( i % 5 == 0 )
+				options.autoRemove( false );
+
+			mTimeline->apply( &mVec2s[i], rnd.nextVec2(), rnd.nextFloat( 0.1f, 2 ), ease ).delay( rnd.nextFloat( 0, 3 ) );
+			mTimeline->appendTo( &mVec2s[i], rnd.nextVec2() * 3.0f, rnd.nextFloat( 0.1f, 1 ), sEaseFns[( i + 3 ) % sNumEaseFns] );
+			mTimeline->apply( &mVec3s[i], vec3( 1 ), rnd.nextVec3(), rnd.nextFloat( 0.1f, 2 ), ease ).delay( rnd.nextFloat( 0, 3 ) );
+			mTimeline->apply( &mColors[i], Color( rnd.nextFloat(), rnd.nextFloat(), rnd.nextFloat() ), rnd.nextFloat( 0.1f, 2 ), ease ).loop( i % 13 == 0 );
+		}
+
+		// items which aren't batched
+		mTimeline->add( [this] { ++mNumCues; }, 1.5f );
+		mTimeline->applyFn<float>( [this]( float v ) { mFnValue = v; }, 0, 5, 2 );
+		mTimeline->apply( &mLerped, 0.0f, 1.0f, 2, easeNone, []( const float &a, const float &b, float t ) { return a + ( b - a ) * t * t; } );
+	}
+
+	void requireEqual( const Scene &rhs ) const
+	{
+		for( size_t i = 0; i < mFloats.size(); ++i ) {
+			REQUIRE( mFloats[i]() == Approx( rhs.mFloats[i]() ) );
+			REQUIRE( mVec2s[i]().x == Approx( rhs.mVec2s[i]().x ) );
+			REQUIRE( mVec2s[i]().y == Approx( rhs.mVec2s[i]().y ) );
+			REQUIRE( mVec3s[i]().z == Approx( rhs.mVec3s[i]().z ) );
+			REQUIRE( mColors[i]().g == Approx( rhs.mColors[i]().g ) );
+		}
+		REQUIRE( mLerped() == rhs.mLerped() );
+		REQUIRE( mFnValue == rhs.mFnValue );
+		REQUIRE( mNumStarts == rhs.mNumStarts );
+		REQUIRE( mNumUpdates == rhs.mNumUpdates );
+		REQUIRE( mNumFinishes == rhs.mNumFinishes );
+		REQUIRE( mNumCues == rhs.mNumCues );
+		REQUIRE( mTimeline->getNumItems() == rhs.mTimeline->getNumItems() );
+	}
+
+	TimelineRef				mTimeline;
+	vector<Anim<float>>		mFloats;
+	vector<Anim<vec2>>		mVec2s;
+	vector<Anim<vec3>>		mVec3s;
+	vector<Anim<Color>>		mColors;
+	Anim<float>				mLerped;
+	float					mFnValue;
+	int						mNumStarts, mNumUpdates, mNumFinishes, mNumCues;
+};
+
+} // anonymous namespace
+
+TEST_CASE( "Timeline" )
+{
+	SECTION( "Batched stepping matches regular stepping" )
+	{
+		Scene regular( false, 201 ), batched( true, 201 );
+		REQUIRE( batched.mTimeline->isBatched() );
+		for( int frame = 0; frame < 400; ++frame ) {
+			regular.mTimeline->step( 1 / 60.0f );
+			batched.mTimeline->step( 1 / 60.0f );
+			regular.requireEqual( batched );
+		}
+		REQUIRE( batched.mNumFinishes > 0 );
+		REQUIRE( batched.mNumCues == 1 );
+	}
+
+	SECTION( "Removal, stepping backwards and toggling batching" )
+	{
+		Scene regular( false, 64 ), batched( true, 64 );
+		for( int frame = 0; frame < 120; ++frame ) {
+			if( frame == 30 ) {
+				for( size_t i = 0; i < 64; i += 3 ) {
+					regular.mFloats[i].stop();
+					batched.mFloats[i].stop();
+				}
+			}
+			if( frame == 60 ) {
+				regular.mTimeline->stepTo( 0.5f );
+				batched.mTimeline->stepTo( 0.5f );
+			}
+			if( frame == 90 ) {
+				batched.mTimeline->setBatched( false );
+				batched.mTimeline->setBatched( true );
+			}
+			regular.mTimeline->step( 1 / 30.0f );
+			batched.mTimeline->step( 1 / 30.0f );
+			regular.requireEqual( batched );
+		}
+	}
+
+	SECTION( "Callbacks may add and remove tweens" )
+	{
+		TimelineRef timeline = Timeline::create();
+		timeline->setBatched();
+		Anim<float> a( 0 ), b( 0 ), c( 0 );
+		timeline->apply( &a, 1.0f, 1 ).finishFn( [&] {
+			timeline->appendTo( &a, 2.0f, 1 );
+			c.stop();
+		} );
+		timeline->apply( &b, 1.0f, 3 ).updateFn( [&] { timeline->remove( timeline->find( b.ptr() ) ); } );
+		timeline->apply( &c, 5.0f, 4 );
+
+		// steps of 1/8 keep the times exact
+		for( int frame = 0; frame < 12; ++frame )
+			timeline->step( 0.125f );
+		REQUIRE( a() == 1.5f );
+		REQUIRE( b() == 0.125f / 3 );
+		REQUIRE( c() == 1.25f );
+		REQUIRE( timeline->getNumItems() == 1 );
+
+		for( int frame = 0; frame < 8; ++frame )
+			timeline->step( 0.125f );
+		REQUIRE( a() == Approx( 2.0f ) );
+		REQUIRE( timeline->empty() );
+	}
+}
+
+TEST_CASE( "TimelineBenchmark", "[.][benchmark]" )
+{
+	for( size_t count : { 1000, 10000, 100000 } ) {
+		double seconds[2];
+		for( int batched = 0; batched < 2; ++batched ) {
+			TimelineRef timeline = Timeline::create();
+			timeline->setBatched( batched != 0 );
+			vector<Anim<vec3>> values( count, Anim<vec3>( vec3( 0 ) ) );
+			Rand rnd( 1 );
+			// staggered over 10 seconds, so at any time some haven't started and some are finished
+			for( size_t i = 0; i < count; ++i )
+				timeline->apply( &values[i], rnd.nextVec3(), rnd.nextFloat( 1, 4 ), sEaseFns[i % 17] ).delay( rnd.nextFloat( 0, 6 ) );
+
+			const int numFrames = 600;
+			Timer timer( true );
+			for( int frame = 0; frame < numFrames; ++frame )
+				timeline->step( 1 / 60.0f );
+			seconds[batched] = timer.getSeconds() / numFrames;
+		}
+		cout << count << " tweens: " << seconds[0] * 1000 << " ms/step regular, " << seconds[1] * 1000 << " ms/step batched" << endl;
+	}
+}
@@ -0,0 +1,488 @@
+#include "catch.hpp"
+#include "cinder/TriMesh.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <array>
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+// Returns a mesh where each triangle of \a source has its own three vertices
+TriMesh unweld( const TriMesh &source )
+{
+	TriMesh result( TriMesh::Format().positions().normals().texCoords0( 2 ) );
+	for( size_t i = 0; i < source.getNumIndices(); ++i ) {
+		uint32_t index = source.getIndices()[i];
+		result.appendPosition( source.getPositions<3>()[index] );
+		result.appendNormal( source.getNormals()[index] );
+		result.appendTexCoord0( source.getTexCoords0<2>()[index] );
+	}
+	for( uint32_t i = 0; i < source.getNumIndices(); i += 3 )
+		result.appendTriangle( i, i + 1, i + 2 );
+
+	return result;
+}
+
+BufferRef writeToBuffer( const TriMesh &mesh, const TriMesh::WriteOptions &options )
+{
+	OStreamMemRef stream = OStreamMem::create();
+	mesh.write( DataTargetStream::createRef( stream ), options );
+	BufferRef result = make_shared<Buffer>( (size_t)stream->tell() );
+	memcpy( result->getData(), stream->getBuffer(), result->getSize() );
+	return result;
+}
+
+// Returns the positions of each triangle, with the corners rotated to start at the smallest, sorted
+vector<array<vec3, 3>> sortedTriangles( const TriMesh &mesh )
+{
+	auto less = []( const vec3 &a, const vec3 &b ) { return std::tie( a.x, a.y, a.z ) < std::tie( b.x, b.y, b.z ); };
+	vector<array<vec3, 3>> result;
+	for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+		array<vec3, 3> tri;
+		mesh.getTriangleVertices( t, &tri[0], &tri[1], &tri[2] );
+		std::rotate( tri.begin(), std::min_element( tri.begin(), tri.end(), less ), tri.end() );
+		result.push_back( tri );
+	}
+	std::sort( result.begin(), result.end(), [&]( const array<vec3, 3> &a, const array<vec3, 3> &b ) {
+		return std::lexicographical_compare( a.begin(), a.end(), b.begin(), b.end(), less );
+	} );
+	return result;
+}
+
+float calcArea( const TriMesh &mesh )
+{
+	float result = 0;
+	for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+		vec3 v0, v1, v2;
+		mesh.getTriangleVertices( t, &v0, &v1, &v2 );
+		result += length( cross( v1 - v0, v2 - v0 ) ) / 2;
+	}
+	return result;
+}
+
+bool indicesValid( const TriMesh &mesh )
+{
+	for( auto index : mesh.getIndices() )
+		if( index >= mesh.getNumVertices() )
+			return false;
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "TriMesh" )
+{
+	SECTION( "weld merges vertices by position" )
+	{
+		TriMesh cube( geom::Cube(), TriMesh::Format().positions().normals().texCoords0( 2 ) );
+		REQUIRE( cube.getNumVertices() == 24 );
+		const size_t numTriangles = cube.getNumTriangles();
+		const vec3 firstPosition = cube.getPositions<3>()[0];
+
+		REQUIRE( cube.weld() == 16 );
+		REQUIRE( cube.getNumVertices() == 8 );
+		REQUIRE( cube.getNormals().size() == 8 );
+		REQUIRE( cube.getBufferTexCoords0().size() == 16 );
+		REQUIRE( cube.getNumTriangles() == numTriangles );
+		REQUIRE( cube.getPositions<3>()[0] == firstPosition );
+		REQUIRE( indicesValid( cube ) );
+		REQUIRE( cube.weld() == 0 );
+	}
+
+	SECTION( "weld tolerance" )
+	{
+		TriMesh mesh( TriMesh::Format().positions() );
+		mesh.appendPosition( vec3( 0, 0, 0 ) );
+		mesh.appendPosition( vec3( 1, 0, 0 ) );
+		mesh.appendPosition( vec3( 0, 1, 0 ) );
+		mesh.appendPosition( vec3( -0.0f, 0.001f, 0 ) );
+		mesh.appendPosition( vec3( 1.0005f, 0, 0 ) );
+		mesh.appendPosition( vec3( -0.0f, 0, 0 ) );
+		mesh.appendTriangle( 0, 1, 2 );
+		mesh.appendTriangle( 3, 4, 5 );
+
+		TriMesh exact = mesh;
+		REQUIRE( exact.weld( 0 ) == 1 );
+		REQUIRE( exact.getIndices()[5] == 0 );
+
+		TriMesh loose = mesh;
+		REQUIRE( loose.weld( 0.01f ) == 3 );
+		REQUIRE( loose.getNumVertices() == 3 );
+		REQUIRE( loose.getIndices() == vector<uint32_t>( { 0, 1, 2, 0, 1, 0 } ) );
+
+		TriMesh nonFinite( TriMesh::Format().positions() );
+		nonFinite.appendPosition( vec3( NAN, 0, 0 ) );
+		nonFinite.appendPosition( vec3( NAN, 0, 0 ) );
+		nonFinite.appendPosition( vec3( INFINITY, 0, 0 ) );
+		nonFinite.appendTriangle( 0, 1, 2 );
+		REQUIRE( nonFinite.weld() == 0 );
+
+		// cells beyond the range of int64_t, and a tolerance too small to square
+		TriMesh huge( TriMesh::Format().positions() );
+		huge.appendPosition( vec3( 3e38f, -3e38f, 0 ) );
+		huge.appendPosition( vec3( 3e38f, -3e38f, 0 ) );
+		huge.appendPosition( vec3( 2e38f, -3e38f, 0 ) );
+		huge.appendTriangle( 0, 1, 2 );
+		TriMesh tiny = huge;
+		REQUIRE( huge.weld( 1e-6f ) == 1 );
+		REQUIRE( tiny.weld( 1e-30f ) == 1 );
+	}
+
+	SECTION( "removeDuplicateVertices compares all attributes" )
+	{
+		TriMesh cube( geom::Cube(), TriMesh::Format().positions().normals().texCoords0( 2 ) );
+		TriMesh soup = unweld( cube );
+		REQUIRE( soup.getNumVertices() == 36 );
+
+		// corners are shared by faces with different normals, so only the vertices within a face are merged
+		REQUIRE( soup.removeDuplicateVertices() == 12 );
+		REQUIRE( soup.getNumVertices() == 24 );
+		REQUIRE( indicesValid( soup ) );
+		for( size_t i = 0; i < soup.getNumIndices(); ++i ) {
+			uint32_t index = soup.getIndices()[i], cubeIndex = cube.getIndices()[i];
+			REQUIRE( soup.getPositions<3>()[index] == cube.getPositions<3>()[cubeIndex] );
+			REQUIRE( soup.getNormals()[index] == cube.getNormals()[cubeIndex] );
+		}
+	}
+
+	SECTION( "Flat and smooth normals" )
+	{
+		TriMesh cube( geom::Cube(), TriMesh::Format().positions().normals() );
+		vector<vec3> expected = cube.getNormals();
+		REQUIRE( cube.recalculateNormals() );
+		for( size_t i = 0; i < expected.size(); ++i )
+			REQUIRE( distance( cube.getNormals()[i], expected[i] ) < 0.0001f );
+
+		// smooth normals of a sphere are continuous across the seam and point away from the center
+		TriMesh sphere( geom::Sphere().subdivisions( 32 ), TriMesh::Format().positions().normals() );
+		TriMesh soup = unweld( TriMesh( geom::Sphere().subdivisions( 32 ), TriMesh::Format().positions().normals().texCoords0( 2 ) ) );
+		for( auto *mesh : { &sphere, &soup } ) {
+			REQUIRE( mesh->recalculateNormals( true, true ) );
+			for( size_t i = 0; i < mesh->getNumVertices(); ++i )
+				REQUIRE( dot( mesh->getNormals()[i], normalize( mesh->getPositions<3>()[i] ) ) > 0.99f );
+		}
+		for( size_t i = 0; i < soup.getNumIndices(); ++i ) {
+			uint32_t index = sphere.getIndices()[i];
+			REQUIRE( distance( soup.getNormals()[soup.getIndices()[i]], sphere.getNormals()[index] ) < 0.0001f );
+		}
+
+		// a tolerance of zero still welds the identical corners of a cube
+		REQUIRE( cube.recalculateNormals( true, false, 0 ) );
+		for( size_t i = 0; i < cube.getNumVertices(); ++i ) {
+			for( size_t j = 0; j < cube.getNumVertices(); ++j )
+				if( cube.getPositions<3>()[i] == cube.getPositions<3>()[j] )
+					REQUIRE( cube.getNormals()[i] == cube.getNormals()[j] );
+			REQUIRE( glm::all( glm::notEqual( cube.getNormals()[i], vec3( 0 ) ) ) );
+		}
+	}
+
+	SECTION( "Tangents and bitangents" )
+	{
+		TriMesh cube( geom::Cube(), TriMesh::Format().positions().normals().texCoords0( 2 ) );
+		REQUIRE( cube.recalculateBitangents() );
+		REQUIRE( cube.getTangents().size() == cube.getNumVertices() );
+		REQUIRE( cube.getBitangents().size() == cube.getNumVertices() );
+		for( size_t i = 0; i < cube.getNumVertices(); ++i ) {
+			REQUIRE( length( cube.getTangents()[i] ) == Approx( 1 ) );
+			REQUIRE( dot( cube.getTangents()[i], cube.getNormals()[i] ) == Approx( 0 ).margin( 0.0001 ) );
+			REQUIRE( distance( cube.getBitangents()[i], cross( cube.getNormals()[i], cube.getTangents()[i] ) ) < 0.0001f );
+		}
+	}
+
+	SECTION( "Vertex cache, overdraw and vertex fetch optimization" )
+	{
+		// shuffle the triangles of a sphere, as an arbitrary order from an import
+		TriMesh mesh( geom::Sphere().subdivisions( 48 ), TriMesh::Format().positions().normals() );
+		vector<uint32_t> &indices = mesh.getIndices();
+		Rand rnd( 42 );
+		for( size_t t = mesh.getNumTriangles() - 1; t > 0; --t )
+			std::swap_ranges( indices.begin() + t * 3, indices.begin() + t * 3 + 3, indices.begin() + rnd.nextUint( uint32_t( t + 1 ) ) * 3 );
+		const auto triangles = sortedTriangles( mesh );
+		const auto shuffled = mesh.calcVertexCacheStatistics();
+		REQUIRE( shuffled.acmr > 2 );
+
+		mesh.optimizeVertexCache();
+		const auto optimized = mesh.calcVertexCacheStatistics();
+		REQUIRE( optimized.acmr < 0.8f );
+		REQUIRE( optimized.atvr < 1.5f );
+		REQUIRE( sortedTriangles( mesh ) == triangles );
+
+		mesh.optimizeOverdraw( 1.05f );
+		REQUIRE( mesh.calcVertexCacheStatistics().acmr < optimized.acmr * 1.1f );
+		REQUIRE( sortedTriangles( mesh ) == triangles );
+
+		mesh.appendPosition( vec3( 2 ) );
+		mesh.appendNormal( vec3( 0, 1, 0 ) );
+		REQUIRE( mesh.optimizeVertexFetch() == 1 );
+		REQUIRE( indicesValid( mesh ) );
+		REQUIRE( sortedTriangles( mesh ) == triangles );
+		uint32_t next = 0;
+		for( auto index : mesh.getIndices() ) {
+			REQUIRE( index <= next );
+			next = std::max( next, index + 1 );
+		}
+		REQUIRE( next == mesh.getNumVertices() );
+
+		// the same optimizations as geom::Modifiers
+		TriMesh modified( geom::Sphere().subdivisions( 48 ) >> geom::OptimizeVertexCache().overdraw() >> geom::OptimizeVertexFetch() );
+		TriMesh unmodified( geom::Sphere().subdivisions( 48 ) );
+		REQUIRE( modified.getNumIndices() == unmodified.getNumIndices() );
+		REQUIRE( modified.getNumVertices() == unmodified.getNumVertices() );
+		REQUIRE( modified.calcVertexCacheStatistics().acmr < unmodified.calcVertexCacheStatistics().acmr );
+		REQUIRE( sortedTriangles( modified ) == sortedTriangles( unmodified ) );
+		REQUIRE( modified.getIndices()[0] == 0 );
+	}
+
+	SECTION( "Simplification" )
+	{
+		// a flat grid simplifies to a few triangles without error, keeping its border
+		TriMesh plane( geom::Plane().subdivisions( ivec2( 32 ) ), TriMesh::Format().positions().normals() );
+		const AxisAlignedBox bounds = plane.calcBoundingBox();
+		const float area = calcArea( plane );
+		float error = -1;
+		REQUIRE( plane.simplify( 0, 0.0001f, &error ) > 0 );
+		REQUIRE( plane.getNumTriangles() < 32 * 8 );
+		REQUIRE( error < 0.0001f );
+		REQUIRE( indicesValid( plane ) );
+		REQUIRE( plane.getNormals().size() == plane.getNumVertices() );
+		REQUIRE( calcArea( plane ) == Approx( area ) );
+		REQUIRE( plane.calcBoundingBox().getMin() == bounds.getMin() );
+		REQUIRE( plane.calcBoundingBox().getMax() == bounds.getMax() );
+
+		// a sphere stays close to the surface, within the error reported
+		TriMesh sphere( geom::Sphere().subdivisions( 64 ), TriMesh::Format().positions().normals().texCoords0() );
+		const size_t numTriangles = sphere.getNumTriangles();
+		REQUIRE( sphere.simplify( numTriangles / 4, FLT_MAX, &error ) > 0 );
+		REQUIRE( sphere.getNumTriangles() <= numTriangles / 4 );
+		REQUIRE( error > 0 );
+		REQUIRE( error < 0.05f );
+		REQUIRE( indicesValid( sphere ) );
+		REQUIRE( calcArea( sphere ) == Approx( 4 * M_PI ).epsilon( 0.05 ) );
+
+		// an error bound stops the simplification early
+		TriMesh bounded( geom::Sphere().subdivisions( 64 ), TriMesh::Format().positions() );
+		bounded.simplify( 0, 0.002f, &error );
+		REQUIRE( bounded.getNumTriangles() > numTriangles / 4 );
+		REQUIRE( bounded.getNumTriangles() < numTriangles );
+		REQUIRE( error <= 0.002f );
+	}
+
+	SECTION( "Version 3 file format" )
+	{
+		TriMesh mesh( geom::Sphere().subdivisions( 32 ), TriMesh::Format().positions().normals().texCoords0( 2 ).colors( 4 ) );
+		mesh.recalculateTangents();
+		const auto lossless = TriMesh::WriteOptions().compressIndices().compressVertices();
+		const auto quantized = TriMesh::WriteOptions().quantizeNormals().quantizeTexCoords();
+
+		for( const auto &options : { TriMesh::WriteOptions(), lossless, quantized, TriMesh::WriteOptions( quantized ).compressVertices() } ) {
+			BufferRef buffer = writeToBuffer( mesh, options );
+			TriMesh read( TriMesh::Format().positions() );
+			read.read( DataSourceBuffer::create( buffer ) );
+			REQUIRE( read.getIndices() == mesh.getIndices() );
+			REQUIRE( read.getBufferPositions() == mesh.getBufferPositions() );
+			REQUIRE( read.getBufferColors() == mesh.getBufferColors() );
+			REQUIRE( read.getAvailableAttribs() == mesh.getAvailableAttribs() );
+			for( size_t i = 0; i < mesh.getNumVertices(); ++i ) {
+				REQUIRE( distance( read.getNormals()[i], mesh.getNormals()[i] ) < 0.0001f );
+				// quantized vectors are unit length, even where the tangents of the sphere's poles are zero
+				if( ! options.getQuantizeNormals() || length( mesh.getTangents()[i] ) > 0.5f )
+					REQUIRE( distance( read.getTangents()[i], mesh.getTangents()[i] ) < 0.0001f );
+				REQUIRE( distance( read.getTexCoords0<2>()[i], mesh.getTexCoords0<2>()[i] ) < 0.0001f );
+			}
+
+			TriMeshView view( buffer );
+			REQUIRE( view.getNumVertices() == mesh.getNumVertices() );
+			REQUIRE( view.getNumIndices() == mesh.getNumIndices() );
+			REQUIRE( view.isIndicesMapped() == ! options.getCompressIndices() );
+			REQUIRE( view.isAttribMapped( geom::POSITION ) == ! options.getCompressVertices() );
+			REQUIRE( view.isAttribMapped( geom::NORMAL ) == ! ( options.getCompressVertices() || options.getQuantizeNormals() ) );
+			REQUIRE( view.getAttribDims( geom::COLOR ) == 4 );
+			REQUIRE( view.getAttribData( geom::BITANGENT ) == nullptr );
+			REQUIRE( TriMesh( view ).getBufferPositions() == mesh.getBufferPositions() );
+		}
+
+		// uncompressed blocks are used in place
+		BufferRef buffer = writeToBuffer( mesh, TriMesh::WriteOptions() );
+		TriMeshView view( buffer );
+		const uint8_t *begin = static_cast<const uint8_t*>( buffer->getData() );
+		const uint8_t *data = reinterpret_cast<const uint8_t*>( view.getAttribData( geom::POSITION ) );
+		REQUIRE( data > begin );
+		REQUIRE( data < begin + buffer->getSize() );
+		REQUIRE( ( data - begin ) % 16 == 0 );
+		REQUIRE( memcmp( view.getIndices(), mesh.getIndices().data(), mesh.getNumIndices() * sizeof( uint32_t ) ) == 0 );
+
+		// compression makes smaller files
+		REQUIRE( writeToBuffer( mesh, lossless )->getSize() < buffer->getSize() );
+		REQUIRE( writeToBuffer( mesh, quantized )->getSize() < buffer->getSize() );
+		REQUIRE( writeToBuffer( mesh, TriMesh::WriteOptions( quantized ).compressVertices() )->getSize() < writeToBuffer( mesh, quantized )->getSize() );
+
+		// attributes can be omitted, and version 2 is still supported
+		TriMesh positions( TriMesh::Format().positions() );
+		positions.read( DataSourceBuffer::create( writeToBuffer( mesh, TriMesh::WriteOptions().attribs( { geom::POSITION } ) ) ) );
+		REQUIRE( positions.getAvailableAttribs() == geom::AttribSet( { geom::POSITION } ) );
+		TriMesh v2;
+		v2.read( DataSourceBuffer::create( writeToBuffer( mesh, TriMesh::WriteOptions().version( 2 ) ) ) );
+		REQUIRE( v2.getBufferPositions() == mesh.getBufferPositions() );
+
+		// files are memory mapped
+		const fs::path path = fs::temp_directory_path() / "cinder_TriMeshTest.bin";
+		mesh.write( writeFile( path ), TriMesh::WriteOptions() );
+		{
+			TriMeshView mapped( loadFile( path ) );
+			REQUIRE( mapped.isAttribMapped( geom::POSITION ) );
+			REQUIRE( memcmp( mapped.getAttribData( geom::POSITION ), mesh.getBufferPositions().data(), mesh.getBufferPositions().size() * sizeof( float ) ) == 0 );
+		}
+		fs::remove( path );
+
+		// truncated or corrupt files throw
+		Buffer truncated( buffer->getData(), buffer->getSize() / 2 );
+		REQUIRE_THROWS_AS( TriMeshView( truncated.getData(), truncated.getSize() ), Exception );
+		Buffer corrupt( *buffer );
+		static_cast<uint8_t*>( corrupt.getData() )[16 + 4] = 7;
+		REQUIRE_THROWS_AS( TriMeshView( corrupt.getData(), corrupt.getSize() ), Exception );
+
+		// as do counts larger than the block could hold, indices past the last vertex and unknown attributes
+		auto findBlock = []( Buffer &file, uint32_t mask ) {
+			uint8_t *data = static_cast<uint8_t*>( file.getData() );
+			uint32_t attrib;
+			for( size_t desc = 16; ; desc += 32 ) {
+				memcpy( &attrib, data + desc, sizeof( attrib ) );
+				if( attrib == mask )
+					return data + desc;
+			}
+		};
+		auto findIndexBlock = [&findBlock]( Buffer &file ) { return findBlock( file, 0 ); };
+		Buffer compressed( *writeToBuffer( mesh, lossless ) );
+		const uint32_t hugeCount = 0x7fffffff;
+		memcpy( findIndexBlock( compressed ) + 8, &hugeCount, sizeof( hugeCount ) );
+		REQUIRE_THROWS_AS( TriMeshView( compressed.getData(), compressed.getSize() ), Exception );
+
+		Buffer outOfRange( *buffer );
+		uint64_t indicesOffset;
+		memcpy( &indicesOffset, findIndexBlock( outOfRange ) + 16, sizeof( indicesOffset ) );
+		const uint32_t badIndex = uint32_t( mesh.getNumVertices() );
+		memcpy( static_cast<uint8_t*>( outOfRange.getData() ) + indicesOffset + 4 * sizeof( uint32_t ), &badIndex, sizeof( badIndex ) );
+		REQUIRE_THROWS_AS( TriMeshView( outOfRange.getData(), outOfRange.getSize() ), Exception );
+
+		Buffer unknownAttrib( *buffer );
+		const uint32_t normalMask = 0x100, colorMask = 0x2, positionMask = 0x1;
+		const uint32_t twoAttribs = normalMask | colorMask;
+		memcpy( findBlock( unknownAttrib, normalMask ), &twoAttribs, sizeof( twoAttribs ) );
+		REQUIRE_THROWS_AS( TriMeshView( unknownAttrib.getData(), unknownAttrib.getSize() ), Exception );
+
+		// a block at a misaligned offset is copied rather than used in place
+		Buffer misaligned( *buffer );
+		uint8_t *positionsDesc = findBlock( misaligned, positionMask );
+		uint64_t positionsOffset;
+		memcpy( &positionsOffset, positionsDesc + 16, sizeof( positionsOffset ) );
+		++positionsOffset;
+		memcpy( positionsDesc + 16, &positionsOffset, sizeof( positionsOffset ) );
+		TriMeshView misalignedView( misaligned.getData(), misaligned.getSize() );
+		REQUIRE( ! misalignedView.isAttribMapped( geom::POSITION ) );
+		REQUIRE( misalignedView.isAttribMapped( geom::NORMAL ) );
+	}
+} // trimesh
+
+TEST_CASE( "TriMeshBenchmark", "[.][benchmark]" )
+{
+	// a triangle soup, as loaded from an STL file, with every position shared by six triangles
+	TriMesh grid = unweld( TriMesh( geom::Plane().subdivisions( ivec2( 400 ) ), TriMesh::Format().positions().normals().texCoords0( 2 ) ) );
+	cout << "Triangle soup of " << grid.getNumVertices() << " vertices" << endl;
+
+	Timer t( true );
+	TriMesh smooth = grid;
+	smooth.recalculateNormals( true );
+	cout << "recalculateNormals( smooth ): " << t.getSeconds() << " s" << endl;
+
+	t.start();
+	grid.recalculateNormals();
+	cout << "recalculateNormals(): " << t.getSeconds() << " s" << endl;
+
+	t.start();
+	grid.recalculateTangents();
+	cout << "recalculateTangents(): " << t.getSeconds() << " s" << endl;
+
+	t.start();
+	size_t removed = grid.weld();
+	cout << "weld(): " << t.getSeconds() << " s, removed " << removed << " vertices" << endl;
+	REQUIRE( grid.getNumVertices() == 401 * 401 );
+}
+
+TEST_CASE( "TriMeshOptimizeBenchmark", "[.][benchmark]" )
+{
+	// a scan-like mesh: a sphere with its triangles in random order
+	TriMesh mesh( geom::Sphere().subdivisions( 512 ), TriMesh::Format().positions().normals().texCoords0( 2 ) );
+	vector<uint32_t> &indices = mesh.getIndices();
+	Rand rnd( 1 );
+	for( size_t t = mesh.getNumTriangles() - 1; t > 0; --t )
+		std::swap_ranges( indices.begin() + t * 3, indices.begin() + t * 3 + 3, indices.begin() + rnd.nextUint( uint32_t( t + 1 ) ) * 3 );
+
+	auto printStatistics = [&]( const char *name, double seconds ) {
+		const auto stats = mesh.calcVertexCacheStatistics();
+		cout << name << ": " << seconds << " s, ACMR " << stats.acmr << ", ATVR " << stats.atvr << endl;
+	};
+	cout << mesh.getNumTriangles() << " triangles" << endl;
+	printStatistics( "shuffled", 0 );
+
+	Timer t( true );
+	mesh.optimizeVertexCache();
+	printStatistics( "optimizeVertexCache()", t.getSeconds() );
+
+	t.start();
+	mesh.optimizeOverdraw();
+	printStatistics( "optimizeOverdraw()", t.getSeconds() );
+
+	t.start();
+	mesh.optimizeVertexFetch();
+	printStatistics( "optimizeVertexFetch()", t.getSeconds() );
+
+	for( size_t target : { mesh.getNumTriangles() / 2, mesh.getNumTriangles() / 10, mesh.getNumTriangles() / 100 } ) {
+		TriMesh lod = mesh;
+		float error;
+		t.start();
+		lod.simplify( target, FLT_MAX, &error );
+		cout << "simplify( " << target << " ): " << t.getSeconds() << " s, " << lod.getNumTriangles() << " triangles, error " << error << endl;
+	}
+}
+
+TEST_CASE( "TriMeshFileBenchmark", "[.][benchmark]" )
+{
+	TriMesh mesh( geom::Sphere().subdivisions( 1024 ), TriMesh::Format().positions().normals().texCoords0( 2 ) );
+	const fs::path path = fs::temp_directory_path() / "cinder_TriMeshFileBenchmark.bin";
+	const double megabytes = ( mesh.getBufferPositions().size() + mesh.getNormals().size() * 3 + mesh.getBufferTexCoords0().size() + mesh.getNumIndices() ) * 4 / ( 1024.0 * 1024.0 );
+	cout << mesh.getNumVertices() << " vertices, " << mesh.getNumTriangles() << " triangles, " << megabytes << " MB" << endl;
+
+	const pair<const char*, TriMesh::WriteOptions> formats[] = {
+		{ "V2", TriMesh::WriteOptions().version( 2 ) },
+		{ "V3", TriMesh::WriteOptions() },
+		{ "V3 compressed", TriMesh::WriteOptions().compressIndices().compressVertices() },
+		{ "V3 quantized", TriMesh::WriteOptions().quantizeNormals().quantizeTexCoords() },
+		{ "V3 quantized + compressed", TriMesh::WriteOptions().quantizeNormals().quantizeTexCoords().compressIndices().compressVertices() }
+	};
+
+	for( const auto &format : formats ) {
+		Timer t( true );
+		mesh.write( writeFile( path ), format.second );
+		double writeSeconds = t.getSeconds();
+
+		t.start();
+		TriMesh read;
+		read.read( loadFile( path ) );
+		double readSeconds = t.getSeconds();
+		REQUIRE( read.getNumIndices() == mesh.getNumIndices() );
+
+		cout << format.first << ": " << fs::file_size( path ) / ( 1024.0 * 1024.0 ) << " MB, write " << megabytes / writeSeconds << " MB/s, read " << megabytes / readSeconds << " MB/s";
+		if( format.second.getVersion() == 3 ) {
+			t.start();
+			TriMeshView view( loadFile( path ) );
+			cout << ", view " << t.getSeconds() * 1000 << " ms";
+		}
+		cout << endl;
+	}
+
+	fs::remove( path );
+}
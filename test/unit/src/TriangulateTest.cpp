@@ -0,0 +1,212 @@
+#include "catch.hpp"
+#include "cinder/Triangulate.h"
+#include "cinder/Rand.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "PolygonTestUtils.h"
+
+#include <iostream>
+
+using namespace cinder;
+using namespace std;
+
+namespace {
+
+Shape2d starShape( Rand &rnd, const vec2 &center, float minRadius, float maxRadius, int numPoints )
+{
+	Shape2d result;
+	auto points = star( rnd, center, minRadius, maxRadius, numPoints );
+	result.moveTo( points[0] );
+	for( size_t i = 1; i < points.size(); ++i )
+		result.lineTo( points[i] );
+	result.close();
+	return result;
+}
+
+// Sum of the signed areas of the triangles
+double signedArea( const TriMesh &mesh )
+{
+	const vec2 *positions = mesh.getPositions<2>();
+	const auto &indices = mesh.getIndices();
+	double sum = 0;
+	for( size_t i = 0; i < indices.size(); i += 3 ) {
+		const vec2 &a = positions[indices[i]], &b = positions[indices[i + 1]], &c = positions[indices[i + 2]];
+		sum += ( (double)b.x - a.x ) * ( (double)c.y - a.y ) - ( (double)b.y - a.y ) * ( (double)c.x - a.x );
+	}
+	return sum / 2;
+}
+
+// Returns the tesselation computed by libtess2, which is used whenever there is more than one contour
+TriMesh calcGeneralMesh( const vector<vec2> &points, Triangulator::Winding winding )
+{
+	Triangulator triangulator;
+	triangulator.addPolyLine( points.data(), points.size() );
+	vector<vec2> far = { vec2( 1e5f, 1e5f ), vec2( 1e5f + 1, 1e5f ), vec2( 1e5f, 1e5f + 1 ) };
+	triangulator.addPolyLine( far.data(), far.size() );
+	TriMesh mesh = triangulator.calcMesh( winding );
+	// drop the far triangle
+	TriMesh result( TriMesh::Format().positions( 2 ) );
+	result.appendPositions( mesh.getPositions<2>(), mesh.getNumVertices() );
+	for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+		vec2 a, b, c;
+		mesh.getTriangleVertices( t, &a, &b, &c );
+		if( a.x < 1e4f && b.x < 1e4f && c.x < 1e4f )
+			result.appendTriangle( mesh.getIndices()[t * 3], mesh.getIndices()[t * 3 + 1], mesh.getIndices()[t * 3 + 2] );
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Triangulator" )
+{
+	SECTION( "simple contours" )
+	{
+		Rand rnd( 7 );
+		for( int i = 0; i < 50; ++i ) {
+			auto points = star( rnd, vec2( rnd.nextFloat( -100, 100 ), rnd.nextFloat( -100, 100 ) ), 1, 50, 3 + i * 3 );
+			if( i % 2 )
+				reverse( points.begin(), points.end() );
+			const double area = signedArea( points );
+
+			for( int w = 0; w <= Triangulator::WINDING_ABS_GEQ_TWO; ++w ) {
+				const auto winding = (Triangulator::Winding)w;
+				TriMesh mesh = Triangulator( PolyLine2f( points ) ).calcMesh( winding );
+				TriMesh general = calcGeneralMesh( points, winding );
+				REQUIRE( mesh.getNumTriangles() == general.getNumTriangles() );
+				REQUIRE( signedArea( mesh ) == Approx( signedArea( general ) ).epsilon( 1e-4 ) );
+				if( winding == Triangulator::WINDING_NEGATIVE || winding == Triangulator::WINDING_ABS_GEQ_TWO ) {
+					REQUIRE( mesh.getNumTriangles() == 0 );
+				}
+				else {
+					REQUIRE( mesh.getNumVertices() == points.size() );
+					REQUIRE( signedArea( mesh ) == Approx( area ).epsilon( 1e-4 ) );
+				}
+			}
+		}
+	}
+
+	SECTION( "concave and degenerate contours" )
+	{
+		// comb with collinear points along its base and a repeated closing point
+		vector<vec2> comb = { vec2( 0, 0 ), vec2( 1, 0 ), vec2( 2, 0 ), vec2( 3, 0 ), vec2( 3, 3 ), vec2( 2.5f, 1 ), vec2( 2, 3 ), vec2( 1.5f, 1 ), vec2( 1, 3 ), vec2( 0.5f, 1 ), vec2( 0, 3 ), vec2( 0, 0 ) };
+		TriMesh mesh = Triangulator( PolyLine2f( comb ) ).calcMesh();
+		REQUIRE( signedArea( mesh ) == Approx( signedArea( comb ) ) );
+		for( size_t t = 0; t < mesh.getNumTriangles(); ++t ) {
+			vec2 a, b, c;
+			mesh.getTriangleVertices( t, &a, &b, &c );
+			REQUIRE( ( b.x - a.x ) * ( c.y - a.y ) - ( b.y - a.y ) * ( c.x - a.x ) >= 0 );
+		}
+
+		// a bowtie isn't simple and is resolved by libtess2
+		vector<vec2> bowtie = { vec2( 0, 0 ), vec2( 2, 2 ), vec2( 2, 0 ), vec2( 0, 2 ) };
+		REQUIRE( abs( signedArea( Triangulator( PolyLine2f( bowtie ) ).calcMesh() ) ) == Approx( 2 ) );
+	}
+
+	SECTION( "holes" )
+	{
+		Shape2d shape;
+		shape.moveTo( 0, 0 ); shape.lineTo( 10, 0 ); shape.lineTo( 10, 10 ); shape.lineTo( 0, 10 ); shape.close();
+		shape.moveTo( 2, 2 ); shape.lineTo( 8, 2 ); shape.lineTo( 8, 8 ); shape.lineTo( 2, 8 ); shape.close();
+		REQUIRE( signedArea( Triangulator( shape ).calcMesh() ) == Approx( 64 ) );
+		REQUIRE( signedArea( Triangulator( shape ).calcMesh( Triangulator::WINDING_NONZERO ) ) == Approx( 100 ) );
+	}
+
+	SECTION( "reuse" )
+	{
+		Rand rnd( 3 );
+		Shape2d shape = starShape( rnd, vec2( 0 ), 5, 10, 20 );
+		shape.appendContour( starShape( rnd, vec2( 30, 0 ), 5, 10, 20 ).getContour( 0 ) );
+
+		Triangulator triangulator;
+		triangulator.addShape( shape );
+		REQUIRE( triangulator.getNumContours() == 2 );
+		TriMesh first = triangulator.calcMesh();
+		REQUIRE( triangulator.getNumContours() == 0 );
+		REQUIRE( triangulator.calcMesh().getNumTriangles() == 0 );
+
+		for( int i = 0; i < 3; ++i ) {
+			triangulator.addShape( shape );
+			TriMesh again = triangulator.calcMesh();
+			REQUIRE( again.getNumIndices() == first.getNumIndices() );
+			REQUIRE( again.getIndices() == first.getIndices() );
+		}
+
+		triangulator.addShape( shape );
+		triangulator.clear();
+		REQUIRE( triangulator.createMesh()->getNumTriangles() == 0 );
+
+		// a large tesselation grows the arena beyond a single block
+		triangulator.addPolyLine( PolyLine2f( star( rnd, vec2( 0 ), 50, 100, 5000 ) ) );
+		triangulator.addPolyLine( PolyLine2f( star( rnd, vec2( 0 ), 1, 10, 1000 ) ) );
+		REQUIRE( triangulator.calcMesh().getNumTriangles() > 5000 );
+		triangulator.addShape( shape );
+		REQUIRE( triangulator.calcMesh().getIndices() == first.getIndices() );
+	}
+
+	SECTION( "batch" )
+	{
+		Rand rnd( 5 );
+		vector<Shape2d> shapes;
+		for( int i = 0; i < 100; ++i ) {
+			shapes.push_back( starShape( rnd, vec2( i * 30, 0 ), 5, 10, 3 + i % 20 ) );
+			if( i % 3 == 0 ) // shapes with holes go through libtess2
+				shapes.back().appendContour( starShape( rnd, vec2( i * 30, 0 ), 1, 4, 8 ).getContour( 0 ) );
+		}
+		shapes.push_back( Shape2d() );
+
+		TriMesh batch = Triangulator::calcMesh( shapes );
+		TriMesh sequential( TriMesh::Format().positions( 2 ) );
+		for( const auto &shape : shapes ) {
+			TriMesh mesh = Triangulator( shape ).calcMesh();
+			const uint32_t offset = (uint32_t)sequential.getNumVertices();
+			sequential.appendPositions( mesh.getPositions<2>(), mesh.getNumVertices() );
+			for( uint32_t index : mesh.getIndices() )
+				sequential.getIndices().push_back( offset + index );
+		}
+
+		REQUIRE( batch.getNumVertices() == sequential.getNumVertices() );
+		REQUIRE( batch.getIndices() == sequential.getIndices() );
+		REQUIRE( equal( batch.getPositions<2>(), batch.getPositions<2>() + batch.getNumVertices(), sequential.getPositions<2>() ) );
+		REQUIRE( Triangulator::calcMesh( vector<Shape2d>() ).getNumVertices() == 0 );
+	}
+}
+
+TEST_CASE( "TriangulatorBenchmark", "[.][benchmark]" )
+{
+	Rand rnd( 1 );
+	vector<Shape2d> shapes, withHoles;
+	size_t numPoints = 0;
+	for( int i = 0; i < 10000; ++i ) {
+		const vec2 center( rnd.nextFloat( 0, 1000 ), rnd.nextFloat( 0, 1000 ) );
+		shapes.push_back( starShape( rnd, center, 5, 10, 8 + i % 56 ) );
+		withHoles.push_back( shapes.back() );
+		withHoles.back().appendContour( starShape( rnd, center, 1, 4, 8 + i % 56 ).getContour( 0 ) );
+		numPoints += 8 + i % 56;
+	}
+
+	for( int pass = 0; pass < 2; ++pass ) {
+		const vector<Shape2d> &input = pass ? withHoles : shapes;
+		cout << input.size() << " shapes, " << numPoints * ( pass ? 2 : 1 ) << " points" << ( pass ? " with holes:" : ":" ) << endl;
+
+		Timer t( true );
+		size_t numTriangles = 0;
+		for( const auto &shape : input )
+			numTriangles += Triangulator( shape ).calcMesh().getNumTriangles();
+		cout << "  new Triangulator per shape: " << t.getSeconds() * 1000 << " ms, " << numTriangles << " triangles" << endl;
+
+		t.start();
+		Triangulator triangulator;
+		numTriangles = 0;
+		for( const auto &shape : input ) {
+			triangulator.addShape( shape );
+			numTriangles += triangulator.calcMesh().getNumTriangles();
+		}
+		cout << "  reused Triangulator: " << t.getSeconds() * 1000 << " ms, " << numTriangles << " triangles" << endl;
+
+		t.start();
+		TriMesh batch = Triangulator::calcMesh( input );
+		cout << "  batch (" << getNumParallelThreads() << " threads): " << t.getSeconds() * 1000 << " ms, " << batch.getNumTriangles() << " triangles" << endl;
+		REQUIRE( batch.getNumTriangles() == numTriangles );
+	}
+}
@@ -4,7 +4,12 @@
 #include "cinder/Utilities.h"
 #include "cinder/app/Platform.h"
 #include "cinder/app/App.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
 #include "catch.hpp"
+#include "utf8cpp/checked.h"
+
+#include <iostream>
 
 using namespace ci;
 using namespace std;
@@ -22,6 +27,48 @@ TYPE loadStringFromFile( const DataSourceRef &dataSource )
 	return TYPE( static_cast<const T*>( padded.getData() ) );
 }
 
+namespace {
+
+// Random valid text, weighted towards runs of ASCII so that the vectorized paths start and stop at every alignment
+u32string randomCodePoints( Rand &rnd, size_t count )
+{
+	u32string result;
+	while( result.size() < count ) {
+		const uint32_t kind = rnd.nextUint( 6 );
+		const size_t runLength = rnd.nextUint( 40 ) + 1;
+		for( size_t i = 0; i < runLength; ++i ) {
+			switch( kind ) {
+				case 0: case 1: result.push_back( rnd.nextUint( 0x80 ) ); break;
+				case 2: result.push_back( 0x80 + rnd.nextUint( 0x800 - 0x80 ) ); break;
+				case 3: result.push_back( 0x800 + rnd.nextUint( 0xD800 - 0x800 ) ); break;
+				case 4: result.push_back( 0xE000 + rnd.nextUint( 0x10000 - 0xE000 ) ); break;
+				default: result.push_back( 0x10000 + rnd.nextUint( 0x110000 - 0x10000 ) ); break;
+			}
+		}
+	}
+	result.resize( count );
+	return result;
+}
+
+// The original implementation of stringLengthUtf8()
+size_t stringLengthUtf8Reference( const char *str, size_t lengthInBytes )
+{
+	size_t result = 0, nextByte = 0;
+	while( nextCharUtf8( str, &nextByte, lengthInBytes ) != 0xFFFF )
+		++result;
+	return result;
+}
+
+string repeatToSize( const string &text, size_t size )
+{
+	string result;
+	while( result.size() < size )
+		result += text;
+	return result;
+}
+
+} // anonymous namespace
+
 
 TEST_CASE("Unicode")
 {
@@ -44,4 +91,230 @@ TEST_CASE("Unicode")
 		REQUIRE( u32 == toUtf32( u16 ) );
 	}
 
+	SECTION( "Conversions match utf8cpp" )
+	{
+		Rand rnd( 12 );
+		for( size_t count = 0; count < 300; count += 1 + count / 8 ) {
+			const u32string u32 = randomCodePoints( rnd, count );
+			string u8;
+			u16string u16;
+			utf8::utf32to8( u32.begin(), u32.end(), back_inserter( u8 ) );
+			utf8::utf8to16( u8.begin(), u8.end(), back_inserter( u16 ) );
+
+			REQUIRE( toUtf16( u8 ) == u16 );
+			REQUIRE( toUtf32( u8 ) == u32 );
+			REQUIRE( toUtf8( u16 ) == u8 );
+			REQUIRE( toUtf8( u32 ) == u8 );
+			REQUIRE( isValidUtf8( u8.data(), u8.size() ) );
+			REQUIRE( stringLengthUtf8( u8.data(), u8.size() ) == stringLengthUtf8Reference( u8.data(), u8.size() ) );
+		}
+	}
+
+	SECTION( "Caller-supplied buffers" )
+	{
+		const string u8 = u8"ASCII, then \u00e9\u00e8 and \u6f22\u5b57 and \U0001F600 at the end";
+		const u16string u16 = toUtf16( u8 );
+		const u32string u32 = toUtf32( u8 );
+
+		// a capacity of 0 queries the size without writing
+		REQUIRE( toUtf16( u8.data(), u8.size(), nullptr, 0 ) == u16.size() );
+		REQUIRE( toUtf32( u8.data(), u8.size(), nullptr, 0 ) == u32.size() );
+		REQUIRE( toUtf8( u16.data(), u16.size() * 2, nullptr, 0 ) == u8.size() );
+		REQUIRE( toUtf8( u32.data(), u32.size() * 4, nullptr, 0 ) == u8.size() );
+
+		// too small leaves the buffer untouched
+		vector<char16_t> buffer16( u16.size() - 1, u'x' );
+		REQUIRE( toUtf16( u8.data(), u8.size(), buffer16.data(), buffer16.size() ) == u16.size() );
+		REQUIRE( buffer16 == vector<char16_t>( u16.size() - 1, u'x' ) );
+
+		buffer16.resize( u16.size() );
+		REQUIRE( toUtf16( u8.data(), u8.size(), buffer16.data(), buffer16.size() ) == u16.size() );
+		REQUIRE( u16string( buffer16.begin(), buffer16.end() ) == u16 );
+
+		vector<char32_t> buffer32( u8.size() );
+		REQUIRE( toUtf32( u8.data(), u8.size(), buffer32.data(), buffer32.size() ) == u32.size() );
+		REQUIRE( u32string( buffer32.data(), u32.size() ) == u32 );
+
+		vector<char> buffer8( u8.size() );
+		REQUIRE( toUtf8( u16.data(), u16.size() * 2, buffer8.data(), buffer8.size() ) == u8.size() );
+		REQUIRE( string( buffer8.begin(), buffer8.end() ) == u8 );
+		REQUIRE( toUtf8( u32.data(), u32.size() * 4, buffer8.data(), buffer8.size() ) == u8.size() );
+		REQUIRE( string( buffer8.begin(), buffer8.end() ) == u8 );
+
+		// reused strings are replaced, not appended to
+		u16string reused16 = u"previous contents that are longer than the conversion";
+		toUtf16( u8.data(), 5, &reused16 );
+		REQUIRE( reused16 == u"ASCII" );
+		string reused8 = "previous";
+		toUtf8( u32.data(), u32.size() * 4, &reused8 );
+		REQUIRE( reused8 == u8 );
+	}
+
+	// a length of 0 means the input is null-terminated
+	SECTION( "Null-terminated input" )
+	{
+		REQUIRE( toUtf8( u"ab" ) == "ab" );
+		REQUIRE( toUtf8( u"abcd" ) == "abcd" );
+		REQUIRE( toUtf8( U"abc" ) == "abc" );
+		REQUIRE( toUtf8( u"" ).empty() );
+		REQUIRE( toUtf8( U"" ).empty() );
+
+		const string u8 = u8"é漢\U0001F600!";
+		REQUIRE( toUtf8( toUtf16( u8 ).c_str() ) == u8 );
+		REQUIRE( toUtf8( toUtf32( u8 ).c_str() ) == u8 );
+	}
+
+	SECTION( "Invalid input throws like utf8cpp" )
+	{
+		const char *invalid[] = { "\x80", "ab\xC0\x80", "\xE6\x97", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF8\x88\x80\x80\x80", "0123456789abcdef\xFF" };
+		for( const char *str : invalid ) {
+			const size_t length = strlen( str );
+			REQUIRE( ! isValidUtf8( str, length ) );
+			REQUIRE_THROWS_AS( toUtf16( str ), utf8::exception );
+			REQUIRE_THROWS_AS( toUtf32( str ), utf8::exception );
+			REQUIRE_THROWS_AS( toUtf16( str, length, nullptr, 0 ), utf8::exception );
+			REQUIRE( stringLengthUtf8( str, length ) == stringLengthUtf8Reference( str, length ) );
+		}
+
+		const char16_t unpaired[] = { u'a', 0xD800, u'b' };
+		REQUIRE_THROWS_AS( toUtf8( u16string( unpaired, 3 ) ), utf8::exception );
+		REQUIRE_THROWS_AS( toUtf8( u16string( 1, char16_t( 0xDC00 ) ) ), utf8::exception );
+		REQUIRE_THROWS_AS( toUtf8( u32string( 1, char32_t( 0x110000 ) ) ), utf8::exception );
+
+		// random bytes are mostly invalid, and always agree with utf8cpp and the original character count
+		Rand rnd( 5 );
+		for( int i = 0; i < 2000; ++i ) {
+			string bytes( rnd.nextUint( 24 ), 0 );
+			for( auto &b : bytes )
+				b = char( rnd.nextBool() ? rnd.nextUint( 0x80 ) : 0x80 + rnd.nextUint( 0x80 ) );
+			REQUIRE( isValidUtf8( bytes.data(), bytes.size() ) == utf8::is_valid( bytes.begin(), bytes.end() ) );
+			REQUIRE( stringLengthUtf8( bytes.data(), bytes.size() ) == stringLengthUtf8Reference( bytes.data(), bytes.size() ) );
+		}
+
+		// U+FFFF is valid, but ends the original count
+		const string maxBmp = u8"ab\uFFFFcd";
+		REQUIRE( isValidUtf8( maxBmp.data(), maxBmp.size() ) );
+		REQUIRE( stringLengthUtf8( maxBmp.data(), maxBmp.size() ) == 2 );
+	}
+
+	SECTION( "LinebreakCache matches breaking the whole text" )
+	{
+		const char *atoms[] = { "word", "longerword", " ", "  ", "\n", "\n\n", "\r\n", "-", ",", "(", ")", "\t", u8"\u00e9t\u00e9", u8"\u6f22\u5b57", u8"\u00a0" };
+		LinebreakCache cache;
+		Rand rnd( 9 );
+		for( int i = 0; i < 500; ++i ) {
+			string text;
+			for( uint32_t atom = rnd.nextUint( 40 ); atom > 0; --atom )
+				text += atoms[rnd.nextUint( sizeof( atoms ) / sizeof( atoms[0] ) )];
+
+			vector<uint8_t> breaks, cachedBreaks;
+			calcLinebreaksUtf8( text.c_str(), text.size(), &breaks );
+			cache.calcLinebreaksUtf8( text.c_str(), text.size(), &cachedBreaks );
+			REQUIRE( breaks == cachedBreaks );
+
+			const size_t width = 4 + rnd.nextUint( 12 );
+			auto measureFn = [width]( const char *, size_t length ) { return length <= width; };
+			vector<string> lines, cachedLines;
+			lineBreakUtf8( text.c_str(), measureFn, [&lines]( const char *line, size_t length ) { lines.push_back( string( line, length ) ); } );
+			cache.lineBreakUtf8( text.c_str(), text.size(), measureFn, [&cachedLines]( const char *line, size_t length ) { cachedLines.push_back( string( line, length ) ); } );
+			REQUIRE( lines == cachedLines );
+		}
+	}
+
+	SECTION( "LinebreakCache only recalculates the edited paragraph" )
+	{
+		string text;
+		for( int i = 0; i < 10; ++i )
+			text += "Paragraph number " + to_string( i ) + " has a few words in it.\n";
+		LinebreakCache cache;
+		vector<uint8_t> breaks;
+		cache.calcLinebreaksUtf8( text.c_str(), text.size(), &breaks );
+		REQUIRE( cache.getNumCalculated() == 10 );
+		REQUIRE( cache.getNumParagraphs() == 10 );
+
+		text.insert( text.find( "number 4" ), "edited " );
+		cache.calcLinebreaksUtf8( text.c_str(), text.size(), &breaks );
+		REQUIRE( cache.getNumCalculated() == 11 );
+		REQUIRE( cache.getNumParagraphs() == 10 );
+
+		vector<uint8_t> expected;
+		calcLinebreaksUtf8( text.c_str(), text.size(), &expected );
+		REQUIRE( breaks == expected );
+	}
+
+	SECTION( "LinebreakCache shares repeated paragraphs but not the first" )
+	{
+		const string text = "  same words\n  same words\n  same words\n";
+		LinebreakCache cache;
+		vector<uint8_t> breaks, expected;
+		cache.calcLinebreaksUtf8( text.c_str(), text.size(), &breaks );
+		REQUIRE( cache.getNumCalculated() == 2 );
+		REQUIRE( cache.getNumParagraphs() == 2 );
+
+		calcLinebreaksUtf8( text.c_str(), text.size(), &expected );
+		REQUIRE( breaks == expected );
+	}
+}
+
+TEST_CASE( "UnicodeBenchmark", "[.][benchmark]" )
+{
+	const size_t size = 4 << 20;
+	const pair<const char*, string> corpora[] = {
+		{ "ASCII", repeatToSize( "The quick brown fox jumps over the lazy dog, again and again. ", size ) },
+		{ "Latin", repeatToSize( u8"Voix ambigu\u00eb d'un c\u0153ur qui, au z\u00e9phyr, pr\u00e9f\u00e8re les jattes de kiwis. Gr\u00f6\u00dfe ", size ) },
+		{ "CJK", repeatToSize( u8"\u6f22\u5b57\u4eee\u540d\u4ea4\u3058\u308a\u6587\u306f\u3001\u65e5\u672c\u8a9e\u306e\u8868\u8a18\u6cd5\u3067\u3059\u3002", size ) }
+	};
+
+	for( const auto &corpus : corpora ) {
+		const string &u8 = corpus.second;
+		const int numIterations = 10;
+		u16string u16;
+		Timer timer( true );
+		for( int i = 0; i < numIterations; ++i ) {
+			u16.clear();
+			utf8::utf8to16( u8.begin(), u8.end(), back_inserter( u16 ) );
+		}
+		const double utf8cppSeconds = timer.getSeconds();
+
+		timer.start();
+		for( int i = 0; i < numIterations; ++i )
+			u16 = toUtf16( u8 );
+		const double allocatingSeconds = timer.getSeconds();
+
+		timer.start();
+		for( int i = 0; i < numIterations; ++i )
+			toUtf16( u8.data(), u8.size(), &u16 );
+		const double reusedSeconds = timer.getSeconds();
+
+		timer.start();
+		size_t numChars = 0;
+		for( int i = 0; i < numIterations; ++i )
+			numChars += stringLengthUtf8Reference( u8.data(), u8.size() );
+		const double lengthReferenceSeconds = timer.getSeconds();
+
+		timer.start();
+		for( int i = 0; i < numIterations; ++i )
+			numChars -= stringLengthUtf8( u8.data(), u8.size() );
+		const double lengthSeconds = timer.getSeconds();
+		REQUIRE( numChars == 0 );
+
+		timer.start();
+		string back;
+		for( int i = 0; i < numIterations; ++i ) {
+			back.clear();
+			utf8::utf16to8( u16.begin(), u16.end(), back_inserter( back ) );
+		}
+		const double utf8cppBackSeconds = timer.getSeconds();
+
+		timer.start();
+		for( int i = 0; i < numIterations; ++i )
+			toUtf8( u16.data(), u16.size() * 2, &back );
+		const double backSeconds = timer.getSeconds();
+		REQUIRE( back == u8 );
+
+		const double megabytes = double( u8.size() ) * numIterations / ( 1 << 20 );
+		cout << corpus.first << ", MB/s: UTF-8 to UTF-16 utf8cpp " << megabytes / utf8cppSeconds << ", toUtf16() " << megabytes / allocatingSeconds
+			<< ", reused " << megabytes / reusedSeconds << "; stringLengthUtf8() before " << megabytes / lengthReferenceSeconds << ", after " << megabytes / lengthSeconds
+			<< "; UTF-16 to UTF-8 utf8cpp " << megabytes / utf8cppBackSeconds << ", toUtf8() " << megabytes / backSeconds << endl;
+	}
 }
@@ -0,0 +1,189 @@
+#include "cinder/XmlDocument.h"
+#include "cinder/Timer.h"
+
+#include "catch.hpp"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+const char *sXml =
+	"<?xml version='1.0'?>\n"
+	"<!DOCTYPE config>\n"
+	"<Config version='2'>\n"
+	"	<display gamma='2.2'>fullscreen<![CDATA[ <yes> ]]></display>\n"
+	"	<!-- comment -->\n"
+	"	<items>\n"
+	"		<item id='1'>one</item>\n"
+	"		<Item id='2'>two</Item>\n"
+	"		<other/>\n"
+	"		<item id='3'>three</item>\n"
+	"	</items>\n"
+	"	<items>\n"
+	"		<item id='4'>four</item>\n"
+	"	</items>\n"
+	"</Config>\n";
+
+bool treesEqual( const XmlTree &a, const XmlTree &b )
+{
+	if( a.getTag() != b.getTag() || a.getValue() != b.getValue() || a.getNodeType() != b.getNodeType() || a.getDocType() != b.getDocType() )
+		return false;
+	if( a.getAttributes().size() != b.getAttributes().size() || a.getChildren().size() != b.getChildren().size() )
+		return false;
+	for( auto attrA = a.getAttributes().begin(), attrB = b.getAttributes().begin(); attrA != a.getAttributes().end(); ++attrA, ++attrB )
+		if( attrA->getName() != attrB->getName() || attrA->getValue() != attrB->getValue() )
+			return false;
+	for( auto childA = a.begin(), childB = b.begin(); childA != a.end(); ++childA, ++childB )
+		if( ! treesEqual( *childA, *childB ) )
+			return false;
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("XmlDocument")
+{
+	SECTION("Values, attributes and paths")
+	{
+		XmlDocument doc( sXml );
+		REQUIRE( doc.getDocType() == "config" );
+		REQUIRE( doc.getRoot().isDocument() );
+
+		XmlDocument::Node config = doc / "config";
+		REQUIRE( config.getTag() == "Config" );
+		REQUIRE( config.getAttributeValue<int>( "version" ) == 2 );
+		REQUIRE( config["missing"].empty() );
+		REQUIRE( config.getAttributeValue<int>( "missing", 7 ) == 7 );
+		REQUIRE_THROWS_AS( config.getAttribute( "missing" ), XmlTree::ExcAttrNotFound );
+
+		XmlDocument::Node display = doc.getChild( "/config/display" );
+		REQUIRE( display.getValue() == "fullscreen <yes> " );
+		REQUIRE( string( display.getValueData() ) == "fullscreen" );
+		REQUIRE( display.getAttributeValue<float>( "gamma" ) == Approx( 2.2f ) );
+		REQUIRE( display.getPath() == "/Config/display" );
+		REQUIRE( display.getParent() == config );
+
+		REQUIRE( doc.getChild( "config/items/item" ).getValue() == "one" );
+		REQUIRE( doc.getChild( "config.items.item", false, '.' ).getValue() == "one" );
+		REQUIRE( doc.hasChild( "Config/items/Item", true ) );
+		REQUIRE( doc.getChild( "Config/items/Item", true ).getValue() == "two" );
+		REQUIRE_FALSE( doc.hasChild( "config/items/missing" ) );
+		REQUIRE_THROWS_AS( doc.getChild( "config/missing" ), XmlTree::ExcChildNotFound );
+	}
+
+	SECTION("Iteration follows XmlTree")
+	{
+		XmlDocument doc( sXml );
+		vector<string> ids;
+		for( auto item : doc / "config" / "items" )
+			ids.push_back( item["id"].getValue() );
+		REQUIRE( ids == vector<string>( { "1", "2", "", "3" } ) );
+
+		ids.clear();
+		for( auto it = doc.getRoot().begin( "config/items/item" ); it != doc.getRoot().end(); ++it )
+			ids.push_back( (*it)["id"].getValue() );
+		REQUIRE( ids == vector<string>( { "1", "2", "3", "4" } ) );
+
+		ids.clear();
+		for( auto it = doc.getRoot().begin( "Config/items/item", true ); it != doc.getRoot().end(); ++it )
+			ids.push_back( (*it)["id"].getValue() );
+		REQUIRE( ids == vector<string>( { "1", "3", "4" } ) );
+
+		REQUIRE( doc.getRoot().find( "config/nothing" ) == doc.getRoot().end() );
+	}
+
+	SECTION("Hashed index gives the same results")
+	{
+		XmlDocument doc( sXml );
+		doc.buildIndex();
+		REQUIRE( doc.hasIndex() );
+		REQUIRE( doc.getChild( "config/items/item" ).getValue() == "one" );
+		REQUIRE( doc.getChild( "CONFIG/ITEMS/ITEM" ).getValue() == "one" );
+		REQUIRE( doc.getChild( "Config/items/Item", true ).getValue() == "two" );
+		REQUIRE( doc.getChild( "config/items/other" ).getTag() == "other" );
+		REQUIRE_FALSE( doc.hasChild( "Config/Items", true ) );
+		REQUIRE_FALSE( doc.hasChild( "config/display/items" ) );
+		REQUIRE( ( doc / "config" / "items" / "item" ).getAttributeValue<int>( "id" ) == 1 );
+	}
+
+	SECTION("Conversion to XmlTree matches parsing with XmlTree")
+	{
+		vector<XmlTree::ParseOptions> options = { XmlTree::ParseOptions(), XmlTree::ParseOptions().parseComments().collapseCData( false ).ignoreDataChildren( false ) };
+		for( const auto &opt : options ) {
+			XmlDocument doc( sXml, opt );
+			XmlTree tree( sXml, opt );
+			REQUIRE( treesEqual( doc.toXmlTree(), tree ) );
+
+			size_t numChildren = 0;
+			for( auto child : doc / "config" ) {
+				REQUIRE( child.getNodeType() == std::next( tree.getChild( "config" ).begin(), numChildren )->getNodeType() );
+				++numChildren;
+			}
+			REQUIRE( numChildren == tree.getChild( "config" ).getChildren().size() );
+		}
+
+		XmlDocument doc( sXml );
+		XmlTree items = doc.getChild( "config/items" ).toXmlTree();
+		REQUIRE( items.getChildren().size() == 4 );
+		REQUIRE( items.getChild( "item" ).getParent().getTag() == "items" );
+	}
+} // xmldocument
+
+TEST_CASE("XmlDocumentBenchmark", "[.][benchmark]")
+{
+	// a config-style document with many distinctly named siblings, where each path lookup scans linearly in XmlTree
+	const int numSections = 2000, numParams = 100;
+	ostringstream ss;
+	ss << "<config>";
+	for( int s = 0; s < numSections; ++s ) {
+		ss << "<section" << s << " name='section " << s << "'>";
+		for( int p = 0; p < numParams; ++p )
+			ss << "<param" << p << " type='int'>" << s + p << "</param" << p << ">";
+		ss << "</section" << s << ">";
+	}
+	ss << "</config>";
+	const string xml = ss.str();
+
+	vector<string> paths;
+	for( int i = 0; i < 20000; ++i ) {
+		const int s = ( i * 7919 ) % numSections, p = ( i * 31 ) % numParams;
+		paths.push_back( "config/section" + toString( s ) + "/param" + toString( p ) );
+	}
+
+	Timer t( true );
+	XmlTree tree( xml );
+	const double treeSeconds = t.getSeconds();
+
+	t.start();
+	XmlDocument doc( xml );
+	const double docSeconds = t.getSeconds();
+
+	int64_t treeSum = 0, docSum = 0, indexedSum = 0;
+	t.start();
+	for( const auto &path : paths )
+		treeSum += tree.getChild( path ).getValue<int>();
+	const double treeLookupSeconds = t.getSeconds();
+
+	t.start();
+	for( const auto &path : paths )
+		docSum += doc.getChild( path ).getValue<int>();
+	const double docLookupSeconds = t.getSeconds();
+
+	t.start();
+	doc.buildIndex();
+	const double indexSeconds = t.getSeconds();
+
+	t.start();
+	for( const auto &path : paths )
+		indexedSum += doc.getChild( path ).getValue<int>();
+	const double indexedLookupSeconds = t.getSeconds();
+
+	REQUIRE( treeSum == docSum );
+	REQUIRE( treeSum == indexedSum );
+	cout << "Parsed " << xml.size() / 1.0e6 << " MB of XML: XmlTree " << treeSeconds << " s, XmlDocument " << docSeconds << " s, buildIndex() " << indexSeconds << " s" << endl;
+	cout << paths.size() << " path lookups: XmlTree " << treeLookupSeconds << " s, XmlDocument " << docLookupSeconds << " s, indexed " << indexedLookupSeconds << " s" << endl;
+}
@@ -5,9 +5,12 @@
 #include "cinder/Signals.h"
 #include "cinder/app/Event.h"
 
+#include "cinder/Timer.h"
+
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 
 using namespace std;
 using namespace ci;
@@ -24,6 +27,37 @@ std::string toString( float value, int precision )
 
 string sAccum = "";
 
+// Stands in for an app's event loop: functions are queued from any thread and run when drained
+struct TestDispatcher {
+	TestDispatcher()
+		: mNumDispatched( 0 )
+	{}
+
+	ConcurrentSignal<void ()>::DispatchFn getDispatchFn()
+	{
+		return [this]( const std::function<void ()> &fn ) {
+			std::lock_guard<std::mutex> lock( mMutex );
+			mQueue.push_back( fn );
+			++mNumDispatched;
+		};
+	}
+
+	void drain()
+	{
+		vector<function<void ()>> queue;
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			queue.swap( mQueue );
+		}
+		for( auto &fn : queue )
+			fn();
+	}
+
+	std::mutex					mMutex;
+	vector<function<void ()>>	mQueue;
+	size_t						mNumDispatched;
+};
+
 struct Foo {
 	char fooBool( float f, int i, string s )
 	{
@@ -625,3 +659,200 @@ TEST_CASE( "signals/Signals" )
 	}
 
 } // Signals
+
+TEST_CASE( "signals/ConcurrentSignal" )
+{
+	SECTION( "Behaves like Signal on a single thread" )
+	{
+		ConcurrentSignal<int ( int ), CollectorVector<int>> signal;
+		auto conn0 = signal.connect( []( int v ) { return v; } );
+		auto conn1 = signal.connect( -1, []( int v ) { return v * 100; } );
+		auto conn2 = signal.connect( 1, []( int v ) { return v * 10; } );
+		auto conn3 = signal.connect( []( int v ) { return v + 1; } );
+		REQUIRE( signal.getNumSlots() == 4 );
+		REQUIRE( signal.emit( 2 ) == vector<int>( { 20, 2, 3, 200 } ) );
+
+		conn3.disable();
+		REQUIRE( signal.emit( 2 ) == vector<int>( { 20, 2, 200 } ) );
+		conn3.enable();
+
+		REQUIRE( conn0.disconnect() );
+		REQUIRE( ! conn0.disconnect() );
+		REQUIRE( ! conn0.isConnected() );
+		REQUIRE( signal.getNumSlots() == 3 );
+		REQUIRE( signal.emit( 3 ) == vector<int>( { 30, 4, 300 } ) );
+
+		{
+			ScopedConnection scoped = signal.connect( 2, []( int v ) { return -v; } );
+			REQUIRE( signal.emit( 1 ) == vector<int>( { -1, 10, 2, 100 } ) );
+		}
+		REQUIRE( signal.getNumSlots() == 3 );
+	}
+
+	SECTION( "Slots may connect and disconnect during emission" )
+	{
+		ConcurrentSignal<void ()> signal;
+		int numCalls = 0;
+		Connection second;
+		signal.connect( [&] {
+			++numCalls;
+			second.disconnect();
+			signal.connect( [&] { numCalls += 100; } );
+		} );
+		second = signal.connect( [&] { numCalls += 10; } );
+
+		signal.emit();
+		REQUIRE( numCalls == 1 );
+		REQUIRE( signal.getNumSlots() == 2 );
+	}
+
+	SECTION( "Slots disconnected during emission are released when it ends" )
+	{
+		ConcurrentSignal<void ()> signal;
+		auto token = make_shared<int>( 0 );
+		Connection second;
+		signal.connect( [&] { second.disconnect(); } );
+		second = signal.connect( [token] {} );
+		REQUIRE( token.use_count() == 2 );
+
+		signal.emit();
+		REQUIRE( token.use_count() == 1 );
+		REQUIRE( signal.getNumSlots() == 1 );
+	}
+
+	SECTION( "Emitting on several threads while connecting and disconnecting" )
+	{
+		ConcurrentSignal<void ( int )> signal;
+		std::atomic<int> sum( 0 ), numTransient( 0 );
+		signal.connect( [&]( int v ) { sum += v; } );
+
+		const int numThreads = 4, numEmits = 20000;
+		vector<thread> threads;
+		for( int t = 0; t < numThreads; ++t ) {
+			threads.emplace_back( [&signal] {
+				for( int i = 0; i < numEmits; ++i )
+					signal.emit( 1 );
+			} );
+		}
+		for( int i = 0; i < 2000; ++i ) {
+			auto conn = signal.connect( i % 3 - 1, [&]( int ) { ++numTransient; } );
+			if( i % 2 )
+				conn.disable();
+			conn.disconnect();
+		}
+		for( auto &t : threads )
+			t.join();
+
+		REQUIRE( sum == numThreads * numEmits );
+		REQUIRE( signal.getNumSlots() == 1 );
+	}
+
+	SECTION( "Queued connections deliver in batches and in order" )
+	{
+		TestDispatcher dispatcher;
+		ConcurrentSignal<void ( int, const string & )> signal;
+		const int numThreads = 4, numEmits = 5000;
+		vector<vector<int>> received( numThreads );
+		signal.connectQueued( [&]( int i, const string &thread ) { received[stoi( thread )].push_back( i ); }, dispatcher.getDispatchFn() );
+
+		vector<thread> threads;
+		for( int t = 0; t < numThreads; ++t ) {
+			threads.emplace_back( [&signal, t] {
+				const string thread = to_string( t );
+				for( int i = 0; i < numEmits; ++i )
+					signal.emit( i, thread );
+			} );
+		}
+		for( auto &t : threads )
+			t.join();
+
+		REQUIRE( received[0].empty() );
+		dispatcher.drain();
+		for( const auto &values : received ) {
+			REQUIRE( values.size() == numEmits );
+			for( int i = 0; i < numEmits; ++i )
+				REQUIRE( values[i] == i );
+		}
+		REQUIRE( dispatcher.mNumDispatched < numThreads * numEmits );
+	}
+
+	SECTION( "Disconnecting skips queued calls that haven't been delivered" )
+	{
+		TestDispatcher dispatcher;
+		int numCalls = 0;
+		{
+			ConcurrentSignal<void ()> signal;
+			auto conn = signal.connectQueued( [&] { ++numCalls; }, dispatcher.getDispatchFn() );
+			signal.connectQueued( [&] { numCalls += 10; }, dispatcher.getDispatchFn() );
+			signal.emit();
+			signal.emit();
+			conn.disconnect();
+		}
+		// the signal is gone, which disconnects the second slot too
+		dispatcher.drain();
+		REQUIRE( numCalls == 0 );
+		REQUIRE( dispatcher.mNumDispatched == 2 );
+	}
+}
+
+TEST_CASE( "signals/SignalsBenchmark", "[.][benchmark]" )
+{
+	const int numEmits = 2000000;
+	for( int numSlots : { 1, 8 } ) {
+		uint64_t sum = 0;
+		Signal<void ( int )> signal;
+		ConcurrentSignal<void ( int )> concurrent;
+		for( int i = 0; i < numSlots; ++i ) {
+			signal.connect( [&sum]( int v ) { sum += v; } );
+			concurrent.connect( [&sum]( int v ) { sum += v; } );
+		}
+
+		Timer timer( true );
+		for( int i = 0; i < numEmits; ++i )
+			signal.emit( i );
+		const double signalSeconds = timer.getSeconds();
+
+		timer.start();
+		for( int i = 0; i < numEmits; ++i )
+			concurrent.emit( i );
+		const double concurrentSeconds = timer.getSeconds();
+
+		cout << numSlots << " slots, M emits/s: Signal " << numEmits / signalSeconds / 1e6 << ", ConcurrentSignal " << numEmits / concurrentSeconds / 1e6
+			<< " (" << sum << ")" << endl;
+	}
+
+	for( int numThreads : { 1, 2, 4 } ) {
+		ConcurrentSignal<void ( int )> concurrent;
+		std::atomic<int> sum( 0 );
+		concurrent.connect( [&sum]( int v ) { sum.fetch_add( v, std::memory_order_relaxed ); } );
+
+		Timer timer( true );
+		vector<thread> threads;
+		for( int t = 0; t < numThreads; ++t ) {
+			threads.emplace_back( [&concurrent, numThreads] {
+				for( int i = 0; i < numEmits / numThreads; ++i )
+					concurrent.emit( 1 );
+			} );
+		}
+		for( auto &t : threads )
+			t.join();
+		cout << numThreads << " emitting threads, M emits/s: " << numEmits / timer.getSeconds() / 1e6 << endl;
+	}
+
+	{
+		TestDispatcher dispatcher;
+		ConcurrentSignal<void ( int )> concurrent;
+		int sum = 0;
+		concurrent.connectQueued( [&sum]( int v ) { sum += v; }, dispatcher.getDispatchFn() );
+
+		Timer timer( true );
+		std::thread emitter( [&concurrent] {
+			for( int i = 0; i < numEmits; ++i )
+				concurrent.emit( 1 );
+		} );
+		while( sum < numEmits )
+			dispatcher.drain();
+		emitter.join();
+		cout << "queued, M emits/s: " << numEmits / timer.getSeconds() / 1e6 << " in " << dispatcher.mNumDispatched << " deliveries" << endl;
+	}
+}